@@ -0,0 +1,297 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Shape analysis of the blobs of a frame.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BlobMoments.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#define BLOB_MOMENTS_SSE2
+	#include <emmintrin.h>
+#endif
+
+// Points summed in single precision lanes before the sums are carried over
+// into double precision, which bounds the rounding error on large blobs.
+#define BLOB_MOMENTS_BLOCK		256
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	// Raw sums over a blob's points, taken relative to its first point so
+	// that screen-sized coordinates do not swamp the second moments.
+	struct MomentSums
+	{
+		double	s0;
+		double	sx;
+		double	sy;
+		double	sxx;
+		double	syy;
+		double	sxy;
+		double	cross;		// twice the signed contour area
+		float		minX;
+		float		minY;
+		float		maxX;
+		float		maxY;
+
+		MomentSums() :
+			s0(0.0), sx(0.0), sy(0.0), sxx(0.0), syy(0.0), sxy(0.0), cross(0.0),
+			minX(FLT_MAX), minY(FLT_MAX), maxX(-FLT_MAX), maxY(-FLT_MAX)
+		{
+		}
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Adds the point range [begin_I, end_I) to the sums one point at a
+	//		time, with contour edges from each point to the next (the last one
+	//		closing back to the first point of the blob).
+	//
+	void AccumulateScalar(const float *x_I, const float *y_I, const unsigned short *sensitivity_I,
+		int count_I, int begin_I, int end_I, int edgeBegin_I, bool unitWeight_I, MomentSums &sums_IO)
+	{
+		const double x0 = x_I[0];
+		const double y0 = y_I[0];
+
+		for (int idx = begin_I; idx < end_I; idx++)
+		{
+			const double x = x_I[idx] - x0;
+			const double y = y_I[idx] - y0;
+			const double w = unitWeight_I ? 1.0 : sensitivity_I[idx];
+
+			sums_IO.s0 += w;
+			sums_IO.sx += w * x;
+			sums_IO.sy += w * y;
+			sums_IO.sxx += w * x * x;
+			sums_IO.syy += w * y * y;
+			sums_IO.sxy += w * x * y;
+			sums_IO.minX = std::min(sums_IO.minX, x_I[idx]);
+			sums_IO.minY = std::min(sums_IO.minY, y_I[idx]);
+			sums_IO.maxX = std::max(sums_IO.maxX, x_I[idx]);
+			sums_IO.maxY = std::max(sums_IO.maxY, y_I[idx]);
+		}
+
+		for (int idx = edgeBegin_I; idx < count_I; idx++)
+		{
+			const int next = idx + 1 == count_I ? 0 : idx + 1;
+			sums_IO.cross += (x_I[idx] - x0) * (y_I[next] - y0) - (x_I[next] - x0) * (y_I[idx] - y0);
+		}
+	}
+
+#if defined(BLOB_MOMENTS_SSE2)
+	///////////////////////////////////////////////////////////////////////////
+
+	double Sum(__m128 value_I)
+	{
+		float lanes[4];
+		_mm_storeu_ps(lanes, value_I);
+		return static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+	}
+
+	float Min(__m128 value_I)
+	{
+		float lanes[4];
+		_mm_storeu_ps(lanes, value_I);
+		return std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+	}
+
+	float Max(__m128 value_I)
+	{
+		float lanes[4];
+		_mm_storeu_ps(lanes, value_I);
+		return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Adds a blob's points to the sums four at a time.  The contour edge
+	//		of each point needs the next point too, so edges are done along
+	//		with the points while the next four are in range.  The remaining
+	//		points and edges go through AccumulateScalar.
+	//
+	void AccumulateSse2(const float *x_I, const float *y_I, const unsigned short *sensitivity_I,
+		int count_I, bool unitWeight_I, MomentSums &sums_IO)
+	{
+		const __m128 x0 = _mm_set1_ps(x_I[0]);
+		const __m128 y0 = _mm_set1_ps(y_I[0]);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128i zero = _mm_setzero_si128();
+
+		__m128 minX = _mm_set1_ps(FLT_MAX);
+		__m128 minY = minX;
+		__m128 maxX = _mm_set1_ps(-FLT_MAX);
+		__m128 maxY = maxX;
+
+		int idx = 0;
+		int edges = 0;
+		while (idx + 4 <= count_I)
+		{
+			__m128 s0 = _mm_setzero_ps();
+			__m128 sx = s0, sy = s0, sxx = s0, syy = s0, sxy = s0, cross = s0;
+
+			const int blockEnd = std::min(count_I, idx + BLOB_MOMENTS_BLOCK);
+			for (; idx + 4 <= blockEnd; idx += 4)
+			{
+				const __m128 rawX = _mm_loadu_ps(x_I + idx);
+				const __m128 rawY = _mm_loadu_ps(y_I + idx);
+				const __m128 x = _mm_sub_ps(rawX, x0);
+				const __m128 y = _mm_sub_ps(rawY, y0);
+
+				__m128 w = one;
+				if (!unitWeight_I)
+				{
+					const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(sensitivity_I + idx));
+					w = _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, zero));
+				}
+
+				const __m128 wx = _mm_mul_ps(w, x);
+				const __m128 wy = _mm_mul_ps(w, y);
+				s0 = _mm_add_ps(s0, w);
+				sx = _mm_add_ps(sx, wx);
+				sy = _mm_add_ps(sy, wy);
+				sxx = _mm_add_ps(sxx, _mm_mul_ps(wx, x));
+				syy = _mm_add_ps(syy, _mm_mul_ps(wy, y));
+				sxy = _mm_add_ps(sxy, _mm_mul_ps(wx, y));
+
+				minX = _mm_min_ps(minX, rawX);
+				minY = _mm_min_ps(minY, rawY);
+				maxX = _mm_max_ps(maxX, rawX);
+				maxY = _mm_max_ps(maxY, rawY);
+
+				if (idx + 5 <= count_I)
+				{
+					const __m128 nextX = _mm_sub_ps(_mm_loadu_ps(x_I + idx + 1), x0);
+					const __m128 nextY = _mm_sub_ps(_mm_loadu_ps(y_I + idx + 1), y0);
+					cross = _mm_add_ps(cross, _mm_sub_ps(_mm_mul_ps(x, nextY), _mm_mul_ps(nextX, y)));
+					edges = idx + 4;
+				}
+			}
+
+			sums_IO.s0 += Sum(s0);
+			sums_IO.sx += Sum(sx);
+			sums_IO.sy += Sum(sy);
+			sums_IO.sxx += Sum(sxx);
+			sums_IO.syy += Sum(syy);
+			sums_IO.sxy += Sum(sxy);
+			sums_IO.cross += Sum(cross);
+		}
+
+		if (idx)
+		{
+			sums_IO.minX = Min(minX);
+			sums_IO.minY = Min(minY);
+			sums_IO.maxX = Max(maxX);
+			sums_IO.maxY = Max(maxY);
+		}
+
+		AccumulateScalar(x_I, y_I, sensitivity_I, count_I, idx, count_I, edges, unitWeight_I, sums_IO);
+	}
+#endif
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Turns the sums into centroid, central moments and the ellipse of
+	//		the same moments: its major axis gives the orientation, and the
+	//		ratio of its axes the eccentricity.
+	//
+	void Finish(const BlobSnapshotBlob &blob_I, float x0_I, float y0_I, const MomentSums &sums_I, double weight_I, BlobMoments &moments_O)
+	{
+		moments_O = BlobMoments();
+		moments_O.blobID = blob_I.blobID;
+		moments_O.weight = weight_I;
+		if (!blob_I.pointCount || sums_I.s0 <= 0.0)
+		{
+			return;
+		}
+
+		const double meanX = sums_I.sx / sums_I.s0;
+		const double meanY = sums_I.sy / sums_I.s0;
+		const double mu20 = std::max(sums_I.sxx / sums_I.s0 - meanX * meanX, 0.0);
+		const double mu02 = std::max(sums_I.syy / sums_I.s0 - meanY * meanY, 0.0);
+		const double mu11 = sums_I.sxy / sums_I.s0 - meanX * meanY;
+
+		const double half = (mu20 - mu02) / 2.0;
+		const double spread = sqrt(half * half + mu11 * mu11);
+		const double major = (mu20 + mu02) / 2.0 + spread;
+		const double minor = std::max((mu20 + mu02) / 2.0 - spread, 0.0);
+
+		moments_O.area = static_cast<float>(fabs(sums_I.cross) / 2.0);
+		moments_O.centroidX = static_cast<float>(x0_I + meanX);
+		moments_O.centroidY = static_cast<float>(y0_I + meanY);
+		moments_O.mu20 = static_cast<float>(mu20);
+		moments_O.mu02 = static_cast<float>(mu02);
+		moments_O.mu11 = static_cast<float>(mu11);
+		moments_O.orientation = static_cast<float>(0.5 * atan2(2.0 * mu11, mu20 - mu02));
+		moments_O.eccentricity = major > 0.0 ? static_cast<float>(sqrt(std::max(1.0 - minor / major, 0.0))) : 0.0f;
+		moments_O.minX = sums_I.minX;
+		moments_O.minY = sums_I.minY;
+		moments_O.maxX = sums_I.maxX;
+		moments_O.maxY = sums_I.maxY;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	template <typename Accumulate>
+	void ComputeAll(const BlobSnapshot &snapshot_I, std::vector<BlobMoments> &moments_O, Accumulate accumulate_I)
+	{
+		moments_O.resize(snapshot_I.BlobCount());
+
+		for (int blobIndex = 0; blobIndex < snapshot_I.BlobCount(); blobIndex++)
+		{
+			const BlobSnapshotBlob &blob = snapshot_I.Blobs()[blobIndex];
+			const float *x = snapshot_I.PointX() + blob.firstPoint;
+			const float *y = snapshot_I.PointY() + blob.firstPoint;
+			const unsigned short *sensitivity = snapshot_I.PointSensitivity() + blob.firstPoint;
+
+			MomentSums sums;
+			if (blob.pointCount)
+			{
+				accumulate_I(x, y, sensitivity, blob.pointCount, false, sums);
+			}
+
+			const double weight = sums.s0;
+			if (blob.pointCount && weight <= 0.0)
+			{
+				sums = MomentSums();
+				accumulate_I(x, y, sensitivity, blob.pointCount, true, sums);
+			}
+
+			Finish(blob, blob.pointCount ? x[0] : 0.0f, blob.pointCount ? y[0] : 0.0f, sums, weight, moments_O[blobIndex]);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ComputeBlobMoments(const BlobSnapshot &snapshot_I, std::vector<BlobMoments> &moments_O)
+{
+#if defined(BLOB_MOMENTS_SSE2)
+	ComputeAll(snapshot_I, moments_O, AccumulateSse2);
+#else
+	ComputeBlobMomentsReference(snapshot_I, moments_O);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ComputeBlobMomentsReference(const BlobSnapshot &snapshot_I, std::vector<BlobMoments> &moments_O)
+{
+	ComputeAll(snapshot_I, moments_O,
+		[](const float *x_I, const float *y_I, const unsigned short *sensitivity_I, int count_I, bool unitWeight_I, MomentSums &sums_IO)
+		{
+			AccumulateScalar(x_I, y_I, sensitivity_I, count_I, 0, count_I, 0, unitWeight_I, sums_IO);
+		});
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Shape analysis of the blobs of a frame.
+//
+//		For every blob of a BlobSnapshot, in one pass over its points: the
+//		sensitivity weighted centroid and second-order central moments, the
+//		principal axis orientation and eccentricity derived from them, the
+//		area enclosed by the contour and the bounding box.  The pass runs
+//		four points at a time with SSE2 where available; a plain double
+//		precision version is kept as the reference it is checked against.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "BlobSnapshot.h"
+
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Moments of one blob, in the coordinates of its points.  If all of a blob's
+// points have zero sensitivity, each point is weighted equally.
+//
+struct BlobMoments
+{
+	int		blobID;
+	double	weight;				// total sensitivity
+	float		area;					// enclosed by the contour
+	float		centroidX;
+	float		centroidY;
+	float		mu20;					// central second moments, per unit weight
+	float		mu02;
+	float		mu11;
+	float		orientation;		// major axis, radians from the X axis
+	float		eccentricity;		// 0 for a circle, towards 1 for a line
+	float		minX;
+	float		minY;
+	float		maxX;
+	float		maxY;
+};
+
+// Computes the moments of every blob of the snapshot into moments_O, one
+// entry per blob.  Reuses the vector's storage.
+void ComputeBlobMoments(const BlobSnapshot &snapshot_I, std::vector<BlobMoments> &moments_O);
+
+// Same results, one point at a time in double precision.
+void ComputeBlobMomentsReference(const BlobSnapshot &snapshot_I, std::vector<BlobMoments> &moments_O);
@@ -0,0 +1,268 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Snapshots of blob frames that outlive the Feel Multi-Touch callback.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BlobSnapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	size_t AlignUp(size_t offset_I)
+	{
+		return (offset_I + BLOB_SNAPSHOT_ALIGN - 1) & ~static_cast<size_t>(BLOB_SNAPSHOT_ALIGN - 1);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+BlobSnapshot::BlobSnapshot() :
+	mBlobCapacity(0),
+	mPointCapacity(0),
+	mBlobs(nullptr),
+	mPointX(nullptr),
+	mPointY(nullptr),
+	mSensitivity(nullptr),
+	mDeviceID(0),
+	mFrameNumber(0),
+	mBlobCount(0),
+	mPointCount(0),
+	mTruncated(false)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Lays out the blob headers and the three point arrays in a single
+//		allocation, each array starting on its own cache line.
+//
+void BlobSnapshot::Allocate(int blobCapacity_I, int pointCapacity_I)
+{
+	mBlobCapacity = std::max(blobCapacity_I, 0);
+	mPointCapacity = std::max(pointCapacity_I, 0);
+
+	const size_t blobOffset = 0;
+	const size_t xOffset = AlignUp(blobOffset + mBlobCapacity * sizeof(BlobSnapshotBlob));
+	const size_t yOffset = AlignUp(xOffset + mPointCapacity * sizeof(float));
+	const size_t sensitivityOffset = AlignUp(yOffset + mPointCapacity * sizeof(float));
+	const size_t size = AlignUp(sensitivityOffset + mPointCapacity * sizeof(unsigned short));
+
+	// Over-allocate so the start can be aligned.
+	mArena.assign(size + BLOB_SNAPSHOT_ALIGN, 0);
+	unsigned char *base = mArena.data() + (AlignUp(reinterpret_cast<uintptr_t>(mArena.data())) - reinterpret_cast<uintptr_t>(mArena.data()));
+
+	mBlobs = reinterpret_cast<BlobSnapshotBlob *>(base + blobOffset);
+	mPointX = reinterpret_cast<float *>(base + xOffset);
+	mPointY = reinterpret_cast<float *>(base + yOffset);
+	mSensitivity = reinterpret_cast<unsigned short *>(base + sensitivityOffset);
+
+	mBlobCount = 0;
+	mPointCount = 0;
+	mTruncated = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool BlobSnapshot::Capture(const WacomMTBlobAggregate &aggregate_I)
+{
+	mDeviceID = aggregate_I.DeviceID;
+	mFrameNumber = aggregate_I.FrameNumber;
+	mBlobCount = 0;
+	mPointCount = 0;
+	mTruncated = false;
+
+	return Append(aggregate_I);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Copies the blobs after those captured so far.  Hit rects may overlap,
+//		so a blob whose ID is already there is not copied again.
+//
+bool BlobSnapshot::Append(const WacomMTBlobAggregate &aggregate_I)
+{
+	const int blobCount = aggregate_I.BlobArray ? std::max(aggregate_I.BlobCount, 0) : 0;
+	const int firstBlob = mBlobCount;
+	int copied = 0;
+
+	for (int idx = 0; idx < blobCount && mBlobCount < mBlobCapacity; idx++)
+	{
+		const WacomMTBlob &blob = aggregate_I.BlobArray[idx];
+		BlobSnapshotBlob *end = mBlobs + firstBlob;
+		if (std::find_if(mBlobs, end, [&blob](const BlobSnapshotBlob &copy_I) { return copy_I.blobID == blob.BlobID; }) != end)
+		{
+			copied++;
+			continue;
+		}
+
+		const int points = blob.BlobPoints ? std::max(blob.PointCount, 0) : 0;
+		if (mPointCount + points > mPointCapacity)
+		{
+			break;
+		}
+
+		BlobSnapshotBlob &copy = mBlobs[mBlobCount++];
+		copy.blobID = blob.BlobID;
+		copy.parentID = blob.ParentID;
+		copy.x = blob.X;
+		copy.y = blob.Y;
+		copy.confidence = blob.Confidence;
+		copy.blobType = blob.BlobType;
+		copy.firstPoint = mPointCount;
+		copy.pointCount = points;
+
+		float *x = mPointX + mPointCount;
+		float *y = mPointY + mPointCount;
+		unsigned short *sensitivity = mSensitivity + mPointCount;
+		for (int point = 0; point < points; point++)
+		{
+			x[point] = blob.BlobPoints[point].X;
+			y[point] = blob.BlobPoints[point].Y;
+			sensitivity[point] = blob.BlobPoints[point].Sensitivity;
+		}
+		mPointCount += points;
+		copied++;
+	}
+
+	const bool complete = copied == blobCount;
+	mTruncated = mTruncated || !complete;
+	return complete;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BlobSnapshot::CopyFrom(const BlobSnapshot &snapshot_I)
+{
+	mDeviceID = snapshot_I.mDeviceID;
+	mFrameNumber = snapshot_I.mFrameNumber;
+	mBlobCount = 0;
+	mPointCount = 0;
+	mTruncated = snapshot_I.mTruncated;
+
+	for (int idx = 0; idx < snapshot_I.mBlobCount && mBlobCount < mBlobCapacity; idx++)
+	{
+		const BlobSnapshotBlob &blob = snapshot_I.mBlobs[idx];
+		if (mPointCount + blob.pointCount > mPointCapacity)
+		{
+			break;
+		}
+
+		BlobSnapshotBlob &copy = mBlobs[mBlobCount++];
+		copy = blob;
+		copy.firstPoint = mPointCount;
+		std::copy(snapshot_I.mPointX + blob.firstPoint, snapshot_I.mPointX + blob.firstPoint + blob.pointCount, mPointX + mPointCount);
+		std::copy(snapshot_I.mPointY + blob.firstPoint, snapshot_I.mPointY + blob.firstPoint + blob.pointCount, mPointY + mPointCount);
+		std::copy(snapshot_I.mSensitivity + blob.firstPoint, snapshot_I.mSensitivity + blob.firstPoint + blob.pointCount, mSensitivity + mPointCount);
+		mPointCount += blob.pointCount;
+	}
+
+	mTruncated = mTruncated || mBlobCount < snapshot_I.mBlobCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+BlobSnapshotPool::BlobSnapshotPool() :
+	mFree(0),
+	mExhausted(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BlobSnapshotPool::Allocate(const WacomMTCapability &caps_I, int count_I)
+{
+	const int blobs = std::max(caps_I.BlobMax, 1);
+	Allocate(blobs, blobs * std::max(caps_I.BlobPointsMax, 1), count_I);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BlobSnapshotPool::Allocate(int blobCapacity_I, int pointCapacity_I, int count_I)
+{
+	const int count = std::min(std::max(count_I, 1), BLOB_SNAPSHOT_POOL_MAX);
+
+	mSnapshots.clear();
+	mSnapshots.resize(count);
+	for (BlobSnapshot &snapshot : mSnapshots)
+	{
+		snapshot.Allocate(blobCapacity_I, pointCapacity_I);
+	}
+
+	mFree = count >= 64 ? ~0ULL : (1ULL << count) - 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Claims the lowest free snapshot by clearing its bit.
+//
+BlobSnapshot *BlobSnapshotPool::Capture(const WacomMTBlobAggregate *aggregate_I)
+{
+	if (!aggregate_I)
+	{
+		return nullptr;
+	}
+
+	unsigned long long free = mFree.load(std::memory_order_relaxed);
+	unsigned long long lowest = 0;
+	do
+	{
+		if (!free)
+		{
+			mExhausted.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		lowest = free & (~free + 1);
+	}
+	while (!mFree.compare_exchange_weak(free, free & ~lowest, std::memory_order_acquire, std::memory_order_relaxed));
+
+	int index = 0;
+	while (!(lowest & (1ULL << index)))
+	{
+		index++;
+	}
+
+	BlobSnapshot &snapshot = mSnapshots[index];
+	snapshot.Capture(*aggregate_I);
+	return &snapshot;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BlobSnapshotPool::Release(const BlobSnapshot *snapshot_I)
+{
+	if (!snapshot_I || mSnapshots.empty())
+	{
+		return;
+	}
+
+	const ptrdiff_t index = snapshot_I - mSnapshots.data();
+	if (index >= 0 && index < static_cast<ptrdiff_t>(mSnapshots.size()))
+	{
+		mFree.fetch_or(1ULL << index, std::memory_order_release);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int BlobSnapshotPool::Available(void) const
+{
+	unsigned long long free = mFree.load(std::memory_order_relaxed);
+	int count = 0;
+	for (; free; free &= free - 1)
+	{
+		count++;
+	}
+	return count;
+}
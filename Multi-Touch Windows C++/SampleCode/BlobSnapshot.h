@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Snapshots of blob frames that outlive the Feel Multi-Touch callback.
+//
+//		A WacomMTBlobAggregate is only valid during the callback, and each of
+//		its blobs points to its own point array.  A snapshot flattens the
+//		aggregate into one preallocated arena: the blob headers, then the X,
+//		Y and Sensitivity of all points as separate arrays, with each blob
+//		referring to its points by index.  Snapshots are recycled through a
+//		pool sized from the device capabilities, so taking one does not
+//		allocate.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Alignment of each array in the arena (a cache line).
+#define BLOB_SNAPSHOT_ALIGN			64
+
+// Most snapshots a pool can hold.
+#define BLOB_SNAPSHOT_POOL_MAX		64
+
+///////////////////////////////////////////////////////////////////////////////
+// A blob of a snapshot.  Its points are firstPoint to firstPoint + pointCount
+// of the snapshot's point arrays.
+//
+struct BlobSnapshotBlob
+{
+	int					blobID;
+	int					parentID;
+	float					x;
+	float					y;
+	bool					confidence;
+	WacomMTBlobType	blobType;
+	int					firstPoint;
+	int					pointCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class BlobSnapshot
+{
+public:
+	BlobSnapshot();
+
+	// The arrays point into the arena, which moves along with a snapshot but
+	// is not copied.
+	BlobSnapshot(BlobSnapshot &&) = default;
+	BlobSnapshot &operator=(BlobSnapshot &&) = default;
+	BlobSnapshot(const BlobSnapshot &) = delete;
+	BlobSnapshot &operator=(const BlobSnapshot &) = delete;
+
+	// Allocates the arena.  Call before capturing.
+	void Allocate(int blobCapacity_I, int pointCapacity_I);
+
+	// Copies the aggregate into the arena.  Blobs that do not fit are left
+	// out, and the snapshot is marked truncated.  Returns false if so.
+	bool Capture(const WacomMTBlobAggregate &aggregate_I);
+
+	// Adds the blobs of another part of the captured frame, as hit regions
+	// deliver it, leaving out those already in the snapshot.
+	bool Append(const WacomMTBlobAggregate &aggregate_I);
+
+	// Copies another snapshot, as far as the arena holds it.
+	void CopyFrom(const BlobSnapshot &snapshot_I);
+
+	int DeviceID(void) const { return mDeviceID; }
+	int FrameNumber(void) const { return mFrameNumber; }
+	int BlobCount(void) const { return mBlobCount; }
+	int PointCount(void) const { return mPointCount; }
+	bool Truncated(void) const { return mTruncated; }
+
+	const BlobSnapshotBlob *Blobs(void) const { return mBlobs; }
+	const float *PointX(void) const { return mPointX; }
+	const float *PointY(void) const { return mPointY; }
+	const unsigned short *PointSensitivity(void) const { return mSensitivity; }
+
+	int BlobCapacity(void) const { return mBlobCapacity; }
+	int PointCapacity(void) const { return mPointCapacity; }
+
+private:
+	std::vector<unsigned char>	mArena;
+	int							mBlobCapacity;
+	int							mPointCapacity;
+
+	// Arrays within the arena.
+	BlobSnapshotBlob			*mBlobs;
+	float							*mPointX;
+	float							*mPointY;
+	unsigned short				*mSensitivity;
+
+	int							mDeviceID;
+	int							mFrameNumber;
+	int							mBlobCount;
+	int							mPointCount;
+	bool							mTruncated;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Fixed set of snapshots.  Capture and Release may be called from any thread:
+// the free snapshots are a bit mask updated atomically.
+//
+class BlobSnapshotPool
+{
+public:
+	BlobSnapshotPool();
+
+	// Allocates count_I snapshots large enough for frames of the device
+	// (BlobMax blobs of BlobPointsMax points), or of the given capacity.
+	// Call before any snapshot is captured.
+	void Allocate(const WacomMTCapability &caps_I, int count_I);
+	void Allocate(int blobCapacity_I, int pointCapacity_I, int count_I);
+
+	// Takes a free snapshot and captures the aggregate into it.  Returns
+	// null if there is no data or every snapshot is in use.
+	BlobSnapshot *Capture(const WacomMTBlobAggregate *aggregate_I);
+
+	// Returns a snapshot taken by Capture to the pool.
+	void Release(const BlobSnapshot *snapshot_I);
+
+	int Available(void) const;
+	unsigned long long Exhausted(void) const { return mExhausted.load(std::memory_order_relaxed); }
+
+private:
+	std::vector<BlobSnapshot>				mSnapshots;
+	std::atomic<unsigned long long>		mFree;			// bit per free snapshot
+	std::atomic<unsigned long long>		mExhausted;		// captures with none free
+};
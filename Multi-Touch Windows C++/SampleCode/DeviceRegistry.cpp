@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		The attached touch devices, read on the touch hot path without locks.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DeviceRegistry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+///////////////////////////////////////////////////////////////////////////////
+
+const WacomMTCapability *DeviceSet::Find(int deviceID_I) const
+{
+	for (const WacomMTCapability &caps : devices)
+	{
+		if (caps.DeviceID == deviceID_I)
+		{
+			return &caps;
+		}
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Counts the reader in the current phase.  If a writer flipped the
+//		phase meanwhile, the reader may have been counted where that writer
+//		no longer looks, so it tries again; then loads the set.  Any writer
+//		that replaces this set afterwards waits for it.
+//
+DeviceRegistry::Reader::Reader(const DeviceRegistry &registry_I) :
+	mRegistry(registry_I),
+	mPhase(0),
+	mSet(nullptr)
+{
+	for (;;)
+	{
+		mPhase = mRegistry.mPhase.load() & 1;
+		mRegistry.mReaders[mPhase].count.fetch_add(1);
+		if ((mRegistry.mPhase.load() & 1) == mPhase)
+		{
+			break;
+		}
+		mRegistry.mReaders[mPhase].count.fetch_sub(1, std::memory_order_release);
+	}
+	mSet = mRegistry.mCurrent.load();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DeviceRegistry::Reader::~Reader()
+{
+	mRegistry.mReaders[mPhase].count.fetch_sub(1, std::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DeviceRegistry::DeviceRegistry() :
+	mCurrent(nullptr),
+	mPhase(0),
+	mStats()
+{
+	mReaders[0].count = 0;
+	mReaders[1].count = 0;
+
+	DeviceSet *set = new DeviceSet();
+	set->version = 0;
+	mCurrent = set;
+	mStats.published = 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DeviceRegistry::~DeviceRegistry()
+{
+	delete mCurrent.load();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool DeviceRegistry::Add(const WacomMTCapability &caps_I)
+{
+	std::lock_guard<std::mutex> lock(mWriteLock);
+	const DeviceSet *current = mCurrent.load(std::memory_order_relaxed);
+	if (current->Find(caps_I.DeviceID))
+	{
+		return false;
+	}
+
+	DeviceSet *set = new DeviceSet(*current);
+	set->devices.push_back(caps_I);
+	Publish(set);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool DeviceRegistry::Remove(int deviceID_I)
+{
+	std::lock_guard<std::mutex> lock(mWriteLock);
+	const DeviceSet *current = mCurrent.load(std::memory_order_relaxed);
+	if (!current->Find(deviceID_I))
+	{
+		return false;
+	}
+
+	DeviceSet *set = new DeviceSet(*current);
+	set->devices.erase(std::remove_if(set->devices.begin(), set->devices.end(),
+		[deviceID_I](const WacomMTCapability &caps_I) { return caps_I.DeviceID == deviceID_I; }), set->devices.end());
+	Publish(set);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void DeviceRegistry::Reset(const std::vector<WacomMTCapability> &devices_I)
+{
+	std::lock_guard<std::mutex> lock(mWriteLock);
+	DeviceSet *set = new DeviceSet();
+	set->devices = devices_I;
+	Publish(set);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Swaps in the new set, ends the grace period, waits for its readers
+//		and deletes the old set.  Call under mWriteLock.
+//
+void DeviceRegistry::Publish(DeviceSet *set_I)
+{
+	const DeviceSet *old = mCurrent.load(std::memory_order_relaxed);
+	set_I->version = old->version + 1;
+	mCurrent.store(set_I);
+
+	const unsigned phase = mPhase.fetch_add(1) & 1;
+	if (mReaders[phase].count.load(std::memory_order_acquire) != 0)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (mReaders[phase].count.load(std::memory_order_acquire) != 0)
+		{
+			std::this_thread::yield();
+		}
+
+		const double waitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		mStats.waits++;
+		mStats.longestWaitMs = std::max(mStats.longestWaitMs, waitMs);
+	}
+
+	delete old;
+	mStats.published++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<WacomMTCapability> DeviceRegistry::Devices(void) const
+{
+	Reader reader(*this);
+	return reader->devices;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool DeviceRegistry::Find(int deviceID_I, WacomMTCapability &caps_O) const
+{
+	Reader reader(*this);
+	const WacomMTCapability *caps = reader->Find(deviceID_I);
+	if (caps)
+	{
+		caps_O = *caps;
+	}
+	return caps != nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DeviceRegistryStats DeviceRegistry::Stats(void) const
+{
+	std::lock_guard<std::mutex> lock(mWriteLock);
+	return mStats;
+}
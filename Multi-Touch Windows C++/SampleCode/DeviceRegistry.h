@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		The attached touch devices, read on the touch hot path without locks.
+//
+//		The registry publishes a new DeviceSet for every attach and detach
+//		(read-copy-update): a writer copies the current set, changes the
+//		copy and swaps it in with one atomic store.  A Reader pins the set
+//		that was current when it was made, and only counts itself in or out
+//		of the current grace period to do so, so it never waits for a
+//		writer.  The writer deletes the old set once the readers of the
+//		grace period it ended have gone.
+//
+//		Writers are serialized and wait for readers, so they belong on a
+//		thread of their own (the sample's window thread), not on the
+//		driver's callback thread.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// One version of the attached devices, in the order they attached.  A set
+// never changes once published.
+//
+struct DeviceSet
+{
+	unsigned long long					version;
+	std::vector<WacomMTCapability>	devices;
+
+	// The device's capabilities, or null.
+	const WacomMTCapability *Find(int deviceID_I) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct DeviceRegistryStats
+{
+	unsigned long long	published;			// versions, the first one included
+	unsigned long long	waits;				// writes that found readers to wait for
+	double					longestWaitMs;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class DeviceRegistry
+{
+public:
+	DeviceRegistry();
+	~DeviceRegistry();
+
+	DeviceRegistry(const DeviceRegistry &) = delete;
+	DeviceRegistry &operator=(const DeviceRegistry &) = delete;
+
+	///////////////////////////////////////////////////////////////////////////
+	// The current set, pinned for as long as the Reader lives.  Keep one for
+	// the time of a frame, and never across a call that waits for the
+	// writing thread (a message box, SendMessage), or the writer waits for
+	// it in turn.
+	//
+	class Reader
+	{
+	public:
+		explicit Reader(const DeviceRegistry &registry_I);
+		~Reader();
+
+		Reader(const Reader &) = delete;
+		Reader &operator=(const Reader &) = delete;
+
+		const DeviceSet &operator*() const { return *mSet; }
+		const DeviceSet *operator->() const { return mSet; }
+
+	private:
+		const DeviceRegistry		&mRegistry;
+		unsigned						mPhase;
+		const DeviceSet			*mSet;
+	};
+
+	// Writers, one at a time.  Each publishes a new version and returns once
+	// no reader can see the old one.  Add keeps the capabilities of a device
+	// that is already there; Add and Remove return false if nothing changed.
+	bool Add(const WacomMTCapability &caps_I);
+	bool Remove(int deviceID_I);
+	void Reset(const std::vector<WacomMTCapability> &devices_I);
+
+	// Copies of the current set, for code that must not hold a Reader.
+	std::vector<WacomMTCapability> Devices(void) const;
+	bool Find(int deviceID_I, WacomMTCapability &caps_O) const;
+
+	DeviceRegistryStats Stats(void) const;
+
+private:
+	struct ReaderCount
+	{
+		alignas(64) std::atomic<int>	count;
+	};
+
+	void Publish(DeviceSet *set_I);
+
+	// Readers count themselves in mReaders[mPhase & 1]; a writer flips the
+	// phase after publishing, and waits for the old count to drain.
+	std::atomic<const DeviceSet *>	mCurrent;
+	alignas(64) std::atomic<unsigned>	mPhase;
+	mutable ReaderCount				mReaders[2];
+
+	mutable std::mutex				mWriteLock;
+	DeviceRegistryStats				mStats;				// under mWriteLock
+};
@@ -0,0 +1,191 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		History of the fingers of a device.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FingerTracks.h"
+
+#include <algorithm>
+
+static_assert((FINGER_TRACK_HISTORY & (FINGER_TRACK_HISTORY - 1)) == 0, "FINGER_TRACK_HISTORY must be a power of two");
+
+///////////////////////////////////////////////////////////////////////////////
+
+FingerTrack::FingerTrack() :
+	mSamples(nullptr),
+	mHead(-1),
+	mCount(0),
+	mTotal(0),
+	mFingerID(-1),
+	mStartFrame(0),
+	mActive(false),
+	mUsed(false),
+	mSeen(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FingerTrack::Start(int fingerID_I, int frameNumber_I)
+{
+	mHead = -1;
+	mCount = 0;
+	mTotal = 0;
+	mFingerID = fingerID_I;
+	mStartFrame = frameNumber_I;
+	mActive = true;
+	mUsed = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FingerTrack::Append(const WacomMTFinger &finger_I, int frameNumber_I)
+{
+	mHead = (mHead + 1) & (FINGER_TRACK_HISTORY - 1);
+	mCount = std::min(mCount + 1, FINGER_TRACK_HISTORY);
+	mTotal++;
+
+	FingerTrackSample &sample = mSamples[mHead];
+	sample.x = finger_I.X;
+	sample.y = finger_I.Y;
+	sample.width = finger_I.Width;
+	sample.height = finger_I.Height;
+	sample.orientation = finger_I.Orientation;
+	sample.confidence = finger_I.Confidence;
+	sample.frameNumber = frameNumber_I;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FingerTrackStore::FingerTrackStore() :
+	mUsedCount(0),
+	mUpdate(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FingerTrackStore::Allocate(int fingerMax_I)
+{
+	const int tracks = std::max(fingerMax_I, 1);
+	mSamples.assign(tracks * FINGER_TRACK_HISTORY, FingerTrackSample());
+	mTracks.assign(tracks, FingerTrack());
+	for (int index = 0; index < tracks; index++)
+	{
+		mTracks[index].mSamples = mSamples.data() + index * FINGER_TRACK_HISTORY;
+	}
+	mUsedCount = 0;
+	mUpdate = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const FingerTrack *FingerTrackStore::Find(int fingerID_I) const
+{
+	for (int index = 0; index < mUsedCount; index++)
+	{
+		if (mTracks[index].mFingerID == fingerID_I)
+		{
+			return &mTracks[index];
+		}
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FingerTrack *FingerTrackStore::FindActive(int fingerID_I)
+{
+	for (int index = 0; index < mUsedCount; index++)
+	{
+		if (mTracks[index].mActive && mTracks[index].mFingerID == fingerID_I)
+		{
+			return &mTracks[index];
+		}
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Starts a track in the slot the finger last used, else in an unused
+//		slot, else in the slot of the track that ended first.  If every track
+//		is active (more fingers than FingerMax), the one reported longest ago
+//		is taken over.
+//
+FingerTrack *FingerTrackStore::StartTrack(int fingerID_I, int frameNumber_I)
+{
+	FingerTrack *track = const_cast<FingerTrack *>(Find(fingerID_I));
+
+	if (!track && mUsedCount < Capacity())
+	{
+		track = &mTracks[mUsedCount++];
+	}
+
+	if (!track)
+	{
+		for (int index = 0; index < mUsedCount; index++)
+		{
+			FingerTrack &candidate = mTracks[index];
+			if (!track || candidate.mActive < track->mActive ||
+				(candidate.mActive == track->mActive && candidate.mSeen < track->mSeen))
+			{
+				track = &candidate;
+			}
+		}
+	}
+
+	track->Start(fingerID_I, frameNumber_I);
+	return track;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FingerTrackStore::Update(int frameNumber_I, int count_I, const WacomMTFinger *fingers_I)
+{
+	if (mTracks.empty())
+	{
+		return;
+	}
+
+	mUpdate++;
+	for (int index = 0; index < count_I && fingers_I; index++)
+	{
+		const WacomMTFinger &finger = fingers_I[index];
+		if (finger.TouchState == WMTFingerStateNone)
+		{
+			continue;
+		}
+
+		// A finger held or lifted without a track (its down state was
+		// missed) starts one as well.
+		FingerTrack *track = finger.TouchState == WMTFingerStateDown ? nullptr : FindActive(finger.FingerID);
+		if (!track)
+		{
+			track = StartTrack(finger.FingerID, frameNumber_I);
+		}
+
+		track->Append(finger, frameNumber_I);
+		track->mSeen = mUpdate;
+		if (finger.TouchState == WMTFingerStateUp)
+		{
+			track->mActive = false;
+		}
+	}
+
+	for (int index = 0; index < mUsedCount; index++)
+	{
+		if (mTracks[index].mSeen != mUpdate)
+		{
+			mTracks[index].mActive = false;
+		}
+	}
+}
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		History of the fingers of a device.
+//
+//		A track follows one FingerID from WMTFingerStateDown to
+//		WMTFingerStateUp and keeps its last FINGER_TRACK_HISTORY samples in a
+//		ring buffer.  A store holds FingerMax tracks of one device; all of its
+//		memory is allocated up front, so updating it never allocates.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+#include <vector>
+
+// Samples kept per track; a power of two.
+#define FINGER_TRACK_HISTORY		64
+
+///////////////////////////////////////////////////////////////////////////////
+// One frame of a finger, in the units of WacomMTFinger.
+//
+struct FingerTrackSample
+{
+	float		x;
+	float		y;
+	float		width;
+	float		height;
+	float		orientation;
+	bool		confidence;
+	int		frameNumber;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class FingerTrack
+{
+public:
+	FingerTrack();
+
+	int FingerID(void) const { return mFingerID; }
+
+	// True from the finger's down state until its up state, or until a
+	// frame no longer reports it.
+	bool Active(void) const { return mActive; }
+
+	// Frames of the first and the newest sample.
+	int StartFrame(void) const { return mStartFrame; }
+	int EndFrame(void) const { return Newest().frameNumber; }
+
+	// Samples held (at most FINGER_TRACK_HISTORY), and taken in all.
+	int Count(void) const { return mCount; }
+	unsigned long long Total(void) const { return mTotal; }
+
+	// The sample age_I frames before the newest, for age_I < Count().
+	const FingerTrackSample &Sample(int age_I) const { return mSamples[(mHead - age_I) & (FINGER_TRACK_HISTORY - 1)]; }
+	const FingerTrackSample &Newest(void) const { return Sample(0); }
+
+private:
+	friend class FingerTrackStore;
+
+	void Start(int fingerID_I, int frameNumber_I);
+	void Append(const WacomMTFinger &finger_I, int frameNumber_I);
+
+	FingerTrackSample			*mSamples;
+	int							mHead;
+	int							mCount;
+	unsigned long long		mTotal;
+	int							mFingerID;
+	int							mStartFrame;
+	bool							mActive;
+	bool							mUsed;
+	unsigned long long		mSeen;			// last update that reported it
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class FingerTrackStore
+{
+public:
+	FingerTrackStore();
+	FingerTrackStore(const FingerTrackStore &) = delete;
+	FingerTrackStore &operator=(const FingerTrackStore &) = delete;
+
+	// Makes room for fingerMax_I tracks (a device's FingerMax), and clears
+	// them.
+	void Allocate(int fingerMax_I);
+	int Capacity(void) const { return static_cast<int>(mTracks.size()); }
+
+	// Adds a frame of fingers.  A down state starts a new track for its
+	// FingerID, an up state ends it.  Tracks of fingers missing from the
+	// frame end too.
+	void Update(int frameNumber_I, int count_I, const WacomMTFinger *fingers_I);
+
+	// The newest track of a finger, active or ended, or null.
+	const FingerTrack *Find(int fingerID_I) const;
+
+	// All tracks in use; ended tracks stay until their slot is taken again.
+	int TrackCount(void) const { return mUsedCount; }
+	const FingerTrack &Track(int index_I) const { return mTracks[index_I]; }
+
+private:
+	FingerTrack *FindActive(int fingerID_I);
+	FingerTrack *StartTrack(int fingerID_I, int frameNumber_I);
+
+	std::vector<FingerTrackSample>	mSamples;
+	std::vector<FingerTrack>			mTracks;
+	int										mUsedCount;
+	unsigned long long					mUpdate;
+};
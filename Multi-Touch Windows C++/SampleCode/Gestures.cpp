@@ -0,0 +1,310 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Recognition of pan, pinch, rotate and n-finger tap gestures.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Gestures.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Most events one frame can raise: three gestures ending, three beginning
+// or changing, and a tap.
+#define GESTURE_MAX_EVENTS			7
+
+///////////////////////////////////////////////////////////////////////////////
+
+GestureRecognizer::GestureRecognizer() :
+	mOriginX(0.0f),
+	mOriginY(0.0f),
+	mScaleX(1.0f),
+	mScaleY(1.0f),
+	mCount(0),
+	mCentroidX(0.0f),
+	mCentroidY(0.0f),
+	mSpread(0.0f),
+	mRotation(0.0f),
+	mStartX(0.0f),
+	mStartY(0.0f),
+	mStartSpread(0.0f),
+	mTapStart(-1.0),
+	mTapFingers(0),
+	mTapFailed(false),
+	mFrameNumber(0),
+	mTimeMs(0.0)
+{
+	std::fill(mActive, mActive + 3, false);
+	mEvents.reserve(GESTURE_MAX_EVENTS);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Opaque tablets report positions as a fraction of the sensor; display
+//		tablets in screen pixels over the logical area.
+//
+void GestureRecognizer::Configure(const WacomMTCapability &caps_I)
+{
+	if (caps_I.Type == WMTDeviceTypeOpaque || caps_I.LogicalWidth <= 0.0f || caps_I.LogicalHeight <= 0.0f)
+	{
+		mOriginX = 0.0f;
+		mOriginY = 0.0f;
+		mScaleX = caps_I.PhysicalSizeX;
+		mScaleY = caps_I.PhysicalSizeY;
+	}
+	else
+	{
+		mOriginX = caps_I.LogicalOriginX;
+		mOriginY = caps_I.LogicalOriginY;
+		mScaleX = caps_I.PhysicalSizeX / caps_I.LogicalWidth;
+		mScaleY = caps_I.PhysicalSizeY / caps_I.LogicalHeight;
+	}
+
+	const int fingerMax = std::max(caps_I.FingerMax, 1);
+	mContacts.assign(fingerMax, Contact());
+	mPreviousX.assign(fingerMax, 0.0f);
+	mPreviousY.assign(fingerMax, 0.0f);
+	mCount = 0;
+	mTapStart = -1.0;
+	std::fill(mActive, mActive + 3, false);
+	mEvents.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+GestureRecognizer::Contact *GestureRecognizer::FindContact(int fingerID_I)
+{
+	for (int index = 0; index < mCount; index++)
+	{
+		if (mContacts[index].fingerID == fingerID_I)
+		{
+			return &mContacts[index];
+		}
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Takes the centroid and spread of the fingers, and the position of
+//		each relative to the centroid.  Between two frames of the same
+//		fingers, the rotation is the angle of the summed products of each
+//		finger's old and new relative positions, which weighs fingers by
+//		their distance from the centroid.
+//
+void GestureRecognizer::Measure(void)
+{
+	float sumX = 0.0f;
+	float sumY = 0.0f;
+	for (int index = 0; index < mCount; index++)
+	{
+		sumX += mContacts[index].x;
+		sumY += mContacts[index].y;
+	}
+	mCentroidX = sumX / mCount;
+	mCentroidY = sumY / mCount;
+
+	float spread = 0.0f;
+	float cross = 0.0f;
+	float dot = 0.0f;
+	for (int index = 0; index < mCount; index++)
+	{
+		const float x = mContacts[index].x - mCentroidX;
+		const float y = mContacts[index].y - mCentroidY;
+		spread += sqrt(x * x + y * y);
+		cross += mPreviousX[index] * y - mPreviousY[index] * x;
+		dot += mPreviousX[index] * x + mPreviousY[index] * y;
+		mPreviousX[index] = x;
+		mPreviousY[index] = y;
+	}
+	mSpread = spread / mCount;
+
+	if (mCount > 1 && (cross != 0.0f || dot != 0.0f))
+	{
+		mRotation += atan2(cross, dot);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Starts measuring from the current fingers, after a finger joined or
+//		left.
+//
+void GestureRecognizer::Settle(void)
+{
+	std::fill(mPreviousX.begin(), mPreviousX.end(), 0.0f);
+	std::fill(mPreviousY.begin(), mPreviousY.end(), 0.0f);
+	Measure();
+	mRotation = 0.0f;
+	mStartX = mCentroidX;
+	mStartY = mCentroidY;
+	mStartSpread = mSpread;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void GestureRecognizer::Raise(EGestureType type_I, EGesturePhase phase_I)
+{
+	GestureEvent event;
+	event.type = type_I;
+	event.phase = phase_I;
+	event.fingerCount = type_I == EGestureType::ETap ? mTapFingers : mCount;
+	event.frameNumber = mFrameNumber;
+	event.timeMs = mTimeMs;
+	event.centroidX = mCentroidX;
+	event.centroidY = mCentroidY;
+	event.panX = mCentroidX - mStartX;
+	event.panY = mCentroidY - mStartY;
+	event.scale = mStartSpread > 0.0f ? mSpread / mStartSpread : 1.0f;
+	event.rotation = mRotation;
+	mEvents.push_back(event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void GestureRecognizer::EndGestures(void)
+{
+	for (int gesture = 0; gesture < 3; gesture++)
+	{
+		if (mActive[gesture])
+		{
+			Raise(static_cast<EGestureType>(gesture), EGesturePhase::EEnd);
+			mActive[gesture] = false;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int GestureRecognizer::Update(int frameNumber_I, int count_I, const WacomMTFinger *fingers_I, double timeMs_I)
+{
+	mEvents.clear();
+	if (mContacts.empty())
+	{
+		return 0;
+	}
+
+	mFrameNumber = frameNumber_I;
+	mTimeMs = timeMs_I;
+
+	for (int index = 0; index < mCount; index++)
+	{
+		mContacts[index].seen = false;
+	}
+
+	// Fingers on the sensor: confident ones, not yet up.
+	bool changed = false;
+	for (int index = 0; index < count_I && fingers_I; index++)
+	{
+		const WacomMTFinger &finger = fingers_I[index];
+		if (finger.TouchState == WMTFingerStateNone || finger.TouchState == WMTFingerStateUp || !finger.Confidence)
+		{
+			continue;
+		}
+
+		const float x = (finger.X - mOriginX) * mScaleX;
+		const float y = (finger.Y - mOriginY) * mScaleY;
+
+		Contact *contact = FindContact(finger.FingerID);
+		if (!contact)
+		{
+			if (mCount == static_cast<int>(mContacts.size()))
+			{
+				continue;
+			}
+
+			if (!mCount && mTapStart < 0.0)
+			{
+				mTapStart = timeMs_I;
+				mTapFingers = 0;
+				mTapFailed = false;
+			}
+
+			contact = &mContacts[mCount++];
+			contact->fingerID = finger.FingerID;
+			contact->downX = x;
+			contact->downY = y;
+			changed = true;
+		}
+
+		contact->x = x;
+		contact->y = y;
+		contact->seen = true;
+
+		const float movedX = x - contact->downX;
+		const float movedY = y - contact->downY;
+		if (movedX * movedX + movedY * movedY > GESTURE_TAP_MM * GESTURE_TAP_MM)
+		{
+			mTapFailed = true;
+		}
+	}
+
+	for (int index = 0; index < mCount; )
+	{
+		if (!mContacts[index].seen)
+		{
+			mContacts[index] = mContacts[--mCount];
+			changed = true;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	mTapFingers = std::max(mTapFingers, mCount);
+	if (mTapStart >= 0.0 && timeMs_I - mTapStart > GESTURE_TAP_MS)
+	{
+		mTapFailed = true;
+	}
+
+	if (changed)
+	{
+		EndGestures();
+		if (mCount)
+		{
+			Settle();
+		}
+	}
+	else if (mCount)
+	{
+		Measure();
+
+		const float panX = mCentroidX - mStartX;
+		const float panY = mCentroidY - mStartY;
+		const bool reached[3] =
+		{
+			panX * panX + panY * panY >= GESTURE_PAN_MM * GESTURE_PAN_MM,
+			mCount > 1 && fabs(mSpread - mStartSpread) >= GESTURE_PINCH_MM,
+			mCount > 1 && mSpread >= GESTURE_ROTATE_MM && fabs(mRotation) >= GESTURE_ROTATE_DEGREES * 3.14159265f / 180.0f
+		};
+
+		for (int gesture = 0; gesture < 3; gesture++)
+		{
+			if (mActive[gesture] || reached[gesture])
+			{
+				Raise(static_cast<EGestureType>(gesture), mActive[gesture] ? EGesturePhase::EChange : EGesturePhase::EBegin);
+				mActive[gesture] = true;
+				mTapFailed = true;
+			}
+		}
+	}
+
+	if (!mCount && mTapStart >= 0.0)
+	{
+		if (!mTapFailed && mTapFingers)
+		{
+			Raise(EGestureType::ETap, EGesturePhase::EEnd);
+		}
+		mTapStart = -1.0;
+	}
+
+	return static_cast<int>(mEvents.size());
+}
@@ -0,0 +1,155 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Recognition of pan, pinch, rotate and n-finger tap gestures.
+//
+//		Each frame of fingers updates the centroid of the confident fingers
+//		on the sensor, their spread (mean distance from the centroid) and
+//		their rotation since they went down.  The rotation is taken from the
+//		change of every finger around the centroid between two frames.  A
+//		gesture begins once its measure passes a threshold in millimeters
+//		or degrees, and ends when a finger joins or leaves.  The work per
+//		frame is bounded by FingerMax, and updating never allocates.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+#include <vector>
+
+// Movement of the centroid, and change of the spread, that begin a pan or a
+// pinch, in millimeters.
+#define GESTURE_PAN_MM				4.0f
+#define GESTURE_PINCH_MM			5.0f
+
+// Rotation that begins a rotate, for fingers at least GESTURE_ROTATE_MM from
+// their centroid.
+#define GESTURE_ROTATE_DEGREES	12.0f
+#define GESTURE_ROTATE_MM			5.0f
+
+// A tap: every finger up within GESTURE_TAP_MS of the first one going down,
+// none having moved GESTURE_TAP_MM.
+#define GESTURE_TAP_MS				250.0
+#define GESTURE_TAP_MM				3.0f
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class EGestureType
+{
+	EPan,
+	EPinch,
+	ERotate,
+	ETap
+};
+
+enum class EGesturePhase
+{
+	EBegin,
+	EChange,
+	EEnd
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A gesture event.  Positions are in millimeters from the sensor's top left
+// corner; pan, scale and rotation are totals since the fingers of the
+// gesture settled.  Rotation is in radians, clockwise on the sensor.  Taps
+// have a single EEnd event.
+//
+struct GestureEvent
+{
+	EGestureType		type;
+	EGesturePhase		phase;
+	int					fingerCount;
+	int					frameNumber;
+	double				timeMs;			// time of the frame
+	float					centroidX;
+	float					centroidY;
+	float					panX;
+	float					panY;
+	float					scale;
+	float					rotation;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class GestureRecognizer
+{
+public:
+	GestureRecognizer();
+
+	// Sets the millimeter scale of the device's finger positions, and makes
+	// room for its FingerMax fingers.  Clears the state.
+	void Configure(const WacomMTCapability &caps_I);
+	int FingerMax(void) const { return static_cast<int>(mContacts.size()); }
+
+	// Adds a frame of fingers taken at timeMs_I (any millisecond clock).
+	// Returns the number of events it raised.
+	int Update(int frameNumber_I, int count_I, const WacomMTFinger *fingers_I, double timeMs_I);
+
+	// Events of the last update.
+	const std::vector<GestureEvent> &Events(void) const { return mEvents; }
+
+	// State of the fingers on the sensor.
+	int FingerCount(void) const { return mCount; }
+	float CentroidX(void) const { return mCentroidX; }
+	float CentroidY(void) const { return mCentroidY; }
+	float Spread(void) const { return mSpread; }
+	float Rotation(void) const { return mRotation; }
+
+private:
+	struct Contact
+	{
+		int		fingerID;
+		float		x;					// millimeters
+		float		y;
+		float		downX;
+		float		downY;
+		bool		seen;
+	};
+
+	Contact *FindContact(int fingerID_I);
+	void Settle(void);
+	void Measure(void);
+	void Raise(EGestureType type_I, EGesturePhase phase_I);
+	void EndGestures(void);
+
+	float							mOriginX;
+	float							mOriginY;
+	float							mScaleX;
+	float							mScaleY;
+
+	// Fingers on the sensor: the first mCount entries.
+	std::vector<Contact>		mContacts;
+	int							mCount;
+
+	// Measures of the current set of fingers, and where they settled.
+	float							mCentroidX;
+	float							mCentroidY;
+	float							mSpread;
+	float							mRotation;
+	float							mStartX;
+	float							mStartY;
+	float							mStartSpread;
+
+	// Positions relative to the centroid in the previous frame, per contact.
+	std::vector<float>		mPreviousX;
+	std::vector<float>		mPreviousY;
+
+	bool							mActive[3];		// pan, pinch, rotate
+
+	// Tap: from the first finger down to the last one up.
+	double						mTapStart;
+	int							mTapFingers;
+	bool							mTapFailed;
+
+	int							mFrameNumber;
+	double						mTimeMs;
+	std::vector<GestureEvent>	mEvents;
+};
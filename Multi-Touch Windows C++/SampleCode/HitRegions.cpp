@@ -0,0 +1,297 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Hit rects of the regions of a window.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HitRegions.h"
+
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	bool SameRect(const WacomMTHitRect &a_I, const WacomMTHitRect &b_I)
+	{
+		return a_I.originX == b_I.originX && a_I.originY == b_I.originY &&
+			a_I.width == b_I.width && a_I.height == b_I.height;
+	}
+
+	// Keeps the first error of a run of driver calls.
+	void Check(WacomMTError result_I, WacomMTError &error_IO)
+	{
+		if (error_IO == WMTErrorSuccess)
+		{
+			error_IO = result_I;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+HitRegionManager::HitRegionManager() :
+	mNextID(1),
+	mLeft(0.0f),
+	mTop(0.0f),
+	mPendingMs(-1.0),
+	mChangedMs(-1.0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int HitRegionManager::AddRegion(const WacomMTHitRect &rect_I, WacomMTProcessingMode mode_I, double timeMs_I)
+{
+	Region region = { mNextID++, rect_I, mode_I };
+	mRegions.push_back(region);
+	BuildIndex();
+	Changed(timeMs_I);
+	return region.id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool HitRegionManager::SetRegion(int regionID_I, const WacomMTHitRect &rect_I, WacomMTProcessingMode mode_I, double timeMs_I)
+{
+	for (Region &region : mRegions)
+	{
+		if (region.id == regionID_I)
+		{
+			if (!SameRect(region.rect, rect_I))
+			{
+				region.rect = rect_I;
+				BuildIndex();
+				Changed(timeMs_I);
+			}
+			if (region.mode != mode_I)
+			{
+				region.mode = mode_I;
+				Changed(timeMs_I);
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool HitRegionManager::RemoveRegion(int regionID_I, double timeMs_I)
+{
+	for (auto region = mRegions.begin(); region != mRegions.end(); ++region)
+	{
+		if (region->id == regionID_I)
+		{
+			mRegions.erase(region);
+			BuildIndex();
+			Changed(timeMs_I);
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void HitRegionManager::MoveWindow(float left_I, float top_I, double timeMs_I)
+{
+	if (left_I != mLeft || top_I != mTop)
+	{
+		mLeft = left_I;
+		mTop = top_I;
+		Changed(timeMs_I);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void HitRegionManager::Changed(double timeMs_I)
+{
+	if (mPendingMs < 0.0)
+	{
+		mPendingMs = timeMs_I;
+	}
+	mChangedMs = timeMs_I;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError HitRegionManager::Attach(HitRegionDriver &driver_IO, int deviceID_I)
+{
+	WacomMTError error = WMTErrorSuccess;
+	Synchronize(driver_IO, deviceID_I, mDevices[deviceID_I], error);
+	return error;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void HitRegionManager::Detach(HitRegionDriver &driver_IO, int deviceID_I)
+{
+	auto device = mDevices.find(deviceID_I);
+	if (device == mDevices.end())
+	{
+		return;
+	}
+
+	for (const Registration &registration : device->second)
+	{
+		driver_IO.Unregister(deviceID_I, registration.id, registration.rect, registration.mode);
+	}
+	mDevices.erase(device);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int HitRegionManager::Update(HitRegionDriver &driver_IO, double timeMs_I, bool forced_I)
+{
+	if (!Pending())
+	{
+		return 0;
+	}
+
+	if (!forced_I && timeMs_I - mChangedMs < HIT_REGION_QUIET_MS && timeMs_I - mPendingMs < HIT_REGION_MAX_DELAY_MS)
+	{
+		return 0;
+	}
+
+	int calls = 0;
+	WacomMTError error = WMTErrorSuccess;
+	for (auto &device : mDevices)
+	{
+		calls += Synchronize(driver_IO, device.first, device.second, error);
+	}
+	mPendingMs = -1.0;
+	return calls;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTHitRect HitRegionManager::ToScreen(const WacomMTHitRect &rect_I) const
+{
+	WacomMTHitRect rect = rect_I;
+	rect.originX += mLeft;
+	rect.originY += mTop;
+	return rect;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Walks the device's registrations and the regions together (both are
+//		in the order of their IDs) and makes the calls that turn the one
+//		into the other.
+//
+int HitRegionManager::Synchronize(HitRegionDriver &driver_IO, int deviceID_I, std::vector<Registration> &registered_IO, WacomMTError &error_O)
+{
+	std::vector<Registration> wanted;
+	wanted.reserve(mRegions.size());
+
+	int calls = 0;
+	size_t old = 0;
+	for (const Region &region : mRegions)
+	{
+		for (; old < registered_IO.size() && registered_IO[old].id < region.id; old++)
+		{
+			Check(driver_IO.Unregister(deviceID_I, registered_IO[old].id, registered_IO[old].rect, registered_IO[old].mode), error_O);
+			calls++;
+		}
+
+		const Registration registration = { region.id, ToScreen(region.rect), region.mode };
+		if (old < registered_IO.size() && registered_IO[old].id == region.id)
+		{
+			const Registration &previous = registered_IO[old++];
+			if (previous.mode != registration.mode)
+			{
+				Check(driver_IO.Unregister(deviceID_I, previous.id, previous.rect, previous.mode), error_O);
+				Check(driver_IO.Register(deviceID_I, registration.id, registration.rect, registration.mode), error_O);
+				calls += 2;
+			}
+			else if (!SameRect(previous.rect, registration.rect))
+			{
+				Check(driver_IO.Move(deviceID_I, registration.id, previous.rect, registration.rect, registration.mode), error_O);
+				calls++;
+			}
+		}
+		else
+		{
+			Check(driver_IO.Register(deviceID_I, registration.id, registration.rect, registration.mode), error_O);
+			calls++;
+		}
+		wanted.push_back(registration);
+	}
+
+	for (; old < registered_IO.size(); old++)
+	{
+		Check(driver_IO.Unregister(deviceID_I, registered_IO[old].id, registered_IO[old].rect, registered_IO[old].mode), error_O);
+		calls++;
+	}
+
+	registered_IO.swap(wanted);
+	return calls;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Cuts the client area at every left and right edge, and lists for
+//		each slice the regions that span it, top first.
+//
+void HitRegionManager::BuildIndex(void)
+{
+	mEdges.clear();
+	mStarts.clear();
+	mCovering.clear();
+
+	for (const Region &region : mRegions)
+	{
+		mEdges.push_back(region.rect.originX);
+		mEdges.push_back(region.rect.originX + region.rect.width);
+	}
+	std::sort(mEdges.begin(), mEdges.end());
+	mEdges.erase(std::unique(mEdges.begin(), mEdges.end()), mEdges.end());
+
+	for (size_t slice = 0; slice + 1 < mEdges.size(); slice++)
+	{
+		mStarts.push_back(static_cast<int>(mCovering.size()));
+		for (int index = static_cast<int>(mRegions.size()) - 1; index >= 0; index--)
+		{
+			const WacomMTHitRect &rect = mRegions[index].rect;
+			if (rect.originX <= mEdges[slice] && rect.originX + rect.width >= mEdges[slice + 1])
+			{
+				mCovering.push_back(index);
+			}
+		}
+	}
+	mStarts.push_back(static_cast<int>(mCovering.size()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int HitRegionManager::Route(float x_I, float y_I) const
+{
+	const float x = x_I - mLeft;
+	const float y = y_I - mTop;
+
+	const int slice = static_cast<int>(std::upper_bound(mEdges.begin(), mEdges.end(), x) - mEdges.begin()) - 1;
+	if (slice < 0 || slice + 1 >= static_cast<int>(mEdges.size()))
+	{
+		return -1;
+	}
+
+	for (int entry = mStarts[slice]; entry < mStarts[slice + 1]; entry++)
+	{
+		const Region &region = mRegions[mCovering[entry]];
+		if (y >= region.rect.originY && y < region.rect.originY + region.rect.height)
+		{
+			return region.id;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Hit rects of the regions of a window.
+//
+//		A window lays out any number of regions (canvas, palettes, toolbars),
+//		each in client coordinates with its own processing mode.  The
+//		manager keeps the hit rect registered for each region on each device
+//		in step with where the window is, but coalesces the changes: while
+//		the window is dragged or sized, the driver is updated once the
+//		geometry has been still for HIT_REGION_QUIET_MS, or at the latest
+//		HIT_REGION_MAX_DELAY_MS after the first change, with one call per
+//		region that moved.
+//
+//		Fingers are routed to the topmost region under them through an
+//		interval index over the regions' left and right edges, which only
+//		changes with the layout, not when the window moves.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+#include <map>
+#include <vector>
+
+// The driver is updated once the geometry has been still this long, or
+// this long after the first change it has not seen.
+#define HIT_REGION_QUIET_MS			50.0
+#define HIT_REGION_MAX_DELAY_MS		100.0
+
+///////////////////////////////////////////////////////////////////////////////
+// The driver calls the manager makes; rects are in screen coordinates.
+//
+class HitRegionDriver
+{
+public:
+	virtual ~HitRegionDriver() {}
+
+	virtual WacomMTError Register(int deviceID_I, int regionID_I, const WacomMTHitRect &rect_I, WacomMTProcessingMode mode_I) = 0;
+	virtual WacomMTError Move(int deviceID_I, int regionID_I, const WacomMTHitRect &from_I, const WacomMTHitRect &to_I, WacomMTProcessingMode mode_I) = 0;
+	virtual WacomMTError Unregister(int deviceID_I, int regionID_I, const WacomMTHitRect &rect_I, WacomMTProcessingMode mode_I) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class HitRegionManager
+{
+public:
+	HitRegionManager();
+
+	HitRegionManager(const HitRegionManager &) = delete;
+	HitRegionManager &operator=(const HitRegionManager &) = delete;
+
+	// Layout, in client coordinates.  Regions added later are on top.
+	// Returns the new region's ID.
+	int AddRegion(const WacomMTHitRect &rect_I, WacomMTProcessingMode mode_I, double timeMs_I);
+	bool SetRegion(int regionID_I, const WacomMTHitRect &rect_I, WacomMTProcessingMode mode_I, double timeMs_I);
+	bool RemoveRegion(int regionID_I, double timeMs_I);
+	int RegionCount(void) const { return static_cast<int>(mRegions.size()); }
+
+	// Screen position of the window's client area.
+	void MoveWindow(float left_I, float top_I, double timeMs_I);
+
+	// Registers the regions on a device, or unregisters them, at once.
+	// Attach returns the first error of the driver, if any.
+	WacomMTError Attach(HitRegionDriver &driver_IO, int deviceID_I);
+	void Detach(HitRegionDriver &driver_IO, int deviceID_I);
+	bool Attached(int deviceID_I) const { return mDevices.count(deviceID_I) != 0; }
+
+	// Brings the attached devices up to date if the changes since the last
+	// update are due (see HIT_REGION_QUIET_MS), or if forced_I.  Returns
+	// the number of driver calls made.
+	int Update(HitRegionDriver &driver_IO, double timeMs_I, bool forced_I = false);
+	bool Pending(void) const { return mPendingMs >= 0.0; }
+
+	// The topmost region at a point in screen coordinates, or -1.
+	int Route(float x_I, float y_I) const;
+
+private:
+	struct Region
+	{
+		int							id;
+		WacomMTHitRect				rect;				// client coordinates
+		WacomMTProcessingMode	mode;
+	};
+
+	struct Registration
+	{
+		int							id;
+		WacomMTHitRect				rect;				// screen coordinates
+		WacomMTProcessingMode	mode;
+	};
+
+	void Changed(double timeMs_I);
+	void BuildIndex(void);
+	WacomMTHitRect ToScreen(const WacomMTHitRect &rect_I) const;
+	int Synchronize(HitRegionDriver &driver_IO, int deviceID_I, std::vector<Registration> &registered_IO, WacomMTError &error_O);
+
+	std::vector<Region>			mRegions;			// bottom to top
+	int								mNextID;
+	float								mLeft;
+	float								mTop;
+
+	// What each attached device has registered.
+	std::map<int, std::vector<Registration>>	mDevices;
+
+	// First and last change the devices have not seen, or -1.
+	double							mPendingMs;
+	double							mChangedMs;
+
+	// Interval index: the regions between mEdges[i] and mEdges[i + 1] are
+	// mCovering[mStarts[i]] to mCovering[mStarts[i + 1]], top first.
+	std::vector<float>			mEdges;
+	std::vector<int>				mStarts;
+	std::vector<int>				mCovering;
+};
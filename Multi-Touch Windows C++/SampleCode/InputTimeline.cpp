@@ -0,0 +1,582 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		One ordered timeline of pen packets and touch frames.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InputTimeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+///////////////////////////////////////////////////////////////////////////////
+
+ClockAlignment::ClockAlignment()
+{
+	Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ClockAlignment::Reset(void)
+{
+	mFirst = 0;
+	mCount = 0;
+	mBucketStartMs = 0.0;
+	mStart = Sample();
+	mLast = Sample();
+	mStarted = false;
+	mRate = 1.0;
+	mSourceOrigin = 0.0;
+	mOrigin = 0.0;
+	mLocked = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Keeps the least delayed arrival of each bucket, by the current rate;
+//		until the first fit, the rate is the slope since the reset.  Refits
+//		whenever a bucket changes.
+//
+double ClockAlignment::Stamp(double sourceTime_I, double arrivalMs_I)
+{
+	const Sample sample = { sourceTime_I, arrivalMs_I };
+	if (mStarted && (sourceTime_I < mLast.source ||
+		(mLocked && std::fabs(arrivalMs_I - ToCommon(sourceTime_I)) > CLOCK_ALIGN_RESYNC_MS)))
+	{
+		Reset();
+	}
+
+	if (!mStarted)
+	{
+		mStart = sample;
+		mStarted = true;
+	}
+	else if (!mLocked && sourceTime_I > mStart.source)
+	{
+		mRate = (arrivalMs_I - mStart.arrival) / (sourceTime_I - mStart.source);
+	}
+	mLast = sample;
+
+	bool changed = true;
+	if (mCount == 0 || arrivalMs_I - mBucketStartMs >= CLOCK_ALIGN_BUCKET_MS)
+	{
+		if (mCount == CLOCK_ALIGN_BUCKETS)
+		{
+			mFirst = (mFirst + 1) % CLOCK_ALIGN_BUCKETS;
+			mCount--;
+		}
+		mBuckets[(mFirst + mCount) % CLOCK_ALIGN_BUCKETS] = sample;
+		mCount++;
+		mBucketStartMs = arrivalMs_I;
+	}
+	else
+	{
+		Sample &best = mBuckets[(mFirst + mCount - 1) % CLOCK_ALIGN_BUCKETS];
+		changed = Delay(sample) < Delay(best);
+		if (changed)
+		{
+			best = sample;
+		}
+	}
+
+	if (changed && mCount >= 2)
+	{
+		Fit();
+	}
+
+	return mLocked ? std::min(ToCommon(sourceTime_I), arrivalMs_I) : arrivalMs_I;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Least squares through the buckets' arrivals, then lowered onto the
+//		least delayed of them, so that none arrives before the line.
+//
+void ClockAlignment::Fit(void)
+{
+	const double base = mBuckets[mFirst].source;
+	double meanX = 0.0;
+	double meanY = 0.0;
+	for (int idx = 0; idx < mCount; idx++)
+	{
+		const Sample &sample = mBuckets[(mFirst + idx) % CLOCK_ALIGN_BUCKETS];
+		meanX += sample.source - base;
+		meanY += sample.arrival;
+	}
+	meanX /= mCount;
+	meanY /= mCount;
+
+	double sxx = 0.0;
+	double sxy = 0.0;
+	for (int idx = 0; idx < mCount; idx++)
+	{
+		const Sample &sample = mBuckets[(mFirst + idx) % CLOCK_ALIGN_BUCKETS];
+		const double dx = sample.source - base - meanX;
+		sxx += dx * dx;
+		sxy += dx * (sample.arrival - meanY);
+	}
+	if (sxx <= 0.0)
+	{
+		return;
+	}
+
+	const double rate = sxy / sxx;
+	double lowest = 0.0;
+	for (int idx = 0; idx < mCount; idx++)
+	{
+		const Sample &sample = mBuckets[(mFirst + idx) % CLOCK_ALIGN_BUCKETS];
+		lowest = std::min(lowest, sample.arrival - (meanY + (sample.source - base - meanX) * rate));
+	}
+
+	mRate = rate;
+	mSourceOrigin = base + meanX;
+	mOrigin = meanY + lowest;
+	mLocked = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+InputTimeline::InputTimeline() :
+	mSequence(0),
+	mReleasedSequence(0),
+	mReleasedMs(std::numeric_limits<double>::lowest()),
+	mLastPacketTime(0),
+	mPacketTimeMs(0.0),
+	mPacketTimeKnown(false),
+	mStats()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InputTimeline::Allocate(int fingers_I)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	mSlots.resize(INPUT_TIMELINE_CAPACITY);
+	mFree.clear();
+	for (int idx = INPUT_TIMELINE_CAPACITY - 1; idx >= 0; idx--)
+	{
+		mSlots[idx].fingers.resize(std::max(fingers_I, 1));
+		mSlots[idx].regions.resize(std::max(fingers_I, 1));
+		mFree.push_back(idx);
+	}
+	mPending.clear();
+	mPending.reserve(INPUT_TIMELINE_CAPACITY);
+	mBatch.reserve(INPUT_TIMELINE_CAPACITY);
+	mBatchDevices.reserve(INPUT_TIMELINE_CAPACITY);
+	mSources.clear();
+	mSources.reserve(1 + INPUT_TIMELINE_MAX_DEVICES);
+	FindSource(true, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InputTimeline::AddDevice(int deviceID_I)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	FindSource(false, deviceID_I);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Withdraws a detached device's clock.  A device attached again starts
+//		over, as its frame numbers may.
+//
+void InputTimeline::RemoveDevice(int deviceID_I)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	mSources.erase(std::remove_if(mSources.begin(), mSources.end(),
+		[deviceID_I](const Source &source_I) { return !source_I.pen && source_I.deviceID == deviceID_I; }),
+		mSources.end());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InputTimeline::PushPenPacket(unsigned packetTime_I, float x_I, float y_I, unsigned pressure_I, double arrivalMs_I)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	Source *source = FindSource(true, 0);
+	Slot *slot = source ? NewSlot() : nullptr;
+	if (!slot)
+	{
+		return false;
+	}
+
+	if (mPacketTimeKnown)
+	{
+		mPacketTimeMs += static_cast<int>(packetTime_I - mLastPacketTime);
+	}
+	else
+	{
+		mPacketTimeMs = packetTime_I;
+		mPacketTimeKnown = true;
+	}
+	mLastPacketTime = packetTime_I;
+
+	TimelineEvent &event = slot->event;
+	event = TimelineEvent();
+	event.type = ETimelineEvent::EPenPacket;
+	event.arrivalMs = arrivalMs_I;
+	event.x = x_I;
+	event.y = y_I;
+	event.pressure = pressure_I;
+
+	source->lastSourceTime = mPacketTimeMs;
+	const double stampMs = source->clock.Stamp(mPacketTimeMs, arrivalMs_I);
+	LowerProximity(*source, stampMs);
+	Hold(*slot, *source, stampMs);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InputTimeline::PushPenProximity(bool entering_I, double arrivalMs_I)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	Source *source = FindSource(true, 0);
+	Slot *slot = source ? NewSlot() : nullptr;
+	if (!slot)
+	{
+		return false;
+	}
+
+	TimelineEvent &event = slot->event;
+	event = TimelineEvent();
+	event.type = ETimelineEvent::EPenProximity;
+	event.arrivalMs = arrivalMs_I;
+	event.entering = entering_I;
+
+	// Leaving follows the last packet.  Entering comes before the next one,
+	// which lowers it onto its own stamp.
+	const bool packets = source->lastStampMs != std::numeric_limits<double>::lowest();
+	Hold(*slot, *source, entering_I || !packets ? arrivalMs_I : source->lastStampMs);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InputTimeline::PushFingers(const WacomMTFingerCollection *fingerData_I, double arrivalMs_I, const int *regions_I)
+{
+	if (!fingerData_I || (fingerData_I->FingerCount > 0 && !fingerData_I->Fingers))
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mLock);
+	Source *source = FindSource(false, fingerData_I->DeviceID);
+	if (!source)
+	{
+		mStats.dropped++;
+		return false;
+	}
+
+	Slot *slot = NewSlot();
+	if (!slot)
+	{
+		return false;
+	}
+
+	const int count = std::min(std::max(fingerData_I->FingerCount, 0), static_cast<int>(slot->fingers.size()));
+	if (count < fingerData_I->FingerCount)
+	{
+		mStats.truncated++;
+	}
+	std::copy(fingerData_I->Fingers, fingerData_I->Fingers + count, slot->fingers.begin());
+	if (regions_I)
+	{
+		std::copy(regions_I, regions_I + count, slot->regions.begin());
+	}
+
+	TimelineEvent &event = slot->event;
+	event = TimelineEvent();
+	event.type = ETimelineEvent::ETouchFrame;
+	event.arrivalMs = arrivalMs_I;
+	event.deviceID = fingerData_I->DeviceID;
+	event.frameNumber = fingerData_I->FrameNumber;
+	event.count = count;
+	event.fingers = slot->fingers.data();
+	event.regions = regions_I ? slot->regions.data() : nullptr;
+
+	source->lastSourceTime = fingerData_I->FrameNumber;
+	Hold(*slot, *source, source->clock.Stamp(fingerData_I->FrameNumber, arrivalMs_I));
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+double InputTimeline::NextReleaseMs(double nowMs_I) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	if (mPending.empty())
+	{
+		return -1.0;
+	}
+
+	const Slot &front = mSlots[mPending.front()];
+	bool held = false;
+	if (Due(front, nowMs_I, held))
+	{
+		return 0.0;
+	}
+	return std::max(front.event.arrivalMs + INPUT_TIMELINE_HOLD_MS - nowMs_I, 0.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+InputTimelineStats InputTimeline::Stats(void) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mStats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ClockEstimate InputTimeline::PenClock(void) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	for (const Source &source : mSources)
+	{
+		if (source.pen)
+		{
+			return Estimate(source);
+		}
+	}
+	return ClockEstimate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ClockEstimate InputTimeline::TouchClock(int deviceID_I) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	for (const Source &source : mSources)
+	{
+		if (!source.pen && source.deviceID == deviceID_I)
+		{
+			return Estimate(source);
+		}
+	}
+	return ClockEstimate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Finds a source, adding it while the room Allocate reserved lasts, so
+//		that the table is never reallocated.
+//
+InputTimeline::Source *InputTimeline::FindSource(bool pen_I, int deviceID_I)
+{
+	for (Source &source : mSources)
+	{
+		if (source.pen == pen_I && (pen_I || source.deviceID == deviceID_I))
+		{
+			return &source;
+		}
+	}
+
+	if (mSources.size() == mSources.capacity())
+	{
+		return nullptr;
+	}
+
+	Source source;
+	source.pen = pen_I;
+	source.deviceID = pen_I ? 0 : deviceID_I;
+	source.lastSourceTime = 0.0;
+	source.lastStampMs = std::numeric_limits<double>::lowest();
+	source.lastArrivalMs = std::numeric_limits<double>::lowest();
+	mSources.push_back(source);
+	return &mSources.back();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ClockEstimate InputTimeline::Estimate(const Source &source_I)
+{
+	ClockEstimate estimate;
+	estimate.locked = source_I.clock.Locked();
+	estimate.rate = source_I.clock.Rate();
+	estimate.offsetMs = source_I.clock.ToCommon(source_I.lastSourceTime) - source_I.lastSourceTime;
+	return estimate;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+InputTimeline::Slot *InputTimeline::NewSlot(void)
+{
+	if (mFree.empty())
+	{
+		mStats.dropped++;
+		return nullptr;
+	}
+
+	Slot *slot = &mSlots[mFree.back()];
+	mFree.pop_back();
+	return slot;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Proximity has no time of its own and is stamped on arrival, which may
+//		be well after the pen came near.  Moves any entering still held down
+//		to the stamp of the packet that follows it, which makes it late if
+//		events after it were released meanwhile.
+//
+void InputTimeline::LowerProximity(Source &source_IO, double stampMs_I)
+{
+	bool lowered = false;
+	for (int index : mPending)
+	{
+		TimelineEvent &event = mSlots[index].event;
+		if (event.type == ETimelineEvent::EPenProximity && event.entering && event.timeMs > stampMs_I)
+		{
+			event.timeMs = stampMs_I;
+			if (!event.late && event.timeMs < mReleasedMs)
+			{
+				event.late = true;
+				mStats.late++;
+			}
+			source_IO.lastStampMs = std::min(source_IO.lastStampMs, event.timeMs);
+			lowered = true;
+		}
+	}
+
+	if (lowered)
+	{
+		std::stable_sort(mPending.begin(), mPending.end(),
+			[this](int a_I, int b_I) { return mSlots[a_I].event.timeMs < mSlots[b_I].event.timeMs; });
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Stamps the event, no earlier than its source's previous one, and
+//		files it by stamp.  Events mostly arrive in order, so the search
+//		starts from the back.
+//
+void InputTimeline::Hold(Slot &slot_IO, Source &source_IO, double stampMs_I)
+{
+	TimelineEvent &event = slot_IO.event;
+	event.timeMs = std::max(stampMs_I, source_IO.lastStampMs);
+	event.late = event.timeMs < mReleasedMs;
+	source_IO.lastStampMs = event.timeMs;
+	source_IO.lastArrivalMs = event.arrivalMs;
+	slot_IO.sequence = ++mSequence;
+
+	if (event.late)
+	{
+		mStats.late++;
+	}
+	mStats.pushed++;
+
+	const int index = static_cast<int>(&slot_IO - mSlots.data());
+	std::vector<int>::iterator position = mPending.end();
+	while (position != mPending.begin() && mSlots[*(position - 1)].event.timeMs > event.timeMs)
+	{
+		--position;
+	}
+	mPending.insert(position, index);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		An event is due once every other source that delivered in the last
+//		INPUT_TIMELINE_IDLE_MS has stamped as far, since none of them can
+//		send an earlier one; or when its hold runs out.  Late events are due
+//		at once.
+//
+bool InputTimeline::Due(const Slot &slot_I, double nowMs_I, bool &held_O) const
+{
+	const TimelineEvent &event = slot_I.event;
+	const bool pen = event.type != ETimelineEvent::ETouchFrame;
+	held_O = false;
+	if (event.late)
+	{
+		return true;
+	}
+
+	for (const Source &source : mSources)
+	{
+		if (source.pen == pen && (pen || source.deviceID == event.deviceID))
+		{
+			continue;
+		}
+		if (nowMs_I - source.lastArrivalMs > INPUT_TIMELINE_IDLE_MS || source.lastStampMs >= event.timeMs)
+		{
+			continue;
+		}
+
+		held_O = nowMs_I >= event.arrivalMs + INPUT_TIMELINE_HOLD_MS;
+		return held_O;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Moves the due events to the batch, in order, and marks the newest
+//		frame of each device in it.
+//
+int InputTimeline::TakeDue(double nowMs_I)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	mBatch.clear();
+
+	size_t taken = 0;
+	for (; taken < mPending.size(); taken++)
+	{
+		Slot &slot = mSlots[mPending[taken]];
+		bool held = false;
+		if (!Due(slot, nowMs_I, held))
+		{
+			break;
+		}
+
+		const double delayMs = nowMs_I - slot.event.arrivalMs;
+		mStats.released++;
+		mStats.held += held ? 1 : 0;
+		mStats.delaySumMs += delayMs;
+		mStats.delayMaxMs = std::max(mStats.delayMaxMs, delayMs);
+		if (slot.sequence < mReleasedSequence)
+		{
+			mStats.reordered++;
+		}
+		mReleasedSequence = std::max(mReleasedSequence, slot.sequence);
+		mReleasedMs = std::max(mReleasedMs, slot.event.timeMs);
+		mBatch.push_back(mPending[taken]);
+	}
+	mPending.erase(mPending.begin(), mPending.begin() + taken);
+
+	mBatchDevices.clear();
+	for (size_t idx = mBatch.size(); idx-- > 0;)
+	{
+		TimelineEvent &event = mSlots[mBatch[idx]].event;
+		if (event.type == ETimelineEvent::ETouchFrame)
+		{
+			event.newest = std::find(mBatchDevices.begin(), mBatchDevices.end(), event.deviceID) == mBatchDevices.end();
+			if (event.newest)
+			{
+				mBatchDevices.push_back(event.deviceID);
+			}
+		}
+	}
+	return static_cast<int>(mBatch.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InputTimeline::ReturnBatch(void)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	mFree.insert(mFree.end(), mBatch.begin(), mBatch.end());
+	mBatch.clear();
+}
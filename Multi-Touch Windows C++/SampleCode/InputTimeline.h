@@ -0,0 +1,255 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		One ordered timeline of pen packets and touch frames.
+//
+//		Pen packets carry pkTime, milliseconds on the tablet driver's clock;
+//		Feel frames only a FrameNumber.  Both arrive late by a delay that
+//		varies with the thread that delivers them.  A ClockAlignment per
+//		source fits a line from the source's time to the common clock under
+//		the least delayed arrivals, which follows the offset and drift of a
+//		driver clock, or the frame period of a device, and stamps each event
+//		on it.  The fixed part of a source's delay cannot be observed and
+//		stays in its stamps.
+//
+//		The InputTimeline holds stamped events back until every source that
+//		is delivering has stamped past them, or at most INPUT_TIMELINE_HOLD_MS
+//		after they arrived, and releases them in stamp order.  An event that
+//		arrives stamped before one already released is late, and goes out
+//		next.  Pushes copy into preallocated slots under a short lock, so
+//		the Feel callbacks do not push here: their frames come through the
+//		TouchFrameQueue, with the time they arrived.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+#include <mutex>
+#include <vector>
+
+// Each bucket of arrivals keeps its least delayed one; the line is fitted
+// to the last CLOCK_ALIGN_BUCKETS of them.  An arrival further than
+// CLOCK_ALIGN_RESYNC_MS off the line starts over, as when a device resets
+// its frame numbers or stops sending frames while it is not touched.
+#define CLOCK_ALIGN_BUCKET_MS			250.0
+#define CLOCK_ALIGN_BUCKETS				64
+#define CLOCK_ALIGN_RESYNC_MS			100.0
+
+// The longest an event is held back, and how long a silent source still
+// holds the others back.
+#define INPUT_TIMELINE_HOLD_MS			12.0
+#define INPUT_TIMELINE_IDLE_MS			25.0
+
+// Events held at once.  Pushes beyond it are dropped.
+#define INPUT_TIMELINE_CAPACITY			256
+
+// Touch devices timed at once, besides the pen.  Frames of further devices
+// are dropped.
+#define INPUT_TIMELINE_MAX_DEVICES		8
+
+///////////////////////////////////////////////////////////////////////////////
+// A source's time to milliseconds on the common clock.
+//
+class ClockAlignment
+{
+public:
+	ClockAlignment();
+
+	void Reset(void);
+
+	// Adds an event's time on its source, and when it arrived on the common
+	// clock.  Returns its time on the common clock: on the line once there
+	// are two buckets, never later than its arrival.
+	double Stamp(double sourceTime_I, double arrivalMs_I);
+
+	bool Locked(void) const { return mLocked; }
+
+	// Common milliseconds per source unit: 1 + drift for a millisecond
+	// clock, the frame period for frame numbers.
+	double Rate(void) const { return mRate; }
+	double ToCommon(double sourceTime_I) const { return mOrigin + (sourceTime_I - mSourceOrigin) * mRate; }
+
+private:
+	struct Sample
+	{
+		double			source;
+		double			arrival;
+	};
+
+	double Delay(const Sample &sample_I) const { return sample_I.arrival - mRate * sample_I.source; }
+	void Fit(void);
+
+	Sample						mBuckets[CLOCK_ALIGN_BUCKETS];	// ring, oldest at mFirst
+	int							mFirst;
+	int							mCount;
+	double						mBucketStartMs;
+
+	Sample						mStart;			// first since the reset
+	Sample						mLast;
+	bool							mStarted;
+
+	double						mRate;
+	double						mSourceOrigin;
+	double						mOrigin;
+	bool							mLocked;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class ETimelineEvent
+{
+	EPenPacket,
+	EPenProximity,
+	ETouchFrame
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A released event.  fingers and regions stay valid until Release returns.
+//
+struct TimelineEvent
+{
+	ETimelineEvent				type;
+	double						timeMs;			// common clock
+	double						arrivalMs;
+	bool							late;				// stamped before an event already released
+	bool							newest;			// no later frame of its device in this release
+
+	// Pen: position as delivered, pressure, and proximity.
+	float							x;
+	float							y;
+	unsigned						pressure;
+	bool							entering;
+
+	// Touch.
+	int							deviceID;
+	int							frameNumber;
+	int							count;
+	const WacomMTFinger		*fingers;
+	const int					*regions;		// hit region delivering each finger, or null
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct InputTimelineStats
+{
+	unsigned long long		pushed;
+	unsigned long long		released;
+	unsigned long long		dropped;			// no slot free
+	unsigned long long		truncated;		// more fingers than a slot holds
+	unsigned long long		held;				// released by the hold limit, not the other sources
+	unsigned long long		late;
+	unsigned long long		reordered;		// released after an event that arrived later
+	double						delaySumMs;		// release after arrival
+	double						delayMaxMs;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct ClockEstimate
+{
+	bool							locked;
+	double						rate;
+	double						offsetMs;		// common time minus source time, at the last event
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Push*, AddDevice and RemoveDevice may be called from any thread but the
+// driver's, Release and NextReleaseMs from the consumer's only.  Times are
+// milliseconds on the common clock, passed in so that the timeline can be
+// driven by a simulated one.
+//
+class InputTimeline
+{
+public:
+	InputTimeline();
+
+	InputTimeline(const InputTimeline &) = delete;
+	InputTimeline &operator=(const InputTimeline &) = delete;
+
+	// Preallocates the slots, each for up to fingers_I fingers, and the
+	// sources.  Call before any push.
+	void Allocate(int fingers_I);
+
+	// Sets up or withdraws a touch device's clock, as the device attaches
+	// and detaches.  A device pushed without AddDevice is added on its first
+	// frame while there is room.
+	void AddDevice(int deviceID_I);
+	void RemoveDevice(int deviceID_I);
+
+	// pkTime, on the driver's clock; proximity has no time of its own.
+	bool PushPenPacket(unsigned packetTime_I, float x_I, float y_I, unsigned pressure_I, double arrivalMs_I);
+	bool PushPenProximity(bool entering_I, double arrivalMs_I);
+	bool PushFingers(const WacomMTFingerCollection *fingerData_I, double arrivalMs_I, const int *regions_I = nullptr);
+
+	// Milliseconds from nowMs_I until the hold limit releases the next
+	// event, 0 if one is due, or -1 if none is held.
+	double NextReleaseMs(double nowMs_I) const;
+
+	// Calls handle_I(const TimelineEvent &) on each event due, in order.
+	// Returns the number released.
+	template <typename Handle>
+	int Release(double nowMs_I, Handle handle_I)
+	{
+		const int count = TakeDue(nowMs_I);
+		for (int idx = 0; idx < count; idx++)
+		{
+			handle_I(mSlots[mBatch[idx]].event);
+		}
+		ReturnBatch();
+		return count;
+	}
+
+	InputTimelineStats Stats(void) const;
+	ClockEstimate PenClock(void) const;
+	ClockEstimate TouchClock(int deviceID_I) const;
+
+private:
+	struct Slot
+	{
+		TimelineEvent					event;
+		unsigned long long			sequence;		// order of arrival
+		std::vector<WacomMTFinger>	fingers;
+		std::vector<int>				regions;
+	};
+
+	struct Source
+	{
+		bool								pen;
+		int								deviceID;
+		ClockAlignment					clock;
+		double							lastSourceTime;
+		double							lastStampMs;
+		double							lastArrivalMs;
+	};
+
+	Source *FindSource(bool pen_I, int deviceID_I);
+	static ClockEstimate Estimate(const Source &source_I);
+	Slot *NewSlot(void);
+	void LowerProximity(Source &source_IO, double stampMs_I);
+	void Hold(Slot &slot_IO, Source &source_IO, double stampMs_I);
+	bool Due(const Slot &slot_I, double nowMs_I, bool &held_O) const;
+	int TakeDue(double nowMs_I);
+	void ReturnBatch(void);
+
+	mutable std::mutex				mLock;
+	std::vector<Slot>					mSlots;
+	std::vector<int>					mFree;			// under mLock
+	std::vector<int>					mPending;		// by stamp, then arrival; under mLock
+	std::vector<int>					mBatch;			// consumer
+	std::vector<int>					mBatchDevices;	// consumer
+	std::vector<Source>				mSources;		// never reallocated; under mLock
+	unsigned long long				mSequence;		// under mLock
+	unsigned long long				mReleasedSequence;
+	double								mReleasedMs;
+	unsigned								mLastPacketTime;	// pkTime, which wraps
+	double								mPacketTimeMs;		// unwrapped
+	bool									mPacketTimeKnown;
+	InputTimelineStats				mStats;			// under mLock
+};
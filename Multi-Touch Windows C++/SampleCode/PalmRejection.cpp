@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Rejection of palm and wrist contacts.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PalmRejection.h"
+
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+
+PalmRejector::PalmRejector() :
+	mOriginX(0.0f),
+	mOriginY(0.0f),
+	mScaleX(1.0f),
+	mScaleY(1.0f),
+	mSizeScaleX(1.0f),
+	mSizeScaleY(1.0f),
+	mPixelPitchX(1.0f),
+	mPixelPitchY(1.0f),
+	mCount(0),
+	mPenInProximity(false),
+	mPenLeftMs(-1.0),
+	mPenKnown(false),
+	mPenX(0.0f),
+	mPenY(0.0f),
+	mPenArrivedMs(-1.0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Positions are converted as in GestureRecognizer.  Sizes up to 1.0 are
+//		a fraction of the sensor, larger ones are pixels, as DrawFingerData
+//		takes them.
+//
+void PalmRejector::Configure(const WacomMTCapability &caps_I)
+{
+	const bool logical = caps_I.LogicalWidth > 0.0f && caps_I.LogicalHeight > 0.0f;
+	mPixelPitchX = logical ? caps_I.PhysicalSizeX / caps_I.LogicalWidth : 1.0f;
+	mPixelPitchY = logical ? caps_I.PhysicalSizeY / caps_I.LogicalHeight : 1.0f;
+	mSizeScaleX = caps_I.PhysicalSizeX;
+	mSizeScaleY = caps_I.PhysicalSizeY;
+
+	if (caps_I.Type == WMTDeviceTypeOpaque || !logical)
+	{
+		mOriginX = 0.0f;
+		mOriginY = 0.0f;
+		mScaleX = caps_I.PhysicalSizeX;
+		mScaleY = caps_I.PhysicalSizeY;
+	}
+	else
+	{
+		mOriginX = caps_I.LogicalOriginX;
+		mOriginY = caps_I.LogicalOriginY;
+		mScaleX = mPixelPitchX;
+		mScaleY = mPixelPitchY;
+	}
+
+	const int fingerMax = std::max(caps_I.FingerMax, 1);
+	mContacts.assign(fingerMax, Contact());
+	mReasons.assign(fingerMax, EPalmReason::ENone);
+	mCount = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void PalmRejector::PenProximity(bool entering_I, double timeMs_I)
+{
+	if (entering_I)
+	{
+		mPenInProximity = true;
+		mPenKnown = false;
+		mPenArrivedMs = timeMs_I;
+	}
+	else
+	{
+		mPenInProximity = false;
+		mPenLeftMs = timeMs_I;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		A packet without a proximity message first (the pen was already in
+//		proximity when the context opened) counts as the pen arriving.
+//
+void PalmRejector::PenPacket(float xMM_I, float yMM_I, double timeMs_I)
+{
+	if (!mPenInProximity)
+	{
+		PenProximity(true, timeMs_I);
+	}
+
+	mPenKnown = true;
+	mPenX = xMM_I;
+	mPenY = yMM_I;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool PalmRejector::PenPresent(double timeMs_I) const
+{
+	return mPenInProximity || (mPenLeftMs >= 0.0 && timeMs_I - mPenLeftMs <= PALM_PEN_LINGER_MS);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool PalmRejector::NearPen(float x_I, float y_I) const
+{
+	const float dx = x_I - mPenX;
+	const float dy = y_I - mPenY;
+	return mPenKnown && dx * dx + dy * dy <= PALM_PEN_RADIUS_MM * PALM_PEN_RADIUS_MM && dy >= -PALM_PEN_ABOVE_MM;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PalmRejector::Contact *PalmRejector::FindContact(int fingerID_I)
+{
+	for (int index = 0; index < mCount; index++)
+	{
+		if (mContacts[index].fingerID == fingerID_I)
+		{
+			return &mContacts[index];
+		}
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Checks a contact that has not been rejected yet.  Size and shape are
+//		checked every frame, as a palm grows while it lands.
+//
+EPalmReason PalmRejector::Classify(const WacomMTFinger &finger_I, const Contact &contact_I, bool isNew_I, double timeMs_I) const
+{
+	if (!finger_I.Confidence)
+	{
+		return EPalmReason::EConfidence;
+	}
+
+	const float width = finger_I.Width * (finger_I.Width <= 1.0f ? mSizeScaleX : mPixelPitchX);
+	const float height = finger_I.Height * (finger_I.Height <= 1.0f ? mSizeScaleY : mPixelPitchY);
+	const float major = std::max(width, height);
+	const float minor = std::min(width, height);
+
+	if (major >= PALM_MAJOR_MM || 0.785f * width * height >= PALM_AREA_MM2)
+	{
+		return EPalmReason::ESize;
+	}
+
+	if (minor > 0.0f && major >= PALM_ELONGATED_MM && major >= PALM_ELONGATION * minor)
+	{
+		return EPalmReason::EShape;
+	}
+
+	if (isNew_I && PenPresent(timeMs_I) && NearPen(contact_I.x, contact_I.y))
+	{
+		return EPalmReason::EPen;
+	}
+
+	if (mPenArrivedMs >= 0.0 && contact_I.downMs >= mPenArrivedMs - PALM_PEN_LEAD_MS && NearPen(contact_I.x, contact_I.y))
+	{
+		return EPalmReason::EPenLead;
+	}
+
+	return EPalmReason::ENone;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int PalmRejector::Update(int count_I, const WacomMTFinger *fingers_I, double timeMs_I)
+{
+	if (mContacts.empty() || !fingers_I)
+	{
+		return 0;
+	}
+
+	if (count_I > static_cast<int>(mReasons.size()))
+	{
+		mReasons.resize(count_I);
+	}
+
+	for (int index = 0; index < mCount; index++)
+	{
+		mContacts[index].seen = false;
+	}
+
+	int accepted = 0;
+	for (int index = 0; index < count_I; index++)
+	{
+		const WacomMTFinger &finger = fingers_I[index];
+		Contact *contact = FindContact(finger.FingerID);
+
+		// A lifting finger keeps the decision it had, and is forgotten.
+		if (finger.TouchState == WMTFingerStateNone || finger.TouchState == WMTFingerStateUp)
+		{
+			mReasons[index] = contact ? contact->reason : EPalmReason::ENone;
+			accepted += mReasons[index] == EPalmReason::ENone;
+			continue;
+		}
+
+		const bool isNew = !contact;
+		if (isNew)
+		{
+			if (mCount == static_cast<int>(mContacts.size()))
+			{
+				mReasons[index] = EPalmReason::ENone;
+				accepted++;
+				continue;
+			}
+
+			contact = &mContacts[mCount++];
+			contact->fingerID = finger.FingerID;
+			contact->downMs = timeMs_I;
+			contact->reason = EPalmReason::ENone;
+		}
+
+		contact->x = ToMillimetersX(finger.X);
+		contact->y = ToMillimetersY(finger.Y);
+		contact->seen = true;
+		if (contact->reason == EPalmReason::ENone)
+		{
+			contact->reason = Classify(finger, *contact, isNew, timeMs_I);
+		}
+
+		mReasons[index] = contact->reason;
+		accepted += mReasons[index] == EPalmReason::ENone;
+	}
+
+	for (int index = 0; index < mCount; )
+	{
+		if (!mContacts[index].seen)
+		{
+			mContacts[index] = mContacts[--mCount];
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	// Contacts that were down when the pen arrived are checked once its
+	// position is known.
+	if (mPenArrivedMs >= 0.0 && mPenKnown)
+	{
+		mPenArrivedMs = -1.0;
+	}
+
+	return accepted;
+}
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Rejection of palm and wrist contacts.
+//
+//		Each frame of fingers is checked against the driver's confidence,
+//		the size and elongation of each contact, and the pen: while the pen
+//		is in proximity, contacts around and below its tip are taken to be
+//		the hand holding it.  Contacts that touched down shortly before the
+//		pen came into proximity are rejected when it does.  Every contact
+//		gets a decision on the frame it appears; a rejected contact stays
+//		rejected until it lifts.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+#include <vector>
+
+// Contacts this large are palms: major axis, or ellipse area.
+#define PALM_MAJOR_MM				22.0f
+#define PALM_AREA_MM2				300.0f
+
+// Contacts this elongated, and at least PALM_ELONGATED_MM long, are the
+// edge of a hand.
+#define PALM_ELONGATION				2.0f
+#define PALM_ELONGATED_MM			12.0f
+
+// Around the pen: contacts within PALM_PEN_RADIUS_MM of the tip and no
+// more than PALM_PEN_ABOVE_MM above it.  The pen counts as present until
+// PALM_PEN_LINGER_MS after it leaves proximity, and contacts down up to
+// PALM_PEN_LEAD_MS before it arrives are rejected when it does.
+#define PALM_PEN_RADIUS_MM			120.0f
+#define PALM_PEN_ABOVE_MM			20.0f
+#define PALM_PEN_LINGER_MS			500.0
+#define PALM_PEN_LEAD_MS			250.0
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class EPalmReason
+{
+	ENone,
+	EConfidence,		// not confident according to the driver
+	ESize,
+	EShape,
+	EPen,					// near the pen when it touched down
+	EPenLead				// near the pen, shortly before it arrived
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class PalmRejector
+{
+public:
+	PalmRejector();
+
+	// Sets the millimeter scale of the device's finger positions and sizes,
+	// and makes room for its FingerMax fingers.  Clears the state.
+	void Configure(const WacomMTCapability &caps_I);
+	int FingerMax(void) const { return static_cast<int>(mContacts.size()); }
+
+	// Pen events, on the same millisecond clock as the frames.  Positions
+	// are in millimeters on the touch sensor (see Configure).
+	void PenProximity(bool entering_I, double timeMs_I);
+	void PenPacket(float xMM_I, float yMM_I, double timeMs_I);
+
+	// Decides on a frame of fingers.  Returns the number accepted.
+	int Update(int count_I, const WacomMTFinger *fingers_I, double timeMs_I);
+
+	// Decisions on the fingers of the last frame, by index.
+	bool Accepted(int index_I) const { return mReasons[index_I] == EPalmReason::ENone; }
+	EPalmReason Reason(int index_I) const { return mReasons[index_I]; }
+
+	// Millimeters on the sensor of a position in finger units, to convert
+	// the pen's position with.
+	float ToMillimetersX(float x_I) const { return (x_I - mOriginX) * mScaleX; }
+	float ToMillimetersY(float y_I) const { return (y_I - mOriginY) * mScaleY; }
+
+private:
+	struct Contact
+	{
+		int				fingerID;
+		double			downMs;
+		float				x;
+		float				y;
+		EPalmReason		reason;
+		bool				seen;
+	};
+
+	Contact *FindContact(int fingerID_I);
+	bool PenPresent(double timeMs_I) const;
+	bool NearPen(float x_I, float y_I) const;
+	EPalmReason Classify(const WacomMTFinger &finger_I, const Contact &contact_I, bool isNew_I, double timeMs_I) const;
+
+	float							mOriginX;
+	float							mOriginY;
+	float							mScaleX;
+	float							mScaleY;
+	float							mSizeScaleX;	// for finger sizes up to 1.0
+	float							mSizeScaleY;
+	float							mPixelPitchX;	// for larger finger sizes
+	float							mPixelPitchY;
+
+	std::vector<Contact>		mContacts;		// the first mCount are down
+	int							mCount;
+	std::vector<EPalmReason>	mReasons;
+
+	// Pen: in proximity, or the time it left; its last position, if any;
+	// and the time it arrived, until the next frame has checked it.
+	bool							mPenInProximity;
+	double						mPenLeftMs;
+	bool							mPenKnown;
+	float							mPenX;
+	float							mPenY;
+	double						mPenArrivedMs;
+};
@@ -0,0 +1,2901 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		The benchmarks of TouchBenchmark.h, which also run headless on Linux.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#if defined(_WIN32)
+	#if !defined(NOMINMAX)
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#endif
+
+#include "PortableBenchmark.h"
+#include "BlobMoments.h"
+#include "DeviceRegistry.h"
+#include "FingerTracks.h"
+#include "Gestures.h"
+#include "HitRegions.h"
+#include "InputTimeline.h"
+#include "PalmRejection.h"
+#include "RawBlobs.h"
+#include "RawFilter.h"
+#include "RawHeatmap.h"
+#include "TouchFrameQueue.h"
+#include "TouchTransform.h"
+#include "WacomMultiTouch.h"
+#include "WacomMTStandIn/WacomMTStandIn.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+// Delivery latency benchmark: the stand-in's finger rate, the seconds
+// measured at each window buffer depth, and the load of the window thread,
+// a stall every so often as a paint or a resize would hold it.  The window
+// gets DELIVERY_BENCH_DRAIN_MS at most to catch up after each run.
+#define DELIVERY_BENCH_RATE_HZ		240
+#define DELIVERY_BENCH_SECONDS		5
+#define DELIVERY_BENCH_STALL_MS		20
+#define DELIVERY_BENCH_STALL_EVERY_MS	250
+#define DELIVERY_BENCH_DRAIN_MS		500
+static const int kBufferDepths[] = { 1, 2, 4, 8, 16, 32 };
+
+// Hit region join stress: the stand-in's finger rate and fingers, the
+// columns the display is split into, one hit region each, and the seconds
+// run with the parts joined and taken as frames.
+#define JOIN_STRESS_RATE_HZ			240
+#define JOIN_STRESS_FINGERS			5
+#define JOIN_STRESS_REGIONS			4
+#define JOIN_STRESS_SECONDS			3
+
+// Touch queue re-plug stress: seconds of plugging stand-in devices in and
+// out, each with an ID not used before, their finger rate, the most plugged
+// in at once and the time between two plugs.
+#define REPLUG_STRESS_SECONDS		3
+#define REPLUG_STRESS_RATE_HZ		1000
+#define REPLUG_STRESS_DEVICES		4
+#define REPLUG_STRESS_PLUG_MS		3
+
+// Synthetic load of the queue benchmark: devices delivering frames of
+// fingers at the given rate, each on its own driver thread.
+#define QUEUE_BENCH_DEVICES			2
+#define QUEUE_BENCH_FINGERS			10
+#define QUEUE_BENCH_RATE_HZ			240
+#define QUEUE_BENCH_SECONDS			2
+
+// Drawing cost per finger (microseconds) simulated by the queue benchmark,
+// from a cheap ellipse to the traced, text-labelled ellipse DrawFingerData
+// draws under a debugger.
+static const double kDrawCostUs[] = { 20.0, 100.0, 400.0 };
+
+// Blobs per frame, and points per blob (BlobPointsMax), of the blob moments
+// benchmark; each size is timed over about MOMENTS_BENCH_POINTS points.
+#define MOMENTS_BENCH_BLOBS			10
+#define MOMENTS_BENCH_POINTS			4000000
+static const int kBlobPoints[] = { 16, 64, 256, 1024 };
+
+// Raw blobs benchmark: frames timed per grid of kScanSizes.
+#define RAW_BENCH_FRAMES				400
+
+// Raw filter benchmark: standard deviation of the synthetic sensor noise,
+// in counts, untouched frames before the contacts come in, and the time
+// per frame aimed for.
+#define FILTER_BENCH_NOISE			2.0
+#define FILTER_BENCH_WARMUP			16
+#define FILTER_BENCH_TARGET_US		50.0
+
+// Gesture benchmark: frame rate of the scripted gestures, and length of the
+// run of ten moving fingers that the cost per frame is taken from.
+#define GESTURE_BENCH_RATE_HZ		240
+#define GESTURE_BENCH_SECONDS		60
+
+// Palm rejection benchmark: sessions replayed, the touch frame rate and pen
+// packet interval, and the length of a session with the pen in proximity
+// from PALM_BENCH_PEN_IN_MS to PALM_BENCH_PEN_OUT_MS.
+#define PALM_BENCH_SESSIONS			2000
+#define PALM_BENCH_RATE_HZ			240
+#define PALM_BENCH_PACKET_MS			5.0
+#define PALM_BENCH_SESSION_MS		3000.0
+#define PALM_BENCH_PEN_IN_MS			800.0
+#define PALM_BENCH_PEN_OUT_MS		2400.0
+
+// Hit region benchmark: the window drag, with WM_MOVE at the mouse's rate
+// and the sample's timer, and the regions and points of the routing test.
+#define HIT_BENCH_DRAG_MS			5000
+#define HIT_BENCH_MOVE_HZ			125
+#define HIT_BENCH_TIMER_MS			16
+#define HIT_BENCH_REGIONS			64
+#define HIT_BENCH_POINTS			1000000
+
+// Touch transform benchmark: devices, fingers per frame and frame rate of
+// the load, and the seconds of it converted.
+#define TRANSFORM_BENCH_DEVICES		4
+#define TRANSFORM_BENCH_FINGERS		10
+#define TRANSFORM_BENCH_RATE_HZ		240
+#define TRANSFORM_BENCH_SECONDS		60
+
+// Device registry stress test: seconds of hot-plugging, the finger rate of
+// the stand-in's devices, the most devices plugged in at once and the time
+// between two plugs.
+#define REGISTRY_STRESS_SECONDS		10
+#define REGISTRY_STRESS_RATE_HZ		1000
+#define REGISTRY_STRESS_DEVICES		4
+#define REGISTRY_STRESS_PLUG_MS		3
+
+// Input timeline benchmark, simulated: the pen's rate, the offset and drift
+// of its driver clock, and its delivery delay (fixed, exponential, and a
+// stall of the window thread every so often); the touch devices' rates,
+// drift and callback delay; and the steps the consumer wakes at.  Pen and
+// touch come and go: the pen is in proximity 1.5 s out of 2, each device
+// touched 3 s out of 4, numbering only the frames it sends.
+#define TIMELINE_BENCH_SECONDS			60
+#define TIMELINE_BENCH_PEN_HZ				200
+#define TIMELINE_BENCH_PEN_OFFSET_MS		5000000.0
+#define TIMELINE_BENCH_PEN_DRIFT_PPM		150.0
+#define TIMELINE_BENCH_PEN_DELAY_MS		1.0
+#define TIMELINE_BENCH_PEN_JITTER_MS		1.5
+#define TIMELINE_BENCH_STALL_MS			15.0
+#define TIMELINE_BENCH_STALL_EVERY_MS	300.0
+#define TIMELINE_BENCH_TOUCH_DRIFT_PPM	-80.0
+#define TIMELINE_BENCH_TOUCH_DELAY_MS	2.0
+#define TIMELINE_BENCH_TOUCH_JITTER_MS	0.7
+#define TIMELINE_BENCH_STEP_MS			0.25
+#define TIMELINE_BENCH_WARMUP_MS			1000.0
+static const int kTouchRatesHz[] = { 100, 240 };
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	double ElapsedMs(Clock::time_point start_I)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start_I).count();
+	}
+
+	// Delivery latency benchmark.  Feel frames carry no time stamp, so the
+	// callback and the window are registered for the same device at once:
+	// the callback times each frame, and its window message is measured
+	// from there.
+	struct DeliveryArrival
+	{
+		int						frame;
+		Clock::time_point		time;
+	};
+
+	struct DeliveryProbe
+	{
+		std::atomic<bool>					recording;
+		std::vector<DeliveryArrival>	callbacks;			// device thread
+		std::vector<DeliveryArrival>	messages;			// window thread
+		std::atomic<int>					lastMessageFrame;
+		Clock::time_point					nextStall;			// window thread
+		std::promise<void>				ready;
+
+#if defined(_WIN32)
+		HWND									hWnd;
+		DWORD									threadID;
+#else
+		// What the stand-in's post function delivers, in place of the
+		// window's message queue.
+		std::mutex							queueLock;
+		std::condition_variable			posted;
+		std::deque<void *>				queue;				// under queueLock
+		bool									stop;					// under queueLock
+#endif
+	};
+
+	struct DeliveryResult
+	{
+		int						bufferDepth;
+		size_t					frames;				// timed by the callback
+		size_t					gaps;					// frame numbers the callback skipped
+		double					intervalJitterUs;	// of the callback's arrivals
+		size_t					stale;				// messages whose buffer held a later frame
+		std::vector<double>	latencyUs;			// message after callback, sorted
+	};
+
+	// The stand-in's own calls.  On Windows the sample may have loaded the
+	// driver's wacommt.dll instead, which has none of them; elsewhere the
+	// stand-in is linked in.
+	struct StandInCalls
+	{
+		WACOMMTSTANDINGETDEFAULTCONFIG				getDefaultConfig;
+		WACOMMTSTANDINSETCONFIG							setConfig;
+		WACOMMTSTANDINATTACHDEVICE						attachDevice;
+		WACOMMTSTANDINDETACHDEVICE						detachDevice;
+		WACOMMTSTANDINREGISTERFINGERREADPOST		registerPost;
+		WACOMMTSTANDINUNREGISTERFINGERREADPOST		unregisterPost;
+	};
+
+	bool FindStandIn(StandInCalls &calls_O)
+	{
+#if defined(_WIN32)
+		HMODULE library = GetModuleHandleA("wacommt.dll");
+		calls_O.getDefaultConfig = library ? reinterpret_cast<WACOMMTSTANDINGETDEFAULTCONFIG>(GetProcAddress(library, "WacomMTStandInGetDefaultConfig")) : nullptr;
+		calls_O.setConfig = library ? reinterpret_cast<WACOMMTSTANDINSETCONFIG>(GetProcAddress(library, "WacomMTStandInSetConfig")) : nullptr;
+		calls_O.attachDevice = library ? reinterpret_cast<WACOMMTSTANDINATTACHDEVICE>(GetProcAddress(library, "WacomMTStandInAttachDevice")) : nullptr;
+		calls_O.detachDevice = library ? reinterpret_cast<WACOMMTSTANDINDETACHDEVICE>(GetProcAddress(library, "WacomMTStandInDetachDevice")) : nullptr;
+		calls_O.registerPost = nullptr;
+		calls_O.unregisterPost = nullptr;
+		return calls_O.getDefaultConfig && calls_O.setConfig && calls_O.attachDevice && calls_O.detachDevice;
+#else
+		calls_O.getDefaultConfig = WacomMTStandInGetDefaultConfig;
+		calls_O.setConfig = WacomMTStandInSetConfig;
+		calls_O.attachDevice = WacomMTStandInAttachDevice;
+		calls_O.detachDevice = WacomMTStandInDetachDevice;
+		calls_O.registerPost = WacomMTStandInRegisterFingerReadPost;
+		calls_O.unregisterPost = WacomMTStandInUnRegisterFingerReadPost;
+		return true;
+#endif
+	}
+
+	int DeliveryFingers(WacomMTFingerCollection *fingerData_I, void *userData_I)
+	{
+		DeliveryProbe &probe = *static_cast<DeliveryProbe *>(userData_I);
+		if (probe.recording.load())
+		{
+			const DeliveryArrival arrival = { fingerData_I->FrameNumber, Clock::now() };
+			probe.callbacks.push_back(arrival);
+		}
+		return 0;
+	}
+
+	// The window's WM_FINGERDATA.  If the library reused the message's
+	// buffer before it got here, the frame read is a later one.
+	void DeliveryMessage(DeliveryProbe &probe_IO, const WacomMTFingerCollection *fingerData_I)
+	{
+		const DeliveryArrival arrival = { fingerData_I->FrameNumber, Clock::now() };
+		probe_IO.messages.push_back(arrival);
+		probe_IO.lastMessageFrame = arrival.frame;
+
+		if (arrival.time >= probe_IO.nextStall)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(DELIVERY_BENCH_STALL_MS));
+			probe_IO.nextStall = Clock::now() + std::chrono::milliseconds(DELIVERY_BENCH_STALL_EVERY_MS);
+		}
+	}
+
+#if defined(_WIN32)
+	LRESULT CALLBACK DeliveryWndProc(HWND hWnd_I, UINT message_I, WPARAM wParam_I, LPARAM lParam_I)
+	{
+		DeliveryProbe *probe = reinterpret_cast<DeliveryProbe *>(GetWindowLongPtr(hWnd_I, GWLP_USERDATA));
+		if (message_I == WM_FINGERDATA && probe && lParam_I)
+		{
+			DeliveryMessage(*probe, reinterpret_cast<const WacomMTFingerCollection *>(lParam_I));
+			return 0;
+		}
+		return DefWindowProc(hWnd_I, message_I, wParam_I, lParam_I);
+	}
+
+	// A message-only window on a thread of its own, like the sample's.
+	void RunDeliveryWindow(DeliveryProbe &probe_IO)
+	{
+		WNDCLASSEXW wcex = { sizeof(WNDCLASSEXW) };
+		wcex.lpfnWndProc = DeliveryWndProc;
+		wcex.hInstance = GetModuleHandle(NULL);
+		wcex.lpszClassName = L"WacomMTDeliveryBenchmark";
+		RegisterClassExW(&wcex);
+
+		probe_IO.hWnd = CreateWindowW(wcex.lpszClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wcex.hInstance, NULL);
+		SetWindowLongPtr(probe_IO.hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(&probe_IO));
+		probe_IO.threadID = GetCurrentThreadId();
+		probe_IO.ready.set_value();
+
+		MSG msg;
+		while (GetMessage(&msg, NULL, 0, 0) > 0)
+		{
+			DispatchMessage(&msg);
+		}
+
+		DestroyWindow(probe_IO.hWnd);
+		UnregisterClassW(wcex.lpszClassName, wcex.hInstance);
+	}
+
+	void StopDeliveryWindow(DeliveryProbe &probe_IO)
+	{
+		PostThreadMessage(probe_IO.threadID, WM_QUIT, 0, 0);
+	}
+#else
+	void PostDeliveryMessage(void *window_I, unsigned message_I, void *data_I)
+	{
+		DeliveryProbe &probe = *static_cast<DeliveryProbe *>(window_I);
+		if (message_I == WM_FINGERDATA)
+		{
+			std::lock_guard<std::mutex> lock(probe.queueLock);
+			probe.queue.push_back(data_I);
+			probe.posted.notify_one();
+		}
+	}
+
+	void RunDeliveryWindow(DeliveryProbe &probe_IO)
+	{
+		probe_IO.ready.set_value();
+
+		std::unique_lock<std::mutex> lock(probe_IO.queueLock);
+		for (;;)
+		{
+			probe_IO.posted.wait(lock, [&]() { return probe_IO.stop || !probe_IO.queue.empty(); });
+			if (probe_IO.stop)
+			{
+				break;
+			}
+
+			void *data = probe_IO.queue.front();
+			probe_IO.queue.pop_front();
+			lock.unlock();
+			DeliveryMessage(probe_IO, static_cast<const WacomMTFingerCollection *>(data));
+			lock.lock();
+		}
+	}
+
+	void StopDeliveryWindow(DeliveryProbe &probe_IO)
+	{
+		std::lock_guard<std::mutex> lock(probe_IO.queueLock);
+		probe_IO.stop = true;
+		probe_IO.posted.notify_one();
+	}
+#endif
+
+	double MicrosecondsBetween(Clock::time_point from_I, Clock::time_point to_I)
+	{
+		return std::chrono::duration<double, std::micro>(to_I - from_I).count();
+	}
+
+	// Matches the messages to the callbacks' frames.  A frame whose message
+	// never carried it was dropped; a message that carried a frame already
+	// seen had its buffer overwritten.
+	void MeasureDelivery(const DeliveryProbe &probe_I, DeliveryResult &result_O)
+	{
+		const std::vector<DeliveryArrival> &callbacks = probe_I.callbacks;
+		result_O.frames = callbacks.size();
+		result_O.gaps = 0;
+
+		double sum = 0.0;
+		double sumSquares = 0.0;
+		std::map<int, Clock::time_point> timed;
+		for (size_t idx = 0; idx < callbacks.size(); idx++)
+		{
+			timed[callbacks[idx].frame] = callbacks[idx].time;
+			if (idx > 0)
+			{
+				const int step = callbacks[idx].frame - callbacks[idx - 1].frame;
+				result_O.gaps += step > 1 ? step - 1 : 0;
+
+				const double intervalUs = MicrosecondsBetween(callbacks[idx - 1].time, callbacks[idx].time);
+				sum += intervalUs;
+				sumSquares += intervalUs * intervalUs;
+			}
+		}
+		const double intervals = static_cast<double>(std::max(callbacks.size(), static_cast<size_t>(2)) - 1);
+		result_O.intervalJitterUs = sqrt(std::max(sumSquares / intervals - (sum / intervals) * (sum / intervals), 0.0));
+
+		result_O.stale = 0;
+		result_O.latencyUs.clear();
+		std::set<int> seen;
+		for (const DeliveryArrival &message : probe_I.messages)
+		{
+			if (!seen.insert(message.frame).second)
+			{
+				result_O.stale++;
+				continue;
+			}
+
+			std::map<int, Clock::time_point>::const_iterator found = timed.find(message.frame);
+			if (found != timed.end())
+			{
+				result_O.latencyUs.push_back(MicrosecondsBetween(found->second, message.time));
+			}
+		}
+		std::sort(result_O.latencyUs.begin(), result_O.latencyUs.end());
+	}
+
+	// Hit region join stress.  Each region's callback queues its part of
+	// the frame, and a consumer feeds what it takes to a FingerTrackStore,
+	// as the sample's render thread does.
+	struct JoinProbe
+	{
+		TouchFrameQueue				queue;
+		bool								join;
+	};
+
+	struct JoinRegion
+	{
+		JoinProbe						*probe;
+		int								regionID;
+	};
+
+	struct JoinResult
+	{
+		unsigned long long			frames;
+		unsigned long long			fingers;			// down or held
+		unsigned long long			cuts;				// tracks a frame left out before the finger lifted
+		TouchFrameStats				stats;
+	};
+
+	// Touch queue re-plug stress.  The consumer counts the frames it takes
+	// per device.
+	struct ReplugProbe
+	{
+		TouchFrameQueue				queue;
+		std::mutex						lock;
+		std::map<int, unsigned long long>	taken;		// by device; under lock
+	};
+
+	int ReplugFingers(WacomMTFingerCollection *fingerData_I, void *userData_I)
+	{
+		static_cast<ReplugProbe *>(userData_I)->queue.PushFingers(fingerData_I);
+		return 0;
+	}
+
+	int JoinFingers(WacomMTFingerCollection *fingerData_I, void *userData_I)
+	{
+		const JoinRegion &region = *static_cast<const JoinRegion *>(userData_I);
+		region.probe->queue.PushFingers(fingerData_I, 0.0, region.probe->join ? region.regionID : 0);
+		return 0;
+	}
+
+	void RunJoin(int deviceID_I, const WacomMTCapability &caps_I, bool join_I, JoinResult &result_O)
+	{
+		std::unique_ptr<JoinProbe> probe(new JoinProbe());
+		probe->queue.Allocate(TouchFrameLimits());
+		probe->join = join_I;
+
+		FingerTrackStore tracks;
+		tracks.Allocate(std::max(caps_I.FingerMax, 1));
+		std::set<int> down;						// fingers down in the last frame taken
+		std::set<int> taken;
+		result_O = JoinResult();
+
+		// Columns of the display, IDs from 1 as the HitRegionManager's.
+		JoinRegion regions[JOIN_STRESS_REGIONS];
+		WacomMTHitRect rects[JOIN_STRESS_REGIONS];
+		const float width = static_cast<float>(caps_I.LogicalWidth) / JOIN_STRESS_REGIONS;
+		for (int idx = 0; idx < JOIN_STRESS_REGIONS; idx++)
+		{
+			regions[idx].probe = probe.get();
+			regions[idx].regionID = idx + 1;
+			rects[idx].originX = static_cast<float>(caps_I.LogicalOriginX) + idx * width;
+			rects[idx].originY = static_cast<float>(caps_I.LogicalOriginY);
+			rects[idx].width = width;
+			rects[idx].height = static_cast<float>(caps_I.LogicalHeight);
+		}
+
+		std::atomic<bool> stop(false);
+		const Clock::time_point start = Clock::now();
+		std::thread consumer([&]()
+		{
+			// A finger down in one frame is in the next, held or lifted;
+			// if a frame leaves it out, its track ends there.
+			const auto take = [&](const TouchFrame &frame_I)
+			{
+				tracks.Update(frame_I.frameNumber, frame_I.count, frame_I.fingers.data());
+				result_O.frames++;
+
+				taken.clear();
+				for (int idx = 0; idx < frame_I.count; idx++)
+				{
+					taken.insert(frame_I.fingers[idx].FingerID);
+				}
+				for (int fingerID : down)
+				{
+					result_O.cuts += taken.count(fingerID) ? 0 : 1;
+				}
+
+				down.clear();
+				for (int idx = 0; idx < frame_I.count; idx++)
+				{
+					const WacomMTFinger &finger = frame_I.fingers[idx];
+					if (finger.TouchState == WMTFingerStateDown || finger.TouchState == WMTFingerStateHold)
+					{
+						down.insert(finger.FingerID);
+						result_O.fingers++;
+					}
+				}
+			};
+
+			while (!stop)
+			{
+				probe->queue.ConsumeLatest(ElapsedMs(start), take);
+				std::this_thread::sleep_for(std::chrono::microseconds(250));
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			probe->queue.ConsumeLatest(ElapsedMs(start), take);
+		});
+
+		for (int idx = 0; idx < JOIN_STRESS_REGIONS; idx++)
+		{
+			WacomMTRegisterFingerReadCallback(deviceID_I, &rects[idx], WMTProcessingModeObserver, JoinFingers, &regions[idx]);
+		}
+		std::this_thread::sleep_for(std::chrono::seconds(JOIN_STRESS_SECONDS));
+		for (int idx = 0; idx < JOIN_STRESS_REGIONS; idx++)
+		{
+			WacomMTUnRegisterFingerReadCallback(deviceID_I, &rects[idx], WMTProcessingModeObserver, &regions[idx]);
+		}
+
+		stop = true;
+		consumer.join();
+		result_O.stats = probe->queue.Stats();
+	}
+
+	enum class EDelivery
+	{
+		EDrawInCallback,
+		ERenderThread
+	};
+
+	struct QueueResult
+	{
+		std::vector<double>	callbackUs;
+		double					deliveredHz;
+		unsigned long long	frames;
+		unsigned long long	rendered;
+		unsigned long long	superseded;
+		unsigned long long	dropped;
+	};
+
+	// Busy waits until the clock reaches until_I.
+	void SpinUntil(Clock::time_point until_I)
+	{
+		while (Clock::now() < until_I)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// An auto-reset event, as CreateEvent makes: Set wakes one Wait, or the
+	// next one to come.
+	class FrameSignal
+	{
+	public:
+		FrameSignal() : mSet(false) {}
+
+		void Set(void)
+		{
+			std::lock_guard<std::mutex> lock(mLock);
+			mSet = true;
+			mChanged.notify_one();
+		}
+
+		void Wait(int timeoutMs_I)
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mChanged.wait_for(lock, std::chrono::milliseconds(timeoutMs_I), [&]() { return mSet; });
+			mSet = false;
+		}
+
+	private:
+		std::mutex						mLock;
+		std::condition_variable		mChanged;
+		bool								mSet;						// under mLock
+	};
+
+	// Ten fingers circling around the middle of an opaque tablet.
+	void MakeFingerFrame(int deviceID_I, int frameNumber_I,
+		std::vector<WacomMTFinger> &fingers_O, WacomMTFingerCollection &collection_O)
+	{
+		const double angle = frameNumber_I * 2.0 * 3.14159265358979 / QUEUE_BENCH_RATE_HZ;
+		for (int idx = 0; idx < static_cast<int>(fingers_O.size()); idx++)
+		{
+			WacomMTFinger &finger = fingers_O[idx];
+			finger = WacomMTFinger();
+			finger.FingerID = idx + 1;
+			finger.X = static_cast<float>(0.5 + (0.1 + 0.03 * idx) * cos(angle + idx));
+			finger.Y = static_cast<float>(0.5 + (0.1 + 0.03 * idx) * sin(angle + idx));
+			finger.Width = 0.02f;
+			finger.Height = 0.03f;
+			finger.Confidence = true;
+			finger.TouchState = frameNumber_I ? WMTFingerStateHold : WMTFingerStateDown;
+		}
+
+		collection_O.Version = WACOM_MULTI_TOUCH_API_VERSION;
+		collection_O.DeviceID = deviceID_I;
+		collection_O.FrameNumber = frameNumber_I;
+		collection_O.FingerCount = static_cast<int>(fingers_O.size());
+		collection_O.Fingers = fingers_O.data();
+	}
+
+	// Elliptic contours of pointCount_I points at screen coordinates, with
+	// uneven sensitivity along each contour.
+	void MakeBlobFrame(int pointCount_I, std::vector<WacomMTBlob> &blobs_O,
+		std::vector<WacomMTBlobPoint> &points_O, WacomMTBlobAggregate &aggregate_O)
+	{
+		std::mt19937 random(pointCount_I);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		blobs_O.resize(MOMENTS_BENCH_BLOBS);
+		points_O.resize(MOMENTS_BENCH_BLOBS * pointCount_I);
+		for (int blobIndex = 0; blobIndex < MOMENTS_BENCH_BLOBS; blobIndex++)
+		{
+			const float centerX = 200.0f + 3400.0f * unit(random);
+			const float centerY = 200.0f + 1700.0f * unit(random);
+			const float radiusX = 20.0f + 60.0f * unit(random);
+			const float radiusY = 20.0f + 60.0f * unit(random);
+			const float tilt = 3.14159265f * unit(random);
+
+			WacomMTBlob &blob = blobs_O[blobIndex];
+			blob = WacomMTBlob();
+			blob.BlobID = blobIndex + 1;
+			blob.Confidence = true;
+			blob.BlobType = WMTBlobTypePrimary;
+			blob.PointCount = pointCount_I;
+			blob.BlobPoints = &points_O[blobIndex * pointCount_I];
+
+			for (int idx = 0; idx < pointCount_I; idx++)
+			{
+				const float angle = 2.0f * 3.14159265f * idx / pointCount_I;
+				const float x = radiusX * cosf(angle);
+				const float y = radiusY * sinf(angle);
+				blob.BlobPoints[idx].X = centerX + x * cosf(tilt) - y * sinf(tilt);
+				blob.BlobPoints[idx].Y = centerY + x * sinf(tilt) + y * cosf(tilt);
+				blob.BlobPoints[idx].Sensitivity = static_cast<unsigned short>(50 + 400 * unit(random));
+			}
+			blob.X = centerX;
+			blob.Y = centerY;
+		}
+
+		aggregate_O = WacomMTBlobAggregate();
+		aggregate_O.Version = WACOM_MULTI_TOUCH_API_VERSION;
+		aggregate_O.DeviceID = 1;
+		aggregate_O.BlobCount = MOMENTS_BENCH_BLOBS;
+		aggregate_O.BlobArray = blobs_O.data();
+	}
+
+	// Nanoseconds per point of compute_I over the snapshot.
+	template <typename Compute>
+	double TimeMoments(Compute compute_I, const BlobSnapshot &snapshot_I, int iterations_I, std::vector<BlobMoments> &moments_O)
+	{
+		compute_I(snapshot_I, moments_O);
+		const Clock::time_point start = Clock::now();
+		for (int iteration = 0; iteration < iterations_I; iteration++)
+		{
+			compute_I(snapshot_I, moments_O);
+		}
+		return ElapsedMs(start) * 1e6 / (static_cast<double>(iterations_I) * snapshot_I.PointCount());
+	}
+
+	// A frame of a sensor whose cells each have their own untouched level,
+	// with gaussian noise.  From frame FILTER_BENCH_WARMUP on, contacts the
+	// size of MakeRawFrame's drift slowly across it.
+	void MakeNoisyRawFrame(int width_I, int height_I, int frame_I, const std::vector<unsigned short> &baseline_I,
+		std::mt19937 &random_IO, std::vector<unsigned short> &raw_O)
+	{
+		std::normal_distribution<double> noise(0.0, FILTER_BENCH_NOISE);
+		const double sigma = 1.2 * width_I / 64.0;
+
+		raw_O.resize(width_I * height_I);
+		for (size_t cell = 0; cell < raw_O.size(); cell++)
+		{
+			raw_O[cell] = static_cast<unsigned short>(std::max(baseline_I[cell] + floor(noise(random_IO) + 0.5), 0.0));
+		}
+
+		if (frame_I < FILTER_BENCH_WARMUP)
+		{
+			return;
+		}
+
+		for (int idx = 0; idx < RAW_BENCH_CONTACTS; idx++)
+		{
+			const double phase = 0.01 * frame_I + idx;
+			const double centerX = width_I * (idx % 5 + 0.5 + 0.2 * sin(phase)) / 5.0;
+			const double centerY = height_I * (idx / 5 + 0.5 + 0.2 * cos(phase)) / 2.0;
+
+			const int reach = static_cast<int>(ceil(3.0 * sigma));
+			for (int y = std::max(static_cast<int>(centerY) - reach, 0); y < std::min(static_cast<int>(centerY) + reach + 1, height_I); y++)
+			{
+				for (int x = std::max(static_cast<int>(centerX) - reach, 0); x < std::min(static_cast<int>(centerX) + reach + 1, width_I); x++)
+				{
+					const double dx = x + 0.5 - centerX;
+					const double dy = y + 0.5 - centerY;
+					unsigned short &cell = raw_O[y * width_I + x];
+					cell = static_cast<unsigned short>(std::min(cell + 200.0 * exp(-(dx * dx + dy * dy) / (2.0 * sigma * sigma)), 65535.0));
+				}
+			}
+		}
+	}
+
+	// Result of playing a scripted gesture to a GestureRecognizer.
+	struct GestureRun
+	{
+		int		eventFrame;			// first event of the wanted type, or -1
+		double	updateUs;			// mean time per update
+		double	updateMaxUs;
+	};
+
+	// Plays fingerCount_I fingers for frames_I frames: down on frame 0, at
+	// position_I(finger, seconds) from then on, and up on the last frame.
+	GestureRun PlayGesture(GestureRecognizer &recognizer_IO, int fingerCount_I, int frames_I,
+		const std::function<void(int, double, float &, float &)> &position_I, EGestureType wanted_I)
+	{
+		GestureRun run = { -1, 0.0, 0.0 };
+		std::vector<WacomMTFinger> fingers(fingerCount_I);
+		for (int frame = 0; frame < frames_I; frame++)
+		{
+			const double seconds = static_cast<double>(frame) / GESTURE_BENCH_RATE_HZ;
+			for (int index = 0; index < fingerCount_I; index++)
+			{
+				WacomMTFinger &finger = fingers[index];
+				finger = WacomMTFinger();
+				finger.FingerID = index + 1;
+				finger.Confidence = true;
+				finger.TouchState = frame == 0 ? WMTFingerStateDown : frame == frames_I - 1 ? WMTFingerStateUp : WMTFingerStateHold;
+				position_I(index, seconds, finger.X, finger.Y);
+			}
+
+			const Clock::time_point start = Clock::now();
+			recognizer_IO.Update(frame, fingerCount_I, fingers.data(), seconds * 1e3);
+			const double us = ElapsedMs(start) * 1e3;
+			run.updateUs += us / frames_I;
+			run.updateMaxUs = std::max(run.updateMaxUs, us);
+
+			for (const GestureEvent &event : recognizer_IO.Events())
+			{
+				if (run.eventFrame < 0 && event.type == wanted_I)
+				{
+					run.eventFrame = frame;
+				}
+			}
+		}
+		return run;
+	}
+
+	// A scripted contact of the palm rejection benchmark, in millimeters.  A
+	// palm grows to its size over its first 30 ms.
+	struct PalmContact
+	{
+		double	downMs;
+		double	upMs;
+		float		x;
+		float		y;
+		float		velocityX;			// mm/s
+		float		velocityY;
+		float		major;
+		float		minor;
+		bool		confident;
+		bool		palm;
+	};
+
+	// A scripted session: the pen writing from PALM_BENCH_PEN_IN_MS to
+	// PALM_BENCH_PEN_OUT_MS, or touch alone.
+	struct PalmSession
+	{
+		bool							pen;
+		float							penX;					// at PALM_BENCH_PEN_IN_MS
+		float							penY;
+		std::vector<PalmContact>	contacts;
+	};
+
+	// Pen tip of a writing session at timeMs_I, moving right at 40 mm/s with
+	// a small vertical wave.
+	void PalmPenAt(const PalmSession &session_I, double timeMs_I, float &x_O, float &y_O)
+	{
+		const double seconds = (std::max(timeMs_I, PALM_BENCH_PEN_IN_MS) - PALM_BENCH_PEN_IN_MS) / 1e3;
+		x_O = static_cast<float>(session_I.penX + 40.0 * seconds);
+		y_O = static_cast<float>(session_I.penY + 3.0 * sin(20.0 * seconds));
+	}
+
+	// Makes a session: 70% are writing, with the hand's palm landing from
+	// 150 ms before the pen comes into proximity to 300 ms after, below and
+	// right of the tip, and sometimes a wrist, a knuckle near the tip, the
+	// other hand's fingers away from it, or one of them close to it.  The
+	// rest are touch alone, fingers with now and then a resting palm.  Half
+	// of the palms lack the driver's confidence.
+	PalmSession MakePalmSession(std::mt19937 &random_IO)
+	{
+		auto uniform = [&](double low_I, double high_I)
+		{
+			return std::uniform_real_distribution<double>(low_I, high_I)(random_IO);
+		};
+		auto chance = [&](double probability_I) { return uniform(0.0, 1.0) < probability_I; };
+
+		auto contact = [&](double downMs_I, double upMs_I, double x_I, double y_I, double major_I, double minor_I, bool palm_I)
+		{
+			PalmContact made = {};
+			made.downMs = downMs_I;
+			made.upMs = std::min(upMs_I, PALM_BENCH_SESSION_MS);
+			made.x = static_cast<float>(x_I);
+			made.y = static_cast<float>(y_I);
+			made.major = static_cast<float>(major_I);
+			made.minor = static_cast<float>(minor_I);
+			made.confident = !palm_I || major_I < PALM_MAJOR_MM || chance(0.5);
+			made.palm = palm_I;
+			return made;
+		};
+
+		PalmSession session;
+		session.pen = chance(0.7);
+		session.penX = static_cast<float>(uniform(100.0, 250.0));
+		session.penY = static_cast<float>(uniform(60.0, 180.0));
+
+		if (!session.pen)
+		{
+			const int fingers = 1 + static_cast<int>(uniform(0.0, 4.0));
+			for (int index = 0; index < fingers; index++)
+			{
+				const double downMs = uniform(0.0, 2500.0);
+				const double size = uniform(7.0, 11.0);
+				PalmContact finger = contact(downMs, downMs + uniform(60.0, 800.0), uniform(40.0, 430.0), uniform(30.0, 230.0), size, size * 0.85, false);
+				finger.velocityX = static_cast<float>(uniform(-100.0, 100.0));
+				finger.velocityY = static_cast<float>(uniform(-100.0, 100.0));
+				session.contacts.push_back(finger);
+			}
+			if (chance(0.3))
+			{
+				const double downMs = uniform(0.0, 1000.0);
+				session.contacts.push_back(contact(downMs, downMs + 1500.0, uniform(60.0, 400.0), uniform(60.0, 200.0), uniform(25.0, 40.0), uniform(15.0, 25.0), true));
+			}
+			return session;
+		}
+
+		// The hand moves with the pen.
+		auto handContact = [&](double downMs_I, double upMs_I, double dx_I, double dy_I, double major_I, double minor_I, bool palm_I)
+		{
+			float x = 0.0f;
+			float y = 0.0f;
+			PalmPenAt(session, downMs_I, x, y);
+			PalmContact made = contact(downMs_I, upMs_I, x + dx_I, y + dy_I, major_I, minor_I, palm_I);
+			made.velocityX = downMs_I < PALM_BENCH_PEN_IN_MS ? 0.0f : 40.0f;
+			return made;
+		};
+
+		const double palmMs = PALM_BENCH_PEN_IN_MS + uniform(-150.0, 300.0);
+		session.contacts.push_back(handContact(palmMs, PALM_BENCH_PEN_OUT_MS + uniform(0.0, 300.0),
+			uniform(0.0, 50.0), uniform(25.0, 60.0), uniform(24.0, 40.0), uniform(14.0, 22.0), true));
+
+		if (chance(0.25))
+		{
+			const double wristMs = palmMs + uniform(50.0, 300.0);
+			session.contacts.push_back(handContact(wristMs, PALM_BENCH_PEN_OUT_MS,
+				uniform(40.0, 90.0), uniform(70.0, 110.0), uniform(30.0, 45.0), uniform(18.0, 25.0), true));
+		}
+
+		if (chance(0.3))
+		{
+			const double knuckleMs = PALM_BENCH_PEN_IN_MS + uniform(100.0, 1200.0);
+			session.contacts.push_back(handContact(knuckleMs, knuckleMs + uniform(50.0, 400.0),
+				uniform(-25.0, 15.0), uniform(15.0, 40.0), uniform(8.0, 11.0), uniform(6.0, 8.0), true));
+		}
+
+		const int taps = static_cast<int>(uniform(0.0, 4.0));
+		for (int index = 0; index < taps; index++)
+		{
+			const double downMs = uniform(300.0, 2700.0);
+			float penX = 0.0f;
+			float penY = 0.0f;
+			PalmPenAt(session, downMs, penX, penY);
+			for (int attempt = 0; attempt < 20; attempt++)
+			{
+				const double x = uniform(10.0, 466.0);
+				const double y = uniform(10.0, 258.0);
+				if ((x - penX) * (x - penX) + (y - penY) * (y - penY) > 140.0 * 140.0)
+				{
+					const double size = uniform(7.0, 11.0);
+					session.contacts.push_back(contact(downMs, downMs + uniform(60.0, 400.0), x, y, size, size * 0.85, false));
+					break;
+				}
+			}
+		}
+
+		if (chance(0.1))
+		{
+			const double downMs = PALM_BENCH_PEN_IN_MS + uniform(0.0, 1400.0);
+			session.contacts.push_back(handContact(downMs, downMs + uniform(60.0, 400.0),
+				uniform(-110.0, -60.0), uniform(-15.0, 10.0), 9.0, 8.0, false));
+			session.contacts.back().velocityX = 0.0f;
+		}
+
+		return session;
+	}
+
+	// Decisions on the contacts of palm rejection replays: palms rejected
+	// and fingers accepted, or not.
+	struct PalmScore
+	{
+		int		palmsRejected;
+		int		palmsAccepted;
+		int		fingersRejected;
+		int		fingersAccepted;
+
+		void Add(bool palm_I, bool rejected_I)
+		{
+			(palm_I ? (rejected_I ? palmsRejected : palmsAccepted) : (rejected_I ? fingersRejected : fingersAccepted))++;
+		}
+
+		void Report(std::stringstream &report_IO, const char *name_I) const
+		{
+			const int rejected = palmsRejected + fingersRejected;
+			const int palms = palmsRejected + palmsAccepted;
+			report_IO << "  " << name_I << ": precision " << (rejected ? 100.0 * palmsRejected / rejected : 100.0)
+				<< "%, recall " << (palms ? 100.0 * palmsRejected / palms : 100.0) << "% ("
+				<< palmsRejected << " of " << palms << " palms, " << fingersRejected << " of "
+				<< fingersRejected + fingersAccepted << " fingers rejected)\n";
+		}
+	};
+
+	// Counts the driver calls of a HitRegionManager.
+	class CountingDriver : public HitRegionDriver
+	{
+	public:
+		CountingDriver() : calls(0) {}
+
+		WacomMTError Register(int, int, const WacomMTHitRect &, WacomMTProcessingMode) override { calls++; return WMTErrorSuccess; }
+		WacomMTError Move(int, int, const WacomMTHitRect &, const WacomMTHitRect &, WacomMTProcessingMode) override { calls++; return WMTErrorSuccess; }
+		WacomMTError Unregister(int, int, const WacomMTHitRect &, WacomMTProcessingMode) override { calls++; return WMTErrorSuccess; }
+
+		int		calls;
+	};
+
+	// Drags a window of regionCount_I regions for HIT_BENCH_DRAG_MS and
+	// returns the driver calls made, not counting the registration.  Every
+	// WM_MOVE updates the driver at once if eager_I, as the sample used to;
+	// otherwise the manager's timer runs and WM_EXITSIZEMOVE ends the drag.
+	int DragHitRegions(int regionCount_I, bool eager_I)
+	{
+		HitRegionManager regions;
+		for (int index = 0; index < regionCount_I; index++)
+		{
+			const WacomMTHitRect rect = { 0.0f, 32.0f * index, 800.0f, 32.0f };
+			regions.AddRegion(rect, WMTProcessingModeNone, 0.0);
+		}
+
+		CountingDriver driver;
+		regions.Attach(driver, 1);
+		driver.calls = 0;
+
+		const int movePeriodMs = 1000 / HIT_BENCH_MOVE_HZ;
+		for (int ms = 1; ms <= HIT_BENCH_DRAG_MS; ms++)
+		{
+			if (ms % movePeriodMs == 0)
+			{
+				regions.MoveWindow(100.0f + ms * 0.2f, 100.0f + ms * 0.1f, ms);
+				regions.Update(driver, ms, eager_I);
+			}
+			if (!eager_I && ms % HIT_BENCH_TIMER_MS == 0)
+			{
+				regions.Update(driver, ms);
+			}
+		}
+		regions.Update(driver, HIT_BENCH_DRAG_MS, true);
+		return driver.calls;
+	}
+
+	// The sample window's client area, as GetClientRect gives it.
+	struct ClientRect
+	{
+		long		left;
+		long		top;
+		long		right;
+		long		bottom;
+	};
+
+	// The conversion DrawFingerData made before it kept a TouchTransform per
+	// device: for each finger, lookups of the device's capabilities, the
+	// pixel pitch divided out, a branch on the device type, and
+	// ScreenToClient (here the subtraction it makes).
+	void ConvertUncached(std::map<int, WacomMTCapability> &caps_IO, int device_I, const ClientRect &client_I,
+		int count_I, const WacomMTFinger *fingers_I, TouchPoint *points_O)
+	{
+		for (int index = 0; index < count_I; index++)
+		{
+			const WacomMTFinger &finger = fingers_I[index];
+			const double horizontalPixelPitch = caps_IO[device_I].PhysicalSizeX / caps_IO[device_I].LogicalWidth;
+			const double verticalPixelPitch = caps_IO[device_I].PhysicalSizeY / caps_IO[device_I].LogicalHeight;
+
+			double x = finger.X;
+			double y = finger.Y;
+			if (caps_IO[device_I].Type == WMTDeviceTypeOpaque)
+			{
+				x = x * (static_cast<double>(client_I.right) - client_I.left) + client_I.left;
+				y = y * (static_cast<double>(client_I.bottom) - client_I.top) + client_I.top;
+			}
+
+			double widthMM = 0.0;
+			if (finger.Width > 0)
+			{
+				widthMM = finger.Width <= 1.0 ? finger.Width * caps_IO[device_I].PhysicalSizeX : finger.Width * horizontalPixelPitch;
+			}
+			double heightMM = 0.0;
+			if (finger.Height > 0)
+			{
+				heightMM = finger.Height <= 1.0 ? finger.Height * caps_IO[device_I].PhysicalSizeY : finger.Height * verticalPixelPitch;
+			}
+
+			TouchPoint &point = points_O[index];
+			point.clientX = static_cast<float>(x - client_I.left);
+			point.clientY = static_cast<float>(y - client_I.top);
+			point.widthMM = static_cast<float>(widthMM);
+			point.heightMM = static_cast<float>(heightMM);
+			point.radiusX = static_cast<float>(widthMM / horizontalPixelPitch / 2);
+			point.radiusY = static_cast<float>(heightMM / verticalPixelPitch / 2);
+		}
+	}
+
+	// Hot-plugging against the stand-in library.  The attach and detach
+	// callbacks queue the change for an applier thread, which updates the
+	// registry and (un)registers the finger callback, as the sample's window
+	// thread does.  Frames go through a TouchFrameQueue to a render thread
+	// that looks their device up, and another thread reads all the time.
+	struct DeviceChange
+	{
+		bool						attached;
+		WacomMTCapability		caps;
+	};
+
+	struct RegistryStress
+	{
+		DeviceRegistry						registry;
+		TouchFrameQueue					frames;
+		FrameSignal							frameReady;
+
+		std::mutex							changeLock;
+		std::condition_variable			changed;
+		std::deque<DeviceChange>		changes;				// under changeLock
+		bool									stopApplying;		// under changeLock
+		std::atomic<bool>					stopReading;
+
+		std::atomic<unsigned long long>	delivered;
+		unsigned long long				lookedUp;			// render thread
+		unsigned long long				detached;			// render thread
+		unsigned long long				reads;				// reader thread
+		std::atomic<unsigned long long>	wrong;
+	};
+
+	void StressAttach(WacomMTCapability deviceInfo_I, void *userData_I)
+	{
+		RegistryStress &stress = *static_cast<RegistryStress *>(userData_I);
+		const DeviceChange change = { true, deviceInfo_I };
+		std::lock_guard<std::mutex> lock(stress.changeLock);
+		stress.changes.push_back(change);
+		stress.changed.notify_one();
+	}
+
+	void StressDetach(int deviceID_I, void *userData_I)
+	{
+		RegistryStress &stress = *static_cast<RegistryStress *>(userData_I);
+		DeviceChange change = { false, WacomMTCapability() };
+		change.caps.DeviceID = deviceID_I;
+		std::lock_guard<std::mutex> lock(stress.changeLock);
+		stress.changes.push_back(change);
+		stress.changed.notify_one();
+	}
+
+	int StressFingers(WacomMTFingerCollection *fingerData_I, void *userData_I)
+	{
+		RegistryStress &stress = *static_cast<RegistryStress *>(userData_I);
+		stress.delivered.fetch_add(1, std::memory_order_relaxed);
+		if (stress.frames.PushFingers(fingerData_I))
+		{
+			stress.frameReady.Set();
+		}
+		return 0;
+	}
+
+	// What the stand-in's devices report (see MakeCaps in WacomMTStandIn).
+	bool StressCapsValid(const WacomMTCapability &caps_I)
+	{
+		return caps_I.Version == WACOM_MULTI_TOUCH_API_VERSION && caps_I.FingerMax >= 10 &&
+			caps_I.LogicalWidth > 0.0f && caps_I.PhysicalSizeX > 0.0f;
+	}
+
+	void ApplyDeviceChanges(RegistryStress &stress_IO)
+	{
+		std::unique_lock<std::mutex> lock(stress_IO.changeLock);
+		for (;;)
+		{
+			stress_IO.changed.wait(lock, [&]() { return stress_IO.stopApplying || !stress_IO.changes.empty(); });
+			if (stress_IO.changes.empty())
+			{
+				break;
+			}
+
+			const DeviceChange change = stress_IO.changes.front();
+			stress_IO.changes.pop_front();
+			lock.unlock();
+
+			// The device may be gone again already; the MTAPI then refuses
+			// the registration, and its detach is next in the queue.
+			if (change.attached)
+			{
+				if (stress_IO.registry.Add(change.caps))
+				{
+					WacomMTRegisterFingerReadCallback(change.caps.DeviceID, NULL, WMTProcessingModeNone, StressFingers, &stress_IO);
+				}
+			}
+			else
+			{
+				WacomMTUnRegisterFingerReadCallback(change.caps.DeviceID, NULL, WMTProcessingModeNone, &stress_IO);
+				stress_IO.registry.Remove(change.caps.DeviceID);
+			}
+
+			lock.lock();
+		}
+	}
+
+	// Input timeline benchmark.  Each simulated event knows when it really
+	// happened; the index of the event travels in the pen's pressure or the
+	// first finger's ID.
+	struct TimelineSimEvent
+	{
+		ETimelineEvent			type;
+		double					trueMs;
+		double					arrivalMs;
+		int						source;				// 0 for the pen, then the devices
+		unsigned					packetTime;
+		bool						entering;
+		int						frameNumber;
+	};
+
+	struct TimelineSimRelease
+	{
+		int						index;
+		double					stampMs;
+		double					releaseMs;
+	};
+
+	// Pen packets and proximity, and the frames of each device, with their
+	// arrival times.  Events of one source arrive in order.
+	void MakeTimelineEvents(std::vector<TimelineSimEvent> &events_O)
+	{
+		std::mt19937 random(11);
+		std::exponential_distribution<double> penJitter(1.0 / TIMELINE_BENCH_PEN_JITTER_MS);
+		std::exponential_distribution<double> touchJitter(1.0 / TIMELINE_BENCH_TOUCH_JITTER_MS);
+		const double endMs = TIMELINE_BENCH_SECONDS * 1000.0;
+
+		events_O.clear();
+		double lastArrival = 0.0;
+		bool inProximity = false;
+		for (double trueMs = 0.0; trueMs < endMs; trueMs += 1000.0 / TIMELINE_BENCH_PEN_HZ)
+		{
+			// The window thread stalls at the start of every period.
+			double arrivalMs = trueMs + TIMELINE_BENCH_PEN_DELAY_MS + penJitter(random);
+			const double stallStart = floor(arrivalMs / TIMELINE_BENCH_STALL_EVERY_MS) * TIMELINE_BENCH_STALL_EVERY_MS;
+			if (arrivalMs < stallStart + TIMELINE_BENCH_STALL_MS)
+			{
+				arrivalMs = stallStart + TIMELINE_BENCH_STALL_MS;
+			}
+			arrivalMs = std::max(arrivalMs, lastArrival);
+			lastArrival = arrivalMs;
+
+			const bool near = fmod(trueMs, 2000.0) < 1500.0;
+			if (near != inProximity)
+			{
+				TimelineSimEvent proximity = TimelineSimEvent();
+				proximity.type = ETimelineEvent::EPenProximity;
+				proximity.trueMs = trueMs;
+				proximity.arrivalMs = arrivalMs;
+				proximity.entering = near;
+				events_O.push_back(proximity);
+				inProximity = near;
+			}
+			if (!near)
+			{
+				continue;
+			}
+
+			TimelineSimEvent packet = TimelineSimEvent();
+			packet.type = ETimelineEvent::EPenPacket;
+			packet.trueMs = trueMs;
+			packet.arrivalMs = arrivalMs;
+			packet.packetTime = static_cast<unsigned>(static_cast<long long>(
+				TIMELINE_BENCH_PEN_OFFSET_MS + trueMs * (1.0 + TIMELINE_BENCH_PEN_DRIFT_PPM * 1e-6)));
+			events_O.push_back(packet);
+		}
+
+		for (int device = 0; device < static_cast<int>(sizeof(kTouchRatesHz) / sizeof(kTouchRatesHz[0])); device++)
+		{
+			const double periodMs = 1000.0 / kTouchRatesHz[device] * (1.0 + TIMELINE_BENCH_TOUCH_DRIFT_PPM * 1e-6);
+			int frameNumber = 0;
+			lastArrival = 0.0;
+			for (double trueMs = 0.37 * device; trueMs < endMs; trueMs += periodMs)
+			{
+				if (fmod(trueMs + 1000.0 * device, 4000.0) >= 3000.0)
+				{
+					continue;
+				}
+
+				TimelineSimEvent frame = TimelineSimEvent();
+				frame.type = ETimelineEvent::ETouchFrame;
+				frame.trueMs = trueMs;
+				frame.arrivalMs = std::max(trueMs + TIMELINE_BENCH_TOUCH_DELAY_MS + touchJitter(random), lastArrival);
+				frame.source = device + 1;
+				frame.frameNumber = ++frameNumber;
+				lastArrival = frame.arrivalMs;
+				events_O.push_back(frame);
+			}
+		}
+
+		std::stable_sort(events_O.begin(), events_O.end(),
+			[](const TimelineSimEvent &a_I, const TimelineSimEvent &b_I) { return a_I.arrivalMs < b_I.arrivalMs; });
+	}
+
+	// Percentile of sorted values.
+	double Percentile(const std::vector<double> &sorted_I, int percent_I)
+	{
+		return sorted_I.empty() ? 0.0 : sorted_I[std::min(sorted_I.size() * percent_I / 100, sorted_I.size() - 1)];
+	}
+
+	// How far the stamps of one source stray from the true times, once the
+	// fixed delay (their median offset) is taken out: p50, p99 and max.
+	void StampSpread(std::vector<double> offsets_I, double &median_O, double spread_O[3])
+	{
+		std::sort(offsets_I.begin(), offsets_I.end());
+		median_O = Percentile(offsets_I, 50);
+		for (double &offset : offsets_I)
+		{
+			offset = fabs(offset - median_O);
+		}
+		std::sort(offsets_I.begin(), offsets_I.end());
+		spread_O[0] = Percentile(offsets_I, 50);
+		spread_O[1] = Percentile(offsets_I, 99);
+		spread_O[2] = offsets_I.empty() ? 0.0 : offsets_I.back();
+	}
+
+	// Events that come after one that truly happened more than marginMs_I
+	// later.
+	template <typename TrueMs>
+	size_t CountInversions(size_t count_I, double marginMs_I, TrueMs trueMs_I)
+	{
+		size_t inversions = 0;
+		double latest = std::numeric_limits<double>::lowest();
+		for (size_t idx = 0; idx < count_I; idx++)
+		{
+			const double trueMs = trueMs_I(idx);
+			if (trueMs < latest - marginMs_I)
+			{
+				inversions++;
+			}
+			latest = std::max(latest, trueMs);
+		}
+		return inversions;
+	}
+
+	// Runs the synthetic load once.  Drawing is simulated by holding the
+	// graphics lock for drawCostUs_I per finger.
+	void RunQueueLoad(EDelivery delivery_I, double drawCostUs_I, QueueResult &result_O)
+	{
+		const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / QUEUE_BENCH_RATE_HZ));
+		const int framesPerDevice = QUEUE_BENCH_RATE_HZ * QUEUE_BENCH_SECONDS;
+
+		TouchFrameQueue queue;
+		queue.Allocate(TouchFrameLimits());
+
+		std::mutex graphicsLock;
+		auto draw = [&](int fingerCount_I)
+		{
+			std::lock_guard<std::mutex> lock(graphicsLock);
+			SpinUntil(Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(drawCostUs_I * fingerCount_I)));
+		};
+
+		FrameSignal frameReady;
+		std::atomic<bool> stopRender(false);
+		std::thread renderer;
+		if (delivery_I == EDelivery::ERenderThread)
+		{
+			renderer = std::thread([&]()
+			{
+				while (!stopRender.load())
+				{
+					frameReady.Wait(10);
+					// Whole frames only, so none is held and the time is not used.
+					queue.ConsumeLatest(0.0, [&](const TouchFrame &frame_I) { draw(frame_I.count); });
+				}
+			});
+		}
+
+		std::vector<std::vector<double>> callbackUs(QUEUE_BENCH_DEVICES);
+		std::vector<double> elapsedSeconds(QUEUE_BENCH_DEVICES);
+		std::vector<std::thread> drivers;
+
+		const Clock::time_point start = Clock::now() + period;
+		for (int device = 0; device < QUEUE_BENCH_DEVICES; device++)
+		{
+			drivers.emplace_back([&, device]()
+			{
+				std::vector<WacomMTFinger> fingers(QUEUE_BENCH_FINGERS);
+				WacomMTFingerCollection collection = WacomMTFingerCollection();
+				callbackUs[device].reserve(framesPerDevice);
+
+				for (int frame = 0; frame < framesPerDevice; frame++)
+				{
+					// A driver that is held up delivers the next frame late,
+					// rather than skipping it.
+					SpinUntil(start + frame * period);
+					MakeFingerFrame(device, frame, fingers, collection);
+
+					const Clock::time_point callStart = Clock::now();
+					if (delivery_I == EDelivery::EDrawInCallback)
+					{
+						draw(collection.FingerCount);
+					}
+					else if (queue.PushFingers(&collection))
+					{
+						frameReady.Set();
+					}
+					callbackUs[device].push_back(ElapsedMs(callStart) * 1e3);
+				}
+
+				elapsedSeconds[device] = ElapsedMs(start) / 1e3;
+			});
+		}
+
+		for (std::thread &driver : drivers)
+		{
+			driver.join();
+		}
+
+		if (renderer.joinable())
+		{
+			stopRender = true;
+			frameReady.Set();
+			renderer.join();
+		}
+
+		result_O.callbackUs.clear();
+		result_O.deliveredHz = 0.0;
+		for (int device = 0; device < QUEUE_BENCH_DEVICES; device++)
+		{
+			result_O.callbackUs.insert(result_O.callbackUs.end(), callbackUs[device].begin(), callbackUs[device].end());
+			result_O.deliveredHz += framesPerDevice / elapsedSeconds[device] / QUEUE_BENCH_DEVICES;
+		}
+		std::sort(result_O.callbackUs.begin(), result_O.callbackUs.end());
+
+		result_O.frames = result_O.callbackUs.size();
+		if (delivery_I == EDelivery::EDrawInCallback)
+		{
+			result_O.rendered = result_O.frames;
+			result_O.superseded = 0;
+			result_O.dropped = 0;
+		}
+		else
+		{
+			const TouchFrameStats stats = queue.Stats();
+			result_O.rendered = stats.rendered;
+			result_O.superseded = stats.superseded;
+			result_O.dropped = stats.dropped;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MakeRawFrame(int width_I, int height_I, std::mt19937 &random_IO,
+	std::vector<unsigned short> &raw_O, std::vector<RawBenchContact> &contacts_O)
+{
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	const double sigma = 1.2 * width_I / 64.0;
+
+	raw_O.resize(width_I * height_I);
+	for (unsigned short &value : raw_O)
+	{
+		value = static_cast<unsigned short>(random_IO() % RAW_BLOB_THRESHOLD);
+	}
+
+	contacts_O.resize(RAW_BENCH_CONTACTS);
+	for (int idx = 0; idx < RAW_BENCH_CONTACTS; idx++)
+	{
+		RawBenchContact &contact = contacts_O[idx];
+		contact.x = width_I * (idx % 5 + 0.3 + 0.4 * unit(random_IO)) / 5.0;
+		contact.y = height_I * (idx / 5 + 0.3 + 0.4 * unit(random_IO)) / 2.0;
+		const double peak = 150.0 + 100.0 * unit(random_IO);
+
+		const int reach = static_cast<int>(ceil(3.0 * sigma));
+		for (int y = std::max(static_cast<int>(contact.y) - reach, 0); y < std::min(static_cast<int>(contact.y) + reach + 1, height_I); y++)
+		{
+			for (int x = std::max(static_cast<int>(contact.x) - reach, 0); x < std::min(static_cast<int>(contact.x) + reach + 1, width_I); x++)
+			{
+				const double dx = x + 0.5 - contact.x;
+				const double dy = y + 0.5 - contact.y;
+				const double value = peak * exp(-(dx * dx + dy * dy) / (2.0 * sigma * sigma));
+				unsigned short &cell = raw_O[y * width_I + x];
+				cell = static_cast<unsigned short>(std::min(cell + value, 65535.0));
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Renders synthetic raw frames of the smallest and a larger kScanSizes
+//		grid as full screen heatmaps at each of kHeatmapImages, and reports
+//		the frames per second of RawHeatmap::Render and RenderReference and
+//		whether their images are the same.  Nothing is drawn on the screen.
+//
+std::string RawHeatmapBenchmarkReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+	report << "Raw heatmap, " << RAW_BENCH_CONTACTS << " contacts per frame\n";
+
+	bool allMatch = true;
+	for (const int *size : { kScanSizes[0], kScanSizes[2] })
+	{
+		const int width = size[0];
+		const int height = size[1];
+
+		std::mt19937 random(width);
+		std::vector<std::vector<unsigned short>> frames(HEATMAP_BENCH_FRAMES);
+		std::vector<RawBenchContact> contacts;
+		for (std::vector<unsigned short> &frame : frames)
+		{
+			MakeRawFrame(width, height, random, frame, contacts);
+		}
+
+		for (const int *image : kHeatmapImages)
+		{
+			RawHeatmap heatmap;
+			heatmap.Allocate(width, height, image[0], image[1]);
+
+			Clock::time_point start = Clock::now();
+			for (const std::vector<unsigned short> &frame : frames)
+			{
+				heatmap.Render(frame.data(), 0, 0, image[0], image[1]);
+			}
+			const double fastMs = ElapsedMs(start) / HEATMAP_BENCH_FRAMES;
+			const uint32_t *rendered = heatmap.Render(frames[0].data(), 0, 0, image[0], image[1]);
+			const std::vector<uint32_t> fast(rendered, rendered + image[0] * image[1]);
+
+			start = Clock::now();
+			for (int frame = 0; frame < HEATMAP_BENCH_REFERENCE; frame++)
+			{
+				heatmap.RenderReference(frames[frame].data(), 0, 0, image[0], image[1]);
+			}
+			const double referenceMs = ElapsedMs(start) / HEATMAP_BENCH_REFERENCE;
+			const uint32_t *reference = heatmap.RenderReference(frames[0].data(), 0, 0, image[0], image[1]);
+
+			const bool match = std::equal(fast.begin(), fast.end(), reference);
+			allMatch = allMatch && match;
+
+			report << "  " << width << " x " << height << " to " << image[0] << " x " << image[1] << ": SSE2 "
+				<< fastMs << " ms/frame (" << 1e3 / fastMs << " fps), reference " << referenceMs << " ms/frame ("
+				<< 1e3 / referenceMs << " fps)" << (match ? "" : "  MISMATCH") << "\n";
+		}
+	}
+	report << (allMatch ? "All images match the reference.\n" : "Images differ from the reference!\n");
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Registers a finger callback and a window (WM_FINGERDATA) for the same
+//		device, at each of the kBufferDepths, for DELIVERY_BENCH_SECONDS,
+//		while the window thread stalls now and then.  Reports the window's
+//		latency behind the callback, its jitter, the frames it dropped and
+//		the messages whose buffer had been reused, and the callback's own
+//		interval jitter and skipped frames.  Runs on a tablet, which must be
+//		touched meanwhile, or on one device of the stand-in library; where
+//		there are no windows, on the stand-in's post function.
+//
+std::string DeliveryLatencyBenchmarkReport(void (*prompt_I)(const std::string &))
+{
+	std::stringstream report;
+	report.precision(3);
+
+	if (WacomMTInitialize(WACOM_MULTI_TOUCH_API_VERSION) != WMTErrorSuccess)
+	{
+		report << "The Multi-Touch library could not be initialized.\n";
+		return report.str();
+	}
+
+	StandInCalls standInCalls;
+	const bool standIn = FindStandIn(standInCalls);
+
+	std::vector<int> deviceIDs(WacomMTGetAttachedDeviceIDs(NULL, 0));
+	if (!deviceIDs.empty())
+	{
+		WacomMTGetAttachedDeviceIDs(deviceIDs.data(), deviceIDs.size() * sizeof(int));
+	}
+
+	int deviceID = deviceIDs.empty() ? 0 : deviceIDs[0];
+	if (standIn)
+	{
+		// One device of fingers only, at the benchmark's rate.
+		WacomMTStandInConfig config;
+		standInCalls.getDefaultConfig(&config);
+		config.fingerRateHz = DELIVERY_BENCH_RATE_HZ;
+		config.rawRateHz = 0;
+		standInCalls.setConfig(&config);
+
+		for (int plugged : deviceIDs)
+		{
+			standInCalls.detachDevice(plugged);
+		}
+		standInCalls.attachDevice(&deviceID);
+	}
+	else if (deviceIDs.empty())
+	{
+		WacomMTQuit();
+		report << "No touch device is attached.\n";
+		return report.str();
+	}
+	else if (prompt_I)
+	{
+		std::stringstream prompt;
+		prompt << "Keep moving fingers on the tablet for " << DELIVERY_BENCH_SECONDS * sizeof(kBufferDepths) / sizeof(kBufferDepths[0])
+			<< " s after OK; frames only arrive while it is touched.\n";
+		prompt_I(prompt.str());
+	}
+
+	std::vector<DeliveryResult> results;
+	for (int bufferDepth : kBufferDepths)
+	{
+		std::unique_ptr<DeliveryProbe> probe(new DeliveryProbe());
+		probe->recording = false;
+		probe->callbacks.reserve(DELIVERY_BENCH_RATE_HZ * DELIVERY_BENCH_SECONDS * 2);
+		probe->messages.reserve(DELIVERY_BENCH_RATE_HZ * DELIVERY_BENCH_SECONDS * 2);
+		probe->lastMessageFrame = std::numeric_limits<int>::min();
+		probe->nextStall = Clock::now() + std::chrono::milliseconds(DELIVERY_BENCH_STALL_EVERY_MS);
+#if !defined(_WIN32)
+		probe->stop = false;
+#endif
+
+		std::future<void> ready = probe->ready.get_future();
+		std::thread window(RunDeliveryWindow, std::ref(*probe));
+		ready.wait();
+
+		// Both observe, so that neither takes the frames from the other.
+		probe->recording = true;
+		WacomMTRegisterFingerReadCallback(deviceID, NULL, WMTProcessingModeObserver, DeliveryFingers, probe.get());
+#if defined(_WIN32)
+		WacomMTRegisterFingerReadHWND(deviceID, WMTProcessingModeObserver, probe->hWnd, bufferDepth);
+#else
+		standInCalls.registerPost(deviceID, WMTProcessingModeObserver, PostDeliveryMessage, probe.get(), bufferDepth);
+#endif
+
+		std::this_thread::sleep_for(std::chrono::seconds(DELIVERY_BENCH_SECONDS));
+
+		probe->recording = false;
+		WacomMTUnRegisterFingerReadCallback(deviceID, NULL, WMTProcessingModeObserver, probe.get());
+
+		// Let the window catch up with the last frame timed, and close it
+		// before its registration goes with the buffers its messages point
+		// into.
+		const int lastFrame = probe->callbacks.empty() ? std::numeric_limits<int>::min() : probe->callbacks.back().frame;
+		const Clock::time_point drainEnd = Clock::now() + std::chrono::milliseconds(DELIVERY_BENCH_DRAIN_MS);
+		while (probe->lastMessageFrame < lastFrame && Clock::now() < drainEnd)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		StopDeliveryWindow(*probe);
+		window.join();
+
+#if defined(_WIN32)
+		WacomMTUnRegisterFingerReadHWND(probe->hWnd);
+#else
+		standInCalls.unregisterPost(probe.get());
+#endif
+
+		DeliveryResult result;
+		result.bufferDepth = bufferDepth;
+		MeasureDelivery(*probe, result);
+		results.push_back(result);
+	}
+
+	if (standIn)
+	{
+		standInCalls.detachDevice(deviceID);
+	}
+	WacomMTQuit();
+
+	size_t frames = 0;
+	size_t gaps = 0;
+	double intervalJitterUs = 0.0;
+	for (const DeliveryResult &result : results)
+	{
+		frames += result.frames;
+		gaps += result.gaps;
+		intervalJitterUs = std::max(intervalJitterUs, result.intervalJitterUs);
+	}
+
+	report << "Finger delivery, " << (standIn ? "stand-in device" : "tablet") << " " << deviceID;
+	if (standIn)
+	{
+		report << " at " << DELIVERY_BENCH_RATE_HZ << " Hz";
+	}
+	report << ", " << DELIVERY_BENCH_SECONDS << " s per buffer depth; the window thread stalls "
+		<< DELIVERY_BENCH_STALL_MS << " ms every " << DELIVERY_BENCH_STALL_EVERY_MS << " ms\n";
+	report << "  Callback: " << frames << " frames, " << gaps << " skipped, interval jitter up to "
+		<< intervalJitterUs << " us\n";
+	report << "  Window, latency behind the callback:\n";
+	for (const DeliveryResult &result : results)
+	{
+		const std::vector<double> &us = result.latencyUs;
+		const size_t dropped = result.frames - std::min(us.size(), result.frames);
+		report << "    bufferDepth " << result.bufferDepth << ": ";
+		if (us.empty())
+		{
+			report << "no frames\n";
+			continue;
+		}
+
+		double sum = 0.0;
+		double sumSquares = 0.0;
+		for (double latency : us)
+		{
+			sum += latency;
+			sumSquares += latency * latency;
+		}
+		const double mean = sum / us.size();
+		report << "us avg " << mean
+			<< ", p50 " << us[us.size() / 2]
+			<< ", p99 " << us[us.size() * 99 / 100]
+			<< ", max " << us.back()
+			<< ", jitter " << sqrt(std::max(sumSquares / us.size() - mean * mean, 0.0))
+			<< "; dropped " << dropped << " (" << 100.0 * dropped / std::max(result.frames, static_cast<size_t>(1)) << "%)"
+			<< ", stale " << result.stale << "\n";
+	}
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Splits a stand-in display into JOIN_STRESS_REGIONS hit regions, so
+//		that the fingers of a frame come in parts, one callback per region,
+//		and keeps tracks of what the queue hands on: once with the parts
+//		joined by frame, and once taking each part as a frame, as the queue
+//		did before.  Reports the tracks cut short while their finger was
+//		still down, which should be none.
+//
+std::string HitRegionJoinStressReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+
+	StandInCalls standInCalls;
+	if (!FindStandIn(standInCalls))
+	{
+		report << "Needs the stand-in wacommt library.\n";
+		return report.str();
+	}
+
+	WacomMTStandInConfig config;
+	standInCalls.getDefaultConfig(&config);
+	config.deviceCount = 1;
+	config.deviceType = WMTDeviceTypeIntegrated;
+	config.fingerCount = JOIN_STRESS_FINGERS;
+	config.fingerRateHz = JOIN_STRESS_RATE_HZ;
+	config.rawRateHz = 0;
+	standInCalls.setConfig(&config);
+
+	if (WacomMTInitialize(WACOM_MULTI_TOUCH_API_VERSION) != WMTErrorSuccess)
+	{
+		report << "The Multi-Touch library could not be initialized.\n";
+		return report.str();
+	}
+
+	int deviceID = 0;
+	WacomMTCapability caps = {};
+	if (WacomMTGetAttachedDeviceIDs(&deviceID, sizeof(deviceID)) < 1 ||
+		WacomMTGetDeviceCapabilities(deviceID, &caps) != WMTErrorSuccess)
+	{
+		WacomMTQuit();
+		report << "No touch device is attached.\n";
+		return report.str();
+	}
+
+	JoinResult joined;
+	JoinResult parts;
+	RunJoin(deviceID, caps, true, joined);
+	RunJoin(deviceID, caps, false, parts);
+	WacomMTQuit();
+
+	report << "Hit region join, stand-in device " << deviceID << " at " << JOIN_STRESS_RATE_HZ << " Hz, "
+		<< JOIN_STRESS_FINGERS << " fingers over " << JOIN_STRESS_REGIONS << " regions, "
+		<< JOIN_STRESS_SECONDS << " s each\n";
+	for (const JoinResult *result : { &joined, &parts })
+	{
+		report << (result == &joined ? "  Joined by frame: " : "  Parts as frames: ")
+			<< result->frames << " frames tracked of " << result->stats.published << " published, "
+			<< result->stats.superseded << " superseded, " << result->stats.late << " late parts; "
+			<< static_cast<double>(result->fingers) / std::max(result->frames, 1ULL) << " fingers down per frame, "
+			<< result->cuts << " tracks cut\n";
+	}
+	report << (joined.cuts == 0 ? "Passed.\n" : "FAILED.\n");
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Plugs stand-in devices in and out every REPLUG_STRESS_PLUG_MS, each
+//		with a new ID, while they stream fingers into a TouchFrameQueue, and
+//		releases each device's channel as it is unplugged, as the sample
+//		does.  With far more devices over the run than the queue has
+//		channels, checks that no frame was dropped for want of one, and that
+//		the last devices' frames came through.
+//
+std::string TouchQueueReplugStressReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+
+	StandInCalls standInCalls;
+	if (!FindStandIn(standInCalls))
+	{
+		report << "Needs the stand-in wacommt library.\n";
+		return report.str();
+	}
+
+	WacomMTStandInConfig config;
+	standInCalls.getDefaultConfig(&config);
+	config.deviceCount = 0;
+	config.fingerRateHz = REPLUG_STRESS_RATE_HZ;
+	config.rawRateHz = 0;
+	config.newDeviceIDs = 1;
+	standInCalls.setConfig(&config);
+
+	if (WacomMTInitialize(WACOM_MULTI_TOUCH_API_VERSION) != WMTErrorSuccess)
+	{
+		report << "The Multi-Touch library could not be initialized.\n";
+		return report.str();
+	}
+
+	std::unique_ptr<ReplugProbe> probe(new ReplugProbe());
+	probe->queue.Allocate(TouchFrameLimits());
+
+	std::atomic<bool> stop(false);
+	const Clock::time_point start = Clock::now();
+	std::thread consumer([&]()
+	{
+		const auto take = [&](const TouchFrame &frame_I)
+		{
+			std::lock_guard<std::mutex> lock(probe->lock);
+			probe->taken[frame_I.deviceID]++;
+		};
+
+		while (!stop)
+		{
+			probe->queue.ConsumeLatest(ElapsedMs(start), take);
+			std::this_thread::sleep_for(std::chrono::microseconds(250));
+		}
+	});
+
+	std::deque<int> plugged;
+	std::vector<int> deviceIDs;
+	const auto unplug = [&]()
+	{
+		const int deviceID = plugged.front();
+		plugged.pop_front();
+		WacomMTUnRegisterFingerReadCallback(deviceID, NULL, WMTProcessingModeObserver, probe.get());
+		standInCalls.detachDevice(deviceID);
+		probe->queue.Release(deviceID);
+	};
+
+	while (ElapsedMs(start) < REPLUG_STRESS_SECONDS * 1000.0)
+	{
+		if (plugged.size() == REPLUG_STRESS_DEVICES)
+		{
+			unplug();
+		}
+
+		int deviceID = 0;
+		if (standInCalls.attachDevice(&deviceID) == WMTErrorSuccess)
+		{
+			WacomMTRegisterFingerReadCallback(deviceID, NULL, WMTProcessingModeObserver, ReplugFingers, probe.get());
+			plugged.push_back(deviceID);
+			deviceIDs.push_back(deviceID);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(REPLUG_STRESS_PLUG_MS));
+	}
+
+	// Let the consumer take the last devices' frames before unplugging them.
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	while (!plugged.empty())
+	{
+		unplug();
+	}
+	stop = true;
+	consumer.join();
+	WacomMTQuit();
+
+	const TouchFrameStats stats = probe->queue.Stats();
+	const size_t last = std::min(deviceIDs.size(), static_cast<size_t>(REPLUG_STRESS_DEVICES));
+	size_t lastTaken = 0;
+	for (size_t idx = deviceIDs.size() - last; idx < deviceIDs.size(); idx++)
+	{
+		lastTaken += probe->taken.count(deviceIDs[idx]) ? 1 : 0;
+	}
+
+	report << "Touch queue re-plug, " << REPLUG_STRESS_SECONDS << " s of plugging every " << REPLUG_STRESS_PLUG_MS
+		<< " ms, up to " << REPLUG_STRESS_DEVICES << " devices at " << REPLUG_STRESS_RATE_HZ << " Hz, "
+		<< TOUCH_QUEUE_MAX_DEVICES << " channels\n";
+	report << "  Devices plugged: " << deviceIDs.size() << ", IDs " << (deviceIDs.empty() ? 0 : deviceIDs.front())
+		<< " to " << (deviceIDs.empty() ? 0 : deviceIDs.back()) << "; " << probe->taken.size() << " had frames taken\n";
+	report << "  Frames: " << stats.published << " published, " << stats.rendered << " taken, "
+		<< stats.superseded << " superseded, " << stats.dropped << " dropped for want of a channel\n";
+	report << "  Last " << last << " devices with frames taken: " << lastTaken << "\n";
+	report << (stats.dropped == 0 && deviceIDs.size() > TOUCH_QUEUE_MAX_DEVICES && lastTaken == last
+		? "Passed.\n" : "FAILED.\n");
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Delivers QUEUE_BENCH_DEVICES x QUEUE_BENCH_FINGERS fingers at
+//		QUEUE_BENCH_RATE_HZ, once drawing in the callback as the sample used
+//		to, and once through the TouchFrameQueue to a render thread, at
+//		several drawing costs.  Reports how long the callback keeps the
+//		driver thread, the frame rate the driver threads could deliver, and
+//		the frames rendered, superseded and dropped.
+//
+std::string TouchQueueBenchmarkReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+	report << "Load: " << QUEUE_BENCH_DEVICES << " devices x " << QUEUE_BENCH_FINGERS
+		<< " fingers at " << QUEUE_BENCH_RATE_HZ << " Hz, " << QUEUE_BENCH_SECONDS << " s\n";
+
+	for (double drawCostUs : kDrawCostUs)
+	{
+		report << "Draw cost " << drawCostUs << " us/finger:\n";
+
+		for (EDelivery delivery : { EDelivery::EDrawInCallback, EDelivery::ERenderThread })
+		{
+			QueueResult result;
+			RunQueueLoad(delivery, drawCostUs, result);
+
+			double total = 0.0;
+			for (double us : result.callbackUs)
+			{
+				total += us;
+			}
+
+			const std::vector<double> &us = result.callbackUs;
+			report << (delivery == EDelivery::EDrawInCallback ? "  in callback:  " : "  render thread: ")
+				<< "callback us avg " << total / us.size()
+				<< ", p99 " << us[us.size() * 99 / 100]
+				<< ", max " << us.back()
+				<< "; delivered " << result.deliveredHz << " Hz"
+				<< "; frames " << result.frames
+				<< ", rendered " << result.rendered
+				<< ", superseded " << result.superseded
+				<< ", dropped " << result.dropped << "\n";
+		}
+	}
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Times ComputeBlobMoments and ComputeBlobMomentsReference on frames of
+//		MOMENTS_BENCH_BLOBS blobs at each of the kBlobPoints sizes, and checks
+//		the SSE2 results against the reference: centroid and bounding box in
+//		pixels, area, moments and eccentricity relative to their size, and
+//		orientation in radians for blobs that are not round.
+//
+std::string BlobMomentsBenchmarkReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+	report << "Blob moments, " << MOMENTS_BENCH_BLOBS << " blobs per frame\n";
+
+	bool allMatch = true;
+	for (int pointCount : kBlobPoints)
+	{
+		std::vector<WacomMTBlob> blobs;
+		std::vector<WacomMTBlobPoint> points;
+		WacomMTBlobAggregate aggregate;
+		MakeBlobFrame(pointCount, blobs, points, aggregate);
+
+		BlobSnapshot snapshot;
+		snapshot.Allocate(MOMENTS_BENCH_BLOBS, MOMENTS_BENCH_BLOBS * pointCount);
+		snapshot.Capture(aggregate);
+
+		const int iterations = std::max(MOMENTS_BENCH_POINTS / snapshot.PointCount(), 1);
+		std::vector<BlobMoments> fast;
+		std::vector<BlobMoments> reference;
+		const double fastNs = TimeMoments(ComputeBlobMoments, snapshot, iterations, fast);
+		const double referenceNs = TimeMoments(ComputeBlobMomentsReference, snapshot, iterations, reference);
+
+		double positionError = 0.0;
+		double relativeError = 0.0;
+		double orientationError = 0.0;
+		for (size_t idx = 0; idx < reference.size(); idx++)
+		{
+			const BlobMoments &a = fast[idx];
+			const BlobMoments &b = reference[idx];
+			const double scale = std::max<double>(b.mu20 + b.mu02, 1e-6);
+
+			positionError = std::max(positionError, std::max(fabs(a.centroidX - b.centroidX), fabs(a.centroidY - b.centroidY)));
+			positionError = std::max(positionError, std::max(fabs(a.minX - b.minX), fabs(a.maxY - b.maxY)));
+			relativeError = std::max(relativeError, fabs(a.area - b.area) / std::max<double>(b.area, 1e-6));
+			relativeError = std::max(relativeError, fabs(a.weight - b.weight) / std::max(b.weight, 1e-6));
+			relativeError = std::max(relativeError, (fabs(a.mu20 - b.mu20) + fabs(a.mu02 - b.mu02) + fabs(a.mu11 - b.mu11)) / scale);
+			relativeError = std::max(relativeError, static_cast<double>(fabs(a.eccentricity - b.eccentricity)));
+			if (b.eccentricity > 0.3f)
+			{
+				orientationError = std::max(orientationError, static_cast<double>(fabs(a.orientation - b.orientation)));
+			}
+		}
+
+		const bool match = positionError < 1e-2 && relativeError < 1e-4 && orientationError < 1e-3;
+		allMatch = allMatch && match;
+
+		report << "  " << pointCount << " points/blob: SSE2 " << fastNs << " ns/point, reference "
+			<< referenceNs << " ns/point (x" << referenceNs / fastNs << "); max error "
+			<< positionError << " px, " << relativeError << " relative, " << orientationError << " rad"
+			<< (match ? "" : "  MISMATCH") << "\n";
+	}
+	report << (allMatch ? "All results match the reference.\n" : "Results differ from the reference!\n");
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Extracts blobs from RAW_BENCH_FRAMES synthetic frames per grid size,
+//		on one thread and with a worker per core, and reports the time per
+//		frame, the contacts found and the centroid error against the
+//		contacts' true centers.
+//
+std::string RawBlobsBenchmarkReport(void)
+{
+	const int cores = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+	std::stringstream report;
+	report.precision(3);
+	report << "Raw blobs, " << RAW_BENCH_CONTACTS << " contacts per frame, " << cores << " cores\n";
+
+	for (const int *size : kScanSizes)
+	{
+		const int width = size[0];
+		const int height = size[1];
+
+		std::mt19937 random(width);
+		std::vector<std::vector<unsigned short>> frames(RAW_BENCH_FRAMES);
+		std::vector<std::vector<RawBenchContact>> contacts(RAW_BENCH_FRAMES);
+		for (int frame = 0; frame < RAW_BENCH_FRAMES; frame++)
+		{
+			MakeRawFrame(width, height, random, frames[frame], contacts[frame]);
+		}
+
+		// Grids below RAW_BLOB_PARALLEL_CELLS are never split.
+		std::vector<int> threadCounts(1, 1);
+		if (cores > 1 && width * height >= RAW_BLOB_PARALLEL_CELLS)
+		{
+			threadCounts.push_back(cores);
+		}
+
+		report << "  " << width << " x " << height << ":";
+		for (int threads : threadCounts)
+		{
+			RawBlobExtractor extractor;
+			extractor.Allocate(width, height, threads);
+
+			int found = 0;
+			double error = 0.0;
+			double seconds = 0.0;
+			for (int frame = 0; frame < RAW_BENCH_FRAMES; frame++)
+			{
+				const Clock::time_point start = Clock::now();
+				extractor.Extract(frames[frame].data());
+				seconds += ElapsedMs(start) / 1e3;
+
+				for (const RawBenchContact &contact : contacts[frame])
+				{
+					double nearest = 1e30;
+					for (const RawBlob &blob : extractor.Blobs())
+					{
+						const double dx = blob.centroidX - contact.x;
+						const double dy = blob.centroidY - contact.y;
+						nearest = std::min(nearest, sqrt(dx * dx + dy * dy));
+					}
+					if (nearest < 1.2 * width / 64.0)
+					{
+						found++;
+						error += nearest;
+					}
+				}
+			}
+
+			const double us = seconds * 1e6 / RAW_BENCH_FRAMES;
+			report << " " << extractor.Strips() << " strip(s) " << us << " us/frame (" << 1e6 / us << " fps)";
+			if (threads == 1)
+			{
+				report << ", found " << found << "/" << RAW_BENCH_FRAMES * RAW_BENCH_CONTACTS
+					<< ", centroid error " << (found ? error / found : 0.0) << " cells;";
+			}
+		}
+		report << "\n";
+	}
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Filters RAW_BENCH_FRAMES synthetic frames per grid size with
+//		RawFrameFilter::Process and ProcessReference, and reports the time
+//		per frame of each, whether their outputs are the same, and the noise
+//		estimated against the FILTER_BENCH_NOISE put in.
+//
+std::string RawFilterBenchmarkReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+	report << "Raw filter, noise " << FILTER_BENCH_NOISE << " counts, target " << FILTER_BENCH_TARGET_US << " us/frame\n";
+
+	bool allMatch = true;
+	for (const int *size : kScanSizes)
+	{
+		const int width = size[0];
+		const int height = size[1];
+
+		std::mt19937 random(width);
+		std::uniform_int_distribution<int> level(100, 300);
+		std::vector<unsigned short> baseline(width * height);
+		for (unsigned short &value : baseline)
+		{
+			value = static_cast<unsigned short>(level(random));
+		}
+
+		RawFrameFilter fast;
+		RawFrameFilter reference;
+		fast.Allocate(width * height);
+		reference.Allocate(width * height);
+
+		std::vector<unsigned short> raw;
+		double fastSeconds = 0.0;
+		double referenceSeconds = 0.0;
+		double noise = 0.0;
+		bool match = true;
+		for (int frame = 0; frame < FILTER_BENCH_WARMUP + RAW_BENCH_FRAMES; frame++)
+		{
+			MakeNoisyRawFrame(width, height, frame, baseline, random, raw);
+
+			const Clock::time_point start = Clock::now();
+			const unsigned short *fastOutput = fast.Process(raw.data());
+			const Clock::time_point middle = Clock::now();
+			const unsigned short *referenceOutput = reference.ProcessReference(raw.data());
+			const Clock::time_point end = Clock::now();
+
+			match = match && std::equal(fastOutput, fastOutput + width * height, referenceOutput) &&
+				fast.Noise() == reference.Noise();
+			if (frame >= FILTER_BENCH_WARMUP)
+			{
+				fastSeconds += std::chrono::duration<double>(middle - start).count();
+				referenceSeconds += std::chrono::duration<double>(end - middle).count();
+				noise += fast.Noise();
+			}
+		}
+		allMatch = allMatch && match;
+
+		const double fastUs = fastSeconds * 1e6 / RAW_BENCH_FRAMES;
+		const double referenceUs = referenceSeconds * 1e6 / RAW_BENCH_FRAMES;
+		report << "  " << width << " x " << height << ": SSE2 " << fastUs << " us/frame"
+			<< (fastUs < FILTER_BENCH_TARGET_US ? "" : " (over target)") << ", reference " << referenceUs
+			<< " us/frame (x" << referenceUs / fastUs << "); noise " << noise / RAW_BENCH_FRAMES
+			<< " counts, threshold " << fast.Threshold() << (match ? "" : "  MISMATCH") << "\n";
+	}
+	report << (allMatch ? "All frames match the reference.\n" : "Frames differ from the reference!\n");
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Plays scripted gestures on a 21.5" display tablet at
+//		GESTURE_BENCH_RATE_HZ and reports, for each, the frames from the
+//		start of the motion (or from the fingers going up, for a tap) to its
+//		first event.  Then times GestureRecognizer::Update over a long run of
+//		ten fingers panning, pinching and rotating at once: the time from a
+//		frame to its events.
+//
+std::string GestureBenchmarkReport(void)
+{
+	WacomMTCapability caps = {};
+	caps.Type = WMTDeviceTypeIntegrated;
+	caps.LogicalWidth = 1920.0f;
+	caps.LogicalHeight = 1080.0f;
+	caps.PhysicalSizeX = 476.6f;
+	caps.PhysicalSizeY = 268.1f;
+	caps.FingerMax = 10;
+
+	const float pixelsPerMM = caps.LogicalWidth / caps.PhysicalSizeX;
+	const double pi = 3.14159265358979;
+
+	std::stringstream report;
+	report.precision(3);
+	report << "Gestures at " << GESTURE_BENCH_RATE_HZ << " Hz, " << caps.PhysicalSizeX << " x " << caps.PhysicalSizeY << " mm\n";
+
+	struct Script
+	{
+		const char								*name;
+		EGestureType							type;
+		int										fingers;
+		int										frames;
+		std::function<void(int, double, float &, float &)>	position;
+	};
+
+	const Script scripts[] =
+	{
+		{ "Pan, 3 fingers at 100 mm/s", EGestureType::EPan, 3, GESTURE_BENCH_RATE_HZ,
+			[&](int finger_I, double seconds_I, float &x_O, float &y_O)
+			{
+				x_O = static_cast<float>((200.0 + 20.0 * finger_I + 100.0 * seconds_I) * pixelsPerMM);
+				y_O = static_cast<float>(130.0 * pixelsPerMM);
+			} },
+		{ "Pinch, 2 fingers parting at 100 mm/s", EGestureType::EPinch, 2, GESTURE_BENCH_RATE_HZ,
+			[&](int finger_I, double seconds_I, float &x_O, float &y_O)
+			{
+				x_O = static_cast<float>((238.0 + (finger_I ? 1.0 : -1.0) * (20.0 + 50.0 * seconds_I)) * pixelsPerMM);
+				y_O = static_cast<float>(130.0 * pixelsPerMM);
+			} },
+		{ "Rotate, 2 fingers 60 mm apart at 90 deg/s", EGestureType::ERotate, 2, GESTURE_BENCH_RATE_HZ,
+			[&](int finger_I, double seconds_I, float &x_O, float &y_O)
+			{
+				const double angle = pi / 2.0 * seconds_I + (finger_I ? pi : 0.0);
+				x_O = static_cast<float>((238.0 + 30.0 * cos(angle)) * pixelsPerMM);
+				y_O = static_cast<float>((130.0 + 30.0 * sin(angle)) * pixelsPerMM);
+			} },
+		{ "Tap, 2 fingers for 50 ms", EGestureType::ETap, 2, GESTURE_BENCH_RATE_HZ / 20 + 1,
+			[&](int finger_I, double, float &x_O, float &y_O)
+			{
+				x_O = static_cast<float>((220.0 + 25.0 * finger_I) * pixelsPerMM);
+				y_O = static_cast<float>(130.0 * pixelsPerMM);
+			} }
+	};
+
+	for (const Script &script : scripts)
+	{
+		GestureRecognizer recognizer;
+		recognizer.Configure(caps);
+		const GestureRun run = PlayGesture(recognizer, script.fingers, script.frames, script.position, script.type);
+
+		report << "  " << script.name << ": ";
+		if (run.eventFrame < 0)
+		{
+			report << "NOT RECOGNIZED\n";
+		}
+		else if (script.type == EGestureType::ETap)
+		{
+			report << "event on the up frame + " << run.eventFrame - (script.frames - 1) << "\n";
+		}
+		else
+		{
+			report << "event after " << run.eventFrame << " frames (" << run.eventFrame * 1e3 / GESTURE_BENCH_RATE_HZ << " ms)\n";
+		}
+	}
+
+	GestureRecognizer recognizer;
+	recognizer.Configure(caps);
+	const GestureRun run = PlayGesture(recognizer, caps.FingerMax, GESTURE_BENCH_SECONDS * GESTURE_BENCH_RATE_HZ,
+		[&](int finger_I, double seconds_I, float &x_O, float &y_O)
+		{
+			const double angle = 0.5 * seconds_I + 2.0 * pi * finger_I / caps.FingerMax;
+			const double radius = 50.0 + 20.0 * sin(seconds_I);
+			x_O = static_cast<float>((238.0 + 40.0 * sin(0.3 * seconds_I) + radius * cos(angle)) * pixelsPerMM);
+			y_O = static_cast<float>((130.0 + radius * sin(angle)) * pixelsPerMM);
+		}, EGestureType::ERotate);
+
+	report << "  Frame to events, " << caps.FingerMax << " fingers over " << GESTURE_BENCH_SECONDS << " s: mean "
+		<< run.updateUs << " us, max " << run.updateMaxUs << " us\n";
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Replays PALM_BENCH_SESSIONS scripted sessions (see MakePalmSession) on
+//		a 21.5" display tablet through a PalmRejector, with the pen's
+//		proximity and packets interleaved with the touch frames as they would
+//		arrive.  Reports the precision and recall of rejecting palms on the
+//		frame each contact appears and by the time it lifts, against the
+//		driver's confidence alone, and the time per frame.
+//
+std::string PalmRejectionBenchmarkReport(void)
+{
+	WacomMTCapability caps = {};
+	caps.Type = WMTDeviceTypeIntegrated;
+	caps.LogicalWidth = 1920.0f;
+	caps.LogicalHeight = 1080.0f;
+	caps.PhysicalSizeX = 476.6f;
+	caps.PhysicalSizeY = 268.1f;
+	caps.FingerMax = 10;
+
+	const float pixelsPerMM = caps.LogicalWidth / caps.PhysicalSizeX;
+	const double frameMs = 1e3 / PALM_BENCH_RATE_HZ;
+
+	std::mt19937 random(37);
+	PalmScore firstFrame = {};
+	PalmScore atLift = {};
+	PalmScore confidence = {};
+	int lateRejections = 0;
+	double lateMs = 0.0;
+	int frames = 0;
+	double updateUs = 0.0;
+	double updateMaxUs = 0.0;
+
+	std::vector<WacomMTFinger> fingers(caps.FingerMax);
+	std::vector<int> contactOf(caps.FingerMax);
+	for (int sessionIndex = 0; sessionIndex < PALM_BENCH_SESSIONS; sessionIndex++)
+	{
+		const PalmSession session = MakePalmSession(random);
+		const int contacts = static_cast<int>(session.contacts.size());
+		std::vector<double> firstMs(contacts, -1.0);
+		std::vector<double> rejectedMs(contacts, -1.0);
+
+		PalmRejector rejector;
+		rejector.Configure(caps);
+		bool penIn = false;
+		double packetMs = PALM_BENCH_PEN_IN_MS;
+
+		for (int frame = 0; frame * frameMs <= PALM_BENCH_SESSION_MS + frameMs; frame++)
+		{
+			const double timeMs = frame * frameMs;
+
+			// Pen events up to this frame.
+			if (session.pen)
+			{
+				if (!penIn && timeMs >= PALM_BENCH_PEN_IN_MS && packetMs < PALM_BENCH_PEN_OUT_MS)
+				{
+					rejector.PenProximity(true, PALM_BENCH_PEN_IN_MS);
+					penIn = true;
+				}
+				for (; penIn && packetMs <= timeMs && packetMs < PALM_BENCH_PEN_OUT_MS; packetMs += PALM_BENCH_PACKET_MS)
+				{
+					float x = 0.0f;
+					float y = 0.0f;
+					PalmPenAt(session, packetMs, x, y);
+					rejector.PenPacket(x, y, packetMs);
+				}
+				if (penIn && timeMs >= PALM_BENCH_PEN_OUT_MS)
+				{
+					rejector.PenProximity(false, PALM_BENCH_PEN_OUT_MS);
+					penIn = false;
+				}
+			}
+
+			// Contacts down on this frame, and those that lifted since the
+			// last one.
+			int count = 0;
+			for (int index = 0; index < contacts && count < caps.FingerMax; index++)
+			{
+				const PalmContact &contact = session.contacts[index];
+				if (timeMs < contact.downMs || timeMs - frameMs >= contact.upMs)
+				{
+					continue;
+				}
+
+				const double heldMs = timeMs - contact.downMs;
+				const float grown = contact.palm ? static_cast<float>(std::min(0.4 + 0.6 * heldMs / 30.0, 1.0)) : 1.0f;
+
+				WacomMTFinger &finger = fingers[count];
+				finger = WacomMTFinger();
+				finger.FingerID = sessionIndex * 16 + index + 1;
+				finger.Confidence = contact.confident;
+				finger.TouchState = timeMs >= contact.upMs ? WMTFingerStateUp :
+					heldMs < frameMs ? WMTFingerStateDown : WMTFingerStateHold;
+				finger.X = (contact.x + contact.velocityX * static_cast<float>(heldMs / 1e3)) * pixelsPerMM;
+				finger.Y = (contact.y + contact.velocityY * static_cast<float>(heldMs / 1e3)) * pixelsPerMM;
+				finger.Width = contact.minor * grown * pixelsPerMM;
+				finger.Height = contact.major * grown * pixelsPerMM;
+				contactOf[count++] = index;
+			}
+
+			const Clock::time_point start = Clock::now();
+			rejector.Update(count, fingers.data(), timeMs);
+			const double us = ElapsedMs(start) * 1e3;
+			updateUs += us;
+			updateMaxUs = std::max(updateMaxUs, us);
+			frames++;
+
+			for (int index = 0; index < count; index++)
+			{
+				const PalmContact &contact = session.contacts[contactOf[index]];
+				const bool rejected = !rejector.Accepted(index);
+				double &rejectedAt = rejectedMs[contactOf[index]];
+				if (rejected && rejectedAt < 0.0)
+				{
+					rejectedAt = timeMs;
+				}
+
+				if (fingers[index].TouchState == WMTFingerStateDown)
+				{
+					firstMs[contactOf[index]] = timeMs;
+					firstFrame.Add(contact.palm, rejected);
+					confidence.Add(contact.palm, !contact.confident);
+				}
+				else if (fingers[index].TouchState == WMTFingerStateUp)
+				{
+					atLift.Add(contact.palm, rejected);
+					if (rejected && rejectedAt > firstMs[contactOf[index]])
+					{
+						lateRejections++;
+						lateMs += rejectedAt - firstMs[contactOf[index]];
+					}
+				}
+			}
+		}
+	}
+
+	std::stringstream report;
+	report.precision(3);
+	report << "Palm rejection, " << PALM_BENCH_SESSIONS << " sessions at " << PALM_BENCH_RATE_HZ << " Hz\n";
+	confidence.Report(report, "Driver confidence alone");
+	firstFrame.Report(report, "On the first frame");
+	atLift.Report(report, "By lift");
+	report << "  Rejected after the first frame: " << lateRejections << ", mean "
+		<< (lateRejections ? lateMs / lateRejections : 0.0) << " ms after touch-down\n";
+	report << "  Update: mean " << updateUs / frames << " us, max " << updateMaxUs << " us over " << frames << " frames\n";
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Counts the MTAPI calls made during a simulated HIT_BENCH_DRAG_MS drag
+//		of a window, updating on every WM_MOVE as the sample did and through
+//		the HitRegionManager.  Then routes HIT_BENCH_POINTS random points
+//		through the interval index of HIT_BENCH_REGIONS overlapping regions
+//		and through a scan of them, checking they agree.
+//
+std::string HitRegionBenchmarkReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+	report << "Driver calls during a " << HIT_BENCH_DRAG_MS / 1000.0 << " s drag, WM_MOVE at " << HIT_BENCH_MOVE_HZ << " Hz\n";
+	report << "  Before, one hit rect updated on every WM_MOVE: " << DragHitRegions(1, true) << "\n";
+	report << "  After, one region: " << DragHitRegions(1, false) << "\n";
+	report << "  After, three regions: " << DragHitRegions(3, false) << "\n";
+
+	// A canvas under a grid of palette tiles, some overlapping.
+	std::mt19937 random(41);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<WacomMTHitRect> rects;
+	HitRegionManager regions;
+	const WacomMTHitRect canvas = { 0.0f, 0.0f, 1920.0f, 1080.0f };
+	rects.push_back(canvas);
+	regions.AddRegion(canvas, WMTProcessingModeNone, 0.0);
+	for (int index = 1; index < HIT_BENCH_REGIONS; index++)
+	{
+		const WacomMTHitRect rect = { 1920.0f * unit(random), 1080.0f * unit(random), 40.0f + 200.0f * unit(random), 40.0f + 200.0f * unit(random) };
+		rects.push_back(rect);
+		regions.AddRegion(rect, WMTProcessingModeObserver, 0.0);
+	}
+	regions.MoveWindow(0.0f, 0.0f, 0.0);
+
+	std::vector<float> points(2 * HIT_BENCH_POINTS);
+	for (size_t index = 0; index < points.size(); index += 2)
+	{
+		points[index] = 2000.0f * unit(random) - 40.0f;
+		points[index + 1] = 1140.0f * unit(random) - 30.0f;
+	}
+
+	std::vector<int> indexed(HIT_BENCH_POINTS);
+	Clock::time_point start = Clock::now();
+	for (int index = 0; index < HIT_BENCH_POINTS; index++)
+	{
+		indexed[index] = regions.Route(points[2 * index], points[2 * index + 1]);
+	}
+	const double indexNs = ElapsedMs(start) * 1e6 / HIT_BENCH_POINTS;
+
+	std::vector<int> scanned(HIT_BENCH_POINTS);
+	start = Clock::now();
+	for (int index = 0; index < HIT_BENCH_POINTS; index++)
+	{
+		const float x = points[2 * index];
+		const float y = points[2 * index + 1];
+		int found = -1;
+		for (int region = HIT_BENCH_REGIONS - 1; region >= 0 && found < 0; region--)
+		{
+			const WacomMTHitRect &rect = rects[region];
+			if (x >= rect.originX && x < rect.originX + rect.width && y >= rect.originY && y < rect.originY + rect.height)
+			{
+				found = region + 1;
+			}
+		}
+		scanned[index] = found;
+	}
+	const double scanNs = ElapsedMs(start) * 1e6 / HIT_BENCH_POINTS;
+
+	report << "Routing among " << HIT_BENCH_REGIONS << " regions: index " << indexNs << " ns, scan " << scanNs
+		<< " ns per finger, " << (indexed == scanned ? "same regions" : "REGIONS DIFFER") << "\n";
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Converts TRANSFORM_BENCH_SECONDS of frames of TRANSFORM_BENCH_FINGERS
+//		fingers at TRANSFORM_BENCH_RATE_HZ from each of two display tablets
+//		and two opaque tablets: as DrawFingerData did without the cache, and
+//		through each device's TouchTransform with SSE2 and one finger at a
+//		time.  Reports the time per finger and per second of the load, and
+//		checks that SSE2 and the reference agree.
+//
+std::string TouchTransformBenchmarkReport(void)
+{
+	const ClientRect client = { 200, 150, 1400, 950 };
+	std::map<int, WacomMTCapability> caps;
+	std::vector<TouchTransform> transforms(TRANSFORM_BENCH_DEVICES);
+	for (int device = 0; device < TRANSFORM_BENCH_DEVICES; device++)
+	{
+		WacomMTCapability &cap = caps[device];
+		cap.DeviceID = device;
+		if (device % 2 == 0)
+		{
+			cap.Type = WMTDeviceTypeIntegrated;
+			cap.LogicalOriginX = 1920.0f * (device / 2);
+			cap.LogicalWidth = 1920.0f;
+			cap.LogicalHeight = 1080.0f;
+			cap.PhysicalSizeX = 476.6f;
+			cap.PhysicalSizeY = 268.1f;
+		}
+		else
+		{
+			cap.Type = WMTDeviceTypeOpaque;
+			cap.LogicalWidth = 4480.0f;
+			cap.LogicalHeight = 2960.0f;
+			cap.PhysicalSizeX = 224.0f;
+			cap.PhysicalSizeY = 148.0f;
+		}
+		transforms[device].Configure(cap, static_cast<float>(client.left), static_cast<float>(client.top),
+			static_cast<float>(client.right - client.left), static_cast<float>(client.bottom - client.top));
+	}
+
+	// A second of frames, replayed.
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	const int frameCount = TRANSFORM_BENCH_RATE_HZ * TRANSFORM_BENCH_DEVICES;
+	std::vector<WacomMTFinger> fingers(frameCount * TRANSFORM_BENCH_FINGERS);
+	for (size_t index = 0; index < fingers.size(); index++)
+	{
+		const WacomMTCapability &cap = caps[static_cast<int>(index / TRANSFORM_BENCH_FINGERS) % TRANSFORM_BENCH_DEVICES];
+		const bool pixels = cap.Type == WMTDeviceTypeIntegrated;
+		WacomMTFinger &finger = fingers[index];
+		finger.FingerID = static_cast<int>(index % TRANSFORM_BENCH_FINGERS) + 1;
+		finger.X = pixels ? cap.LogicalOriginX + cap.LogicalWidth * unit(random) : unit(random);
+		finger.Y = pixels ? cap.LogicalHeight * unit(random) : unit(random);
+		finger.Width = pixels ? 20.0f + 40.0f * unit(random) : 0.03f + 0.05f * unit(random);
+		finger.Height = index % 7 ? finger.Width * (0.8f + 0.4f * unit(random)) : -1.0f;
+		finger.Confidence = true;
+		finger.TouchState = WMTFingerStateHold;
+	}
+
+	const int fingerTotal = TRANSFORM_BENCH_SECONDS * frameCount * TRANSFORM_BENCH_FINGERS;
+	std::vector<TouchPoint> points(TRANSFORM_BENCH_FINGERS);
+	std::vector<TouchPoint> reference(TRANSFORM_BENCH_FINGERS);
+	double sink = 0.0;
+
+	Clock::time_point start = Clock::now();
+	for (int second = 0; second < TRANSFORM_BENCH_SECONDS; second++)
+	{
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			ConvertUncached(caps, frame % TRANSFORM_BENCH_DEVICES, client, TRANSFORM_BENCH_FINGERS,
+				&fingers[frame * TRANSFORM_BENCH_FINGERS], points.data());
+			sink += points[0].clientX;
+		}
+	}
+	const double uncachedNs = ElapsedMs(start) * 1e6 / fingerTotal;
+
+	start = Clock::now();
+	for (int second = 0; second < TRANSFORM_BENCH_SECONDS; second++)
+	{
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			transforms[frame % TRANSFORM_BENCH_DEVICES].ConvertReference(TRANSFORM_BENCH_FINGERS,
+				&fingers[frame * TRANSFORM_BENCH_FINGERS], points.data());
+			sink += points[0].clientX;
+		}
+	}
+	const double referenceNs = ElapsedMs(start) * 1e6 / fingerTotal;
+
+	start = Clock::now();
+	for (int second = 0; second < TRANSFORM_BENCH_SECONDS; second++)
+	{
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			transforms[frame % TRANSFORM_BENCH_DEVICES].Convert(TRANSFORM_BENCH_FINGERS,
+				&fingers[frame * TRANSFORM_BENCH_FINGERS], points.data());
+			sink += points[0].clientX;
+		}
+	}
+	const double simdNs = ElapsedMs(start) * 1e6 / fingerTotal;
+
+	// SSE2 against the reference, and the reference against the uncached
+	// conversion, every frame of the second.
+	bool same = true;
+	float largest = 0.0f;
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		const TouchTransform &transform = transforms[frame % TRANSFORM_BENCH_DEVICES];
+		const WacomMTFinger *frameFingers = &fingers[frame * TRANSFORM_BENCH_FINGERS];
+		transform.Convert(TRANSFORM_BENCH_FINGERS, frameFingers, points.data());
+		transform.ConvertReference(TRANSFORM_BENCH_FINGERS, frameFingers, reference.data());
+		for (int index = 0; index < TRANSFORM_BENCH_FINGERS; index++)
+		{
+			const TouchPoint &a = points[index];
+			const TouchPoint &b = reference[index];
+			same = same && a.clientX == b.clientX && a.clientY == b.clientY && a.x == b.x && a.y == b.y &&
+				a.widthMM == b.widthMM && a.heightMM == b.heightMM && a.radiusX == b.radiusX && a.radiusY == b.radiusY;
+		}
+
+		ConvertUncached(caps, frame % TRANSFORM_BENCH_DEVICES, client, TRANSFORM_BENCH_FINGERS, frameFingers, points.data());
+		for (int index = 0; index < TRANSFORM_BENCH_FINGERS; index++)
+		{
+			largest = std::max(largest, std::fabs(points[index].clientX - reference[index].clientX));
+			largest = std::max(largest, std::fabs(points[index].clientY - reference[index].clientY));
+			largest = std::max(largest, std::fabs(points[index].radiusX - reference[index].radiusX));
+		}
+	}
+
+	const double perSecond = 1e-3 * TRANSFORM_BENCH_RATE_HZ * TRANSFORM_BENCH_DEVICES * TRANSFORM_BENCH_FINGERS;
+	std::stringstream report;
+	report.precision(3);
+	report << "Touch transforms, " << TRANSFORM_BENCH_FINGERS << " fingers x " << TRANSFORM_BENCH_RATE_HZ << " Hz x "
+		<< TRANSFORM_BENCH_DEVICES << " devices\n";
+	report << "  Uncached: " << uncachedNs << " ns per finger, " << uncachedNs * perSecond << " us per second\n";
+	report << "  Reference: " << referenceNs << " ns per finger, " << referenceNs * perSecond << " us per second\n";
+	report << "  SSE2: " << simdNs << " ns per finger, " << simdNs * perSecond << " us per second, "
+		<< (same ? "same as the reference" : "DIFFERS FROM THE REFERENCE") << "\n";
+	report << "  Largest difference from the uncached conversion: " << largest << " px\n";
+	if (sink == 0.0)
+	{
+		report << "\n";
+	}
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Plugs devices of the stand-in library in and out every
+//		REGISTRY_STRESS_PLUG_MS for REGISTRY_STRESS_SECONDS, each delivering
+//		fingers at REGISTRY_STRESS_RATE_HZ, while a render thread looks up the
+//		device of every frame in the DeviceRegistry and another thread reads
+//		it without pause.  Reports the hot-plugs, the versions published and
+//		how long writers waited for readers, and checks that every device
+//		read had the capabilities the stand-in gave it.
+//
+std::string DeviceRegistryStressReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+
+	if (WacomMTInitialize(WACOM_MULTI_TOUCH_API_VERSION) != WMTErrorSuccess)
+	{
+		report << "The Multi-Touch library could not be initialized.\n";
+		return report.str();
+	}
+
+	StandInCalls standInCalls;
+	if (!FindStandIn(standInCalls))
+	{
+		WacomMTQuit();
+		report << "This test plugs devices in and out, which needs the stand-in wacommt.dll\n"
+			"next to the executable (see WacomMTStandIn.h).\n";
+		return report.str();
+	}
+
+	// Devices plugged in from here on deliver fingers only, at the stress
+	// rate; those there already go before the callbacks are registered.
+	WacomMTStandInConfig config;
+	standInCalls.getDefaultConfig(&config);
+	config.fingerRateHz = REGISTRY_STRESS_RATE_HZ;
+	config.rawRateHz = 0;
+	standInCalls.setConfig(&config);
+
+	std::vector<int> plugged(WacomMTGetAttachedDeviceIDs(NULL, 0));
+	if (!plugged.empty())
+	{
+		WacomMTGetAttachedDeviceIDs(plugged.data(), plugged.size() * sizeof(int));
+	}
+	for (int deviceID : plugged)
+	{
+		standInCalls.detachDevice(deviceID);
+	}
+	plugged.clear();
+
+	std::unique_ptr<RegistryStress> stress(new RegistryStress());
+	stress->frames.Allocate(TouchFrameLimits());
+	stress->stopApplying = false;
+	stress->stopReading = false;
+	stress->delivered = 0;
+	stress->lookedUp = 0;
+	stress->detached = 0;
+	stress->reads = 0;
+	stress->wrong = 0;
+
+	std::thread applier(ApplyDeviceChanges, std::ref(*stress));
+
+	std::thread renderer([&]()
+	{
+		while (!stress->stopReading)
+		{
+			stress->frameReady.Wait(10);
+			stress->frames.ConsumeLatest(0.0, [&](const TouchFrame &frame_I)
+			{
+				DeviceRegistry::Reader devices(stress->registry);
+				const WacomMTCapability *caps = devices->Find(frame_I.deviceID);
+				if (!caps)
+				{
+					// Queued before its device was unplugged.
+					stress->detached++;
+				}
+				else if (caps->DeviceID != frame_I.deviceID || frame_I.count > caps->FingerMax || !StressCapsValid(*caps))
+				{
+					stress->wrong++;
+				}
+				stress->lookedUp++;
+			});
+		}
+	});
+
+	std::thread reader([&]()
+	{
+		unsigned long long lastVersion = 0;
+		while (!stress->stopReading)
+		{
+			DeviceRegistry::Reader devices(stress->registry);
+			if (devices->version < lastVersion || devices->devices.size() > REGISTRY_STRESS_DEVICES)
+			{
+				stress->wrong++;
+			}
+			for (const WacomMTCapability &caps : devices->devices)
+			{
+				if (!StressCapsValid(caps))
+				{
+					stress->wrong++;
+				}
+			}
+			lastVersion = devices->version;
+			stress->reads++;
+		}
+	});
+
+	WacomMTRegisterAttachCallback(StressAttach, stress.get());
+	WacomMTRegisterDetachCallback(StressDetach, stress.get());
+
+	// Plug in while there is room, and otherwise pull a device at random
+	// half of the time.
+	std::mt19937 random(7);
+	int attaches = 0;
+	int detaches = 0;
+	const Clock::time_point start = Clock::now();
+	while (ElapsedMs(start) < REGISTRY_STRESS_SECONDS * 1000.0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(REGISTRY_STRESS_PLUG_MS));
+
+		const bool attach = plugged.empty() || (plugged.size() < REGISTRY_STRESS_DEVICES && random() % 2 == 0);
+		if (attach)
+		{
+			int deviceID = 0;
+			if (standInCalls.attachDevice(&deviceID) == WMTErrorSuccess)
+			{
+				plugged.push_back(deviceID);
+				attaches++;
+			}
+		}
+		else
+		{
+			const size_t pick = random() % plugged.size();
+			if (standInCalls.detachDevice(plugged[pick]) == WMTErrorSuccess)
+			{
+				detaches++;
+			}
+			plugged.erase(plugged.begin() + pick);
+		}
+	}
+	const double seconds = ElapsedMs(start) / 1e3;
+
+	for (int deviceID : plugged)
+	{
+		standInCalls.detachDevice(deviceID);
+		detaches++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(stress->changeLock);
+		stress->stopApplying = true;
+		stress->changed.notify_one();
+	}
+	applier.join();
+
+	stress->stopReading = true;
+	stress->frameReady.Set();
+	renderer.join();
+	reader.join();
+	WacomMTQuit();
+
+	const DeviceRegistryStats stats = stress->registry.Stats();
+	const bool passed = stress->wrong == 0 && stress->registry.Devices().empty() && stress->lookedUp > 0;
+
+	report << "Device registry, " << REGISTRY_STRESS_SECONDS << " s of hot-plugging every " << REGISTRY_STRESS_PLUG_MS
+		<< " ms, up to " << REGISTRY_STRESS_DEVICES << " devices at " << REGISTRY_STRESS_RATE_HZ << " Hz\n";
+	report << "  Hot-plugs: " << attaches << " attached, " << detaches << " detached, "
+		<< (attaches + detaches) / seconds << " per second\n";
+	report << "  Versions published: " << stats.published << "; writers waited for readers " << stats.waits
+		<< " times, at most " << stats.longestWaitMs << " ms\n";
+	report << "  Frames: " << stress->delivered << " delivered, " << stress->lookedUp << " looked up, "
+		<< stress->detached << " of devices already unplugged\n";
+	report << "  Reader thread: " << stress->reads << " reads, " << seconds * 1e9 / std::max(stress->reads, 1ULL) << " ns each\n";
+	report << "  Devices read with wrong capabilities: " << stress->wrong << "\n";
+	report << (passed ? "Passed.\n" : "FAILED.\n");
+
+	return report.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Runs simulated pen packets, on a driver clock with an offset and a
+//		drift, and the frames of two touch devices through the input
+//		timeline, on a simulated clock, and compares its stamps and its order
+//		with those of the arrivals.  Reports how far the stamps stray from
+//		the true times once the fixed delay is taken out, the drift and frame
+//		periods estimated, the events out of true order, and the delay the
+//		merge adds.  Needs no device.
+//
+std::string InputTimelineBenchmarkReport(void)
+{
+	std::stringstream report;
+	report.precision(3);
+
+	std::vector<TimelineSimEvent> events;
+	MakeTimelineEvents(events);
+	const int devices = static_cast<int>(sizeof(kTouchRatesHz) / sizeof(kTouchRatesHz[0]));
+
+	InputTimeline timeline;
+	timeline.Allocate(1);
+
+	// Proximity carries no index; the pen's events leave in the order they
+	// came, so the n-th proximity out is the n-th in.
+	std::vector<int> proximity;
+	for (int idx = 0; idx < static_cast<int>(events.size()); idx++)
+	{
+		if (events[idx].type == ETimelineEvent::EPenProximity)
+		{
+			proximity.push_back(idx);
+		}
+	}
+
+	std::vector<TimelineSimRelease> released;
+	released.reserve(events.size());
+	size_t proximityOut = 0;
+	double nowMs = 0.0;
+	const auto handle = [&](const TimelineEvent &event_I)
+	{
+		TimelineSimRelease release;
+		release.index = event_I.type == ETimelineEvent::EPenPacket ? static_cast<int>(event_I.pressure) :
+			event_I.type == ETimelineEvent::ETouchFrame ? event_I.fingers[0].FingerID : proximity[proximityOut++];
+		release.stampMs = event_I.timeMs;
+		release.releaseMs = nowMs;
+		released.push_back(release);
+	};
+
+	WacomMTFinger finger = WacomMTFinger();
+	WacomMTFingerCollection frame = WacomMTFingerCollection();
+	frame.FingerCount = 1;
+	frame.Fingers = &finger;
+
+	const Clock::time_point start = Clock::now();
+
+	// The consumer wakes every step and releases what is due; everything
+	// that arrived since was pushed at its own arrival time.
+	size_t next = 0;
+	const double endMs = TIMELINE_BENCH_SECONDS * 1000.0 + 100.0;
+	for (nowMs = 0.0; nowMs < endMs; nowMs += TIMELINE_BENCH_STEP_MS)
+	{
+		for (; next < events.size() && events[next].arrivalMs <= nowMs; next++)
+		{
+			const TimelineSimEvent &event = events[next];
+			switch (event.type)
+			{
+			case ETimelineEvent::EPenPacket:
+				timeline.PushPenPacket(event.packetTime, 0.0f, 0.0f, static_cast<unsigned>(next), event.arrivalMs);
+				break;
+
+			case ETimelineEvent::EPenProximity:
+				timeline.PushPenProximity(event.entering, event.arrivalMs);
+				break;
+
+			case ETimelineEvent::ETouchFrame:
+				frame.DeviceID = event.source;
+				frame.FrameNumber = event.frameNumber;
+				finger.FingerID = static_cast<int>(next);
+				timeline.PushFingers(&frame, event.arrivalMs);
+				break;
+			}
+		}
+		timeline.Release(nowMs, handle);
+	}
+
+	const double nsPerEvent = ElapsedMs(start) * 1e6 / std::max(events.size(), static_cast<size_t>(1));
+	const InputTimelineStats stats = timeline.Stats();
+
+	// Stamps and arrivals against the true times, per source.
+	std::vector<std::vector<double>> stampOffsets(devices + 1);
+	std::vector<std::vector<double>> arrivalOffsets(devices + 1);
+	std::vector<double> delays;
+	delays.reserve(released.size());
+	for (const TimelineSimRelease &release : released)
+	{
+		const TimelineSimEvent &event = events[release.index];
+		delays.push_back(release.releaseMs - event.arrivalMs);
+		if (event.type != ETimelineEvent::EPenProximity && event.trueMs >= TIMELINE_BENCH_WARMUP_MS)
+		{
+			stampOffsets[event.source].push_back(release.stampMs - event.trueMs);
+			arrivalOffsets[event.source].push_back(event.arrivalMs - event.trueMs);
+		}
+	}
+	std::sort(delays.begin(), delays.end());
+
+	const auto arrivalTrueMs = [&](size_t idx_I) { return events[idx_I].trueMs; };
+	const auto releaseTrueMs = [&](size_t idx_I) { return events[released[idx_I].index].trueMs; };
+
+	report << "Input timeline, simulated " << TIMELINE_BENCH_SECONDS << " s: pen at " << TIMELINE_BENCH_PEN_HZ
+		<< " Hz, drift " << TIMELINE_BENCH_PEN_DRIFT_PPM << " ppm, delay " << TIMELINE_BENCH_PEN_DELAY_MS
+		<< " ms + " << TIMELINE_BENCH_PEN_JITTER_MS << " ms avg, stalls of " << TIMELINE_BENCH_STALL_MS
+		<< " ms every " << TIMELINE_BENCH_STALL_EVERY_MS << " ms; touch at";
+	for (int rate : kTouchRatesHz)
+	{
+		report << " " << rate;
+	}
+	report << " Hz, drift " << TIMELINE_BENCH_TOUCH_DRIFT_PPM << " ppm, delay " << TIMELINE_BENCH_TOUCH_DELAY_MS
+		<< " ms + " << TIMELINE_BENCH_TOUCH_JITTER_MS << " ms avg\n";
+	report << "  " << events.size() << " events, " << released.size() << " released, "
+		<< nsPerEvent << " ns each to push and release\n";
+
+	report << "  Distance from the true time, fixed delay taken out (p50 / p99 / max ms):\n";
+	for (int source = 0; source <= devices; source++)
+	{
+		double stampMedian = 0.0;
+		double stampSpread[3];
+		double arrivalMedian = 0.0;
+		double arrivalSpread[3];
+		StampSpread(stampOffsets[source], stampMedian, stampSpread);
+		StampSpread(arrivalOffsets[source], arrivalMedian, arrivalSpread);
+
+		if (source == 0)
+		{
+			const ClockEstimate clock = timeline.PenClock();
+			report << "    Pen, drift estimated " << (1.0 / clock.rate - 1.0) * 1e6 << " ppm";
+		}
+		else
+		{
+			const ClockEstimate clock = timeline.TouchClock(source);
+			const double periodMs = 1000.0 / kTouchRatesHz[source - 1] * (1.0 + TIMELINE_BENCH_TOUCH_DRIFT_PPM * 1e-6);
+			report << "    Touch " << source << ", period " << clock.rate << " ms estimated, "
+				<< (clock.rate / periodMs - 1.0) * 1e6 << " ppm off";
+		}
+		report << ":\n      stamped " << stampSpread[0] << " / " << stampSpread[1] << " / " << stampSpread[2]
+			<< " (delay left " << stampMedian << ")"
+			<< ", arrival " << arrivalSpread[0] << " / " << arrivalSpread[1] << " / " << arrivalSpread[2]
+			<< " (delay " << arrivalMedian << ")\n";
+	}
+
+	for (double marginMs : { 1.0, 3.0 })
+	{
+		report << "  Out of true order by more than " << marginMs << " ms: "
+			<< CountInversions(released.size(), marginMs, releaseTrueMs) << " released, "
+			<< CountInversions(events.size(), marginMs, arrivalTrueMs) << " as they arrived\n";
+	}
+	report << "  Merge delay, ms: p50 " << Percentile(delays, 50) << ", p99 " << Percentile(delays, 99)
+		<< ", max " << (delays.empty() ? 0.0 : delays.back())
+		<< "; held to the limit " << stats.held << ", late " << stats.late
+		<< ", reordered " << stats.reordered << ", dropped " << stats.dropped << "\n";
+
+	return report.str();
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		The benchmarks of TouchBenchmark.h, which also run headless on
+//		Linux.  They are standard C++, but for the window a benchmark
+//		measures on Windows.  Each returns its report; TouchBenchmark.cpp shows it in a
+//		message box, and PortableBenchmarkMain.cpp prints it.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Raw benchmarks: contacts per frame, and the grids (ScanSizeX x ScanSizeY)
+// tried.
+#define RAW_BENCH_CONTACTS			10
+static const int kScanSizes[][2] = { { 64, 36 }, { 128, 72 }, { 256, 144 }, { 512, 288 } };
+
+// Raw heatmap benchmark: frames rendered per size with SSE2 and with the
+// reference, and the images (1080p and 4K) rendered into.
+#define HEATMAP_BENCH_FRAMES			60
+#define HEATMAP_BENCH_REFERENCE		5
+static const int kHeatmapImages[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+
+///////////////////////////////////////////////////////////////////////////////
+// A contact of a synthetic raw frame, in cells.
+//
+struct RawBenchContact
+{
+	double	x;
+	double	y;
+};
+
+// Gaussian contacts on a jittered 5 x 2 grid, so they do not merge, over
+// noise below RAW_BLOB_THRESHOLD.  Contacts are about 12 mm across on a
+// sensor 64 cells wide, and the same size on finer grids.
+void MakeRawFrame(int width_I, int height_I, std::mt19937 &random_IO,
+	std::vector<unsigned short> &raw_O, std::vector<RawBenchContact> &contacts_O);
+
+// /touchQueueBenchmark
+std::string TouchQueueBenchmarkReport(void);
+
+// /blobMomentsBenchmark
+std::string BlobMomentsBenchmarkReport(void);
+
+// /rawBlobsBenchmark
+std::string RawBlobsBenchmarkReport(void);
+
+// /rawFilterBenchmark
+std::string RawFilterBenchmarkReport(void);
+
+// /rawHeatmapBenchmark
+std::string RawHeatmapBenchmarkReport(void);
+
+// /gestureBenchmark
+std::string GestureBenchmarkReport(void);
+
+// /palmRejectionBenchmark
+std::string PalmRejectionBenchmarkReport(void);
+
+// /hitRegionBenchmark
+std::string HitRegionBenchmarkReport(void);
+
+// /touchTransformBenchmark
+std::string TouchTransformBenchmarkReport(void);
+
+// /deviceRegistryStress.  Needs the stand-in library.
+std::string DeviceRegistryStressReport(void);
+
+// /inputTimelineBenchmark
+std::string InputTimelineBenchmarkReport(void);
+
+// /deliveryLatencyBenchmark.  prompt_I, if not null, is shown before a run
+// on a tablet, which must be touched meanwhile.  Where there are no
+// windows, needs the stand-in library linked in place of the driver's.
+std::string DeliveryLatencyBenchmarkReport(void (*prompt_I)(const std::string &));
+
+// /hitRegionJoinStress.  Needs the stand-in library.
+std::string HitRegionJoinStressReport(void);
+
+// /touchQueueReplugStress.  Needs the stand-in library.
+std::string TouchQueueReplugStressReport(void);
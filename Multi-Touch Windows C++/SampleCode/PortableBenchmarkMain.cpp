@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Command line entry point of the portable benchmarks, for running
+//		them headless where there is no sample window (see CMakeLists.txt).
+//		Takes the switches of the sample, e.g.
+//			touchbenchmark /rawHeatmapBenchmark
+//		and prints each report to stdout.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "PortableBenchmark.h"
+
+#include <cstdio>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	struct Benchmark
+	{
+		const char		*option;
+		std::string		(*run)(void);
+	};
+
+	const Benchmark kBenchmarks[] =
+	{
+		{ "/touchQueueBenchmark", TouchQueueBenchmarkReport },
+		{ "/blobMomentsBenchmark", BlobMomentsBenchmarkReport },
+		{ "/rawBlobsBenchmark", RawBlobsBenchmarkReport },
+		{ "/rawFilterBenchmark", RawFilterBenchmarkReport },
+		{ "/rawHeatmapBenchmark", RawHeatmapBenchmarkReport },
+		{ "/gestureBenchmark", GestureBenchmarkReport },
+		{ "/palmRejectionBenchmark", PalmRejectionBenchmarkReport },
+		{ "/hitRegionBenchmark", HitRegionBenchmarkReport },
+		{ "/hitRegionJoinStress", HitRegionJoinStressReport },
+		{ "/touchTransformBenchmark", TouchTransformBenchmarkReport },
+		{ "/deviceRegistryStress", DeviceRegistryStressReport },
+		{ "/touchQueueReplugStress", TouchQueueReplugStressReport },
+		{ "/deliveryLatencyBenchmark", []() { return DeliveryLatencyBenchmarkReport(nullptr); } },
+		{ "/inputTimelineBenchmark", InputTimelineBenchmarkReport }
+	};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Runs the benchmarks named on the command line, or lists them.
+//
+int main(int argc, char *argv[])
+{
+	int ran = 0;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		for (const Benchmark &benchmark : kBenchmarks)
+		{
+			if (strcmp(argv[arg], benchmark.option) == 0)
+			{
+				fputs(benchmark.run().c_str(), stdout);
+				fflush(stdout);
+				ran++;
+			}
+		}
+	}
+
+	if (ran == 0)
+	{
+		fprintf(stderr, "usage: %s benchmark...\n", argv[0]);
+		for (const Benchmark &benchmark : kBenchmarks)
+		{
+			fprintf(stderr, "  %s\n", benchmark.option);
+		}
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,544 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Blob extraction from raw sensitivity frames.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RawBlobs.h"
+
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// The eight neighbours, clockwise from the west (y grows downwards).
+	const int kNeighbourX[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+	const int kNeighbourY[8] = { 0, -1, -1, -1, 0, 1, 1, 1 };
+
+	int Direction(int dx_I, int dy_I)
+	{
+		for (int dir = 0; dir < 8; dir++)
+		{
+			if (kNeighbourX[dir] == dx_I && kNeighbourY[dir] == dy_I)
+			{
+				return dir;
+			}
+		}
+		return 0;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+RawBlobExtractor::RawBlobExtractor() :
+	mWidth(0),
+	mHeight(0),
+	mRaw(nullptr),
+	mThreshold(RAW_BLOB_THRESHOLD),
+	mTruncated(false),
+	mGeneration(0),
+	mPending(0),
+	mPhase(EPhase::ELabel),
+	mStop(false)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+RawBlobExtractor::~RawBlobExtractor()
+{
+	StopWorkers();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawBlobExtractor::Allocate(int scanSizeX_I, int scanSizeY_I, int threadCount_I)
+{
+	StopWorkers();
+
+	mWidth = std::max(scanSizeX_I, 0);
+	mHeight = std::max(scanSizeY_I, 0);
+	const int cells = mWidth * mHeight;
+
+	mParent.assign(cells, -1);
+	mLabel.assign(cells, -1);
+	mRootLabel.assign(cells, -1);
+	mRoots.assign(RAW_BLOB_MAX_COMPONENTS, 0);
+	mBlobs.reserve(RAW_BLOB_MAX);
+	mBlobs.clear();
+
+	// A contour visits each boundary cell at most once from each side.
+	mContour.resize(4 * cells + 4);
+
+	int strips = cells >= RAW_BLOB_PARALLEL_CELLS ? std::max(threadCount_I, 1) : 1;
+	strips = std::max(std::min(strips, mHeight), 1);
+
+	mStrips.resize(strips);
+	for (int idx = 0; idx < strips; idx++)
+	{
+		mStrips[idx].firstRow = mHeight * idx / strips;
+		mStrips[idx].endRow = mHeight * (idx + 1) / strips;
+		mStrips[idx].sums.reserve(RAW_BLOB_MAX_COMPONENTS);
+	}
+
+	StartWorkers(strips - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Labels the strips, joins them, numbers the components, then sums up
+//		each strip's cells per component and traces the contours.
+//
+int RawBlobExtractor::Extract(const unsigned short *raw_I, unsigned short threshold_I)
+{
+	mBlobs.clear();
+	if (!raw_I || mParent.empty())
+	{
+		return 0;
+	}
+
+	mRaw = raw_I;
+	mThreshold = threshold_I;
+
+	RunPhase(EPhase::ELabel);
+	JoinStrips();
+	NumberComponents();
+	RunPhase(EPhase::EResolve);
+	Collect();
+
+	mRaw = nullptr;
+	return static_cast<int>(mBlobs.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Union-find.  Find compresses paths as it goes, so it is only used where
+// one thread owns the cells; FindRoot only reads.
+
+int RawBlobExtractor::Find(int cell_I)
+{
+	while (mParent[cell_I] != cell_I)
+	{
+		mParent[cell_I] = mParent[mParent[cell_I]];
+		cell_I = mParent[cell_I];
+	}
+	return cell_I;
+}
+
+int RawBlobExtractor::FindRoot(int cell_I) const
+{
+	while (mParent[cell_I] != cell_I)
+	{
+		cell_I = mParent[cell_I];
+	}
+	return cell_I;
+}
+
+void RawBlobExtractor::Union(int a_I, int b_I)
+{
+	const int rootA = Find(a_I);
+	const int rootB = Find(b_I);
+	if (rootA < rootB)
+	{
+		mParent[rootB] = rootA;
+	}
+	else if (rootB < rootA)
+	{
+		mParent[rootA] = rootB;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Links each foreground cell of the strip to its foreground neighbours
+//		to the west and in the row above, within the strip.
+//
+void RawBlobExtractor::LabelStrip(Strip &strip_IO)
+{
+	for (int y = strip_IO.firstRow; y < strip_IO.endRow; y++)
+	{
+		const int row = y * mWidth;
+		for (int x = 0; x < mWidth; x++)
+		{
+			const int cell = row + x;
+			if (mRaw[cell] <= mThreshold)
+			{
+				mParent[cell] = -1;
+				continue;
+			}
+
+			mParent[cell] = cell;
+			if (x > 0 && mParent[cell - 1] >= 0)
+			{
+				Union(cell, cell - 1);
+			}
+
+			if (y > strip_IO.firstRow)
+			{
+				const int above = cell - mWidth;
+				if (x > 0 && mParent[above - 1] >= 0)
+				{
+					Union(cell, above - 1);
+				}
+				if (mParent[above] >= 0)
+				{
+					Union(cell, above);
+				}
+				if (x + 1 < mWidth && mParent[above + 1] >= 0)
+				{
+					Union(cell, above + 1);
+				}
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawBlobExtractor::JoinStrips(void)
+{
+	for (size_t idx = 1; idx < mStrips.size(); idx++)
+	{
+		const int y = mStrips[idx].firstRow;
+		for (int x = 0; x < mWidth; x++)
+		{
+			const int cell = y * mWidth + x;
+			if (mParent[cell] < 0)
+			{
+				continue;
+			}
+
+			const int above = cell - mWidth;
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if (x + dx >= 0 && x + dx < mWidth && mParent[above + dx] >= 0)
+				{
+					Union(cell, above + dx);
+				}
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Numbers the components in raster order of their first cell, up to
+//		RAW_BLOB_MAX_COMPONENTS.
+//
+void RawBlobExtractor::NumberComponents(void)
+{
+	int count = 0;
+	mTruncated = false;
+
+	const int cells = mWidth * mHeight;
+	for (int cell = 0; cell < cells; cell++)
+	{
+		if (mParent[cell] != cell)
+		{
+			continue;
+		}
+
+		if (count < RAW_BLOB_MAX_COMPONENTS)
+		{
+			mRoots[count] = cell;
+			mRootLabel[cell] = count++;
+		}
+		else
+		{
+			mRootLabel[cell] = -1;
+			mTruncated = true;
+		}
+	}
+
+	for (Strip &strip : mStrips)
+	{
+		strip.sums.resize(count);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawBlobExtractor::ResolveStrip(Strip &strip_IO)
+{
+	for (Sums &sums : strip_IO.sums)
+	{
+		sums = Sums();
+		sums.peakIndex = -1;
+		sums.minX = mWidth;
+		sums.minY = mHeight;
+		sums.maxX = -1;
+		sums.maxY = -1;
+	}
+
+	for (int y = strip_IO.firstRow; y < strip_IO.endRow; y++)
+	{
+		for (int x = 0; x < mWidth; x++)
+		{
+			const int cell = y * mWidth + x;
+			const int label = mParent[cell] < 0 ? -1 : mRootLabel[FindRoot(cell)];
+			mLabel[cell] = label;
+			if (label < 0)
+			{
+				continue;
+			}
+
+			const unsigned short value = mRaw[cell];
+			const double weight = value - mThreshold;
+			Sums &sums = strip_IO.sums[label];
+			sums.area++;
+			sums.weight += weight;
+			sums.weightX += weight * (x + 0.5);
+			sums.weightY += weight * (y + 0.5);
+			if (value > sums.peak)
+			{
+				sums.peak = value;
+				sums.peakIndex = cell;
+			}
+			sums.minX = std::min(sums.minX, x);
+			sums.minY = std::min(sums.minY, y);
+			sums.maxX = std::max(sums.maxX, x);
+			sums.maxY = std::max(sums.maxY, y);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawBlobExtractor::Collect(void)
+{
+	int points = 0;
+	const size_t components = mStrips[0].sums.size();
+
+	for (size_t label = 0; label < components; label++)
+	{
+		Sums total = mStrips[0].sums[label];
+		for (size_t strip = 1; strip < mStrips.size(); strip++)
+		{
+			const Sums &sums = mStrips[strip].sums[label];
+			if (!sums.area)
+			{
+				continue;
+			}
+
+			total.area += sums.area;
+			total.weight += sums.weight;
+			total.weightX += sums.weightX;
+			total.weightY += sums.weightY;
+			if (sums.peak > total.peak)
+			{
+				total.peak = sums.peak;
+				total.peakIndex = sums.peakIndex;
+			}
+			total.minX = std::min(total.minX, sums.minX);
+			total.minY = std::min(total.minY, sums.minY);
+			total.maxX = std::max(total.maxX, sums.maxX);
+			total.maxY = std::max(total.maxY, sums.maxY);
+		}
+
+		if (total.area < RAW_BLOB_MIN_AREA)
+		{
+			continue;
+		}
+
+		if (mBlobs.size() == RAW_BLOB_MAX)
+		{
+			mTruncated = true;
+			break;
+		}
+
+		RawBlob blob;
+		blob.area = total.area;
+		blob.weight = total.weight;
+		blob.centroidX = static_cast<float>(total.weightX / total.weight);
+		blob.centroidY = static_cast<float>(total.weightY / total.weight);
+		blob.peak = total.peak;
+		blob.peakX = total.peakIndex % mWidth;
+		blob.peakY = total.peakIndex / mWidth;
+		blob.minX = total.minX;
+		blob.minY = total.minY;
+		blob.maxX = total.maxX;
+		blob.maxY = total.maxY;
+		blob.firstPoint = points;
+		blob.pointCount = 0;
+
+		TraceContour(mRoots[label], static_cast<int>(label), blob);
+		points += blob.pointCount;
+		mBlobs.push_back(blob);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Moore neighbour tracing of the outer boundary, starting at the
+//		component's first cell in raster order (so its west neighbour is
+//		outside).  Stops on entering the first cell the way it first left it.
+//
+void RawBlobExtractor::TraceContour(int start_I, int label_I, RawBlob &blob_IO)
+{
+	const int limit = static_cast<int>(mContour.size()) - blob_IO.firstPoint;
+	RawBlobPoint *contour = mContour.data() + blob_IO.firstPoint;
+
+	int x = start_I % mWidth;
+	int y = start_I / mWidth;
+	int backtrack = 0;
+	int firstMove = -1;
+	int count = 0;
+
+	contour[count++] = { x + 0.5f, y + 0.5f };
+
+	while (count < limit)
+	{
+		int move = -1;
+		for (int step = 1; step <= 8; step++)
+		{
+			const int dir = (backtrack + step) % 8;
+			const int nx = x + kNeighbourX[dir];
+			const int ny = y + kNeighbourY[dir];
+			if (nx >= 0 && nx < mWidth && ny >= 0 && ny < mHeight && mLabel[ny * mWidth + nx] == label_I)
+			{
+				move = dir;
+				break;
+			}
+		}
+
+		if (move < 0)
+		{
+			break;		// a single cell
+		}
+
+		if (x == start_I % mWidth && y == start_I / mWidth)
+		{
+			if (move == firstMove)
+			{
+				break;
+			}
+			if (firstMove < 0)
+			{
+				firstMove = move;
+			}
+		}
+
+		// The new backtrack is the cell checked just before the move, seen
+		// from the cell moved to.
+		const int previous = (move + 7) % 8;
+		const int nx = x + kNeighbourX[move];
+		const int ny = y + kNeighbourY[move];
+		backtrack = Direction(x + kNeighbourX[previous] - nx, y + kNeighbourY[previous] - ny);
+		x = nx;
+		y = ny;
+
+		if (x == start_I % mWidth && y == start_I / mWidth)
+		{
+			continue;	// not added twice; the loop stops or goes round again
+		}
+		contour[count++] = { x + 0.5f, y + 0.5f };
+	}
+
+	blob_IO.pointCount = count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Workers
+
+void RawBlobExtractor::DoPhase(EPhase phase_I, int strip_I)
+{
+	if (phase_I == EPhase::ELabel)
+	{
+		LabelStrip(mStrips[strip_I]);
+	}
+	else
+	{
+		ResolveStrip(mStrips[strip_I]);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Runs the phase on every strip, the first one on the calling thread,
+//		and waits for all of them.
+//
+void RawBlobExtractor::RunPhase(EPhase phase_I)
+{
+	if (mWorkers.empty())
+	{
+		DoPhase(phase_I, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		mPhase = phase_I;
+		mPending = static_cast<int>(mWorkers.size());
+		mGeneration++;
+	}
+	mWake.notify_all();
+
+	DoPhase(phase_I, 0);
+
+	std::unique_lock<std::mutex> lock(mLock);
+	mDone.wait(lock, [this]() { return mPending == 0; });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawBlobExtractor::Worker(int strip_I, unsigned long long generation_I)
+{
+	unsigned long long seen = generation_I;
+	for (;;)
+	{
+		EPhase phase;
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mWake.wait(lock, [&]() { return mStop || mGeneration != seen; });
+			if (mStop)
+			{
+				return;
+			}
+			seen = mGeneration;
+			phase = mPhase;
+		}
+
+		DoPhase(phase, strip_I);
+
+		std::lock_guard<std::mutex> lock(mLock);
+		if (--mPending == 0)
+		{
+			mDone.notify_one();
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawBlobExtractor::StartWorkers(int count_I)
+{
+	mStop = false;
+	for (int idx = 0; idx < count_I; idx++)
+	{
+		mWorkers.emplace_back(&RawBlobExtractor::Worker, this, idx + 1, mGeneration);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawBlobExtractor::StopWorkers(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		mStop = true;
+	}
+	mWake.notify_all();
+
+	for (std::thread &worker : mWorkers)
+	{
+		worker.join();
+	}
+	mWorkers.clear();
+}
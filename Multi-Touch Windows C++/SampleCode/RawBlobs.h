@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Blob extraction from raw sensitivity frames.
+//
+//		Cells of the ScanSizeX x ScanSizeY grid above a threshold are grouped
+//		into 8-connected components with a union-find.  Large grids are cut
+//		into strips of rows labelled in parallel by a set of worker threads;
+//		the strips are then joined along their boundary rows.  For each
+//		component the extractor reports its area, weighted centroid, peak,
+//		bounding box and outer contour, in cell units.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Cells with a sensitivity above this are part of a blob.
+#define RAW_BLOB_THRESHOLD			4
+
+// Most blobs reported per frame, and the smallest (in cells).  Smaller
+// components, such as specks of noise around a contact, are still labelled,
+// up to RAW_BLOB_MAX_COMPONENTS per frame.
+#define RAW_BLOB_MAX					64
+#define RAW_BLOB_MIN_AREA			2
+#define RAW_BLOB_MAX_COMPONENTS	1024
+
+// Grids with fewer cells are labelled on the calling thread only.
+#define RAW_BLOB_PARALLEL_CELLS	16384
+
+///////////////////////////////////////////////////////////////////////////////
+// A point of a contour: the center of a boundary cell, in cell units.
+//
+struct RawBlobPoint
+{
+	float		x;
+	float		y;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A component.  Cell (x, y) covers [x, x + 1) x [y, y + 1); the centroid
+// is weighted by the sensitivity above the threshold.  The contour is
+// points firstPoint to firstPoint + pointCount of Contour(), clockwise.
+//
+struct RawBlob
+{
+	int					area;				// cells
+	double				weight;
+	float					centroidX;
+	float					centroidY;
+	unsigned short		peak;
+	int					peakX;
+	int					peakY;
+	int					minX;
+	int					minY;
+	int					maxX;
+	int					maxY;
+	int					firstPoint;
+	int					pointCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class RawBlobExtractor
+{
+public:
+	RawBlobExtractor();
+	~RawBlobExtractor();
+
+	// Sizes the buffers for the grid and starts up to threadCount_I - 1
+	// workers (none for small grids).  Call before extracting.
+	void Allocate(int scanSizeX_I, int scanSizeY_I, int threadCount_I);
+
+	// Finds the blobs of a frame of ScanSizeX x ScanSizeY values.  Returns
+	// the number found; the results stay valid until the next call.
+	int Extract(const unsigned short *raw_I, unsigned short threshold_I = RAW_BLOB_THRESHOLD);
+
+	const std::vector<RawBlob> &Blobs(void) const { return mBlobs; }
+	const RawBlobPoint *Contour(void) const { return mContour.data(); }
+
+	// True if the last frame had more than RAW_BLOB_MAX blobs, or more than
+	// RAW_BLOB_MAX_COMPONENTS components.
+	bool Truncated(void) const { return mTruncated; }
+
+	int ScanSizeX(void) const { return mWidth; }
+	int ScanSizeY(void) const { return mHeight; }
+	int Strips(void) const { return static_cast<int>(mStrips.size()); }
+
+private:
+	enum class EPhase
+	{
+		ELabel,
+		EResolve
+	};
+
+	// Per component sums of one strip.
+	struct Sums
+	{
+		int					area;
+		double				weight;
+		double				weightX;
+		double				weightY;
+		unsigned short		peak;
+		int					peakIndex;
+		int					minX;
+		int					minY;
+		int					maxX;
+		int					maxY;
+	};
+
+	struct Strip
+	{
+		int					firstRow;
+		int					endRow;
+		std::vector<Sums>	sums;
+	};
+
+	int Find(int cell_I);
+	int FindRoot(int cell_I) const;
+	void Union(int a_I, int b_I);
+
+	void RunPhase(EPhase phase_I);
+	void DoPhase(EPhase phase_I, int strip_I);
+	void LabelStrip(Strip &strip_IO);
+	void ResolveStrip(Strip &strip_IO);
+	void JoinStrips(void);
+	void NumberComponents(void);
+	void Collect(void);
+	void TraceContour(int start_I, int label_I, RawBlob &blob_IO);
+
+	void StartWorkers(int count_I);
+	void StopWorkers(void);
+	void Worker(int strip_I, unsigned long long generation_I);
+
+	int							mWidth;
+	int							mHeight;
+
+	// Frame being extracted.
+	const unsigned short		*mRaw;
+	unsigned short				mThreshold;
+
+	// Union-find over cells: -1 for background, else the parent cell.  The
+	// root of a component is its first cell in raster order.
+	std::vector<int>			mParent;
+	std::vector<int>			mLabel;			// component of each cell, or -1
+	std::vector<int>			mRootLabel;		// component of each root cell
+	std::vector<int>			mRoots;			// root cell of each component
+	bool							mTruncated;
+
+	std::vector<Strip>		mStrips;
+	std::vector<RawBlob>		mBlobs;
+	std::vector<RawBlobPoint>	mContour;
+
+	// Workers: strip N > 0 is worked on by thread N - 1.
+	std::vector<std::thread>	mWorkers;
+	std::mutex					mLock;
+	std::condition_variable	mWake;
+	std::condition_variable	mDone;
+	unsigned long long		mGeneration;
+	int							mPending;
+	EPhase						mPhase;
+	bool							mStop;
+};
@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Denoising of raw sensitivity frames.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RawFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#define RAW_FILTER_SSE2
+	#include <emmintrin.h>
+#endif
+
+// Groups of eight cells summed in 32-bit lanes before the noise sums are
+// carried over into 64 bits.
+#define RAW_FILTER_SUM_BLOCK		4096
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers: the unsigned 16-bit operations of SSE2, one value at a time.
+
+namespace
+{
+	const unsigned TOUCH_LEVEL = RAW_FILTER_TOUCH_LEVEL << RAW_FILTER_FRACTION_BITS;
+
+	inline unsigned SubSat(unsigned a_I, unsigned b_I)
+	{
+		return a_I > b_I ? a_I - b_I : 0;
+	}
+
+	inline unsigned AddSat(unsigned a_I, unsigned b_I)
+	{
+		return std::min(a_I + b_I, 0xffffu);
+	}
+
+	inline unsigned Average(unsigned a_I, unsigned b_I)
+	{
+		return (a_I + b_I + 1) >> 1;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+RawFrameFilter::RawFrameFilter() :
+	mPrimed(false),
+	mNoise(0.0f)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawFrameFilter::Allocate(int cellCount_I)
+{
+	const size_t cells = std::max(cellCount_I, 0);
+	mSmoothed.assign(cells, 0);
+	mBaseline.assign(cells, 0);
+	mOutput.assign(cells, 0);
+	mPrimed = false;
+	mNoise = 0.0f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned short RawFrameFilter::Threshold(void) const
+{
+	return static_cast<unsigned short>(std::max(static_cast<int>(ceil(RAW_FILTER_NOISE_FACTOR * mNoise)), RAW_FILTER_MIN_THRESHOLD));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Takes the first frame as both the smoothed value and the baseline:
+//		the sensor is assumed untouched when the filter starts.
+//
+void RawFrameFilter::Prime(const unsigned short *raw_I)
+{
+	for (size_t cell = 0; cell < mSmoothed.size(); cell++)
+	{
+		const unsigned short value = static_cast<unsigned short>(std::min<unsigned>(raw_I[cell], RAW_FILTER_MAX_INPUT) << RAW_FILTER_FRACTION_BITS);
+		mSmoothed[cell] = value;
+		mBaseline[cell] = value;
+		mOutput[cell] = 0;
+	}
+	mPrimed = true;
+	mNoise = 0.0f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Turns the summed deviations (in 1/8 counts) into a noise estimate.
+//		For white noise of deviation sigma, the change from the smoothed
+//		value has a mean absolute value of sigma * sqrt(2 / pi) *
+//		sqrt(2 / (2 - a)), with a the smoothing factor.
+//
+void RawFrameFilter::Finish(unsigned long long deviation_I, unsigned long long cells_I)
+{
+	if (!cells_I)
+	{
+		return;
+	}
+
+	const double alpha = 1.0 / (1 << RAW_FILTER_SMOOTH_SHIFT);
+	const double meanAbsolute = deviation_I / (8.0 * cells_I);
+	mNoise = static_cast<float>(meanAbsolute / (sqrt(2.0 / 3.14159265358979) * sqrt(2.0 / (2.0 - alpha))));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Filters cells [begin_I, end_I), adding the deviations of untouched
+//		cells and their number to the sums.
+//
+void RawFrameFilter::ProcessCells(const unsigned short *raw_I, int begin_I, int end_I,
+	unsigned long long &deviation_IO, unsigned long long &cells_IO)
+{
+	for (int cell = begin_I; cell < end_I; cell++)
+	{
+		const unsigned value = std::min<unsigned>(raw_I[cell], RAW_FILTER_MAX_INPUT) << RAW_FILTER_FRACTION_BITS;
+		const unsigned previous = mSmoothed[cell];
+
+		unsigned smoothed = value;
+		for (int step = 0; step < RAW_FILTER_SMOOTH_SHIFT; step++)
+		{
+			smoothed = Average(previous, smoothed);
+		}
+
+		unsigned baseline = mBaseline[cell];
+		const unsigned above = SubSat(smoothed, baseline);
+		const unsigned below = SubSat(baseline, smoothed);
+		const bool untouched = above < TOUCH_LEVEL;
+
+		if (untouched)
+		{
+			baseline = AddSat(baseline, std::min<unsigned>(above, RAW_FILTER_BASELINE_UP));
+			deviation_IO += (value > previous ? value - previous : previous - value) >> 1;
+			cells_IO++;
+		}
+		baseline = SubSat(baseline, std::min<unsigned>(below, RAW_FILTER_BASELINE_DOWN));
+
+		mSmoothed[cell] = static_cast<unsigned short>(smoothed);
+		mBaseline[cell] = static_cast<unsigned short>(baseline);
+		mOutput[cell] = static_cast<unsigned short>(SubSat(smoothed, baseline) >> RAW_FILTER_FRACTION_BITS);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned short *RawFrameFilter::ProcessReference(const unsigned short *raw_I)
+{
+	if (!raw_I || mOutput.empty())
+	{
+		return mOutput.data();
+	}
+
+	if (!mPrimed)
+	{
+		Prime(raw_I);
+		return mOutput.data();
+	}
+
+	unsigned long long deviation = 0;
+	unsigned long long cells = 0;
+	ProcessCells(raw_I, 0, CellCount(), deviation, cells);
+	Finish(deviation, cells);
+	return mOutput.data();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		The same steps as ProcessCells on eight cells at a time.  SSE2 has no
+//		unsigned 16-bit minimum or compare, so min(a, b) is a - (a -sat b),
+//		and a < b is (a -sat (b - 1)) == 0.
+//
+const unsigned short *RawFrameFilter::Process(const unsigned short *raw_I)
+{
+#if defined(RAW_FILTER_SSE2)
+	if (!raw_I || mOutput.empty())
+	{
+		return mOutput.data();
+	}
+
+	if (!mPrimed)
+	{
+		Prime(raw_I);
+		return mOutput.data();
+	}
+
+	const __m128i maxInput = _mm_set1_epi16(RAW_FILTER_MAX_INPUT);
+	const __m128i touchLimit = _mm_set1_epi16(static_cast<short>(TOUCH_LEVEL - 1));
+	const __m128i up = _mm_set1_epi16(RAW_FILTER_BASELINE_UP);
+	const __m128i down = _mm_set1_epi16(RAW_FILTER_BASELINE_DOWN);
+	const __m128i ones = _mm_set1_epi16(1);
+	const __m128i zero = _mm_setzero_si128();
+
+	unsigned short *smoothedState = mSmoothed.data();
+	unsigned short *baselineState = mBaseline.data();
+	unsigned short *output = mOutput.data();
+
+	const int count = CellCount();
+	const int vectorEnd = count & ~7;
+	unsigned long long deviation = 0;
+	unsigned long long cells = 0;
+
+	int cell = 0;
+	while (cell < vectorEnd)
+	{
+		__m128i deviationSum = zero;
+		__m128i cellSum = zero;
+
+		const int blockEnd = std::min(vectorEnd, cell + 8 * RAW_FILTER_SUM_BLOCK);
+		for (; cell < blockEnd; cell += 8)
+		{
+			const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(raw_I + cell));
+			const __m128i value = _mm_slli_epi16(_mm_sub_epi16(raw, _mm_subs_epu16(raw, maxInput)), RAW_FILTER_FRACTION_BITS);
+			const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i *>(smoothedState + cell));
+
+			__m128i smoothed = value;
+			for (int step = 0; step < RAW_FILTER_SMOOTH_SHIFT; step++)
+			{
+				smoothed = _mm_avg_epu16(previous, smoothed);
+			}
+
+			__m128i baseline = _mm_loadu_si128(reinterpret_cast<const __m128i *>(baselineState + cell));
+			const __m128i above = _mm_subs_epu16(smoothed, baseline);
+			const __m128i below = _mm_subs_epu16(baseline, smoothed);
+			const __m128i untouched = _mm_cmpeq_epi16(_mm_subs_epu16(above, touchLimit), zero);
+
+			const __m128i rise = _mm_sub_epi16(above, _mm_subs_epu16(above, up));
+			const __m128i fall = _mm_sub_epi16(below, _mm_subs_epu16(below, down));
+			baseline = _mm_adds_epu16(baseline, _mm_and_si128(rise, untouched));
+			baseline = _mm_subs_epu16(baseline, fall);
+
+			const __m128i change = _mm_or_si128(_mm_subs_epu16(value, previous), _mm_subs_epu16(previous, value));
+			deviationSum = _mm_add_epi32(deviationSum, _mm_madd_epi16(_mm_and_si128(_mm_srli_epi16(change, 1), untouched), ones));
+			cellSum = _mm_add_epi32(cellSum, _mm_madd_epi16(_mm_and_si128(untouched, ones), ones));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(smoothedState + cell), smoothed);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(baselineState + cell), baseline);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + cell),
+				_mm_srli_epi16(_mm_subs_epu16(smoothed, baseline), RAW_FILTER_FRACTION_BITS));
+		}
+
+		int lanes[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), deviationSum);
+		deviation += static_cast<unsigned long long>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), cellSum);
+		cells += static_cast<unsigned long long>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+	}
+
+	ProcessCells(raw_I, vectorEnd, count, deviation, cells);
+	Finish(deviation, cells);
+	return mOutput.data();
+#else
+	return ProcessReference(raw_I);
+#endif
+}
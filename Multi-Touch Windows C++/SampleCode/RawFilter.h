@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Denoising of raw sensitivity frames.
+//
+//		Each cell keeps an IIR smoothed value and a baseline, both unsigned
+//		16-bit with RAW_FILTER_FRACTION_BITS fraction bits, updated eight
+//		cells at a time with SSE2.  The baseline follows the smoothed value
+//		slowly where the cell is not touched, and quickly downwards, so it
+//		settles on the cell's untouched level.  The output is the smoothed
+//		value above the baseline, and the noise of the untouched cells is
+//		estimated every frame, to set blob thresholds from.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <vector>
+
+// Fixed point of the filter state; raw values are clamped so that they fit.
+#define RAW_FILTER_FRACTION_BITS		4
+#define RAW_FILTER_MAX_INPUT			4095
+
+// Smoothing: each frame moves the smoothed value 1 / 2^SHIFT of the way to
+// the new raw value.
+#define RAW_FILTER_SMOOTH_SHIFT		1
+
+// Baseline steps per frame (in 1/16 counts) towards the smoothed value, up
+// where the cell is less than RAW_FILTER_TOUCH_LEVEL counts above it, and
+// down.
+#define RAW_FILTER_BASELINE_UP		1
+#define RAW_FILTER_BASELINE_DOWN		8
+#define RAW_FILTER_TOUCH_LEVEL		8
+
+// Suggested blob threshold: this many times the noise, at least
+// RAW_FILTER_MIN_THRESHOLD counts.
+#define RAW_FILTER_NOISE_FACTOR		4.0f
+#define RAW_FILTER_MIN_THRESHOLD		2
+
+///////////////////////////////////////////////////////////////////////////////
+
+class RawFrameFilter
+{
+public:
+	RawFrameFilter();
+
+	// Sizes the state for frames of cellCount_I values, and resets it.
+	void Allocate(int cellCount_I);
+
+	// Starts again from the next frame, e.g. after the device was idle.
+	void Reset(void) { mPrimed = false; }
+
+	// Filters a frame.  Returns the denoised frame (counts above the
+	// baseline), valid until the next call.
+	const unsigned short *Process(const unsigned short *raw_I);
+
+	// Same results one cell at a time, for checking.
+	const unsigned short *ProcessReference(const unsigned short *raw_I);
+
+	// Mean absolute frame-to-frame change of the untouched cells, in counts,
+	// scaled to a standard deviation; and the threshold it suggests.
+	float Noise(void) const { return mNoise; }
+	unsigned short Threshold(void) const;
+
+	int CellCount(void) const { return static_cast<int>(mOutput.size()); }
+
+private:
+	void Prime(const unsigned short *raw_I);
+	void Finish(unsigned long long deviation_I, unsigned long long cells_I);
+	void ProcessCells(const unsigned short *raw_I, int begin_I, int end_I,
+		unsigned long long &deviation_IO, unsigned long long &cells_IO);
+
+	std::vector<unsigned short>	mSmoothed;
+	std::vector<unsigned short>	mBaseline;
+	std::vector<unsigned short>	mOutput;
+	bool									mPrimed;
+	float									mNoise;
+};
@@ -0,0 +1,323 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Heatmap images of raw sensitivity frames.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RawHeatmap.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#define RAW_HEATMAP_SSE2
+	#include <emmintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	const int WEIGHT_ONE = 1 << RAW_HEATMAP_WEIGHT_BITS;
+	const int WEIGHT_HALF = WEIGHT_ONE / 2;
+
+	// Colours of the table from cold to hot, evenly spaced over the scale.
+	const uint8_t kHeatColours[][3] =
+	{
+		{ 0, 0, 0 },			// black
+		{ 96, 0, 160 },		// purple
+		{ 255, 96, 0 },		// orange
+		{ 255, 255, 160 }		// pale yellow
+	};
+
+	inline uint32_t Bgra(int red_I, int green_I, int blue_I)
+	{
+		return 0xff000000u | (red_I << 16) | (green_I << 8) | blue_I;
+	}
+
+	// Blends one channel of two colours, as the SSE2 code does.
+	inline int Blend(uint32_t a_I, uint32_t b_I, int shift_I, int weight_I)
+	{
+		const int a = (a_I >> shift_I) & 0xff;
+		const int b = (b_I >> shift_I) & 0xff;
+		return (a * (WEIGHT_ONE - weight_I) + b * weight_I + WEIGHT_HALF) >> RAW_HEATMAP_WEIGHT_BITS;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+RawHeatmap::RawHeatmap() :
+	mScanSizeX(0),
+	mScanSizeY(0),
+	mImageWidth(0),
+	mImageHeight(0),
+	mColumnBegin(0),
+	mColumnEnd(0),
+	mRowBegin(0),
+	mRowEnd(0)
+{
+	std::fill(mLayout, mLayout + 4, INT_MIN);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawHeatmap::Allocate(int scanSizeX_I, int scanSizeY_I, int imageWidth_I, int imageHeight_I,
+	unsigned short fullScale_I)
+{
+	mScanSizeX = std::max(scanSizeX_I, 1);
+	mScanSizeY = std::max(scanSizeY_I, 1);
+	mImageWidth = std::max(imageWidth_I, 0);
+	mImageHeight = std::max(imageHeight_I, 0);
+
+	const int stops = sizeof(kHeatColours) / sizeof(kHeatColours[0]);
+	const int fullScale = std::max<int>(fullScale_I, 1);
+	mTable.resize(fullScale + 1);
+	for (int value = 0; value <= fullScale; value++)
+	{
+		const double position = static_cast<double>(value) * (stops - 1) / fullScale;
+		const int stop = std::min(static_cast<int>(position), stops - 2);
+		const double t = position - stop;
+
+		int channels[3];
+		for (int channel = 0; channel < 3; channel++)
+		{
+			channels[channel] = static_cast<int>(kHeatColours[stop][channel] * (1.0 - t) + kHeatColours[stop + 1][channel] * t + 0.5);
+		}
+		mTable[value] = Bgra(channels[0], channels[1], channels[2]);
+	}
+
+	mCells.assign((mScanSizeX + 1) * (mScanSizeY + 1), mTable[0]);
+	mBlended.assign((mScanSizeX + 1) * 4, 0);
+	mImage.assign(static_cast<size_t>(mImageWidth) * mImageHeight, mTable[0]);
+	mColumns.resize(mImageWidth);
+	mColumnWeights.resize(mImageWidth * 4);
+	mRows.resize(mImageHeight);
+	std::fill(mLayout, mLayout + 4, INT_MIN);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Looks up the colour of every cell, repeating the last column and row.
+//
+void RawHeatmap::Colour(const unsigned short *raw_I)
+{
+	const int fullScale = static_cast<int>(mTable.size()) - 1;
+	const int stride = mScanSizeX + 1;
+
+	for (int y = 0; y < mScanSizeY; y++)
+	{
+		const unsigned short *source = raw_I + y * mScanSizeX;
+		uint32_t *cells = mCells.data() + y * stride;
+		for (int x = 0; x < mScanSizeX; x++)
+		{
+			cells[x] = mTable[std::min<int>(source[x], fullScale)];
+		}
+		cells[mScanSizeX] = cells[mScanSizeX - 1];
+	}
+	std::copy(mCells.begin() + (mScanSizeY - 1) * stride, mCells.begin() + mScanSizeY * stride,
+		mCells.begin() + mScanSizeY * stride);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Finds, for each of pixels_I image columns (or rows), the cell under
+//		its center when cells_I cells are stretched over length_I pixels from
+//		offset_I, and how far it is towards the next cell.  Pixels [begin_O,
+//		end_O) are the ones covered.
+//
+void RawHeatmap::Map(int offset_I, int length_I, int cells_I, int pixels_I,
+	std::vector<Sample> &samples_O, int &begin_O, int &end_O)
+{
+	begin_O = std::min(std::max(offset_I, 0), pixels_I);
+	end_O = length_I > 0 ? std::max(std::min(offset_I + length_I, pixels_I), begin_O) : begin_O;
+
+	for (int pixel = begin_O; pixel < end_O; pixel++)
+	{
+		const double position = std::min(std::max((pixel - offset_I + 0.5) * cells_I / length_I - 0.5, 0.0),
+			static_cast<double>(cells_I - 1));
+
+		Sample &sample = samples_O[pixel];
+		sample.cell = static_cast<int>(position);
+		sample.weight = static_cast<int>((position - sample.cell) * WEIGHT_ONE + 0.5);
+		if (sample.weight == WEIGHT_ONE)
+		{
+			sample.cell++;
+			sample.weight = 0;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RawHeatmap::Layout(int left_I, int top_I, int width_I, int height_I)
+{
+	if (mLayout[0] == left_I && mLayout[1] == top_I && mLayout[2] == width_I && mLayout[3] == height_I)
+	{
+		return;
+	}
+
+	Map(left_I, width_I, mScanSizeX, mImageWidth, mColumns, mColumnBegin, mColumnEnd);
+	for (int x = mColumnBegin; x < mColumnEnd; x++)
+	{
+		std::fill(mColumnWeights.begin() + x * 4, mColumnWeights.begin() + x * 4 + 4, static_cast<uint16_t>(mColumns[x].weight));
+	}
+	Map(top_I, height_I, mScanSizeY, mImageHeight, mRows, mRowBegin, mRowEnd);
+	mLayout[0] = left_I;
+	mLayout[1] = top_I;
+	mLayout[2] = width_I;
+	mLayout[3] = height_I;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t *RawHeatmap::RenderReference(const unsigned short *raw_I, int left_I, int top_I, int width_I, int height_I)
+{
+	if (!raw_I || mImage.empty())
+	{
+		return mImage.data();
+	}
+
+	Colour(raw_I);
+	Layout(left_I, top_I, width_I, height_I);
+
+	const int stride = mScanSizeX + 1;
+	std::fill(mImage.begin(), mImage.end(), mTable[0]);
+
+	for (int y = mRowBegin; y < mRowEnd; y++)
+	{
+		const Sample &row = mRows[y];
+		const uint32_t *top = mCells.data() + row.cell * stride;
+		const uint32_t *bottom = top + stride;
+		uint32_t *pixels = mImage.data() + static_cast<size_t>(y) * mImageWidth;
+
+		for (int x = mColumnBegin; x < mColumnEnd; x++)
+		{
+			const Sample &column = mColumns[x];
+			int channels[3];
+			for (int channel = 0; channel < 3; channel++)
+			{
+				const int shift = 16 - 8 * channel;
+				const int left = Blend(top[column.cell], bottom[column.cell], shift, row.weight);
+				const int right = Blend(top[column.cell + 1], bottom[column.cell + 1], shift, row.weight);
+				channels[channel] = (left * (WEIGHT_ONE - column.weight) + right * column.weight + WEIGHT_HALF) >> RAW_HEATMAP_WEIGHT_BITS;
+			}
+			pixels[x] = Bgra(channels[0], channels[1], channels[2]);
+		}
+	}
+	return mImage.data();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		The same blends as RenderReference with SSE2.  For each image row,
+//		the two cell rows around it are blended into mBlended, two cells at
+//		a time.  Pixels are then blended horizontally two at a time: each
+//		loads its blended cell and the next one, the two left and the two
+//		right cells are gathered into a register each, and the 16-bit
+//		channels are weighted together.
+//
+const uint32_t *RawHeatmap::Render(const unsigned short *raw_I, int left_I, int top_I, int width_I, int height_I)
+{
+#if defined(RAW_HEATMAP_SSE2)
+	if (!raw_I || mImage.empty())
+	{
+		return mImage.data();
+	}
+
+	Colour(raw_I);
+	Layout(left_I, top_I, width_I, height_I);
+
+	const int stride = mScanSizeX + 1;
+	const uint32_t background = mTable[0];
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one16 = _mm_set1_epi16(WEIGHT_ONE);
+	const __m128i half16 = _mm_set1_epi16(WEIGHT_HALF);
+
+	std::fill(mImage.begin(), mImage.begin() + static_cast<size_t>(mRowBegin) * mImageWidth, background);
+	std::fill(mImage.begin() + static_cast<size_t>(mRowEnd) * mImageWidth, mImage.end(), background);
+
+	int blendedRow = -1;
+	int blendedWeight = -1;
+	for (int y = mRowBegin; y < mRowEnd; y++)
+	{
+		const Sample &row = mRows[y];
+		uint32_t *pixels = mImage.data() + static_cast<size_t>(y) * mImageWidth;
+
+		// Rows stretched over several pixels often sample the same place.
+		if (row.cell != blendedRow || row.weight != blendedWeight)
+		{
+			const uint32_t *top = mCells.data() + row.cell * stride;
+			const uint32_t *bottom = top + stride;
+			uint16_t *blended = mBlended.data();
+
+			const __m128i topWeight = _mm_set1_epi16(static_cast<short>(WEIGHT_ONE - row.weight));
+			const __m128i bottomWeight = _mm_set1_epi16(static_cast<short>(row.weight));
+
+			int cell = 0;
+			for (; cell + 2 <= stride; cell += 2)
+			{
+				const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(top + cell)), zero);
+				const __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(bottom + cell)), zero);
+				const __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(a, topWeight), _mm_mullo_epi16(b, bottomWeight)), half16);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(blended + cell * 4), _mm_srli_epi16(sum, RAW_HEATMAP_WEIGHT_BITS));
+			}
+			for (; cell < stride; cell++)
+			{
+				for (int channel = 0; channel < 4; channel++)
+				{
+					blended[cell * 4 + channel] = static_cast<uint16_t>(Blend(top[cell], bottom[cell], 8 * channel, row.weight));
+				}
+			}
+
+			blendedRow = row.cell;
+			blendedWeight = row.weight;
+		}
+
+		std::fill(pixels, pixels + mColumnBegin, background);
+		std::fill(pixels + mColumnEnd, pixels + mImageWidth, background);
+
+		const uint16_t *blended = mBlended.data();
+		int x = mColumnBegin;
+		for (; x + 4 <= mColumnEnd; x += 4)
+		{
+			__m128i result[2];
+			for (int pair = 0; pair < 2; pair++)
+			{
+				const Sample *columns = mColumns.data() + x + 2 * pair;
+				const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blended + columns[0].cell * 4));
+				const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blended + columns[1].cell * 4));
+				const __m128i left = _mm_unpacklo_epi64(first, second);
+				const __m128i right = _mm_unpackhi_epi64(first, second);
+				const __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mColumnWeights.data() + (x + 2 * pair) * 4));
+				const __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(left, _mm_sub_epi16(one16, weight)), _mm_mullo_epi16(right, weight)), half16);
+				result[pair] = _mm_srli_epi16(sum, RAW_HEATMAP_WEIGHT_BITS);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(pixels + x), _mm_packus_epi16(result[0], result[1]));
+		}
+		for (; x < mColumnEnd; x++)
+		{
+			const Sample &column = mColumns[x];
+			const uint16_t *left = blended + column.cell * 4;
+			uint32_t colour = 0;
+			for (int channel = 0; channel < 4; channel++)
+			{
+				const uint32_t value = (left[channel] * (WEIGHT_ONE - column.weight) + left[channel + 4] * column.weight + WEIGHT_HALF) >> RAW_HEATMAP_WEIGHT_BITS;
+				colour |= value << (8 * channel);
+			}
+			pixels[x] = colour;
+		}
+	}
+	return mImage.data();
+#else
+	return RenderReference(raw_I, left_I, top_I, width_I, height_I);
+#endif
+}
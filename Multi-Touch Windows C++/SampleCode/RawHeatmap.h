@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Heatmap images of raw sensitivity frames.
+//
+//		Each cell of the ScanSizeX x ScanSizeY grid is turned into a colour
+//		through a lookup table, and the cell colours are stretched bilinearly
+//		over a rectangle of a 32-bit BGRA image, with SSE2.  The image can be
+//		presented with a single blit of a top-down DIB.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Sensitivity shown in the hottest colour; anything above it is clamped.
+#define RAW_HEATMAP_FULL_SCALE		255
+
+// Interpolation weights are fixed point with this many fraction bits.
+#define RAW_HEATMAP_WEIGHT_BITS		7
+
+///////////////////////////////////////////////////////////////////////////////
+
+class RawHeatmap
+{
+public:
+	RawHeatmap();
+
+	// Sizes the buffers for a grid and an image of imageWidth_I x
+	// imageHeight_I pixels, and builds the colour table.
+	void Allocate(int scanSizeX_I, int scanSizeY_I, int imageWidth_I, int imageHeight_I,
+		unsigned short fullScale_I = RAW_HEATMAP_FULL_SCALE);
+
+	// Draws a frame of ScanSizeX x ScanSizeY values stretched over the
+	// rectangle at (left_I, top_I) of width_I x height_I pixels; the rest of
+	// the image gets the colour of 0.  The rectangle may reach outside the
+	// image.  Returns the image rows, top first, valid until the next call.
+	const uint32_t *Render(const unsigned short *raw_I, int left_I, int top_I, int width_I, int height_I);
+
+	// Same image one pixel at a time, for checking.
+	const uint32_t *RenderReference(const unsigned short *raw_I, int left_I, int top_I, int width_I, int height_I);
+
+	int ScanSizeX(void) const { return mScanSizeX; }
+	int ScanSizeY(void) const { return mScanSizeY; }
+	int ImageWidth(void) const { return mImageWidth; }
+	int ImageHeight(void) const { return mImageHeight; }
+
+private:
+	// Source cell and weight of the next cell, for each image column or row.
+	struct Sample
+	{
+		int		cell;
+		int		weight;
+	};
+
+	void Colour(const unsigned short *raw_I);
+	void Map(int offset_I, int length_I, int cells_I, int pixels_I,
+		std::vector<Sample> &samples_O, int &begin_O, int &end_O);
+	void Layout(int left_I, int top_I, int width_I, int height_I);
+
+	int							mScanSizeX;
+	int							mScanSizeY;
+	int							mImageWidth;
+	int							mImageHeight;
+
+	// Colour of each sensitivity up to the full scale.
+	std::vector<uint32_t>	mTable;
+
+	// Cell colours, one extra column and row repeating the last so that
+	// every sample has a next cell.
+	std::vector<uint32_t>	mCells;
+
+	// Rectangle the samples were computed for, and the image columns and
+	// rows it covers.
+	int							mLayout[4];
+	int							mColumnBegin;
+	int							mColumnEnd;
+	int							mRowBegin;
+	int							mRowEnd;
+	std::vector<Sample>		mColumns;
+	std::vector<Sample>		mRows;
+	std::vector<uint16_t>	mColumnWeights;	// each column's, for four channels
+
+	// One row of cell colours blended vertically, 16 bits per channel.
+	std::vector<uint16_t>	mBlended;
+
+	std::vector<uint32_t>	mImage;
+};
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Offline benchmarks of the touch processing in this sample.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "TouchBenchmark.h"
+#include "PortableBenchmark.h"
+
+#include <string>
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	// Delivery latency benchmark: asks for the tablet to be touched.
+	void ShowDeliveryPrompt(const std::string &prompt_I)
+	{
+		MessageBoxA(nullptr, prompt_I.c_str(), "Delivery Latency Benchmark", MB_OK | MB_ICONINFORMATION);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable touch queue benchmark.
+//
+void RunTouchQueueBenchmark(void)
+{
+	const std::string report = TouchQueueBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Touch Queue Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable blob moments benchmark.
+//
+void RunBlobMomentsBenchmark(void)
+{
+	const std::string report = BlobMomentsBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Blob Moments Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable raw blobs benchmark.
+//
+void RunRawBlobsBenchmark(void)
+{
+	const std::string report = RawBlobsBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Raw Blobs Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable raw filter benchmark.
+//
+void RunRawFilterBenchmark(void)
+{
+	const std::string report = RawFilterBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Raw Filter Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable raw heatmap benchmark.
+//
+void RunRawHeatmapBenchmark(void)
+{
+	const std::string report = RawHeatmapBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Raw Heatmap Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable gesture benchmark.
+//
+void RunGestureBenchmark(void)
+{
+	const std::string report = GestureBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Gesture Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable palm rejection benchmark.
+//
+void RunPalmRejectionBenchmark(void)
+{
+	const std::string report = PalmRejectionBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Palm Rejection Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable hit region benchmark.
+//
+void RunHitRegionBenchmark(void)
+{
+	const std::string report = HitRegionBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Hit Region Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable hit region join stress test.
+//
+void RunHitRegionJoinStress(void)
+{
+	const std::string report = HitRegionJoinStressReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Hit Region Join Stress", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable touch transform benchmark.
+//
+void RunTouchTransformBenchmark(void)
+{
+	const std::string report = TouchTransformBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Touch Transform Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable device registry stress test.
+//
+void RunDeviceRegistryStress(void)
+{
+	const std::string report = DeviceRegistryStressReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Device Registry Stress", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable touch queue re-plug stress test.
+//
+void RunTouchQueueReplugStress(void)
+{
+	const std::string report = TouchQueueReplugStressReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Touch Queue Re-plug Stress", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable delivery latency benchmark.
+//
+void RunDeliveryLatencyBenchmark(void)
+{
+	const std::string report = DeliveryLatencyBenchmarkReport(ShowDeliveryPrompt);
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Delivery Latency Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Shows the report of the portable input timeline benchmark.
+//
+void RunInputTimelineBenchmark(void)
+{
+	const std::string report = InputTimelineBenchmarkReport();
+	OutputDebugStringA(report.c_str());
+	MessageBoxA(nullptr, report.c_str(), "Input Timeline Benchmark", MB_OK | MB_ICONINFORMATION);
+}
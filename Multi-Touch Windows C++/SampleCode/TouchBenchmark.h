@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Offline benchmarks of the touch processing in this sample, run from
+//		the command line instead of opening the window.  They need no tablet;
+//		the touch data is synthetic.  Results are traced and shown in a
+//		message box.  All of them also run headless, printing their reports
+//		(see PortableBenchmark.h).
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// /touchQueueBenchmark: time spent in the finger callback, and frames
+// superseded or dropped, when drawing happens in the callback and when it
+// happens on a render thread behind the TouchFrameQueue.
+void RunTouchQueueBenchmark(void);
+
+// /blobMomentsBenchmark: time per point of the SSE2 blob moments against
+// the double precision reference, at several BlobPointsMax sizes, and the
+// largest difference between their results.
+void RunBlobMomentsBenchmark(void);
+
+// /rawBlobsBenchmark: time per raw frame of the RawBlobExtractor on grids
+// from a 64 x 36 sensor up to a large one, on one thread and on all cores,
+// and how well the blobs found match the synthetic contacts.
+void RunRawBlobsBenchmark(void);
+
+// /rawFilterBenchmark: time per raw frame of the RawFrameFilter, SSE2 and
+// reference, on the grids of the raw blobs benchmark, and the noise it
+// estimates on synthetic frames of known noise.
+void RunRawFilterBenchmark(void);
+
+// /rawHeatmapBenchmark: frames per second of the RawHeatmap, SSE2 and
+// reference, rendering raw frames into 1080p and 4K images off screen.
+void RunRawHeatmapBenchmark(void);
+
+// /gestureBenchmark: how many frames the GestureRecognizer takes to report
+// scripted pans, pinches, rotations and taps, and its time per frame.
+void RunGestureBenchmark(void);
+
+// /palmRejectionBenchmark: precision and recall of the PalmRejector on
+// replayed writing and touch sessions, on the first frame of each contact
+// and by its lift, against the driver's confidence alone, and its time per
+// frame.
+void RunPalmRejectionBenchmark(void);
+
+// /hitRegionBenchmark: MTAPI calls during a simulated window drag, moving
+// the hit rect on every WM_MOVE and through the HitRegionManager, and the
+// time to route a finger to one of many regions.
+void RunHitRegionBenchmark(void);
+
+// /hitRegionJoinStress: splits a display of the stand-in wacommt.dll into
+// hit regions, so that frames come in parts, and checks that the queue
+// joins them into frames that keep the finger tracks whole.
+void RunHitRegionJoinStress(void);
+
+// /touchTransformBenchmark: time per finger of converting the fingers of
+// four devices to client pixels and millimeters, as DrawFingerData did per
+// finger and through cached TouchTransforms, SSE2 and reference.
+void RunTouchTransformBenchmark(void);
+
+// /deviceRegistryStress: hot-plugs devices of the stand-in wacommt.dll
+// every few milliseconds while they deliver fingers at 1 kHz, and checks
+// that the DeviceRegistry's readers always see whole, valid devices.  Needs
+// the stand-in library instead of the driver's.
+void RunDeviceRegistryStress(void);
+
+// /touchQueueReplugStress: plugs devices of the stand-in wacommt.dll in and
+// out, each with a new ID, far more of them than the TouchFrameQueue has
+// channels, and checks that releasing each one's channel on detach keeps
+// every frame coming.
+void RunTouchQueueReplugStress(void);
+
+// /deliveryLatencyBenchmark: how far window messages (WM_FINGERDATA) lag
+// the finger callback for the same frames, their jitter and the frames they
+// drop, at several bufferDepth values, while the window thread is busy now
+// and then.  Runs on a touched tablet or the stand-in library;
+// headless, on the stand-in's post function.
+void RunDeliveryLatencyBenchmark(void);
+
+// /inputTimelineBenchmark: how closely the InputTimeline's stamps follow
+// the true times of simulated pen packets and touch frames on drifting
+// clocks, how well it restores their order, and the delay the merge adds.
+void RunInputTimelineBenchmark(void);
@@ -0,0 +1,536 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Hand-off of touch frames from the Feel Multi-Touch callbacks to a
+//		render thread.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TouchFrameQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Copies the fingers after those of the frame so far, with the region
+	//		that delivered them.  Hit rects may overlap, so a finger whose ID
+	//		is already there is not copied again.  Returns false if some did
+	//		not fit.
+	//
+	bool AppendFingers(TouchFrame &frame_IO, const WacomMTFingerCollection &fingerData_I, int regionID_I)
+	{
+		const int fingerCount = fingerData_I.Fingers ? std::max(fingerData_I.FingerCount, 0) : 0;
+		const int capacity = static_cast<int>(frame_IO.fingers.size());
+		const std::vector<WacomMTFinger>::const_iterator begin = frame_IO.fingers.begin();
+		const std::vector<WacomMTFinger>::const_iterator end = begin + frame_IO.count;
+		int copied = 0;
+
+		for (int idx = 0; idx < fingerCount; idx++)
+		{
+			const WacomMTFinger &finger = fingerData_I.Fingers[idx];
+			if (std::find_if(begin, end, [&finger](const WacomMTFinger &copy_I) { return copy_I.FingerID == finger.FingerID; }) == end)
+			{
+				if (frame_IO.count == capacity)
+				{
+					break;
+				}
+				frame_IO.fingers[frame_IO.count] = finger;
+				frame_IO.regions[frame_IO.count] = regionID_I;
+				frame_IO.count++;
+			}
+			copied++;
+		}
+		return copied == fingerCount;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TouchFrameLimits::TouchFrameLimits() :
+	fingers(TOUCH_QUEUE_MIN_FINGERS),
+	blobs(TOUCH_QUEUE_MIN_BLOBS),
+	blobPoints(TOUCH_QUEUE_MIN_BLOB_POINTS),
+	rawElements(TOUCH_QUEUE_MIN_RAW)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchFrameLimits::Include(const WacomMTCapability &caps_I)
+{
+	fingers = std::max(fingers, caps_I.FingerMax);
+	blobs = std::max(blobs, caps_I.BlobMax);
+	blobPoints = std::max(blobPoints, caps_I.BlobMax * caps_I.BlobPointsMax);
+	rawElements = std::max(rawElements, caps_I.ScanSizeX * caps_I.ScanSizeY);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TouchFrame::TouchFrame() :
+	type(ETouchFrameType::EFingerFrame),
+	deviceID(0),
+	frameNumber(0),
+	count(0),
+	truncated(false),
+	arrivalMs(0.0),
+	joined(false),
+	previousFrameNumber(-1),
+	previousCount(-1)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchFrame::Allocate(const TouchFrameLimits &limits_I)
+{
+	fingers.resize(limits_I.fingers);
+	regions.resize(limits_I.fingers);
+	blobs.Allocate(limits_I.blobs, limits_I.blobPoints);
+	raw.resize(limits_I.rawElements);
+	count = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchFrame::CopyFrom(const TouchFrame &frame_I)
+{
+	type = frame_I.type;
+	deviceID = frame_I.deviceID;
+	frameNumber = frame_I.frameNumber;
+	truncated = frame_I.truncated;
+	arrivalMs = frame_I.arrivalMs;
+	joined = frame_I.joined;
+	previousFrameNumber = frame_I.previousFrameNumber;
+	previousCount = frame_I.previousCount;
+
+	if (type == ETouchFrameType::EBlobFrame)
+	{
+		blobs.CopyFrom(frame_I.blobs);
+		count = blobs.BlobCount();
+	}
+	else
+	{
+		count = std::min(frame_I.count, static_cast<int>(fingers.size()));
+		std::copy(frame_I.fingers.begin(), frame_I.fingers.begin() + count, fingers.begin());
+		std::copy(frame_I.regions.begin(), frame_I.regions.begin() + count, regions.begin());
+	}
+	truncated = truncated || count < frame_I.count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TouchFrameTripleBuffer::TouchFrameTripleBuffer() :
+	mShared(1),
+	mBack(0),
+	mFront(2)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchFrameTripleBuffer::Allocate(const TouchFrameLimits &limits_I)
+{
+	for (TouchFrame &frame : mFrames)
+	{
+		frame.Allocate(limits_I);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Swaps the filled back frame with the shared one.  The release half of
+//		the exchange makes the frame contents visible to the consumer that
+//		takes it.
+//
+bool TouchFrameTripleBuffer::Publish(void)
+{
+	const unsigned previous = mShared.exchange(mBack | FRESH_BIT, std::memory_order_acq_rel);
+	mBack = previous & ~FRESH_BIT;
+	return (previous & FRESH_BIT) != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const TouchFrame *TouchFrameTripleBuffer::TakeLatest(void)
+{
+	if (!(mShared.load(std::memory_order_relaxed) & FRESH_BIT))
+	{
+		return nullptr;
+	}
+
+	const unsigned previous = mShared.exchange(mFront, std::memory_order_acq_rel);
+	mFront = previous & ~FRESH_BIT;
+	return &mFrames[mFront];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TouchFrameQueue::TouchFrameQueue() :
+	mPublished(0),
+	mSuperseded(0),
+	mDropped(0),
+	mTruncated(0),
+	mRendered(0),
+	mLate(0)
+{
+	for (Channel &channel : mChannels)
+	{
+		channel.deviceID = NO_DEVICE;
+		channel.releases = 0;
+		channel.seenReleases = 0;
+		channel.joining = false;
+		channel.holding = false;
+		channel.hasSettled = false;
+		channel.heldMs = 0.0;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchFrameQueue::Allocate(const TouchFrameLimits &limits_I)
+{
+	for (Channel &channel : mChannels)
+	{
+		channel.buffer.Allocate(limits_I);
+		channel.parts.Allocate(limits_I);
+		channel.held.Allocate(limits_I);
+		channel.settled.Allocate(limits_I);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Finds the device's channel, claiming a free one the first time the
+//		device delivers a frame.  Channels are freed by Release, so one
+//		before the device's own may be free: the device's is looked for
+//		first.  Only the device's thread claims for it.
+//
+TouchFrameQueue::Channel *TouchFrameQueue::Find(int deviceID_I)
+{
+	for (Channel &channel : mChannels)
+	{
+		if (channel.deviceID.load(std::memory_order_acquire) == deviceID_I)
+		{
+			return &channel;
+		}
+	}
+
+	for (Channel &channel : mChannels)
+	{
+		int owner = NO_DEVICE;
+		if (channel.deviceID.compare_exchange_strong(owner, deviceID_I, std::memory_order_acq_rel))
+		{
+			return &channel;
+		}
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Resets the producer's side of the channel, then frees it.  A device
+//		that takes it next sees the reset, and so does the consumer, by the
+//		count of releases.
+//
+void TouchFrameQueue::Release(int deviceID_I)
+{
+	for (Channel &channel : mChannels)
+	{
+		if (channel.deviceID.load(std::memory_order_acquire) == deviceID_I)
+		{
+			channel.joining = false;
+			channel.releases.fetch_add(1, std::memory_order_relaxed);
+			channel.deviceID.store(NO_DEVICE, std::memory_order_release);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Starts joining a frame when a part is not of the one being joined,
+//		which has then ended: the new frame keeps its number and count.
+//		Returns true if a frame was started.
+//
+bool TouchFrameQueue::Join(Channel &channel_IO, ETouchFrameType type_I, int deviceID_I, int frameNumber_I)
+{
+	TouchFrame &parts = channel_IO.parts;
+	if (channel_IO.joining && parts.type == type_I && parts.frameNumber == frameNumber_I)
+	{
+		return false;
+	}
+
+	const bool previous = channel_IO.joining && parts.type == type_I;
+	parts.previousFrameNumber = previous ? parts.frameNumber : -1;
+	parts.previousCount = previous ? parts.count : -1;
+	parts.type = type_I;
+	parts.deviceID = deviceID_I;
+	parts.frameNumber = frameNumber_I;
+	parts.count = 0;
+	parts.truncated = false;
+	parts.joined = true;
+	channel_IO.joining = true;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchFrameQueue::Publish(TouchFrameTripleBuffer &buffer_I, bool truncated_I)
+{
+	if (truncated_I)
+	{
+		mTruncated.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (buffer_I.Publish())
+	{
+		mSuperseded.fetch_add(1, std::memory_order_relaxed);
+	}
+	mPublished.fetch_add(1, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TouchFrameQueue::PushFingers(const WacomMTFingerCollection *fingerData_I, double arrivalMs_I, int regionID_I)
+{
+	if (!fingerData_I)
+	{
+		return false;
+	}
+
+	Channel *channel = Find(fingerData_I->DeviceID);
+	if (!channel)
+	{
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	TouchFrame &frame = channel->buffer.BackFrame();
+	if (regionID_I)
+	{
+		TouchFrame &parts = channel->parts;
+		if (Join(*channel, ETouchFrameType::EFingerFrame, fingerData_I->DeviceID, fingerData_I->FrameNumber))
+		{
+			parts.arrivalMs = arrivalMs_I;
+		}
+		parts.truncated = !AppendFingers(parts, *fingerData_I, regionID_I) || parts.truncated;
+		frame.CopyFrom(parts);
+	}
+	else
+	{
+		frame.type = ETouchFrameType::EFingerFrame;
+		frame.deviceID = fingerData_I->DeviceID;
+		frame.frameNumber = fingerData_I->FrameNumber;
+		frame.arrivalMs = arrivalMs_I;
+		frame.joined = false;
+		frame.count = 0;
+		frame.truncated = !AppendFingers(frame, *fingerData_I, 0);
+		channel->joining = false;
+	}
+
+	Publish(channel->buffer, frame.truncated);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TouchFrameQueue::PushBlobs(const WacomMTBlobAggregate *blobData_I, int regionID_I)
+{
+	if (!blobData_I)
+	{
+		return false;
+	}
+
+	Channel *channel = Find(blobData_I->DeviceID);
+	if (!channel)
+	{
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	TouchFrame &frame = channel->buffer.BackFrame();
+	if (regionID_I)
+	{
+		TouchFrame &parts = channel->parts;
+		if (Join(*channel, ETouchFrameType::EBlobFrame, blobData_I->DeviceID, blobData_I->FrameNumber))
+		{
+			parts.blobs.Capture(*blobData_I);
+		}
+		else
+		{
+			parts.blobs.Append(*blobData_I);
+		}
+		parts.count = parts.blobs.BlobCount();
+		parts.truncated = parts.blobs.Truncated();
+		frame.CopyFrom(parts);
+	}
+	else
+	{
+		frame.type = ETouchFrameType::EBlobFrame;
+		frame.deviceID = blobData_I->DeviceID;
+		frame.frameNumber = blobData_I->FrameNumber;
+		frame.joined = false;
+		frame.truncated = !frame.blobs.Capture(*blobData_I);
+		frame.count = frame.blobs.BlobCount();
+		channel->joining = false;
+	}
+
+	Publish(channel->buffer, frame.truncated);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TouchFrameQueue::PushRaw(const WacomMTRawData *rawData_I)
+{
+	if (!rawData_I)
+	{
+		return false;
+	}
+
+	Channel *channel = Find(rawData_I->DeviceID);
+	if (!channel)
+	{
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	TouchFrame &frame = channel->buffer.BackFrame();
+	frame.type = ETouchFrameType::ERawFrame;
+	frame.deviceID = rawData_I->DeviceID;
+	frame.frameNumber = rawData_I->FrameNumber;
+	frame.joined = false;
+	frame.count = std::min(rawData_I->ElementCount, static_cast<int>(frame.raw.size()));
+	if (frame.count > 0 && rawData_I->Sensitivity)
+	{
+		memcpy(frame.raw.data(), rawData_I->Sensitivity, frame.count * sizeof(unsigned short));
+	}
+	else
+	{
+		frame.count = 0;
+	}
+
+	frame.truncated = frame.count < rawData_I->ElementCount;
+	Publish(channel->buffer, frame.truncated);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Takes the channel's newest frame, if a device has it.  A joined finger frame is held
+//		until it settles: when a frame follows that shows it ended as held,
+//		or when no part came for TOUCH_QUEUE_SETTLE_MS.  One that a later
+//		frame shows to have lost a part counts as superseded.  Returns the
+//		frames to visit, in order: a settled one, then the one taken.
+//
+int TouchFrameQueue::Take(Channel &channel_IO, double nowMs_I, const TouchFrame *taken_O[2])
+{
+	// The device is read first: a device that took the channel after a
+	// release comes with it.
+	const bool free = channel_IO.deviceID.load(std::memory_order_acquire) == NO_DEVICE;
+	const unsigned releases = channel_IO.releases.load(std::memory_order_acquire);
+	if (releases != channel_IO.seenReleases)
+	{
+		channel_IO.seenReleases = releases;
+		channel_IO.holding = false;
+		channel_IO.hasSettled = false;
+	}
+	if (free)
+	{
+		return 0;
+	}
+
+	const TouchFrame *frame = channel_IO.buffer.TakeLatest();
+	bool parts = frame && frame->joined && frame->type == ETouchFrameType::EFingerFrame;
+	int count = 0;
+
+	if (parts && channel_IO.hasSettled && frame->frameNumber == channel_IO.settled.frameNumber)
+	{
+		mLate.fetch_add(1, std::memory_order_relaxed);
+		frame = nullptr;
+		parts = false;
+	}
+
+	if (channel_IO.holding)
+	{
+		const TouchFrame &held = channel_IO.held;
+		bool settle = false;
+		if (!frame)
+		{
+			settle = nowMs_I - channel_IO.heldMs >= TOUCH_QUEUE_SETTLE_MS;
+			if (!settle)
+			{
+				return 0;
+			}
+		}
+		else if (!parts || (frame->previousFrameNumber == held.frameNumber && frame->previousCount == held.count))
+		{
+			settle = true;
+		}
+		else if (frame->frameNumber != held.frameNumber)
+		{
+			mSuperseded.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (settle)
+		{
+			std::swap(channel_IO.held, channel_IO.settled);
+			channel_IO.hasSettled = true;
+			taken_O[count++] = &channel_IO.settled;
+		}
+		channel_IO.holding = false;
+	}
+
+	if (parts)
+	{
+		channel_IO.held.CopyFrom(*frame);
+		channel_IO.holding = true;
+		channel_IO.heldMs = nowMs_I;
+	}
+	else if (frame)
+	{
+		taken_O[count++] = frame;
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+double TouchFrameQueue::NextSettleMs(double nowMs_I) const
+{
+	double next = -1.0;
+	for (const Channel &channel : mChannels)
+	{
+		if (channel.holding)
+		{
+			const double dueMs = std::max(channel.heldMs + TOUCH_QUEUE_SETTLE_MS - nowMs_I, 0.0);
+			next = next < 0.0 ? dueMs : std::min(next, dueMs);
+		}
+	}
+	return next;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TouchFrameStats TouchFrameQueue::Stats(void) const
+{
+	TouchFrameStats stats;
+	stats.published = mPublished.load(std::memory_order_relaxed);
+	stats.superseded = mSuperseded.load(std::memory_order_relaxed);
+	stats.dropped = mDropped.load(std::memory_order_relaxed);
+	stats.truncated = mTruncated.load(std::memory_order_relaxed);
+	stats.rendered = mRendered.load(std::memory_order_relaxed);
+	stats.late = mLate.load(std::memory_order_relaxed);
+	return stats;
+}
@@ -0,0 +1,240 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Hand-off of touch frames from the Feel Multi-Touch callbacks to a
+//		render thread.
+//
+//		Each device gets a triple buffer of preallocated frames.  The callback
+//		copies the frame into the back buffer and publishes it with a single
+//		atomic exchange, so it never waits for drawing.  The render thread
+//		takes the newest published frame of each device; a frame replaced
+//		before the render thread got to it counts as superseded.
+//
+//		With hit regions, the driver delivers a frame in parts: each region's
+//		callback gets the contacts within its rect, one after the other.  The
+//		queue joins the parts of a device's frame by FrameNumber and publishes
+//		what it has so far with each part.  Finger frames drive the trackers
+//		and gestures, so the render thread holds a joined one back until the
+//		next frame shows that it was whole, or no part came for
+//		TOUCH_QUEUE_SETTLE_MS.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+#include "BlobSnapshot.h"
+
+#include <atomic>
+#include <vector>
+
+// Devices that can deliver frames at the same time.
+#define TOUCH_QUEUE_MAX_DEVICES		8
+
+// Smallest frame capacities, used when the attached devices report less
+// (or nothing yet), so a device attached later still fits.
+#define TOUCH_QUEUE_MIN_FINGERS		16
+#define TOUCH_QUEUE_MIN_BLOBS			16
+#define TOUCH_QUEUE_MIN_BLOB_POINTS	1024
+#define TOUCH_QUEUE_MIN_RAW			4096
+
+// How long a finger frame delivered in parts is held after its last part.
+#define TOUCH_QUEUE_SETTLE_MS			1.0
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class ETouchFrameType
+{
+	EFingerFrame,
+	EBlobFrame,
+	ERawFrame
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Capacity of every preallocated frame.
+//
+struct TouchFrameLimits
+{
+	int		fingers;
+	int		blobs;
+	int		blobPoints;			// total over all blobs of a frame
+	int		rawElements;
+
+	TouchFrameLimits();
+
+	// Grows the limits to hold frames of the given device.
+	void Include(const WacomMTCapability &caps_I);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// A copy of one callback's data, or of the parts of a frame joined so far.
+// Only the first count entries of the arrays are valid; blob frames are held
+// as a snapshot.
+//
+struct TouchFrame
+{
+	ETouchFrameType					type;
+	int									deviceID;
+	int									frameNumber;
+	int									count;
+	bool									truncated;
+	double								arrivalMs;		// as given to PushFingers
+
+	// Set for a frame delivered in parts, which carries the frame joined
+	// before it as it ended: its number and count, or -1 if none.
+	bool									joined;
+	int									previousFrameNumber;
+	int									previousCount;
+
+	std::vector<WacomMTFinger>		fingers;
+	std::vector<int>					regions;			// delivering each finger, 0 for no region
+	BlobSnapshot						blobs;
+	std::vector<unsigned short>	raw;
+
+	TouchFrame();
+	void Allocate(const TouchFrameLimits &limits_I);
+
+	// Copies another finger or blob frame.
+	void CopyFrom(const TouchFrame &frame_I);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct TouchFrameStats
+{
+	unsigned long long	published;
+	unsigned long long	superseded;		// replaced before being rendered
+	unsigned long long	dropped;			// no device slot free
+	unsigned long long	truncated;		// larger than the frame capacity
+	unsigned long long	rendered;
+	unsigned long long	late;				// parts after their frame was settled
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Triple buffer for one producer and one consumer.  Of the three frames, the
+// producer owns one, the consumer owns one, and the third is the newest
+// published frame, swapped atomically by either side.
+//
+class TouchFrameTripleBuffer
+{
+public:
+	TouchFrameTripleBuffer();
+
+	void Allocate(const TouchFrameLimits &limits_I);
+
+	// Producer: fill BackFrame(), then Publish().  Publish returns true if
+	// it replaced a frame the consumer had not taken.
+	TouchFrame &BackFrame(void) { return mFrames[mBack]; }
+	bool Publish(void);
+
+	// Consumer: the newest frame published since the last call, or null.
+	// The frame stays valid until the next call.
+	const TouchFrame *TakeLatest(void);
+
+private:
+	// Index of the shared frame, with FRESH_BIT set while it is unread.
+	static const unsigned FRESH_BIT = 4;
+
+	TouchFrame						mFrames[3];
+	alignas(64) std::atomic<unsigned>	mShared;
+	alignas(64) unsigned			mBack;
+	alignas(64) unsigned			mFront;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Frames of all devices.  Push* may be called from any thread, as long as
+// the frames of one device arrive on one thread at a time (as the driver
+// delivers them); ConsumeLatest is called from the render thread only.  A
+// device takes a channel with its first frame, until Release.
+//
+class TouchFrameQueue
+{
+public:
+	TouchFrameQueue();
+
+	// Preallocates all frames.  Call before any frame is pushed.
+	void Allocate(const TouchFrameLimits &limits_I);
+
+	// Copy the callback data and publish it.  Return false if there is no
+	// data, or if the frame was dropped because no device slot is free.
+	// arrivalMs_I is when the finger frame arrived, for the input timeline.
+	// regionID_I is the hit region whose callback got the data, which is
+	// then a part of the frame, or 0 for a callback without a hit rect.
+	bool PushFingers(const WacomMTFingerCollection *fingerData_I, double arrivalMs_I = 0.0, int regionID_I = 0);
+	bool PushBlobs(const WacomMTBlobAggregate *blobData_I, int regionID_I = 0);
+	bool PushRaw(const WacomMTRawData *rawData_I);
+
+	// Frees the device's channel for a device attached later.  Call once it
+	// delivers no more frames, as after it detached; its frames not taken
+	// yet are dropped.
+	void Release(int deviceID_I);
+
+	// Calls visit_I(const TouchFrame &) with the newest unread frame of each
+	// device, and with joined finger frames as they settle.  nowMs_I is the
+	// time on the consumer's clock.  Returns the number of frames visited.
+	template <typename Visit>
+	int ConsumeLatest(double nowMs_I, Visit visit_I)
+	{
+		int visited = 0;
+		for (Channel &channel : mChannels)
+		{
+			const TouchFrame *taken[2] = { nullptr, nullptr };
+			const int count = Take(channel, nowMs_I, taken);
+			for (int idx = 0; idx < count; idx++)
+			{
+				visit_I(*taken[idx]);
+			}
+			visited += count;
+		}
+		mRendered.fetch_add(visited, std::memory_order_relaxed);
+		return visited;
+	}
+
+	// Milliseconds from nowMs_I until a held finger frame settles, 0 if one
+	// has, or -1 if none is held.  Consumer only.
+	double NextSettleMs(double nowMs_I) const;
+
+	TouchFrameStats Stats(void) const;
+
+private:
+	static const int NO_DEVICE = -0x7fffffff;
+
+	struct Channel
+	{
+		std::atomic<int>			deviceID;
+		std::atomic<unsigned>	releases;
+		TouchFrameTripleBuffer	buffer;
+
+		// Producer: the parts of the frame being delivered.
+		TouchFrame					parts;
+		bool							joining;
+
+		// Consumer: a joined finger frame waiting for more parts, and the
+		// one last settled, of the device since the last release seen.
+		unsigned						seenReleases;
+		TouchFrame					held;
+		TouchFrame					settled;
+		bool							holding;
+		bool							hasSettled;
+		double						heldMs;
+	};
+
+	Channel *Find(int deviceID_I);
+	bool Join(Channel &channel_IO, ETouchFrameType type_I, int deviceID_I, int frameNumber_I);
+	void Publish(TouchFrameTripleBuffer &buffer_I, bool truncated_I);
+	int Take(Channel &channel_IO, double nowMs_I, const TouchFrame *taken_O[2]);
+
+	Channel								mChannels[TOUCH_QUEUE_MAX_DEVICES];
+
+	std::atomic<unsigned long long>	mPublished;
+	std::atomic<unsigned long long>	mSuperseded;
+	std::atomic<unsigned long long>	mDropped;
+	std::atomic<unsigned long long>	mTruncated;
+	std::atomic<unsigned long long>	mRendered;
+	std::atomic<unsigned long long>	mLate;
+};
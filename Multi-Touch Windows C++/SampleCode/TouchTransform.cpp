@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Conversion of finger positions and sizes to client pixels and
+//		millimeters.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TouchTransform.h"
+
+#include <cstddef>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#define TOUCH_TRANSFORM_SSE2
+	#include <emmintrin.h>
+#endif
+
+static_assert(offsetof(WacomMTFinger, Height) == offsetof(WacomMTFinger, X) + 3 * sizeof(float),
+	"X, Y, Width and Height must be adjacent");
+
+///////////////////////////////////////////////////////////////////////////////
+
+TouchTransform::TouchTransform() :
+	mClientScaleX(1.0f),
+	mClientScaleY(1.0f),
+	mClientOffsetX(0.0f),
+	mClientOffsetY(0.0f),
+	mMMScaleX(1.0f),
+	mMMScaleY(1.0f),
+	mMMOffsetX(0.0f),
+	mMMOffsetY(0.0f),
+	mFractionScaleX(1.0f),
+	mFractionScaleY(1.0f),
+	mPixelScaleX(1.0f),
+	mPixelScaleY(1.0f),
+	mRadiusScaleX(0.5f),
+	mRadiusScaleY(0.5f)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchTransform::Configure(const WacomMTCapability &caps_I, float clientLeft_I, float clientTop_I,
+	float clientWidth_I, float clientHeight_I)
+{
+	const float pitchX = caps_I.LogicalWidth > 0.0f ? caps_I.PhysicalSizeX / caps_I.LogicalWidth : 1.0f;
+	const float pitchY = caps_I.LogicalHeight > 0.0f ? caps_I.PhysicalSizeY / caps_I.LogicalHeight : 1.0f;
+
+	if (caps_I.Type == WMTDeviceTypeOpaque)
+	{
+		// The sensor maps over the client area.
+		mClientScaleX = clientWidth_I;
+		mClientScaleY = clientHeight_I;
+		mClientOffsetX = 0.0f;
+		mClientOffsetY = 0.0f;
+		mMMScaleX = caps_I.PhysicalSizeX;
+		mMMScaleY = caps_I.PhysicalSizeY;
+		mMMOffsetX = 0.0f;
+		mMMOffsetY = 0.0f;
+	}
+	else
+	{
+		mClientScaleX = 1.0f;
+		mClientScaleY = 1.0f;
+		mClientOffsetX = -clientLeft_I;
+		mClientOffsetY = -clientTop_I;
+		mMMScaleX = pitchX;
+		mMMScaleY = pitchY;
+		mMMOffsetX = -caps_I.LogicalOriginX * pitchX;
+		mMMOffsetY = -caps_I.LogicalOriginY * pitchY;
+	}
+
+	mFractionScaleX = caps_I.PhysicalSizeX;
+	mFractionScaleY = caps_I.PhysicalSizeY;
+	mPixelScaleX = pitchX;
+	mPixelScaleY = pitchY;
+	mRadiusScaleX = 0.5f / pitchX;
+	mRadiusScaleY = 0.5f / pitchY;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		The operations of Convert, in the same order, on one finger.
+//
+void TouchTransform::ConvertOne(const WacomMTFinger &finger_I, TouchPoint &point_O) const
+{
+	point_O.clientX = finger_I.X * mClientScaleX + mClientOffsetX;
+	point_O.clientY = finger_I.Y * mClientScaleY + mClientOffsetY;
+	point_O.x = finger_I.X * mMMScaleX + mMMOffsetX;
+	point_O.y = finger_I.Y * mMMScaleY + mMMOffsetY;
+
+	const float width = finger_I.Width * (finger_I.Width <= 1.0f ? mFractionScaleX : mPixelScaleX);
+	const float height = finger_I.Height * (finger_I.Height <= 1.0f ? mFractionScaleY : mPixelScaleY);
+	point_O.widthMM = width > 0.0f ? width : 0.0f;
+	point_O.heightMM = height > 0.0f ? height : 0.0f;
+	point_O.radiusX = point_O.widthMM * mRadiusScaleX;
+	point_O.radiusY = point_O.heightMM * mRadiusScaleY;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchTransform::ConvertReference(int count_I, const WacomMTFinger *fingers_I, TouchPoint *points_O) const
+{
+	for (int index = 0; index < count_I; index++)
+	{
+		ConvertOne(fingers_I[index], points_O[index]);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Loads X, Y, Width and Height of four fingers and transposes them, so
+//		that each register holds one of them for all four.  The results are
+//		transposed back into the points, four values at a time.
+//
+void TouchTransform::Convert(int count_I, const WacomMTFinger *fingers_I, TouchPoint *points_O) const
+{
+	int index = 0;
+
+#if defined(TOUCH_TRANSFORM_SSE2)
+	const __m128 clientScaleX = _mm_set1_ps(mClientScaleX);
+	const __m128 clientScaleY = _mm_set1_ps(mClientScaleY);
+	const __m128 clientOffsetX = _mm_set1_ps(mClientOffsetX);
+	const __m128 clientOffsetY = _mm_set1_ps(mClientOffsetY);
+	const __m128 mmScaleX = _mm_set1_ps(mMMScaleX);
+	const __m128 mmScaleY = _mm_set1_ps(mMMScaleY);
+	const __m128 mmOffsetX = _mm_set1_ps(mMMOffsetX);
+	const __m128 mmOffsetY = _mm_set1_ps(mMMOffsetY);
+	const __m128 fractionScaleX = _mm_set1_ps(mFractionScaleX);
+	const __m128 fractionScaleY = _mm_set1_ps(mFractionScaleY);
+	const __m128 pixelScaleX = _mm_set1_ps(mPixelScaleX);
+	const __m128 pixelScaleY = _mm_set1_ps(mPixelScaleY);
+	const __m128 radiusScaleX = _mm_set1_ps(mRadiusScaleX);
+	const __m128 radiusScaleY = _mm_set1_ps(mRadiusScaleY);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; index + 4 <= count_I; index += 4)
+	{
+		__m128 x = _mm_loadu_ps(&fingers_I[index].X);
+		__m128 y = _mm_loadu_ps(&fingers_I[index + 1].X);
+		__m128 width = _mm_loadu_ps(&fingers_I[index + 2].X);
+		__m128 height = _mm_loadu_ps(&fingers_I[index + 3].X);
+		_MM_TRANSPOSE4_PS(x, y, width, height);
+
+		__m128 clientX = _mm_add_ps(_mm_mul_ps(x, clientScaleX), clientOffsetX);
+		__m128 clientY = _mm_add_ps(_mm_mul_ps(y, clientScaleY), clientOffsetY);
+		__m128 mmX = _mm_add_ps(_mm_mul_ps(x, mmScaleX), mmOffsetX);
+		__m128 mmY = _mm_add_ps(_mm_mul_ps(y, mmScaleY), mmOffsetY);
+
+		const __m128 fractionX = _mm_cmple_ps(width, one);
+		const __m128 fractionY = _mm_cmple_ps(height, one);
+		__m128 widthMM = _mm_max_ps(_mm_mul_ps(width,
+			_mm_or_ps(_mm_and_ps(fractionX, fractionScaleX), _mm_andnot_ps(fractionX, pixelScaleX))), zero);
+		__m128 heightMM = _mm_max_ps(_mm_mul_ps(height,
+			_mm_or_ps(_mm_and_ps(fractionY, fractionScaleY), _mm_andnot_ps(fractionY, pixelScaleY))), zero);
+		__m128 radiusX = _mm_mul_ps(widthMM, radiusScaleX);
+		__m128 radiusY = _mm_mul_ps(heightMM, radiusScaleY);
+
+		_MM_TRANSPOSE4_PS(clientX, clientY, mmX, mmY);
+		_MM_TRANSPOSE4_PS(widthMM, heightMM, radiusX, radiusY);
+
+		TouchPoint *points = points_O + index;
+		_mm_storeu_ps(&points[0].clientX, clientX);
+		_mm_storeu_ps(&points[0].widthMM, widthMM);
+		_mm_storeu_ps(&points[1].clientX, clientY);
+		_mm_storeu_ps(&points[1].widthMM, heightMM);
+		_mm_storeu_ps(&points[2].clientX, mmX);
+		_mm_storeu_ps(&points[2].widthMM, radiusX);
+		_mm_storeu_ps(&points[3].clientX, mmY);
+		_mm_storeu_ps(&points[3].widthMM, radiusY);
+	}
+#endif
+
+	for (; index < count_I; index++)
+	{
+		ConvertOne(fingers_I[index], points_O[index]);
+	}
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Conversion of finger positions and sizes to client pixels and
+//		millimeters.
+//
+//		A TouchTransform is computed for each device when it attaches and
+//		when the window moves: the affine mapping of its finger positions to
+//		the client area and to millimeters on the sensor, and the scales of
+//		its finger sizes.  Display tablets report positions in screen pixels,
+//		opaque tablets as a fraction of the sensor, mapped over the client
+//		area.  A finger size up to 1.0 is a fraction of the sensor, a larger
+//		one is in pixels.  A frame of fingers is then converted without
+//		branches, four fingers at a time with SSE2.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// A converted finger.  Sizes below zero (not reported) convert to zero.
+//
+struct TouchPoint
+{
+	float		clientX;				// client pixels
+	float		clientY;
+	float		x;						// millimeters from the sensor's top left
+	float		y;
+	float		widthMM;
+	float		heightMM;
+	float		radiusX;				// half the size, in client pixels
+	float		radiusY;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class TouchTransform
+{
+public:
+	TouchTransform();
+
+	// Computes the transform of a device for a client area at the given
+	// screen position and size.
+	void Configure(const WacomMTCapability &caps_I, float clientLeft_I, float clientTop_I,
+		float clientWidth_I, float clientHeight_I);
+
+	// Converts count_I fingers into points_O, which must hold as many.
+	void Convert(int count_I, const WacomMTFinger *fingers_I, TouchPoint *points_O) const;
+
+	// Same results one finger at a time, for checking.
+	void ConvertReference(int count_I, const WacomMTFinger *fingers_I, TouchPoint *points_O) const;
+
+	// Client pixels of a finger position, e.g. from its history.
+	float ClientX(float x_I) const { return x_I * mClientScaleX + mClientOffsetX; }
+	float ClientY(float y_I) const { return y_I * mClientScaleY + mClientOffsetY; }
+
+private:
+	void ConvertOne(const WacomMTFinger &finger_I, TouchPoint &point_O) const;
+
+	// Position: value * scale + offset.
+	float			mClientScaleX;
+	float			mClientScaleY;
+	float			mClientOffsetX;
+	float			mClientOffsetY;
+	float			mMMScaleX;
+	float			mMMScaleY;
+	float			mMMOffsetX;
+	float			mMMOffsetY;
+
+	// Size to millimeters, for sizes up to 1.0 and above; millimeters to
+	// half a client pixel.
+	float			mFractionScaleX;
+	float			mFractionScaleY;
+	float			mPixelScaleX;
+	float			mPixelScaleY;
+	float			mRadiusScaleX;
+	float			mRadiusScaleY;
+};
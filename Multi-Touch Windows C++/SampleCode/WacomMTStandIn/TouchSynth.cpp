@@ -0,0 +1,437 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Synthetic touch data for one device.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TouchSynth.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#define TOUCH_SYNTH_PI	3.14159265358979
+
+///////////////////////////////////////////////////////////////////////////////
+
+TouchSynth::TouchSynth() :
+	mCaps(),
+	mBlobPoints(0),
+	mNextFingerID(1),
+	mFrameNumber(0),
+	mTime(0.0),
+	mScriptLength(0.0),
+	mFingerCollection(),
+	mBlobAggregate(),
+	mRawData()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchSynth::Init(const WacomMTCapability &caps_I, int fingerCount_I, int blobPoints_I, unsigned seed_I)
+{
+	mCaps = caps_I;
+	mRandom.seed(seed_I);
+	mBlobPoints = std::max(3, std::min(blobPoints_I, std::max(caps_I.BlobPointsMax, 3)));
+	mNextFingerID = 1;
+	mFrameNumber = 0;
+	mTime = 0.0;
+
+	mFingers.resize(std::max(caps_I.FingerMax, 1));
+	mBlobs.resize(std::max(caps_I.BlobMax, 1));
+	mBlobPointData.resize(mBlobs.size() * mBlobPoints);
+	mRaw.resize(std::max(caps_I.ScanSizeX * caps_I.ScanSizeY, 0));
+
+	mContacts.clear();
+	mContacts.reserve(mFingers.size());
+	mLifted.clear();
+	mLifted.reserve(mFingers.size());
+	mPreviousIDs.clear();
+	mPreviousIDs.reserve(mFingers.size());
+
+	// Stagger the first touch-downs a little.
+	mRandomFingers.resize(std::min(fingerCount_I, static_cast<int>(mFingers.size())));
+	for (RandomFinger &finger : mRandomFingers)
+	{
+		NewTouch(finger, Uniform(0.0, 0.3));
+	}
+	mScript.clear();
+
+	mFingerCollection.Version = WACOM_MULTI_TOUCH_API_VERSION;
+	mFingerCollection.DeviceID = caps_I.DeviceID;
+	mFingerCollection.Fingers = mFingers.data();
+	mFingerCollection.FingerCount = 0;
+
+	mBlobAggregate.Version = WACOM_MULTI_TOUCH_API_VERSION;
+	mBlobAggregate.DeviceID = caps_I.DeviceID;
+	mBlobAggregate.BlobArray = mBlobs.data();
+	mBlobAggregate.BlobCount = 0;
+
+	mRawData.Version = WACOM_MULTI_TOUCH_API_VERSION;
+	mRawData.DeviceID = caps_I.DeviceID;
+	mRawData.Sensitivity = mRaw.data();
+	mRawData.ElementCount = static_cast<int>(mRaw.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchSynth::SetScript(const std::vector<TouchScriptKey> &keys_I)
+{
+	mScript = keys_I;
+	std::stable_sort(mScript.begin(), mScript.end(),
+		[](const TouchScriptKey &a_I, const TouchScriptKey &b_I) { return a_I.fingerID < b_I.fingerID || (a_I.fingerID == b_I.fingerID && a_I.time < b_I.time); });
+
+	mScriptLength = 0.0;
+	for (const TouchScriptKey &key : mScript)
+	{
+		mScriptLength = std::max(mScriptLength, key.time);
+	}
+	mScriptLength += TOUCH_SYNTH_SCRIPT_GAP;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+double TouchSynth::Uniform(double low_I, double high_I)
+{
+	return std::uniform_real_distribution<double>(low_I, high_I)(mRandom);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Starts a new touch of a random finger: a new FingerID, a place to
+//		wander around, a contact size and how long the finger stays down.
+//
+void TouchSynth::NewTouch(RandomFinger &finger_IO, double downTime_I)
+{
+	finger_IO.fingerID = mNextFingerID++;
+	finger_IO.downTime = downTime_I;
+	finger_IO.upTime = downTime_I + Uniform(0.4, 2.5);
+	finger_IO.centerX = Uniform(0.25, 0.75);
+	finger_IO.centerY = Uniform(0.25, 0.75);
+	finger_IO.ampX = Uniform(0.02, 0.2);
+	finger_IO.ampY = Uniform(0.02, 0.2);
+	finger_IO.freqX = Uniform(0.2, 1.0);
+	finger_IO.freqY = Uniform(0.2, 1.0);
+	finger_IO.phaseX = Uniform(0.0, 2.0 * TOUCH_SYNTH_PI);
+	finger_IO.phaseY = Uniform(0.0, 2.0 * TOUCH_SYNTH_PI);
+	finger_IO.widthMM = Uniform(7.0, 12.0);
+	finger_IO.heightMM = finger_IO.widthMM * Uniform(1.0, 1.4);
+	finger_IO.orientation = Uniform(0.0, 180.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchSynth::RandomContacts(double seconds_I)
+{
+	for (RandomFinger &finger : mRandomFingers)
+	{
+		// After lifting, the finger stays up for a moment and then touches
+		// down again somewhere else.
+		if (seconds_I >= finger.upTime)
+		{
+			NewTouch(finger, finger.upTime + Uniform(0.05, 0.6));
+		}
+
+		if (seconds_I < finger.downTime)
+		{
+			continue;
+		}
+
+		const double t = seconds_I - finger.downTime;
+		Contact contact;
+		contact.fingerID = finger.fingerID;
+		contact.x = finger.centerX + finger.ampX * sin(2.0 * TOUCH_SYNTH_PI * finger.freqX * t + finger.phaseX);
+		contact.y = finger.centerY + finger.ampY * sin(2.0 * TOUCH_SYNTH_PI * finger.freqY * t + finger.phaseY);
+		contact.widthMM = finger.widthMM;
+		contact.heightMM = finger.heightMM;
+		contact.orientation = finger.orientation;
+		mContacts.push_back(contact);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Interpolates each scripted finger between the keys around the time.
+//		The keys are sorted by finger, then by time.
+//
+void TouchSynth::ScriptContacts(double seconds_I)
+{
+	const double t = fmod(seconds_I, mScriptLength);
+
+	size_t first = 0;
+	while (first < mScript.size() && mContacts.size() < mFingers.size())
+	{
+		size_t last = first;
+		while (last + 1 < mScript.size() && mScript[last + 1].fingerID == mScript[first].fingerID)
+		{
+			last++;
+		}
+
+		if (t >= mScript[first].time && t <= mScript[last].time)
+		{
+			size_t key = first;
+			while (key < last && mScript[key + 1].time < t)
+			{
+				key++;
+			}
+
+			const TouchScriptKey &a = mScript[key];
+			const TouchScriptKey &b = mScript[std::min(key + 1, last)];
+			const double span = b.time - a.time;
+			const double u = span > 0.0 ? (t - a.time) / span : 0.0;
+
+			Contact contact;
+			contact.fingerID = a.fingerID;
+			contact.x = a.x + u * (b.x - a.x);
+			contact.y = a.y + u * (b.y - a.y);
+			contact.widthMM = a.width + u * (b.width - a.width);
+			contact.heightMM = a.height + u * (b.height - a.height);
+			contact.orientation = 90.0;
+			mContacts.push_back(contact);
+		}
+
+		first = last + 1;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TouchSynth::Step(double seconds_I)
+{
+	mTime = seconds_I;
+	mFrameNumber++;
+
+	// Remember last frame's contacts to find the fingers that lifted.
+	std::swap(mContacts, mLifted);
+	mContacts.clear();
+
+	if (!mScript.empty())
+	{
+		ScriptContacts(seconds_I);
+	}
+	else
+	{
+		RandomContacts(seconds_I);
+	}
+
+	mLifted.erase(std::remove_if(mLifted.begin(), mLifted.end(), [this](const Contact &lifted_I)
+	{
+		for (const Contact &contact : mContacts)
+		{
+			if (contact.fingerID == lifted_I.fingerID)
+			{
+				return true;
+			}
+		}
+		return false;
+	}), mLifted.end());
+
+	BuildFingers();
+	BuildBlobs();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Fingers in the device's logical units: pixels for integrated devices,
+//		fractions of the tablet for opaque ones.  Down the first frame, Hold
+//		while down, and Up once in the frame after the finger lifted.
+//
+void TouchSynth::BuildFingers(void)
+{
+	const double scaleX = mCaps.LogicalWidth;
+	const double scaleY = mCaps.LogicalHeight;
+	const double originX = mCaps.LogicalOriginX;
+	const double originY = mCaps.LogicalOriginY;
+	const double physicalX = mCaps.PhysicalSizeX > 0.0f ? mCaps.PhysicalSizeX : 1.0;
+	const double physicalY = mCaps.PhysicalSizeY > 0.0f ? mCaps.PhysicalSizeY : 1.0;
+
+	int count = 0;
+	auto add = [&](const Contact &contact_I, WacomMTFingerState state_I)
+	{
+		if (count >= static_cast<int>(mFingers.size()))
+		{
+			return;
+		}
+
+		WacomMTFinger &finger = mFingers[count++];
+		finger.FingerID = contact_I.fingerID;
+		finger.X = static_cast<float>(originX + contact_I.x * scaleX);
+		finger.Y = static_cast<float>(originY + contact_I.y * scaleY);
+		finger.Width = static_cast<float>(contact_I.widthMM / physicalX * scaleX);
+		finger.Height = static_cast<float>(contact_I.heightMM / physicalY * scaleY);
+		finger.Sensitivity = state_I == WMTFingerStateUp ? 0 : TOUCH_SYNTH_RAW_PEAK;
+		finger.Orientation = static_cast<float>(contact_I.orientation);
+		finger.Confidence = true;
+		finger.TouchState = state_I;
+	};
+
+	for (const Contact &contact : mContacts)
+	{
+		const bool wasDown = std::find(mPreviousIDs.begin(), mPreviousIDs.end(), contact.fingerID) != mPreviousIDs.end();
+		add(contact, wasDown ? WMTFingerStateHold : WMTFingerStateDown);
+	}
+	for (const Contact &contact : mLifted)
+	{
+		add(contact, WMTFingerStateUp);
+	}
+
+	mPreviousIDs.clear();
+	for (const Contact &contact : mContacts)
+	{
+		mPreviousIDs.push_back(contact.fingerID);
+	}
+
+	mFingerCollection.FrameNumber = mFrameNumber;
+	mFingerCollection.FingerCount = count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		One blob per contact: an ellipse with a slightly wavy outline,
+//		rotated to the contact's orientation, in the same units as fingers.
+//
+void TouchSynth::BuildBlobs(void)
+{
+	const double scaleX = mCaps.LogicalWidth;
+	const double scaleY = mCaps.LogicalHeight;
+	const double originX = mCaps.LogicalOriginX;
+	const double originY = mCaps.LogicalOriginY;
+	const double physicalX = mCaps.PhysicalSizeX > 0.0f ? mCaps.PhysicalSizeX : 1.0;
+	const double physicalY = mCaps.PhysicalSizeY > 0.0f ? mCaps.PhysicalSizeY : 1.0;
+
+	int count = 0;
+	for (const Contact &contact : mContacts)
+	{
+		if (count >= static_cast<int>(mBlobs.size()))
+		{
+			break;
+		}
+
+		WacomMTBlob &blob = mBlobs[count];
+		blob.BlobID = contact.fingerID;
+		blob.X = static_cast<float>(originX + contact.x * scaleX);
+		blob.Y = static_cast<float>(originY + contact.y * scaleY);
+		blob.Confidence = true;
+		blob.BlobType = WMTBlobTypePrimary;
+		blob.ParentID = 0;
+		blob.PointCount = mBlobPoints;
+		blob.BlobPoints = mBlobPointData.data() + count * mBlobPoints;
+
+		const double radiusX = contact.widthMM / 2.0 / physicalX * scaleX;
+		const double radiusY = contact.heightMM / 2.0 / physicalY * scaleY;
+		const double rotation = contact.orientation * TOUCH_SYNTH_PI / 180.0;
+		const double wobble = Uniform(0.0, 2.0 * TOUCH_SYNTH_PI);
+
+		for (int idx = 0; idx < mBlobPoints; idx++)
+		{
+			const double angle = 2.0 * TOUCH_SYNTH_PI * idx / mBlobPoints;
+			const double radius = 1.0 + 0.08 * sin(3.0 * angle + wobble);
+			const double ex = radiusX * radius * cos(angle);
+			const double ey = radiusY * radius * sin(angle);
+
+			WacomMTBlobPoint &point = blob.BlobPoints[idx];
+			point.X = static_cast<float>(blob.X + ex * cos(rotation) - ey * sin(rotation));
+			point.Y = static_cast<float>(blob.Y + ex * sin(rotation) + ey * cos(rotation));
+			point.Sensitivity = static_cast<unsigned short>(TOUCH_SYNTH_RAW_PEAK / 4 + Uniform(0.0, TOUCH_SYNTH_RAW_PEAK / 8));
+		}
+		count++;
+	}
+
+	mBlobAggregate.FrameNumber = mFrameNumber;
+	mBlobAggregate.BlobCount = count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Noise floor plus a Gaussian bump for each contact, with a spread of
+//		about a third of the contact size.  Only cells within three spreads
+//		of a contact are evaluated.
+//
+void TouchSynth::BuildRaw(void)
+{
+	const int sizeX = mCaps.ScanSizeX;
+	const int sizeY = mCaps.ScanSizeY;
+	if (mRaw.empty() || sizeX <= 0 || sizeY <= 0)
+	{
+		mRawData.ElementCount = 0;
+		return;
+	}
+
+	std::uniform_int_distribution<int> noise(0, TOUCH_SYNTH_RAW_NOISE);
+	for (unsigned short &value : mRaw)
+	{
+		value = static_cast<unsigned short>(noise(mRandom));
+	}
+
+	const double cellX = (mCaps.PhysicalSizeX > 0.0f ? mCaps.PhysicalSizeX : 1.0) / sizeX;
+	const double cellY = (mCaps.PhysicalSizeY > 0.0f ? mCaps.PhysicalSizeY : 1.0) / sizeY;
+
+	for (const Contact &contact : mContacts)
+	{
+		const double cx = contact.x * sizeX - 0.5;
+		const double cy = contact.y * sizeY - 0.5;
+		const double sigmaX = std::max(0.5, contact.widthMM / 3.0 / cellX);
+		const double sigmaY = std::max(0.5, contact.heightMM / 3.0 / cellY);
+
+		const int x0 = std::max(0, static_cast<int>(floor(cx - 3.0 * sigmaX)));
+		const int x1 = std::min(sizeX - 1, static_cast<int>(ceil(cx + 3.0 * sigmaX)));
+		const int y0 = std::max(0, static_cast<int>(floor(cy - 3.0 * sigmaY)));
+		const int y1 = std::min(sizeY - 1, static_cast<int>(ceil(cy + 3.0 * sigmaY)));
+
+		for (int sy = y0; sy <= y1; sy++)
+		{
+			const double dy = (sy - cy) / sigmaY;
+			for (int sx = x0; sx <= x1; sx++)
+			{
+				const double dx = (sx - cx) / sigmaX;
+				const double bump = TOUCH_SYNTH_RAW_PEAK * exp(-0.5 * (dx * dx + dy * dy));
+				unsigned short &value = mRaw[sy * sizeX + sx];
+				value = static_cast<unsigned short>(std::min(65535.0, value + bump));
+			}
+		}
+	}
+
+	mRawData.FrameNumber = mFrameNumber;
+	mRawData.ElementCount = sizeX * sizeY;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool LoadTouchScript(const char *path_I, std::vector<TouchScriptKey> &keys_O)
+{
+	keys_O.clear();
+
+	FILE *file = fopen(path_I, "r");
+	if (!file)
+	{
+		return false;
+	}
+
+	char line[256];
+	while (fgets(line, sizeof(line), file))
+	{
+		char *comment = strchr(line, '#');
+		if (comment)
+		{
+			*comment = '\0';
+		}
+
+		TouchScriptKey key = { 0.0, 0, 0.0, 0.0, 10.0, 12.0 };
+		if (sscanf(line, "%lf %d %lf %lf %lf %lf", &key.time, &key.fingerID, &key.x, &key.y, &key.width, &key.height) >= 4)
+		{
+			keys_O.push_back(key);
+		}
+	}
+
+	fclose(file);
+	return !keys_O.empty();
+}
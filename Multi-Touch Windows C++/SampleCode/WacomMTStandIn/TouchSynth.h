@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Synthetic touch data for one device: finger collections, blob
+//		aggregates and raw sensitivity frames, as the Feel Multi-Touch API
+//		delivers them.
+//
+//		Contacts either follow scripted keyframes or move at random.  In
+//		random mode each of the fingers touches down, wanders along a smooth
+//		path and lifts again, then touches down elsewhere with a new
+//		FingerID.  Blobs are elliptic contours around the fingers and raw
+//		frames are Gaussian bumps over a noise floor.
+//
+//		The frames are built in preallocated buffers sized from the device
+//		capabilities, and stay valid until the next Step().
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouchTypes.h"
+
+#include <random>
+#include <vector>
+
+// Time (seconds) between the end of a script and its repetition.
+#define TOUCH_SYNTH_SCRIPT_GAP		0.25
+
+// Peak raw sensitivity of a contact, and the raw noise floor.
+#define TOUCH_SYNTH_RAW_PEAK			200
+#define TOUCH_SYNTH_RAW_NOISE			3
+
+///////////////////////////////////////////////////////////////////////////////
+// One keyframe of a scripted finger.  x and y are fractions of the touch
+// surface; width and height are in millimeters.
+//
+struct TouchScriptKey
+{
+	double	time;					// seconds from the start of the script
+	int		fingerID;
+	double	x;
+	double	y;
+	double	width;
+	double	height;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class TouchSynth
+{
+public:
+	TouchSynth();
+
+	// Sizes the frames for the device and starts random contacts.
+	void Init(const WacomMTCapability &caps_I, int fingerCount_I, int blobPoints_I, unsigned seed_I);
+
+	// Replaces the random contacts with keyframes.  A finger is down from
+	// its first key to its last; the script repeats.
+	void SetScript(const std::vector<TouchScriptKey> &keys_I);
+
+	// Builds the frames for time seconds_I (non-decreasing).
+	void Step(double seconds_I);
+
+	// Builds a raw frame for the current contacts.  Raw frames are made
+	// separately as they are usually delivered at a lower rate.
+	void BuildRaw(void);
+
+	WacomMTFingerCollection &Fingers(void) { return mFingerCollection; }
+	WacomMTBlobAggregate &Blobs(void) { return mBlobAggregate; }
+	WacomMTRawData &Raw(void) { return mRawData; }
+	const WacomMTCapability &Caps(void) const { return mCaps; }
+
+private:
+	// A contact on the surface, in surface fractions and millimeters.
+	struct Contact
+	{
+		int		fingerID;
+		double	x;
+		double	y;
+		double	widthMM;
+		double	heightMM;
+		double	orientation;		// degrees
+	};
+
+	// A finger in random mode: touches down at downTime, lifts at upTime.
+	struct RandomFinger
+	{
+		int		fingerID;
+		double	downTime;
+		double	upTime;
+		double	centerX, centerY;
+		double	ampX, ampY;
+		double	freqX, freqY;
+		double	phaseX, phaseY;
+		double	widthMM, heightMM;
+		double	orientation;
+	};
+
+	double Uniform(double low_I, double high_I);
+	void NewTouch(RandomFinger &finger_IO, double downTime_I);
+	void RandomContacts(double seconds_I);
+	void ScriptContacts(double seconds_I);
+	void BuildFingers(void);
+	void BuildBlobs(void);
+
+	WacomMTCapability					mCaps;
+	std::mt19937						mRandom;
+	int									mBlobPoints;
+	int									mNextFingerID;
+	int									mFrameNumber;
+	double								mTime;
+
+	std::vector<RandomFinger>		mRandomFingers;
+	std::vector<TouchScriptKey>	mScript;
+	double								mScriptLength;
+
+	std::vector<Contact>				mContacts;
+	std::vector<Contact>				mLifted;			// up this frame
+	std::vector<int>					mPreviousIDs;
+
+	std::vector<WacomMTFinger>		mFingers;
+	std::vector<WacomMTBlob>		mBlobs;
+	std::vector<WacomMTBlobPoint>	mBlobPointData;
+	std::vector<unsigned short>	mRaw;
+
+	WacomMTFingerCollection			mFingerCollection;
+	WacomMTBlobAggregate				mBlobAggregate;
+	WacomMTRawData						mRawData;
+};
+
+// Reads a script of "seconds fingerID x y [width height]" lines; '#' starts
+// a comment.  Returns false if the file cannot be read or has no keys.
+bool LoadTouchScript(const char *path_I, std::vector<TouchScriptKey> &keys_O);
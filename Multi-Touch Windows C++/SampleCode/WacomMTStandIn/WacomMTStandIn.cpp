@@ -0,0 +1,990 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Stand-in for the Wacom Feel(TM) Multi-Touch driver library.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(_WIN32)
+	#define WACOMMT_EXPORTS
+	#define NOMINMAX
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif defined(__GNUC__)
+	#define WMT_EXPORT __attribute__((visibility("default")))
+#endif
+
+#include "WacomMTStandIn.h"
+#include "TouchSynth.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Local types and state
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	template <typename Callback>
+	struct CallbackRegistration
+	{
+		bool						hasHitRect;
+		WacomMTHitRect			hitRect;
+		WacomMTProcessingMode	mode;
+		Callback					callback;
+		void						*userData;
+	};
+
+	using FingerRegistration = CallbackRegistration<WMT_FINGER_CALLBACK>;
+	using BlobRegistration = CallbackRegistration<WMT_BLOB_CALLBACK>;
+	using RawRegistration = CallbackRegistration<WMT_RAW_CALLBACK>;
+
+	// A window registered for data.  Messages point into a ring of
+	// bufferDepth copies, as with the driver: a message's data stays valid
+	// until bufferDepth more frames have been posted.
+	struct WindowFrame
+	{
+		WacomMTFingerCollection			fingers;
+		WacomMTBlobAggregate				blobs;
+		WacomMTRawData						raw;
+		std::vector<WacomMTFinger>		fingerData;
+		std::vector<WacomMTBlob>		blobData;
+		std::vector<WacomMTBlobPoint>	pointData;
+		std::vector<unsigned short>	rawData;
+	};
+
+	struct WindowRegistration
+	{
+		void						*window;			// HWND, or the post function's argument
+		WMT_STANDIN_POST		post;				// null to post window messages
+		unsigned					message;
+		std::vector<WindowFrame>	ring;
+		size_t					next;
+	};
+
+	struct Device
+	{
+		WacomMTCapability		caps;
+		TouchSynth				synth;
+		std::thread				thread;
+		std::thread::id		threadID;
+		std::atomic<bool>		stop;
+
+		// lock guards the registrations; the device thread holds
+		// deliverLock while it calls out.
+		std::mutex				lock;
+		std::mutex				deliverLock;
+		std::vector<FingerRegistration>	fingerRegistrations;
+		std::vector<BlobRegistration>		blobRegistrations;
+		std::vector<RawRegistration>		rawRegistrations;
+
+		// Copies of the registrations taken for each delivery, and the
+		// fingers and blobs inside a hit rect.
+		std::vector<FingerRegistration>	fingerTargets;
+		std::vector<BlobRegistration>		blobTargets;
+		std::vector<RawRegistration>		rawTargets;
+		std::vector<WacomMTFinger>			hitFingers;
+		std::vector<WacomMTBlob>			hitBlobs;
+
+		std::vector<WindowRegistration>	windows;
+	};
+
+	std::mutex									gStateLock;
+	std::vector<std::unique_ptr<Device>>	gDevices;
+	std::atomic<bool>							gRunning(false);
+	bool											gConfigSet = false;
+	WacomMTStandInConfig						gConfig;
+	std::vector<TouchScriptKey>				gScript;
+	int											gLastDeviceID = 0;		// highest given out
+
+	WMT_ATTACH_CALLBACK						gAttachCallback = nullptr;
+	void											*gAttachUserData = nullptr;
+	WMT_DETACH_CALLBACK						gDetachCallback = nullptr;
+	void											*gDetachUserData = nullptr;
+
+	///////////////////////////////////////////////////////////////////////////
+
+	Device *FindDevice(int deviceID_I)
+	{
+		for (const std::unique_ptr<Device> &device : gDevices)
+		{
+			if (device->caps.DeviceID == deviceID_I)
+			{
+				return device.get();
+			}
+		}
+		return nullptr;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// Parses "key=value,key=value" from the WACOMMT_STANDIN variable.
+	//
+	void ApplyEnvironment(WacomMTStandInConfig &config_IO)
+	{
+		const char *text = getenv("WACOMMT_STANDIN");
+		if (!text)
+		{
+			return;
+		}
+
+		std::string settings(text);
+		size_t start = 0;
+		while (start < settings.size())
+		{
+			size_t end = settings.find(',', start);
+			if (end == std::string::npos)
+			{
+				end = settings.size();
+			}
+
+			const std::string item = settings.substr(start, end - start);
+			const size_t equals = item.find('=');
+			const std::string key = item.substr(0, equals);
+			const std::string value = equals == std::string::npos ? "" : item.substr(equals + 1);
+
+			if (key == "devices")			config_IO.deviceCount = atoi(value.c_str());
+			else if (key == "fingers")		config_IO.fingerCount = atoi(value.c_str());
+			else if (key == "rate")			config_IO.fingerRateHz = atoi(value.c_str());
+			else if (key == "raw")			config_IO.rawRateHz = atoi(value.c_str());
+			else if (key == "points")		config_IO.blobPoints = atoi(value.c_str());
+			else if (key == "seed")			config_IO.seed = static_cast<unsigned>(atoi(value.c_str()));
+			else if (key == "type")			config_IO.deviceType = value == "opaque" ? WMTDeviceTypeOpaque : WMTDeviceTypeIntegrated;
+			else if (key == "scan")			sscanf(value.c_str(), "%dx%d", &config_IO.scanSizeX, &config_IO.scanSizeY);
+			else if (key == "newids")		config_IO.newDeviceIDs = atoi(value.c_str());
+			else if (key == "script")
+			{
+				strncpy(config_IO.scriptPath, value.c_str(), sizeof(config_IO.scriptPath) - 1);
+				config_IO.scriptPath[sizeof(config_IO.scriptPath) - 1] = '\0';
+			}
+
+			start = end + 1;
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	WacomMTCapability MakeCaps(const WacomMTStandInConfig &config_I, int deviceID_I)
+	{
+		WacomMTCapability caps = WacomMTCapability();
+		caps.Version = WACOM_MULTI_TOUCH_API_VERSION;
+		caps.DeviceID = deviceID_I;
+		caps.Type = config_I.deviceType;
+
+		if (config_I.deviceType == WMTDeviceTypeIntegrated)
+		{
+			caps.LogicalWidth = 1920.0f;
+			caps.LogicalHeight = 1080.0f;
+			caps.PhysicalSizeX = 527.0f;
+			caps.PhysicalSizeY = 296.0f;
+		}
+		else
+		{
+			caps.LogicalWidth = 1.0f;
+			caps.LogicalHeight = 1.0f;
+			caps.PhysicalSizeX = 224.0f;
+			caps.PhysicalSizeY = 148.0f;
+		}
+
+		caps.ReportedSizeX = config_I.scanSizeX * 64;
+		caps.ReportedSizeY = config_I.scanSizeY * 64;
+		caps.ScanSizeX = config_I.scanSizeX;
+		caps.ScanSizeY = config_I.scanSizeY;
+		caps.FingerMax = std::max(10, config_I.fingerCount);
+		caps.BlobMax = caps.FingerMax;
+		caps.BlobPointsMax = config_I.blobPoints;
+		caps.CapabilityFlags = WMTCapabilityFlagsRawAvailable | WMTCapabilityFlagsBlobAvailable | WMTCapabilityFlagsSensitivityAvailable;
+		return caps;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		A device of the configuration (see MakeCaps), not yet started.
+	//
+	std::unique_ptr<Device> MakeDevice(const WacomMTStandInConfig &config_I, int deviceID_I)
+	{
+		std::unique_ptr<Device> device(new Device());
+		device->stop = false;
+		device->caps = MakeCaps(config_I, deviceID_I);
+		device->synth.Init(device->caps, config_I.fingerCount, config_I.blobPoints,
+			config_I.seed + (deviceID_I - STANDIN_FIRST_DEVICE_ID));
+		if (!gScript.empty())
+		{
+			device->synth.SetScript(gScript);
+		}
+		device->hitFingers.reserve(device->caps.FingerMax);
+		device->hitBlobs.reserve(device->caps.BlobMax);
+		return device;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	bool SameHitRect(const WacomMTHitRect *hitRect_I, bool hasHitRect_I, const WacomMTHitRect &registered_I)
+	{
+		if (!hitRect_I || !hasHitRect_I)
+		{
+			return !hitRect_I && !hasHitRect_I;
+		}
+		return hitRect_I->originX == registered_I.originX && hitRect_I->originY == registered_I.originY &&
+			hitRect_I->width == registered_I.width && hitRect_I->height == registered_I.height;
+	}
+
+	bool InHitRect(const WacomMTHitRect &hitRect_I, float x_I, float y_I)
+	{
+		return x_I >= hitRect_I.originX && x_I < hitRect_I.originX + hitRect_I.width &&
+			y_I >= hitRect_I.originY && y_I < hitRect_I.originY + hitRect_I.height;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	template <typename Callback>
+	WacomMTError AddRegistration(int deviceID_I, WacomMTHitRect *hitRect_I, WacomMTProcessingMode mode_I,
+		Callback callback_I, void *userData_I, std::vector<CallbackRegistration<Callback>> Device::*list_I)
+	{
+		std::lock_guard<std::mutex> state(gStateLock);
+		Device *device = gRunning ? FindDevice(deviceID_I) : nullptr;
+		if (!device || !callback_I)
+		{
+			return gRunning ? WMTErrorInvalidParam : WMTErrorQuit;
+		}
+
+		CallbackRegistration<Callback> registration = CallbackRegistration<Callback>();
+		registration.hasHitRect = hitRect_I != nullptr;
+		registration.hitRect = hitRect_I ? *hitRect_I : WacomMTHitRect();
+		registration.mode = mode_I;
+		registration.callback = callback_I;
+		registration.userData = userData_I;
+
+		std::lock_guard<std::mutex> lock(device->lock);
+		(device->*list_I).push_back(registration);
+		return WMTErrorSuccess;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Removes a registration.  Unless called from a callback, waits for
+	//		a delivery in progress, so the callback is not called after this
+	//		returns.
+	//
+	template <typename Callback>
+	WacomMTError RemoveRegistration(int deviceID_I, WacomMTHitRect *hitRect_I, void *userData_I,
+		std::vector<CallbackRegistration<Callback>> Device::*list_I)
+	{
+		std::lock_guard<std::mutex> state(gStateLock);
+		Device *device = gRunning ? FindDevice(deviceID_I) : nullptr;
+		if (!device)
+		{
+			return gRunning ? WMTErrorInvalidParam : WMTErrorQuit;
+		}
+
+		bool removed = false;
+		{
+			std::lock_guard<std::mutex> lock(device->lock);
+			std::vector<CallbackRegistration<Callback>> &list = device->*list_I;
+			for (auto iter = list.begin(); iter != list.end(); ++iter)
+			{
+				if (iter->userData == userData_I && SameHitRect(hitRect_I, iter->hasHitRect, iter->hitRect))
+				{
+					list.erase(iter);
+					removed = true;
+					break;
+				}
+			}
+		}
+
+		if (removed && std::this_thread::get_id() != device->threadID)
+		{
+			std::lock_guard<std::mutex> wait(device->deliverLock);
+		}
+		return removed ? WMTErrorSuccess : WMTErrorInvalidParam;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	template <typename Callback>
+	WacomMTError MoveRegistration(int deviceID_I, WacomMTHitRect *oldHitRect_I, WacomMTHitRect *newHitRect_I,
+		void *userData_I, std::vector<CallbackRegistration<Callback>> Device::*list_I)
+	{
+		std::lock_guard<std::mutex> state(gStateLock);
+		Device *device = gRunning ? FindDevice(deviceID_I) : nullptr;
+		if (!device)
+		{
+			return gRunning ? WMTErrorInvalidParam : WMTErrorQuit;
+		}
+
+		std::lock_guard<std::mutex> lock(device->lock);
+		for (CallbackRegistration<Callback> &registration : device->*list_I)
+		{
+			if (registration.userData == userData_I && SameHitRect(oldHitRect_I, registration.hasHitRect, registration.hitRect))
+			{
+				registration.hasHitRect = newHitRect_I != nullptr;
+				registration.hitRect = newHitRect_I ? *newHitRect_I : WacomMTHitRect();
+				return WMTErrorSuccess;
+			}
+		}
+		return WMTErrorInvalidParam;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	WacomMTError AddWindow(int deviceID_I, void *window_I, WMT_STANDIN_POST post_I, unsigned message_I, int bufferDepth_I)
+	{
+		std::lock_guard<std::mutex> state(gStateLock);
+		Device *device = gRunning ? FindDevice(deviceID_I) : nullptr;
+		if (!device || !window_I || bufferDepth_I < 1)
+		{
+			return gRunning ? WMTErrorInvalidParam : WMTErrorQuit;
+		}
+
+		WindowRegistration window;
+		window.window = window_I;
+		window.post = post_I;
+		window.message = message_I;
+		window.next = 0;
+		window.ring.resize(bufferDepth_I);
+		for (WindowFrame &frame : window.ring)
+		{
+			frame.fingerData.resize(std::max(device->caps.FingerMax, 1));
+			frame.blobData.resize(std::max(device->caps.BlobMax, 1));
+			frame.pointData.resize(frame.blobData.size() * std::max(device->caps.BlobPointsMax, 1));
+			frame.rawData.resize(std::max(device->caps.ScanSizeX * device->caps.ScanSizeY, 1));
+		}
+
+		std::lock_guard<std::mutex> lock(device->lock);
+		device->windows.push_back(std::move(window));
+		return WMTErrorSuccess;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	WacomMTError RemoveWindow(void *window_I, unsigned message_I)
+	{
+		std::lock_guard<std::mutex> state(gStateLock);
+		if (!gRunning)
+		{
+			return WMTErrorQuit;
+		}
+
+		bool removed = false;
+		for (const std::unique_ptr<Device> &device : gDevices)
+		{
+			{
+				std::lock_guard<std::mutex> lock(device->lock);
+				auto end = std::remove_if(device->windows.begin(), device->windows.end(),
+					[&](const WindowRegistration &registration_I) { return registration_I.window == window_I && registration_I.message == message_I; });
+				removed |= end != device->windows.end();
+				device->windows.erase(end, device->windows.end());
+			}
+
+			if (std::this_thread::get_id() != device->threadID)
+			{
+				std::lock_guard<std::mutex> wait(device->deliverLock);
+			}
+		}
+		return removed ? WMTErrorSuccess : WMTErrorInvalidParam;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Copies the frame into the window's next ring slot and posts it.
+	//
+	void PostToWindows(Device &device_IO, unsigned message_I)
+	{
+		std::lock_guard<std::mutex> lock(device_IO.lock);
+		for (WindowRegistration &window : device_IO.windows)
+		{
+			if (window.message != message_I)
+			{
+				continue;
+			}
+
+			WindowFrame &frame = window.ring[window.next];
+			window.next = (window.next + 1) % window.ring.size();
+			void *data = nullptr;
+
+			if (message_I == WM_FINGERDATA)
+			{
+				const WacomMTFingerCollection &source = device_IO.synth.Fingers();
+				frame.fingers = source;
+				frame.fingers.FingerCount = std::min(source.FingerCount, static_cast<int>(frame.fingerData.size()));
+				std::copy(source.Fingers, source.Fingers + frame.fingers.FingerCount, frame.fingerData.begin());
+				frame.fingers.Fingers = frame.fingerData.data();
+				data = &frame.fingers;
+			}
+			else if (message_I == WM_BLOBDATA)
+			{
+				const WacomMTBlobAggregate &source = device_IO.synth.Blobs();
+				frame.blobs = source;
+				frame.blobs.BlobArray = frame.blobData.data();
+				frame.blobs.BlobCount = 0;
+
+				size_t points = 0;
+				for (int idx = 0; idx < source.BlobCount && idx < static_cast<int>(frame.blobData.size()); idx++)
+				{
+					const WacomMTBlob &blob = source.BlobArray[idx];
+					if (points + blob.PointCount > frame.pointData.size())
+					{
+						break;
+					}
+
+					WacomMTBlob &copy = frame.blobData[frame.blobs.BlobCount++];
+					copy = blob;
+					copy.BlobPoints = frame.pointData.data() + points;
+					std::copy(blob.BlobPoints, blob.BlobPoints + blob.PointCount, copy.BlobPoints);
+					points += blob.PointCount;
+				}
+				data = &frame.blobs;
+			}
+			else
+			{
+				const WacomMTRawData &source = device_IO.synth.Raw();
+				frame.raw = source;
+				frame.raw.ElementCount = std::min(source.ElementCount, static_cast<int>(frame.rawData.size()));
+				std::copy(source.Sensitivity, source.Sensitivity + frame.raw.ElementCount, frame.rawData.begin());
+				frame.raw.Sensitivity = frame.rawData.data();
+				data = &frame.raw;
+			}
+
+			if (window.post)
+			{
+				window.post(window.window, message_I, data);
+			}
+#if defined(_MSC_VER)
+			else
+			{
+				PostMessage(static_cast<HWND>(window.window), message_I, 0, reinterpret_cast<LPARAM>(data));
+			}
+#endif
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Calls the finger and blob callbacks with the current frame.  A
+	//		callback with a hit rect only gets the fingers (or blobs) whose
+	//		position is inside it, and none if no finger is.
+	//
+	void DeliverTouch(Device &device_IO)
+	{
+		{
+			std::lock_guard<std::mutex> lock(device_IO.lock);
+			device_IO.fingerTargets = device_IO.fingerRegistrations;
+			device_IO.blobTargets = device_IO.blobRegistrations;
+		}
+
+		WacomMTFingerCollection &fingers = device_IO.synth.Fingers();
+		for (const FingerRegistration &target : device_IO.fingerTargets)
+		{
+			if (!target.hasHitRect)
+			{
+				target.callback(&fingers, target.userData);
+				continue;
+			}
+
+			device_IO.hitFingers.clear();
+			for (int idx = 0; idx < fingers.FingerCount; idx++)
+			{
+				if (InHitRect(target.hitRect, fingers.Fingers[idx].X, fingers.Fingers[idx].Y))
+				{
+					device_IO.hitFingers.push_back(fingers.Fingers[idx]);
+				}
+			}
+
+			if (!device_IO.hitFingers.empty())
+			{
+				WacomMTFingerCollection hit = fingers;
+				hit.FingerCount = static_cast<int>(device_IO.hitFingers.size());
+				hit.Fingers = device_IO.hitFingers.data();
+				target.callback(&hit, target.userData);
+			}
+		}
+
+		WacomMTBlobAggregate &blobs = device_IO.synth.Blobs();
+		for (const BlobRegistration &target : device_IO.blobTargets)
+		{
+			if (!target.hasHitRect)
+			{
+				target.callback(&blobs, target.userData);
+				continue;
+			}
+
+			device_IO.hitBlobs.clear();
+			for (int idx = 0; idx < blobs.BlobCount; idx++)
+			{
+				if (InHitRect(target.hitRect, blobs.BlobArray[idx].X, blobs.BlobArray[idx].Y))
+				{
+					device_IO.hitBlobs.push_back(blobs.BlobArray[idx]);
+				}
+			}
+
+			if (!device_IO.hitBlobs.empty())
+			{
+				WacomMTBlobAggregate hit = blobs;
+				hit.BlobCount = static_cast<int>(device_IO.hitBlobs.size());
+				hit.BlobArray = device_IO.hitBlobs.data();
+				target.callback(&hit, target.userData);
+			}
+		}
+
+		PostToWindows(device_IO, WM_FINGERDATA);
+		PostToWindows(device_IO, WM_BLOBDATA);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	void DeliverRaw(Device &device_IO)
+	{
+		{
+			std::lock_guard<std::mutex> lock(device_IO.lock);
+			device_IO.rawTargets = device_IO.rawRegistrations;
+		}
+
+		WacomMTRawData &raw = device_IO.synth.Raw();
+		for (const RawRegistration &target : device_IO.rawTargets)
+		{
+			target.callback(&raw, target.userData);
+		}
+
+		PostToWindows(device_IO, WM_RAWDATA);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Device thread.  Frames are timed from the start of the thread and
+	//		made for their scheduled time; a frame held up by a slow callback
+	//		is delivered late, not skipped.
+	//
+	void RunDevice(Device *device_I, int fingerRateHz_I, int rawRateHz_I)
+	{
+		const Clock::time_point start = Clock::now();
+		const Clock::duration fingerPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(fingerRateHz_I, 1)));
+		const Clock::duration rawPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(rawRateHz_I, 1)));
+
+		Clock::time_point nextFinger = start;
+		Clock::time_point nextRaw = start;
+
+		while (!device_I->stop)
+		{
+			const Clock::time_point next = rawRateHz_I > 0 ? std::min(nextFinger, nextRaw) : nextFinger;
+			std::this_thread::sleep_until(next);
+
+			std::lock_guard<std::mutex> deliver(device_I->deliverLock);
+			if (device_I->stop)
+			{
+				break;
+			}
+
+			if (next == nextFinger)
+			{
+				device_I->synth.Step(std::chrono::duration<double>(next - start).count());
+				DeliverTouch(*device_I);
+				nextFinger += fingerPeriod;
+			}
+
+			if (rawRateHz_I > 0 && next == nextRaw)
+			{
+				device_I->synth.BuildRaw();
+				DeliverRaw(*device_I);
+				nextRaw += rawPeriod;
+			}
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	void StartDevice(Device &device_IO, const WacomMTStandInConfig &config_I)
+	{
+		device_IO.thread = std::thread(RunDevice, &device_IO, config_I.fingerRateHz, config_I.rawRateHz);
+		device_IO.threadID = device_IO.thread.get_id();
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// Purpose
+	//		Waits for a device's thread to end (stop must be set) and deletes
+	//		the device.  Called from a callback of the device, the thread is
+	//		still using it and ends once the callback returns, so it keeps
+	//		the device.
+	//
+	void JoinDevice(std::unique_ptr<Device> &device_IO)
+	{
+		if (device_IO->thread.get_id() == std::this_thread::get_id())
+		{
+			device_IO->thread.detach();
+			device_IO.release();
+		}
+		else if (device_IO->thread.joinable())
+		{
+			device_IO->thread.join();
+		}
+		device_IO.reset();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Stand-in configuration
+
+void WacomMTStandInGetDefaultConfig(WacomMTStandInConfig *config)
+{
+	if (!config)
+	{
+		return;
+	}
+
+	*config = WacomMTStandInConfig();
+	config->deviceCount = STANDIN_DEFAULT_DEVICES;
+	config->deviceType = WMTDeviceTypeIntegrated;
+	config->fingerCount = STANDIN_DEFAULT_FINGERS;
+	config->fingerRateHz = STANDIN_DEFAULT_RATE_HZ;
+	config->rawRateHz = STANDIN_DEFAULT_RAW_RATE_HZ;
+	config->scanSizeX = STANDIN_DEFAULT_SCAN_X;
+	config->scanSizeY = STANDIN_DEFAULT_SCAN_Y;
+	config->blobPoints = STANDIN_DEFAULT_BLOB_POINTS;
+	config->seed = 1;
+	ApplyEnvironment(*config);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError WacomMTStandInSetConfig(const WacomMTStandInConfig *config)
+{
+	if (!config || config->deviceCount < 0 || config->fingerCount < 0 || config->fingerRateHz <= 0 ||
+		config->rawRateHz < 0 || config->scanSizeX <= 0 || config->scanSizeY <= 0 || config->blobPoints < 3)
+	{
+		return WMTErrorInvalidParam;
+	}
+
+	std::lock_guard<std::mutex> state(gStateLock);
+	gConfig = *config;
+	gConfigSet = true;
+	return WMTErrorSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError WacomMTStandInAttachDevice(int *deviceID)
+{
+	WacomMTCapability caps = WacomMTCapability();
+	WMT_ATTACH_CALLBACK callback = nullptr;
+	void *userData = nullptr;
+	{
+		std::lock_guard<std::mutex> state(gStateLock);
+		if (!gRunning)
+		{
+			return WMTErrorQuit;
+		}
+
+		int id = gConfig.newDeviceIDs ? std::max(STANDIN_FIRST_DEVICE_ID, gLastDeviceID + 1) : STANDIN_FIRST_DEVICE_ID;
+		while (FindDevice(id))
+		{
+			id++;
+		}
+		gLastDeviceID = std::max(gLastDeviceID, id);
+
+		gDevices.push_back(MakeDevice(gConfig, id));
+		StartDevice(*gDevices.back(), gConfig);
+		caps = gDevices.back()->caps;
+		callback = gAttachCallback;
+		userData = gAttachUserData;
+	}
+
+	if (deviceID)
+	{
+		*deviceID = caps.DeviceID;
+	}
+	if (callback)
+	{
+		callback(caps, userData);
+	}
+	return WMTErrorSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError WacomMTStandInDetachDevice(int deviceID)
+{
+	std::unique_ptr<Device> device;
+	WMT_DETACH_CALLBACK callback = nullptr;
+	void *userData = nullptr;
+	{
+		std::lock_guard<std::mutex> state(gStateLock);
+		if (!gRunning)
+		{
+			return WMTErrorQuit;
+		}
+
+		auto iter = std::find_if(gDevices.begin(), gDevices.end(),
+			[deviceID](const std::unique_ptr<Device> &device_I) { return device_I->caps.DeviceID == deviceID; });
+		if (iter == gDevices.end())
+		{
+			return WMTErrorInvalidParam;
+		}
+
+		device = std::move(*iter);
+		gDevices.erase(iter);
+		callback = gDetachCallback;
+		userData = gDetachUserData;
+	}
+
+	device->stop = true;
+	JoinDevice(device);
+
+	if (callback)
+	{
+		callback(deviceID, userData);
+	}
+	return WMTErrorSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError WacomMTStandInRegisterFingerReadPost(int deviceID, WacomMTProcessingMode mode, WMT_STANDIN_POST post, void *window, int bufferDepth)
+{
+	(void)mode;
+
+	if (!post)
+	{
+		return WMTErrorInvalidParam;
+	}
+	return AddWindow(deviceID, window, post, WM_FINGERDATA, bufferDepth);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError WacomMTStandInUnRegisterFingerReadPost(void *window)
+{
+	return RemoveWindow(window, WM_FINGERDATA);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Feel Multi-Touch API
+
+WacomMTError WacomMTInitialize(int libraryAPIVersion)
+{
+	if (libraryAPIVersion < 1 || libraryAPIVersion > WACOM_MULTI_TOUCH_API_VERSION)
+	{
+		return WMTErrorBadVersion;
+	}
+
+	std::lock_guard<std::mutex> state(gStateLock);
+	if (gRunning)
+	{
+		return WMTErrorSuccess;
+	}
+
+	if (!gConfigSet)
+	{
+		WacomMTStandInGetDefaultConfig(&gConfig);
+	}
+
+	gScript.clear();
+	if (gConfig.scriptPath[0] && !LoadTouchScript(gConfig.scriptPath, gScript))
+	{
+		return WMTErrorInvalidParam;
+	}
+
+	gRunning = true;
+	for (int idx = 0; idx < gConfig.deviceCount; idx++)
+	{
+		gDevices.push_back(MakeDevice(gConfig, STANDIN_FIRST_DEVICE_ID + idx));
+	}
+	gLastDeviceID = STANDIN_FIRST_DEVICE_ID + gConfig.deviceCount - 1;
+
+	for (const std::unique_ptr<Device> &device : gDevices)
+	{
+		StartDevice(*device, gConfig);
+	}
+	return WMTErrorSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void WacomMTQuit(void)
+{
+	std::vector<std::unique_ptr<Device>> devices;
+	{
+		std::lock_guard<std::mutex> state(gStateLock);
+		gRunning = false;
+		devices.swap(gDevices);
+		gAttachCallback = nullptr;
+		gDetachCallback = nullptr;
+	}
+
+	for (const std::unique_ptr<Device> &device : devices)
+	{
+		device->stop = true;
+	}
+
+	for (std::unique_ptr<Device> &device : devices)
+	{
+		JoinDevice(device);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int WacomMTGetAttachedDeviceIDs(int *deviceArray, size_t bufferSize)
+{
+	std::lock_guard<std::mutex> state(gStateLock);
+	const int count = static_cast<int>(gDevices.size());
+
+	if (deviceArray && bufferSize >= count * sizeof(int))
+	{
+		for (int idx = 0; idx < count; idx++)
+		{
+			deviceArray[idx] = gDevices[idx]->caps.DeviceID;
+		}
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError WacomMTGetDeviceCapabilities(int deviceID, WacomMTCapability *capabilityBuffer)
+{
+	std::lock_guard<std::mutex> state(gStateLock);
+	if (!gRunning)
+	{
+		return WMTErrorQuit;
+	}
+
+	Device *device = FindDevice(deviceID);
+	if (!device || !capabilityBuffer)
+	{
+		return WMTErrorInvalidParam;
+	}
+
+	*capabilityBuffer = device->caps;
+	return WMTErrorSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Called by WacomMTStandInAttachDevice and WacomMTStandInDetachDevice.
+
+WacomMTError WacomMTRegisterAttachCallback(WMT_ATTACH_CALLBACK attachCallback, void *userData)
+{
+	std::lock_guard<std::mutex> state(gStateLock);
+	if (!gRunning)
+	{
+		return WMTErrorQuit;
+	}
+
+	gAttachCallback = attachCallback;
+	gAttachUserData = userData;
+	return WMTErrorSuccess;
+}
+
+WacomMTError WacomMTRegisterDetachCallback(WMT_DETACH_CALLBACK detachCallback, void *userData)
+{
+	std::lock_guard<std::mutex> state(gStateLock);
+	if (!gRunning)
+	{
+		return WMTErrorQuit;
+	}
+
+	gDetachCallback = detachCallback;
+	gDetachUserData = userData;
+	return WMTErrorSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError WacomMTRegisterFingerReadCallback(int deviceID, WacomMTHitRect *hitRect, WacomMTProcessingMode mode, WMT_FINGER_CALLBACK fingerCallback, void *userData)
+{
+	return AddRegistration(deviceID, hitRect, mode, fingerCallback, userData, &Device::fingerRegistrations);
+}
+
+WacomMTError WacomMTRegisterBlobReadCallback(int deviceID, WacomMTHitRect *hitRect, WacomMTProcessingMode mode, WMT_BLOB_CALLBACK blobCallback, void *userData)
+{
+	return AddRegistration(deviceID, hitRect, mode, blobCallback, userData, &Device::blobRegistrations);
+}
+
+WacomMTError WacomMTRegisterRawReadCallback(int deviceID, WacomMTProcessingMode mode, WMT_RAW_CALLBACK rawCallback, void *userData)
+{
+	return AddRegistration(deviceID, nullptr, mode, rawCallback, userData, &Device::rawRegistrations);
+}
+
+WacomMTError WacomMTUnRegisterFingerReadCallback(int deviceID, WacomMTHitRect *hitRect, WacomMTProcessingMode mode, void *userData)
+{
+	(void)mode;
+
+	return RemoveRegistration(deviceID, hitRect, userData, &Device::fingerRegistrations);
+}
+
+WacomMTError WacomMTUnRegisterBlobReadCallback(int deviceID, WacomMTHitRect *hitRect, WacomMTProcessingMode mode, void *userData)
+{
+	(void)mode;
+
+	return RemoveRegistration(deviceID, hitRect, userData, &Device::blobRegistrations);
+}
+
+WacomMTError WacomMTUnRegisterRawReadCallback(int deviceID, WacomMTProcessingMode mode, void *userData)
+{
+	(void)mode;
+
+	return RemoveRegistration(deviceID, nullptr, userData, &Device::rawRegistrations);
+}
+
+WacomMTError WacomMTMoveRegisteredFingerReadCallback(int deviceID, WacomMTHitRect *oldHitRect, WacomMTProcessingMode mode, WacomMTHitRect *newHitRect, void *userData)
+{
+	(void)mode;
+
+	return MoveRegistration(deviceID, oldHitRect, newHitRect, userData, &Device::fingerRegistrations);
+}
+
+WacomMTError WacomMTMoveRegisteredBlobReadCallback(int deviceID, WacomMTHitRect *oldHitRect, WacomMTProcessingMode mode, WacomMTHitRect *newHitRect, void *userData)
+{
+	(void)mode;
+
+	return MoveRegistration(deviceID, oldHitRect, newHitRect, userData, &Device::blobRegistrations);
+}
+
+#if defined(_MSC_VER)
+///////////////////////////////////////////////////////////////////////////////
+
+WacomMTError WacomMTRegisterFingerReadHWND(int deviceID, WacomMTProcessingMode mode, HWND hWnd, int bufferDepth)
+{
+	(void)mode;
+
+	return AddWindow(deviceID, hWnd, nullptr, WM_FINGERDATA, bufferDepth);
+}
+
+WacomMTError WacomMTRegisterBlobReadHWND(int deviceID, WacomMTProcessingMode mode, HWND hWnd, int bufferDepth)
+{
+	(void)mode;
+
+	return AddWindow(deviceID, hWnd, nullptr, WM_BLOBDATA, bufferDepth);
+}
+
+WacomMTError WacomMTRegisterRawReadHWND(int deviceID, WacomMTProcessingMode mode, HWND hWnd, int bufferDepth)
+{
+	(void)mode;
+
+	return AddWindow(deviceID, hWnd, nullptr, WM_RAWDATA, bufferDepth);
+}
+
+WacomMTError WacomMTUnRegisterFingerReadHWND(HWND hWnd)
+{
+	return RemoveWindow(hWnd, WM_FINGERDATA);
+}
+
+WacomMTError WacomMTUnRegisterBlobReadHWND(HWND hWnd)
+{
+	return RemoveWindow(hWnd, WM_BLOBDATA);
+}
+#endif
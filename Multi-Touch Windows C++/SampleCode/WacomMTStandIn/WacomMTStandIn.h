@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	PURPOSE
+//		Stand-in for the Wacom Feel(TM) Multi-Touch driver library.
+//
+//		Implements the Feel Multi-Touch API of WacomMultiTouch.h with
+//		synthetic devices (see TouchSynth.h), so that touch processing can be
+//		run and benchmarked without a tablet, on Windows or Linux.  Each
+//		device has a thread that delivers finger and blob frames at the
+//		finger rate and raw frames at the raw rate to the registered
+//		callbacks and windows.
+//
+//		Windows: build WacomMTStandIn.vcxproj and copy the resulting
+//		wacommt.dll next to the sample's executable; the sample loads it
+//		instead of the driver's.  Set WACOMMT_STANDIN to configure it, e.g.
+//			WACOMMT_STANDIN=devices=2,fingers=10,rate=240,raw=60,type=opaque
+//		Other keys: scan=WxH, points=N (blob contour points), seed=N,
+//		script=path (see LoadTouchScript), newids=1 (see below).
+//
+//		Linux: the CMakeLists.txt of the sample builds it as libwacommt.so,
+//		together with the touch processing and benchmarks that use it, e.g.
+//			cmake -S .. -B build && cmake --build build
+//		Configure it with WacomMTStandInSetConfig.  There are no windows
+//		there; WacomMTStandInRegisterFingerReadPost delivers as to a window
+//		through a function instead.
+//
+//		WacomMTStandInAttachDevice and WacomMTStandInDetachDevice plug
+//		devices in and out while the library runs, calling the attach and
+//		detach callbacks as the driver does.  Load them with GetProcAddress
+//		(see the typedefs below), since the driver's library has neither.
+//
+//	COPYRIGHT
+//		Copyright (c) 2012-2020 Wacom Co., Ltd.
+//
+//		The text and information contained in this file may be freely used,
+//		copied, or distributed without compensation or licensing restrictions.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "WacomMultiTouch.h"
+
+// Defaults of the stand-in configuration.
+#define STANDIN_DEFAULT_DEVICES			1
+#define STANDIN_DEFAULT_FINGERS			5
+#define STANDIN_DEFAULT_RATE_HZ			100
+#define STANDIN_DEFAULT_RAW_RATE_HZ		60
+#define STANDIN_DEFAULT_SCAN_X			64
+#define STANDIN_DEFAULT_SCAN_Y			36
+#define STANDIN_DEFAULT_BLOB_POINTS		32
+
+// The first device gets this ID, the next one ID + 1, and so on; a device
+// plugged in later gets the lowest ID that is free, or with newDeviceIDs
+// set, one that no device had before, as the driver may give a device that
+// is plugged in again.
+#define STANDIN_FIRST_DEVICE_ID			1
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+	///////////////////////////////////////////////////////////////////////////
+	// Synthetic devices.  Integrated devices cover a 1920 x 1080 display of
+	// 527 x 296 mm; opaque ones a 224 x 148 mm tablet.
+	//
+	typedef struct _WacomMTStandInConfig
+	{
+		int						deviceCount;
+		WacomMTDeviceType		deviceType;
+		int						fingerCount;		// fingers touching in random mode
+		int						fingerRateHz;		// finger and blob frames
+		int						rawRateHz;			// raw frames; 0 for none
+		int						scanSizeX;
+		int						scanSizeY;
+		int						blobPoints;			// contour points per blob
+		unsigned					seed;
+		char						scriptPath[260];	// keyframes instead of random fingers
+		int						newDeviceIDs;		// nonzero: never reuse a device ID
+	} WacomMTStandInConfig;
+
+	/// Fills config with the defaults, overridden by WACOMMT_STANDIN if set.
+	WMT_EXPORT void WacomMTStandInGetDefaultConfig(WacomMTStandInConfig *config);
+
+	/// Sets the configuration used by the next WacomMTInitialize, and by the
+	/// devices attached with WacomMTStandInAttachDevice from now on.
+	WMT_EXPORT WacomMTError WacomMTStandInSetConfig(const WacomMTStandInConfig *config);
+
+	/// Plugs in a device made from the configuration, starts its deliveries
+	/// and calls the attach callback, on the calling thread.
+	WMT_EXPORT WacomMTError WacomMTStandInAttachDevice(int *deviceID);
+
+	/// Unplugs a device: stops its deliveries, waiting for one in progress
+	/// unless called from it, then calls the detach callback, on the
+	/// calling thread.
+	WMT_EXPORT WacomMTError WacomMTStandInDetachDevice(int deviceID);
+
+	/// Called on the device thread in place of posting a window message:
+	/// window is the value registered, data the message's lParam.
+	typedef void ( * WMT_STANDIN_POST )( void *window, unsigned message, void *data );
+
+	/// Delivers finger frames as WacomMTRegisterFingerReadHWND does, from
+	/// a ring of bufferDepth copies, but by calling post with WM_FINGERDATA
+	/// instead of posting to a window.  Works on any platform.
+	WMT_EXPORT WacomMTError WacomMTStandInRegisterFingerReadPost(int deviceID, WacomMTProcessingMode mode, WMT_STANDIN_POST post, void *window, int bufferDepth);
+
+	WMT_EXPORT WacomMTError WacomMTStandInUnRegisterFingerReadPost(void *window);
+
+	typedef void         ( * WACOMMTSTANDINGETDEFAULTCONFIG ) ( WacomMTStandInConfig* );
+	typedef WacomMTError ( * WACOMMTSTANDINSETCONFIG )        ( const WacomMTStandInConfig* );
+	typedef WacomMTError ( * WACOMMTSTANDINATTACHDEVICE )     ( int* );
+	typedef WacomMTError ( * WACOMMTSTANDINDETACHDEVICE )     ( int );
+	typedef WacomMTError ( * WACOMMTSTANDINREGISTERFINGERREADPOST )   ( int, WacomMTProcessingMode, WMT_STANDIN_POST, void*, int );
+	typedef WacomMTError ( * WACOMMTSTANDINUNREGISTERFINGERREADPOST ) ( void* );
+
+#if defined(__cplusplus)
+}
+#endif
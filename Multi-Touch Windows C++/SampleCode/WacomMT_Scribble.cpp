@@ -23,10 +23,25 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include <atomic>
 #include <crtdbg.h>
 
 #include "WacomMultiTouch.h"
 #include "WintabUtils.h"
+#include "BlobMoments.h"
+#include "BlobSnapshot.h"
+#include "DeviceRegistry.h"
+#include "FingerTracks.h"
+#include "Gestures.h"
+#include "HitRegions.h"
+#include "InputTimeline.h"
+#include "PalmRejection.h"
+#include "RawBlobs.h"
+#include "RawFilter.h"
+#include "RawHeatmap.h"
+#include "TouchFrameQueue.h"
+#include "TouchTransform.h"
+#include "TouchBenchmark.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Defines
@@ -39,17 +54,28 @@
 // Graphics HPEN objects
 #define NUM_HPENS		10
 
+// Hit regions: the toolbar strip along the top of the client area, left to
+// the system as well (observer mode), and the timer that brings the driver
+// up to date while the window moves.
+#define TOOLBAR_HEIGHT			32
+#define HIT_REGION_TIMER		1
+#define HIT_REGION_TIMER_MS	16
+
+// Devices attaching and detaching, posted by the MTAPI callbacks so that
+// the window thread registers for their data.  The attach message carries a
+// copy of the capabilities in lParam, which the window deletes.
+#define WM_MTDEVICEATTACHED	(WM_APP + 1)
+#define WM_MTDEVICEDETACHED	(WM_APP + 2)
+
 ///////////////////////////////////////////////////////////////////////////////
 // Wintab support headers
-#define PACKETDATA	(PK_X | PK_Y | PK_BUTTONS | PK_NORMAL_PRESSURE)
+#define PACKETDATA	(PK_X | PK_Y | PK_BUTTONS | PK_NORMAL_PRESSURE | PK_TIME)
 #define PACKETMODE	PK_BUTTONS
 #include "pktdef.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Types
 
-using WacomMTHitRectPtr = std::unique_ptr<WacomMTHitRect>;
-
 enum class EDataType
 {
 	ENoData,
@@ -81,19 +107,38 @@ RECT										g_clientRect = {0, 0, 0, 0};
 bool										g_ShowTouchSize = true;
 bool										g_ShowTouchID = false;
 
-std::map<int, WacomMTCapability>	g_caps;
-std::vector<int>						g_devices;
+// The attached devices: changed by the window thread, read by the render
+// thread without locks.
+DeviceRegistry							g_deviceRegistry;
 HCTX										g_tabCtx = NULL;
 
 std::map<int, HPEN>					g_hPenMap;
 std::map<int, HPEN>					g_fingerHPenMap;
 
+// Recent history, gestures and palm rejection of each device's fingers
+// (under the graphics lock).
+std::map<int, FingerTrackStore>	g_fingerTracks;
+std::map<int, GestureRecognizer>	g_gestures;
+std::map<int, PalmRejector>		g_palmRejectors;
+
+// Conversion of each device's fingers to the client area, kept up to date
+// with the window, and the points of the frame being drawn (under the
+// graphics lock).
+std::map<int, TouchTransform>		g_touchTransforms;
+std::vector<TouchPoint>				g_touchPoints;
+
 HBRUSH									g_noConfidenceBrush = NULL;
 HBRUSH									g_confidenceBrush = NULL;
 HBRUSH									g_positionOnlyBrush = NULL;
 HPEN										g_noConfidencePen = NULL;
 HPEN										g_confidencePen = NULL;
-std::map<int, WacomMTHitRectPtr>	g_lastWTHitRect;
+
+// Regions of the client area registered with the MTAPI in callback mode:
+// the canvas, and the toolbar strip above it.
+HitRegionManager						g_hitRegions;
+int										g_canvasRegion = -1;
+int										g_toolbarRegion = -1;
+bool										g_hitRegionTimer = false;
 
 bool										g_useConfidenceBits = true;
 bool										g_ObserverMode = false;
@@ -104,6 +149,26 @@ bool										g_UseWinHitRect = true;
 
 CRITICAL_SECTION						g_graphicsCriticalSection;
 
+// Touch frames are handed from the MTAPI callbacks to the render thread, so
+// that drawing never holds up the driver's callback thread.
+TouchFrameQueue						g_touchFrames;
+HANDLE									g_touchFrameEvent = NULL;
+HANDLE									g_touchRenderThread = NULL;
+std::atomic<bool>						g_stopTouchRender(false);
+
+// Pen packets and finger frames, stamped on one clock and put in order for
+// palm rejection and gestures, which the render thread feeds.
+InputTimeline							g_inputTimeline;
+
+// Blob frames posted to the window are drawn from a snapshot as well.
+BlobSnapshotPool						g_blobSnapshots;
+
+// Blobs found in the raw frames of each device, after denoising (render
+// thread only).
+std::map<int, std::unique_ptr<RawBlobExtractor>>	g_rawBlobs;
+std::map<int, RawFrameFilter>							g_rawFilters;
+std::map<int, RawHeatmap>								g_rawHeatmaps;
+
 ///////////////////////////////////////////////////////////////////////////////
 // Forward declarations of functions included in this code module
 
@@ -116,20 +181,27 @@ void					ClearScreen();
 ///////////////////////////////////////////////////////////////////////////////
 // Multi-touch API support functions
 
-WacomMTHitRectPtr GetAppHitRect();
 int FingerCallback(WacomMTFingerCollection *fingerData, void *userData);
 int BlobCallback(WacomMTBlobAggregate *blobData, void *userData);
 int RawCallback(WacomMTRawData *rawData, void *userData);
 void AttachCallback(WacomMTCapability deviceInfo, void *userRef);
 void DetachCallback(int deviceID, void *userRef);
-void DrawFingerData(int count, WacomMTFinger *fingers, int device);
-void DrawBlobData(int count, WacomMTBlob *blobs, int device);
-void DrawRawData(int count, unsigned short* rawBuf, int device);
+void OnDeviceAttached(HWND hWnd_I, const WacomMTCapability &caps_I);
+void OnDeviceDetached(HWND hWnd_I, int deviceID_I);
+void DrawFingerData(int count, const WacomMTFinger *fingers, const int *regions, int device, int frameNumber, double timeMs_I, bool draw_I);
+void DrawBlobData(const BlobSnapshot &snapshot_I);
+void DrawRawData(int count, const unsigned short* rawBuf, int device);
+void DrawTouchFrame(const TouchFrame &frame_I);
+void ProcessTimelineEvent(const TimelineEvent &event_I);
+void TakeTouchFrame(const TouchFrame &frame_I);
+void StartTouchRenderer(void);
+void StopTouchRenderer(void);
 void DumpCaps(bool showMessageBox_I);
-bool ClientHitRectChanged(const WacomMTHitRectPtr& wtHitRect_I, int deviceID);
+void LayoutHitRegions(double timeMs_I);
+void UpdateTouchTransforms(void);
+void UpdateHitRegions(HWND hWnd_I, bool forced_I);
 WacomMTError RegisterForData(int deviceID_I, HWND hWnd_I);
 WacomMTError UnregisterForData(int deviceID, HWND hWnd_I);
-WacomMTError MoveCallback(int deviceID);
 WacomMTError InitWacomMTAPI(HWND hwnd_I);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -137,6 +209,7 @@ WacomMTError InitWacomMTAPI(HWND hwnd_I);
 
 HCTX InitWintabAPI(HWND hwnd_I);
 void DrawPenData(POINT point_I, UINT pressure_I, bool bMoveToPoint_I);
+void UpdatePenForPalms(POINT point_I, double timeMs_I);
 void Cleanup(void);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -170,6 +243,19 @@ WacomMTProcessingMode CurrentMode(void)
 		: WMTProcessingModeNone;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Milliseconds on the clock shared by pen and touch events.
+//
+double TimeMs(void)
+{
+	LARGE_INTEGER counter = {0};
+	LARGE_INTEGER frequency = {0};
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return counter.QuadPart * 1000.0 / frequency.QuadPart;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 std::wstring GetTitle(void)
@@ -248,12 +334,97 @@ int APIENTRY _tWinMain(_In_ HINSTANCE hInstance,
 							_In_ int nCmdShow)
 {
 	UNREFERENCED_PARAMETER(hPrevInstance);
-	UNREFERENCED_PARAMETER(lpCmdLine);
 
 	MSG msg;
 	HACCEL hAccelTable;
 
+	// Benchmarks run instead of the application.
+	if (_tcsstr(lpCmdLine, _T("/touchQueueBenchmark")))
+	{
+		RunTouchQueueBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/blobMomentsBenchmark")))
+	{
+		RunBlobMomentsBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/rawBlobsBenchmark")))
+	{
+		RunRawBlobsBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/rawFilterBenchmark")))
+	{
+		RunRawFilterBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/rawHeatmapBenchmark")))
+	{
+		RunRawHeatmapBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/gestureBenchmark")))
+	{
+		RunGestureBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/palmRejectionBenchmark")))
+	{
+		RunPalmRejectionBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/hitRegionBenchmark")))
+	{
+		RunHitRegionBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/hitRegionJoinStress")))
+	{
+		RunHitRegionJoinStress();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/touchTransformBenchmark")))
+	{
+		RunTouchTransformBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/deviceRegistryStress")))
+	{
+		RunDeviceRegistryStress();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/touchQueueReplugStress")))
+	{
+		RunTouchQueueReplugStress();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/deliveryLatencyBenchmark")))
+	{
+		RunDeliveryLatencyBenchmark();
+		return 0;
+	}
+
+	if (_tcsstr(lpCmdLine, _T("/inputTimelineBenchmark")))
+	{
+		RunInputTimelineBenchmark();
+		return 0;
+	}
+
 	InitializeCriticalSection(&g_graphicsCriticalSection);
+	g_touchFrameEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
 
 	// Initialize global strings
 	MyRegisterClass(hInstance);
@@ -307,6 +478,9 @@ int APIENTRY _tWinMain(_In_ HINSTANCE hInstance,
 		g_confidencePen = NULL;
 	}
 
+	CloseHandle(g_touchFrameEvent);
+	g_touchFrameEvent = NULL;
+
 	DeleteCriticalSection(&g_graphicsCriticalSection);
 
 	return static_cast<int>(msg.wParam);
@@ -417,6 +591,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
 		case WM_TIMER:
 		{
+			if (wParam == HIT_REGION_TIMER)
+			{
+				UpdateHitRegions(hWnd, false);
+				break;
+			}
 			return DefWindowProc(hWnd, message, wParam, lParam);
 		}
 
@@ -495,16 +674,17 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 					bool newMode = wmId == IDM_OBSERVER;
 					if (g_ObserverMode != newMode)
 					{
-						for (size_t idx = 0; idx < g_devices.size(); idx++)
+						const std::vector<WacomMTCapability> devices = g_deviceRegistry.Devices();
+						for (size_t idx = 0; idx < devices.size(); idx++)
 						{
-							UnregisterForData(g_devices[idx], hWnd);
+							UnregisterForData(devices[idx].DeviceID, hWnd);
 						}
 						g_ObserverMode = newMode;
 						CheckMenuItem(menu, IDM_OBSERVER, (g_ObserverMode ? MF_CHECKED : MF_UNCHECKED));
 						CheckMenuItem(menu, IDM_CONSUMER, (g_ObserverMode ? MF_UNCHECKED : MF_CHECKED));
-						for (size_t idx = 0; idx < g_devices.size(); idx++)
+						for (size_t idx = 0; idx < devices.size(); idx++)
 						{
-							RegisterForData(g_devices[idx], hWnd);
+							RegisterForData(devices[idx].DeviceID, hWnd);
 						}
 					}
 					SetWindowTextW(hWnd, GetTitle().c_str());
@@ -534,9 +714,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 				case IDM_RAW:
 				{
 					EDataType typeHit = (wmId == IDM_FINGER) ? EDataType::EFingerData : (wmId == IDM_BLOB) ? EDataType::EBlobData : EDataType::ERawData;
-					for (size_t idx = 0; idx < g_devices.size(); idx++)
+					const std::vector<WacomMTCapability> devices = g_deviceRegistry.Devices();
+					for (size_t idx = 0; idx < devices.size(); idx++)
 					{
-						UnregisterForData(g_devices[idx], hWnd);
+						UnregisterForData(devices[idx].DeviceID, hWnd);
 					}
 					if (g_DataType == typeHit)
 					{
@@ -551,9 +732,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 					CheckMenuItem(menu, IDM_BLOB, (g_DataType == EDataType::EBlobData ? MF_CHECKED : MF_UNCHECKED));
 					CheckMenuItem(menu, IDM_RAW, (g_DataType == EDataType::ERawData ? MF_CHECKED : MF_UNCHECKED));
 
-					for (size_t idx = 0; idx < g_devices.size(); idx++)
+					for (size_t idx = 0; idx < devices.size(); idx++)
 					{
-						RegisterForData(g_devices[idx], hWnd);
+						RegisterForData(devices[idx].DeviceID, hWnd);
 					}
 
 					SetWindowTextW(hWnd, GetTitle().c_str());
@@ -566,9 +747,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 				// See the Wacom MTAPI Developer docs for more on the difference.
 				case IDM_WINDOW_HANDLES:
 				{
-					for (size_t idx = 0; idx < g_devices.size(); idx++)
+					const std::vector<WacomMTCapability> devices = g_deviceRegistry.Devices();
+					for (size_t idx = 0; idx < devices.size(); idx++)
 					{
-						UnregisterForData(g_devices[idx], hWnd);
+						UnregisterForData(devices[idx].DeviceID, hWnd);
 					}
 					g_UseHWND = !g_UseHWND;
 
@@ -576,9 +758,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 					CheckMenuItem(menu, IDM_WINDOW_RECT, (g_UseHWND || g_UseWinHitRect ? MF_CHECKED : MF_UNCHECKED));
 					EnableMenuItem(menu, IDM_WINDOW_RECT, (g_UseHWND ? MF_GRAYED : MF_ENABLED));
 
-					for (size_t idx = 0; idx < g_devices.size(); idx++)
+					for (size_t idx = 0; idx < devices.size(); idx++)
 					{
-						RegisterForData(g_devices[idx], hWnd);
+						RegisterForData(devices[idx].DeviceID, hWnd);
 					}
 
 					SetWindowTextW(hWnd, GetTitle().c_str());
@@ -588,17 +770,18 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
 				case IDM_WINDOW_RECT:
 				{
-					for (size_t idx = 0; idx < g_devices.size(); idx++)
+					const std::vector<WacomMTCapability> devices = g_deviceRegistry.Devices();
+					for (size_t idx = 0; idx < devices.size(); idx++)
 					{
-						UnregisterForData(g_devices[idx], hWnd);
+						UnregisterForData(devices[idx].DeviceID, hWnd);
 					}
 
 					g_UseWinHitRect = !g_UseWinHitRect;
 					CheckMenuItem(menu, IDM_WINDOW_RECT, (g_UseWinHitRect ? MF_CHECKED : MF_UNCHECKED));
 
-					for (size_t idx = 0; idx < g_devices.size(); idx++)
+					for (size_t idx = 0; idx < devices.size(); idx++)
 					{
-						RegisterForData(g_devices[idx], hWnd);
+						RegisterForData(devices[idx].DeviceID, hWnd);
 					}
 
 					SetWindowTextW(hWnd, GetTitle().c_str());
@@ -656,6 +839,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
 		case WM_DESTROY:
 		{
+			// Stop drawing touch frames before the DC goes away.
+			StopTouchRenderer();
+
 			ReleaseDC(hWnd, g_hdc);
 			if (g_tabCtx)
 			{
@@ -678,41 +864,67 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			GetWindowInfo(hWnd, &appWindowInfo);
 			g_clientRect = appWindowInfo.rcClient;
 
-			if (!g_UseHWND)
-			{
-				// Make sure there's an attached touch tablet.
-				for (size_t idx = 0; idx < g_devices.size(); idx++)
-				{
-					int deviceID = g_devices[idx];
-					if (g_caps.count(deviceID) && (g_caps[deviceID].Type == WMTDeviceTypeIntegrated))
-					{
-						// Resend hitrect size and position to MTAPI
-						MoveCallback(deviceID);
-					}
-				}
-			}
-			else
-			{
-				return DefWindowProc(hWnd, message, wParam, lParam);
-			}
+			// Move the hit regions with the window; the MTAPI hears of it
+			// once the window settles, or every HIT_REGION_MAX_DELAY_MS.
+			const double timeMs = TimeMs();
+			EnterCriticalSection(&g_graphicsCriticalSection);
+			LayoutHitRegions(timeMs);
+			UpdateTouchTransforms();
+			LeaveCriticalSection(&g_graphicsCriticalSection);
+
+			UpdateHitRegions(hWnd, false);
 			break;
 		}
 
+		case WM_EXITSIZEMOVE:
+		{
+			UpdateHitRegions(hWnd, true);
+			return DefWindowProc(hWnd, message, wParam, lParam);
+		}
+
 		// Handle MTAPI Finger data
 		case WM_FINGERDATA:
 		{
-			DrawFingerData(((WacomMTFingerCollection*)lParam)->FingerCount,
-				((WacomMTFingerCollection*)lParam)->Fingers,
-				((WacomMTFingerCollection*)lParam)->DeviceID);
+			if (g_touchFrames.PushFingers((WacomMTFingerCollection*)lParam, TimeMs()))
+			{
+				SetEvent(g_touchFrameEvent);
+			}
+			break;
+		}
+
+		// Devices coming and going, from the MTAPI callbacks.
+		case WM_MTDEVICEATTACHED:
+		{
+			std::unique_ptr<WacomMTCapability> caps(reinterpret_cast<WacomMTCapability *>(lParam));
+			OnDeviceAttached(hWnd, *caps);
+			break;
+		}
+
+		case WM_MTDEVICEDETACHED:
+		{
+			OnDeviceDetached(hWnd, static_cast<int>(wParam));
 			break;
 		}
 
 		// Handle MTAPI Blob data
 		case WM_BLOBDATA:
 		{
-			DrawBlobData(((WacomMTBlobAggregate*)lParam)->BlobCount,
-				((WacomMTBlobAggregate*)lParam)->BlobArray,
-				((WacomMTBlobAggregate*)lParam)->DeviceID);
+			const BlobSnapshot *snapshot = g_blobSnapshots.Capture((WacomMTBlobAggregate*)lParam);
+			if (snapshot)
+			{
+				DrawBlobData(*snapshot);
+				g_blobSnapshots.Release(snapshot);
+			}
+			break;
+		}
+
+		// Pen entering or leaving proximity, for palm rejection.
+		case WT_PROXIMITY:
+		{
+			if (g_inputTimeline.PushPenProximity(LOWORD(lParam) != 0, TimeMs()))
+			{
+				SetEvent(g_touchFrameEvent);
+			}
 			break;
 		}
 
@@ -732,6 +944,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 				ptNew.y = wintabPkt.pkY;
 				prsNew = wintabPkt.pkNormalPressure;
 
+				if (g_inputTimeline.PushPenPacket(wintabPkt.pkTime, static_cast<float>(ptNew.x),
+					static_cast<float>(ptNew.y), prsNew, TimeMs()))
+				{
+					SetEvent(g_touchFrameEvent);
+				}
+
 				if ((ptNew.x != ptOld.x) || (ptNew.y != ptOld.y))
 				{
 					bool bMoveToPoint = ((prsOld == 0) && (prsNew > 0));
@@ -772,16 +990,12 @@ INT_PTR CALLBACK About(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
 			WacomMTError res = WMTErrorInvalidParam;
 
 			g_hWndAbout = hDlg;
-			for (size_t idx = 0; idx < g_devices.size(); idx++)
+			for (const WacomMTCapability &caps : g_deviceRegistry.Devices())
 			{
-				int deviceID = g_devices[idx];
-				if (g_caps.count(deviceID))
+				res = WacomMTRegisterFingerReadHWND(caps.DeviceID, WMTProcessingModePassThrough, g_hWndAbout, 5);
+				if (res != WMTErrorSuccess)
 				{
-					res = WacomMTRegisterFingerReadHWND(deviceID, WMTProcessingModePassThrough, g_hWndAbout, 5);
-					if (res != WMTErrorSuccess)
-					{
-						break;
-					}
+					break;
 				}
 			}
 			return 1;
@@ -791,15 +1005,12 @@ INT_PTR CALLBACK About(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
 		{
 			if ((LOWORD(wParam) == IDOK) || (LOWORD(wParam) == IDCANCEL))
 			{
-				for (size_t idx = 0; idx < g_devices.size(); idx++)
+				const size_t deviceCount = g_deviceRegistry.Devices().size();
+				for (size_t idx = 0; idx < deviceCount; idx++)
 				{
-					int deviceID = g_devices[idx];
-					if (g_caps.count(deviceID))
+					if (WacomMTUnRegisterFingerReadHWND(g_hWndAbout) != WMTErrorSuccess)
 					{
-						if (WacomMTUnRegisterFingerReadHWND(g_hWndAbout) != WMTErrorSuccess)
-						{
-							break;
-						}
+						break;
 					}
 				}
 				DestroyWindow(hDlg);
@@ -814,6 +1025,50 @@ INT_PTR CALLBACK About(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
 	return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Registers the callbacks of the hit regions for finger or blob data,
+//		whichever is shown, with the region's ID as the user data.  The
+//		driver calls each with the contacts within its rect, and the queue
+//		joins them again by frame.
+//
+class MTHitRegionDriver : public HitRegionDriver
+{
+public:
+	WacomMTError Register(int deviceID_I, int regionID_I, const WacomMTHitRect &rect_I, WacomMTProcessingMode mode_I) override
+	{
+		WacomMTHitRect rect = rect_I;
+		return g_DataType == EDataType::EBlobData
+			? WacomMTRegisterBlobReadCallback(deviceID_I, &rect, mode_I, BlobCallback, UserData(regionID_I))
+			: WacomMTRegisterFingerReadCallback(deviceID_I, &rect, mode_I, FingerCallback, UserData(regionID_I));
+	}
+
+	WacomMTError Move(int deviceID_I, int regionID_I, const WacomMTHitRect &from_I, const WacomMTHitRect &to_I, WacomMTProcessingMode mode_I) override
+	{
+		WacomMTHitRect from = from_I;
+		WacomMTHitRect to = to_I;
+		return g_DataType == EDataType::EBlobData
+			? WacomMTMoveRegisteredBlobReadCallback(deviceID_I, &from, mode_I, &to, UserData(regionID_I))
+			: WacomMTMoveRegisteredFingerReadCallback(deviceID_I, &from, mode_I, &to, UserData(regionID_I));
+	}
+
+	WacomMTError Unregister(int deviceID_I, int regionID_I, const WacomMTHitRect &rect_I, WacomMTProcessingMode mode_I) override
+	{
+		WacomMTHitRect rect = rect_I;
+		return g_DataType == EDataType::EBlobData
+			? WacomMTUnRegisterBlobReadCallback(deviceID_I, &rect, mode_I, UserData(regionID_I))
+			: WacomMTUnRegisterFingerReadCallback(deviceID_I, &rect, mode_I, UserData(regionID_I));
+	}
+
+	// The region of a callback's user data, 0 for a callback without one.
+	static int RegionID(void *userData_I) { return static_cast<int>(reinterpret_cast<intptr_t>(userData_I)); }
+
+private:
+	static void *UserData(int regionID_I) { return reinterpret_cast<void *>(static_cast<intptr_t>(regionID_I)); }
+};
+
+MTHitRegionDriver g_hitRegionDriver;
+
 ///////////////////////////////////////////////////////////////////////////////
 // Purpose
 //		Register for finger, blob, and raw data from the MTAPI.
@@ -822,10 +1077,21 @@ WacomMTError RegisterForData(int deviceID_I, HWND hWnd_I)
 {
 	WacomMTError res = WMTErrorInvalidParam;
 
-	WacomMTHitRectPtr wtHitRect;
-	if (g_caps[deviceID_I].Type == WMTDeviceTypeIntegrated)
+	WacomMTCapability caps = { 0 };
+	if (!g_deviceRegistry.Find(deviceID_I, caps))
 	{
-		wtHitRect = GetAppHitRect();
+		return res;
+	}
+
+	// Display tablets in windowed callback mode register a hit rect per
+	// region of the window.
+	if (!g_UseHWND && g_UseWinHitRect && caps.Type == WMTDeviceTypeIntegrated &&
+		(g_DataType == EDataType::EFingerData || g_DataType == EDataType::EBlobData))
+	{
+		EnterCriticalSection(&g_graphicsCriticalSection);
+		LayoutHitRegions(TimeMs());
+		LeaveCriticalSection(&g_graphicsCriticalSection);
+		return g_hitRegions.Attach(g_hitRegionDriver, deviceID_I);
 	}
 
 	switch (g_DataType)
@@ -838,7 +1104,7 @@ WacomMTError RegisterForData(int deviceID_I, HWND hWnd_I)
 			}
 			else
 			{
-				res = WacomMTRegisterFingerReadCallback(deviceID_I, wtHitRect.get(), CurrentMode(), FingerCallback, NULL);
+				res = WacomMTRegisterFingerReadCallback(deviceID_I, NULL, CurrentMode(), FingerCallback, NULL);
 			}
 			break;
 		}
@@ -851,7 +1117,7 @@ WacomMTError RegisterForData(int deviceID_I, HWND hWnd_I)
 			}
 			else
 			{
-				res = WacomMTRegisterBlobReadCallback(deviceID_I, wtHitRect.get(), CurrentMode(), BlobCallback, NULL);
+				res = WacomMTRegisterBlobReadCallback(deviceID_I, NULL, CurrentMode(), BlobCallback, NULL);
 			}
 			break;
 		}
@@ -868,53 +1134,70 @@ WacomMTError RegisterForData(int deviceID_I, HWND hWnd_I)
 		}
 	}
 
-	g_lastWTHitRect[deviceID_I] = std::move(wtHitRect);
-
 	return res;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // Purpose
-//		Callback triggered to deliver movement data from the MTAPI.
+//		Lays out the hit regions over the client area: the toolbar strip on
+//		top, and the canvas below it in the current processing mode.  Call
+//		under the graphics lock.
 //
-WacomMTError MoveCallback(int deviceID)
+void LayoutHitRegions(double timeMs_I)
 {
-	WacomMTError res = WMTErrorInvalidParam;
+	const float width = static_cast<float>(g_clientRect.right - g_clientRect.left);
+	const float height = static_cast<float>(g_clientRect.bottom - g_clientRect.top);
+	const float toolbarHeight = std::min(static_cast<float>(TOOLBAR_HEIGHT), height);
 
-	WacomMTHitRectPtr wtHitRect = GetAppHitRect();
-	if (ClientHitRectChanged(wtHitRect, deviceID))
-	{
-		switch (g_DataType)
-		{
-			case EDataType::EFingerData:
-			{
-				// move registered callback from prev hit rect to new hit rect
-				res = WacomMTMoveRegisteredFingerReadCallback(deviceID, g_lastWTHitRect[deviceID].get(), CurrentMode(), wtHitRect.get(), NULL);
-				break;
-			}
+	const WacomMTHitRect toolbar = { 0.0f, 0.0f, width, toolbarHeight };
+	const WacomMTHitRect canvas = { 0.0f, toolbarHeight, width, height - toolbarHeight };
 
-			case EDataType::EBlobData:
-			{
-				// move registered callback from prev hit rect to new hit rect
-				res = WacomMTMoveRegisteredBlobReadCallback(deviceID, g_lastWTHitRect[deviceID].get(), CurrentMode(), wtHitRect.get(), NULL);
-				break;
-			}
+	g_hitRegions.MoveWindow(static_cast<float>(g_clientRect.left), static_cast<float>(g_clientRect.top), timeMs_I);
+	if (!g_hitRegions.RegionCount())
+	{
+		g_canvasRegion = g_hitRegions.AddRegion(canvas, CurrentMode(), timeMs_I);
+		g_toolbarRegion = g_hitRegions.AddRegion(toolbar, WMTProcessingModeObserver, timeMs_I);
+	}
+	else
+	{
+		g_hitRegions.SetRegion(g_canvasRegion, canvas, CurrentMode(), timeMs_I);
+		g_hitRegions.SetRegion(g_toolbarRegion, toolbar, WMTProcessingModeObserver, timeMs_I);
+	}
+}
 
-			case EDataType::ERawData:
-			{
-				res = WacomMTRegisterRawReadCallback(deviceID, CurrentMode(), RawCallback, NULL);
-				break;
-			}
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Passes changes of the hit regions on to the MTAPI when they are due,
+//		keeping a timer running while some are not.
+//
+void UpdateHitRegions(HWND hWnd_I, bool forced_I)
+{
+	g_hitRegions.Update(g_hitRegionDriver, TimeMs(), forced_I);
 
-			default:
-			{
-				break;
-			}
-		}
+	if (g_hitRegions.Pending() && !g_hitRegionTimer)
+	{
+		g_hitRegionTimer = SetTimer(hWnd_I, HIT_REGION_TIMER, HIT_REGION_TIMER_MS, NULL) != 0;
+	}
+	else if (!g_hitRegions.Pending() && g_hitRegionTimer)
+	{
+		KillTimer(hWnd_I, HIT_REGION_TIMER);
+		g_hitRegionTimer = false;
+	}
+}
 
-		g_lastWTHitRect[deviceID] = std::move(wtHitRect);
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Recomputes the transform of every device for where the client area
+//		is now.  Call under the graphics lock.
+//
+void UpdateTouchTransforms(void)
+{
+	for (const WacomMTCapability &caps : g_deviceRegistry.Devices())
+	{
+		g_touchTransforms[caps.DeviceID].Configure(caps,
+			static_cast<float>(g_clientRect.left), static_cast<float>(g_clientRect.top),
+			static_cast<float>(g_clientRect.right - g_clientRect.left), static_cast<float>(g_clientRect.bottom - g_clientRect.top));
 	}
-	return res;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -933,9 +1216,14 @@ WacomMTError UnregisterForData(int deviceID, HWND hWnd_I)
 			{
 				res = WacomMTUnRegisterFingerReadHWND(hWnd_I);
 			}
+			else if (g_hitRegions.Attached(deviceID))
+			{
+				g_hitRegions.Detach(g_hitRegionDriver, deviceID);
+				res = WMTErrorSuccess;
+			}
 			else
 			{
-				res = WacomMTUnRegisterFingerReadCallback(deviceID, g_lastWTHitRect[deviceID].get(), CurrentMode(), NULL);
+				res = WacomMTUnRegisterFingerReadCallback(deviceID, NULL, CurrentMode(), NULL);
 			}
 			break;
 		}
@@ -946,9 +1234,14 @@ WacomMTError UnregisterForData(int deviceID, HWND hWnd_I)
 			{
 				res = WacomMTUnRegisterBlobReadHWND(g_mainWnd);
 			}
+			else if (g_hitRegions.Attached(deviceID))
+			{
+				g_hitRegions.Detach(g_hitRegionDriver, deviceID);
+				res = WMTErrorSuccess;
+			}
 			else
 			{
-				res = WacomMTUnRegisterBlobReadCallback(deviceID, g_lastWTHitRect[deviceID].get(), CurrentMode(), NULL);
+				res = WacomMTUnRegisterBlobReadCallback(deviceID, NULL, CurrentMode(), NULL);
 			}
 			break;
 		}
@@ -965,8 +1258,6 @@ WacomMTError UnregisterForData(int deviceID, HWND hWnd_I)
 		}
 	}
 
-	g_lastWTHitRect[deviceID].reset();
-
 	return res;
 }
 
@@ -976,9 +1267,9 @@ WacomMTError UnregisterForData(int deviceID, HWND hWnd_I)
 //
 int FingerCallback(WacomMTFingerCollection *fingerData, void *userData)
 {
-	if (fingerData)
+	if (g_touchFrames.PushFingers(fingerData, TimeMs(), MTHitRegionDriver::RegionID(userData)))
 	{
-		DrawFingerData(fingerData->FingerCount, fingerData->Fingers, fingerData->DeviceID);
+		SetEvent(g_touchFrameEvent);
 	}
 	return 0;
 }
@@ -989,9 +1280,9 @@ int FingerCallback(WacomMTFingerCollection *fingerData, void *userData)
 //
 int BlobCallback(WacomMTBlobAggregate *blobData, void *userData)
 {
-	if (blobData)
+	if (g_touchFrames.PushBlobs(blobData, MTHitRegionDriver::RegionID(userData)))
 	{
-		DrawBlobData(blobData->BlobCount, blobData->BlobArray, blobData->DeviceID);
+		SetEvent(g_touchFrameEvent);
 	}
 	return 0;
 }
@@ -1003,43 +1294,153 @@ int BlobCallback(WacomMTBlobAggregate *blobData, void *userData)
 int RawCallback(WacomMTRawData *rawData, void *userData)
 {
 	// rawData->ElementCount should equal caps.ScanX times caps.ScanY
-	if (rawData)
+	if (g_touchFrames.PushRaw(rawData))
 	{
-		DrawRawData(rawData->ElementCount, rawData->Sensitivity, rawData->DeviceID);
+		SetEvent(g_touchFrameEvent);
 	}
 	return 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // Purpose
-//		Callback triggered on device attach.
+//		Render thread: draws the newest frame of each device whenever a
+//		callback has queued one.  Frames that arrive faster than they can be
+//		drawn replace each other in the queue instead of delaying the driver.
+//		Finger frames go on from the queue to the input timeline, stamped
+//		with the time the callback got them, and are drawn with the pen
+//		events as the timeline releases them; it wakes the thread when they
+//		are due as well, and when a frame joined from hit region parts
+//		settles.
 //
-void AttachCallback(WacomMTCapability deviceInfo, void *userRef)
+DWORD WINAPI TouchRenderThread(LPVOID param_I)
+{
+	UNREFERENCED_PARAMETER(param_I);
+
+	for (;;)
+	{
+		const double nowMs = TimeMs();
+		double dueMs = g_inputTimeline.NextReleaseMs(nowMs);
+		const double settleMs = g_touchFrames.NextSettleMs(nowMs);
+		if (settleMs >= 0.0 && (dueMs < 0.0 || settleMs < dueMs))
+		{
+			dueMs = settleMs;
+		}
+		const DWORD wait = WaitForSingleObject(g_touchFrameEvent,
+			dueMs < 0.0 ? INFINITE : static_cast<DWORD>(ceil(dueMs)));
+		if ((wait != WAIT_OBJECT_0 && wait != WAIT_TIMEOUT) || g_stopTouchRender)
+		{
+			break;
+		}
+
+		g_touchFrames.ConsumeLatest(TimeMs(), TakeTouchFrame);
+		g_inputTimeline.Release(TimeMs(), ProcessTimelineEvent);
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Starts the render thread.  The queue must be allocated first.
+//
+void StartTouchRenderer(void)
 {
-	if (!g_caps.count(deviceInfo.DeviceID))
+	if (!g_touchRenderThread)
 	{
-		g_devices.push_back(deviceInfo.DeviceID);
-		g_caps[deviceInfo.DeviceID] = deviceInfo;
+		g_stopTouchRender = false;
+		g_touchRenderThread = CreateThread(NULL, 0, TouchRenderThread, NULL, 0, NULL);
+	}
+}
 
-		RegisterForData(deviceInfo.DeviceID, g_mainWnd); // Ignore result
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Stops the render thread.  Callbacks may still queue frames afterwards;
+//		they are no longer drawn.
+//
+void StopTouchRenderer(void)
+{
+	if (g_touchRenderThread)
+	{
+		g_stopTouchRender = true;
+		SetEvent(g_touchFrameEvent);
+		WaitForSingleObject(g_touchRenderThread, INFINITE);
+		CloseHandle(g_touchRenderThread);
+		g_touchRenderThread = NULL;
+
+		TouchFrameStats stats = g_touchFrames.Stats();
+		DebugTrace("Touch frames: %llu published, %llu rendered, %llu superseded, %llu dropped, %llu truncated\n",
+			stats.published, stats.rendered, stats.superseded, stats.dropped, stats.truncated);
+
+		InputTimelineStats timeline = g_inputTimeline.Stats();
+		DebugTrace("Input timeline: %llu pushed, %llu released, %llu held to the limit, %llu late, %llu reordered, %llu dropped, %.1f ms avg delay\n",
+			timeline.pushed, timeline.released, timeline.held, timeline.late, timeline.reordered, timeline.dropped,
+			timeline.released ? timeline.delaySumMs / timeline.released : 0.0);
 	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // Purpose
-//		Callback triggered on device detach.
+//		Callback triggered on device attach, on a thread of the driver.  The
+//		window thread takes it from there.
+//
+void AttachCallback(WacomMTCapability deviceInfo, void *userRef)
+{
+	WacomMTCapability *caps = new WacomMTCapability(deviceInfo);
+	if (!PostMessage(static_cast<HWND>(userRef), WM_MTDEVICEATTACHED, 0, reinterpret_cast<LPARAM>(caps)))
+	{
+		delete caps;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Callback triggered on device detach, on a thread of the driver.
 //
 void DetachCallback(int deviceID, void *userRef)
 {
-	if (g_caps.count(deviceID))
+	PostMessage(static_cast<HWND>(userRef), WM_MTDEVICEDETACHED, static_cast<WPARAM>(deviceID), 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Publishes an attached device, then registers for its data.  Never
+//		call under the graphics lock: publishing waits for the readers.
+//
+void OnDeviceAttached(HWND hWnd_I, const WacomMTCapability &caps_I)
+{
+	if (g_deviceRegistry.Add(caps_I))
 	{
-		UnregisterForData(deviceID, g_mainWnd);
-		std::vector<int>::const_iterator iter = std::find(g_devices.begin(), g_devices.end(), deviceID);
-		if (iter != g_devices.end())
-		{
-			g_devices.erase(iter);
-		}
-		g_caps.erase(deviceID);
+		g_inputTimeline.AddDevice(caps_I.DeviceID);
+
+		EnterCriticalSection(&g_graphicsCriticalSection);
+		UpdateTouchTransforms();
+		LeaveCriticalSection(&g_graphicsCriticalSection);
+
+		RegisterForData(caps_I.DeviceID, hWnd_I); // Ignore result
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Unregisters a detached device and withdraws it.  Once Remove returns
+//		no frame of the device is being drawn, and frames still queued are
+//		skipped, so its state can go.
+//
+void OnDeviceDetached(HWND hWnd_I, int deviceID_I)
+{
+	WacomMTCapability caps = { 0 };
+	if (g_deviceRegistry.Find(deviceID_I, caps))
+	{
+		UnregisterForData(deviceID_I, hWnd_I);
+		g_deviceRegistry.Remove(deviceID_I);
+		g_inputTimeline.RemoveDevice(deviceID_I);
+		g_touchFrames.Release(deviceID_I);
+
+		EnterCriticalSection(&g_graphicsCriticalSection);
+		g_touchTransforms.erase(deviceID_I);
+		g_fingerTracks.erase(deviceID_I);
+		g_gestures.erase(deviceID_I);
+		g_palmRejectors.erase(deviceID_I);
+		LeaveCriticalSection(&g_graphicsCriticalSection);
 	}
 }
 
@@ -1065,16 +1466,75 @@ void Rotate(double degrees, const POINT& centerPnt, std::vector<POINT>& points)
 
 ///////////////////////////////////////////////////////////////////////////////
 // Purpose
-//		Draws Finger data from the MTAPI.
+//		Draws Finger data from the MTAPI, joining each contact to where the
+//		finger was in the previous frame.  regions, if not null, holds the
+//		hit region that delivered each finger.  timeMs_I is the frame's time
+//		on the input timeline.  Frames that are not drawn still go to the
+//		trackers, gestures and palm rejection.
 //
-void DrawFingerData(int count, WacomMTFinger *fingers, int device)
+void DrawFingerData(int count, const WacomMTFinger *fingers, const int *regions, int device, int frameNumber, double timeMs_I, bool draw_I)
 {
-	if (g_devices.size() && count && fingers)
+	// Frames queued before their device detached find it gone.
+	DeviceRegistry::Reader devices(g_deviceRegistry);
+	const WacomMTCapability *found = devices->Find(device);
+
+	if (found && count && fingers)
 	{
 		EnterCriticalSection(&g_graphicsCriticalSection);
 
-		float horizontalPixelPitch = g_caps[device].PhysicalSizeX / g_caps[device].LogicalWidth;
-		float verticalPixelPitch = g_caps[device].PhysicalSizeY / g_caps[device].LogicalHeight;
+		const WacomMTCapability &caps = *found;
+
+		FingerTrackStore &tracks = g_fingerTracks[device];
+		if (tracks.Capacity() < caps.FingerMax)
+		{
+			tracks.Allocate(caps.FingerMax);
+		}
+		tracks.Update(frameNumber, count, fingers);
+
+		GestureRecognizer &gestures = g_gestures[device];
+		if (gestures.FingerMax() < caps.FingerMax)
+		{
+			gestures.Configure(caps);
+		}
+
+		gestures.Update(frameNumber, count, fingers, timeMs_I);
+
+		PalmRejector &palms = g_palmRejectors[device];
+		if (palms.FingerMax() < caps.FingerMax)
+		{
+			palms.Configure(caps);
+		}
+		palms.Update(count, fingers, timeMs_I);
+
+		// Display the newest gesture under the finger stats.
+		for (const GestureEvent &event : gestures.Events())
+		{
+			static const wchar_t *gestureNames[] = {L"Pan", L"Pinch", L"Rotate", L"Tap"};
+			wchar_t gestureStr[128] = L"";
+			_stprintf_s(gestureStr, L"Gesture:%s Fingers:%d Pan:%.0f,%.0f mm  Scale:%.2f  Angle:%.0f      ",
+				gestureNames[static_cast<int>(event.type)], event.fingerCount, event.panX, event.panY,
+				event.scale, event.rotation * 180.0f / 3.14159265f);
+			TextOut(g_hdc, 50, 40, gestureStr, _tcslen(gestureStr));
+		}
+
+		if (!draw_I)
+		{
+			LeaveCriticalSection(&g_graphicsCriticalSection);
+			return;
+		}
+
+		// Positions and sizes of the whole frame, in client pixels and
+		// millimeters.
+		if (!g_touchTransforms.count(device))
+		{
+			UpdateTouchTransforms();
+		}
+		const TouchTransform &transform = g_touchTransforms[device];
+		if (static_cast<int>(g_touchPoints.size()) < count)
+		{
+			g_touchPoints.resize(count);
+		}
+		transform.Convert(count, fingers, g_touchPoints.data());
 
 		for (int index = 0; index < count; index++)
 		{
@@ -1087,68 +1547,30 @@ void DrawFingerData(int count, WacomMTFinger *fingers, int device)
 
 			if (fingers[index].TouchState != WMTFingerStateNone)
 			{
-				// Skip this finger if using confidence bits and it's NOT confident.
-				if (g_useConfidenceBits && !fingers[index].Confidence)
+				// Skip this finger if using confidence bits and it's NOT confident,
+				// or is otherwise taken for a palm.
+				if (g_useConfidenceBits && !palms.Accepted(index))
 				{
 					continue;
 				}
 
-				HPEN pen = g_fingerHPenMap[fingers[index].FingerID];
-				HPEN oldPen = (HPEN)SelectObject(g_hdc, pen);
-
-				// Display tablets report position in pixels.
-				double x = fingers[index].X;
-				double y = fingers[index].Y;
-				if (g_caps[device].Type == WMTDeviceTypeOpaque)
+				// Fingers on the toolbar strip are not drawn.
+				if (regions && regions[index] == g_toolbarRegion)
 				{
-					// If we're using an opaque tablet, then the X and Y values are not in
-					// pixels; they are a percentage of the tablet width (eg: 0.123, 0.37, etc.).
-					// We need to convert to client pixels.
-					x *= static_cast<double>(g_clientRect.right) - g_clientRect.left;
-					x += g_clientRect.left;
-					y *= static_cast<double>(g_clientRect.bottom) - g_clientRect.top;
-					y += g_clientRect.top ;
+					continue;
 				}
 
-				//map to our window
-				POINT pt = {static_cast<LONG>(x), static_cast<LONG>(y)};
-				::ScreenToClient(g_mainWnd, &pt);
-
-				// If width and height are not supported; we will fake it.
-				double widthMM = 0.;
-				double widthMaxMM = 0.;
-
-				if (fingers[index].Width > 0)
-				{
-					// Make larger for visibility, if necessary.
-					if (fingers[index].Width <= 1.0)
-					{
-						// Convert logical value to millimeters by multiplying by physical width.
-						widthMM = static_cast<double>(fingers[index].Width) * g_caps[device].PhysicalSizeX;
-					}
-					else //must be Cintiq so width already in pixels
-					{
-						widthMM = static_cast<double>(fingers[index].Width) * horizontalPixelPitch;
-					}
-				}
+				HPEN pen = g_fingerHPenMap[fingers[index].FingerID];
+				HPEN oldPen = (HPEN)SelectObject(g_hdc, pen);
 
-				int contactWidthOffset = static_cast<int>(widthMM / horizontalPixelPitch / 2);
+				const TouchPoint &point = g_touchPoints[index];
+				POINT pt = {static_cast<LONG>(point.clientX), static_cast<LONG>(point.clientY)};
 
-				double heightMM = 0.;
-				if (fingers[index].Height > 0)
-				{
-					// Make larger for visibility, if necessary.
-					if (fingers[index].Height <= 1.0)
-					{
-						// Convert logical value to millimeters by multiplying by physical height.
-						heightMM = static_cast<double>(fingers[index].Height) * g_caps[device].PhysicalSizeY;
-					}
-					else //must be Cintiq so height already in pixels
-					{
-						heightMM = static_cast<double>(fingers[index].Height) * verticalPixelPitch; //pixel pitch of Cintiq 24 HD
-					}
-				}
-				int contactHeightOffset = static_cast<int>(heightMM / verticalPixelPitch / 2);
+				// Sizes not reported are zero.
+				double widthMM = point.widthMM;
+				double heightMM = point.heightMM;
+				int contactWidthOffset = static_cast<int>(point.radiusX);
+				int contactHeightOffset = static_cast<int>(point.radiusY);
 
 				DebugTrace("width, height (mm): %3.3f,%3.3f\n", widthMM, heightMM);
 
@@ -1163,6 +1585,14 @@ void DrawFingerData(int count, WacomMTFinger *fingers, int device)
 
 				CenterEllipse(g_hdc, pt.x, pt.y, contactWidthOffset, contactHeightOffset);
 
+				const FingerTrack *track = tracks.Find(fingers[index].FingerID);
+				if (track && track->Count() > 1)
+				{
+					const FingerTrackSample &previous = track->Sample(1);
+					MoveToEx(g_hdc, static_cast<int>(transform.ClientX(previous.x)), static_cast<int>(transform.ClientY(previous.y)), NULL);
+					LineTo(g_hdc, pt.x, pt.y);
+				}
+
 				wchar_t displayText[8] = L"";
 				if (g_ShowTouchSize)
 				{
@@ -1212,63 +1642,94 @@ void ClearScreen()
 
 ///////////////////////////////////////////////////////////////////////////////
 // Purpose
-//		Determines the applications hit rect.
+//		Draw Raw data from the MTAPI: the denoised frame as a heatmap, and
+//		over it the contour of each blob found in the frame and a circle at
+//		its center sized by its peak.  The blob threshold follows the noise
+//		of the device.
 //
-WacomMTHitRectPtr GetAppHitRect()
+void DrawRawData(int count, const unsigned short* rawBuf, int device)
 {
-	if (g_UseWinHitRect)
+	DeviceRegistry::Reader devices(g_deviceRegistry);
+	const WacomMTCapability *caps = devices->Find(device);
+	if (!caps)
 	{
-		WINDOWINFO appWindowInfo = {0};
-		appWindowInfo.cbSize = sizeof(appWindowInfo);
-		GetWindowInfo(g_mainWnd, &appWindowInfo);
+		return;
+	}
 
-		WacomMTHitRect hitRect = {
-			static_cast<float>(appWindowInfo.rcClient.left),
-			static_cast<float>(appWindowInfo.rcClient.top),
-			static_cast<float>(appWindowInfo.rcClient.right - appWindowInfo.rcClient.left),
-			static_cast<float>(appWindowInfo.rcClient.bottom - appWindowInfo.rcClient.top)
+	SIZE rawSize = {caps->ScanSizeX, caps->ScanSizeY};
+	if (count && rawBuf && count >= rawSize.cx * rawSize.cy)
+	{
+		std::unique_ptr<RawBlobExtractor> &extractor = g_rawBlobs[device];
+		if (!extractor || extractor->ScanSizeX() != rawSize.cx || extractor->ScanSizeY() != rawSize.cy)
+		{
+			extractor.reset(new RawBlobExtractor());
+			extractor->Allocate(rawSize.cx, rawSize.cy, static_cast<int>(std::thread::hardware_concurrency()));
+		}
+
+		RawFrameFilter &filter = g_rawFilters[device];
+		if (filter.CellCount() != rawSize.cx * rawSize.cy)
+		{
+			filter.Allocate(rawSize.cx * rawSize.cy);
+		}
+		const unsigned short *denoised = filter.Process(rawBuf);
+		extractor->Extract(denoised, filter.Threshold());
+
+		// Cell coordinates to the window.
+		const float scaleX = caps->LogicalWidth / rawSize.cx;
+		const float scaleY = caps->LogicalHeight / rawSize.cy;
+		auto toClient = [&](float x_I, float y_I)
+		{
+			POINT pt = {static_cast<LONG>(x_I * scaleX + caps->LogicalOriginX),
+				static_cast<LONG>(y_I * scaleY + caps->LogicalOriginY)};
+			::ScreenToClient(g_mainWnd, &pt);
+			return pt;
 		};
 
-		return WacomMTHitRectPtr(new WacomMTHitRect(hitRect));
-	}
-	return WacomMTHitRectPtr();
-}
+		// The denoised frame as a heatmap over the whole client area, drawn
+		// with a single blit.
+		const int clientWidth = g_clientRect.right - g_clientRect.left;
+		const int clientHeight = g_clientRect.bottom - g_clientRect.top;
+		RawHeatmap &heatmap = g_rawHeatmaps[device];
+		if (heatmap.ScanSizeX() != rawSize.cx || heatmap.ScanSizeY() != rawSize.cy ||
+			heatmap.ImageWidth() != clientWidth || heatmap.ImageHeight() != clientHeight)
+		{
+			heatmap.Allocate(rawSize.cx, rawSize.cy, clientWidth, clientHeight);
+		}
 
-///////////////////////////////////////////////////////////////////////////////
-// Purpose
-//		Draw Raw data from the MTAPI.
-//
-void DrawRawData(int count, unsigned short* rawBuf, int device)
-{
-	SIZE rawSize = {g_caps[device].ScanSizeX, g_caps[device].ScanSizeY};
-	if (count && rawBuf)
-	{
-		ClearScreen();
+		if (clientWidth > 0 && clientHeight > 0)
+		{
+			const POINT origin = toClient(0.0f, 0.0f);
+			const POINT corner = toClient(static_cast<float>(rawSize.cx), static_cast<float>(rawSize.cy));
+			const uint32_t *image = heatmap.Render(denoised, origin.x, origin.y, corner.x - origin.x, corner.y - origin.y);
+
+			BITMAPINFO bitmapInfo = {0};
+			bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+			bitmapInfo.bmiHeader.biWidth = clientWidth;
+			bitmapInfo.bmiHeader.biHeight = -clientHeight;	// top-down
+			bitmapInfo.bmiHeader.biPlanes = 1;
+			bitmapInfo.bmiHeader.biBitCount = 32;
+			bitmapInfo.bmiHeader.biCompression = BI_RGB;
+			SetDIBitsToDevice(g_hdc, 0, 0, clientWidth, clientHeight, 0, 0, 0, clientHeight, image, &bitmapInfo, DIB_RGB_COLORS);
+		}
 
 		HPEN pen = CreatePen(PS_SOLID, 2, RGB(255,0,0));
 		HPEN oldPen = static_cast<HPEN>(SelectObject(g_hdc, pen));
 
-		for (int sy = 0; sy < rawSize.cy; sy++)
+		for (const RawBlob &blob : extractor->Blobs())
 		{
-			for (int sx = 0; sx < rawSize.cx; sx++)
+			const RawBlobPoint *contour = extractor->Contour() + blob.firstPoint;
+			POINT pt = toClient(contour[0].x, contour[0].y);
+			MoveToEx(g_hdc, pt.x, pt.y, NULL);
+			for (int pointIndex = 1; pointIndex <= blob.pointCount; pointIndex++)
 			{
-				unsigned short value = rawBuf[sy * rawSize.cx + sx];
-				if (value > 4)
-				{
-					int X = sx * static_cast<int>(g_caps[device].LogicalWidth)  / rawSize.cx + static_cast<int>(g_caps[device].LogicalOriginX);
-					int Y = sy * static_cast<int>(g_caps[device].LogicalHeight) / rawSize.cy + static_cast<int>(g_caps[device].LogicalOriginY);
-					int offset = std::max(value * 6 / 255 + 5, 7);
-
-					if ((X > g_clientRect.left) && (X < g_clientRect.right) &&
-						 (Y > g_clientRect.top) &&  (Y < g_clientRect.bottom))
-					{
-						POINT pt = {X, Y};
-						::ScreenToClient(g_mainWnd, &pt);
-
-						Circle(g_hdc, pt.x, pt.y, offset);
-					}
-				}
+				const RawBlobPoint &point = contour[pointIndex == blob.pointCount ? 0 : pointIndex];
+				pt = toClient(point.x, point.y);
+				LineTo(g_hdc, pt.x, pt.y);
 			}
+
+			int offset = std::max(blob.peak * 6 / 255 + 5, 7);
+			pt = toClient(blob.centroidX, blob.centroidY);
+			Circle(g_hdc, pt.x, pt.y, offset);
 		}
 
 		SelectObject(g_hdc, oldPen);
@@ -1278,49 +1739,27 @@ void DrawRawData(int count, unsigned short* rawBuf, int device)
 
 ///////////////////////////////////////////////////////////////////////////////
 // Purpose
-//		Calculates the center point given a set of points.
+//		Draw a single blob of a snapshot.
 //
-POINT FindCenterPoint(int count, WacomMTBlobPoint *points)
+void DrawBlob(const BlobSnapshot &snapshot_I, const BlobSnapshotBlob &blob_I)
 {
-	UINT32 msig = 0;
-	UINT32 wmx = 0;
-	UINT32 wmy = 0;
-
-	for (int i = 0; i < count; i++)
+	const int count = blob_I.pointCount;
+	if (count)
 	{
-		msig += points[i].Sensitivity;
-		wmx += static_cast<UINT32>(points[i].X * points[i].Sensitivity);
-		wmy += static_cast<UINT32>(points[i].Y * points[i].Sensitivity);
-	}
-
-	POINT center = {0,0};
-	if (msig)
-	{
-		center.x = wmx / msig;
-		center.y = wmy / msig;
-	}
-	return center;
-}
+		const float *pointX = snapshot_I.PointX() + blob_I.firstPoint;
+		const float *pointY = snapshot_I.PointY() + blob_I.firstPoint;
+		const unsigned short *sensitivity = snapshot_I.PointSensitivity() + blob_I.firstPoint;
 
-///////////////////////////////////////////////////////////////////////////////
-// Purpose
-//		Draw a single blob from the MTAPI.
-//
-void DrawBlob(int count, WacomMTBlobPoint *points)
-{
-	if (count && points)
-	{
-		WacomMTBlobPoint apiPoint = points[0];
-		POINT curPt = {static_cast<LONG>(apiPoint.X), static_cast<LONG>(apiPoint.Y)};
+		POINT curPt = {static_cast<LONG>(pointX[0]), static_cast<LONG>(pointY[0])};
 		::ScreenToClient(g_mainWnd, &curPt);
 
 		for (int pointIndex = 1; pointIndex <= count; pointIndex++)
 		{
-			bool bDrawLine = apiPoint.Sensitivity > 0;
-			apiPoint = points[pointIndex == count ? 0 : pointIndex];
+			bool bDrawLine = sensitivity[pointIndex - 1] > 0;
+			const int next = pointIndex == count ? 0 : pointIndex;
 			POINT prevPt = curPt;
-			curPt.x = static_cast<LONG>(apiPoint.X);
-			curPt.y = static_cast<LONG>(apiPoint.Y);
+			curPt.x = static_cast<LONG>(pointX[next]);
+			curPt.y = static_cast<LONG>(pointY[next]);
 			::ScreenToClient(g_mainWnd, &curPt);
 
 			if (bDrawLine)
@@ -1336,30 +1775,24 @@ void DrawBlob(int count, WacomMTBlobPoint *points)
 // Purpose
 //		Draw blob data from the MTAPI.
 //
-void DrawBlobData(int count, WacomMTBlob *blobs, int device)
+void DrawBlobData(const BlobSnapshot &snapshot_I)
 {
-	if (count && blobs)
-	{
-		blobs->BlobID;
-		blobs->BlobType;
-		blobs->ParentID;
+	// Blobs are drawn on the render thread and, for HWND data, the window
+	// thread; each keeps its own moments.
+	thread_local std::vector<BlobMoments> moments;
 
+	const int count = snapshot_I.BlobCount();
+	const BlobSnapshotBlob *blobs = snapshot_I.Blobs();
+
+	if (count)
+	{
 		ClearScreen();
+		ComputeBlobMoments(snapshot_I, moments);
 
 		{
-			POINT pt = { static_cast<LONG>(blobs->X), static_cast<LONG>(blobs->Y)};
-
-			if ((pt.x > g_clientRect.left) && (pt.x < g_clientRect.right) &&
-				 (pt.y > g_clientRect.top) &&  (pt.y < g_clientRect.bottom))
-			{
-				//map to our window
-				::ScreenToClient(g_mainWnd, &pt);
-				Circle(g_hdc, pt.x, pt.y, 2);
-			}
-
 			for (int blobIndex = 0; blobIndex < count; blobIndex++)
 			{
-				bool confident = blobs[blobIndex].Confidence;
+				bool confident = blobs[blobIndex].confidence;
 
 				if ( g_useConfidenceBits && !confident )
 				{
@@ -1369,7 +1802,12 @@ void DrawBlobData(int count, WacomMTBlob *blobs, int device)
 				HPEN oldPen = static_cast<HPEN>(SelectObject(g_hdc, 
 					confident ? g_confidencePen : g_noConfidencePen));
 
-				DrawBlob(blobs[blobIndex].PointCount, blobs[blobIndex].BlobPoints);
+				DrawBlob(snapshot_I, blobs[blobIndex]);
+
+				// Mark the sensitivity weighted center of the blob.
+				POINT pt = { static_cast<LONG>(moments[blobIndex].centroidX), static_cast<LONG>(moments[blobIndex].centroidY)};
+				::ScreenToClient(g_mainWnd, &pt);
+				Circle(g_hdc, pt.x, pt.y, 2);
 
 				SelectObject(g_hdc, oldPen);
 			}
@@ -1377,6 +1815,97 @@ void DrawBlobData(int count, WacomMTBlob *blobs, int device)
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Draw a frame queued by one of the MTAPI callbacks.
+//
+void DrawTouchFrame(const TouchFrame &frame_I)
+{
+	EnterCriticalSection(&g_graphicsCriticalSection);
+
+	switch (frame_I.type)
+	{
+		case ETouchFrameType::EFingerFrame:
+		{
+			DrawFingerData(frame_I.count, frame_I.fingers.data(), frame_I.joined ? frame_I.regions.data() : nullptr,
+				frame_I.deviceID, frame_I.frameNumber, TimeMs(), true);
+			break;
+		}
+
+		case ETouchFrameType::EBlobFrame:
+		{
+			DrawBlobData(frame_I.blobs);
+			break;
+		}
+
+		case ETouchFrameType::ERawFrame:
+		{
+			DrawRawData(frame_I.count, frame_I.raw.data(), frame_I.deviceID);
+			break;
+		}
+	}
+
+	LeaveCriticalSection(&g_graphicsCriticalSection);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Passes a finger frame taken from the queue on to the input timeline,
+//		and draws the others.
+//
+void TakeTouchFrame(const TouchFrame &frame_I)
+{
+	if (frame_I.type != ETouchFrameType::EFingerFrame)
+	{
+		DrawTouchFrame(frame_I);
+		return;
+	}
+
+	WacomMTFingerCollection fingers = { 0 };
+	fingers.DeviceID = frame_I.deviceID;
+	fingers.FrameNumber = frame_I.frameNumber;
+	fingers.FingerCount = frame_I.count;
+	fingers.Fingers = const_cast<WacomMTFinger *>(frame_I.fingers.data());
+	g_inputTimeline.PushFingers(&fingers, frame_I.arrivalMs, frame_I.joined ? frame_I.regions.data() : nullptr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Hands an event of the input timeline, in order and on the common
+//		clock, to palm rejection and gestures.  Only the newest frame of
+//		each device in a release is drawn.
+//
+void ProcessTimelineEvent(const TimelineEvent &event_I)
+{
+	switch (event_I.type)
+	{
+		case ETimelineEvent::EPenPacket:
+		{
+			POINT point = { static_cast<LONG>(event_I.x), static_cast<LONG>(event_I.y) };
+			UpdatePenForPalms(point, event_I.timeMs);
+			break;
+		}
+
+		case ETimelineEvent::EPenProximity:
+		{
+			EnterCriticalSection(&g_graphicsCriticalSection);
+			for (auto &palms : g_palmRejectors)
+			{
+				palms.second.PenProximity(event_I.entering, event_I.timeMs);
+			}
+			LeaveCriticalSection(&g_graphicsCriticalSection);
+			break;
+		}
+
+		case ETimelineEvent::ETouchFrame:
+		{
+			DrawFingerData(event_I.count, event_I.fingers, event_I.regions, event_I.deviceID, event_I.frameNumber,
+				event_I.timeMs, event_I.newest);
+			break;
+		}
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Wintab support functions
 
@@ -1446,35 +1975,71 @@ WacomMTError InitWacomMTAPI(HWND hWnd_I)
 		return res;
 	}
 
+	std::vector<int> deviceIDs;
 	int deviceCount = WacomMTGetAttachedDeviceIDs(NULL, 0);
 	if (deviceCount)
 	{
 		int newCount = 0;
 		while (newCount != deviceCount)
 		{
-			g_devices.resize(deviceCount, 0);
-			newCount = WacomMTGetAttachedDeviceIDs(&g_devices[0], deviceCount * sizeof(int));
+			deviceIDs.resize(deviceCount, 0);
+			newCount = WacomMTGetAttachedDeviceIDs(&deviceIDs[0], deviceCount * sizeof(int));
 		}
+	}
 
+	std::vector<WacomMTCapability> devices;
+	for (int deviceID : deviceIDs)
+	{
+		WacomMTCapability caps = { 0 };
+		if (WacomMTGetDeviceCapabilities(deviceID, &caps) == WMTErrorSuccess)
+		{
+			devices.push_back(caps);
+		}
+	}
+
+	if (!devices.empty())
+	{
+		g_deviceRegistry.Reset(devices);
 		DumpCaps(false);
+
+		EnterCriticalSection(&g_graphicsCriticalSection);
+		UpdateTouchTransforms();
+		LeaveCriticalSection(&g_graphicsCriticalSection);
 	}
 
-	res = WacomMTRegisterAttachCallback(AttachCallback, NULL); 
+	// Size the queued frames for the attached devices, and start drawing
+	// them before any callback is registered.
+	TouchFrameLimits limits;
+	for (const WacomMTCapability &caps : devices)
+	{
+		limits.Include(caps);
+	}
+	g_touchFrames.Allocate(limits);
+	g_inputTimeline.Allocate(limits.fingers);
+	for (const WacomMTCapability &caps : devices)
+	{
+		g_inputTimeline.AddDevice(caps.DeviceID);
+	}
+	g_blobSnapshots.Allocate(limits.blobs, limits.blobPoints, 2);
+	StartTouchRenderer();
+
+	// The window is not in g_mainWnd yet during WM_CREATE.
+	res = WacomMTRegisterAttachCallback(AttachCallback, hWnd_I); 
 	if (res != WMTErrorSuccess)
 	{
 		return res;
 	}
 
-	res = WacomMTRegisterDetachCallback(DetachCallback, NULL); 
+	res = WacomMTRegisterDetachCallback(DetachCallback, hWnd_I); 
 	if (res != WMTErrorSuccess)
 	{
 		return res;
 	}
 
-	int loopCount = static_cast<int>(g_devices.size());
+	int loopCount = static_cast<int>(devices.size());
 	for (int idx = 0; idx < loopCount; idx++)
 	{
-		res = RegisterForData(g_devices[idx], hWnd_I); 
+		res = RegisterForData(devices[idx].DeviceID, hWnd_I); 
 		if (res != WMTErrorSuccess)
 		{
 			return res;
@@ -1537,6 +2102,41 @@ void DrawPenData(POINT point_I, UINT pressure_I, bool bMoveToPoint_I)
 	LeaveCriticalSection(&g_graphicsCriticalSection);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Gives the pen's position, hovering or not, to each device's palm
+//		rejection.  Display tablets report fingers in screen pixels, as the
+//		pen is; opaque tablets as a fraction of the sensor, which the system
+//		context maps over the whole virtual screen.
+//
+void UpdatePenForPalms(POINT point_I, double timeMs_I)
+{
+	const double virtualX = GetSystemMetrics(SM_XVIRTUALSCREEN);
+	const double virtualY = GetSystemMetrics(SM_YVIRTUALSCREEN);
+	const double virtualWidth = std::max(GetSystemMetrics(SM_CXVIRTUALSCREEN), 1);
+	const double virtualHeight = std::max(GetSystemMetrics(SM_CYVIRTUALSCREEN), 1);
+
+	DeviceRegistry::Reader devices(g_deviceRegistry);
+	EnterCriticalSection(&g_graphicsCriticalSection);
+
+	for (auto &palms : g_palmRejectors)
+	{
+		const WacomMTCapability *caps = devices->Find(palms.first);
+		double x = point_I.x;
+		double y = point_I.y;
+		if (caps && caps->Type == WMTDeviceTypeOpaque)
+		{
+			x = (x - virtualX) / virtualWidth;
+			y = (y - virtualY) / virtualHeight;
+		}
+
+		palms.second.PenPacket(palms.second.ToMillimetersX(static_cast<float>(x)),
+			palms.second.ToMillimetersY(static_cast<float>(y)), timeMs_I);
+	}
+
+	LeaveCriticalSection(&g_graphicsCriticalSection);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Purpose
 //		Release resources we used in this example.
@@ -1557,37 +2157,30 @@ void Cleanup(void)
 void DumpCaps(bool showMessageBox_I)
 {
 	std::stringstream msg;
-	WacomMTError res = WMTErrorInvalidParam;
 
-	for (int idx = 0; idx < static_cast<int>(g_devices.size()); idx++)
+	const std::vector<WacomMTCapability> devices = g_deviceRegistry.Devices();
+	for (int idx = 0; idx < static_cast<int>(devices.size()); idx++)
 	{
-		WacomMTCapability cap = { 0 };
-		res = WacomMTGetDeviceCapabilities(g_devices[idx], &cap);
-		if (res != WMTErrorSuccess)
-		{
-			break;
-		}
-
-		g_caps[g_devices[idx]] = cap;
+		const WacomMTCapability &cap = devices[idx];
 
 		msg << "MT Capabilities for idx: " << idx << std::endl;
-		msg << "\tVersion: " << g_caps[idx].Version << std::endl;
-		msg << "\tdeviceID_I: " << g_caps[idx].DeviceID << std::endl;
-		msg << "\tType: " << (int)g_caps[idx].Type << std::endl;
-		msg << "\tLogicalOriginX: " << g_caps[idx].LogicalOriginX << std::endl;
-		msg << "\tLogicalOriginY: " << g_caps[idx].LogicalOriginY << std::endl;
-		msg << "\tLogicalWidth: " << g_caps[idx].LogicalWidth << std::endl;
-		msg << "\tLogicalHeight: " << g_caps[idx].LogicalHeight << std::endl;
-		msg << "\tPhysicalSizeX: " << g_caps[idx].PhysicalSizeX << "\n";
-		msg << "\tPhysicalSizeY: " << g_caps[idx].PhysicalSizeY << "\n";
-		msg << "\tReportedSizeX: " << g_caps[idx].ReportedSizeX << "\n";
-		msg << "\tReportedSizeY: " << g_caps[idx].ReportedSizeY << "\n";
-		msg << "\tScanSizeX: " << g_caps[idx].ScanSizeX << "\n";
-		msg << "\tScanSizeY: " << g_caps[idx].ScanSizeY << "\n";
-		msg << "\tFingerMax: " << g_caps[idx].FingerMax << "\n";
-		msg << "\tBlobMax: " << g_caps[idx].BlobMax << "\n";
-		msg << "\tBlobPointsMax: " << g_caps[idx].BlobPointsMax << "\n";
-		msg << "\tCapabilityFlags: " << std::hex << static_cast<int>(g_caps[idx].CapabilityFlags) << "\n\n";
+		msg << "\tVersion: " << cap.Version << std::endl;
+		msg << "\tdeviceID_I: " << cap.DeviceID << std::endl;
+		msg << "\tType: " << (int)cap.Type << std::endl;
+		msg << "\tLogicalOriginX: " << cap.LogicalOriginX << std::endl;
+		msg << "\tLogicalOriginY: " << cap.LogicalOriginY << std::endl;
+		msg << "\tLogicalWidth: " << cap.LogicalWidth << std::endl;
+		msg << "\tLogicalHeight: " << cap.LogicalHeight << std::endl;
+		msg << "\tPhysicalSizeX: " << cap.PhysicalSizeX << "\n";
+		msg << "\tPhysicalSizeY: " << cap.PhysicalSizeY << "\n";
+		msg << "\tReportedSizeX: " << cap.ReportedSizeX << "\n";
+		msg << "\tReportedSizeY: " << cap.ReportedSizeY << "\n";
+		msg << "\tScanSizeX: " << cap.ScanSizeX << "\n";
+		msg << "\tScanSizeY: " << cap.ScanSizeY << "\n";
+		msg << "\tFingerMax: " << cap.FingerMax << "\n";
+		msg << "\tBlobMax: " << cap.BlobMax << "\n";
+		msg << "\tBlobPointsMax: " << cap.BlobPointsMax << "\n";
+		msg << "\tCapabilityFlags: " << std::hex << static_cast<int>(cap.CapabilityFlags) << std::dec << "\n\n";
 	}
 
 	DebugTrace("%s\n", msg.str().c_str());
@@ -1599,17 +2192,3 @@ void DumpCaps(bool showMessageBox_I)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// Purpose
-//		Returns true if client hit rect changed from last time.
-//
-bool ClientHitRectChanged(const WacomMTHitRectPtr& wtHitRect_I, int deviceID)
-{
-	if (!wtHitRect_I && !g_lastWTHitRect[deviceID]) return false;
-	if (!wtHitRect_I || !g_lastWTHitRect[deviceID]) return true;
-	return ( (wtHitRect_I->originX != g_lastWTHitRect[deviceID]->originX)
-			|| (wtHitRect_I->originY != g_lastWTHitRect[deviceID]->originY)
-			|| (wtHitRect_I->width   != g_lastWTHitRect[deviceID]->width  )
-			|| (wtHitRect_I->height  != g_lastWTHitRect[deviceID]->height ));
-}
-
-///////////////////////////////////////////////////////////////////////////////
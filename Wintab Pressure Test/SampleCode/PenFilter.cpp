@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Jitter filter for pen packets.
+//
+//	COPYRIGHT
+//		Copyright (c) 2024 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+
+#include "PenFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	// Smoothing factor of a one pole low pass at cutoff_I Hz.
+	double LowPassAlpha(double cutoff_I, double dtSeconds_I)
+	{
+		const double tau = 1.0 / (2.0 * 3.14159265358979 * cutoff_I);
+		return 1.0 / (1.0 + tau / dtSeconds_I);
+	}
+
+	UINT Median3(UINT a_I, UINT b_I, UINT c_I)
+	{
+		return (std::max)((std::min)(a_I, b_I), (std::min)((std::max)(a_I, b_I), c_I));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PenFilterParams::PenFilterParams() :
+	enabled(true),
+	minCutoff(PEN_FILTER_MIN_CUTOFF),
+	beta(PEN_FILTER_BETA),
+	speedCutoff(PEN_FILTER_SPEED_CUTOFF),
+	pressureOn(PEN_FILTER_PRESSURE_ON),
+	pressureOff(PEN_FILTER_PRESSURE_OFF),
+	medianBand(PEN_FILTER_MEDIAN_BAND)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PenFilter::PenFilter() :
+	mMaxPressure(1023),
+	mPixelScale(1.0)
+{
+	Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void PenFilter::Reset(void)
+{
+	mHasPosition = false;
+	mX = 0.0;
+	mY = 0.0;
+	mSpeed = 0.0;
+	mTime = 0;
+	mPressureCount = 0;
+	mContact = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		One Euro filter on x/y.  The speed is estimated from the filtered
+//		position, low passed at speedCutoff, and sets the position cutoff to
+//		minCutoff + beta * speed.  Both axes share the cutoff so the filter
+//		does not bend the direction of travel.
+//
+void PenFilter::Filter(PenFilterSample &sample_IO)
+{
+	if (!mParams.enabled)
+	{
+		return;
+	}
+
+	const DWORD elapsed = sample_IO.time - mTime;
+	if (!mHasPosition || elapsed > PEN_FILTER_RESET_MS)
+	{
+		Reset();
+		mHasPosition = true;
+		mX = sample_IO.x;
+		mY = sample_IO.y;
+		mTime = sample_IO.time;
+		sample_IO.pressure = FilterPressure(sample_IO.pressure);
+		return;
+	}
+
+	const double dt = (elapsed ? elapsed : PEN_FILTER_DEFAULT_INTERVAL_MS) / 1000.0;
+
+	const double dx = (sample_IO.x - mX) * mPixelScale;
+	const double dy = (sample_IO.y - mY) * mPixelScale;
+	const double speed = std::sqrt(dx * dx + dy * dy) / dt;
+	mSpeed += LowPassAlpha(mParams.speedCutoff, dt) * (speed - mSpeed);
+
+	const double alpha = LowPassAlpha(mParams.minCutoff + mParams.beta * mSpeed, dt);
+	mX += alpha * (sample_IO.x - mX);
+	mY += alpha * (sample_IO.y - mY);
+	mTime = sample_IO.time;
+
+	sample_IO.x = mX;
+	sample_IO.y = mY;
+	sample_IO.pressure = FilterPressure(sample_IO.pressure);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void PenFilter::FilterBatch(PenFilterSample *samples_IO, size_t count_I)
+{
+	for (size_t idx = 0; idx < count_I; idx++)
+	{
+		Filter(samples_IO[idx]);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Median of the last three packets while the pressure is in the low
+//		band, where single-packet spikes come from, then the contact
+//		hysteresis.  Above the band the pressure passes unchanged, so a
+//		stroke's pressure is not delayed by the median.
+//
+UINT PenFilter::FilterPressure(UINT pressure_I)
+{
+	mPressureHistory[0] = mPressureHistory[1];
+	mPressureHistory[1] = mPressureHistory[2];
+	mPressureHistory[2] = pressure_I;
+	mPressureCount = (std::min)(mPressureCount + 1, 3);
+
+	const double maxPressure = static_cast<double>((std::max)(mMaxPressure, 1u));
+
+	UINT pressure = pressure_I;
+	if (mPressureCount == 3 && pressure_I < mParams.medianBand * maxPressure)
+	{
+		pressure = Median3(mPressureHistory[0], mPressureHistory[1], mPressureHistory[2]);
+	}
+
+	if (mContact)
+	{
+		mContact = pressure >= mParams.pressureOff * maxPressure && pressure > 0;
+	}
+	else
+	{
+		mContact = pressure >= mParams.pressureOn * maxPressure && pressure > 0;
+	}
+
+	return mContact ? pressure : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ParsePenFilterParams(const char *text_I, PenFilterParams &params_IO)
+{
+	if (!text_I || !*text_I)
+	{
+		return false;
+	}
+
+	if (_stricmp(text_I, "off") == 0)
+	{
+		params_IO.enabled = false;
+		return true;
+	}
+
+	double values[4] = { params_IO.minCutoff, params_IO.beta, params_IO.pressureOn, params_IO.pressureOff };
+	const int count = sscanf(text_I, "%lf,%lf,%lf,%lf", &values[0], &values[1], &values[2], &values[3]);
+
+	if (count < 1 || values[0] <= 0.0 || values[1] < 0.0 ||
+		values[2] < 0.0 || values[3] < 0.0 || values[3] > values[2])
+	{
+		return false;
+	}
+
+	params_IO.enabled = true;
+	params_IO.minCutoff = values[0];
+	params_IO.beta = values[1];
+	params_IO.pressureOn = values[2];
+	params_IO.pressureOff = values[3];
+	return true;
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Jitter filter for pen packets, run separately for each Wintab context.
+//
+//		Position goes through a speed-adaptive low pass (One Euro filter):
+//		a slow pen is smoothed hard, and the cutoff rises with the speed so
+//		that a fast pen is followed with little lag.  Pressure goes through a
+//		3-tap median while it is low, which removes single-packet spikes at
+//		touch-down and lift-off, and then through a contact hysteresis, so
+//		noise around zero pressure cannot start or end a stroke.
+//
+//	COPYRIGHT
+//		Copyright (c) 2024 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <windows.h>
+#include <cstddef>
+
+// Default tuning; see PenFilterParams.
+#define PEN_FILTER_MIN_CUTOFF			1.0
+#define PEN_FILTER_BETA					0.05
+#define PEN_FILTER_SPEED_CUTOFF		1.0
+#define PEN_FILTER_PRESSURE_ON		0.01
+#define PEN_FILTER_PRESSURE_OFF		0.005
+#define PEN_FILTER_MEDIAN_BAND		0.05
+
+// Packet interval (ms) assumed when two packets carry the same pkTime, and
+// the gap after which the filter starts over instead of smoothing across it.
+#define PEN_FILTER_DEFAULT_INTERVAL_MS	4
+#define PEN_FILTER_RESET_MS				100
+
+///////////////////////////////////////////////////////////////////////////////
+// Filter tuning.  Speeds are in pixels per second; pressures are fractions
+// of the tablet's maximum pressure.
+//
+struct PenFilterParams
+{
+	bool		enabled;
+	double	minCutoff;			// Hz, position cutoff for a still pen
+	double	beta;					// Hz added per pixel/second of speed
+	double	speedCutoff;		// Hz, cutoff of the speed estimate
+	double	pressureOn;			// pressure needed to start a contact
+	double	pressureOff;		// pressure below which a contact ends
+	double	medianBand;			// median applies below this pressure
+
+	PenFilterParams();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// One packet, filtered in place.  x/y are in context units.
+//
+struct PenFilterSample
+{
+	double	x;
+	double	y;
+	UINT		pressure;
+	DWORD		time;				// pkTime, milliseconds
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class PenFilter
+{
+public:
+	PenFilter();
+
+	void SetParams(const PenFilterParams &params_I) { mParams = params_I; }
+	const PenFilterParams &Params(void) const { return mParams; }
+
+	// Context properties: the maximum pressure, and the size of a context
+	// unit in pixels (1 for a system context).
+	void SetMaxPressure(UINT maxPressure_I) { mMaxPressure = maxPressure_I; }
+	void SetPixelScale(double pixelsPerUnit_I) { mPixelScale = pixelsPerUnit_I; }
+
+	// Forget the packet history, e.g. when the pen leaves proximity.
+	void Reset(void);
+
+	// Filters packets in arrival order.  Each output depends only on the
+	// packets up to it, so batches may be of any size.
+	void Filter(PenFilterSample &sample_IO);
+	void FilterBatch(PenFilterSample *samples_IO, size_t count_I);
+
+private:
+	UINT FilterPressure(UINT pressure_I);
+
+	PenFilterParams	mParams;
+	UINT		mMaxPressure;
+	double	mPixelScale;
+
+	bool		mHasPosition;
+	double	mX;
+	double	mY;
+	double	mSpeed;
+	DWORD		mTime;
+
+	UINT		mPressureHistory[3];
+	int		mPressureCount;
+	bool		mContact;
+};
+
+// Parses "off" or "minCutoff,beta[,pressureOn,pressureOff]" into params_IO,
+// leaving omitted values unchanged.  Returns false if the text is invalid.
+bool ParsePenFilterParams(const char *text_I, PenFilterParams &params_IO);
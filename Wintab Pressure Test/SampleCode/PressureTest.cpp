@@ -17,15 +17,19 @@
 
 #include <msgpack.h>
 #include <wintab.h>
-#define PACKETDATA	(PK_X | PK_Y | PK_BUTTONS | PK_NORMAL_PRESSURE)
+#define PACKETDATA	(PK_X | PK_Y | PK_BUTTONS | PK_NORMAL_PRESSURE | PK_TIME)
 #define PACKETMODE	PK_BUTTONS
 #include <pktdef.h>
 #include "Utils.h"
+#include "PenFilter.h"
 
 #include "PressureTest.h"
 
 constexpr int MAX_LOADSTRING = 100;
 
+// Most packets taken from the context queue per WT_PACKET message.
+constexpr int MAX_PACKETS = 32;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Global Variables:
 
@@ -36,6 +40,9 @@ TCHAR szWindowClass[MAX_LOADSTRING];	// the main window class name
 char* gpszProgramName = "PressureTest";
 static LOGCONTEXT glogContext = { 0 };
 
+// Jitter filter settings; see /penFilter and the Options menu.
+static PenFilterParams gfilterParams;
+
 //////////////////////////////////////////////////////////////////////////////
 // Forward declarations of functions included in this code module:
 ATOM					MyRegisterClass(HINSTANCE);
@@ -54,7 +61,18 @@ int APIENTRY _tWinMain(
 	_In_ int       nCmdShow)
 {
 	UNREFERENCED_PARAMETER(hPrevInstance);
-	UNREFERENCED_PARAMETER(lpCmdLine);
+
+	// /penFilter off | minCutoff,beta[,pressureOn,pressureOff]
+	const char* filterSwitch = strstr(lpCmdLine, "/penFilter");
+	if (filterSwitch)
+	{
+		char value[64] = { 0 };
+		if (sscanf(filterSwitch + strlen("/penFilter"), " %63s", value) != 1 ||
+			!ParsePenFilterParams(value, gfilterParams))
+		{
+			ShowError("Bad /penFilter value; use off or minCutoff,beta[,pressureOn,pressureOff].");
+		}
+	}
 
 	// TODO: Place code here.
 	MSG msg;
@@ -194,13 +212,14 @@ LRESULT CALLBACK WndProc(
 	HDC hdc;
 
 	static HCTX hCtx = NULL;
+	static PenFilter penFilter;
 	static POINT ptOld, ptNew;
 	static UINT prsOld, prsNew;
 	static UINT max_pressure;
 	static UINT half_axis;
 	static RECT rcClient;
 	PAINTSTRUCT psPaint;
-	PACKET pkt;
+	PACKET pkts[MAX_PACKETS];
 	BOOL fHandled = TRUE;
 	LRESULT lResult = 0L;
 	static int xMousePos = 0;
@@ -215,6 +234,16 @@ LRESULT CALLBACK WndProc(
 			ShowError("Could Not Open Tablet Context.");
 			SendMessage(hWnd, WM_DESTROY, 0, 0L);
 		}
+		else
+		{
+			// The context reports screen coordinates, so units are pixels.
+			AXIS tabletPressure = { 0 };
+			gpWTInfoA(WTI_DEVICES, DVC_NPRESSURE, &tabletPressure);
+			penFilter.SetParams(gfilterParams);
+			penFilter.SetMaxPressure(tabletPressure.axMax);
+			penFilter.SetPixelScale(1.0);
+		}
+		CheckMenuItem(GetMenu(hWnd), IDM_PENFILTER, gfilterParams.enabled ? MF_CHECKED : MF_UNCHECKED);
 		break;
 
 	case WM_MOVE:
@@ -243,6 +272,12 @@ LRESULT CALLBACK WndProc(
 		case IDM_EXIT:
 			DestroyWindow(hWnd);
 			break;
+		case IDM_PENFILTER:
+			gfilterParams.enabled = !gfilterParams.enabled;
+			penFilter.SetParams(gfilterParams);
+			penFilter.Reset();
+			CheckMenuItem(GetMenu(hWnd), IDM_PENFILTER, gfilterParams.enabled ? MF_CHECKED : MF_UNCHECKED);
+			break;
 		default:
 			return DefWindowProc(hWnd, message, wParam, lParam);
 		}
@@ -341,25 +376,42 @@ LRESULT CALLBACK WndProc(
 		break;
 
 	case WT_PACKET:
-		if (gpWTPacket((HCTX)lParam, wParam, &pkt))
 		{
-			if (HIWORD(pkt.pkButtons) == TBN_DOWN)
+			// Take every queued packet, oldest first, so that the jitter
+			// filter sees the whole batch; later WT_PACKET messages for
+			// packets already taken find the queue empty.
+			const int count = gpWTPacketsGet((HCTX)lParam, MAX_PACKETS, pkts);
+
+			PenFilterSample samples[MAX_PACKETS];
+			for (int idx = 0; idx < count; idx++)
 			{
-				MessageBeep(0);
+				samples[idx].x = pkts[idx].pkX;
+				samples[idx].y = pkts[idx].pkY;
+				samples[idx].pressure = pkts[idx].pkNormalPressure;
+				samples[idx].time = pkts[idx].pkTime;
 			}
-			ptOld = ptNew;
-			prsOld = prsNew;
+			penFilter.FilterBatch(samples, count);
+
+			for (int idx = 0; idx < count; idx++)
+			{
+				if (HIWORD(pkts[idx].pkButtons) == TBN_DOWN)
+				{
+					MessageBeep(0);
+				}
+				ptOld = ptNew;
+				prsOld = prsNew;
 
-			ptNew.x = pkt.pkX;
-			ptNew.y = pkt.pkY;
+				ptNew.x = static_cast<LONG>(floor(samples[idx].x + 0.5));
+				ptNew.y = static_cast<LONG>(floor(samples[idx].y + 0.5));
 
-			prsNew = pkt.pkNormalPressure;
+				prsNew = samples[idx].pressure;
 
-			if (  (ptNew.x != ptOld.x)
-				|| (ptNew.y != ptOld.y)
-				|| (prsNew != prsOld))
-			{
-				InvalidateRect(hWnd, NULL, TRUE);
+				if (  (ptNew.x != ptOld.x)
+					|| (ptNew.y != ptOld.y)
+					|| (prsNew != prsOld))
+				{
+					InvalidateRect(hWnd, NULL, TRUE);
+				}
 			}
 		}
 		break;
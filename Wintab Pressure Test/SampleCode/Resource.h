@@ -13,6 +13,7 @@
 #define IDI_PRESSURETEST			107
 #define IDI_SMALL				108
 #define IDC_PRESSURETEST			109
+#define IDM_PENFILTER			110
 #define IDC_MYICON				2
 #ifndef IDC_STATIC
 #define IDC_STATIC				-1
@@ -26,6 +27,6 @@
 #define _APS_NEXT_RESOURCE_VALUE	129
 #define _APS_NEXT_COMMAND_VALUE		32771
 #define _APS_NEXT_CONTROL_VALUE		1000
-#define _APS_NEXT_SYMED_VALUE		110
+#define _APS_NEXT_SYMED_VALUE		111
 #endif
 #endif
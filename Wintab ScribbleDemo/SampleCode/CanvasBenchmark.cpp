@@ -0,0 +1,237 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		CanvasBenchmark.cpp
+
+	PURPOSE
+		Offline benchmarks for the kiosk ink canvas.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+
+#include "CanvasBenchmark.h"
+#include "TiledCanvas.h"
+#include "InkDocument.h"
+#include "WorkStealingPool.h"
+#include "Utils.h"
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+
+// Synthetic workload: random-walk strokes scattered over the canvas.
+#define BENCH_STROKES				400
+#define BENCH_SEGMENTS_PER_STROKE	250
+#define BENCH_SEGMENT_LENGTH		6.0
+
+// Size of the offscreen surface the dirty tiles are presented to.
+#define BENCH_SURFACE_SIZE			4096
+
+// Document re-render workload and the thread counts it is timed with.
+#define BENCH_RENDER_STROKES		2000
+#define BENCH_RENDER_ZOOM			1.0
+#define BENCH_RENDER_REPEATS		3
+static const unsigned kBenchRenderThreads[] = { 1, 2, 4, 8, 16 };
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double ElapsedMs(const LARGE_INTEGER &start_I, const LARGE_INTEGER &end_I, const LARGE_INTEGER &freq_I)
+{
+	return 1000.0 * static_cast<double>(end_I.QuadPart - start_I.QuadPart) / static_cast<double>(freq_I.QuadPart);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Draws synthetic strokes on a CANVAS_BENCHMARK_SIZE square canvas,
+//		presenting the dirty tiles after every segment as the kiosk mode does
+//		after every packet, and reports frame times and memory use.
+//
+void RunCanvasBenchmark(size_t residentBudget_I, size_t compressedBudget_I)
+{
+	LARGE_INTEGER freq = { 0 };
+	QueryPerformanceFrequency(&freq);
+
+	TiledCanvas canvas;
+	canvas.Init(CANVAS_BENCHMARK_SIZE, CANVAS_BENCHMARK_SIZE,
+		residentBudget_I, compressedBudget_I, RGB(255, 255, 255));
+
+	// Present into an offscreen surface; the viewport follows each stroke so
+	// that the copies are not clipped away.
+	HDC hdc = CreateCompatibleDC(nullptr);
+	BITMAPINFO info = BITMAPINFO();
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = BENCH_SURFACE_SIZE;
+	info.bmiHeader.biHeight = -BENCH_SURFACE_SIZE;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+	void *bits = nullptr;
+	HBITMAP surface = CreateDIBSection(hdc, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+	HGDIOBJ oldBitmap = SelectObject(hdc, surface);
+
+	std::vector<double> frameMs;
+	frameMs.reserve(BENCH_STROKES * BENCH_SEGMENTS_PER_STROKE);
+	size_t tilesPresented = 0;
+
+	srand(1234);
+
+	for (int stroke = 0; stroke < BENCH_STROKES; stroke++)
+	{
+		double x = BENCH_SURFACE_SIZE / 2 + rand() % (CANVAS_BENCHMARK_SIZE - BENCH_SURFACE_SIZE);
+		double y = BENCH_SURFACE_SIZE / 2 + rand() % (CANVAS_BENCHMARK_SIZE - BENCH_SURFACE_SIZE);
+		double heading = (rand() % 360) * 3.14159 / 180.0;
+		double width = 1 + rand() % 10;
+		COLORREF color = RGB(rand() % 255, rand() % 255, rand() % 255);
+
+		SetViewportOrgEx(hdc, -static_cast<int>(x) + BENCH_SURFACE_SIZE / 2,
+			-static_cast<int>(y) + BENCH_SURFACE_SIZE / 2, nullptr);
+
+		for (int seg = 0; seg < BENCH_SEGMENTS_PER_STROKE; seg++)
+		{
+			heading += ((rand() % 100) - 50) / 400.0;
+			double nx = x + BENCH_SEGMENT_LENGTH * cos(heading);
+			double ny = y + BENCH_SEGMENT_LENGTH * sin(heading);
+
+			LARGE_INTEGER start, end;
+			QueryPerformanceCounter(&start);
+
+			canvas.DrawSegment(x, y, nx, ny, width, color);
+			tilesPresented += canvas.PresentDirty(hdc);
+
+			QueryPerformanceCounter(&end);
+			frameMs.push_back(ElapsedMs(start, end, freq));
+
+			x = nx;
+			y = ny;
+		}
+	}
+
+	SelectObject(hdc, oldBitmap);
+	DeleteObject(surface);
+	DeleteDC(hdc);
+
+	std::sort(frameMs.begin(), frameMs.end());
+	double total = 0.0;
+	for (double ms : frameMs)
+	{
+		total += ms;
+	}
+
+	const CanvasStats &stats = canvas.Stats();
+	const double mb = 1024.0 * 1024.0;
+	const double fullCanvasMb = static_cast<double>(CANVAS_BENCHMARK_SIZE) * CANVAS_BENCHMARK_SIZE * sizeof(DWORD) / mb;
+
+	std::stringstream report;
+	report.precision(3);
+	report << "Canvas: " << CANVAS_BENCHMARK_SIZE << " x " << CANVAS_BENCHMARK_SIZE
+		<< " (" << fullCanvasMb << " MB if fully allocated)\n";
+	report << "Frames: " << frameMs.size() << ", tiles presented/frame: "
+		<< static_cast<double>(tilesPresented) / frameMs.size() << "\n";
+	report << "Frame ms: avg " << total / frameMs.size()
+		<< ", p50 " << frameMs[frameMs.size() / 2]
+		<< ", p99 " << frameMs[frameMs.size() * 99 / 100]
+		<< ", max " << frameMs.back() << "\n";
+	report << "Tiles: resident " << stats.residentTiles
+		<< ", compressed " << stats.compressedTiles
+		<< ", on disk " << stats.diskTiles << "\n";
+	report << "Memory MB: resident " << stats.residentBytes / mb
+		<< " (peak " << stats.peakResidentBytes / mb << ")"
+		<< ", compressed " << stats.compressedBytes / mb
+		<< ", disk " << stats.diskBytes / mb << "\n";
+	report << "Compressions: " << stats.compressions
+		<< ", spills: " << stats.spills
+		<< ", reloads: " << stats.reloads << "\n";
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Canvas Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Re-renders a synthetic document with 1 to 16 raster threads and reports
+//		the best of BENCH_RENDER_REPEATS runs for each, the speedup over one
+//		thread and the output checksum, which must not depend on the thread
+//		count.
+//
+void RunRenderScalingBenchmark(size_t residentBudget_I, size_t compressedBudget_I)
+{
+	TiledCanvas canvas;
+	canvas.Init(CANVAS_BENCHMARK_SIZE, CANVAS_BENCHMARK_SIZE,
+		residentBudget_I, compressedBudget_I, RGB(255, 255, 255));
+
+	InkDocument doc;
+	srand(5678);
+
+	for (int stroke = 0; stroke < BENCH_RENDER_STROKES; stroke++)
+	{
+		double x = rand() % CANVAS_BENCHMARK_SIZE;
+		double y = rand() % CANVAS_BENCHMARK_SIZE;
+		double heading = (rand() % 360) * 3.14159 / 180.0;
+		double width = 1 + rand() % 10;
+
+		doc.BeginStroke(RGB(rand() % 255, rand() % 255, rand() % 255));
+		doc.AddPoint(x, y, width);
+
+		for (int seg = 0; seg < BENCH_SEGMENTS_PER_STROKE; seg++)
+		{
+			heading += ((rand() % 100) - 50) / 400.0;
+			x += BENCH_SEGMENT_LENGTH * cos(heading);
+			y += BENCH_SEGMENT_LENGTH * sin(heading);
+			doc.AddPoint(x, y, width);
+		}
+
+		doc.EndStroke();
+	}
+
+	const RECT viewport = { 0, 0, BENCH_SURFACE_SIZE, BENCH_SURFACE_SIZE };
+
+	std::stringstream report;
+	report.precision(3);
+	report << "Document: " << doc.Strokes().size() << " strokes, "
+		<< doc.SegmentCount() << " segments, zoom " << BENCH_RENDER_ZOOM << "\n";
+
+	double baseMs = 0.0;
+	UINT64 baseChecksum = 0;
+	bool deterministic = true;
+
+	for (unsigned threads : kBenchRenderThreads)
+	{
+		WorkStealingPool pool(threads);
+		InkRenderStats best = InkRenderStats();
+
+		for (int repeat = 0; repeat < BENCH_RENDER_REPEATS; repeat++)
+		{
+			InkRenderStats stats;
+			RenderInkDocument(canvas, doc, BENCH_RENDER_ZOOM, viewport, pool, stats);
+
+			if (repeat == 0 || stats.totalMs < best.totalMs)
+			{
+				best = stats;
+			}
+		}
+
+		if (threads == kBenchRenderThreads[0])
+		{
+			baseMs = best.totalMs;
+			baseChecksum = best.checksum;
+		}
+		deterministic &= best.checksum == baseChecksum;
+
+		report << threads << " threads: " << best.totalMs << " ms"
+			<< " (bin " << best.binMs << ", raster " << best.rasterMs
+			<< ", composite " << best.compositeMs << ")"
+			<< ", speedup " << baseMs / best.totalMs
+			<< ", tiles " << best.tiles
+			<< ", steals " << pool.StealCount()
+			<< ", checksum " << std::hex << best.checksum << std::dec << "\n";
+	}
+
+	report << (deterministic ? "Output identical for all thread counts.\n" : "OUTPUT DIFFERS BETWEEN THREAD COUNTS!\n");
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Render Scaling Benchmark", MB_OK | MB_ICONINFORMATION);
+}
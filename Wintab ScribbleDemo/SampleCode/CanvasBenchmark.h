@@ -0,0 +1,27 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		CanvasBenchmark.h
+
+	PURPOSE
+		Offline benchmarks for the kiosk ink canvas.  Run with the
+		/canvasBenchmark command line switch; results are traced and
+		shown in a message box.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+#pragma once
+
+#include <windows.h>
+
+// Size of the virtual canvas used by the benchmark.
+#define CANVAS_BENCHMARK_SIZE		16384
+
+void RunCanvasBenchmark(size_t residentBudget_I, size_t compressedBudget_I);
+
+// Times a full document re-render on 1, 2, 4, 8 and 16 raster threads.
+void RunRenderScalingBenchmark(size_t residentBudget_I, size_t compressedBudget_I);
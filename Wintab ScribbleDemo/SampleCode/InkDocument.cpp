@@ -0,0 +1,384 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		InkDocument.cpp
+
+	PURPOSE
+		Stroke storage for the kiosk display mode, and the parallel tile
+		renderer used to rebuild the canvas from it.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+
+#include "InkDocument.h"
+#include "TiledCanvas.h"
+#include "WorkStealingPool.h"
+#include "Utils.h"
+#include <algorithm>
+#include <map>
+
+// Number of tiles rasterized before they are handed to the canvas.  Bounds
+// the memory held by finished tiles that have not been composited yet.
+#define INK_RENDER_BATCH_TILES		256
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	// A run of consecutive segments of one stroke that touch one tile.
+	struct InkSpan
+	{
+		size_t	stroke;
+		size_t	first;		// index of the first segment's end point
+		size_t	last;		// index of the last segment's end point
+	};
+
+	struct TileJob
+	{
+		LONG						tx;
+		LONG						ty;
+		std::vector<InkSpan>	spans;
+	};
+
+	struct TileResult
+	{
+		bool						hasInk;
+		bool						resident;
+		std::vector<DWORD>	pixels;
+		std::vector<BYTE>		packed;
+		UINT64					hash;
+	};
+
+	const UINT64 FNV_OFFSET = 14695981039346656037ULL;
+	const UINT64 FNV_PRIME = 1099511628211ULL;
+
+	UINT64 HashBytes(UINT64 hash_I, const void *data_I, size_t size_I)
+	{
+		const BYTE *bytes = static_cast<const BYTE *>(data_I);
+		for (size_t idx = 0; idx < size_I; idx++)
+		{
+			hash_I = (hash_I ^ bytes[idx]) * FNV_PRIME;
+		}
+		return hash_I;
+	}
+
+	double ElapsedMs(const LARGE_INTEGER &start_I, const LARGE_INTEGER &end_I, const LARGE_INTEGER &freq_I)
+	{
+		return 1000.0 * static_cast<double>(end_I.QuadPart - start_I.QuadPart) / static_cast<double>(freq_I.QuadPart);
+	}
+
+	// Segment seg_I of a polyline runs from point seg_I - 1 to point seg_I
+	// and uses the width of its end point, as the live kiosk drawing does.
+	// A single point polyline has one zero length segment.
+	void SegmentPoints(const std::vector<InkPoint> &points_I, size_t seg_I, double zoom_I,
+		double &x0_O, double &y0_O, double &x1_O, double &y1_O, double &width_O)
+	{
+		const InkPoint &end = points_I[seg_I];
+		const InkPoint &start = seg_I > 0 ? points_I[seg_I - 1] : end;
+
+		x0_O = start.x * zoom_I;
+		y0_O = start.y * zoom_I;
+		x1_O = end.x * zoom_I;
+		y1_O = end.y * zoom_I;
+		width_O = end.width * zoom_I;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InkDocument::BeginStroke(COLORREF color_I)
+{
+	EndStroke();
+
+	InkStroke stroke;
+	stroke.color = color_I;
+	mStrokes.push_back(stroke);
+	mInStroke = true;
+
+	mFitting = mFitTolerance > 0.0;
+	if (mFitting)
+	{
+		mFitter.SetTolerance(mFitTolerance);
+		mFitter.Begin();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InkDocument::AddPoint(double x_I, double y_I, double width_I)
+{
+	WACOM_ASSERT(mInStroke && !mStrokes.empty());
+
+	InkPoint point = { x_I, y_I, width_I };
+	mStrokes.back().points.push_back(point);
+
+	if (mFitting)
+	{
+		mFitter.AddPoint(point);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Ends the current stroke.  A fitted stroke keeps its raw samples only
+//		while it is being drawn; they are replaced by the curves here.
+//
+void InkDocument::EndStroke(void)
+{
+	if (!mInStroke)
+	{
+		return;
+	}
+
+	if (mFitting)
+	{
+		mFitter.End();
+
+		InkStroke &stroke = mStrokes.back();
+		stroke.curves = mFitter.TakeCurves();
+		stroke.points = std::vector<InkPoint>();
+		mFitting = false;
+	}
+
+	mInStroke = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InkDocument::Clear(void)
+{
+	mStrokes.clear();
+	mInStroke = false;
+	mFitting = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t InkDocument::SegmentCount(void) const
+{
+	size_t count = 0;
+	for (const InkStroke &stroke : mStrokes)
+	{
+		if (!stroke.curves.empty())
+		{
+			count += stroke.curves.size();
+		}
+		else
+		{
+			count += stroke.points.size() > 1 ? stroke.points.size() - 1 : stroke.points.size();
+		}
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Rebuilds the canvas from the document in four phases:
+//		0. Flatten: fitted strokes become polylines with segments about
+//			STROKE_FLATTEN_STEP pixels long at this zoom (parallel).
+//		1. Bin: walk the segments in document order and append each to the
+//			span list of every tile it covers (serial, cheap).
+//		2. Raster: one job per tile replays its spans in document order into
+//			a private buffer (parallel, work-stealing).
+//		3. Composite: store the finished tiles into the canvas in tile key
+//			order (serial, touches the LRU cache).
+//		Phases 2 and 3 run in batches to bound the memory of finished tiles.
+//
+void RenderInkDocument(TiledCanvas &canvas_IO, const InkDocument &doc_I, double zoom_I,
+	const RECT &viewport_I, WorkStealingPool &pool_I, InkRenderStats &stats_O)
+{
+	LARGE_INTEGER freq = { 0 };
+	LARGE_INTEGER start, binned, end;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&start);
+
+	stats_O = InkRenderStats();
+	stats_O.threads = pool_I.ThreadCount();
+
+	canvas_IO.Clear();
+
+	const LONG canvasWidth = canvas_IO.Width();
+	const LONG canvasHeight = canvas_IO.Height();
+	const DWORD background = canvas_IO.BackgroundPixel();
+
+	const std::vector<InkStroke> &strokes = doc_I.Strokes();
+
+	// Phase 0: raw strokes are used as they are.
+	std::vector<std::vector<InkPoint>> flattened(strokes.size());
+	pool_I.ParallelFor(strokes.size(), [&](size_t index_I, unsigned)
+	{
+		const InkStroke &stroke = strokes[index_I];
+		if (stroke.curves.empty())
+		{
+			return;
+		}
+
+		std::vector<InkPoint> &points = flattened[index_I];
+		points.push_back(stroke.curves.front().p0);
+		for (const InkCurve &curve : stroke.curves)
+		{
+			FlattenCurve(curve, STROKE_FLATTEN_STEP / zoom_I, points);
+		}
+	});
+
+	std::vector<const std::vector<InkPoint> *> polylines(strokes.size());
+	for (size_t idx = 0; idx < strokes.size(); idx++)
+	{
+		polylines[idx] = strokes[idx].curves.empty() ? &strokes[idx].points : &flattened[idx];
+	}
+
+	// Phase 1: keyed by row then column, so iteration is in tile key order.
+	std::map<UINT64, TileJob> bins;
+
+	for (size_t strokeIdx = 0; strokeIdx < strokes.size(); strokeIdx++)
+	{
+		const std::vector<InkPoint> &points = *polylines[strokeIdx];
+
+		for (size_t seg = (points.size() > 1 ? 1 : 0); seg < points.size(); seg++)
+		{
+			double x0, y0, x1, y1, width;
+			SegmentPoints(points, seg, zoom_I, x0, y0, x1, y1, width);
+			stats_O.segments++;
+
+			RECT range = { 0 };
+			if (!TiledCanvas::SegmentTileRange(x0, y0, x1, y1, width, canvasWidth, canvasHeight, range))
+			{
+				continue;
+			}
+
+			for (LONG ty = range.top; ty <= range.bottom; ty++)
+			{
+				for (LONG tx = range.left; tx <= range.right; tx++)
+				{
+					UINT64 key = (static_cast<UINT64>(ty) << 32) | static_cast<UINT64>(tx);
+					TileJob &job = bins[key];
+					job.tx = tx;
+					job.ty = ty;
+
+					// Extend the previous span when this segment follows it.
+					if (!job.spans.empty() && job.spans.back().stroke == strokeIdx && job.spans.back().last + 1 == seg)
+					{
+						job.spans.back().last = seg;
+					}
+					else
+					{
+						InkSpan span = { strokeIdx, seg, seg };
+						job.spans.push_back(span);
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<TileJob> jobs;
+	jobs.reserve(bins.size());
+	for (auto &bin : bins)
+	{
+		stats_O.spans += bin.second.spans.size();
+		jobs.push_back(std::move(bin.second));
+	}
+	bins.clear();
+
+	QueryPerformanceCounter(&binned);
+	stats_O.binMs = ElapsedMs(start, binned, freq);
+
+	const LONG viewLeft = viewport_I.left / CANVAS_TILE_SIZE;
+	const LONG viewTop = viewport_I.top / CANVAS_TILE_SIZE;
+	const LONG viewRight = (viewport_I.right - 1) / CANVAS_TILE_SIZE;
+	const LONG viewBottom = (viewport_I.bottom - 1) / CANVAS_TILE_SIZE;
+
+	std::vector<TileResult> results;
+	UINT64 checksum = FNV_OFFSET;
+
+	for (size_t batchStart = 0; batchStart < jobs.size(); batchStart += INK_RENDER_BATCH_TILES)
+	{
+		const size_t batchSize = std::min<size_t>(INK_RENDER_BATCH_TILES, jobs.size() - batchStart);
+		results.clear();
+		results.resize(batchSize);
+
+		// Phase 2: every tile is written by exactly one job, so no locking.
+		LARGE_INTEGER rasterStart, rasterEnd;
+		QueryPerformanceCounter(&rasterStart);
+
+		pool_I.ParallelFor(batchSize, [&](size_t index_I, unsigned)
+		{
+			const TileJob &job = jobs[batchStart + index_I];
+			TileResult &result = results[index_I];
+
+			result.pixels.assign(CANVAS_TILE_SIZE * CANVAS_TILE_SIZE, background);
+			result.hasInk = false;
+
+			for (const InkSpan &span : job.spans)
+			{
+				const std::vector<InkPoint> &points = *polylines[span.stroke];
+				const DWORD pixel = TiledCanvas::ToPixel(strokes[span.stroke].color);
+
+				for (size_t seg = span.first; seg <= span.last; seg++)
+				{
+					double x0, y0, x1, y1, width;
+					SegmentPoints(points, seg, zoom_I, x0, y0, x1, y1, width);
+					result.hasInk |= TiledCanvas::RasterizeSegment(result.pixels.data(), job.tx, job.ty,
+						canvasWidth, canvasHeight, x0, y0, x1, y1, width, pixel);
+				}
+			}
+
+			// The bin is the bounding box of each segment; diagonal strokes
+			// leave some binned tiles untouched.  Those stay unallocated.
+			if (!result.hasInk)
+			{
+				result.pixels = std::vector<DWORD>();
+				return;
+			}
+
+			result.hash = HashBytes(FNV_OFFSET, &job.tx, sizeof(job.tx));
+			result.hash = HashBytes(result.hash, &job.ty, sizeof(job.ty));
+			result.hash = HashBytes(result.hash, result.pixels.data(), result.pixels.size() * sizeof(DWORD));
+
+			result.resident = job.tx >= viewLeft && job.tx <= viewRight && job.ty >= viewTop && job.ty <= viewBottom;
+			if (!result.resident)
+			{
+				TiledCanvas::PackTile(result.pixels, result.packed);
+				result.pixels = std::vector<DWORD>();
+			}
+		});
+
+		QueryPerformanceCounter(&rasterEnd);
+		stats_O.rasterMs += ElapsedMs(rasterStart, rasterEnd, freq);
+
+		// Phase 3: deterministic order regardless of which worker ran what.
+		for (size_t idx = 0; idx < batchSize; idx++)
+		{
+			TileResult &result = results[idx];
+			if (!result.hasInk)
+			{
+				continue;
+			}
+
+			const TileJob &job = jobs[batchStart + idx];
+			if (result.resident)
+			{
+				canvas_IO.StoreTile(job.tx, job.ty, std::move(result.pixels));
+			}
+			else
+			{
+				canvas_IO.StoreCompressedTile(job.tx, job.ty, std::move(result.packed));
+			}
+
+			checksum = HashBytes(checksum, &result.hash, sizeof(result.hash));
+			stats_O.tiles++;
+		}
+
+		LARGE_INTEGER compositeEnd;
+		QueryPerformanceCounter(&compositeEnd);
+		stats_O.compositeMs += ElapsedMs(rasterEnd, compositeEnd, freq);
+	}
+
+	QueryPerformanceCounter(&end);
+	stats_O.totalMs = ElapsedMs(start, end, freq);
+	stats_O.checksum = checksum;
+}
@@ -0,0 +1,96 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		InkDocument.h
+
+	PURPOSE
+		Stroke storage for the kiosk display mode, and the parallel tile
+		renderer used to rebuild the canvas from it (eg: after a zoom).
+
+		With a fit tolerance set, each stroke is fitted to cubic curves as
+		its samples arrive and only the curves are kept once it ends.
+
+		Rendering bins every stroke segment into the tiles it covers, then
+		rasterizes the tiles on a WorkStealingPool.  Each tile is rendered by
+		exactly one job, in document order, into a private buffer; finished
+		tiles are stored into the canvas in tile key order, so the result is
+		identical for any number of threads.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include "StrokeFit.h"
+
+class TiledCanvas;
+class WorkStealingPool;
+
+///////////////////////////////////////////////////////////////////////////////
+// A stroke holds either its raw samples (points) or, once fitted, the
+// curves through them.
+//
+struct InkStroke
+{
+	COLORREF					color;
+	std::vector<InkPoint>	points;
+	std::vector<InkCurve>	curves;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Timing and result summary of one RenderInkDocument call.
+//
+struct InkRenderStats
+{
+	unsigned	threads;
+	size_t	tiles;			// tiles rendered
+	size_t	spans;			// per-tile runs of consecutive segments
+	size_t	segments;
+	double	binMs;
+	double	rasterMs;
+	double	compositeMs;
+	double	totalMs;
+	UINT64	checksum;		// FNV-1a of the rendered tiles in key order
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Ordered list of strokes.  A single point stroke is drawn as a dot.
+//
+class InkDocument
+{
+public:
+	InkDocument() : mInStroke(false), mFitTolerance(0.0), mFitting(false) {}
+
+	// Tolerance (document pixels) for fitting strokes that start after this
+	// call; 0 keeps raw samples.
+	void SetFitTolerance(double tolerance_I) { mFitTolerance = tolerance_I; }
+	double FitTolerance(void) const { return mFitTolerance; }
+
+	void BeginStroke(COLORREF color_I);
+	void AddPoint(double x_I, double y_I, double width_I);
+	void EndStroke(void);
+	void Clear(void);
+
+	bool InStroke(void) const { return mInStroke; }
+	bool IsEmpty(void) const { return mStrokes.empty(); }
+	size_t SegmentCount(void) const;
+	const std::vector<InkStroke> &Strokes(void) const { return mStrokes; }
+
+private:
+	std::vector<InkStroke>	mStrokes;
+	bool							mInStroke;
+	double						mFitTolerance;
+	bool							mFitting;		// current stroke is being fitted
+	StrokeFitter				mFitter;
+};
+
+// Clears canvas_IO and renders doc_I into it at zoom_I.  Tiles intersecting
+// viewport_I (canvas pixels) are stored resident, all others are packed by
+// the raster jobs and stored compressed.
+void RenderInkDocument(TiledCanvas &canvas_IO, const InkDocument &doc_I, double zoom_I,
+	const RECT &viewport_I, WorkStealingPool &pool_I, InkRenderStats &stats_O);
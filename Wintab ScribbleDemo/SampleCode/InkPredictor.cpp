@@ -0,0 +1,156 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		InkPredictor.cpp
+
+	PURPOSE
+		Short term prediction of pen position and pressure.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+
+#include "InkPredictor.h"
+#include <algorithm>
+#include <cmath>
+
+// Default weight of the fitted acceleration.
+#define PREDICT_DEFAULT_ACCEL_WEIGHT	0.5
+
+// Predicted travel is capped at this multiple of the recent average speed.
+#define PREDICT_TRAVEL_LIMIT			1.5
+
+// Shortest history time span (ms) worth extrapolating from.
+#define PREDICT_MIN_SPAN_MS			4
+
+///////////////////////////////////////////////////////////////////////////////
+
+InkPredictor::InkPredictor() :
+	mNewest(0),
+	mCount(0),
+	mAccelWeight(PREDICT_DEFAULT_ACCEL_WEIGHT)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InkPredictor::AddSample(const PenSample &sample_I)
+{
+	mNewest = (mNewest + 1) % PREDICT_HISTORY;
+	mHistory[mNewest] = sample_I;
+	mCount = std::min(mCount + 1, PREDICT_HISTORY);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sample age_I packets older than the newest one.
+//
+const PenSample &InkPredictor::Sample(int age_I) const
+{
+	return mHistory[(mNewest - age_I + PREDICT_HISTORY) % PREDICT_HISTORY];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Fits x(t), y(t) = a + b t + c t^2 and p(t) = a + b t by weighted
+//		least squares, with t in ms relative to the newest packet and more
+//		weight on recent packets.  The prediction is the newest sample plus
+//		the fitted change over the look-ahead, so the tail always starts at
+//		the real pen position.
+//
+bool InkPredictor::Predict(double aheadMs_I, PenSample &predicted_O) const
+{
+	if (mCount < 3)
+	{
+		return false;
+	}
+
+	const PenSample &newest = Sample(0);
+
+	int count = 0;
+	while (count < mCount && newest.time - Sample(count).time <= PREDICT_WINDOW_MS)
+	{
+		count++;
+	}
+
+	const PenSample &oldest = Sample(count - 1);
+	const double span = static_cast<double>(newest.time - oldest.time);
+	if (count < 3 || span < PREDICT_MIN_SPAN_MS)
+	{
+		return false;
+	}
+
+	// Weighted moments of t, and of t times each coordinate.
+	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0, s4 = 0.0;
+	double x0 = 0.0, x1 = 0.0, x2 = 0.0;
+	double y0 = 0.0, y1 = 0.0, y2 = 0.0;
+	double p0 = 0.0, p1 = 0.0;
+
+	for (int age = 0; age < count; age++)
+	{
+		const PenSample &sample = Sample(age);
+		const double t = -static_cast<double>(newest.time - sample.time);
+		const double w = static_cast<double>(count - age) / count;
+
+		s0 += w;
+		s1 += w * t;
+		s2 += w * t * t;
+		s3 += w * t * t * t;
+		s4 += w * t * t * t * t;
+
+		x0 += w * sample.x;
+		x1 += w * t * sample.x;
+		x2 += w * t * t * sample.x;
+		y0 += w * sample.y;
+		y1 += w * t * sample.y;
+		y2 += w * t * t * sample.y;
+		p0 += w * sample.pressure;
+		p1 += w * t * sample.pressure;
+	}
+
+	const double ahead = std::min(aheadMs_I, PREDICT_MAX_AHEAD_MS);
+
+	// Quadratic fit by Cramer's rule; only the b and c terms are needed.
+	const double det = s0 * (s2 * s4 - s3 * s3) - s1 * (s1 * s4 - s2 * s3) + s2 * (s1 * s3 - s2 * s2);
+	double dx = 0.0, dy = 0.0;
+
+	if (std::fabs(det) > 1e-9)
+	{
+		const double bx = (s0 * (x1 * s4 - s3 * x2) - x0 * (s1 * s4 - s2 * s3) + s2 * (s1 * x2 - s2 * x1)) / det;
+		const double cx = (s0 * (s2 * x2 - x1 * s3) - s1 * (s1 * x2 - x1 * s2) + x0 * (s1 * s3 - s2 * s2)) / det;
+		const double by = (s0 * (y1 * s4 - s3 * y2) - y0 * (s1 * s4 - s2 * s3) + s2 * (s1 * y2 - s2 * y1)) / det;
+		const double cy = (s0 * (s2 * y2 - y1 * s3) - s1 * (s1 * y2 - y1 * s2) + y0 * (s1 * s3 - s2 * s2)) / det;
+
+		dx = bx * ahead + mAccelWeight * cx * ahead * ahead;
+		dy = by * ahead + mAccelWeight * cy * ahead * ahead;
+	}
+	else
+	{
+		// Too few distinct times for a quadratic; use the average velocity.
+		dx = (newest.x - oldest.x) / span * ahead;
+		dy = (newest.y - oldest.y) / span * ahead;
+	}
+
+	// Cap the travel relative to the recent average speed.
+	const double speed = std::sqrt((newest.x - oldest.x) * (newest.x - oldest.x) + (newest.y - oldest.y) * (newest.y - oldest.y)) / span;
+	const double travel = std::sqrt(dx * dx + dy * dy);
+	const double limit = PREDICT_TRAVEL_LIMIT * speed * ahead;
+	if (travel > limit && travel > 0.0)
+	{
+		dx *= limit / travel;
+		dy *= limit / travel;
+	}
+
+	// Linear pressure trend.
+	const double pdet = s0 * s2 - s1 * s1;
+	const double pslope = std::fabs(pdet) > 1e-9 ? (s0 * p1 - s1 * p0) / pdet : 0.0;
+
+	predicted_O.x = newest.x + dx;
+	predicted_O.y = newest.y + dy;
+	predicted_O.pressure = newest.pressure + pslope * ahead;
+	predicted_O.time = newest.time + static_cast<DWORD>(ahead + 0.5);
+
+	return predicted_O.pressure > 0.0;
+}
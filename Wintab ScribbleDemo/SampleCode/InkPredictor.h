@@ -0,0 +1,69 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		InkPredictor.h
+
+	PURPOSE
+		Short term prediction of pen position and pressure from the recent
+		packet history, used to draw a provisional ink tail ahead of the pen.
+
+		Position is extrapolated with a weighted least squares quadratic in
+		time over the last few packets (pkTime), with the acceleration term
+		damped and the predicted travel capped, since overshoot is more
+		visible than lag.  Pressure is extrapolated linearly.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+#pragma once
+
+#include <windows.h>
+
+// Packets kept for the fit, and the oldest packet age (ms) still used.
+#define PREDICT_HISTORY				8
+#define PREDICT_WINDOW_MS			40
+
+// Longest look-ahead honored, in milliseconds.
+#define PREDICT_MAX_AHEAD_MS		50.0
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct PenSample
+{
+	double	x;
+	double	y;
+	double	pressure;
+	DWORD		time;			// pkTime, milliseconds
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class InkPredictor
+{
+public:
+	InkPredictor();
+
+	// Forget the history; call when the pen lifts.
+	void Reset(void) { mCount = 0; }
+
+	void AddSample(const PenSample &sample_I);
+
+	// Predicts the sample aheadMs_I after the newest one.  Returns false
+	// when there is too little history or the pen is predicted to lift.
+	bool Predict(double aheadMs_I, PenSample &predicted_O) const;
+
+	// Weight of the acceleration term, 0 (linear) to 1 (full quadratic).
+	void SetAccelerationWeight(double weight_I) { mAccelWeight = weight_I; }
+	double AccelerationWeight(void) const { return mAccelWeight; }
+
+private:
+	const PenSample &Sample(int age_I) const;
+
+	PenSample	mHistory[PREDICT_HISTORY];
+	int			mNewest;
+	int			mCount;
+	double		mAccelWeight;
+};
@@ -0,0 +1,213 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		PacketLog.cpp
+
+	PURPOSE
+		Recording and loading of pen packet sessions.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+
+#include "PacketLog.h"
+#include "Utils.h"
+#include <cmath>
+#include <cstdlib>
+
+// Synthetic session parameters, roughly an Intuos at 266 Hz.
+#define SYNTH_RATE_HZ			266
+#define SYNTH_X_EXTENT			44704
+#define SYNTH_Y_EXTENT			27940
+#define SYNTH_MAX_PRESSURE		8191
+#define SYNTH_NOISE_COUNTS		3
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool PacketLogWriter::Open(const char *path_I, const PacketLogHeader &header_I)
+{
+	Close();
+
+	mFile = fopen(path_I, "wb");
+	if (!mFile)
+	{
+		WacomTrace("PacketLogWriter: cannot create %s\n", path_I);
+		return false;
+	}
+
+	PacketLogHeader header = header_I;
+	header.magic = PACKETLOG_MAGIC;
+	header.version = PACKETLOG_VERSION;
+	fwrite(&header, sizeof(header), 1, mFile);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void PacketLogWriter::Write(const PacketRecord &record_I)
+{
+	if (mFile)
+	{
+		fwrite(&record_I, sizeof(record_I), 1, mFile);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void PacketLogWriter::Close(void)
+{
+	if (mFile)
+	{
+		fclose(mFile);
+		mFile = nullptr;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool LoadPacketLog(const char *path_I, PacketLogHeader &header_O, std::vector<PacketRecord> &records_O)
+{
+	records_O.clear();
+
+	FILE *file = fopen(path_I, "rb");
+	if (!file)
+	{
+		return false;
+	}
+
+	bool ok = fread(&header_O, sizeof(header_O), 1, file) == 1 &&
+		header_O.magic == PACKETLOG_MAGIC && header_O.version == PACKETLOG_VERSION;
+
+	PacketRecord record;
+	while (ok && fread(&record, sizeof(record), 1, file) == 1)
+	{
+		records_O.push_back(record);
+	}
+
+	fclose(file);
+	return ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Writes words as loops drifting left to right, with pressure ramping
+//		in and out of each stroke and short hover gaps between strokes.
+//		Pen speed varies within a stroke, so both slow, dense sections and
+//		fast, sparse ones are present.  Each stroke starts with the pen
+//		resting at noisy, near-zero pressure, as at a real touch-down.
+//
+void MakeSyntheticPacketLog(unsigned seconds_I, unsigned seed_I,
+	PacketLogHeader &header_O, std::vector<PacketRecord> &records_O)
+{
+	header_O = PacketLogHeader();
+	header_O.magic = PACKETLOG_MAGIC;
+	header_O.version = PACKETLOG_VERSION;
+	header_O.xExtent = SYNTH_X_EXTENT;
+	header_O.yExtent = SYNTH_Y_EXTENT;
+	header_O.maxPressure = SYNTH_MAX_PRESSURE;
+
+	records_O.clear();
+	srand(seed_I);
+
+	const double pi = 3.14159265358979;
+	const double dt = 1.0 / SYNTH_RATE_HZ;
+	const unsigned total = seconds_I * SYNTH_RATE_HZ;
+
+	double lineX = SYNTH_X_EXTENT * 0.05;
+	double lineY = SYNTH_Y_EXTENT * 0.1;
+	double time = 0.0;
+
+	while (records_O.size() < total)
+	{
+		// One stroke: 0.3 to 1.2 seconds of loops.
+		const double duration = 0.3 + (rand() % 90) / 100.0;
+		const double loopHz = 2.0 + (rand() % 300) / 100.0;
+		const double radius = 300.0 + rand() % 500;
+		const double drift = 1500.0 + rand() % 2000;
+		const double phase = (rand() % 628) / 100.0;
+		const double peak = SYNTH_MAX_PRESSURE * (0.3 + (rand() % 60) / 100.0);
+
+		// Touch-down: the pen rests for 20 to 60 ms at very low, noisy
+		// pressure before it starts to move.
+		const double startX = lineX + radius * cos(phase);
+		const double startY = lineY + radius * 1.4 * sin(phase);
+		const double landing = 0.02 + (rand() % 40) / 1000.0;
+		for (double t = 0.0; t < landing && records_O.size() < total; t += dt)
+		{
+			const double pressure = 40.0 * t / landing + (rand() % 61) - 30;
+
+			PacketRecord record = PacketRecord();
+			record.time = static_cast<DWORD>((time + t) * 1000.0);
+			record.x = static_cast<LONG>(startX) + (rand() % (2 * SYNTH_NOISE_COUNTS + 1)) - SYNTH_NOISE_COUNTS;
+			record.y = static_cast<LONG>(startY) + (rand() % (2 * SYNTH_NOISE_COUNTS + 1)) - SYNTH_NOISE_COUNTS;
+			record.pressure = pressure > 0.0 ? static_cast<UINT>(pressure) : 0;
+			record.buttons = record.pressure ? 1 : 0;
+			records_O.push_back(record);
+		}
+		time += landing;
+
+		for (double t = 0.0; t < duration && records_O.size() < total; t += dt)
+		{
+			const double u = t / duration;
+
+			// Uneven speed: slow near the ends of the stroke, fast in between.
+			const double s = t + 0.08 * sin(2.0 * pi * u);
+			const double x = lineX + drift * s + radius * cos(2.0 * pi * loopHz * s + phase);
+			const double y = lineY + radius * 1.4 * sin(2.0 * pi * loopHz * s + phase);
+			const double pressure = peak * sin(pi * u) + (rand() % 41) - 20;
+
+			PacketRecord record = PacketRecord();
+			record.time = static_cast<DWORD>((time + t) * 1000.0);
+			record.x = static_cast<LONG>(x) + (rand() % (2 * SYNTH_NOISE_COUNTS + 1)) - SYNTH_NOISE_COUNTS;
+			record.y = static_cast<LONG>(y) + (rand() % (2 * SYNTH_NOISE_COUNTS + 1)) - SYNTH_NOISE_COUNTS;
+			record.pressure = pressure > 0.0 ? static_cast<UINT>(pressure) : 0;
+			record.buttons = record.pressure ? 1 : 0;
+			records_O.push_back(record);
+		}
+
+		time += duration;
+		lineX += drift * duration + radius;
+
+		// Next line when the pen reaches the right margin.
+		if (lineX > SYNTH_X_EXTENT * 0.85)
+		{
+			lineX = SYNTH_X_EXTENT * 0.05;
+			lineY += SYNTH_Y_EXTENT * 0.12;
+			if (lineY > SYNTH_Y_EXTENT * 0.9)
+			{
+				lineY = SYNTH_Y_EXTENT * 0.1;
+			}
+		}
+
+		// Hover gap of 40 to 120 ms before the next stroke.
+		const double gap = 0.04 + (rand() % 80) / 1000.0;
+		for (double t = 0.0; t < gap && records_O.size() < total; t += dt)
+		{
+			PacketRecord record = PacketRecord();
+			record.time = static_cast<DWORD>((time + t) * 1000.0);
+			record.x = static_cast<LONG>(lineX) + (rand() % (2 * SYNTH_NOISE_COUNTS + 1)) - SYNTH_NOISE_COUNTS;
+			record.y = static_cast<LONG>(lineY) + (rand() % (2 * SYNTH_NOISE_COUNTS + 1)) - SYNTH_NOISE_COUNTS;
+			records_O.push_back(record);
+		}
+		time += gap;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void PacketToPixels(const PacketLogHeader &header_I, const PacketRecord &record_I, double &x_O, double &y_O)
+{
+	if (header_I.xExtent <= 0 || header_I.yExtent <= 0)
+	{
+		x_O = record_I.x;
+		y_O = record_I.y;
+		return;
+	}
+
+	const double scale = PACKETLOG_REPLAY_WIDTH / header_I.xExtent;
+	x_O = record_I.x * scale;
+	y_O = record_I.y * scale;
+}
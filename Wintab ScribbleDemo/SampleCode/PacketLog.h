@@ -0,0 +1,82 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		PacketLog.h
+
+	PURPOSE
+		Recording and loading of pen packet sessions, so that ink processing
+		stages can be measured offline against real input.
+
+		A log holds the packets of one Wintab context: a PacketLogHeader
+		followed by PacketRecord entries, in arrival order.  Run ScribbleDemo
+		with /recordPackets <path> to record one.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include <cstdio>
+
+#define PACKETLOG_MAGIC			0x4C4B5057		// "WPKL"
+#define PACKETLOG_VERSION		1
+
+// Width, in pixels, that tablet coordinates are scaled to on replay.
+#define PACKETLOG_REPLAY_WIDTH	1920.0
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct PacketLogHeader
+{
+	DWORD		magic;
+	DWORD		version;
+	LONG		xExtent;			// tablet units; 0 if x/y are screen pixels
+	LONG		yExtent;
+	UINT		maxPressure;
+	DWORD		reserved;
+};
+
+struct PacketRecord
+{
+	DWORD		time;				// pkTime, milliseconds
+	LONG		x;
+	LONG		y;
+	UINT		pressure;		// pkNormalPressure
+	DWORD		buttons;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Appends packets to a log file.
+//
+class PacketLogWriter
+{
+public:
+	PacketLogWriter() : mFile(nullptr) {}
+	~PacketLogWriter() { Close(); }
+
+	bool Open(const char *path_I, const PacketLogHeader &header_I);
+	void Write(const PacketRecord &record_I);
+	void Close(void);
+
+	bool IsOpen(void) const { return mFile != nullptr; }
+
+private:
+	FILE		*mFile;
+};
+
+// Reads a whole log.  Returns false if the file is missing or not a log.
+bool LoadPacketLog(const char *path_I, PacketLogHeader &header_O, std::vector<PacketRecord> &records_O);
+
+// Generates a handwriting-like session sampled at 266 Hz, including sensor
+// noise, for use when no recorded log is given.
+void MakeSyntheticPacketLog(unsigned seconds_I, unsigned seed_I,
+	PacketLogHeader &header_O, std::vector<PacketRecord> &records_O);
+
+// Converts a record's position to pixels; tablet coordinates are scaled to
+// PACKETLOG_REPLAY_WIDTH keeping the aspect ratio.
+void PacketToPixels(const PacketLogHeader &header_I, const PacketRecord &record_I, double &x_O, double &y_O);
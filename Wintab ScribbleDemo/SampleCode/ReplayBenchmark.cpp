@@ -0,0 +1,655 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		ReplayBenchmark.cpp
+
+	PURPOSE
+		Offline benchmarks that replay a recorded packet session through the
+		ink processing stages.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+
+#include "ReplayBenchmark.h"
+#include "PacketLog.h"
+#include "StrokeFit.h"
+#include "InkPredictor.h"
+#include "PenFilter.h"
+#include "Utils.h"
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+
+// Tolerances (pixels) compared by the fit benchmark.
+static const double kFitTolerances[] = { 0.25, 0.5, STROKE_FIT_DEFAULT_TOLERANCE, 1.5 };
+
+// Look-aheads (ms) compared by the prediction benchmark: 1 to 3 frames at
+// 60 Hz, and the acceleration weights tried for each.
+static const double kPredictAheadMs[] = { 1000.0 / 60, 2000.0 / 60, 3000.0 / 60 };
+static const double kPredictAccelWeights[] = { 0.0, 0.5, 1.0 };
+
+// Step used to sample fitted curves when measuring deviation.
+#define REPLAY_DEVIATION_STEP		0.25
+
+// Filter settings (minimum cutoff Hz, beta) compared by the jitter filter
+// benchmark, after the unfiltered baseline.
+static const double kFilterSettings[][2] =
+{
+	{ 0.5, 0.02 },
+	{ 1.0, 0.02 },
+	{ PEN_FILTER_MIN_CUTOFF, PEN_FILTER_BETA },
+	{ 1.0, 0.1 },
+	{ 2.0, 0.1 },
+};
+
+// Packets delivered per WT_PACKET batch in the filter benchmark.
+#define REPLAY_FILTER_BATCH			8
+
+// The pen counts as still below this speed (pixels per second) in the
+// filter benchmark; jitter is measured there and lag everywhere else.
+#define REPLAY_STILL_SPEED			20.0
+
+// Contacts shorter than this many packets count as speckles.
+#define REPLAY_SPECKLE_PACKETS		4
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	double ElapsedMs(const LARGE_INTEGER &start_I, const LARGE_INTEGER &end_I, const LARGE_INTEGER &freq_I)
+	{
+		return 1000.0 * static_cast<double>(end_I.QuadPart - start_I.QuadPart) / static_cast<double>(freq_I.QuadPart);
+	}
+
+	// Loads the log, or makes a synthetic one if no path is given.  The
+	// description names the source for the report.
+	bool LoadSession(const char *logPath_I, PacketLogHeader &header_O,
+		std::vector<PacketRecord> &records_O, std::string &description_O)
+	{
+		if (logPath_I && *logPath_I)
+		{
+			if (!LoadPacketLog(logPath_I, header_O, records_O))
+			{
+				ShowError("Cannot read the packet log.");
+				return false;
+			}
+			description_O = logPath_I;
+		}
+		else
+		{
+			MakeSyntheticPacketLog(REPLAY_SYNTHETIC_SECONDS, 1234, header_O, records_O);
+			description_O = "synthetic";
+		}
+
+		std::stringstream text;
+		text << description_O << ", " << records_O.size() << " packets";
+		if (records_O.size() > 1)
+		{
+			text << ", " << (records_O.back().time - records_O.front().time) / 1000.0 << " s";
+		}
+		description_O = text.str();
+		return true;
+	}
+
+	// Splits the session into strokes (runs of non-zero pressure), in
+	// pixels, with the pen width ScribbleDemo draws for each pressure.
+	void SessionStrokes(const PacketLogHeader &header_I, const std::vector<PacketRecord> &records_I,
+		std::vector<std::vector<InkPoint>> &strokes_O)
+	{
+		strokes_O.clear();
+		const double maxPressure = header_I.maxPressure ? header_I.maxPressure : 1.0;
+		bool down = false;
+
+		for (const PacketRecord &record : records_I)
+		{
+			if (record.pressure == 0)
+			{
+				down = false;
+				continue;
+			}
+
+			if (!down)
+			{
+				strokes_O.push_back(std::vector<InkPoint>());
+				down = true;
+			}
+
+			InkPoint point;
+			PacketToPixels(header_I, record, point.x, point.y);
+			point.width = 1 + std::floor(10 * record.pressure / maxPressure);
+			strokes_O.back().push_back(point);
+		}
+	}
+
+	// True if the pen is below REPLAY_STILL_SPEED at idx_I and at the ends
+	// of the velocity window around it, so the start and end of a motion
+	// are not taken for jitter.
+	bool IsStill(const std::vector<double> &vx_I, const std::vector<double> &vy_I, size_t idx_I, size_t window_I)
+	{
+		const double limit = REPLAY_STILL_SPEED * REPLAY_STILL_SPEED;
+		for (size_t idx : { idx_I - window_I, idx_I, idx_I + window_I })
+		{
+			if (vx_I[idx] * vx_I[idx] + vy_I[idx] * vy_I[idx] >= limit)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Distance from (x_I, y_I) to segment a_I..b_I, and the parameter of
+	// the closest point.
+	double SegmentDistance(const InkPoint &a_I, const InkPoint &b_I, double x_I, double y_I, double &t_O)
+	{
+		const double dx = b_I.x - a_I.x;
+		const double dy = b_I.y - a_I.y;
+		const double len2 = dx * dx + dy * dy;
+		t_O = len2 > 0.0 ? ((x_I - a_I.x) * dx + (y_I - a_I.y) * dy) / len2 : 0.0;
+		t_O = std::min(1.0, std::max(0.0, t_O));
+		return std::hypot(a_I.x + t_O * dx - x_I, a_I.y + t_O * dy - y_I);
+	}
+
+	// Samples a curve every REPLAY_DEVIATION_STEP pixels, including both ends.
+	void SampleCurve(const InkCurve &curve_I, std::vector<InkPoint> &points_O)
+	{
+		const double length =
+			std::hypot(curve_I.c1.x - curve_I.p0.x, curve_I.c1.y - curve_I.p0.y) +
+			std::hypot(curve_I.c2.x - curve_I.c1.x, curve_I.c2.y - curve_I.c1.y) +
+			std::hypot(curve_I.p3.x - curve_I.c2.x, curve_I.p3.y - curve_I.c2.y);
+		const int steps = std::max(1, static_cast<int>(std::ceil(length / REPLAY_DEVIATION_STEP)));
+
+		points_O.clear();
+		for (int idx = 0; idx <= steps; idx++)
+		{
+			points_O.push_back(EvaluateCurve(curve_I, static_cast<double>(idx) / steps));
+		}
+	}
+
+	// Distance from p_I to the closest point of the polyline, and the width
+	// interpolated there.
+	double PolylineDistance(const std::vector<InkPoint> &line_I, const InkPoint &p_I, double &width_O)
+	{
+		double best = 1e300;
+		width_O = line_I.front().width;
+
+		for (size_t idx = 0; idx + 1 < line_I.size() || idx == 0; idx++)
+		{
+			const InkPoint &a = line_I[idx];
+			const InkPoint &b = idx + 1 < line_I.size() ? line_I[idx + 1] : a;
+
+			double t = 0.0;
+			const double dist = SegmentDistance(a, b, p_I.x, p_I.y, t);
+			if (dist < best)
+			{
+				best = dist;
+				width_O = a.width + t * (b.width - a.width);
+			}
+		}
+
+		return best;
+	}
+
+	struct Deviation
+	{
+		double	maxSample;		// raw sample to its curve
+		double	sumSample;
+		double	maxExcursion;	// curve to the raw samples it replaces
+		double	maxWidth;
+	};
+
+	// Measures how far the curves of one stroke are from its raw samples.
+	// Each curve ends exactly on a raw sample, which identifies the samples
+	// it replaced; those are compared against that curve alone, so loops
+	// where a stroke crosses itself cannot hide errors.
+	void MeasureStroke(const std::vector<InkPoint> &samples_I, const std::vector<InkCurve> &curves_I,
+		Deviation &deviation_IO)
+	{
+		std::vector<InkPoint> line;
+		size_t next = 0;
+
+		for (const InkCurve &curve : curves_I)
+		{
+			SampleCurve(curve, line);
+
+			// Samples from the curve's start up to and including its end.
+			size_t first = next > 0 ? next - 1 : 0;
+			size_t last = first;
+			while (last < samples_I.size() &&
+				!(samples_I[last].x == curve.p3.x && samples_I[last].y == curve.p3.y && samples_I[last].width == curve.p3.width))
+			{
+				last++;
+			}
+			last = std::min(last, samples_I.size() - 1);
+
+			for (size_t idx = next; idx <= last; idx++)
+			{
+				double width = 0.0;
+				const double distance = PolylineDistance(line, samples_I[idx], width);
+				deviation_IO.maxSample = std::max(deviation_IO.maxSample, distance);
+				deviation_IO.sumSample += distance;
+				deviation_IO.maxWidth = std::max(deviation_IO.maxWidth, std::fabs(width - samples_I[idx].width));
+			}
+
+			// Excursion of the curve away from the sample polyline.
+			for (const InkPoint &point : line)
+			{
+				double best = 1e300;
+				for (size_t idx = first; idx <= last; idx++)
+				{
+					double t = 0.0;
+					const InkPoint &b = idx + 1 <= last ? samples_I[idx + 1] : samples_I[idx];
+					best = std::min(best, SegmentDistance(samples_I[idx], b, point.x, point.y, t));
+				}
+				deviation_IO.maxExcursion = std::max(deviation_IO.maxExcursion, best);
+			}
+
+			next = last + 1;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Feeds every stroke of the session to the stroke fitter one sample at
+//		a time, as kiosk mode does, and reports for each tolerance:
+//		- point reduction: raw samples / stored curve end points,
+//		- storage ratio: raw sample bytes / curve bytes (3 points per curve
+//		  plus the first point of each stroke),
+//		- fitting throughput in samples per second,
+//		- maximum and mean distance of the raw samples from the curves,
+//		- maximum distance of the curves from the raw sample polyline, which
+//		  shows overshoot between samples, and
+//		- the maximum width deviation.
+//
+void RunStrokeFitBenchmark(const char *logPath_I)
+{
+	PacketLogHeader header;
+	std::vector<PacketRecord> records;
+	std::string description;
+
+	if (!LoadSession(logPath_I, header, records, description))
+	{
+		return;
+	}
+
+	std::vector<std::vector<InkPoint>> strokes;
+	SessionStrokes(header, records, strokes);
+
+	size_t samples = 0;
+	for (const auto &stroke : strokes)
+	{
+		samples += stroke.size();
+	}
+
+	LARGE_INTEGER freq = { 0 };
+	QueryPerformanceFrequency(&freq);
+
+	std::stringstream report;
+	report.precision(3);
+	report << "Session: " << description << "\n";
+	report << "Strokes: " << strokes.size() << ", samples: " << samples << "\n";
+
+	for (double tolerance : kFitTolerances)
+	{
+		StrokeFitter fitter(tolerance);
+		std::vector<std::vector<InkCurve>> fitted(strokes.size());
+
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+
+		for (size_t idx = 0; idx < strokes.size(); idx++)
+		{
+			fitter.Begin();
+			for (const InkPoint &point : strokes[idx])
+			{
+				fitter.AddPoint(point);
+			}
+			fitter.End();
+			fitted[idx] = fitter.TakeCurves();
+		}
+
+		QueryPerformanceCounter(&end);
+		const double fitMs = ElapsedMs(start, end, freq);
+
+		// Deviation of every raw sample from its fitted stroke.
+		size_t curves = 0;
+		Deviation deviation = Deviation();
+
+		for (size_t idx = 0; idx < strokes.size(); idx++)
+		{
+			curves += fitted[idx].size();
+			MeasureStroke(strokes[idx], fitted[idx], deviation);
+		}
+
+		const size_t storedPoints = curves + strokes.size();
+		const size_t rawBytes = samples * sizeof(InkPoint);
+		const size_t curveBytes = (3 * curves + strokes.size()) * sizeof(InkPoint);
+
+		report << "Tolerance " << tolerance << " px: "
+			<< curves << " curves, point reduction " << static_cast<double>(samples) / std::max<size_t>(1, storedPoints) << "x"
+			<< ", storage " << static_cast<double>(rawBytes) / std::max<size_t>(1, curveBytes) << "x"
+			<< ", " << samples / std::max(1e-6, fitMs / 1000.0) / 1e6 << " M samples/s"
+			<< ", sample deviation max " << deviation.maxSample << " px, mean " << deviation.sumSample / std::max<size_t>(1, samples) << " px"
+			<< ", curve excursion max " << deviation.maxExcursion << " px"
+			<< ", width max " << deviation.maxWidth << " px\n";
+	}
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Stroke Fit Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Replays every stroke packet by packet.  After each packet the
+//		predictor guesses the pen state aheadMs later, which is compared to
+//		the real state then (interpolated between the recorded packets):
+//		- lag: distance from the newest packet to the real position, ie: the
+//		  gap visible without prediction,
+//		- error: distance from the prediction to the real position,
+//		- pressure error, as a percentage of the maximum pressure,
+//		- coverage: share of packets for which a prediction was made.
+//		Predictions past the end of a stroke are not scored.
+//
+void RunPredictionBenchmark(const char *logPath_I)
+{
+	PacketLogHeader header;
+	std::vector<PacketRecord> records;
+	std::string description;
+
+	if (!LoadSession(logPath_I, header, records, description))
+	{
+		return;
+	}
+
+	// Strokes as runs of packets with pressure.
+	std::vector<std::vector<PenSample>> strokes;
+	bool down = false;
+	for (const PacketRecord &record : records)
+	{
+		if (record.pressure == 0)
+		{
+			down = false;
+			continue;
+		}
+
+		if (!down)
+		{
+			strokes.push_back(std::vector<PenSample>());
+			down = true;
+		}
+
+		PenSample sample;
+		PacketToPixels(header, record, sample.x, sample.y);
+		sample.pressure = record.pressure;
+		sample.time = record.time;
+		strokes.back().push_back(sample);
+	}
+
+	const double maxPressure = header.maxPressure ? header.maxPressure : 1.0;
+
+	std::stringstream report;
+	report.precision(3);
+	report << "Session: " << description << "\n";
+	report << "Strokes: " << strokes.size() << "\n";
+
+	for (double ahead : kPredictAheadMs)
+	{
+		for (double weight : kPredictAccelWeights)
+		{
+			std::vector<double> lags;
+			std::vector<double> errors;
+			double pressureError = 0.0;
+			size_t packets = 0;
+
+			InkPredictor predictor;
+			predictor.SetAccelerationWeight(weight);
+
+			for (const std::vector<PenSample> &stroke : strokes)
+			{
+				predictor.Reset();
+				size_t next = 0;
+
+				for (size_t idx = 0; idx < stroke.size(); idx++)
+				{
+					predictor.AddSample(stroke[idx]);
+
+					// Real state at the predicted time.
+					const double target = stroke[idx].time + ahead;
+					next = std::max(next, idx + 1);
+					while (next < stroke.size() && stroke[next].time < target)
+					{
+						next++;
+					}
+					if (next >= stroke.size())
+					{
+						break;
+					}
+
+					const PenSample &a = stroke[next - 1];
+					const PenSample &b = stroke[next];
+					const double dt = static_cast<double>(b.time) - a.time;
+					const double u = dt > 0.0 ? std::min(1.0, std::max(0.0, (target - a.time) / dt)) : 1.0;
+					const double realX = a.x + u * (b.x - a.x);
+					const double realY = a.y + u * (b.y - a.y);
+					const double realP = a.pressure + u * (b.pressure - a.pressure);
+
+					const double lag = std::hypot(realX - stroke[idx].x, realY - stroke[idx].y);
+					lags.push_back(lag);
+					packets++;
+
+					PenSample predicted;
+					if (predictor.Predict(ahead, predicted))
+					{
+						errors.push_back(std::hypot(realX - predicted.x, realY - predicted.y));
+						pressureError += std::fabs(realP - predicted.pressure);
+					}
+				}
+			}
+
+			if (lags.empty())
+			{
+				continue;
+			}
+
+			std::sort(lags.begin(), lags.end());
+			std::sort(errors.begin(), errors.end());
+
+			double lagSum = 0.0, errorSum = 0.0;
+			for (double lag : lags)
+			{
+				lagSum += lag;
+			}
+			for (double error : errors)
+			{
+				errorSum += error;
+			}
+
+			const size_t predicted = std::max<size_t>(1, errors.size());
+			report << "Ahead " << ahead << " ms, accel " << weight << ": lag mean " << lagSum / lags.size()
+				<< " px, p95 " << lags[lags.size() * 95 / 100]
+				<< " | error mean " << errorSum / predicted
+				<< " px, p95 " << (errors.empty() ? 0.0 : errors[errors.size() * 95 / 100])
+				<< ", max " << (errors.empty() ? 0.0 : errors.back())
+				<< " | pressure " << 100.0 * pressureError / predicted / maxPressure << "%"
+				<< " | coverage " << 100.0 * errors.size() / packets << "%\n";
+		}
+	}
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Ink Prediction Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Replays the session through the jitter filter in WT_PACKET sized
+//		batches and compares the output with the raw packets:
+//		- jitter: RMS second difference of the position while the pen is
+//		  still, where sensor noise is all that moves it,
+//		- lag: how far behind the raw packets the output runs while the pen
+//		  moves, in ms along the direction of travel,
+//		- tip-downs, and speckles (contacts shorter than
+//		  REPLAY_SPECKLE_PACKETS packets), and
+//		- contact packets dropped: packets with raw pressure above the
+//		  default contact threshold that the filter reports as lifted.
+//		The pen speed used to tell still from moving is taken from the raw
+//		packets over a window of +/-4 packets.
+//
+void RunPenFilterBenchmark(const char *logPath_I)
+{
+	PacketLogHeader header;
+	std::vector<PacketRecord> records;
+	std::string description;
+
+	if (!LoadSession(logPath_I, header, records, description))
+	{
+		return;
+	}
+
+	const size_t count = records.size();
+	std::vector<PenFilterSample> raw(count);
+	for (size_t idx = 0; idx < count; idx++)
+	{
+		PacketToPixels(header, records[idx], raw[idx].x, raw[idx].y);
+		raw[idx].pressure = records[idx].pressure;
+		raw[idx].time = records[idx].time;
+	}
+
+	// Raw velocity (pixels per second), for still/moving classification
+	// and the lag direction.
+	const size_t window = 4;
+	std::vector<double> vx(count, 0.0), vy(count, 0.0);
+	std::vector<DWORD> intervals;
+	for (size_t idx = window; idx + window < count; idx++)
+	{
+		const double dt = (static_cast<double>(raw[idx + window].time) - raw[idx - window].time) / 1000.0;
+		if (dt > 0.0)
+		{
+			vx[idx] = (raw[idx + window].x - raw[idx - window].x) / dt;
+			vy[idx] = (raw[idx + window].y - raw[idx - window].y) / dt;
+		}
+		intervals.push_back(raw[idx].time - raw[idx - 1].time);
+	}
+
+	double packetMs = 0.0;
+	if (!intervals.empty())
+	{
+		std::nth_element(intervals.begin(), intervals.begin() + intervals.size() / 2, intervals.end());
+		packetMs = intervals[intervals.size() / 2];
+	}
+
+	std::stringstream report;
+	report.precision(3);
+	report << "Session: " << description << "\n";
+	report << "Packet interval: " << packetMs << " ms\n";
+
+	const size_t settings = sizeof(kFilterSettings) / sizeof(kFilterSettings[0]);
+	for (size_t setting = 0; setting <= settings; setting++)
+	{
+		PenFilterParams params;
+		params.enabled = setting > 0;
+		if (setting > 0)
+		{
+			params.minCutoff = kFilterSettings[setting - 1][0];
+			params.beta = kFilterSettings[setting - 1][1];
+		}
+
+		PenFilter filter;
+		filter.SetParams(params);
+		filter.SetMaxPressure(header.maxPressure);
+
+		std::vector<PenFilterSample> out = raw;
+
+		LARGE_INTEGER freq = { 0 }, start, end;
+		QueryPerformanceFrequency(&freq);
+		QueryPerformanceCounter(&start);
+
+		for (size_t idx = 0; idx < count; idx += REPLAY_FILTER_BATCH)
+		{
+			filter.FilterBatch(&out[idx], std::min<size_t>(REPLAY_FILTER_BATCH, count - idx));
+		}
+
+		QueryPerformanceCounter(&end);
+		const double filterMs = ElapsedMs(start, end, freq);
+
+		// Position jitter and lag.
+		double jitterSum = 0.0;
+		size_t jitterCount = 0;
+		std::vector<double> lags;
+
+		for (size_t idx = 2 * window; idx + 2 * window < count; idx++)
+		{
+			const double speed2 = vx[idx] * vx[idx] + vy[idx] * vy[idx];
+
+			if (IsStill(vx, vy, idx, window))
+			{
+				const double ax = out[idx - 1].x - 2.0 * out[idx].x + out[idx + 1].x;
+				const double ay = out[idx - 1].y - 2.0 * out[idx].y + out[idx + 1].y;
+				jitterSum += ax * ax + ay * ay;
+				jitterCount++;
+			}
+			else if (raw[idx].pressure > 0 && speed2 >= REPLAY_STILL_SPEED * REPLAY_STILL_SPEED)
+			{
+				const double behind = (raw[idx].x - out[idx].x) * vx[idx] + (raw[idx].y - out[idx].y) * vy[idx];
+				lags.push_back(1000.0 * behind / speed2);
+			}
+		}
+
+		// Contacts, and packets of clear contact that were dropped.
+		const double onPressure = PEN_FILTER_PRESSURE_ON * header.maxPressure;
+		size_t tipDowns = 0, speckles = 0, run = 0, missed = 0, contact = 0;
+
+		for (size_t idx = 0; idx < count; idx++)
+		{
+			if (raw[idx].pressure >= onPressure)
+			{
+				contact++;
+				missed += out[idx].pressure == 0;
+			}
+
+			if (out[idx].pressure > 0)
+			{
+				tipDowns += run++ == 0;
+			}
+			else if (run > 0)
+			{
+				speckles += run < REPLAY_SPECKLE_PACKETS;
+				run = 0;
+			}
+		}
+
+		double lagMean = 0.0, lagP95 = 0.0;
+		if (!lags.empty())
+		{
+			for (double lag : lags)
+			{
+				lagMean += lag;
+			}
+			lagMean /= lags.size();
+			std::nth_element(lags.begin(), lags.begin() + lags.size() * 95 / 100, lags.end());
+			lagP95 = lags[lags.size() * 95 / 100];
+		}
+
+		if (setting == 0)
+		{
+			report << "Unfiltered";
+		}
+		else
+		{
+			report << "Cutoff " << params.minCutoff << " Hz, beta " << params.beta;
+		}
+		report << ": jitter " << std::sqrt(jitterSum / std::max<size_t>(1, jitterCount)) << " px"
+			<< " | lag mean " << lagMean << " ms, p95 " << lagP95 << " ms"
+			<< " | tip-downs " << tipDowns << ", speckles " << speckles
+			<< ", contact packets dropped " << 100.0 * missed / std::max<size_t>(1, contact) << "%"
+			<< " | " << count / std::max(1e-6, filterMs / 1000.0) / 1e6 << " M packets/s\n";
+	}
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Jitter Filter Benchmark", MB_OK | MB_ICONINFORMATION);
+}
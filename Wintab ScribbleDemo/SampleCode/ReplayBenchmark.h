@@ -0,0 +1,35 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		ReplayBenchmark.h
+
+	PURPOSE
+		Offline benchmarks that replay a recorded packet session (see
+		PacketLog.h) through the ink processing stages.  Without a log a
+		synthetic session is used.  Results are traced and shown in a
+		message box.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+#pragma once
+
+#include <windows.h>
+
+// Length of the synthetic session used when no log is given.
+#define REPLAY_SYNTHETIC_SECONDS		60
+
+// /fitBenchmark [log]: point reduction, fitting throughput and deviation of
+// the stroke fitter at several tolerances.
+void RunStrokeFitBenchmark(const char *logPath_I);
+
+// /predictBenchmark [log]: error of the ink predictor against the lag it
+// hides, for look-aheads of 1 to 3 display frames.
+void RunPredictionBenchmark(const char *logPath_I);
+
+// /filterBenchmark [log]: jitter removed by the pen filter against the lag
+// it adds, and its effect on tip-down events.
+void RunPenFilterBenchmark(const char *logPath_I);
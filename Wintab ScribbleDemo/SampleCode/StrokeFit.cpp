@@ -0,0 +1,389 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		StrokeFit.cpp
+
+	PURPOSE
+		Online fitting of pen samples to piecewise cubic Bezier curves,
+		after Schneider, "An Algorithm for Automatically Fitting Digitized
+		Curves" (Graphics Gems, 1990).
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+
+#include "StrokeFit.h"
+#include <algorithm>
+#include <cmath>
+
+// Newton-Raphson re-parameterization passes tried before giving up on a fit.
+#define STROKE_FIT_REPARAM_PASSES		2
+
+// Fits this many times worse than the tolerance are not worth re-fitting.
+#define STROKE_FIT_REPARAM_LIMIT		4.0
+
+// Longest polyline a single curve flattens to.
+#define STROKE_FLATTEN_MAX_SEGMENTS		64
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	void Bernstein(double t_I, double &b0_O, double &b1_O, double &b2_O, double &b3_O)
+	{
+		const double s = 1.0 - t_I;
+		b0_O = s * s * s;
+		b1_O = 3.0 * s * s * t_I;
+		b2_O = 3.0 * s * t_I * t_I;
+		b3_O = t_I * t_I * t_I;
+	}
+
+	double Distance(double x0_I, double y0_I, double x1_I, double y1_I)
+	{
+		return std::sqrt((x1_I - x0_I) * (x1_I - x0_I) + (y1_I - y0_I) * (y1_I - y0_I));
+	}
+
+	// Unit vector from (x0, y0) towards (x1, y1); false if they coincide.
+	bool Direction(double x0_I, double y0_I, double x1_I, double y1_I, double &dx_O, double &dy_O)
+	{
+		const double len = Distance(x0_I, y0_I, x1_I, y1_I);
+		if (len < 1e-9)
+		{
+			return false;
+		}
+
+		dx_O = (x1_I - x0_I) / len;
+		dy_O = (y1_I - y0_I) / len;
+		return true;
+	}
+
+	// Moves t_I one Newton-Raphson step towards the curve point closest to p_I.
+	double Reparameterize(const InkCurve &curve_I, const InkPoint &p_I, double t_I)
+	{
+		const double s = 1.0 - t_I;
+
+		const InkPoint q = EvaluateCurve(curve_I, t_I);
+
+		// First and second derivatives of the x/y curve.
+		const double d1x = 3.0 * (s * s * (curve_I.c1.x - curve_I.p0.x) + 2.0 * s * t_I * (curve_I.c2.x - curve_I.c1.x) + t_I * t_I * (curve_I.p3.x - curve_I.c2.x));
+		const double d1y = 3.0 * (s * s * (curve_I.c1.y - curve_I.p0.y) + 2.0 * s * t_I * (curve_I.c2.y - curve_I.c1.y) + t_I * t_I * (curve_I.p3.y - curve_I.c2.y));
+		const double d2x = 6.0 * (s * (curve_I.c2.x - 2.0 * curve_I.c1.x + curve_I.p0.x) + t_I * (curve_I.p3.x - 2.0 * curve_I.c2.x + curve_I.c1.x));
+		const double d2y = 6.0 * (s * (curve_I.c2.y - 2.0 * curve_I.c1.y + curve_I.p0.y) + t_I * (curve_I.p3.y - 2.0 * curve_I.c2.y + curve_I.c1.y));
+
+		const double numerator = (q.x - p_I.x) * d1x + (q.y - p_I.y) * d1y;
+		const double denominator = d1x * d1x + d1y * d1y + (q.x - p_I.x) * d2x + (q.y - p_I.y) * d2y;
+
+		if (std::fabs(denominator) < 1e-12)
+		{
+			return t_I;
+		}
+
+		return std::min(1.0, std::max(0.0, t_I - numerator / denominator));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+InkPoint EvaluateCurve(const InkCurve &curve_I, double t_I)
+{
+	double b0, b1, b2, b3;
+	Bernstein(t_I, b0, b1, b2, b3);
+
+	InkPoint point;
+	point.x = b0 * curve_I.p0.x + b1 * curve_I.c1.x + b2 * curve_I.c2.x + b3 * curve_I.p3.x;
+	point.y = b0 * curve_I.p0.y + b1 * curve_I.c1.y + b2 * curve_I.c2.y + b3 * curve_I.p3.y;
+	point.width = b0 * curve_I.p0.width + b1 * curve_I.c1.width + b2 * curve_I.c2.width + b3 * curve_I.p3.width;
+	return point;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FlattenCurve(const InkCurve &curve_I, double step_I, std::vector<InkPoint> &points_IO)
+{
+	// The control polygon is never shorter than the curve.
+	const double length =
+		Distance(curve_I.p0.x, curve_I.p0.y, curve_I.c1.x, curve_I.c1.y) +
+		Distance(curve_I.c1.x, curve_I.c1.y, curve_I.c2.x, curve_I.c2.y) +
+		Distance(curve_I.c2.x, curve_I.c2.y, curve_I.p3.x, curve_I.p3.y);
+
+	const int segments = std::max(1, std::min(STROKE_FLATTEN_MAX_SEGMENTS, static_cast<int>(std::ceil(length / step_I))));
+
+	for (int idx = 1; idx <= segments; idx++)
+	{
+		points_IO.push_back(EvaluateCurve(curve_I, static_cast<double>(idx) / segments));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+StrokeFitter::StrokeFitter(double tolerance_I) :
+	mTolerance(tolerance_I),
+	mPending(),
+	mHasPending(false),
+	mHasTangent(false),
+	mTangentX(0.0),
+	mTangentY(0.0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void StrokeFitter::Begin(void)
+{
+	mSamples.clear();
+	mCurves.clear();
+	mHasPending = false;
+	mHasTangent = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<InkCurve> StrokeFitter::TakeCurves(void)
+{
+	std::vector<InkCurve> curves;
+	curves.swap(mCurves);
+	return curves;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Adds a sample to the pending curve.  If the longer run no longer fits,
+//		the previous fit (all samples but this one) is committed and the
+//		pending curve restarts at its end point.
+//
+void StrokeFitter::AddPoint(const InkPoint &point_I)
+{
+	// Drop repeated samples; they add nothing but weight to the fit.
+	if (!mSamples.empty() &&
+		 mSamples.back().x == point_I.x && mSamples.back().y == point_I.y && mSamples.back().width == point_I.width)
+	{
+		return;
+	}
+
+	mSamples.push_back(point_I);
+	const size_t count = mSamples.size();
+
+	if (count == 1)
+	{
+		return;
+	}
+
+	if (count == 2)
+	{
+		mPending = MakeLine(mSamples[0], mSamples[1]);
+		mHasPending = true;
+		return;
+	}
+
+	InkCurve curve;
+	if (count <= STROKE_FIT_MAX_SAMPLES && FitSamples(count, curve))
+	{
+		mPending = curve;
+		return;
+	}
+
+	// The previous fit covers every sample but the newest.
+	mCurves.push_back(mPending);
+	if (!Direction(mPending.c2.x, mPending.c2.y, mPending.p3.x, mPending.p3.y, mTangentX, mTangentY))
+	{
+		Direction(mPending.p0.x, mPending.p0.y, mPending.p3.x, mPending.p3.y, mTangentX, mTangentY);
+	}
+	mHasTangent = true;
+
+	InkPoint anchor = mSamples[count - 2];
+	mSamples.clear();
+	mSamples.push_back(anchor);
+	mHasPending = false;
+	AddPoint(point_I);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void StrokeFitter::End(void)
+{
+	if (mHasPending)
+	{
+		mCurves.push_back(mPending);
+	}
+	else if (mSamples.size() == 1 && mCurves.empty())
+	{
+		mCurves.push_back(MakeLine(mSamples[0], mSamples[0]));
+	}
+
+	mSamples.clear();
+	mHasPending = false;
+	mHasTangent = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+InkCurve StrokeFitter::MakeLine(const InkPoint &from_I, const InkPoint &to_I)
+{
+	InkCurve curve = InkCurve();
+	curve.p0 = from_I;
+	curve.p3 = to_I;
+
+	curve.c1.x = from_I.x + (to_I.x - from_I.x) / 3.0;
+	curve.c1.y = from_I.y + (to_I.y - from_I.y) / 3.0;
+	curve.c1.width = from_I.width + (to_I.width - from_I.width) / 3.0;
+	curve.c2.x = from_I.x + 2.0 * (to_I.x - from_I.x) / 3.0;
+	curve.c2.y = from_I.y + 2.0 * (to_I.y - from_I.y) / 3.0;
+	curve.c2.width = from_I.width + 2.0 * (to_I.width - from_I.width) / 3.0;
+	return curve;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Purpose
+//		Least squares fit of one cubic to the first count_I samples, with the
+//		end points fixed to the first and last sample and the end tangents
+//		fixed by the previous curve (start) and the last few samples (end).
+//		Returns false if a sample is further than the tolerance from the fit.
+//
+bool StrokeFitter::FitSamples(size_t count_I, InkCurve &curve_O)
+{
+	const InkPoint &first = mSamples[0];
+	const InkPoint &last = mSamples[count_I - 1];
+
+	// Chord length parameters.
+	std::vector<double> &params = mParams;
+	params.resize(count_I);
+	params[0] = 0.0;
+	for (size_t idx = 1; idx < count_I; idx++)
+	{
+		params[idx] = params[idx - 1] + Distance(mSamples[idx - 1].x, mSamples[idx - 1].y, mSamples[idx].x, mSamples[idx].y);
+	}
+
+	const double chord = params[count_I - 1];
+	if (chord < 1e-9)
+	{
+		return false;
+	}
+
+	for (size_t idx = 1; idx < count_I; idx++)
+	{
+		params[idx] /= chord;
+	}
+
+	// End tangents, estimated over a couple of samples to resist noise.
+	const size_t reach = std::min<size_t>(2, count_I - 1);
+	double t1x = 0.0, t1y = 0.0, t2x = 0.0, t2y = 0.0;
+
+	if (mHasTangent)
+	{
+		t1x = mTangentX;
+		t1y = mTangentY;
+	}
+	else if (!Direction(first.x, first.y, mSamples[reach].x, mSamples[reach].y, t1x, t1y))
+	{
+		Direction(first.x, first.y, last.x, last.y, t1x, t1y);
+	}
+
+	if (!Direction(last.x, last.y, mSamples[count_I - 1 - reach].x, mSamples[count_I - 1 - reach].y, t2x, t2y))
+	{
+		Direction(last.x, last.y, first.x, first.y, t2x, t2y);
+	}
+
+	curve_O = InkCurve();
+	curve_O.p0 = first;
+	curve_O.p3 = last;
+
+	for (int pass = 0; pass <= STROKE_FIT_REPARAM_PASSES; pass++)
+	{
+		// Solve for the tangent lengths a1, a2 (x/y) and the inner widths.
+		double c00 = 0.0, c01 = 0.0, c11 = 0.0, x0 = 0.0, x1 = 0.0;
+		double w00 = 0.0, w01 = 0.0, w11 = 0.0, wx0 = 0.0, wx1 = 0.0;
+
+		for (size_t idx = 0; idx < count_I; idx++)
+		{
+			double b0, b1, b2, b3;
+			Bernstein(params[idx], b0, b1, b2, b3);
+
+			const double a1x = t1x * b1, a1y = t1y * b1;
+			const double a2x = t2x * b2, a2y = t2y * b2;
+			const double rx = mSamples[idx].x - (first.x * (b0 + b1) + last.x * (b2 + b3));
+			const double ry = mSamples[idx].y - (first.y * (b0 + b1) + last.y * (b2 + b3));
+
+			c00 += a1x * a1x + a1y * a1y;
+			c01 += a1x * a2x + a1y * a2y;
+			c11 += a2x * a2x + a2y * a2y;
+			x0 += a1x * rx + a1y * ry;
+			x1 += a2x * rx + a2y * ry;
+
+			const double rw = mSamples[idx].width - (first.width * b0 + last.width * b3);
+			w00 += b1 * b1;
+			w01 += b1 * b2;
+			w11 += b2 * b2;
+			wx0 += b1 * rw;
+			wx1 += b2 * rw;
+		}
+
+		const double span = Distance(first.x, first.y, last.x, last.y);
+		double alpha1 = span / 3.0;
+		double alpha2 = span / 3.0;
+
+		const double det = c00 * c11 - c01 * c01;
+		if (std::fabs(det) > 1e-12)
+		{
+			const double a1 = (x0 * c11 - x1 * c01) / det;
+			const double a2 = (c00 * x1 - c01 * x0) / det;
+
+			// Negative or vanishing lengths mean the tangents do not suit the
+			// samples, and lengths beyond the sampled path length make the
+			// curve overshoot between samples; either way fall back to
+			// Schneider's heuristic.
+			if (a1 > 1e-6 * chord && a2 > 1e-6 * chord && a1 < chord && a2 < chord)
+			{
+				alpha1 = a1;
+				alpha2 = a2;
+			}
+		}
+
+		curve_O.c1.x = first.x + t1x * alpha1;
+		curve_O.c1.y = first.y + t1y * alpha1;
+		curve_O.c2.x = last.x + t2x * alpha2;
+		curve_O.c2.y = last.y + t2y * alpha2;
+
+		const double wdet = w00 * w11 - w01 * w01;
+		if (std::fabs(wdet) > 1e-12)
+		{
+			curve_O.c1.width = (wx0 * w11 - wx1 * w01) / wdet;
+			curve_O.c2.width = (w00 * wx1 - w01 * wx0) / wdet;
+		}
+		else
+		{
+			curve_O.c1.width = first.width + (last.width - first.width) / 3.0;
+			curve_O.c2.width = first.width + 2.0 * (last.width - first.width) / 3.0;
+		}
+
+		// Largest deviation in position or width.
+		double error = 0.0;
+		for (size_t idx = 1; idx + 1 < count_I; idx++)
+		{
+			const InkPoint q = EvaluateCurve(curve_O, params[idx]);
+			error = std::max(error, Distance(q.x, q.y, mSamples[idx].x, mSamples[idx].y));
+			error = std::max(error, std::fabs(q.width - mSamples[idx].width));
+		}
+
+		curve_O.error = error;
+		if (error <= mTolerance)
+		{
+			return true;
+		}
+
+		if (error > STROKE_FIT_REPARAM_LIMIT * mTolerance)
+		{
+			return false;
+		}
+
+		for (size_t idx = 1; idx + 1 < count_I; idx++)
+		{
+			params[idx] = Reparameterize(curve_O, mSamples[idx], params[idx]);
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,99 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		StrokeFit.h
+
+	PURPOSE
+		Online fitting of pen samples to piecewise cubic Bezier curves.
+
+		Samples are fitted as they arrive.  The fitter keeps one pending curve
+		through the samples since the last committed curve and re-fits it with
+		every new sample; when the fit exceeds the tolerance the pending curve
+		is committed and a new one starts at its end point, tangent continuous
+		with it.  Width (pressure) is fitted along the curve as a fourth
+		coordinate, so it is interpolated smoothly between the end points.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Default maximum distance, in pixels, between a sample and its curve.
+#define STROKE_FIT_DEFAULT_TOLERANCE	0.75
+
+// Longest run of samples fitted by one curve.  Bounds the per-sample cost.
+#define STROKE_FIT_MAX_SAMPLES			64
+
+// Curves are flattened into segments about this long (pixels) for drawing.
+#define STROKE_FLATTEN_STEP				3.0
+
+///////////////////////////////////////////////////////////////////////////////
+// One pen sample, in document coordinates (canvas pixels at zoom 1).
+//
+struct InkPoint
+{
+	double	x;
+	double	y;
+	double	width;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Cubic Bezier in (x, y, width).  Consecutive curves of a stroke share
+// end points.
+//
+struct InkCurve
+{
+	InkPoint	p0;
+	InkPoint	c1;
+	InkPoint	c2;
+	InkPoint	p3;
+	double	error;		// largest sample distance seen by the fit
+};
+
+InkPoint EvaluateCurve(const InkCurve &curve_I, double t_I);
+
+// Appends the curve as a polyline to points_IO, excluding p0; step_I is the
+// target segment length in the same units as the curve.
+void FlattenCurve(const InkCurve &curve_I, double step_I, std::vector<InkPoint> &points_IO);
+
+///////////////////////////////////////////////////////////////////////////////
+
+class StrokeFitter
+{
+public:
+	explicit StrokeFitter(double tolerance_I = STROKE_FIT_DEFAULT_TOLERANCE);
+
+	void SetTolerance(double tolerance_I) { mTolerance = tolerance_I; }
+	double Tolerance(void) const { return mTolerance; }
+
+	// Starts a new stroke, discarding any curves not yet taken.
+	void Begin(void);
+	void AddPoint(const InkPoint &point_I);
+
+	// Commits the pending curve.  A single sample becomes a zero length curve.
+	void End(void);
+
+	// Curves committed since Begin.
+	const std::vector<InkCurve> &Curves(void) const { return mCurves; }
+	std::vector<InkCurve> TakeCurves(void);
+
+private:
+	bool FitSamples(size_t count_I, InkCurve &curve_O);
+	static InkCurve MakeLine(const InkPoint &from_I, const InkPoint &to_I);
+
+	double						mTolerance;
+	std::vector<InkPoint>	mSamples;		// since the last committed curve
+	std::vector<double>		mParams;			// scratch, chord length parameters
+	InkCurve						mPending;
+	bool							mHasPending;		// mPending fits all but the newest sample
+	bool							mHasTangent;
+	double						mTangentX;		// end tangent of the last committed curve
+	double						mTangentY;
+	std::vector<InkCurve>	mCurves;
+};
@@ -0,0 +1,706 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		TiledCanvas.cpp
+
+	PURPOSE
+		Sparse, tiled ink canvas used by the kiosk display mode.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+
+#include "TiledCanvas.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////
+// Local helpers
+
+namespace
+{
+	// Run-length encodes tile pixels as (WORD count, DWORD value) pairs.
+	// Ink tiles are mostly background, so this typically shrinks a tile
+	// from 256KB to a few KB.
+	void PackPixels(const std::vector<DWORD> &pixels_I, std::vector<BYTE> &packed_O)
+	{
+		packed_O.clear();
+
+		size_t idx = 0;
+		while (idx < pixels_I.size())
+		{
+			DWORD value = pixels_I[idx];
+			WORD count = 1;
+			while (idx + count < pixels_I.size() && pixels_I[idx + count] == value && count < 0xFFFF)
+			{
+				count++;
+			}
+
+			BYTE run[sizeof(WORD) + sizeof(DWORD)];
+			memcpy(run, &count, sizeof(WORD));
+			memcpy(run + sizeof(WORD), &value, sizeof(DWORD));
+			packed_O.insert(packed_O.end(), run, run + sizeof(run));
+
+			idx += count;
+		}
+
+		packed_O.shrink_to_fit();
+	}
+
+	// Reverses PackPixels.
+	void UnpackPixels(const std::vector<BYTE> &packed_I, std::vector<DWORD> &pixels_O)
+	{
+		pixels_O.resize(CANVAS_TILE_SIZE * CANVAS_TILE_SIZE);
+
+		size_t out = 0;
+		for (size_t in = 0; in + sizeof(WORD) + sizeof(DWORD) <= packed_I.size(); in += sizeof(WORD) + sizeof(DWORD))
+		{
+			WORD count = 0;
+			DWORD value = 0;
+			memcpy(&count, &packed_I[in], sizeof(WORD));
+			memcpy(&value, &packed_I[in + sizeof(WORD)], sizeof(DWORD));
+
+			count = static_cast<WORD>(std::min<size_t>(count, pixels_O.size() - out));
+			std::fill_n(pixels_O.begin() + out, count, value);
+			out += count;
+		}
+
+		WACOM_ASSERT(out == pixels_O.size());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Converts a COLORREF (0x00BBGGRR) to a 32bpp DIB pixel (0x00RRGGBB).
+//
+DWORD TiledCanvas::ToPixel(COLORREF color_I)
+{
+	return (static_cast<DWORD>(GetRValue(color_I)) << 16) |
+			 (static_cast<DWORD>(GetGValue(color_I)) << 8) |
+			  static_cast<DWORD>(GetBValue(color_I));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::PackTile(const std::vector<DWORD> &pixels_I, std::vector<BYTE> &packed_O)
+{
+	PackPixels(pixels_I, packed_O);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TiledCanvas::TiledCanvas() :
+	mWidth(0),
+	mHeight(0),
+	mResidentBudget(CANVAS_DEFAULT_RESIDENT_BUDGET),
+	mCompressedBudget(CANVAS_DEFAULT_COMPRESSED_BUDGET),
+	mBackground(0x00FFFFFF),
+	mBackgroundRef(RGB(255, 255, 255)),
+	mSpillFile(nullptr),
+	mSpillEnd(0)
+{
+	mStats = CanvasStats();
+
+	mTileInfo = BITMAPINFO();
+	mTileInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	mTileInfo.bmiHeader.biWidth = CANVAS_TILE_SIZE;
+	mTileInfo.bmiHeader.biHeight = -CANVAS_TILE_SIZE;	// top-down
+	mTileInfo.bmiHeader.biPlanes = 1;
+	mTileInfo.bmiHeader.biBitCount = 32;
+	mTileInfo.bmiHeader.biCompression = BI_RGB;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TiledCanvas::~TiledCanvas()
+{
+	Clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::Init(LONG width_I, LONG height_I,
+	size_t residentBudget_I, size_t compressedBudget_I,
+	COLORREF background_I)
+{
+	Clear();
+
+	mWidth = width_I;
+	mHeight = height_I;
+
+	// Always allow at least a handful of resident tiles so that a single
+	// wide stroke segment never has to evict the tiles it is drawing into.
+	mResidentBudget = std::max<size_t>(residentBudget_I, 16 * CANVAS_TILE_BYTES);
+	mCompressedBudget = compressedBudget_I;
+	mBackgroundRef = background_I;
+	mBackground = ToPixel(background_I);
+
+	WacomTrace("TiledCanvas::Init: %i x %i, resident budget: %u KB, compressed budget: %u KB\n",
+		mWidth, mHeight, (UINT)(mResidentBudget / 1024), (UINT)(mCompressedBudget / 1024));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::Clear(void)
+{
+	mTiles.clear();
+	mLru.clear();
+	mColdList.clear();
+	mDirty.clear();
+
+	CloseSpillFile();
+
+	size_t peak = mStats.peakResidentBytes;
+	mStats = CanvasStats();
+	mStats.peakResidentBytes = peak;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+UINT64 TiledCanvas::TileKey(LONG tx_I, LONG ty_I)
+{
+	return (static_cast<UINT64>(static_cast<DWORD>(ty_I)) << 32) | static_cast<DWORD>(tx_I);
+}
+
+LONG TiledCanvas::KeyX(UINT64 key_I)
+{
+	return static_cast<LONG>(static_cast<DWORD>(key_I & 0xFFFFFFFF));
+}
+
+LONG TiledCanvas::KeyY(UINT64 key_I)
+{
+	return static_cast<LONG>(static_cast<DWORD>(key_I >> 32));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Returns a resident tile, allocating a background-filled one if no ink has
+// been drawn there yet.
+//
+TiledCanvas::Tile &TiledCanvas::AcquireTile(LONG tx_I, LONG ty_I)
+{
+	UINT64 key = TileKey(tx_I, ty_I);
+	auto it = mTiles.find(key);
+
+	if (it == mTiles.end())
+	{
+		Tile &tile = mTiles[key];
+		tile.state = ETileResident;
+		tile.pixels.assign(CANVAS_TILE_SIZE * CANVAS_TILE_SIZE, mBackground);
+		tile.fileOffset = 0;
+		tile.fileSize = 0;
+		tile.dirty = false;
+
+		mLru.push_front(key);
+		tile.lruPos = mLru.begin();
+
+		mStats.residentTiles++;
+		mStats.residentBytes += CANVAS_TILE_BYTES;
+		mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+		return tile;
+	}
+
+	MakeResident(key, it->second);
+	Touch(key, it->second);
+	return it->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Brings a compressed or spilled tile back into memory.
+//
+void TiledCanvas::MakeResident(UINT64 key_I, Tile &tile_I)
+{
+	if (tile_I.state == ETileResident)
+	{
+		return;
+	}
+
+	if (tile_I.state == ETileOnDisk)
+	{
+		tile_I.packed.resize(tile_I.fileSize);
+		bool ok = mSpillFile &&
+			_fseeki64(mSpillFile, tile_I.fileOffset, SEEK_SET) == 0 &&
+			fread(tile_I.packed.data(), 1, tile_I.fileSize, mSpillFile) == tile_I.fileSize;
+
+		if (!ok)
+		{
+			// Losing a tile is preferable to aborting the demo; start blank.
+			WacomTrace("TiledCanvas: could not reload tile [%i,%i] from spill file\n", KeyX(key_I), KeyY(key_I));
+			tile_I.packed.clear();
+		}
+
+		mStats.diskTiles--;
+		mStats.diskBytes -= tile_I.fileSize;
+		tile_I.fileSize = 0;
+	}
+	else
+	{
+		mColdList.erase(tile_I.lruPos);
+		mStats.compressedTiles--;
+		mStats.compressedBytes -= tile_I.packed.size();
+	}
+
+	if (tile_I.packed.empty())
+	{
+		tile_I.pixels.assign(CANVAS_TILE_SIZE * CANVAS_TILE_SIZE, mBackground);
+	}
+	else
+	{
+		UnpackPixels(tile_I.packed, tile_I.pixels);
+	}
+
+	tile_I.packed.clear();
+	tile_I.packed.shrink_to_fit();
+	tile_I.state = ETileResident;
+
+	mLru.push_front(key_I);
+	tile_I.lruPos = mLru.begin();
+
+	mStats.reloads++;
+	mStats.residentTiles++;
+	mStats.residentBytes += CANVAS_TILE_BYTES;
+	mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Removes a tile from whichever list holds it and from the counters.
+//
+void TiledCanvas::DiscardTile(UINT64 key_I)
+{
+	auto it = mTiles.find(key_I);
+	if (it == mTiles.end())
+	{
+		return;
+	}
+
+	Tile &tile = it->second;
+	switch (tile.state)
+	{
+		case ETileResident:
+		{
+			mLru.erase(tile.lruPos);
+			mStats.residentTiles--;
+			mStats.residentBytes -= CANVAS_TILE_BYTES;
+			break;
+		}
+		case ETileCompressed:
+		{
+			mColdList.erase(tile.lruPos);
+			mStats.compressedTiles--;
+			mStats.compressedBytes -= tile.packed.size();
+			break;
+		}
+		case ETileOnDisk:
+		{
+			mStats.diskTiles--;
+			mStats.diskBytes -= tile.fileSize;
+			break;
+		}
+	}
+
+	if (tile.dirty)
+	{
+		mDirty.erase(std::remove(mDirty.begin(), mDirty.end(), key_I), mDirty.end());
+	}
+
+	mTiles.erase(it);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::StoreTile(LONG tx_I, LONG ty_I, std::vector<DWORD> &&pixels_I)
+{
+	WACOM_ASSERT(pixels_I.size() == CANVAS_TILE_SIZE * CANVAS_TILE_SIZE);
+
+	UINT64 key = TileKey(tx_I, ty_I);
+	DiscardTile(key);
+
+	Tile &tile = mTiles[key];
+	tile.state = ETileResident;
+	tile.pixels = std::move(pixels_I);
+	tile.fileOffset = 0;
+	tile.fileSize = 0;
+	tile.dirty = false;
+
+	mLru.push_front(key);
+	tile.lruPos = mLru.begin();
+
+	mStats.residentTiles++;
+	mStats.residentBytes += CANVAS_TILE_BYTES;
+	mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+
+	EnforceBudgets();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::StoreCompressedTile(LONG tx_I, LONG ty_I, std::vector<BYTE> &&packed_I)
+{
+	UINT64 key = TileKey(tx_I, ty_I);
+	DiscardTile(key);
+
+	Tile &tile = mTiles[key];
+	tile.state = ETileCompressed;
+	tile.packed = std::move(packed_I);
+	tile.fileOffset = 0;
+	tile.fileSize = 0;
+	tile.dirty = false;
+
+	mColdList.push_front(key);
+	tile.lruPos = mColdList.begin();
+
+	mStats.compressedTiles++;
+	mStats.compressedBytes += tile.packed.size();
+
+	EnforceBudgets();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::Touch(UINT64 key_I, Tile &tile_I)
+{
+	if (tile_I.state == ETileResident && tile_I.lruPos != mLru.begin())
+	{
+		mLru.splice(mLru.begin(), mLru, tile_I.lruPos);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Compresses least recently used resident tiles until the resident budget is
+// met, then spills the coldest compressed tiles until the compressed budget
+// is met.  Dirty tiles are never evicted; they will be presented shortly.
+//
+void TiledCanvas::EnforceBudgets(void)
+{
+	auto it = mLru.end();
+	while (mStats.residentBytes > mResidentBudget && it != mLru.begin())
+	{
+		--it;
+		UINT64 key = *it;
+		Tile &tile = mTiles[key];
+
+		if (tile.dirty)
+		{
+			continue;
+		}
+
+		// CompressTile removes the tile from mLru; step past it first.
+		auto next = it;
+		++next;
+		CompressTile(key, tile);
+		it = next;
+	}
+
+	while (mStats.compressedBytes > mCompressedBudget && !mColdList.empty())
+	{
+		UINT64 key = mColdList.back();
+		SpillTile(key, mTiles[key]);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::CompressTile(UINT64 key_I, Tile &tile_I)
+{
+	WACOM_ASSERT(tile_I.state == ETileResident);
+
+	PackPixels(tile_I.pixels, tile_I.packed);
+	tile_I.pixels.clear();
+	tile_I.pixels.shrink_to_fit();
+	tile_I.state = ETileCompressed;
+
+	mLru.erase(tile_I.lruPos);
+	mColdList.push_front(key_I);
+	tile_I.lruPos = mColdList.begin();
+
+	mStats.compressions++;
+	mStats.residentTiles--;
+	mStats.residentBytes -= CANVAS_TILE_BYTES;
+	mStats.compressedTiles++;
+	mStats.compressedBytes += tile_I.packed.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::SpillTile(UINT64 key_I, Tile &tile_I)
+{
+	WACOM_ASSERT(tile_I.state == ETileCompressed);
+
+	mColdList.erase(tile_I.lruPos);
+	mStats.compressedTiles--;
+	mStats.compressedBytes -= tile_I.packed.size();
+
+	if (!OpenSpillFile() ||
+		_fseeki64(mSpillFile, mSpillEnd, SEEK_SET) != 0 ||
+		fwrite(tile_I.packed.data(), 1, tile_I.packed.size(), mSpillFile) != tile_I.packed.size())
+	{
+		// No room on disk; keep the tile compressed in memory instead.
+		WacomTrace("TiledCanvas: could not spill tile [%i,%i]\n", KeyX(key_I), KeyY(key_I));
+		mColdList.push_front(key_I);
+		tile_I.lruPos = mColdList.begin();
+		mStats.compressedTiles++;
+		mStats.compressedBytes += tile_I.packed.size();
+		mCompressedBudget = mStats.compressedBytes;
+		return;
+	}
+
+	// Spilled records are appended; space of reloaded tiles is reclaimed
+	// when the canvas is cleared.
+	tile_I.fileOffset = mSpillEnd;
+	tile_I.fileSize = tile_I.packed.size();
+	mSpillEnd += tile_I.fileSize;
+
+	tile_I.packed.clear();
+	tile_I.packed.shrink_to_fit();
+	tile_I.state = ETileOnDisk;
+
+	mStats.spills++;
+	mStats.diskTiles++;
+	mStats.diskBytes += tile_I.fileSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TiledCanvas::OpenSpillFile(void)
+{
+	if (mSpillFile)
+	{
+		return true;
+	}
+
+	char tempDir[MAX_PATH] = "";
+	char tempFile[MAX_PATH] = "";
+	if (!GetTempPathA(MAX_PATH, tempDir) || !GetTempFileNameA(tempDir, "ink", 0, tempFile))
+	{
+		return false;
+	}
+
+	mSpillPath = tempFile;
+	mSpillFile = fopen(mSpillPath.c_str(), "w+b");
+	mSpillEnd = 0;
+
+	WacomTrace("TiledCanvas: spilling cold tiles to %s\n", mSpillPath.c_str());
+	return mSpillFile != nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::CloseSpillFile(void)
+{
+	if (mSpillFile)
+	{
+		fclose(mSpillFile);
+		mSpillFile = nullptr;
+	}
+
+	if (!mSpillPath.empty())
+	{
+		DeleteFileA(mSpillPath.c_str());
+		mSpillPath.clear();
+	}
+
+	mSpillEnd = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::DrawSegment(double x0_I, double y0_I, double x1_I, double y1_I,
+	double width_I, COLORREF color_I)
+{
+	RECT tiles = { 0 };
+	if (!IsInitialized() || !SegmentTileRange(x0_I, y0_I, x1_I, y1_I, width_I, mWidth, mHeight, tiles))
+	{
+		return;
+	}
+
+	const DWORD pixel = ToPixel(color_I);
+
+	for (LONG ty = tiles.top; ty <= tiles.bottom; ty++)
+	{
+		for (LONG tx = tiles.left; tx <= tiles.right; tx++)
+		{
+			auto it = mTiles.find(TileKey(tx, ty));
+
+			// Only allocate a tile once ink actually lands in it.
+			if (it == mTiles.end() &&
+				!RasterizeSegment(nullptr, tx, ty, mWidth, mHeight, x0_I, y0_I, x1_I, y1_I, width_I, pixel))
+			{
+				continue;
+			}
+
+			Tile &tile = AcquireTile(tx, ty);
+			RasterizeSegment(tile.pixels.data(), tx, ty, mWidth, mHeight, x0_I, y0_I, x1_I, y1_I, width_I, pixel);
+
+			if (!tile.dirty)
+			{
+				tile.dirty = true;
+				mDirty.push_back(TileKey(tx, ty));
+			}
+		}
+	}
+
+	EnforceBudgets();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TiledCanvas::SegmentTileRange(double x0_I, double y0_I, double x1_I, double y1_I,
+	double width_I, LONG canvasWidth_I, LONG canvasHeight_I, RECT &tiles_O)
+{
+	const double radius = std::max(width_I * 0.5, CANVAS_MIN_RADIUS);
+
+	// Pixel bounds of the round-capped segment, clipped to the canvas.
+	LONG left   = std::max(0L, static_cast<LONG>(std::floor(std::min(x0_I, x1_I) - radius)));
+	LONG top    = std::max(0L, static_cast<LONG>(std::floor(std::min(y0_I, y1_I) - radius)));
+	LONG right  = std::min(canvasWidth_I - 1, static_cast<LONG>(std::ceil(std::max(x0_I, x1_I) + radius)));
+	LONG bottom = std::min(canvasHeight_I - 1, static_cast<LONG>(std::ceil(std::max(y0_I, y1_I) + radius)));
+
+	if (left > right || top > bottom)
+	{
+		return false;
+	}
+
+	tiles_O.left = left / CANVAS_TILE_SIZE;
+	tiles_O.top = top / CANVAS_TILE_SIZE;
+	tiles_O.right = right / CANVAS_TILE_SIZE;
+	tiles_O.bottom = bottom / CANVAS_TILE_SIZE;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TiledCanvas::RasterizeSegment(DWORD *pixels_IO, LONG tx_I, LONG ty_I,
+	LONG canvasWidth_I, LONG canvasHeight_I,
+	double x0_I, double y0_I, double x1_I, double y1_I,
+	double width_I, DWORD pixel_I)
+{
+	const double radius = std::max(width_I * 0.5, CANVAS_MIN_RADIUS);
+	const double r2 = radius * radius;
+
+	const LONG tileLeft = tx_I * CANVAS_TILE_SIZE;
+	const LONG tileTop = ty_I * CANVAS_TILE_SIZE;
+
+	// Segment bounds clipped to the tile and the canvas.
+	LONG left   = std::max(tileLeft, static_cast<LONG>(std::floor(std::min(x0_I, x1_I) - radius)));
+	LONG top    = std::max(tileTop, static_cast<LONG>(std::floor(std::min(y0_I, y1_I) - radius)));
+	LONG right  = std::min(std::min(canvasWidth_I, tileLeft + CANVAS_TILE_SIZE) - 1,
+		static_cast<LONG>(std::ceil(std::max(x0_I, x1_I) + radius)));
+	LONG bottom = std::min(std::min(canvasHeight_I, tileTop + CANVAS_TILE_SIZE) - 1,
+		static_cast<LONG>(std::ceil(std::max(y0_I, y1_I) + radius)));
+
+	const double dx = x1_I - x0_I;
+	const double dy = y1_I - y0_I;
+	const double len2 = dx * dx + dy * dy;
+	bool hit = false;
+
+	for (LONG py = std::max(0L, top); py <= bottom; py++)
+	{
+		const double cy = py + 0.5;
+
+		for (LONG px = std::max(0L, left); px <= right; px++)
+		{
+			const double cx = px + 0.5;
+
+			// Distance from the pixel center to the closest point on the segment.
+			double t = len2 > 0.0 ? ((cx - x0_I) * dx + (cy - y0_I) * dy) / len2 : 0.0;
+			t = std::min(1.0, std::max(0.0, t));
+			const double ex = x0_I + t * dx - cx;
+			const double ey = y0_I + t * dy - cy;
+
+			if (ex * ex + ey * ey <= r2)
+			{
+				if (!pixels_IO)
+				{
+					return true;
+				}
+
+				pixels_IO[(py - tileTop) * CANVAS_TILE_SIZE + (px - tileLeft)] = pixel_I;
+				hit = true;
+			}
+		}
+	}
+
+	return hit;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::BlitTile(HDC hdc_I, LONG tx_I, LONG ty_I, const DWORD *pixels_I)
+{
+	SetDIBitsToDevice(hdc_I,
+		tx_I * CANVAS_TILE_SIZE, ty_I * CANVAS_TILE_SIZE,
+		CANVAS_TILE_SIZE, CANVAS_TILE_SIZE,
+		0, 0, 0, CANVAS_TILE_SIZE,
+		pixels_I, &mTileInfo, DIB_RGB_COLORS);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t TiledCanvas::PresentDirty(HDC hdc_I)
+{
+	size_t presented = 0;
+
+	for (UINT64 key : mDirty)
+	{
+		auto it = mTiles.find(key);
+		if (it == mTiles.end())
+		{
+			continue;	// cleared since it was marked
+		}
+
+		Tile &tile = it->second;
+		MakeResident(key, tile);
+		BlitTile(hdc_I, KeyX(key), KeyY(key), tile.pixels.data());
+		tile.dirty = false;
+		presented++;
+	}
+
+	mDirty.clear();
+	mStats.tilesPresented += presented;
+
+	EnforceBudgets();
+	return presented;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TiledCanvas::PaintRect(HDC hdc_I, const RECT &rect_I)
+{
+	if (rect_I.right <= rect_I.left || rect_I.bottom <= rect_I.top)
+	{
+		return;
+	}
+
+	HBRUSH background = CreateSolidBrush(mBackgroundRef);
+
+	LONG txFirst = std::max(0L, rect_I.left) / CANVAS_TILE_SIZE;
+	LONG tyFirst = std::max(0L, rect_I.top) / CANVAS_TILE_SIZE;
+	LONG txLast = (rect_I.right - 1) / CANVAS_TILE_SIZE;
+	LONG tyLast = (rect_I.bottom - 1) / CANVAS_TILE_SIZE;
+
+	for (LONG ty = tyFirst; ty <= tyLast; ty++)
+	{
+		for (LONG tx = txFirst; tx <= txLast; tx++)
+		{
+			auto it = mTiles.find(TileKey(tx, ty));
+
+			if (it == mTiles.end())
+			{
+				RECT tileRect = { tx * CANVAS_TILE_SIZE, ty * CANVAS_TILE_SIZE,
+					(tx + 1) * CANVAS_TILE_SIZE, (ty + 1) * CANVAS_TILE_SIZE };
+				FillRect(hdc_I, &tileRect, background);
+				continue;
+			}
+
+			MakeResident(it->first, it->second);
+			Touch(it->first, it->second);
+			BlitTile(hdc_I, tx, ty, it->second.pixels.data());
+		}
+	}
+
+	DeleteObject(background);
+
+	EnforceBudgets();
+}
@@ -0,0 +1,176 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		TiledCanvas.h
+
+	PURPOSE
+		Sparse, tiled ink canvas used by the kiosk display mode.
+
+		Tiles are only allocated where ink has been drawn.  Resident tiles are
+		kept in an LRU list bounded by a memory budget; cold tiles are first
+		compressed in memory and then spilled to a temporary file.  Tiles
+		touched since the last presentation are tracked as dirty so that only
+		those tiles need to be copied to the window.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <string>
+#include <cstdio>
+
+// Width and height of one canvas tile, in pixels.
+#define CANVAS_TILE_SIZE		256
+
+// Bytes used by the pixels of one resident tile (32bpp).
+#define CANVAS_TILE_BYTES		(CANVAS_TILE_SIZE * CANVAS_TILE_SIZE * sizeof(DWORD))
+
+// Smallest pen radius rasterized, so that thin strokes stay connected.
+#define CANVAS_MIN_RADIUS		0.75
+
+// Default budgets used when none are given on the command line.
+#define CANVAS_DEFAULT_RESIDENT_BUDGET		(64 * 1024 * 1024)
+#define CANVAS_DEFAULT_COMPRESSED_BUDGET	(16 * 1024 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////
+// Counters describing the current memory use of a canvas.
+//
+struct CanvasStats
+{
+	size_t	residentTiles;
+	size_t	residentBytes;
+	size_t	peakResidentBytes;
+	size_t	compressedTiles;
+	size_t	compressedBytes;
+	size_t	diskTiles;
+	size_t	diskBytes;
+	size_t	compressions;
+	size_t	spills;
+	size_t	reloads;
+	size_t	tilesPresented;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Sparse tiled canvas with an LRU tile cache.
+//
+// All coordinates are canvas pixels.  The canvas origin maps to the client
+// origin of the window it is presented to.
+//
+class TiledCanvas
+{
+public:
+	TiledCanvas();
+	~TiledCanvas();
+
+	// Sets the virtual size and memory budgets and discards any ink.
+	void Init(LONG width_I, LONG height_I,
+		size_t residentBudget_I, size_t compressedBudget_I,
+		COLORREF background_I);
+
+	// Discards all tiles (resident, compressed and spilled).
+	void Clear(void);
+
+	// Rasterizes a round-capped line segment into every tile it touches.
+	void DrawSegment(double x0_I, double y0_I, double x1_I, double y1_I,
+		double width_I, COLORREF color_I);
+
+	// Copies the tiles touched since the last call to the DC and clears
+	// the dirty set.  Returns the number of tiles copied.
+	size_t PresentDirty(HDC hdc_I);
+
+	// Repaints every tile intersecting rect_I (client coordinates), filling
+	// unallocated tiles with the background color.  Used for WM_PAINT.
+	void PaintRect(HDC hdc_I, const RECT &rect_I);
+
+	// Replaces a tile with pixels rendered elsewhere (eg: by a raster job).
+	// The tile is resident and not dirty; callers invalidate the window.
+	void StoreTile(LONG tx_I, LONG ty_I, std::vector<DWORD> &&pixels_I);
+
+	// Replaces a tile with data already packed by PackTile.
+	void StoreCompressedTile(LONG tx_I, LONG ty_I, std::vector<BYTE> &&packed_I);
+
+	// Helpers shared with the raster jobs, which render tiles off-canvas.
+	static DWORD ToPixel(COLORREF color_I);
+	static void PackTile(const std::vector<DWORD> &pixels_I, std::vector<BYTE> &packed_O);
+
+	// Tile index range (inclusive) covered by a segment; false if the
+	// segment lies outside the canvas.
+	static bool SegmentTileRange(double x0_I, double y0_I, double x1_I, double y1_I,
+		double width_I, LONG canvasWidth_I, LONG canvasHeight_I, RECT &tiles_O);
+
+	// Writes pixel_I into the pixels of tile (tx_I, ty_I) whose centers lie
+	// within the round-capped segment.  With a null pixels_IO it only reports
+	// whether any pixel would be written.
+	static bool RasterizeSegment(DWORD *pixels_IO, LONG tx_I, LONG ty_I,
+		LONG canvasWidth_I, LONG canvasHeight_I,
+		double x0_I, double y0_I, double x1_I, double y1_I,
+		double width_I, DWORD pixel_I);
+
+	bool IsInitialized(void) const { return mWidth > 0 && mHeight > 0; }
+	LONG Width(void) const { return mWidth; }
+	LONG Height(void) const { return mHeight; }
+	size_t DirtyCount(void) const { return mDirty.size(); }
+	DWORD BackgroundPixel(void) const { return mBackground; }
+	const CanvasStats &Stats(void) const { return mStats; }
+
+private:
+	enum ETileState
+	{
+		ETileResident,
+		ETileCompressed,
+		ETileOnDisk
+	};
+
+	struct Tile
+	{
+		ETileState						state;
+		std::vector<DWORD>			pixels;		// ETileResident
+		std::vector<BYTE>				packed;		// ETileCompressed
+		long long						fileOffset;	// ETileOnDisk
+		size_t							fileSize;	// ETileOnDisk
+		bool								dirty;
+		std::list<UINT64>::iterator	lruPos;		// position in mLru or mColdList
+	};
+
+	static UINT64 TileKey(LONG tx_I, LONG ty_I);
+	static LONG KeyX(UINT64 key_I);
+	static LONG KeyY(UINT64 key_I);
+
+	Tile &AcquireTile(LONG tx_I, LONG ty_I);
+	void MakeResident(UINT64 key_I, Tile &tile_I);
+	void Touch(UINT64 key_I, Tile &tile_I);
+	void DiscardTile(UINT64 key_I);
+	void EnforceBudgets(void);
+	void CompressTile(UINT64 key_I, Tile &tile_I);
+	void SpillTile(UINT64 key_I, Tile &tile_I);
+	bool OpenSpillFile(void);
+	void CloseSpillFile(void);
+	void BlitTile(HDC hdc_I, LONG tx_I, LONG ty_I, const DWORD *pixels_I);
+
+	LONG										mWidth;
+	LONG										mHeight;
+	size_t									mResidentBudget;
+	size_t									mCompressedBudget;
+	DWORD										mBackground;		// 0x00RRGGBB (DIB order)
+	COLORREF									mBackgroundRef;
+
+	std::unordered_map<UINT64, Tile>	mTiles;
+	std::list<UINT64>						mLru;				// resident; most recent first
+	std::list<UINT64>						mColdList;		// compressed; most recent first
+	std::vector<UINT64>					mDirty;
+
+	std::string								mSpillPath;
+	FILE										*mSpillFile;
+	long long								mSpillEnd;
+
+	CanvasStats								mStats;
+	BITMAPINFO								mTileInfo;
+};
@@ -0,0 +1,185 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		WorkStealingPool.cpp
+
+	PURPOSE
+		Small work-stealing thread pool used to rasterize canvas tiles in
+		parallel.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+
+WorkStealingPool::WorkStealingPool(unsigned numThreads_I) :
+	mJob(nullptr),
+	mGeneration(0),
+	mRemaining(0),
+	mActive(0),
+	mQuit(false),
+	mSteals(0)
+{
+	unsigned numThreads = numThreads_I ? numThreads_I : std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned idx = 0; idx < numThreads; idx++)
+	{
+		mWorkers.push_back(std::unique_ptr<Worker>(new Worker()));
+	}
+
+	// Start threads only once every worker exists; they steal from each other.
+	for (unsigned idx = 0; idx < numThreads; idx++)
+	{
+		mWorkers[idx]->thread = std::thread(&WorkStealingPool::WorkerLoop, this, idx);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(mStateLock);
+		mQuit = true;
+	}
+	mWake.notify_all();
+
+	for (auto &worker : mWorkers)
+	{
+		worker->thread.join();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void WorkStealingPool::ParallelFor(size_t count_I, const std::function<void(size_t, unsigned)> &job_I)
+{
+	if (count_I == 0)
+	{
+		return;
+	}
+
+	// Seed each worker with a contiguous block so neighbouring tiles tend to
+	// stay on one core; stealing evens out the blocks that turn out heavier.
+	const size_t numWorkers = mWorkers.size();
+	for (size_t idx = 0; idx < numWorkers; idx++)
+	{
+		size_t first = count_I * idx / numWorkers;
+		size_t last = count_I * (idx + 1) / numWorkers;
+
+		std::lock_guard<std::mutex> guard(mWorkers[idx]->lock);
+		for (size_t job = first; job < last; job++)
+		{
+			mWorkers[idx]->jobs.push_back(job);
+		}
+	}
+
+	std::unique_lock<std::mutex> state(mStateLock);
+	mJob = &job_I;
+	mRemaining = count_I;
+	mGeneration++;
+	mWake.notify_all();
+
+	// Also wait for every worker holding this job to let go of it, so a slow
+	// worker can never run it against the next call's indices.
+	mDone.wait(state, [this] { return mRemaining == 0 && mActive == 0; });
+	mJob = nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool WorkStealingPool::PopLocal(unsigned index_I, size_t &job_O)
+{
+	Worker &worker = *mWorkers[index_I];
+	std::lock_guard<std::mutex> guard(worker.lock);
+
+	if (worker.jobs.empty())
+	{
+		return false;
+	}
+
+	job_O = worker.jobs.back();
+	worker.jobs.pop_back();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool WorkStealingPool::Steal(unsigned thief_I, size_t &job_O)
+{
+	const unsigned numWorkers = static_cast<unsigned>(mWorkers.size());
+
+	for (unsigned offset = 1; offset < numWorkers; offset++)
+	{
+		Worker &victim = *mWorkers[(thief_I + offset) % numWorkers];
+		std::lock_guard<std::mutex> guard(victim.lock);
+
+		if (!victim.jobs.empty())
+		{
+			// Take from the opposite end to the owner to limit contention.
+			job_O = victim.jobs.front();
+			victim.jobs.pop_front();
+			mSteals++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void WorkStealingPool::WorkerLoop(unsigned index_I)
+{
+	size_t seenGeneration = 0;
+
+	while (true)
+	{
+		const std::function<void(size_t, unsigned)> *job = nullptr;
+		{
+			std::unique_lock<std::mutex> state(mStateLock);
+			mWake.wait(state, [&] { return mQuit || mGeneration != seenGeneration; });
+
+			if (mQuit)
+			{
+				return;
+			}
+
+			seenGeneration = mGeneration;
+			job = mJob;
+
+			// Woke after that ParallelFor already returned; nothing to do.
+			if (!job)
+			{
+				continue;
+			}
+
+			mActive++;
+		}
+
+		size_t completed = 0;
+		size_t index = 0;
+		while (PopLocal(index_I, index) || Steal(index_I, index))
+		{
+			(*job)(index, index_I);
+			completed++;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(mStateLock);
+			mRemaining -= completed;
+			mActive--;
+			if (mRemaining == 0 && mActive == 0)
+			{
+				mDone.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,73 @@
+/*----------------------------------------------------------------------------s
+	NAME
+		WorkStealingPool.h
+
+	PURPOSE
+		Small work-stealing thread pool used to rasterize canvas tiles in
+		parallel.
+
+		Each worker owns a deque of job indices.  A worker pops work from the
+		back of its own deque and, when that runs dry, steals from the front
+		of the other workers' deques, so uneven tiles (dense ink next to empty
+		space) still keep every core busy.
+
+	COPYRIGHT
+		This file is Copyright (c) Wacom Company, Ltd. 2024 All Rights Reserved
+		with portions copyright 1991-1998 by LCS/Telegraphics.
+
+		The text and information contained in this file may be freely used,
+		copied, or distributed without compensation or licensing restrictions.
+---------------------------------------------------------------------------- */
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+
+class WorkStealingPool
+{
+public:
+	// numThreads_I == 0 uses one worker per hardware thread.
+	explicit WorkStealingPool(unsigned numThreads_I = 0);
+	~WorkStealingPool();
+
+	// Runs job_I(index, workerIndex) for every index in [0, count_I) and
+	// returns when all have completed.  The calling thread does not run jobs.
+	// Only one ParallelFor may be active at a time.
+	void ParallelFor(size_t count_I, const std::function<void(size_t, unsigned)> &job_I);
+
+	unsigned ThreadCount(void) const { return static_cast<unsigned>(mWorkers.size()); }
+
+	// Number of jobs taken from another worker's deque since construction.
+	size_t StealCount(void) const { return mSteals.load(); }
+
+private:
+	struct Worker
+	{
+		std::thread				thread;
+		std::mutex				lock;
+		std::deque<size_t>	jobs;
+	};
+
+	void WorkerLoop(unsigned index_I);
+	bool PopLocal(unsigned index_I, size_t &job_O);
+	bool Steal(unsigned thief_I, size_t &job_O);
+
+	std::vector<std::unique_ptr<Worker>>			mWorkers;
+
+	std::mutex											mStateLock;
+	std::condition_variable							mWake;
+	std::condition_variable							mDone;
+	const std::function<void(size_t, unsigned)>	*mJob;
+	size_t												mGeneration;
+	size_t												mRemaining;
+	size_t												mActive;		// workers holding mJob
+	bool													mQuit;
+
+	std::atomic<size_t>								mSteals;
+};
@@ -0,0 +1,341 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Implementation of the cache of tablet control properties.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "ControlCache.h"
+#include "Utils.h"
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+// Module-global variables
+
+// The cached extensions, in the order their controls are kept.
+static const UINT gCachedTags[CONTROL_CACHE_EXTENSIONS] = { WTX_EXPKEYS2, WTX_TOUCHRING, WTX_TOUCHSTRIP };
+
+////////////////////////////////////////////////////////////////////////////////
+
+ControlCache::ControlCache() :
+	mCtx(NULL),
+	mStats()
+{
+	for (int idx = 0; idx < CONTROL_CACHE_EXTENSIONS; ++idx)
+	{
+		mExtensions[idx] = Extension { gCachedTags[idx], false, 0, 0 };
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Find the index and packet mask of each cached extension.
+//	Parameters:
+//		none
+//	Return:
+//		none
+//	Notes:
+//		Not all versions of wintab support all extensions.  Extensions are defined by
+//		value and referenced by index, so one pass over the indices finds them all.
+//
+void ControlCache::FindExtensions(void)
+{
+	for (Extension &ext : mExtensions)
+	{
+		ext.found = false;
+		ext.mask = 0;
+	}
+
+	// Iterate through Wintab extension indices
+	UINT thisTag = 0;
+	for (UINT i = 0; ; ++i)
+	{
+		++mStats.infos;
+		if (!gpWTInfoA(WTI_EXTENSIONS + i, EXT_TAG, &thisTag))
+		{
+			break;
+		}
+
+		for (Extension &ext : mExtensions)
+		{
+			if (ext.tag == thisTag && !ext.found)
+			{
+				ext.found = true;
+				ext.index = i;
+				++mStats.infos;
+				gpWTInfoA(WTI_EXTENSIONS + i, EXT_MASK, &ext.mask);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ControlCache::HasExtension(UINT tag_I) const
+{
+	return FindExtension(tag_I) != nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+WTPKT ControlCache::ExtensionMask(UINT tag_I) const
+{
+	const Extension *ext = FindExtension(tag_I);
+	return ext ? ext->mask : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Bring the table up to date with the tablets Wintab knows.
+//	Parameters:
+//		changed_O - Receives the indices of the tablets read again or dropped
+//	Return:
+//		none
+//	Notes:
+//		A tablet whose control counts are unchanged costs one WTInfoA and one
+//		WTExtGet per extension.  Properties that fail to read count as zero, and
+//		show in the failures statistic.
+//
+void ControlCache::Refresh(std::vector<UINT> &changed_O)
+{
+	++mStats.refreshes;
+
+	std::vector<ControlFunction> functions;
+	functions.reserve(mFunctions.size());
+
+	UINT tablet = 0;
+	auto old = mFunctions.cbegin();
+	for (; tablet < CONTROL_CACHE_MAX_TABLETS; ++tablet)
+	{
+		// Wintab lists a default context for each tablet it has seen.
+		LOGCONTEXTA lcTemp = { 0 };
+		++mStats.infos;
+		if (!gpWTInfoA(WTI_DDCTXS + tablet, 0, &lcTemp))
+		{
+			break;
+		}
+
+		// Control and function elements are ignored for the count.  A tablet
+		// that is not attached has no controls to count, which is no failure.
+		TabletCounts counts = { true, { 0 } };
+		for (int idx = 0; idx < CONTROL_CACHE_EXTENSIONS; ++idx)
+		{
+			if (mExtensions[idx].found)
+			{
+				GetBytes(mExtensions[idx].tag, tablet, 0, 0, TABLET_PROPERTY_CONTROLCOUNT,
+					&counts.controls[idx], sizeof(UINT32), false);
+			}
+		}
+
+		const auto oldEnd = std::find_if(old, mFunctions.cend(),
+			[tablet](const ControlFunction &func_I) { return func_I.tablet != tablet; });
+
+		if (tablet < mCounts.size() && mCounts[tablet].known &&
+			std::equal(counts.controls, counts.controls + CONTROL_CACHE_EXTENSIONS, mCounts[tablet].controls))
+		{
+			functions.insert(functions.end(), old, oldEnd);
+		}
+		else
+		{
+			ReadTablet(tablet, counts, functions);
+			changed_O.push_back(tablet);
+			++mStats.tabletsRead;
+		}
+		old = oldEnd;
+
+		if (tablet >= mCounts.size())
+		{
+			mCounts.resize(tablet + 1, TabletCounts { false, { 0 } });
+		}
+		mCounts[tablet] = counts;
+	}
+
+	// Tablets no longer listed at all.
+	for (UINT gone = tablet; gone < mCounts.size(); ++gone)
+	{
+		if (mCounts[gone].known)
+		{
+			changed_O.push_back(gone);
+		}
+	}
+	mCounts.resize(std::min<size_t>(mCounts.size(), tablet));
+
+	mFunctions.swap(functions);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ControlCache::Set(UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I,
+							  const std::string &value_I)
+{
+	return SetBytes(ext_I, tablet_I, control_I, function_I, property_I, value_I.c_str(), value_I.length() + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ControlCache::Set(UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I,
+							  const std::vector<BYTE> &value_I)
+{
+	return SetBytes(ext_I, tablet_I, control_I, function_I, property_I, value_I.data(), value_I.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ControlCache::Clear(void)
+{
+	mCtx = NULL;
+	mFunctions.clear();
+	mCounts.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////
+
+const ControlCache::Extension *ControlCache::FindExtension(UINT tag_I) const
+{
+	for (const Extension &ext : mExtensions)
+	{
+		if (ext.tag == tag_I)
+		{
+			return ext.found ? &ext : nullptr;
+		}
+	}
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Fill in the scratch buffer for a property of dataSize_I bytes.
+//	Return:
+//		EXTPROPERTY* - the buffer, valid until the next call
+//
+EXTPROPERTY *ControlCache::Scratch(UINT tablet_I,
+											  UINT control_I,
+											  UINT function_I,
+											  WORD property_I,
+											  size_t dataSize_I)
+{
+	const size_t size = sizeof(EXTPROPERTY) + dataSize_I;
+	if (size > mScratch.size())
+	{
+		mScratch.resize(size);
+		++mStats.scratchGrowths;
+	}
+
+	EXTPROPERTY *prop = reinterpret_cast<EXTPROPERTY *>(mScratch.data());
+	prop->version = 0;
+	prop->tabletIndex = static_cast<BYTE>(tablet_I);
+	prop->controlIndex = static_cast<BYTE>(control_I);
+	prop->functionIndex = static_cast<BYTE>(function_I);
+	prop->propertyID = property_I;
+	prop->reserved = 0;
+	prop->dataSize = static_cast<DWORD>(dataSize_I);
+	return prop;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ControlCache::GetBytes(UINT ext_I,
+									 UINT tablet_I,
+									 UINT control_I,
+									 UINT function_I,
+									 WORD property_I,
+									 void *data_O,
+									 size_t size_I,
+									 bool countFailure_I)
+{
+	EXTPROPERTY *prop = Scratch(tablet_I, control_I, function_I, property_I, size_I);
+
+	++mStats.gets;
+	if (FALSE == gpWTExtGet(mCtx, ext_I, prop))
+	{
+		mStats.failures += countFailure_I ? 1 : 0;
+		return false;
+	}
+
+	memcpy(data_O, prop->data, size_I);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ControlCache::SetBytes(UINT ext_I,
+									 UINT tablet_I,
+									 UINT control_I,
+									 UINT function_I,
+									 WORD property_I,
+									 const void *data_I,
+									 size_t size_I)
+{
+	EXTPROPERTY *prop = Scratch(tablet_I, control_I, function_I, property_I, size_I);
+	memcpy(prop->data, data_I, size_I);
+
+	++mStats.sets;
+	if (FALSE == gpWTExtSet(mCtx, ext_I, prop))
+	{
+		++mStats.failures;
+		return false;
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Read every control and function of a tablet.
+//	Parameters:
+//		tablet_I - The index of the tablet
+//		counts_I - Its number of controls per extension
+//		functions_O - Receives the functions, in order
+//	Return:
+//		none
+//
+void ControlCache::ReadTablet(UINT tablet_I,
+										const TabletCounts &counts_I,
+										std::vector<ControlFunction> &functions_O)
+{
+	for (int idx = 0; idx < CONTROL_CACHE_EXTENSIONS; ++idx)
+	{
+		const UINT ext = mExtensions[idx].tag;
+		for (UINT control = 0; control < counts_I.controls[idx]; ++control)
+		{
+			ControlFunction func = { tablet_I, ext, control, 0, FALSE, 0, 0, 0, TABLET_ICON_FMT_NONE, 0, 0, false };
+
+			// The function element is ignored for the count.
+			UINT32 numFuncs = 0;
+			Get(ext, tablet_I, control, 0, TABLET_PROPERTY_FUNCCOUNT, numFuncs);
+			if (!numFuncs)
+			{
+				continue;
+			}
+
+			Get(ext, tablet_I, control, 0, TABLET_PROPERTY_LOCATION, func.location);
+			if (ext != WTX_EXPKEYS2)
+			{
+				Get(ext, tablet_I, control, 0, TABLET_PROPERTY_MIN, func.min);
+				Get(ext, tablet_I, control, 0, TABLET_PROPERTY_MAX, func.max);
+			}
+
+			// TABLET_ICON_FMT_NONE is returned if the control does not have a display
+			Get(ext, tablet_I, control, 0, TABLET_PROPERTY_ICON_FORMAT, func.iconFormat);
+			if (func.iconFormat != TABLET_ICON_FMT_NONE)
+			{
+				Get(ext, tablet_I, control, 0, TABLET_PROPERTY_ICON_WIDTH, func.iconWidth);
+				Get(ext, tablet_I, control, 0, TABLET_PROPERTY_ICON_HEIGHT, func.iconHeight);
+			}
+
+			for (UINT function = 0; function < numFuncs; ++function)
+			{
+				func.function = function;
+				func.available = FALSE;
+				Get(ext, tablet_I, control, function, TABLET_PROPERTY_AVAILABLE, func.available);
+				functions_O.push_back(func);
+			}
+		}
+	}
+}
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Declarations for the cache of tablet control properties.
+//
+//		Every WTExtGet is a round trip to the tablet service.  The cache
+//		reads the controls and functions of all tablets once, into a flat
+//		table, and reads them again only for tablets whose control counts
+//		changed, when Wintab sends WT_INFOCHANGE.  Property reads and writes
+//		go through one scratch buffer.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <wintab.h>
+
+#include <string>
+#include <vector>
+
+// Wintab remembers at most this many tablets.
+#define CONTROL_CACHE_MAX_TABLETS	16
+
+// The extensions cached: WTX_EXPKEYS2, WTX_TOUCHRING and WTX_TOUCHSTRIP.
+#define CONTROL_CACHE_EXTENSIONS		3
+
+///////////////////////////////////////////////////////////////////////////////
+// One function of a control.  Location, range and icon are properties of
+// the control, read once for all of its functions; ExpressKeys have no
+// range.
+//
+struct ControlFunction
+{
+	UINT		tablet;
+	UINT		extension;		// WTX_ tag
+	UINT		control;
+	UINT		function;
+	BOOL		available;
+	UINT32	location;
+	UINT32	min;
+	UINT32	max;
+	UINT32	iconFormat;
+	UINT32	iconWidth;
+	UINT32	iconHeight;
+	bool		overridden;		// by this application
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct ControlCacheStats
+{
+	unsigned long long	infos;			// WTInfoA calls
+	unsigned long long	gets;				// WTExtGet calls
+	unsigned long long	sets;				// WTExtSet calls
+	unsigned long long	failures;		// of gets and sets, absent tablets aside
+	unsigned long long	refreshes;
+	unsigned long long	tabletsRead;	// tablets whose controls were read again
+	unsigned long long	scratchGrowths;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class ControlCache
+{
+public:
+	ControlCache();
+
+	// Scans WTI_EXTENSIONS once for the cached extensions.  Needs no
+	// context.
+	void FindExtensions(void);
+	bool HasExtension(UINT tag_I) const;
+	WTPKT ExtensionMask(UINT tag_I) const;
+
+	void SetContext(HCTX ctx_I) { mCtx = ctx_I; }
+
+	// Reads the controls of the tablets that are new, or whose control
+	// counts changed, and drops those gone; adds their indices to
+	// changed_O.  The others keep their entries, overridden flags included.
+	void Refresh(std::vector<UINT> &changed_O);
+
+	// Ordered by tablet, extension, control and function.
+	std::vector<ControlFunction> &Functions(void) { return mFunctions; }
+	const std::vector<ControlFunction> &Functions(void) const { return mFunctions; }
+
+	// Reads or writes one property through the scratch buffer.  The type
+	// must be the property's.
+	template <typename T>
+	bool Get(UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I, T &value_O)
+	{
+		return GetBytes(ext_I, tablet_I, control_I, function_I, property_I, &value_O, sizeof(T));
+	}
+
+	template <typename T>
+	bool Set(UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I, const T &value_I)
+	{
+		return SetBytes(ext_I, tablet_I, control_I, function_I, property_I, &value_I, sizeof(T));
+	}
+
+	// Strings are written with their terminator.
+	bool Set(UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I, const std::string &value_I);
+	bool Set(UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I, const std::vector<BYTE> &value_I);
+
+	const ControlCacheStats &Stats(void) const { return mStats; }
+	void ResetStats(void) { mStats = ControlCacheStats(); }
+
+	// Forgets the tablets and the context; the extensions stay.
+	void Clear(void);
+
+private:
+	struct Extension
+	{
+		UINT			tag;
+		bool			found;
+		UINT			index;		// in WTI_EXTENSIONS
+		WTPKT			mask;
+	};
+
+	struct TabletCounts
+	{
+		bool			known;
+		UINT32		controls[CONTROL_CACHE_EXTENSIONS];
+	};
+
+	const Extension *FindExtension(UINT tag_I) const;
+	EXTPROPERTY *Scratch(UINT tablet_I, UINT control_I, UINT function_I, WORD property_I, size_t dataSize_I);
+	bool GetBytes(UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I, void *data_O, size_t size_I,
+		bool countFailure_I = true);
+	bool SetBytes(UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I, const void *data_I, size_t size_I);
+	void ReadTablet(UINT tablet_I, const TabletCounts &counts_I, std::vector<ControlFunction> &functions_O);
+
+	HCTX								mCtx;
+	Extension						mExtensions[CONTROL_CACHE_EXTENSIONS];
+	std::vector<ControlFunction>	mFunctions;
+	std::vector<TabletCounts>		mCounts;			// by tablet index
+	std::vector<BYTE>				mScratch;
+	ControlCacheStats				mStats;
+};
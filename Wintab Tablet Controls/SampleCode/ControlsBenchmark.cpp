@@ -0,0 +1,1246 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Benchmarks of this sample.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "ControlsBenchmark.h"
+#include "ControlCache.h"
+#include "Drawing.h"
+#include "IconPipeline.h"
+#include "IconScheduler.h"
+#include "SliderMotion.h"
+#include "Utils.h"
+#include "WintabStandIn/WintabStandIn.h"
+#if !defined(_WIN32)
+	#include "Win32StandIn/Win32StandIn.h"
+#endif
+#include <algorithm>
+#include <map>
+#include <memory>
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark parameters
+
+// Each timing is the best of this many runs.
+#define STARTUP_BENCH_RUNS		5
+
+// Images, each a layout's icon for some keys, and their size.
+#define ICON_BENCH_IMAGES		8
+#define ICON_BENCH_IMAGE_SIZE	256
+
+// Layouts, of a display per key of each tablet, and layout switches.
+#define ICON_BENCH_LAYOUTS		3
+#define ICON_BENCH_KEYS			8
+#define ICON_BENCH_TABLETS		3
+#define ICON_BENCH_SWITCHES	30
+
+// Runs of the conversion steps over an image.
+#define ICON_BENCH_KERNEL_RUNS	200
+
+// Simulated seconds of animated displays, and frames per second.
+#define STREAM_BENCH_SECONDS		10
+#define STREAM_BENCH_FPS			60
+
+// Frames between toggles of the recording indicator.
+#define STREAM_BENCH_TOGGLE		45
+
+// TouchRing packets of the scrub, and the size of the window painted.
+#define REPAINT_BENCH_PACKETS		2000
+#define REPAINT_BENCH_WIDTH		500
+#define REPAINT_BENCH_HEIGHT		400
+
+// Period of the coasting timer, and replays of the sessions per timing run.
+#define SLIDER_BENCH_COAST_MS		16
+#define SLIDER_BENCH_PASSES		100
+
+////////////////////////////////////////////////////////////////////////////////
+// Module-private types and functions
+
+namespace
+{
+	struct LegacyCalls
+	{
+		unsigned long long	infos;
+		unsigned long long	gets;
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+	// The extension lookup Tablet::Init made per extension.
+
+	bool LegacyFindExtension(UINT tagToMatch_I, UINT &index_O, LegacyCalls &calls_IO)
+	{
+		UINT thisTag = 0;
+		for (UINT i = 0; ; ++i)
+		{
+			++calls_IO.infos;
+			if (!gpWTInfoA(WTI_EXTENSIONS + i, EXT_TAG, &thisTag))
+			{
+				return false;
+			}
+			if (thisTag == tagToMatch_I)
+			{
+				index_O = i;
+				return true;
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// The property read Tablet::Init made, a buffer per call.
+
+	template <typename T>
+	T LegacyGet(HCTX ctx_I, UINT ext_I, UINT tablet_I, UINT control_I, UINT function_I, WORD property_I,
+		LegacyCalls &calls_IO)
+	{
+		T result = T();
+
+		std::unique_ptr<BYTE[]> buffer(new BYTE[sizeof(EXTPROPERTY) + sizeof(T)]);
+		EXTPROPERTY *prop = (EXTPROPERTY*)buffer.get();
+		prop->version = 0;
+		prop->tabletIndex = static_cast<BYTE>(tablet_I);
+		prop->controlIndex = static_cast<BYTE>(control_I);
+		prop->functionIndex = static_cast<BYTE>(function_I);
+		prop->propertyID = property_I;
+		prop->reserved = 0;
+		prop->dataSize = sizeof(T);
+
+		++calls_IO.gets;
+		if (gpWTExtGet(ctx_I, ext_I, prop))
+		{
+			result = *((T*)(&prop->data[0]));
+		}
+		return result;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Every read Tablet::Init made before the ControlCache: seven or nine per
+	// function, of each control, extension and tablet.
+
+	void LegacyEnumerate(HCTX ctx_I, std::vector<ControlFunction> &functions_O, LegacyCalls &calls_IO)
+	{
+		const UINT tags[CONTROL_CACHE_EXTENSIONS] = { WTX_EXPKEYS2, WTX_TOUCHRING, WTX_TOUCHSTRIP };
+
+		// Tablet::Init looked the extensions up ring, strip, keys.
+		for (const UINT tag : { WTX_TOUCHRING, WTX_TOUCHSTRIP, WTX_EXPKEYS2 })
+		{
+			UINT index = 0;
+			if (LegacyFindExtension(tag, index, calls_IO))
+			{
+				WTPKT mask = 0;
+				++calls_IO.infos;
+				gpWTInfoA(WTI_EXTENSIONS + index, EXT_MASK, &mask);
+			}
+		}
+
+		for (UINT tablet = 0; tablet < CONTROL_CACHE_MAX_TABLETS; ++tablet)
+		{
+			LOGCONTEXTA lcTemp = { 0 };
+			++calls_IO.infos;
+			if (!gpWTInfoA(WTI_DDCTXS + tablet, 0, &lcTemp))
+			{
+				break;
+			}
+
+			for (const UINT ext : tags)
+			{
+				const UINT32 numCtrls = LegacyGet<UINT32>(ctx_I, ext, tablet, 0, 0, TABLET_PROPERTY_CONTROLCOUNT, calls_IO);
+				for (UINT control = 0; control < numCtrls; ++control)
+				{
+					const UINT32 numFuncs = LegacyGet<UINT32>(ctx_I, ext, tablet, control, 0, TABLET_PROPERTY_FUNCCOUNT, calls_IO);
+					for (UINT function = 0; function < numFuncs; ++function)
+					{
+						ControlFunction func = { tablet, ext, control, function };
+						func.available = LegacyGet<BOOL>(ctx_I, ext, tablet, control, function, TABLET_PROPERTY_AVAILABLE, calls_IO);
+						func.location = LegacyGet<UINT32>(ctx_I, ext, tablet, control, function, TABLET_PROPERTY_LOCATION, calls_IO);
+						func.min = LegacyGet<UINT32>(ctx_I, ext, tablet, control, function, TABLET_PROPERTY_MIN, calls_IO);
+						func.max = LegacyGet<UINT32>(ctx_I, ext, tablet, control, function, TABLET_PROPERTY_MAX, calls_IO);
+						func.iconFormat = LegacyGet<UINT32>(ctx_I, ext, tablet, control, function, TABLET_PROPERTY_ICON_FORMAT, calls_IO);
+						if (func.iconFormat != TABLET_ICON_FMT_NONE)
+						{
+							func.iconWidth = LegacyGet<UINT32>(ctx_I, ext, tablet, control, function, TABLET_PROPERTY_ICON_WIDTH, calls_IO);
+							func.iconHeight = LegacyGet<UINT32>(ctx_I, ext, tablet, control, function, TABLET_PROPERTY_ICON_HEIGHT, calls_IO);
+						}
+						functions_O.push_back(func);
+					}
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Whether both reads found the same controls.  The cache has no range
+	// for ExpressKeys, which the drawing code ignores.
+
+	bool SameFunctions(const std::vector<ControlFunction> &legacy_I, const std::vector<ControlFunction> &cached_I)
+	{
+		return std::equal(legacy_I.begin(), legacy_I.end(), cached_I.begin(), cached_I.end(),
+			[](const ControlFunction &a_I, const ControlFunction &b_I)
+			{
+				const bool ranged = a_I.extension != WTX_EXPKEYS2;
+				return a_I.tablet == b_I.tablet && a_I.extension == b_I.extension &&
+					a_I.control == b_I.control && a_I.function == b_I.function &&
+					(a_I.available != FALSE) == (b_I.available != FALSE) && a_I.location == b_I.location &&
+					(!ranged || (a_I.min == b_I.min && a_I.max == b_I.max)) &&
+					a_I.iconFormat == b_I.iconFormat && a_I.iconWidth == b_I.iconWidth &&
+					a_I.iconHeight == b_I.iconHeight;
+			});
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	double Milliseconds(const LARGE_INTEGER &start_I, const LARGE_INTEGER &end_I, const LARGE_INTEGER &freq_I)
+	{
+		return 1000.0 * (end_I.QuadPart - start_I.QuadPart) / freq_I.QuadPart;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Display sizes of the tablets' keys.
+
+	const UINT32 gIconBenchSizes[ICON_BENCH_TABLETS][2] = { { 64, 32 }, { 64, 32 }, { 48, 48 } };
+
+	////////////////////////////////////////////////////////////////////////////
+	// A 32-bit bottom-up BMP of rings and gradients, different per seed.
+
+	bool WriteBenchImage(const std::string &path_I, UINT seed_I)
+	{
+		const UINT size = ICON_BENCH_IMAGE_SIZE;
+		const DWORD pixelBytes = size * size * 4;
+
+		BITMAPFILEHEADER fileHeader = { 0 };
+		fileHeader.bfType = 0x4D42;	// "BM"
+		fileHeader.bfOffBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
+		fileHeader.bfSize = fileHeader.bfOffBits + pixelBytes;
+
+		BITMAPINFOHEADER infoHeader = { 0 };
+		infoHeader.biSize = sizeof(BITMAPINFOHEADER);
+		infoHeader.biWidth = size;
+		infoHeader.biHeight = size;
+		infoHeader.biPlanes = 1;
+		infoHeader.biBitCount = 32;
+		infoHeader.biCompression = BI_RGB;
+		infoHeader.biSizeImage = pixelBytes;
+
+		std::vector<UINT32> pixels(size * size);
+		for (UINT y = 0; y < size; ++y)
+		{
+			for (UINT x = 0; x < size; ++x)
+			{
+				const int dx = static_cast<int>(x) - size / 2;
+				const int dy = static_cast<int>(y) - size / 2;
+				const UINT ring = static_cast<UINT>(dx * dx + dy * dy) / (64 + 32 * seed_I);
+				const UINT32 r = (ring & 1) ? 255 : (x * (seed_I + 1)) & 0xFF;
+				const UINT32 g = (y * 255 / size) ^ (seed_I * 37);
+				const UINT32 b = ((x + y) * (8 - seed_I % 8)) & 0xFF;
+				pixels[y * size + x] = 0xFF000000 | (r << 16) | ((g & 0xFF) << 8) | b;
+			}
+		}
+
+		std::ofstream file(path_I.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(&fileHeader), sizeof(fileHeader));
+		file.write(reinterpret_cast<const char *>(&infoHeader), sizeof(infoHeader));
+		file.write(reinterpret_cast<const char *>(pixels.data()), pixelBytes);
+		return !!file;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// The image of a key in a layout.
+
+	UINT BenchImage(UINT layout_I, UINT key_I)
+	{
+		return (key_I + layout_I * 3) % ICON_BENCH_IMAGES;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Gets the icons of a layout for all keys; returns their bytes, 0 if any
+	// failed.
+
+	size_t SetBenchLayout(IconPipeline &icons_IO, const std::vector<std::string> &images_I, UINT layout_I)
+	{
+		size_t bytes = 0;
+		for (UINT tablet = 0; tablet < ICON_BENCH_TABLETS; ++tablet)
+		{
+			for (UINT key = 0; key < ICON_BENCH_KEYS; ++key)
+			{
+				const std::vector<BYTE> *icon = icons_IO.Icon(images_I[BenchImage(layout_I, key)], TABLET_ICON_FMT_4BPP_GRAY,
+					gIconBenchSizes[tablet][0], gIconBenchSizes[tablet][1]);
+				if (!icon)
+				{
+					return 0;
+				}
+				bytes += icon->size();
+			}
+		}
+		return bytes;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// As SetIcon did before the IconPipeline: the file, read per control.
+
+	size_t LegacyBenchLayout(const std::vector<std::string> &images_I, UINT layout_I)
+	{
+		size_t bytes = 0;
+		for (UINT tablet = 0; tablet < ICON_BENCH_TABLETS; ++tablet)
+		{
+			for (UINT key = 0; key < ICON_BENCH_KEYS; ++key)
+			{
+				std::ifstream imageFile(images_I[BenchImage(layout_I, key)].c_str(), std::ios::in | std::ios::binary);
+				std::vector<BYTE> data((std::istreambuf_iterator<char>(imageFile)), std::istreambuf_iterator<char>());
+				bytes += data.size();
+			}
+		}
+		return bytes;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	////////////////////////////////////////////////////////////////////////////
+	// Loads Wintab and opens a context on a message-only window.
+
+	HCTX OpenBenchContext(HWND &hWnd_O)
+	{
+		if (!LoadWintab())
+		{
+			ShowError("Wintab not available or not all Wintab functions available.");
+			return NULL;
+		}
+
+		LOGCONTEXTA lcContext = { 0 };
+		hWnd_O = CreateWindowExA(0, "STATIC", "", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, NULL, NULL);
+		const HCTX hCtx = gpWTInfoA(WTI_DEFSYSCTX, 0, &lcContext) ? gpWTOpenA(hWnd_O, &lcContext, FALSE) : NULL;
+		if (!hCtx)
+		{
+			ShowError("Couldn't open a context.");
+			DestroyWindow(hWnd_O);
+			UnloadWintab();
+		}
+		return hCtx;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void CloseBenchContext(HCTX hCtx_I, HWND hWnd_I)
+	{
+		gpWTClose(hCtx_I);
+		DestroyWindow(hWnd_I);
+		UnloadWintab();
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// What an application shows on display idx_I at frame_I: a progress bar
+	// on every fourth, a recording indicator on the next, the rest still.
+
+	IconPriority StreamBenchFrame(size_t idx_I, UINT frame_I, UINT width_I, UINT height_I,
+		std::vector<BYTE> &gray_O, std::vector<BYTE> &icon_O)
+	{
+		gray_O.assign(static_cast<size_t>(width_I) * height_I, 0);
+		IconPriority priority = ICON_PRIORITY_STATE;
+		switch (idx_I % 4)
+		{
+			case 0:
+			{
+				const UINT filled = (frame_I * 2) % (width_I + 1);
+				for (UINT y = height_I / 4; y < height_I * 3 / 4; ++y)
+				{
+					std::fill_n(gray_O.begin() + y * width_I, filled, static_cast<BYTE>(255));
+				}
+				priority = ICON_PRIORITY_ANIMATION;
+				break;
+			}
+			case 1:
+			{
+				const bool recording = (frame_I / STREAM_BENCH_TOGGLE) % 2 != 0;
+				const BYTE level = recording ? 255 : 64;
+				for (UINT y = height_I / 4; y < height_I * 3 / 4; ++y)
+				{
+					std::fill_n(gray_O.begin() + y * width_I + width_I / 2 - height_I / 4, height_I / 2, level);
+				}
+				break;
+			}
+			default:
+			{
+				for (size_t px = idx_I % 7; px < gray_O.size(); px += 7)
+				{
+					gray_O[px] = 160;
+				}
+				break;
+			}
+		}
+
+		icon_O.resize(IconPipeline::IconSize(TABLET_ICON_FMT_4BPP_GRAY, width_I, height_I));
+		IconPipeline::PackGray4(gray_O.data(), width_I, height_I, icon_O.data());
+		return priority;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Appends a packet, 4 to 6 ms after the last, or now and then in the same
+	// millisecond, as reports arrive.
+
+	void AddSliderPacket(std::vector<SliderRecord> &records_IO, UINT &seed_IO, SliderKind kind_I, UINT tablet_I,
+		UINT control_I, UINT mode_I, DWORD position_I)
+	{
+		seed_IO = seed_IO * 1664525u + 1013904223u;
+		const UINT jitter = seed_IO >> 16;
+
+		SliderRecord record = SliderRecord();
+		record.kind = kind_I;
+		record.data.nTablet = static_cast<BYTE>(tablet_I);
+		record.data.nControl = static_cast<BYTE>(control_I);
+		record.data.nMode = static_cast<BYTE>(mode_I);
+		record.data.nPosition = position_I;
+		record.timeMs = records_IO.empty() ? 1000 : records_IO.back().timeMs + (jitter % 8 ? 4 + jitter % 3 : 0);
+		records_IO.push_back(record);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Sessions as /sliderRecord writes them, on the stand-in's ranges: a ring
+	// spun three turns forward, faster and faster, and two back, through its
+	// ends, held still, lifted, then flicked; a strip slid up and down and
+	// flicked into its end; and another tablet's ring, its mode changed while
+	// touched, held still and lifted.
+
+	void BuildSliderSessions(std::vector<SliderRecord> &records_O)
+	{
+		records_O.clear();
+		SliderRecord range = SliderRecord();
+		range.range = true;
+		range.max = WTSTANDIN_RING_MAX;
+		records_O.push_back(range);
+		range.data.nTablet = 1;
+		range.data.nControl = 1;
+		records_O.push_back(range);
+		range.kind = SLIDER_STRIP;
+		range.data.nTablet = 0;
+		range.data.nControl = 0;
+		range.max = WTSTANDIN_STRIP_MAX;
+		records_O.push_back(range);
+
+		UINT seed = 1;
+		const int turn = WTSTANDIN_RING_MAX + 1;
+		auto ring = [&](UINT tablet_I, UINT control_I, UINT mode_I, int position_I)
+		{
+			AddSliderPacket(records_O, seed, SLIDER_RING, tablet_I, control_I, mode_I,
+				static_cast<DWORD>((position_I % turn + turn) % turn) + 1);
+		};
+		auto strip = [&](int position_I)
+		{
+			AddSliderPacket(records_O, seed, SLIDER_STRIP, 0, 0, 0, static_cast<DWORD>(position_I));
+		};
+
+		int position = 60;
+		ring(0, 0, 0, position);
+		for (int travelled = 0; travelled < 3 * turn; )
+		{
+			const int step = 1 + 2 * travelled / (3 * turn);
+			travelled += step;
+			ring(0, 0, 0, position += step);
+		}
+		for (int travelled = 0; travelled < 2 * turn; travelled += 2)
+		{
+			ring(0, 0, 0, position -= 2);
+		}
+		AddSliderPacket(records_O, seed, SLIDER_RING, 0, 0, 0, 0);
+		records_O.back().timeMs += 400;
+
+		ring(0, 0, 0, position);
+		for (int packet = 0; packet < 8; ++packet)
+		{
+			ring(0, 0, 0, position += 4);
+		}
+		AddSliderPacket(records_O, seed, SLIDER_RING, 0, 0, 0, 0);
+
+		strip(2);
+		records_O.back().timeMs += 400;
+		for (position = 3; position <= 30; ++position)
+		{
+			strip(position);
+		}
+		for (position = 28; position >= 5; position -= 2)
+		{
+			strip(position);
+		}
+		for (position = 8; position <= 23; position += 3)
+		{
+			strip(position);
+		}
+		AddSliderPacket(records_O, seed, SLIDER_STRIP, 0, 0, 0, 0);
+
+		ring(1, 1, 0, 5);
+		records_O.back().timeMs += 1000;
+		for (position = 4; position >= -6; --position)
+		{
+			ring(1, 1, 0, position);
+		}
+		for (position = -6; position <= 6; ++position)
+		{
+			ring(1, 1, 1, position);
+		}
+		AddSliderPacket(records_O, seed, SLIDER_RING, 1, 1, 1, 0);
+		records_O.back().timeMs += 300;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	struct SliderReference
+	{
+		bool		touching;
+		UINT		mode;
+		DWORD		last;
+		UINT		period;		// of a ring; 0 for a strip
+		double	min;
+		double	max;
+		double	engine;		// sums of the deltas
+		double	reference;
+	};
+
+	struct SliderReplay
+	{
+		unsigned long long	mismatches;
+		double					largestRingStep;	// of a period
+		double					coastDistance;
+		double					fastestLift;		// positions per second
+		std::map<UINT, SliderReference>	controls;
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+	// Replays records_I through motion_IO, coasting every
+	// SLIDER_BENCH_COAST_MS as TABLET_MOTION_TIMER would, and checks each
+	// delta against a plain unwrap of the positions.
+
+	void ReplaySliders(const std::vector<SliderRecord> &records_I, SliderMotion &motion_IO, SliderReplay &replay_O)
+	{
+		replay_O = SliderReplay();
+		SliderMotionEvent events[8];
+		DWORD nextCoastMs = 0;
+
+		auto coast = [&](DWORD until_I)
+		{
+			while (motion_IO.Coasting() && nextCoastMs <= until_I)
+			{
+				const size_t count = motion_IO.Coast(nextCoastMs, events, _countof(events));
+				for (size_t idx = 0; idx < count; ++idx)
+				{
+					const SliderMotionEvent &event = events[idx];
+					const SliderReference &control =
+						replay_O.controls[(event.kind << 16) | (event.tablet << 8) | event.control];
+					replay_O.coastDistance += fabs(event.delta);
+					if (event.position < control.min ||
+						event.position > (control.period ? control.max + 1 : control.max))
+					{
+						++replay_O.mismatches;
+					}
+				}
+				nextCoastMs += SLIDER_BENCH_COAST_MS;
+			}
+		};
+
+		for (const SliderRecord &record : records_I)
+		{
+			const UINT key = (record.kind << 16) | (record.data.nTablet << 8) | record.data.nControl;
+			if (record.range)
+			{
+				motion_IO.Setup(record.kind, record.data.nTablet, record.data.nControl, record.min, record.max);
+				SliderReference control = SliderReference();
+				control.period = record.kind == SLIDER_RING ? record.max - record.min + 1 : 0;
+				control.min = record.min;
+				control.max = record.max;
+				replay_O.controls[key] = control;
+				continue;
+			}
+
+			coast(record.timeMs);
+
+			auto found = replay_O.controls.find(key);
+			SliderMotionEvent event = SliderMotionEvent();
+			const bool moved = motion_IO.Packet(record.kind, record.data, record.timeMs, event);
+			if (found == replay_O.controls.end())
+			{
+				continue;
+			}
+
+			SliderReference &control = found->second;
+			double expected = 0.0;
+			const DWORD position = record.data.nPosition;
+			if (position == 0)
+			{
+				control.touching = false;
+			}
+			else if (!control.touching || control.mode != record.data.nMode)
+			{
+				control.touching = true;
+				control.mode = record.data.nMode;
+			}
+			else
+			{
+				long long step = static_cast<long long>(position) - control.last;
+				if (control.period)
+				{
+					step = (step % control.period + control.period) % control.period;
+					if (2 * step > control.period)
+					{
+						step -= control.period;
+					}
+				}
+				expected = static_cast<double>(step);
+			}
+			control.last = position;
+
+			const double delta = moved ? event.delta : 0.0;
+			control.engine += delta;
+			control.reference += expected;
+
+			// A step of exactly half an even ring goes either way.
+			const bool tie = control.period && fabs(delta) * 2 == control.period && fabs(expected) * 2 == control.period;
+			if (delta != expected && !tie)
+			{
+				++replay_O.mismatches;
+			}
+			if (control.period)
+			{
+				replay_O.largestRingStep = std::max<double>(replay_O.largestRingStep, fabs(delta) / control.period);
+			}
+
+			// As Tablet::TrackSlider sets the timer again
+			if (moved && event.coasting)
+			{
+				replay_O.fastestLift = std::max<double>(replay_O.fastestLift, fabs(event.velocity));
+				nextCoastMs = record.timeMs + SLIDER_BENCH_COAST_MS;
+			}
+		}
+		coast(MAXDWORD);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void ReportIconStats(std::stringstream &report_IO, const IconPipelineStats &stats_I)
+	{
+		report_IO << stats_I.reads << " reads, " << stats_I.decodes << " decodes, "
+			<< stats_I.converts << " converts, " << stats_I.memoryHits << " memory hits, "
+			<< stats_I.diskHits << " disk hits, " << stats_I.diskWrites << " disk writes\n";
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RunStartupBenchmark(void)
+{
+	HWND hWnd = NULL;
+	const HCTX hCtx = OpenBenchContext(hWnd);
+	if (!hCtx)
+	{
+		return;
+	}
+
+	// Only the stand-in plugs tablets in on request.
+	const WINTABSTANDINATTACHTABLET attachTablet =
+		(WINTABSTANDINATTACHTABLET)GetProcAddress(ghWintab, "WintabStandInAttachTablet");
+	const WINTABSTANDINDETACHTABLET detachTablet =
+		(WINTABSTANDINDETACHTABLET)GetProcAddress(ghWintab, "WintabStandInDetachTablet");
+
+	std::stringstream report;
+	report.precision(3);
+	report << std::fixed;
+
+	LARGE_INTEGER freq = { 0 };
+	QueryPerformanceFrequency(&freq);
+
+	// Property by property, as Tablet::Init did.
+	std::vector<ControlFunction> legacy;
+	LegacyCalls legacyCalls = { 0, 0 };
+	double legacyMs = 0.0;
+	for (int run = 0; run < STARTUP_BENCH_RUNS; ++run)
+	{
+		legacy.clear();
+		legacyCalls = LegacyCalls { 0, 0 };
+
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		LegacyEnumerate(hCtx, legacy, legacyCalls);
+		QueryPerformanceCounter(&end);
+
+		const double ms = Milliseconds(start, end, freq);
+		legacyMs = run ? std::min<double>(legacyMs, ms) : ms;
+	}
+
+	// Through a new cache each run, as at startup.
+	std::unique_ptr<ControlCache> cache;
+	ControlCacheStats cachedCalls = ControlCacheStats();
+	double cachedMs = 0.0;
+	for (int run = 0; run < STARTUP_BENCH_RUNS; ++run)
+	{
+		cache.reset(new ControlCache());
+		std::vector<UINT> changed;
+
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		cache->FindExtensions();
+		cache->SetContext(hCtx);
+		cache->Refresh(changed);
+		QueryPerformanceCounter(&end);
+
+		const double ms = Milliseconds(start, end, freq);
+		cachedMs = run ? std::min<double>(cachedMs, ms) : ms;
+		cachedCalls = cache->Stats();
+	}
+
+	const bool same = SameFunctions(legacy, cache->Functions());
+	report << "Reading " << legacy.size() << " control functions\n"
+		<< "  property by property: " << legacyMs << " ms, "
+		<< legacyCalls.infos << " WTInfoA, " << legacyCalls.gets << " WTExtGet\n"
+		<< "  control cache:        " << cachedMs << " ms, "
+		<< cachedCalls.infos << " WTInfoA, " << cachedCalls.gets << " WTExtGet, "
+		<< cachedCalls.scratchGrowths << " scratch allocations\n"
+		<< "  same controls: " << (same ? "yes" : "NO") << "\n";
+
+	// A WT_INFOCHANGE that changed no controls.
+	{
+		cache->ResetStats();
+		std::vector<UINT> changed;
+
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		cache->Refresh(changed);
+		QueryPerformanceCounter(&end);
+
+		report << "Refresh, nothing changed: " << Milliseconds(start, end, freq) << " ms, "
+			<< cache->Stats().infos << " WTInfoA, " << cache->Stats().gets << " WTExtGet, "
+			<< changed.size() << " tablets read\n";
+	}
+
+	// WT_INFOCHANGE after a tablet is plugged in, then out.
+	UINT tablet = 0;
+	if (attachTablet && detachTablet && attachTablet(&tablet))
+	{
+		for (const bool attached : { true, false })
+		{
+			if (!attached)
+			{
+				detachTablet(tablet);
+			}
+
+			cache->ResetStats();
+			std::vector<UINT> changed;
+
+			LARGE_INTEGER start, end;
+			QueryPerformanceCounter(&start);
+			cache->Refresh(changed);
+			QueryPerformanceCounter(&end);
+
+			report << "Refresh, tablet " << tablet << (attached ? " attached: " : " detached: ")
+				<< Milliseconds(start, end, freq) << " ms, "
+				<< cache->Stats().infos << " WTInfoA, " << cache->Stats().gets << " WTExtGet, "
+				<< changed.size() << " tablets read\n";
+		}
+	}
+
+	CloseBenchContext(hCtx, hWnd);
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Startup Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RunIconBenchmark(void)
+{
+	char tempPath[MAX_PATH] = { 0 };
+	if (!GetTempPathA(MAX_PATH, tempPath))
+	{
+		ShowError("Couldn't find the temporary directory.");
+		return;
+	}
+
+	// The images and the icons cached from them share a directory.
+	const std::string directory = std::string(tempPath) + "TabletControlsIconBenchmark\\";
+	CreateDirectoryA(directory.c_str(), NULL);
+
+	std::vector<std::string> images;
+	for (UINT image = 0; image < ICON_BENCH_IMAGES; ++image)
+	{
+		images.push_back(directory + "image" + std::to_string(image) + ".bmp");
+		if (!WriteBenchImage(images.back(), image))
+		{
+			ShowError("Couldn't write the benchmark images.");
+			return;
+		}
+	}
+
+	std::stringstream report;
+	report.precision(3);
+	report << std::fixed;
+
+	LARGE_INTEGER freq = { 0 };
+	QueryPerformanceFrequency(&freq);
+
+	std::unique_ptr<IconPipeline> icons(new IconPipeline());
+	icons->SetCacheDirectory(directory);
+
+	// First use of each layout: every image decoded, every icon converted.
+	{
+		size_t bytes = 0;
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (UINT layout = 0; layout < ICON_BENCH_LAYOUTS; ++layout)
+		{
+			bytes += SetBenchLayout(*icons, images, layout);
+		}
+		QueryPerformanceCounter(&end);
+
+		report << ICON_BENCH_LAYOUTS << " layouts of " << ICON_BENCH_TABLETS * ICON_BENCH_KEYS << " icons, "
+			<< ICON_BENCH_IMAGES << " images of " << ICON_BENCH_IMAGE_SIZE << "x" << ICON_BENCH_IMAGE_SIZE << "\n"
+			<< "  first use: " << Milliseconds(start, end, freq) << " ms, " << bytes << " bytes, ";
+		ReportIconStats(report, icons->Stats());
+	}
+
+	// Switching between layouts seen: from memory.
+	{
+		icons->ResetStats();
+		size_t bytes = 0;
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (UINT change = 0; change < ICON_BENCH_SWITCHES; ++change)
+		{
+			bytes += SetBenchLayout(*icons, images, change % ICON_BENCH_LAYOUTS);
+		}
+		QueryPerformanceCounter(&end);
+
+		report << "  " << ICON_BENCH_SWITCHES << " switches: " << Milliseconds(start, end, freq) << " ms, "
+			<< bytes << " bytes, ";
+		ReportIconStats(report, icons->Stats());
+	}
+
+	// The next session: from the disk cache.
+	icons.reset(new IconPipeline());
+	icons->SetCacheDirectory(directory);
+	{
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (UINT layout = 0; layout < ICON_BENCH_LAYOUTS; ++layout)
+		{
+			SetBenchLayout(*icons, images, layout);
+		}
+		QueryPerformanceCounter(&end);
+
+		report << "  next session: " << Milliseconds(start, end, freq) << " ms, ";
+		ReportIconStats(report, icons->Stats());
+	}
+
+	// The same switches, reading each file per control and converting
+	// nothing.
+	{
+		size_t bytes = 0;
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (UINT change = 0; change < ICON_BENCH_SWITCHES; ++change)
+		{
+			bytes += LegacyBenchLayout(images, change % ICON_BENCH_LAYOUTS);
+		}
+		QueryPerformanceCounter(&end);
+
+		report << "  " << ICON_BENCH_SWITCHES << " switches, file per control: " << Milliseconds(start, end, freq)
+			<< " ms, " << bytes << " bytes\n";
+	}
+
+	icons->DeleteCacheFiles();
+	icons.reset();
+	for (const std::string &image : images)
+	{
+		DeleteFileA(image.c_str());
+	}
+	RemoveDirectoryA(directory.c_str());
+
+	// The conversion steps over one image.
+	const size_t count = ICON_BENCH_IMAGE_SIZE * ICON_BENCH_IMAGE_SIZE;
+	std::vector<UINT32> argb(count);
+	UINT32 state = 12345;
+	for (UINT32 &pixel : argb)
+	{
+		state = state * 1664525 + 1013904223;
+		pixel = state;
+	}
+
+	std::vector<BYTE> gray(count), grayReference(count);
+	std::vector<BYTE> packed(count / 2), packedReference(count / 2);
+	double ms[4] = { 0.0 };
+	for (int run = 0; run < ICON_BENCH_KERNEL_RUNS; ++run)
+	{
+		LARGE_INTEGER t[5];
+		QueryPerformanceCounter(&t[0]);
+		IconPipeline::Luminance(argb.data(), count, gray.data());
+		QueryPerformanceCounter(&t[1]);
+		IconPipeline::LuminanceReference(argb.data(), count, grayReference.data());
+		QueryPerformanceCounter(&t[2]);
+		IconPipeline::PackGray4(gray.data(), ICON_BENCH_IMAGE_SIZE, ICON_BENCH_IMAGE_SIZE, packed.data());
+		QueryPerformanceCounter(&t[3]);
+		IconPipeline::PackGray4Reference(gray.data(), ICON_BENCH_IMAGE_SIZE, ICON_BENCH_IMAGE_SIZE, packedReference.data());
+		QueryPerformanceCounter(&t[4]);
+
+		for (int step = 0; step < 4; ++step)
+		{
+			const double stepMs = Milliseconds(t[step], t[step + 1], freq);
+			ms[step] = run ? std::min<double>(ms[step], stepMs) : stepMs;
+		}
+	}
+
+	report << "Conversion of " << count << " pixels, best of " << ICON_BENCH_KERNEL_RUNS << "\n"
+		<< "  luminance: " << ms[0] << " ms, reference " << ms[1] << " ms, same: "
+		<< (gray == grayReference ? "yes" : "NO") << "\n"
+		<< "  4-bit packing: " << ms[2] << " ms, reference " << ms[3] << " ms, same: "
+		<< (packed == packedReference ? "yes" : "NO") << "\n";
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Icon Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RunIconStreamBenchmark(void)
+{
+	HWND hWnd = NULL;
+	const HCTX hCtx = OpenBenchContext(hWnd);
+	if (!hCtx)
+	{
+		return;
+	}
+
+	ControlCache controls;
+	std::vector<UINT> changed;
+	controls.FindExtensions();
+	controls.SetContext(hCtx);
+	controls.Refresh(changed);
+
+	std::vector<ControlFunction> displays;
+	for (const ControlFunction &func : controls.Functions())
+	{
+		if (func.iconFormat == TABLET_ICON_FMT_4BPP_GRAY && func.function == 0)
+		{
+			displays.push_back(func);
+		}
+	}
+	if (displays.empty())
+	{
+		ShowError("No control displays found.");
+		CloseBenchContext(hCtx, hWnd);
+		return;
+	}
+
+	std::stringstream report;
+	report.precision(3);
+	report << std::fixed;
+
+	LARGE_INTEGER freq = { 0 };
+	QueryPerformanceFrequency(&freq);
+
+	const UINT frames = STREAM_BENCH_SECONDS * STREAM_BENCH_FPS;
+	std::vector<BYTE> gray, icon;
+
+	// Every icon of every frame, as the application pushes them.
+	unsigned long long naiveBytes = 0;
+	unsigned long long naiveFailures = 0;
+	double naiveMs = 0.0;
+	{
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (UINT frame = 0; frame < frames; ++frame)
+		{
+			for (size_t idx = 0; idx < displays.size(); ++idx)
+			{
+				const ControlFunction &func = displays[idx];
+				StreamBenchFrame(idx, frame, func.iconWidth, func.iconHeight, gray, icon);
+				if (controls.Set(func.extension, func.tablet, func.control, func.function,
+					TABLET_PROPERTY_OVERRIDE_ICON, icon))
+				{
+					naiveBytes += icon.size();
+				}
+				else
+				{
+					++naiveFailures;
+				}
+			}
+		}
+		QueryPerformanceCounter(&end);
+		naiveMs = Milliseconds(start, end, freq);
+	}
+
+	// The same frames through the scheduler, pumped once a frame on a
+	// simulated clock.
+	IconScheduler scheduler(controls);
+	double scheduledMs = 0.0;
+	{
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (UINT frame = 0; frame < frames; ++frame)
+		{
+			const ULONGLONG nowMs = static_cast<ULONGLONG>(frame) * 1000 / STREAM_BENCH_FPS;
+			for (size_t idx = 0; idx < displays.size(); ++idx)
+			{
+				const ControlFunction &func = displays[idx];
+				const IconPriority priority = StreamBenchFrame(idx, frame, func.iconWidth, func.iconHeight, gray, icon);
+				scheduler.Submit(func, icon, priority, nowMs);
+			}
+			scheduler.Pump(nowMs);
+		}
+		QueryPerformanceCounter(&end);
+		scheduledMs = Milliseconds(start, end, freq);
+	}
+
+	const IconSchedulerStats &stats = scheduler.Stats();
+	report << displays.size() << " displays, " << frames << " frames at " << STREAM_BENCH_FPS << " fps, "
+		<< "budget " << ICON_SCHEDULER_DEFAULT_RATE << " bytes/s per tablet\n"
+		<< "  every frame: " << naiveMs << " ms, " << frames * displays.size() << " uploads, "
+		<< naiveBytes << " bytes, " << naiveFailures << " failures\n"
+		<< "  scheduled:   " << scheduledMs << " ms, " << stats.uploads << " uploads, "
+		<< stats.bytesUploaded << " bytes, " << stats.failures << " failures\n"
+		<< "    " << stats.unchanged << " frames unchanged, " << stats.superseded << " superseded, "
+		<< stats.deferrals << " deferrals\n"
+		<< "    longest wait of a state change: " << stats.maxStateDelayMs << " ms\n";
+
+	CloseBenchContext(hCtx, hWnd);
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Icon Stream Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RunRepaintBenchmark(void)
+{
+	// A window for its size only, never shown, painted through a memory DC.
+	const HWND hWnd = CreateWindowExA(0, "STATIC", "", WS_POPUP, 0, 0,
+		REPAINT_BENCH_WIDTH, REPAINT_BENCH_HEIGHT, NULL, NULL, NULL, NULL);
+	const HDC hdc = CreateCompatibleDC(NULL);
+
+	BITMAPINFO bmi = { 0 };
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = REPAINT_BENCH_WIDTH;
+	bmi.bmiHeader.biHeight = -REPAINT_BENCH_HEIGHT;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+	void *bits = nullptr;
+	const HBITMAP hBitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+	if (!hWnd || !hdc || !hBitmap)
+	{
+		ShowError("Couldn't create the window or memory DC to paint.");
+		return;
+	}
+	const HGDIOBJ hOldBitmap = SelectObject(hdc, hBitmap);
+
+	// The stand-in's tablets: 17 ExpressKeys, two rings and two strips of
+	// four modes.
+	Drawing::Init(hWnd);
+	for (int tablet = 0; tablet < WTSTANDIN_DEFAULT_TABLETS; ++tablet)
+	{
+		for (int key = 0; key < WTSTANDIN_DEFAULT_KEYS; ++key)
+		{
+			Drawing::SetupKey(tablet, key, 0, TRUE,
+				key < (WTSTANDIN_DEFAULT_KEYS + 1) / 2 ? TABLET_LOC_LEFT : TABLET_LOC_RIGHT, 0, 0);
+		}
+		for (int control = 0; control < WTSTANDIN_DEFAULT_RINGS; ++control)
+		{
+			for (int mode = 0; mode < WTSTANDIN_DEFAULT_MODES; ++mode)
+			{
+				Drawing::SetupRing(tablet, control, mode, TRUE, TABLET_LOC_LEFT, 0, WTSTANDIN_RING_MAX);
+			}
+		}
+		for (int control = 0; control < WTSTANDIN_DEFAULT_STRIPS; ++control)
+		{
+			for (int mode = 0; mode < WTSTANDIN_DEFAULT_MODES; ++mode)
+			{
+				Drawing::SetupStrip(tablet, control, mode, TRUE, TABLET_LOC_RIGHT, 0, WTSTANDIN_STRIP_MAX);
+			}
+		}
+	}
+	Drawing::PaintToHDC(hdc);
+
+	std::stringstream report;
+	report.precision(3);
+	report << std::fixed;
+
+	LARGE_INTEGER freq = { 0 };
+	QueryPerformanceFrequency(&freq);
+
+	// Without GDI+, the stand-in counts what each way draws instead.
+#if !defined(_WIN32)
+	WIN32STANDINDRAWSTATS fullDrawn = { 0 };
+	WIN32STANDINDRAWSTATS incrementalDrawn = { 0 };
+	Win32StandInResetDrawStats();
+#endif
+
+	// As before: every Update per packet, everything redrawn and copied.
+	double fullMs = 0.0;
+	{
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (int packet = 0; packet < REPAINT_BENCH_PACKETS; ++packet)
+		{
+			Drawing::UpdateKeys(0, 0, 0, 0);
+			Drawing::UpdateRing(0, 0, 0, 1 + packet % WTSTANDIN_RING_MAX);
+			Drawing::UpdateStrip(0, 0, 0, 0);
+			Drawing::SetDirty();
+			Drawing::PaintToHDC(hdc);
+		}
+		QueryPerformanceCounter(&end);
+		fullMs = Milliseconds(start, end, freq);
+	}
+#if !defined(_WIN32)
+	Win32StandInGetDrawStats(&fullDrawn);
+	Win32StandInResetDrawStats();
+#endif
+
+	// The ring's Update only, its box redrawn and copied, as WM_PAINT
+	// would clip to the rectangles invalidated.
+	double incrementalMs = 0.0;
+	unsigned long long pixels = 0;
+	{
+		std::vector<RECT> rects;
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (int packet = 0; packet < REPAINT_BENCH_PACKETS; ++packet)
+		{
+			Drawing::UpdateRing(0, 0, 0, 1 + (packet + 1) % WTSTANDIN_RING_MAX);
+			Drawing::DirtyRects(rects);
+
+			const HRGN hRgn = CreateRectRgn(0, 0, 0, 0);
+			for (const RECT &rect : rects)
+			{
+				const HRGN hRect = CreateRectRgnIndirect(&rect);
+				CombineRgn(hRgn, hRgn, hRect, RGN_OR);
+				DeleteObject(hRect);
+				pixels += static_cast<unsigned long long>(rect.right - rect.left) * (rect.bottom - rect.top);
+			}
+			SelectClipRgn(hdc, hRgn);
+			DeleteObject(hRgn);
+
+			Drawing::PaintToHDC(hdc);
+			SelectClipRgn(hdc, NULL);
+		}
+		QueryPerformanceCounter(&end);
+		incrementalMs = Milliseconds(start, end, freq);
+	}
+#if !defined(_WIN32)
+	Win32StandInGetDrawStats(&incrementalDrawn);
+#endif
+
+	report << REPAINT_BENCH_PACKETS << " TouchRing packets, " << WTSTANDIN_DEFAULT_TABLETS << " tablets drawn in "
+		<< REPAINT_BENCH_WIDTH << "x" << REPAINT_BENCH_HEIGHT << "\n"
+		<< "  full redraw: " << 1000.0 * fullMs / REPAINT_BENCH_PACKETS << " us per packet, "
+		<< REPAINT_BENCH_WIDTH * REPAINT_BENCH_HEIGHT << " pixels\n"
+		<< "  dirty controls: " << 1000.0 * incrementalMs / REPAINT_BENCH_PACKETS << " us per packet, "
+		<< pixels / REPAINT_BENCH_PACKETS << " pixels\n"
+		<< "  " << (incrementalMs > 0.0 ? fullMs / incrementalMs : 0.0) << "x less time\n";
+#if !defined(_WIN32)
+	report << "Drawn per packet, as counted by the stand-in:\n"
+		<< "  full redraw: " << fullDrawn.primitives / REPAINT_BENCH_PACKETS << " primitives, "
+		<< (fullDrawn.pixelsCleared + fullDrawn.pixelsCopied) / REPAINT_BENCH_PACKETS << " pixels cleared and copied\n"
+		<< "  dirty controls: " << incrementalDrawn.primitives / REPAINT_BENCH_PACKETS << " primitives, "
+		<< (incrementalDrawn.pixelsCleared + incrementalDrawn.pixelsCopied) / REPAINT_BENCH_PACKETS
+		<< " pixels cleared and copied\n";
+#endif
+
+	Drawing::Cleanup();
+	SelectObject(hdc, hOldBitmap);
+	DeleteObject(hBitmap);
+	DeleteDC(hdc);
+	DestroyWindow(hWnd);
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Repaint Benchmark", MB_OK | MB_ICONINFORMATION);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RunSliderReplay(const TCHAR *path_I)
+{
+	std::stringstream report;
+	report.precision(3);
+	report << std::fixed;
+
+	std::vector<SliderRecord> records;
+	if (path_I && *path_I)
+	{
+		std::ifstream file(path_I);
+		SliderRecord record;
+		while (ReadSliderRecord(file, record))
+		{
+			records.push_back(record);
+		}
+		if (records.empty())
+		{
+			ShowError("Couldn't read the slider recording.");
+			return;
+		}
+		report << "Recorded session, " << records.size() << " records\n";
+	}
+	else
+	{
+		BuildSliderSessions(records);
+		report << "Built-in sessions, " << records.size() << " records\n";
+	}
+
+	// Checked once, coasting as the timer would.
+	std::unique_ptr<SliderMotion> motion(new SliderMotion());
+	SliderReplay replay;
+	ReplaySliders(records, *motion, replay);
+	const SliderMotionStats stats = motion->Stats();
+
+	// Timed without the checks or coasting: the packets alone.
+	LARGE_INTEGER freq = { 0 };
+	QueryPerformanceFrequency(&freq);
+
+	size_t packets = 0;
+	double bestMs = 0.0;
+	for (int run = 0; run < STARTUP_BENCH_RUNS; ++run)
+	{
+		motion.reset(new SliderMotion());
+		SliderMotionEvent event;
+		packets = 0;
+
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for (int pass = 0; pass < SLIDER_BENCH_PASSES; ++pass)
+		{
+			for (const SliderRecord &record : records)
+			{
+				if (record.range)
+				{
+					motion->Setup(record.kind, record.data.nTablet, record.data.nControl, record.min, record.max);
+				}
+				else
+				{
+					motion->Packet(record.kind, record.data, record.timeMs, event);
+					++packets;
+				}
+			}
+		}
+		QueryPerformanceCounter(&end);
+
+		const double ms = Milliseconds(start, end, freq);
+		bestMs = run ? std::min<double>(bestMs, ms) : ms;
+	}
+
+	report << "  " << stats.packets << " packets, " << stats.ignored << " of controls without a range, "
+		<< stats.touches << " touches, " << stats.moves << " moves, " << stats.lifts << " lifts\n"
+		<< "  " << stats.wraps << " ring steps through the ends, largest step "
+		<< replay.largestRingStep << " of a turn\n"
+		<< "  " << replay.mismatches << " deltas differing from the reference unwrap\n";
+	for (const auto &entry : replay.controls)
+	{
+		report << "  " << (static_cast<SliderKind>(entry.first >> 16) == SLIDER_RING ? "ring " : "strip ") << ((entry.first >> 8) & 0xFF)
+			<< "/" << (entry.first & 0xFF) << ": net " << entry.second.engine << ", reference "
+			<< entry.second.reference << " positions\n";
+	}
+	report << "  " << stats.coasts << " lifts coasted, from up to " << replay.fastestLift << " positions/s, "
+		<< replay.coastDistance << " positions in " << stats.coastSteps << " steps\n"
+		<< "  " << (packets ? 1000000.0 * bestMs / packets : 0.0) << " ns per packet, "
+		<< sizeof(SliderMotion) << " bytes of state, fixed\n";
+
+	OutputDebugStringA(report.str().c_str());
+	MessageBoxA(nullptr, report.str().c_str(), "Slider Replay", MB_OK | MB_ICONINFORMATION);
+}
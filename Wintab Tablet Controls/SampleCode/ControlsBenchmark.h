@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Declarations of the benchmarks of this sample, run from the command
+//		line instead of opening the window.  Run them against the stand-in
+//		Wintab in WintabStandIn, or a tablet.  Results are traced and shown
+//		in a message box.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// /startupBenchmark: time and Wintab calls to read the controls of all
+// tablets, property by property as Tablet::Init did and through the
+// ControlCache; and to refresh the cache on a WT_INFOCHANGE that changed
+// nothing, and, with the stand-in, on one that attached a tablet.
+void RunStartupBenchmark(void);
+
+// /iconBenchmark: time to set the icons of three layouts of ExpressKey
+// displays, from generated images: converting them, switching layouts in
+// memory, and starting again from the disk cache, against reading each
+// file per control as SetIcon did; and the SSE2 conversion steps against
+// their references.  Needs no Wintab.
+void RunIconBenchmark(void);
+
+// /iconStreamBenchmark: uploads of animated control displays, a progress
+// bar, a recording indicator and still icons on each, pushed every frame:
+// set directly and through the IconScheduler, with the bytes uploaded,
+// frames skipped and the longest wait of a state change.
+void RunIconStreamBenchmark(void);
+
+// /repaintBenchmark: time per TouchRing packet to scrub a ring on the
+// stand-in's three tablets, redrawing everything as before and redrawing
+// the dirty controls only.  Needs no Wintab; paints off screen.
+void RunRepaintBenchmark(void);
+
+// /sliderReplay [file]: the TouchRing and TouchStrip motion engine over a
+// session recorded with /sliderRecord, or built-in sessions on the
+// stand-in's ranges: each delta checked against a plain unwrap of the
+// positions, the wraps, the coasting after lifts, the time per packet and
+// the engine's fixed memory.  Needs no Wintab.
+void RunSliderReplay(const TCHAR *path_I);
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Command line entry point of the benchmarks where there is no sample
+//		window, on Linux against the stand-ins (see CMakeLists.txt).  Takes
+//		the switches of the sample, e.g.
+//			controlsbenchmark /repaintBenchmark
+//			controlsbenchmark /sliderReplay session.txt
+//		and prints each report, shown in a message box on Windows, to stdout.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "ControlsBenchmark.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Module-private types
+
+namespace
+{
+	struct Benchmark
+	{
+		const char	*option;
+		void			(*run)(void);
+	};
+
+	const Benchmark kBenchmarks[] =
+	{
+		{ "/startupBenchmark", RunStartupBenchmark },
+		{ "/iconBenchmark", RunIconBenchmark },
+		{ "/iconStreamBenchmark", RunIconStreamBenchmark },
+		{ "/repaintBenchmark", RunRepaintBenchmark },
+		{ "/sliderReplay", nullptr }
+	};
+
+	bool IsSwitch(const char *arg_I)
+	{
+		for (const Benchmark &benchmark : kBenchmarks)
+		{
+			if (strcmp(arg_I, benchmark.option) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs the benchmarks named on the command line, or lists them.  A file
+// after /sliderReplay is replayed, as with the sample.
+
+int main(int argc, char *argv[])
+{
+	int ran = 0;
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (strcmp(argv[arg], "/sliderReplay") == 0)
+		{
+			const bool hasFile = arg + 1 < argc && !IsSwitch(argv[arg + 1]);
+			RunSliderReplay(hasFile ? argv[++arg] : "");
+			++ran;
+			continue;
+		}
+		for (const Benchmark &benchmark : kBenchmarks)
+		{
+			if (benchmark.run && strcmp(argv[arg], benchmark.option) == 0)
+			{
+				benchmark.run();
+				++ran;
+			}
+		}
+	}
+
+	if (ran == 0)
+	{
+		fprintf(stderr, "usage: %s benchmark...\n", argv[0]);
+		for (const Benchmark &benchmark : kBenchmarks)
+		{
+			fprintf(stderr, "  %s\n", benchmark.option);
+		}
+		fprintf(stderr, "  /sliderReplay takes an optional file, recorded with /sliderRecord\n");
+		return 1;
+	}
+	return 0;
+}
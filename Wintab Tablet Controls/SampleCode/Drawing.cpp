@@ -12,7 +12,9 @@
 #include "stdafx.h"
 #include "Drawing.h"
 #include "Utils.h"
+#include <algorithm>
 #include <map>
+#include <memory>
 
 using namespace Gdiplus;
 using std::vector;
@@ -21,11 +23,18 @@ using std::wstring;
 ////////////////////////////////////////////////////////////////////////////////
 // Structures
 
+// Each control's glyph is drawn over the static layer within its box,
+// in window coordinates, and redrawn alone when it is dirty.
+
 struct SExpKey
 {
 	bool available;
 	bool down;
 	int  location;
+	REAL x;
+	REAL y;
+	Rect box;
+	bool dirty;
 };
 
 struct SMode
@@ -42,6 +51,10 @@ struct SLinearControl
 	int				min;
 	int				max;
 	int				location;
+	REAL				x;
+	REAL				y;
+	Rect				box;
+	bool				dirty;
 };
 
 struct STablet
@@ -49,25 +62,32 @@ struct STablet
 	vector<SExpKey>			expKeys;
 	vector<SLinearControl>	touchRings;
 	vector<SLinearControl>	touchStrips;
+	REAL							x;
+	REAL							y;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 // Module-global vars
 
-ULONG_PTR							gGdiToken			= NULL;
+ULONG_PTR							gGdiToken			= 0;
 std::map<int, STablet>			gTablets;
 std::unique_ptr<Bitmap>			gBackbuffer;
+std::unique_ptr<Bitmap>			gStaticLayer;		// outlines and labels
 std::unique_ptr<Pen>				gOutlinePen;
 std::unique_ptr<SolidBrush>	gDisabledBrush;
 std::unique_ptr<SolidBrush>	gActiveBrush;
 std::unique_ptr<SolidBrush>	gInactiveBrush;
 std::unique_ptr<SolidBrush>	gBlack;
-bool									gDirty				= true;
+bool									gDirty				= true;		// all of it, layout included
 
 ////////////////////////////////////////////////////////////////////////////////
 // Forward declarations for non-public functions
 
-void DrawTablet(Graphics &g_I, STablet &tablet_I, REAL x_I, REAL y_I);
+void UpdateLinearControl(SLinearControl &control_IO, int function_I, int position_I, bool down_I);
+void LayoutTablet(STablet &tablet_IO, REAL x_I, REAL y_I);
+void DrawTabletStatic(Graphics &g_I, const STablet &tablet_I);
+void DrawTabletGlyphs(Graphics &g_I, const STablet &tablet_I, const Rect *clip_I);
+void RedrawBox(Graphics &g_I, const STablet &tablet_I, const Rect &box_I);
 
 ////////////////////////////////////////////////////////////////////////////////
 // Public functions
@@ -85,6 +105,7 @@ void Drawing::Cleanup(void)
 	gBlack.reset();
 
 	gBackbuffer.reset();
+	gStaticLayer.reset();
 
 	GdiplusShutdown(gGdiToken);
 }
@@ -108,7 +129,74 @@ void Drawing::Init(HWND hWnd_I)
 
 	RECT r = {0};
 	GetClientRect(hWnd_I, &r);
-	gBackbuffer.reset(new Bitmap(r.right - r.left + 1, r.bottom - r.top + 1));
+	gBackbuffer.reset(new Bitmap(r.right - r.left + 1, r.bottom - r.top + 1, PixelFormat32bppPARGB));
+	gStaticLayer.reset(new Bitmap(r.right - r.left + 1, r.bottom - r.top + 1, PixelFormat32bppPARGB));
+	gDirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Redraw everything at the next paint
+
+void Drawing::SetDirty(void)
+{
+	gDirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Get the window rectangles that the next paint will change: the boxes of
+// the dirty glyphs, or all of the window
+
+void Drawing::DirtyRects(vector<RECT> &rects_O)
+{
+	rects_O.clear();
+	if (gDirty)
+	{
+		if (gBackbuffer)
+		{
+			const RECT all = { 0, 0, static_cast<LONG>(gBackbuffer->GetWidth()), static_cast<LONG>(gBackbuffer->GetHeight()) };
+			rects_O.push_back(all);
+		}
+		return;
+	}
+
+	const auto add = [&rects_O](const Rect &box_I)
+	{
+		const RECT r = { box_I.X, box_I.Y, box_I.X + box_I.Width, box_I.Y + box_I.Height };
+		rects_O.push_back(r);
+	};
+
+	for (const auto &val : gTablets)
+	{
+		for (const auto &ek : val.second.expKeys)
+		{
+			if (ek.dirty)
+			{
+				add(ek.box);
+			}
+		}
+		for (const auto &tr : val.second.touchRings)
+		{
+			if (tr.dirty)
+			{
+				add(tr.box);
+			}
+		}
+		for (const auto &ts : val.second.touchStrips)
+		{
+			if (ts.dirty)
+			{
+				add(ts.box);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Forget a tablet's controls, before they are set up again or it is gone
+
+void Drawing::RemoveTablet(int tablet_I)
+{
+	gTablets.erase(tablet_I);
 	gDirty = true;
 }
 
@@ -117,12 +205,18 @@ void Drawing::Init(HWND hWnd_I)
 
 void Drawing::UpdateKeys(int tablet_I, int control_I, int, int state_I)
 {
-	if (gTablets.count(tablet_I))
+	const auto tablet = gTablets.find(tablet_I);
+	if (tablet != gTablets.end())
 	{
-		if (control_I < static_cast<int>(gTablets[tablet_I].expKeys.size()))
+		if (control_I < static_cast<int>(tablet->second.expKeys.size()))
 		{
-			gTablets[tablet_I].expKeys[control_I].down = (state_I != 0);
-			gDirty = true;
+			SExpKey &ek = tablet->second.expKeys[control_I];
+			const bool down = (state_I != 0);
+			if (ek.down != down)
+			{
+				ek.down = down;
+				ek.dirty = true;
+			}
 		}
 	}
 }
@@ -132,20 +226,12 @@ void Drawing::UpdateKeys(int tablet_I, int control_I, int, int state_I)
 
 void Drawing::UpdateRing(int tablet_I, int control_I, int function_I, int position_I)
 {
-	if (gTablets.count(tablet_I))
+	const auto tablet = gTablets.find(tablet_I);
+	if (tablet != gTablets.end())
 	{
-		if (control_I < static_cast<int>(gTablets[tablet_I].touchRings.size()))
+		if (control_I < static_cast<int>(tablet->second.touchRings.size()))
 		{
-			const int ringModes = static_cast<int>(gTablets[tablet_I].touchRings[control_I].modes.size());
-			gTablets[tablet_I].touchRings[control_I].down = (position_I != 0);
-			gTablets[tablet_I].touchRings[control_I].position = position_I - 1;
-
-			for (int i = 0; i < ringModes; ++i)
-			{
-				gTablets[tablet_I].touchRings[control_I].modes[i].active = ((i == function_I) || (ringModes == 1));
-			}
-
-			gDirty = true;
+			UpdateLinearControl(tablet->second.touchRings[control_I], function_I, position_I - 1, position_I != 0);
 		}
 	}
 }
@@ -155,48 +241,120 @@ void Drawing::UpdateRing(int tablet_I, int control_I, int function_I, int positi
 
 void Drawing::UpdateStrip(int tablet_I, int control_I, int function_I, int position_I)
 {
-	if (gTablets.count(tablet_I))
+	const auto tablet = gTablets.find(tablet_I);
+	if (tablet != gTablets.end())
 	{
-		if (control_I < static_cast<int>(gTablets[tablet_I].touchStrips.size()))
+		if (control_I < static_cast<int>(tablet->second.touchStrips.size()))
 		{
-			const int stripModes = static_cast<int>(gTablets[tablet_I].touchStrips[control_I].modes.size());
-			gTablets[tablet_I].touchStrips[control_I].down = (position_I != 0);
-			gTablets[tablet_I].touchStrips[control_I].position = position_I;
-
-			for (int i = 0; i < stripModes; ++i)
-			{
-				gTablets[tablet_I].touchStrips[control_I].modes[i].active = ((i == function_I) || (stripModes == 1));
-			}
-
-			gDirty = true;
+			UpdateLinearControl(tablet->second.touchStrips[control_I], function_I, position_I, position_I != 0);
 		}
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Perform redraw if necessary, blit to the given DC
+// Perform redraw if necessary, blit the DC's clip box to the given DC
+//
+// A full redraw lays the tablets out and draws the static layer again;
+// otherwise only the dirty glyphs are redrawn, over the static layer.
 
 void Drawing::PaintToHDC(HDC hdc)
 {
 	if (gDirty)
 	{
-		REAL x = 20;
 		REAL y = 20;
+		Graphics sg(gStaticLayer.get());
+		sg.SetSmoothingMode(SmoothingModeHighQuality);
+		sg.Clear(Color::White);
+
+		for (auto &val : gTablets)
+		{
+			LayoutTablet(val.second, 20, y);
+			DrawTabletStatic(sg, val.second);
+			y += 100;
+		}
+
 		Graphics g(gBackbuffer.get());
+		g.SetCompositingMode(CompositingModeSourceCopy);
+		g.DrawImage(gStaticLayer.get(), 0, 0);
+		g.SetCompositingMode(CompositingModeSourceOver);
 		g.SetSmoothingMode(SmoothingModeHighQuality);
-		g.Clear(Color::White);
 
-		for (const auto& val : gTablets)
+		for (auto &val : gTablets)
 		{
-			STablet tablet = val.second;
-			DrawTablet(g, tablet, x, y);
-			y += 100;
+			DrawTabletGlyphs(g, val.second, nullptr);
 		}
 		gDirty = false;
 	}
+	else
+	{
+		Graphics g(gBackbuffer.get());
+		g.SetSmoothingMode(SmoothingModeHighQuality);
 
+		for (auto &val : gTablets)
+		{
+			STablet &tablet = val.second;
+			for (auto &ek : tablet.expKeys)
+			{
+				if (ek.dirty)
+				{
+					RedrawBox(g, tablet, ek.box);
+				}
+			}
+			for (auto &tr : tablet.touchRings)
+			{
+				if (tr.dirty)
+				{
+					RedrawBox(g, tablet, tr.box);
+				}
+			}
+			for (auto &ts : tablet.touchStrips)
+			{
+				if (ts.dirty)
+				{
+					RedrawBox(g, tablet, ts.box);
+				}
+			}
+		}
+	}
+
+	// Everything drawn is clean, whether or not this paint shows it.
+	for (auto &val : gTablets)
+	{
+		for (auto &ek : val.second.expKeys)
+		{
+			ek.dirty = false;
+		}
+		for (auto &tr : val.second.touchRings)
+		{
+			tr.dirty = false;
+		}
+		for (auto &ts : val.second.touchStrips)
+		{
+			ts.dirty = false;
+		}
+	}
+
+	RECT clip = { 0 };
 	Graphics g(hdc);
-	g.DrawImage(gBackbuffer.get(), 0, 0);
+	const int region = GetClipBox(hdc, &clip);
+	if (region == NULLREGION)
+	{
+		return;
+	}
+	if (region != ERROR)
+	{
+		const INT width = std::min<INT>(clip.right, gBackbuffer->GetWidth()) - clip.left;
+		const INT height = std::min<INT>(clip.bottom, gBackbuffer->GetHeight()) - clip.top;
+		if (width > 0 && height > 0)
+		{
+			g.DrawImage(gBackbuffer.get(), Rect(clip.left, clip.top, width, height),
+				clip.left, clip.top, width, height, UnitPixel);
+		}
+	}
+	else
+	{
+		g.DrawImage(gBackbuffer.get(), 0, 0);
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -218,6 +376,7 @@ void Drawing::SetupKey(int tablet_I,
 	gTablets[tablet_I].expKeys[control_I].available = (availible_I != FALSE);
 	gTablets[tablet_I].expKeys[control_I].down = false;
 	gTablets[tablet_I].expKeys[control_I].location = location_I;
+	gDirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -248,6 +407,7 @@ void Drawing::SetupRing(int tablet_I,
 	gTablets[tablet_I].touchRings[control_I].position = 0;
 	gTablets[tablet_I].touchRings[control_I].modes[function_I].available = (availible_I != FALSE);
 	gTablets[tablet_I].touchRings[control_I].modes[function_I].active = false;
+	gDirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -278,6 +438,7 @@ void Drawing::SetupStrip(int tablet_I,
 	gTablets[tablet_I].touchStrips[control_I].position = 0;
 	gTablets[tablet_I].touchStrips[control_I].modes[function_I].available = (availible_I != FALSE);
 	gTablets[tablet_I].touchStrips[control_I].modes[function_I].active = false;
+	gDirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -331,42 +492,117 @@ wstring LocationLabel(int location_I)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Draw rectangles to represent ExpressKeys
+// Set a TouchRing's or TouchStrip's state from a packet; dirty if it shows
 
-void DrawExpKeys(Graphics &g_I, STablet &tablet_I, REAL x_I, REAL y_I)
+void UpdateLinearControl(SLinearControl &control_IO, int function_I, int position_I, bool down_I)
+{
+	const int modes = static_cast<int>(control_IO.modes.size());
+	bool changed = control_IO.down != down_I || (down_I && control_IO.position != position_I);
+
+	for (int i = 0; i < modes; ++i)
+	{
+		const bool active = ((i == function_I) || (modes == 1));
+		changed = changed || control_IO.modes[i].active != active;
+		control_IO.modes[i].active = active;
+	}
+
+	control_IO.down = down_I;
+	control_IO.position = position_I;
+	control_IO.dirty = control_IO.dirty || changed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Place a tablet's controls and their glyph boxes
+//
+// The boxes hold the antialiased edges: the needle of a ring reaches 27
+// pixels from its center, that of a strip 5 pixels past it.
+
+void LayoutTablet(STablet &tablet_IO, REAL x_I, REAL y_I)
 {
-	const int numButtonSets = 4;
 	REAL XOffsets[4] = {0,  0,  0,  0};
-	REAL YOffsets[4] = {5, 20, 35, 50};
+	const REAL YOffsets[4] = {5, 20, 35, 50};
 
-	// Draw labels
-	Font f(FontFamily::GenericSansSerif(), 9);
-	StringFormat sf;
+	tablet_IO.x = x_I;
+	tablet_IO.y = y_I;
+
+	for (auto &ek : tablet_IO.expKeys)
+	{
+		ek.x = x_I + 15 + XOffsets[ek.location];
+		ek.y = y_I + YOffsets[ek.location];
+		XOffsets[ek.location] += 15;
+		ek.box = Rect(static_cast<INT>(ek.x) - 2, static_cast<INT>(ek.y) - 2, 17, 15);
+	}
+	x_I += 140;
+
+	for (auto &tr : tablet_IO.touchRings)
+	{
+		const INT modesWidth = static_cast<INT>(tr.modes.size()) * 15;
+		tr.x = x_I;
+		tr.y = y_I;
+		tr.box = Rect(static_cast<INT>(x_I) - 8, static_cast<INT>(y_I) - 2, std::max<INT>(61, modesWidth + 10), 70);
+		x_I += 100;
+	}
+
+	for (auto &ts : tablet_IO.touchStrips)
+	{
+		const INT modesWidth = static_cast<INT>(ts.modes.size()) * 15;
+		ts.x = x_I;
+		ts.y = y_I;
+		ts.box = Rect(static_cast<INT>(x_I) - 3, static_cast<INT>(y_I) - 2, std::max<INT>(97, modesWidth + 5), 60);
+		x_I += 100;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Draw what does not change with packets: labels and outlines
+
+void DrawTabletStatic(Graphics &g_I, const STablet &tablet_I)
+{
+	const REAL YOffsets[4] = {5, 20, 35, 50};
+
+	// ExpressKey row labels
+	Font keyFont(FontFamily::GenericSansSerif(), 9);
 	SolidBrush brush(Color::Black);
 
-	for (int i=0; i < numButtonSets; ++i)
+	for (int i = 0; i < 4; ++i)
 	{
-		g_I.DrawString(LocationLabel(i).c_str(), -1, &f, PointF(x_I, y_I + YOffsets[i]-3), &brush);
+		g_I.DrawString(LocationLabel(i).c_str(), -1, &keyFont, PointF(tablet_I.x, tablet_I.y + YOffsets[i] - 3), &brush);
 	}
-	x_I += 15;
 
-	// Draw button rectangles
-	for (const auto &ek : tablet_I.expKeys)
+	// Circles and rectangles, with location indicators
+	Font f(FontFamily::GenericSansSerif(), 6);
+	StringFormat sf;
+	sf.SetAlignment(StringAlignmentCenter);
+	sf.SetLineAlignment(StringAlignmentCenter);
+
+	for (const auto &tr : tablet_I.touchRings)
 	{
-		REAL thisY = y_I + YOffsets[ek.location];
-		REAL thisX = x_I + XOffsets[ek.location];
-		XOffsets[ek.location] += 15;
+		g_I.DrawEllipse(gOutlinePen.get(), tr.x, tr.y + 15, 45.0, 45.0);
+		g_I.DrawString(LocationLabel(tr.location).c_str(), -1, &f,
+			PointF(static_cast<REAL>(tr.x + 22.5), static_cast<REAL>(tr.y + 37.5)), &sf, gBlack.get());
+	}
 
-		Brush *br = MyBrush(ek.available, ek.down);
-		g_I.FillRectangle(br, thisX, thisY, 12.0, 10.0);
-		g_I.DrawRectangle(gOutlinePen.get(), thisX, thisY, 12.0, 10.0);
+	for (const auto &ts : tablet_I.touchStrips)
+	{
+		g_I.DrawString(LocationLabel(ts.location).c_str(), -1, &f, PointF(ts.x + 45, ts.y + 40), &sf, gBlack.get());
+		g_I.DrawRectangle(gOutlinePen.get(), ts.x, ts.y + 30, 90.0, 20.0);
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Draw a rectangle to represent an ExpressKey
+
+void DrawExpKey(Graphics &g_I, const SExpKey &ek_I)
+{
+	Brush *br = MyBrush(ek_I.available, ek_I.down);
+	g_I.FillRectangle(br, ek_I.x, ek_I.y, 12.0, 10.0);
+	g_I.DrawRectangle(gOutlinePen.get(), ek_I.x, ek_I.y, 12.0, 10.0);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Draw a series of circles to represent modes
 
-void DrawModeBubbles(Graphics &g_I, vector<SMode> &modes_I, REAL x_I, REAL y_I)
+void DrawModeBubbles(Graphics &g_I, const vector<SMode> &modes_I, REAL x_I, REAL y_I)
 {
 	REAL modeOffset = 0;
 
@@ -380,25 +616,16 @@ void DrawModeBubbles(Graphics &g_I, vector<SMode> &modes_I, REAL x_I, REAL y_I)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Draw a circle with needle to represent a TouchRing
+// Draw the modes and needle of a TouchRing
 
-void DrawRing(Graphics &g_I, SLinearControl &ring_I, REAL x_I, REAL y_I)
+void DrawRing(Graphics &g_I, const SLinearControl &ring_I)
 {
-	DrawModeBubbles(g_I, ring_I.modes, x_I, y_I);
-
-	g_I.DrawEllipse(gOutlinePen.get(), x_I, y_I + 15, 45.0, 45.0);
-
-	// Draw location indicator
-	REAL centerX = static_cast<REAL>(x_I + 22.5);
-	REAL centerY = static_cast<REAL>(y_I + 37.5);
-	Font f(FontFamily::GenericSansSerif(), 6);
-	StringFormat sf;
-	sf.SetAlignment(StringAlignmentCenter);
-	sf.SetLineAlignment(StringAlignmentCenter);
-	g_I.DrawString(LocationLabel(ring_I.location).c_str(), -1, &f, PointF(centerX, centerY), &sf, gBlack.get());
+	DrawModeBubbles(g_I, ring_I.modes, ring_I.x, ring_I.y);
 
 	if (ring_I.down)
 	{
+		REAL centerX = static_cast<REAL>(ring_I.x + 22.5);
+		REAL centerY = static_cast<REAL>(ring_I.y + 37.5);
 		float pos = static_cast<float>(ring_I.position - ring_I.min);
 		int range = ring_I.max - ring_I.min;
 		REAL angle = static_cast<REAL>(pos/range * M_PI * 2 - (M_PI / 2));
@@ -414,19 +641,11 @@ void DrawRing(Graphics &g_I, SLinearControl &ring_I, REAL x_I, REAL y_I)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Draw a rectangle with needle to represent a TouchStrip
+// Draw the modes and needle of a TouchStrip
 
-void DrawStrip(Graphics &g_I, SLinearControl &strip_I, REAL x_I, REAL y_I)
+void DrawStrip(Graphics &g_I, const SLinearControl &strip_I)
 {
-	DrawModeBubbles(g_I, strip_I.modes, x_I, y_I);
-
-	// Draw location indicator
-	Font f(FontFamily::GenericSansSerif(), 6);
-	StringFormat sf;
-	sf.SetAlignment(StringAlignmentCenter);
-	sf.SetLineAlignment(StringAlignmentCenter);
-	g_I.DrawString(LocationLabel(strip_I.location).c_str(), -1, &f, PointF(x_I + 45, y_I + 40), &sf, gBlack.get());
-	g_I.DrawRectangle(gOutlinePen.get(), x_I, y_I + 30, 90.0, 20.0);
+	DrawModeBubbles(g_I, strip_I.modes, strip_I.x, strip_I.y);
 
 	if (strip_I.down)
 	{
@@ -434,27 +653,51 @@ void DrawStrip(Graphics &g_I, SLinearControl &strip_I, REAL x_I, REAL y_I)
 		float pos = static_cast<float>(strip_I.position - strip_I.min);
 		int range = strip_I.max - strip_I.min;
 		REAL offset = static_cast<REAL>(pos/range * 90);
-		g_I.DrawLine(&p, x_I + offset, y_I + 25, x_I + offset, y_I + 55);
+		g_I.DrawLine(&p, strip_I.x + offset, strip_I.y + 25, strip_I.x + offset, strip_I.y + 55);
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Draw all controls for a single tablet
+// Draw a tablet's glyphs, or those whose boxes meet clip_I
 
-void DrawTablet(Graphics &g_I, STablet &tablet_I, REAL x_I, REAL y_I)
+void DrawTabletGlyphs(Graphics &g_I, const STablet &tablet_I, const Rect *clip_I)
 {
-	DrawExpKeys(g_I, tablet_I, x_I, y_I);
-	x_I += 140;
+	for (const auto &ek : tablet_I.expKeys)
+	{
+		if (!clip_I || clip_I->IntersectsWith(ek.box))
+		{
+			DrawExpKey(g_I, ek);
+		}
+	}
 
-	for (auto &tr : tablet_I.touchRings)
+	for (const auto &tr : tablet_I.touchRings)
 	{
-		DrawRing(g_I, tr, x_I, y_I);
-		x_I += 100;
+		if (!clip_I || clip_I->IntersectsWith(tr.box))
+		{
+			DrawRing(g_I, tr);
+		}
 	}
 
-	for (auto &ts : tablet_I.touchStrips)
+	for (const auto &ts : tablet_I.touchStrips)
 	{
-		DrawStrip(g_I, ts, x_I, y_I);
-		x_I += 100;
+		if (!clip_I || clip_I->IntersectsWith(ts.box))
+		{
+			DrawStrip(g_I, ts);
+		}
 	}
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// Restore a box of the backbuffer from the static layer and draw the glyphs
+// in it again, neighbours overlapping it included
+
+void RedrawBox(Graphics &g_I, const STablet &tablet_I, const Rect &box_I)
+{
+	g_I.SetCompositingMode(CompositingModeSourceCopy);
+	g_I.DrawImage(gStaticLayer.get(), box_I, box_I.X, box_I.Y, box_I.Width, box_I.Height, UnitPixel);
+	g_I.SetCompositingMode(CompositingModeSourceOver);
+
+	g_I.SetClip(box_I);
+	DrawTabletGlyphs(g_I, tablet_I, &box_I);
+	g_I.ResetClip();
+}
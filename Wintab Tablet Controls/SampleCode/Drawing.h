@@ -27,9 +27,18 @@ namespace Drawing
 	void SetupStrip(int tablet_I, int control_I, int function_I, BOOL availible_I,
 		int location_I, int min_I, int max_I);
 
+	void RemoveTablet(int tablet_I);
+
+	// Each marks the control dirty if its state shows a change.
 	void UpdateKeys(int tablet_I, int control_I, int location_I, int state_I);
 	void UpdateRing(int tablet_I, int control_I, int function_I, int position_I);
 	void UpdateStrip(int tablet_I, int control_I, int function_I, int position_I);
 
+	// The rectangles to invalidate for the next PaintToHDC: the dirty
+	// controls', or the window's after setup or resizing.
+	void DirtyRects(std::vector<RECT> &rects_O);
+	void SetDirty(void);
+
+	// Redraws what is dirty, and copies the DC's clip box to it.
 	void PaintToHDC(HDC hdc_I);
 }
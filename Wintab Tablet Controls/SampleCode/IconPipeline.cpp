@@ -0,0 +1,641 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Implementation of the pipeline that turns image files into icons for
+//		control displays.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "IconPipeline.h"
+#include "Utils.h"
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#define ICON_PIPELINE_SSE2
+	#include <emmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Module-private types and functions
+
+namespace
+{
+	// Resampling weights are in 1/4096ths; the horizontal pass keeps 8
+	// fraction bits for the vertical one.
+	const int WEIGHT_BITS = 12;
+	const int FRACTION_BITS = 8;
+
+	const UINT32 CACHE_MAGIC = 0x4E4F4349;	// "ICON"
+
+	struct CacheHeader
+	{
+		UINT32		magic;
+		UINT32		version;
+		UINT64		key;
+		UINT64		checksum;
+		UINT32		size;
+		UINT32		reserved;
+	};
+
+	// Source pixels [first, first + weights.size()) make one output pixel.
+	struct Span
+	{
+		UINT					first;
+		std::vector<int>	weights;
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+	// 64-bit FNV-1a.
+
+	UINT64 Hash(const void *data_I, size_t size_I, UINT64 hash_I = 0xCBF29CE484222325ull)
+	{
+		const BYTE *bytes = static_cast<const BYTE *>(data_I);
+		for (size_t idx = 0; idx < size_I; ++idx)
+		{
+			hash_I = (hash_I ^ bytes[idx]) * 0x100000001B3ull;
+		}
+		return hash_I;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Identifies a converted icon: the image's content, the display's format
+	// and size, and the conversion.
+
+	UINT64 IconKey(UINT64 contentHash_I, UINT32 format_I, UINT32 width_I, UINT32 height_I)
+	{
+		const UINT32 parts[4] = { format_I, width_I, height_I, ICON_PIPELINE_VERSION };
+		return Hash(parts, sizeof(parts), Hash(&contentHash_I, sizeof(contentHash_I)));
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// x * 15 / 255, rounded, and x / 255 rounded, exactly, for x < 65281.
+
+	inline UINT Div255(UINT x_I)
+	{
+		x_I += 128;
+		return (x_I + (x_I >> 8)) >> 8;
+	}
+
+	inline BYTE Quantize4(BYTE gray_I)
+	{
+		return static_cast<BYTE>(Div255(gray_I * 15u));
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Output pixel i covers source [i * source / output, (i + 1) * source /
+	// output); each source pixel weighs its part of that, in integers that
+	// sum to 1 << WEIGHT_BITS.
+
+	std::vector<Span> MakeSpans(UINT source_I, UINT output_I)
+	{
+		std::vector<Span> spans(output_I);
+		const double scale = static_cast<double>(source_I) / output_I;
+		for (UINT i = 0; i < output_I; ++i)
+		{
+			const double start = i * scale;
+			const double end = std::min<double>((i + 1) * scale, source_I);
+			Span &span = spans[i];
+			span.first = static_cast<UINT>(start);
+
+			int total = 0;
+			size_t largest = 0;
+			for (UINT s = span.first; s < end; ++s)
+			{
+				const double cover = std::min<double>(s + 1, end) - std::max<double>(s, start);
+				const int weight = static_cast<int>(cover / (end - start) * (1 << WEIGHT_BITS) + 0.5);
+				span.weights.push_back(weight);
+				total += weight;
+				if (weight > span.weights[largest])
+				{
+					largest = span.weights.size() - 1;
+				}
+			}
+			span.weights[largest] += (1 << WEIGHT_BITS) - total;
+		}
+		return spans;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+IconPipeline::IconPipeline() :
+	mGdiToken(0),
+	mStats()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+IconPipeline::~IconPipeline()
+{
+	Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconPipeline::SetCacheDirectory(const std::string &directory_I)
+{
+	mCacheDirectory = directory_I;
+	if (!mCacheDirectory.empty())
+	{
+		// Fails harmlessly if it exists; if it cannot be made, cache files
+		// simply fail to open.
+		CreateDirectoryA(mCacheDirectory.c_str(), NULL);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Get the icon of an image file for a display.
+//	Parameters:
+//		path_I - The image file
+//		format_I - The display's TABLET_PROPERTY_ICON_FORMAT
+//		width_I, height_I - The display's TABLET_PROPERTY_ICON_WIDTH and _HEIGHT
+//	Return:
+//		const std::vector<BYTE>* - the icon, or nullptr if there is none
+//	Notes:
+//		A path is read once, to hash its content.  The icon comes from memory,
+//		else from the disk cache, else from the decoded image, which is
+//		decoded once.
+//
+const std::vector<BYTE> *IconPipeline::Icon(const std::string &path_I,
+														  UINT32 format_I,
+														  UINT32 width_I,
+														  UINT32 height_I)
+{
+	const size_t size = IconSize(format_I, width_I, height_I);
+	if (!size)
+	{
+		return nullptr;
+	}
+
+	auto pathHash = mPathHashes.find(path_I);
+	if (pathHash == mPathHashes.end())
+	{
+		std::ifstream file(path_I.c_str(), std::ios::in | std::ios::binary);
+		if (!file)
+		{
+			return nullptr;
+		}
+		const std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		++mStats.reads;
+		pathHash = mPathHashes.insert(std::make_pair(path_I, Hash(content.data(), content.size()))).first;
+	}
+
+	const UINT64 contentHash = pathHash->second;
+	const UINT64 key = IconKey(contentHash, format_I, width_I, height_I);
+	const auto found = mIcons.find(key);
+	if (found != mIcons.end())
+	{
+		++mStats.memoryHits;
+		return &found->second;
+	}
+
+	std::vector<BYTE> icon;
+	if (Load(key, size, icon))
+	{
+		++mStats.diskHits;
+	}
+	else
+	{
+		auto source = mSources.find(contentHash);
+		if (source == mSources.end())
+		{
+			GrayImage image;
+			if (!Decode(path_I, image))
+			{
+				return nullptr;
+			}
+			source = mSources.insert(std::make_pair(contentHash, std::move(image))).first;
+		}
+
+		if (!Convert(source->second, format_I, width_I, height_I, icon))
+		{
+			return nullptr;
+		}
+		Save(key, icon);
+	}
+
+	return &(mIcons[key] = std::move(icon));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconPipeline::ForgetPaths(void)
+{
+	mPathHashes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconPipeline::DeleteCacheFiles(void)
+{
+	if (mCacheDirectory.empty())
+	{
+		return;
+	}
+
+	for (const auto &icon : mIcons)
+	{
+		DeleteFileA(CachePath(icon.first).c_str());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconPipeline::Clear(void)
+{
+	mPathHashes.clear();
+	mSources.clear();
+	mIcons.clear();
+
+	if (mGdiToken)
+	{
+		Gdiplus::GdiplusShutdown(mGdiToken);
+		mGdiToken = 0;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TABLET_ICON_FMT_4BPP_GRAY rows start on a byte; the odd pixel of a row
+// takes the high nibble.
+
+size_t IconPipeline::IconSize(UINT32 format_I, UINT32 width_I, UINT32 height_I)
+{
+	switch (format_I)
+	{
+		case TABLET_ICON_FMT_4BPP_GRAY:
+		{
+			return static_cast<size_t>((width_I + 1) / 2) * height_I;
+		}
+		default:
+		{
+			return 0;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Convert 32-bit ARGB pixels, blue in the low byte, to gray
+//		premultiplied by alpha, so that transparency shows dark as on a display.
+//	Parameters:
+//		argb_I - The pixels
+//		count_I - The number of pixels
+//		gray_O - Receives count_I gray values
+//	Return:
+//		none
+//
+void IconPipeline::LuminanceReference(const UINT32 *argb_I,
+												  size_t count_I,
+												  BYTE *gray_O)
+{
+	for (size_t idx = 0; idx < count_I; ++idx)
+	{
+		const UINT32 p = argb_I[idx];
+		const UINT luma = (29 * (p & 0xFF) + 150 * ((p >> 8) & 0xFF) + 77 * ((p >> 16) & 0xFF) + 128) >> 8;
+		gray_O[idx] = static_cast<BYTE>(Div255(luma * (p >> 24)));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		LuminanceReference, eight pixels at a time.
+//
+void IconPipeline::Luminance(const UINT32 *argb_I,
+									  size_t count_I,
+									  BYTE *gray_O)
+{
+	size_t idx = 0;
+
+#if defined(ICON_PIPELINE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weights = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0);
+	const __m128i half32 = _mm_set1_epi32(128);
+	const __m128i half16 = _mm_set1_epi16(128);
+
+	// Luma of four pixels, one per 32-bit lane: pmaddwd gives b and g, and
+	// r, of each pixel in two lanes, which the shuffles line up to add.
+	const auto luma4 = [&](__m128i pixels_I)
+	{
+		const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels_I, zero), weights);
+		const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels_I, zero), weights);
+		const __m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1)));
+		return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(even, odd), half32), 8);
+	};
+
+	for (; idx + 8 <= count_I; idx += 8)
+	{
+		const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(argb_I + idx));
+		const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(argb_I + idx + 4));
+
+		// Luma and alpha are at most 255, and their product fits 16 bits
+		// unsigned, as does Div255's rounding of it.
+		const __m128i luma = _mm_packs_epi32(luma4(p0), luma4(p1));
+		const __m128i alpha = _mm_packs_epi32(_mm_srli_epi32(p0, 24), _mm_srli_epi32(p1, 24));
+		__m128i v = _mm_add_epi16(_mm_mullo_epi16(luma, alpha), half16);
+		v = _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(gray_O + idx), _mm_packus_epi16(v, zero));
+	}
+#endif
+
+	LuminanceReference(argb_I + idx, count_I - idx, gray_O + idx);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Scale a gray image to fit width_I x height_I, keeping its aspect ratio,
+//		centered on black.
+//	Parameters:
+//		source_I - The image
+//		width_I, height_I - The size to fit
+//		gray_O - Receives width_I x height_I gray values
+//	Return:
+//		none
+//	Notes:
+//		Each output pixel is the average of the source area it covers, in two
+//		separable passes.
+//
+void IconPipeline::Resample(const GrayImage &source_I,
+									 UINT width_I,
+									 UINT height_I,
+									 std::vector<BYTE> &gray_O)
+{
+	gray_O.assign(static_cast<size_t>(width_I) * height_I, 0);
+	if (!source_I.width || !source_I.height || !width_I || !height_I)
+	{
+		return;
+	}
+
+	const double scale = std::min<double>(static_cast<double>(width_I) / source_I.width,
+		static_cast<double>(height_I) / source_I.height);
+	const UINT fitWidth = std::max<UINT>(1u, std::min<UINT>(width_I, static_cast<UINT>(source_I.width * scale + 0.5)));
+	const UINT fitHeight = std::max<UINT>(1u, std::min<UINT>(height_I, static_cast<UINT>(source_I.height * scale + 0.5)));
+	const UINT left = (width_I - fitWidth) / 2;
+	const UINT top = (height_I - fitHeight) / 2;
+
+	const std::vector<Span> columns = MakeSpans(source_I.width, fitWidth);
+	const std::vector<Span> rows = MakeSpans(source_I.height, fitHeight);
+
+	// Horizontal pass, to FRACTION_BITS fixed point.
+	std::vector<USHORT> horizontal(static_cast<size_t>(fitWidth) * source_I.height);
+	for (UINT y = 0; y < source_I.height; ++y)
+	{
+		const BYTE *in = &source_I.pixels[static_cast<size_t>(y) * source_I.width];
+		USHORT *out = &horizontal[static_cast<size_t>(y) * fitWidth];
+		for (UINT x = 0; x < fitWidth; ++x)
+		{
+			const Span &span = columns[x];
+			UINT sum = 0;
+			for (size_t tap = 0; tap < span.weights.size(); ++tap)
+			{
+				sum += in[span.first + tap] * span.weights[tap];
+			}
+			out[x] = static_cast<USHORT>((sum + (1 << (WEIGHT_BITS - FRACTION_BITS - 1))) >> (WEIGHT_BITS - FRACTION_BITS));
+		}
+	}
+
+	// Vertical pass, into the centered area.
+	for (UINT y = 0; y < fitHeight; ++y)
+	{
+		const Span &span = rows[y];
+		BYTE *out = &gray_O[static_cast<size_t>(top + y) * width_I + left];
+		for (UINT x = 0; x < fitWidth; ++x)
+		{
+			UINT sum = 0;
+			for (size_t tap = 0; tap < span.weights.size(); ++tap)
+			{
+				sum += horizontal[static_cast<size_t>(span.first + tap) * fitWidth + x] * span.weights[tap];
+			}
+			out[x] = static_cast<BYTE>(std::min<UINT>(255u, (sum + (1 << (WEIGHT_BITS + FRACTION_BITS - 1))) >> (WEIGHT_BITS + FRACTION_BITS)));
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Pack gray to TABLET_ICON_FMT_4BPP_GRAY.
+//	Parameters:
+//		gray_I - width_I x height_I gray values
+//		width_I, height_I - The size
+//		packed_O - Receives IconSize(TABLET_ICON_FMT_4BPP_GRAY, ...) bytes
+//	Return:
+//		none
+//	Notes:
+//		The first pixel of each pair takes the high nibble.
+//
+void IconPipeline::PackGray4Reference(const BYTE *gray_I,
+												  UINT width_I,
+												  UINT height_I,
+												  BYTE *packed_O)
+{
+	for (UINT y = 0; y < height_I; ++y)
+	{
+		const BYTE *in = gray_I + static_cast<size_t>(y) * width_I;
+		BYTE *out = packed_O + static_cast<size_t>(y) * ((width_I + 1) / 2);
+		for (UINT x = 0; x < width_I; x += 2)
+		{
+			const BYTE second = x + 1 < width_I ? Quantize4(in[x + 1]) : 0;
+			out[x / 2] = static_cast<BYTE>((Quantize4(in[x]) << 4) | second);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		PackGray4Reference, sixteen pixels at a time.
+//
+void IconPipeline::PackGray4(const BYTE *gray_I,
+									  UINT width_I,
+									  UINT height_I,
+									  BYTE *packed_O)
+{
+#if defined(ICON_PIPELINE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i fifteen = _mm_set1_epi16(15);
+	const __m128i half16 = _mm_set1_epi16(128);
+	const __m128i lowNibbles = _mm_set1_epi32(0xF0);
+
+	// Two pixels per 32-bit lane, the first in the low half: the first to
+	// the high nibble of the lane's low byte, the second to its low nibble.
+	const auto pack8 = [&](__m128i gray16_I)
+	{
+		__m128i q = _mm_add_epi16(_mm_mullo_epi16(gray16_I, fifteen), half16);
+		q = _mm_srli_epi16(_mm_add_epi16(q, _mm_srli_epi16(q, 8)), 8);
+		return _mm_or_si128(_mm_and_si128(_mm_slli_epi32(q, 4), lowNibbles), _mm_srli_epi32(q, 16));
+	};
+
+	const UINT stride = (width_I + 1) / 2;
+	for (UINT y = 0; y < height_I; ++y)
+	{
+		const BYTE *in = gray_I + static_cast<size_t>(y) * width_I;
+		BYTE *out = packed_O + static_cast<size_t>(y) * stride;
+
+		UINT x = 0;
+		for (; x + 16 <= width_I; x += 16)
+		{
+			const __m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x));
+			const __m128i packed = _mm_packs_epi32(pack8(_mm_unpacklo_epi8(gray, zero)), pack8(_mm_unpackhi_epi8(gray, zero)));
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(out + x / 2), _mm_packus_epi16(packed, zero));
+		}
+
+		// The rest of the row, x even.
+		PackGray4Reference(in + x, width_I - x, 1, out + x / 2);
+	}
+#else
+	PackGray4Reference(gray_I, width_I, height_I, packed_O);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Decode an image file to gray with GDI+.
+//	Parameters:
+//		path_I - The image file
+//		image_O - Receives the image
+//	Return:
+//		bool - true if decoded
+//
+bool IconPipeline::Decode(const std::string &path_I,
+								  GrayImage &image_O)
+{
+	if (!mGdiToken)
+	{
+		Gdiplus::GdiplusStartupInput gdisi;
+		Gdiplus::GdiplusStartup(&mGdiToken, &gdisi, NULL);
+	}
+
+	const std::wstring widePath(path_I.begin(), path_I.end());
+	Gdiplus::Bitmap bitmap(widePath.c_str());
+	if (bitmap.GetLastStatus() != Gdiplus::Ok)
+	{
+		return false;
+	}
+
+	const UINT width = bitmap.GetWidth();
+	const UINT height = bitmap.GetHeight();
+	Gdiplus::Rect rect(0, 0, static_cast<INT>(width), static_cast<INT>(height));
+	Gdiplus::BitmapData data;
+	if (bitmap.LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppARGB, &data) != Gdiplus::Ok)
+	{
+		return false;
+	}
+
+	image_O.width = width;
+	image_O.height = height;
+	image_O.pixels.resize(static_cast<size_t>(width) * height);
+	for (UINT y = 0; y < height; ++y)
+	{
+		const BYTE *row = static_cast<const BYTE *>(data.Scan0) + static_cast<ptrdiff_t>(y) * data.Stride;
+		Luminance(reinterpret_cast<const UINT32 *>(row), width, &image_O.pixels[static_cast<size_t>(y) * width]);
+	}
+
+	bitmap.UnlockBits(&data);
+	++mStats.decodes;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool IconPipeline::Convert(const GrayImage &source_I,
+									UINT32 format_I,
+									UINT32 width_I,
+									UINT32 height_I,
+									std::vector<BYTE> &icon_O)
+{
+	std::vector<BYTE> gray;
+	Resample(source_I, width_I, height_I, gray);
+
+	icon_O.resize(IconSize(format_I, width_I, height_I));
+	switch (format_I)
+	{
+		case TABLET_ICON_FMT_4BPP_GRAY:
+		{
+			PackGray4(gray.data(), width_I, height_I, icon_O.data());
+			break;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+
+	++mStats.converts;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Read a converted icon from the disk cache.
+//	Return:
+//		bool - true if the file exists and holds the icon, whole
+//
+bool IconPipeline::Load(UINT64 key_I,
+								size_t size_I,
+								std::vector<BYTE> &icon_O)
+{
+	if (mCacheDirectory.empty())
+	{
+		return false;
+	}
+
+	std::ifstream file(CachePath(key_I).c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	CacheHeader header = { 0 };
+	icon_O.resize(size_I);
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	file.read(reinterpret_cast<char *>(icon_O.data()), size_I);
+	if (!file || header.magic != CACHE_MAGIC || header.version != ICON_PIPELINE_VERSION ||
+		header.key != key_I || header.size != size_I || header.checksum != Hash(icon_O.data(), size_I))
+	{
+		++mStats.diskRejects;
+		return false;
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconPipeline::Save(UINT64 key_I,
+								const std::vector<BYTE> &icon_I)
+{
+	if (mCacheDirectory.empty())
+	{
+		return;
+	}
+
+	// The checksum rejects a file left half written.
+	const CacheHeader header = { CACHE_MAGIC, ICON_PIPELINE_VERSION, key_I,
+		Hash(icon_I.data(), icon_I.size()), static_cast<UINT32>(icon_I.size()), 0 };
+	std::ofstream file(CachePath(key_I).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(icon_I.data()), icon_I.size());
+	if (file)
+	{
+		++mStats.diskWrites;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string IconPipeline::CachePath(UINT64 key_I) const
+{
+	char name[32] = { 0 };
+	sprintf_s(name, sizeof(name), "%016llx.icon", static_cast<unsigned long long>(key_I));
+	return mCacheDirectory + name;
+}
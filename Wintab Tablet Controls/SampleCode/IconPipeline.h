@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Declarations for the pipeline that turns image files into icons for
+//		control displays.
+//
+//		A display takes its icon in the format and size the control
+//		reports, e.g. 4 bits per pixel of gray, two pixels per byte.  The
+//		pipeline decodes each image once, to gray premultiplied by its
+//		alpha, scales it to fit each display size, and packs it eight or
+//		sixteen pixels at a time with SSE2.  Converted icons are kept in
+//		memory and on disk by the content hash of the image, so that
+//		setting the same icons again, or in the next session, decodes and
+//		converts nothing.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Bump when the conversion changes, so that icons cached on disk by an
+// older version are not used.
+#define ICON_PIPELINE_VERSION		1
+
+///////////////////////////////////////////////////////////////////////////////
+// 8-bit gray, row after row.
+//
+struct GrayImage
+{
+	UINT					width;
+	UINT					height;
+	std::vector<BYTE>	pixels;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct IconPipelineStats
+{
+	unsigned long long	reads;			// image files read to hash them
+	unsigned long long	decodes;
+	unsigned long long	converts;
+	unsigned long long	memoryHits;
+	unsigned long long	diskHits;
+	unsigned long long	diskWrites;
+	unsigned long long	diskRejects;	// cache files unreadable, or of another version
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class IconPipeline
+{
+public:
+	IconPipeline();
+	~IconPipeline();
+
+	IconPipeline(const IconPipeline &) = delete;
+	IconPipeline &operator=(const IconPipeline &) = delete;
+
+	// Directory to cache converted icons in, created if needed, with a
+	// trailing separator.  Empty for none, the default.
+	void SetCacheDirectory(const std::string &directory_I);
+
+	// The icon of an image file for a display of format_I (TABLET_ICON_FMT_)
+	// and size.  nullptr if the file cannot be read or decoded, or the
+	// format is not supported.  Valid until Clear.
+	const std::vector<BYTE> *Icon(const std::string &path_I, UINT32 format_I, UINT32 width_I, UINT32 height_I);
+
+	// Forgets which content each path has, after the files changed.
+	void ForgetPaths(void);
+
+	// Deletes the cache files of the icons in memory.
+	void DeleteCacheFiles(void);
+
+	// Forgets everything in memory; the cache files stay.
+	void Clear(void);
+
+	const IconPipelineStats &Stats(void) const { return mStats; }
+	void ResetStats(void) { mStats = IconPipelineStats(); }
+
+	// Bytes of an icon, 0 if the format is not supported.
+	static size_t IconSize(UINT32 format_I, UINT32 width_I, UINT32 height_I);
+
+	// The conversion steps, public for the benchmark.  Luminance and
+	// PackGray4 use SSE2 where available; the references compute the same
+	// result one pixel at a time.
+	static void Luminance(const UINT32 *argb_I, size_t count_I, BYTE *gray_O);
+	static void LuminanceReference(const UINT32 *argb_I, size_t count_I, BYTE *gray_O);
+	static void Resample(const GrayImage &source_I, UINT width_I, UINT height_I, std::vector<BYTE> &gray_O);
+	static void PackGray4(const BYTE *gray_I, UINT width_I, UINT height_I, BYTE *packed_O);
+	static void PackGray4Reference(const BYTE *gray_I, UINT width_I, UINT height_I, BYTE *packed_O);
+
+private:
+	bool Decode(const std::string &path_I, GrayImage &image_O);
+	bool Convert(const GrayImage &source_I, UINT32 format_I, UINT32 width_I, UINT32 height_I, std::vector<BYTE> &icon_O);
+	bool Load(UINT64 key_I, size_t size_I, std::vector<BYTE> &icon_O);
+	void Save(UINT64 key_I, const std::vector<BYTE> &icon_I);
+	std::string CachePath(UINT64 key_I) const;
+
+	std::string								mCacheDirectory;
+	std::map<std::string, UINT64>		mPathHashes;	// content hash by path
+	std::map<UINT64, GrayImage>			mSources;		// decoded, by content hash
+	std::map<UINT64, std::vector<BYTE>>	mIcons;			// converted, by IconKey
+	ULONG_PTR								mGdiToken;
+	IconPipelineStats						mStats;
+};
@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Implementation of the scheduler of icon uploads to control displays.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "IconScheduler.h"
+#include "Utils.h"
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+
+IconScheduler::IconScheduler(ControlCache &controls_I) :
+	mControls(controls_I),
+	mRate(ICON_SCHEDULER_DEFAULT_RATE),
+	mBurst(ICON_SCHEDULER_DEFAULT_BURST),
+	mPendingCount(0),
+	mSequence(0),
+	mStats()
+{
+	for (Budget &budget : mBudgets)
+	{
+		budget = Budget { 0.0, 0, false };
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconScheduler::SetBudget(UINT bytesPerSecond_I,
+										UINT burstBytes_I)
+{
+	mRate = bytesPerSecond_I;
+	mBurst = burstBytes_I;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Queue a control's next icon.
+//	Parameters:
+//		func_I - The control function
+//		icon_I - The icon, in the control's format
+//		priority_I - Whether the icon shows a change of state
+//		nowMs_I - The time, on the clock given to Pump
+//	Return:
+//		none
+//	Notes:
+//		An icon equal to the one shown replaces, and so cancels, any icon
+//		still waiting.
+//
+void IconScheduler::Submit(const ControlFunction &func_I,
+									const std::vector<BYTE> &icon_I,
+									IconPriority priority_I,
+									ULONGLONG nowMs_I)
+{
+	++mStats.submitted;
+
+	Slot &slot = mSlots[SlotKey(func_I)];
+	slot.func = func_I;
+
+	if (slot.hasUploaded && slot.uploaded == icon_I)
+	{
+		++mStats.unchanged;
+		if (slot.hasPending)
+		{
+			++mStats.superseded;
+			DropPending(slot);
+		}
+		return;
+	}
+
+	if (slot.hasPending)
+	{
+		++mStats.superseded;
+		if (slot.priority == ICON_PRIORITY_ANIMATION && priority_I == ICON_PRIORITY_STATE)
+		{
+			slot.submittedMs = nowMs_I;
+		}
+		slot.priority = std::max<IconPriority>(slot.priority, priority_I);
+	}
+	else
+	{
+		slot.hasPending = true;
+		slot.priority = priority_I;
+		slot.sequence = mSequence++;
+		slot.submittedMs = nowMs_I;
+		++mPendingCount;
+	}
+
+	// Reuses the slot's buffer once it has grown to the icon size.
+	slot.pending.assign(icon_I.begin(), icon_I.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Upload the waiting icons that the tablets' budgets allow.
+//	Parameters:
+//		nowMs_I - The time
+//	Return:
+//		size_t - the number of icons uploaded
+//	Notes:
+//		Icons go in priority order per tablet; when a tablet cannot afford
+//		its next icon, the rest of its icons wait for the next pump, so that
+//		small animation frames cannot starve a state change.  An icon larger
+//		than the burst goes when the budget is full.
+//
+size_t IconScheduler::Pump(ULONGLONG nowMs_I)
+{
+	if (!mPendingCount)
+	{
+		return 0;
+	}
+
+	mOrder.clear();
+	for (auto &entry : mSlots)
+	{
+		if (entry.second.hasPending)
+		{
+			mOrder.push_back(&entry.second);
+		}
+	}
+	std::sort(mOrder.begin(), mOrder.end(),
+		[](const Slot *a_I, const Slot *b_I)
+		{
+			return a_I->priority != b_I->priority ? a_I->priority > b_I->priority : a_I->sequence < b_I->sequence;
+		});
+
+	bool refilled[CONTROL_CACHE_MAX_TABLETS] = { false };
+	bool blocked[CONTROL_CACHE_MAX_TABLETS] = { false };
+	size_t uploads = 0;
+	for (Slot *slot : mOrder)
+	{
+		const UINT tablet = slot->func.tablet;
+		if (tablet >= CONTROL_CACHE_MAX_TABLETS || blocked[tablet])
+		{
+			continue;
+		}
+
+		Budget &budget = mBudgets[tablet];
+		if (!refilled[tablet])
+		{
+			refilled[tablet] = true;
+			if (!budget.started)
+			{
+				budget = Budget { static_cast<double>(mBurst), nowMs_I, true };
+			}
+			else if (nowMs_I > budget.lastMs)
+			{
+				budget.bytes = std::min<double>(mBurst, budget.bytes + (nowMs_I - budget.lastMs) * mRate / 1000.0);
+				budget.lastMs = nowMs_I;
+			}
+		}
+
+		const size_t size = slot->pending.size();
+		if (budget.bytes < size && budget.bytes < mBurst)
+		{
+			blocked[tablet] = true;
+			++mStats.deferrals;
+			continue;
+		}
+		budget.bytes -= size;
+
+		if (mControls.Set(slot->func.extension, slot->func.tablet, slot->func.control, slot->func.function,
+			TABLET_PROPERTY_OVERRIDE_ICON, slot->pending))
+		{
+			++uploads;
+			++mStats.uploads;
+			mStats.bytesUploaded += size;
+			if (slot->priority == ICON_PRIORITY_STATE)
+			{
+				mStats.maxStateDelayMs = std::max<unsigned long long>(mStats.maxStateDelayMs,
+					nowMs_I > slot->submittedMs ? nowMs_I - slot->submittedMs : 0);
+			}
+			slot->uploaded.swap(slot->pending);
+			slot->hasUploaded = true;
+		}
+		else
+		{
+			// Not retried: the tablet is likely gone, and WT_INFOCHANGE will
+			// set its controls up again.  The next icon goes in full.
+			++mStats.failures;
+			slot->hasUploaded = false;
+		}
+		DropPending(*slot);
+	}
+	return uploads;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconScheduler::Forget(UINT tablet_I)
+{
+	for (auto entry = mSlots.begin(); entry != mSlots.end(); )
+	{
+		if (entry->second.func.tablet == tablet_I)
+		{
+			DropPending(entry->second);
+			entry = mSlots.erase(entry);
+		}
+		else
+		{
+			++entry;
+		}
+	}
+
+	if (tablet_I < CONTROL_CACHE_MAX_TABLETS)
+	{
+		mBudgets[tablet_I].started = false;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconScheduler::Clear(void)
+{
+	mSlots.clear();
+	mOrder.clear();
+	mPendingCount = 0;
+	for (Budget &budget : mBudgets)
+	{
+		budget.started = false;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////
+
+UINT64 IconScheduler::SlotKey(const ControlFunction &func_I)
+{
+	return (static_cast<UINT64>(func_I.tablet) << 48) | (static_cast<UINT64>(func_I.extension & 0xFFFF) << 32) |
+		(static_cast<UINT64>(func_I.control & 0xFFFF) << 16) | (func_I.function & 0xFFFF);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void IconScheduler::DropPending(Slot &slot_IO)
+{
+	if (slot_IO.hasPending)
+	{
+		slot_IO.hasPending = false;
+		--mPendingCount;
+	}
+}
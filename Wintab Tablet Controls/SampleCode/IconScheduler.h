@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Declarations for the scheduler of icon uploads to control displays.
+//
+//		Every icon set is a whole icon sent to the tablet, and an animation
+//		sends one per frame.  The scheduler keeps the last icon uploaded to
+//		each control and the newest one waiting.  A frame equal to the
+//		uploaded icon is dropped, and a frame replaced before its turn is
+//		never sent.  Uploads to each tablet are limited to a byte budget per
+//		second; state changes go before animation frames, then the oldest
+//		first.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ControlCache.h"
+
+#include <map>
+#include <vector>
+
+// Bytes per second each tablet may take, and how many it may take at once.
+// The burst covers a full set of 64x32 key icons.
+#define ICON_SCHEDULER_DEFAULT_RATE		32768
+#define ICON_SCHEDULER_DEFAULT_BURST	8192
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum IconPriority
+{
+	ICON_PRIORITY_ANIMATION,	// a frame that the next one replaces
+	ICON_PRIORITY_STATE			// a change the user must see, e.g. recording
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct IconSchedulerStats
+{
+	unsigned long long	submitted;
+	unsigned long long	unchanged;			// frames equal to the icon shown
+	unsigned long long	superseded;			// frames replaced before upload
+	unsigned long long	uploads;
+	unsigned long long	bytesUploaded;
+	unsigned long long	failures;			// uploads the tablet refused
+	unsigned long long	deferrals;			// pumps that left a tablet's icons waiting
+	unsigned long long	maxStateDelayMs;	// longest wait of a state change
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class IconScheduler
+{
+public:
+	explicit IconScheduler(ControlCache &controls_I);
+
+	IconScheduler(const IconScheduler &) = delete;
+	IconScheduler &operator=(const IconScheduler &) = delete;
+
+	void SetBudget(UINT bytesPerSecond_I, UINT burstBytes_I);
+
+	// Queues func_I's next icon, replacing any still waiting.  A waiting
+	// state change keeps its priority.  nowMs_I is a millisecond clock such
+	// as GetTickCount64, the one given to Pump.
+	void Submit(const ControlFunction &func_I, const std::vector<BYTE> &icon_I, IconPriority priority_I,
+		ULONGLONG nowMs_I);
+
+	// Uploads what the budgets allow at nowMs_I.  Returns the number
+	// uploaded.
+	size_t Pump(ULONGLONG nowMs_I);
+
+	bool Pending(void) const { return mPendingCount != 0; }
+
+	// Forgets a tablet's icons, after its controls changed.
+	void Forget(UINT tablet_I);
+
+	// Forgets everything, the budgets aside.
+	void Clear(void);
+
+	const IconSchedulerStats &Stats(void) const { return mStats; }
+	void ResetStats(void) { mStats = IconSchedulerStats(); }
+
+private:
+	struct Slot
+	{
+		ControlFunction		func;
+		std::vector<BYTE>		uploaded;
+		std::vector<BYTE>		pending;
+		bool						hasUploaded;
+		bool						hasPending;
+		IconPriority			priority;
+		unsigned long long	sequence;		// of the oldest frame waiting
+		ULONGLONG				submittedMs;	// of the state change waiting
+	};
+
+	struct Budget
+	{
+		double					bytes;
+		ULONGLONG				lastMs;
+		bool						started;
+	};
+
+	static UINT64 SlotKey(const ControlFunction &func_I);
+	void DropPending(Slot &slot_IO);
+
+	ControlCache						&mControls;
+	std::map<UINT64, Slot>			mSlots;
+	std::vector<Slot *>				mOrder;			// scratch for Pump
+	Budget								mBudgets[CONTROL_CACHE_MAX_TABLETS];
+	UINT									mRate;
+	UINT									mBurst;
+	size_t								mPendingCount;
+	unsigned long long				mSequence;
+	IconSchedulerStats				mStats;
+};
@@ -0,0 +1,429 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Implementation of the motion engine of TouchRings and TouchStrips.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "SliderMotion.h"
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+
+SliderMotion::SliderMotion() :
+	mSmoothingMs(SLIDER_MOTION_DEFAULT_SMOOTHING_MS),
+	mInertia(true),
+	mFrictionMs(SLIDER_MOTION_DEFAULT_FRICTION_MS),
+	mStopVelocity(SLIDER_MOTION_DEFAULT_STOP_VELOCITY),
+	mCoasting(0),
+	mStats()
+{
+	Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void SliderMotion::SetSmoothing(double timeConstantMs_I)
+{
+	mSmoothingMs = timeConstantMs_I;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void SliderMotion::SetInertia(bool enabled_I,
+										double frictionMs_I,
+										double stopVelocity_I)
+{
+	mInertia = enabled_I;
+	mFrictionMs = frictionMs_I;
+	mStopVelocity = stopVelocity_I;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Set up a control for tracking.
+//	Parameters:
+//		kind_I, tablet_I, control_I - The control
+//		min_I, max_I - Its TABLET_PROPERTY_MIN and TABLET_PROPERTY_MAX
+//	Return:
+//		none
+//	Notes:
+//		A ring's positions run MIN to MAX and around, so MAX - MIN + 1 of
+//		them make a turn.
+//
+void SliderMotion::Setup(SliderKind kind_I,
+								 UINT tablet_I,
+								 UINT control_I,
+								 UINT32 min_I,
+								 UINT32 max_I)
+{
+	if (tablet_I >= SLIDER_MOTION_MAX_TABLETS || control_I >= SLIDER_MOTION_MAX_CONTROLS || max_I < min_I)
+	{
+		return;
+	}
+
+	Control &control = mControls[kind_I][tablet_I][control_I];
+	if (control.coasting)
+	{
+		--mCoasting;
+	}
+	control = Control();
+	control.setUp = true;
+	control.min = min_I;
+	control.max = max_I;
+	control.period = kind_I == SLIDER_RING ? static_cast<double>(max_I) - min_I + 1 : 0.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void SliderMotion::Forget(UINT tablet_I)
+{
+	if (tablet_I >= SLIDER_MOTION_MAX_TABLETS)
+	{
+		return;
+	}
+
+	for (int kind = 0; kind < SLIDER_KINDS; ++kind)
+	{
+		for (Control &control : mControls[kind][tablet_I])
+		{
+			if (control.coasting)
+			{
+				--mCoasting;
+			}
+			control = Control();
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void SliderMotion::Clear(void)
+{
+	for (int kind = 0; kind < SLIDER_KINDS; ++kind)
+	{
+		for (int tablet = 0; tablet < SLIDER_MOTION_MAX_TABLETS; ++tablet)
+		{
+			for (Control &control : mControls[kind][tablet])
+			{
+				control = Control();
+			}
+		}
+	}
+	mCoasting = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Track a ring's or strip's packet data.
+//	Parameters:
+//		kind_I - Whether the data is pkTouchRing or pkTouchStrip
+//		data_I - The data
+//		timeMs_I - The packet's time
+//		event_O - Receives the motion
+//	Return:
+//		bool - true if the finger touched, moved or lifted
+//	Notes:
+//		A touch, or a change of mode while touching, starts over, with no
+//		delta.  The velocity decays for as long as the finger rests, so a
+//		finger that stops before it lifts does not coast.
+//
+bool SliderMotion::Packet(SliderKind kind_I,
+								  const SLIDERDATA &data_I,
+								  DWORD timeMs_I,
+								  SliderMotionEvent &event_O)
+{
+	++mStats.packets;
+
+	Control *control = Find(kind_I, data_I.nTablet, data_I.nControl);
+	if (!control)
+	{
+		++mStats.ignored;
+		return false;
+	}
+
+	if (data_I.nPosition == 0)
+	{
+		if (!control->touching)
+		{
+			return false;
+		}
+
+		++mStats.lifts;
+		control->touching = false;
+		Smooth(*control, 0.0, timeMs_I - control->lastMs);
+		control->lastMs = timeMs_I;
+
+		if (mInertia && control->moved && fabs(control->velocity) >= mStopVelocity)
+		{
+			control->coasting = true;
+			++mCoasting;
+			++mStats.coasts;
+		}
+		else
+		{
+			control->velocity = 0.0;
+		}
+
+		Fill(*control, kind_I, data_I.nTablet, data_I.nControl, 0.0, event_O);
+		return true;
+	}
+
+	const double position = kind_I == SLIDER_RING ? data_I.nPosition - 1.0 : static_cast<double>(data_I.nPosition);
+	if (!control->touching || control->mode != data_I.nMode)
+	{
+		if (control->coasting)
+		{
+			control->coasting = false;
+			--mCoasting;
+		}
+
+		++mStats.touches;
+		control->touching = true;
+		control->moved = false;
+		control->mode = data_I.nMode;
+		control->position = position;
+		control->velocity = 0.0;
+		control->lastMs = timeMs_I;
+
+		Fill(*control, kind_I, data_I.nTablet, data_I.nControl, 0.0, event_O);
+		return true;
+	}
+
+	double delta = position - control->position;
+	if (delta == 0.0)
+	{
+		return false;
+	}
+
+	// The short way around a ring
+	if (control->period > 0.0)
+	{
+		if (delta > control->period / 2)
+		{
+			delta -= control->period;
+			++mStats.wraps;
+		}
+		else if (delta < -control->period / 2)
+		{
+			delta += control->period;
+			++mStats.wraps;
+		}
+	}
+
+	// Packets may share a millisecond.
+	const DWORD elapsedMs = timeMs_I - control->lastMs;
+	const double instant = delta * 1000.0 / std::max<DWORD>(elapsedMs, 1);
+	if (control->moved)
+	{
+		Smooth(*control, instant, elapsedMs);
+	}
+	else
+	{
+		control->velocity = instant;
+		control->moved = true;
+	}
+
+	++mStats.moves;
+	control->position = position;
+	control->lastMs = timeMs_I;
+
+	Fill(*control, kind_I, data_I.nTablet, data_I.nControl, delta, event_O);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Move the coasting controls on.
+//	Parameters:
+//		nowMs_I - The time
+//		events_O - Receives an event per coasting control
+//		capacity_I - The number of events events_O holds
+//	Return:
+//		size_t - the number of events written
+//	Notes:
+//		The velocity decays exponentially, and the distance is its integral
+//		over the time since the last event.  A strip stops at its ends.
+//		Controls past capacity_I catch up at the next call.
+//
+size_t SliderMotion::Coast(DWORD nowMs_I,
+									SliderMotionEvent *events_O,
+									size_t capacity_I)
+{
+	size_t count = 0;
+	for (int kind = 0; kind < SLIDER_KINDS && mCoasting && count < capacity_I; ++kind)
+	{
+		for (UINT tablet = 0; tablet < SLIDER_MOTION_MAX_TABLETS && count < capacity_I; ++tablet)
+		{
+			for (UINT idx = 0; idx < SLIDER_MOTION_MAX_CONTROLS && count < capacity_I; ++idx)
+			{
+				Control &control = mControls[kind][tablet][idx];
+				const DWORD elapsedMs = nowMs_I - control.lastMs;
+				if (!control.coasting || elapsedMs == 0)
+				{
+					continue;
+				}
+
+				const double decay = mFrictionMs > 0.0 ? exp(-(elapsedMs / mFrictionMs)) : 0.0;
+				double delta = control.velocity * mFrictionMs / 1000.0 * (1.0 - decay);
+				control.velocity *= decay;
+
+				double position = control.position + delta;
+				if (control.period > 0.0)
+				{
+					position -= floor((position - control.min) / control.period) * control.period;
+				}
+				else if (position < control.min || position > control.max)
+				{
+					position = std::min<double>(std::max<double>(position, control.min), control.max);
+					delta = position - control.position;
+					control.velocity = 0.0;
+				}
+				control.position = position;
+				control.lastMs = nowMs_I;
+				++mStats.coastSteps;
+
+				if (fabs(control.velocity) < mStopVelocity)
+				{
+					control.coasting = false;
+					control.velocity = 0.0;
+					--mCoasting;
+				}
+
+				Fill(control, static_cast<SliderKind>(kind), tablet, idx, delta, events_O[count++]);
+			}
+		}
+	}
+	return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////
+
+SliderMotion::Control *SliderMotion::Find(SliderKind kind_I,
+														UINT tablet_I,
+														UINT control_I)
+{
+	if (kind_I >= SLIDER_KINDS || tablet_I >= SLIDER_MOTION_MAX_TABLETS || control_I >= SLIDER_MOTION_MAX_CONTROLS)
+	{
+		return nullptr;
+	}
+
+	Control &control = mControls[kind_I][tablet_I][control_I];
+	return control.setUp ? &control : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Exponential smoothing over the elapsed time, so that it does not depend
+// on the packet rate.
+
+void SliderMotion::Smooth(Control &control_IO,
+								  double instant_I,
+								  DWORD elapsedMs_I) const
+{
+	const double alpha = mSmoothingMs > 0.0 ? 1.0 - exp(-(elapsedMs_I / mSmoothingMs)) : 1.0;
+	control_IO.velocity += alpha * (instant_I - control_IO.velocity);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void SliderMotion::Fill(const Control &state_I,
+								SliderKind kind_I,
+								UINT tablet_I,
+								UINT control_I,
+								double delta_I,
+								SliderMotionEvent &event_O) const
+{
+	event_O.kind = kind_I;
+	event_O.tablet = tablet_I;
+	event_O.control = control_I;
+	event_O.mode = state_I.mode;
+	event_O.position = state_I.position;
+	event_O.delta = delta_I;
+	event_O.velocity = state_I.velocity;
+	event_O.touching = state_I.touching;
+	event_O.coasting = state_I.coasting;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Recorded sessions
+////////////////////////////////////////////////////////////////////////////////
+
+void WriteSliderRange(std::ostream &out_IO,
+							 SliderKind kind_I,
+							 UINT tablet_I,
+							 UINT control_I,
+							 UINT32 min_I,
+							 UINT32 max_I)
+{
+	out_IO << (kind_I == SLIDER_RING ? "range ring " : "range strip ")
+		<< tablet_I << " " << control_I << " " << min_I << " " << max_I << "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void WriteSliderSample(std::ostream &out_IO,
+							  SliderKind kind_I,
+							  const SLIDERDATA &data_I,
+							  DWORD timeMs_I)
+{
+	out_IO << timeMs_I << (kind_I == SLIDER_RING ? " ring " : " strip ")
+		<< static_cast<UINT>(data_I.nTablet) << " " << static_cast<UINT>(data_I.nControl) << " "
+		<< static_cast<UINT>(data_I.nMode) << " " << data_I.nPosition << "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Read the next record of a recorded session.
+//	Parameters:
+//		in_IO - The recording
+//		record_O - Receives the record
+//	Return:
+//		bool - false at the end, or at a line that is not a record
+//
+bool ReadSliderRecord(std::istream &in_IO,
+							 SliderRecord &record_O)
+{
+	std::string line;
+	while (std::getline(in_IO, line))
+	{
+		if (line.empty() || line[0] == '#' || line[0] == '\r')
+		{
+			continue;
+		}
+
+		std::istringstream fields(line);
+		std::string first, kind;
+		UINT tablet = 0, control = 0;
+		record_O = SliderRecord();
+		if (!(fields >> first >> kind >> tablet >> control) || (kind != "ring" && kind != "strip"))
+		{
+			return false;
+		}
+
+		record_O.kind = kind == "ring" ? SLIDER_RING : SLIDER_STRIP;
+		record_O.data.nTablet = static_cast<BYTE>(tablet);
+		record_O.data.nControl = static_cast<BYTE>(control);
+		if (first == "range")
+		{
+			record_O.range = true;
+			return static_cast<bool>(fields >> record_O.min >> record_O.max);
+		}
+
+		UINT mode = 0;
+		std::istringstream time(first);
+		if (!(time >> record_O.timeMs) || !(fields >> mode >> record_O.data.nPosition))
+		{
+			return false;
+		}
+		record_O.data.nMode = static_cast<BYTE>(mode);
+		return true;
+	}
+	return false;
+}
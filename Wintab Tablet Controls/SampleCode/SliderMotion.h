@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Declarations for the motion engine of TouchRings and TouchStrips.
+//
+//		WT_PACKETEXT reports where a finger is on a ring or strip, 0 when it
+//		is lifted.  The engine turns those positions into signed deltas,
+//		taking the short way around a ring across its ends, and a smoothed
+//		velocity.  After a lift it can coast: the motion goes on, slowing
+//		down, until Coast finds it stopped or the finger touches again.
+//		State is kept in a fixed table per tablet and control.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <wintab.h>
+
+#include <iosfwd>
+
+// Controls tracked per tablet and kind.
+#define SLIDER_MOTION_MAX_TABLETS		16
+#define SLIDER_MOTION_MAX_CONTROLS		4
+
+// Time constants: of the velocity's smoothing, and of its decay while
+// coasting.  Coasting stops below the stop velocity, in positions per
+// second.
+#define SLIDER_MOTION_DEFAULT_SMOOTHING_MS		40.0
+#define SLIDER_MOTION_DEFAULT_FRICTION_MS		300.0
+#define SLIDER_MOTION_DEFAULT_STOP_VELOCITY	2.0
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum SliderKind
+{
+	SLIDER_RING,
+	SLIDER_STRIP,
+	SLIDER_KINDS
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Positions are as Drawing shows them: a ring's is SLIDERDATA's nPosition
+// less one, from TABLET_PROPERTY_MIN to _MAX and around to MIN again; a
+// strip's is nPosition, from MIN to MAX.
+//
+struct SliderMotionEvent
+{
+	SliderKind	kind;
+	UINT			tablet;
+	UINT			control;
+	UINT			mode;
+	double		position;
+	double		delta;			// since the control's last event
+	double		velocity;		// positions per second, smoothed
+	bool			touching;
+	bool			coasting;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct SliderMotionStats
+{
+	unsigned long long	packets;
+	unsigned long long	ignored;		// of controls not set up
+	unsigned long long	touches;
+	unsigned long long	moves;
+	unsigned long long	wraps;		// ring deltas across the ends
+	unsigned long long	lifts;
+	unsigned long long	coasts;		// lifts that coast
+	unsigned long long	coastSteps;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SliderMotion
+{
+public:
+	SliderMotion();
+
+	void SetSmoothing(double timeConstantMs_I);
+	void SetInertia(bool enabled_I, double frictionMs_I = SLIDER_MOTION_DEFAULT_FRICTION_MS,
+		double stopVelocity_I = SLIDER_MOTION_DEFAULT_STOP_VELOCITY);
+
+	// Sets up a control with its TABLET_PROPERTY_MIN and _MAX.  Packets of
+	// controls not set up are ignored.
+	void Setup(SliderKind kind_I, UINT tablet_I, UINT control_I, UINT32 min_I, UINT32 max_I);
+
+	// Forgets a tablet's controls, after they changed.
+	void Forget(UINT tablet_I);
+	void Clear(void);
+
+	// Tracks one packet's data, at timeMs_I from EXTENSIONBASE's nTime.
+	// Returns true, with event_O, on a touch, move or lift.
+	bool Packet(SliderKind kind_I, const SLIDERDATA &data_I, DWORD timeMs_I, SliderMotionEvent &event_O);
+
+	// Moves the coasting controls on to nowMs_I, on the clock of the
+	// packets.  Writes an event per control, up to capacity_I; the last of
+	// a control has coasting false.  Returns the number written.
+	size_t Coast(DWORD nowMs_I, SliderMotionEvent *events_O, size_t capacity_I);
+	bool Coasting(void) const { return mCoasting != 0; }
+
+	const SliderMotionStats &Stats(void) const { return mStats; }
+	void ResetStats(void) { mStats = SliderMotionStats(); }
+
+private:
+	struct Control
+	{
+		bool			setUp;
+		bool			touching;
+		bool			coasting;
+		bool			moved;			// since the touch
+		UINT			mode;
+		double		min;
+		double		max;
+		double		period;			// of a ring; 0 for a strip
+		double		position;
+		double		velocity;
+		DWORD			lastMs;
+	};
+
+	Control *Find(SliderKind kind_I, UINT tablet_I, UINT control_I);
+	void Smooth(Control &control_IO, double instant_I, DWORD elapsedMs_I) const;
+	void Fill(const Control &state_I, SliderKind kind_I, UINT tablet_I, UINT control_I, double delta_I,
+		SliderMotionEvent &event_O) const;
+
+	Control							mControls[SLIDER_KINDS][SLIDER_MOTION_MAX_TABLETS][SLIDER_MOTION_MAX_CONTROLS];
+	double							mSmoothingMs;
+	bool								mInertia;
+	double							mFrictionMs;
+	double							mStopVelocity;
+	size_t							mCoasting;
+	SliderMotionStats				mStats;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Recorded sessions, a record per line: a control's range, as set up, or a
+// packet's data.
+//		range ring|strip <nTablet> <nControl> <min> <max>
+//		<nTime> ring|strip <nTablet> <nControl> <nMode> <nPosition>
+// Lines starting with # are comments.
+//
+struct SliderRecord
+{
+	bool			range;			// else a packet
+	SliderKind	kind;
+	SLIDERDATA	data;				// of a range, nTablet and nControl only
+	DWORD			timeMs;
+	UINT32		min;
+	UINT32		max;
+};
+
+void WriteSliderRange(std::ostream &out_IO, SliderKind kind_I, UINT tablet_I, UINT control_I, UINT32 min_I,
+	UINT32 max_I);
+void WriteSliderSample(std::ostream &out_IO, SliderKind kind_I, const SLIDERDATA &data_I, DWORD timeMs_I);
+bool ReadSliderRecord(std::istream &in_IO, SliderRecord &record_O);
@@ -11,7 +11,11 @@
 
 #include "stdafx.h"
 #include "Tablet.h"
+#include "ControlCache.h"
 #include "Drawing.h"
+#include "IconPipeline.h"
+#include "IconScheduler.h"
+#include "SliderMotion.h"
 #include "Utils.h"
 #include <sstream>
 #include <map>
@@ -20,267 +24,49 @@
 // Module-global variables
 
 static HCTX ghCtx = NULL;
-static DWORD gNumTablets = 0;
-static DWORD gNumTabletsThatHaveBeenAttached = 0;
+static HWND ghWnd = NULL;
+static ControlCache gControls;
+static IconPipeline gIcons;
+static IconScheduler gIconScheduler(gControls);
+static SliderMotion gSliderMotion;
+static DWORD gSliderPacketMs = 0;		// nTime of the last ring or strip packet
+static DWORD gSliderTickMs = 0;			// and GetTickCount then
+static std::ostream *gpSliderRecording = nullptr;
 
 DWORD gNumCursorsPerTablet = 0;
 std::map<int, bool> gAttachMap;
 
-////////////////////////////////////////////////////////////////////////////////
-//	Purpose:
-//		Convert the wintab extension value to the index for this version of wintab.
-//	Parameters:
-//		tagToMatch_I - The extension tag value
-//		index_O - The index of the requested tag
-//	Return:
-//		bool - true if tag value found
-//	Notes:
-//		Not all versions of wintab support all extensions.  Extensions are defined by
-//		value and referenced by index.
-//
-bool FindWTExtension(UINT tagToMatch_I,
-							UINT &index_O)
-{
-	UINT index = 0xFFFFFFFF;
-
-	// Iterate through Wintab extension indices
-	UINT thisTag = 0;
-	for (UINT i = 0; gpWTInfoA(WTI_EXTENSIONS+i, EXT_TAG, &thisTag); ++i)
-	{
-		// looking for the specified tag
-		if (thisTag == tagToMatch_I)
-		{
-			// note the index of the found tag
-			index = i;
-			break;
-		}
-	}
-
-	// if found report the index
-	if (index != 0xFFFFFFFF)
-	{
-		index_O = index;
-		return true;
-	}
-
-	return false;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-//	Purpose:
-//		Get a property value from an extention.
-//	Parameters:
-//		ext_I - The index of the extension
-//		tablet_I - The index of the tablet
-//		control_I - The index of the control on the tablet
-//		function_I - The index of the function on the control
-//		property_I - The value of the property requested
-//	Return:
-//		<T> - the value of the propery correctly typecast; or a self initialize
-//				value to type T
-//	Notes:
-//		This must be called with the correct data type for the property value.
-//
-template <typename T>
-T CtrlPropertyGet(UINT ext_I,
-						BYTE tablet_I,
-						BYTE control_I,
-						BYTE function_I,
-						WORD property_I)
-{
-	T result = T();
-
-	// allocate a buffer
-	std::unique_ptr<BYTE[]> buffer(new BYTE[sizeof(EXTPROPERTY) + sizeof(T)]);
-
-	// cast the buffer to the extension property data structure
-	EXTPROPERTY *prop = (EXTPROPERTY*)buffer.get();
-
-	// fill in the data
-	prop->version = 0;
-	prop->tabletIndex = tablet_I;
-	prop->controlIndex = control_I;
-	prop->functionIndex = function_I;
-	prop->propertyID = property_I;
-	prop->reserved = 0;
-	prop->dataSize = sizeof(T);
-
-	// send the command to Wintab
-	const bool gotit = (FALSE != gpWTExtGet(ghCtx, ext_I, prop));
-
-	// if successful
-	if (gotit)
-	{
-		// store the data requested
-		result = *((T*)(&prop->data[0]));
-	}
-	else
-	{
-		// otherwise report the failure
-		ShowError("Failed to get a property.");
-	}
-
-	return result;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-//	Purpose:
-//		Set a value for a property of an extention.
-//	Parameters:
-//		ext_I - The index of the extension
-//		tablet_I - The index of the tablet
-//		control_I - The index of the control on the tablet
-//		function_I - The index of the function on the control
-//		property_I - The property value to set
-//		value_I - The value to set the property to
-//	Return:
-//		bool - true if the value correctly set
-//	Notes:
-//		This must be called with the correct data type for the property value.
-//
-template <typename T>
-bool CtrlPropertySet(UINT ext_I,
-							BYTE tablet_I,
-							BYTE control_I,
-							BYTE function_I,
-							WORD property_I,
-							T value_I)
-{
-	// allocate a buffer
-	std::unique_ptr<BYTE[]> buffer(new BYTE[sizeof(EXTPROPERTY) + sizeof(T)]);
-
-	// cast the buffer to the extension property data structure
-	EXTPROPERTY *prop = (EXTPROPERTY*)buffer.get();
-
-	// fill in the data
-	prop->version = 0;
-	prop->tabletIndex = tablet_I;
-	prop->controlIndex = control_I;
-	prop->functionIndex = function_I;
-	prop->propertyID = property_I;
-	prop->reserved = 0;
-	prop->dataSize = sizeof(T);
-	*((T*)(&prop->data[0])) = value_I;
-
-	// send the command to Wintab and record result
-	return (FALSE != gpWTExtSet(ghCtx, ext_I, prop));
-}
-
-////////////////////////////////////////////////////////////////////////////////
-//	Purpose:
-//		Specialization for a STL string.
-//	Notes:
-//		See CtrlPropertySet
-//
-template <>
-bool CtrlPropertySet(UINT ext_I,
-							BYTE tablet_I,
-							BYTE control_I,
-							BYTE function_I,
-							WORD property_I,
-							std::string value_I)
-{
-	// allocate a buffer
-	std::unique_ptr<BYTE[]> buffer(new BYTE[sizeof(EXTPROPERTY) + value_I.length() + 1]);
-
-	// cast the buffer to the extension property data structure
-	EXTPROPERTY *prop = (EXTPROPERTY*)buffer.get();
-
-	// fill in the data
-	prop->version = 0;
-	prop->tabletIndex = tablet_I;
-	prop->controlIndex = control_I;
-	prop->functionIndex = function_I;
-	prop->propertyID = property_I;
-	prop->reserved = 0;
-	prop->dataSize = static_cast<DWORD>(value_I.length() + 1);
-	strcpy((char*)(&prop->data[0]), value_I.c_str());
-
-	// send the command to Wintab and record result
-	return (FALSE != gpWTExtSet(ghCtx, ext_I, prop));
-}
-
-////////////////////////////////////////////////////////////////////////////////
-//	Purpose:
-//		Specialization for a STL BYTE vector.
-//	Notes:
-//		See CtrlPropertySet
-//
-template <>
-bool CtrlPropertySet(UINT ext_I,
-							BYTE tablet_I,
-							BYTE control_I,
-							BYTE function_I,
-							WORD property_I,
-							std::vector<BYTE> value_I)
-{
-	// allocate a buffer
-	std::unique_ptr<BYTE[]> buffer(new BYTE[sizeof(EXTPROPERTY) + value_I.size()]);
-
-	// cast the buffer to the extension property data structure
-	EXTPROPERTY *prop = (EXTPROPERTY*)buffer.get();
-
-	// fill in the data
-	prop->version = 0;
-	prop->tabletIndex = tablet_I;
-	prop->controlIndex = control_I;
-	prop->functionIndex = function_I;
-	prop->propertyID = property_I;
-	prop->reserved = 0;
-	prop->dataSize = static_cast<DWORD>(value_I.size());
-
-	for (size_t i = 0; i < value_I.size(); ++i)
-	{
-		prop->data[i] = value_I[i];
-	}
-
-	// send the command to Wintab and record result
-	return (FALSE != gpWTExtSet(ghCtx, ext_I, prop));
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 //	Purpose:
 //		Set the icon for a specified control.
 //	Parameters:
-//		ext_I - The index of the extension
-//		tablet_I - The index of the tablet
-//		control_I - The index of the control on the tablet
-//		function_I - The index of the function on the control
+//		func_I - The control function to set the icon for
 //		filename_I - Filename of the image to load
 //	Return:
 //		bool - true if the value correctly set
+//	Notes:
+//		The image is converted to the control's icon format and size once;
+//		see IconPipeline.  The icon is queued; see PumpIcons.
 //
-bool SetIcon(UINT ext_I,
-				 UINT tablet_I,
-				 UINT control_I,
-				 UINT function_I,
+bool SetIcon(const ControlFunction &func_I,
 				 std::string filename_I)
 {
-	// open a file stream
-	std::ifstream imageFile(filename_I.c_str(), std::ios::in | std::ios::binary);
-
-	// create a BYTE vector to hold
-	std::vector<BYTE> imageData;
-
-	// fill the vector with the data from the stream
-	while (!imageFile.eof())
+	const std::vector<BYTE> *icon = gIcons.Icon(filename_I, func_I.iconFormat, func_I.iconWidth, func_I.iconHeight);
+	if (!icon)
 	{
-		imageData.push_back(imageFile.get());
+		return false;
 	}
 
-	// send the vector as property "TABLET_PROPERTY_OVERRIDE_ICON"
-	return CtrlPropertySet(ext_I, tablet_I, control_I, function_I,
-		TABLET_PROPERTY_OVERRIDE_ICON, imageData);
+	// queue the icon for property "TABLET_PROPERTY_OVERRIDE_ICON"
+	gIconScheduler.Submit(func_I, *icon, ICON_PRIORITY_STATE, GetTickCount64());
+	return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 //	Purpose:
 //		Sets all properties for a given tablet/control/function.
 //	Parameters:
-//		tablet_I - The index of the tablet
-//		ext_I - The index of the extension
-//		control_I - The index of the control on the tablet
-//		function_I - The index of the function on the control
+//		func_IO - The cached control function; records the override
 //		fp_I - Drawing function to render the control in this app.
 //	Return:
 //		none
@@ -288,19 +74,15 @@ bool SetIcon(UINT ext_I,
 //		This is a definite testing function.  Normally you would only take over what
 //		you need.  This code takes over everything.
 //
-void SetupPropertiesForFunc(UINT tablet_I,
-									 UINT ext_I,
-									 UINT control_I,
-									 UINT function_I,
+void SetupPropertiesForFunc(ControlFunction &func_IO,
 									 Drawing::SetupControlPtr fp_I)
 {
-	// ask if control is available for override?
-	const BOOL avail = CtrlPropertyGet<BOOL>(ext_I, tablet_I, control_I, function_I, TABLET_PROPERTY_AVAILABLE);
+	const UINT ext = func_IO.extension;
 
-	// If so, override the control
-	if (avail)
+	// If the control is available for override, override it
+	if (func_IO.available)
 	{
-		CtrlPropertySet(ext_I, tablet_I, control_I, function_I,
+		func_IO.overridden = gControls.Set(ext, func_IO.tablet, func_IO.control, func_IO.function,
 			TABLET_PROPERTY_OVERRIDE, static_cast<BOOL>(TRUE));
 
 		// Give control a custom name.
@@ -308,21 +90,21 @@ void SetupPropertiesForFunc(UINT tablet_I,
 		// so they should be short.
 		std::stringstream name;
 
-		switch(ext_I)
+		switch(ext)
 		{
 			case WTX_EXPKEYS2:
 			{
-				name << "EK: " << control_I;
+				name << "EK: " << func_IO.control;
 				break;
 			}
 			case WTX_TOUCHRING:
 			{
-				name << "TR: " << function_I;
+				name << "TR: " << func_IO.function;
 				break;
 			}
 			case WTX_TOUCHSTRIP:
 			{
-				name << "TS: " << function_I;
+				name << "TS: " << func_IO.function;
 				break;
 			}
 			default:
@@ -332,174 +114,134 @@ void SetupPropertiesForFunc(UINT tablet_I,
 			}
 		}
 
-		CtrlPropertySet(ext_I, tablet_I, control_I, function_I,
+		gControls.Set(ext, func_IO.tablet, func_IO.control, func_IO.function,
 			TABLET_PROPERTY_OVERRIDE_NAME, name.str());
 	}
 
-	// Get the location of the control
-	const UINT32 location = CtrlPropertyGet<UINT32>(ext_I, tablet_I, control_I,
-		function_I, TABLET_PROPERTY_LOCATION);
-
-	// Get the range of values
-	const UINT32 min = CtrlPropertyGet<UINT32>(ext_I, tablet_I, control_I, function_I, TABLET_PROPERTY_MIN);
-	const UINT32 max = CtrlPropertyGet<UINT32>(ext_I, tablet_I, control_I, function_I, TABLET_PROPERTY_MAX);
-
 	// WARNING - these icons will overwrite displayed key names (eg: "EK: 0, EK: 1, etc.")
 
-	// Set the display properties
-	// first check the format of the display.
-	const UINT32 iconFmt = CtrlPropertyGet<UINT32>(ext_I, tablet_I, control_I, function_I,
-		TABLET_PROPERTY_ICON_FORMAT);
-	// TABLET_ICON_FMT_NONE is returned if the control does not have a display
-	if (iconFmt != TABLET_ICON_FMT_NONE)
+	// TABLET_ICON_FMT_NONE is cached if the control does not have a display
+	if (func_IO.iconFormat != TABLET_ICON_FMT_NONE)
 	{
-		// Get the width of the display icon
-		const UINT32 iconW = CtrlPropertyGet<UINT32>(ext_I, tablet_I, control_I, function_I,
-			TABLET_PROPERTY_ICON_WIDTH);
-		// Get the height of the display icon
-		const UINT32 iconH = CtrlPropertyGet<UINT32>(ext_I, tablet_I, control_I, function_I,
-			TABLET_PROPERTY_ICON_HEIGHT);
-
 		// set the icon to "sample.png"
-		SetIcon(ext_I, tablet_I, control_I, function_I, "sample.png");
+		SetIcon(func_IO, "sample.png");
 	}
 
 	// Send all the values to the drawing code to display in the client area.
-	fp_I(tablet_I, control_I, function_I, avail, location, min, max);
+	fp_I(func_IO.tablet, func_IO.control, func_IO.function, func_IO.available,
+		func_IO.location, func_IO.min, func_IO.max);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 //	Purpose:
-//		Iterate through all functions on this control.
+//		Set up all cached controls and functions of this tablet.
 //	Parameters:
 //		tablet_I - The index of the tablet
-//		ext_I - The index of the extension
-//		control_I - The index of the control on the tablet
-//		fp_I - Drawing function to render the control in this app.
 //	Return:
 //		none
 //	Notes:
 //		This is a definite testing function.  Normally you would only take over what
 //		you need.  This code takes over everything.
 //
-void SetupFuncsForControl(UINT tablet_I,
-								  UINT ext_I,
-								  UINT control_I,
-								  Drawing::SetupControlPtr fp_I)
+void SetupControlsForTablet(UINT tablet_I)
 {
-	// Get number of functions.
-	// Note the function element is ignored for this property.
-	const UINT32 numFuncs = CtrlPropertyGet<UINT32>(ext_I, tablet_I, control_I, 0,
-		TABLET_PROPERTY_FUNCCOUNT);
-	for (UINT i=0; i<numFuncs; i++)
+	for (ControlFunction &func : gControls.Functions())
 	{
-		SetupPropertiesForFunc(tablet_I, ext_I, control_I, i, fp_I);
-	}
-}
-
-////////////////////////////////////////////////////////////////////////////////
-//	Purpose:
-//		Iterate through all controls on this tablet/extension.
-//	Parameters:
-//		tablet_I - The index of the tablet
-//		ext_I - The index of the extension
-//		fp_I - Drawing function to render the control in this app.
-//	Return:
-//		none
-//	Notes:
-//		This is a definite testing function.  Normally you would only take over what
-//		you need.  This code takes over everything.
-//
-void SetupControlsForExtension(UINT tablet_I,
-										 UINT ext_I,
-										 Drawing::SetupControlPtr fp_I)
-{
-	// Get number of controls of this type
-	// Note the control and function elements are ignored for this property.
-	const UINT32 numCtrls = CtrlPropertyGet<UINT32>(ext_I, tablet_I, 0, 0,
-		TABLET_PROPERTY_CONTROLCOUNT);
+		if (func.tablet != tablet_I)
+		{
+			continue;
+		}
 
-	for (UINT32 idx = 0; idx < numCtrls; ++idx)
-	{
-		// You only need to setup controls you wish to override
-		SetupFuncsForControl(tablet_I, ext_I, idx, fp_I);
+		switch (func.extension)
+		{
+			case WTX_EXPKEYS2:
+			{
+				// Express Keys
+				SetupPropertiesForFunc(func, Drawing::SetupKey);
+				break;
+			}
+			case WTX_TOUCHRING:
+			{
+				// Touch Rings
+				SetupPropertiesForFunc(func, Drawing::SetupRing);
+				if (func.function == 0)
+				{
+					gSliderMotion.Setup(SLIDER_RING, func.tablet, func.control, func.min, func.max);
+					if (gpSliderRecording)
+					{
+						WriteSliderRange(*gpSliderRecording, SLIDER_RING, func.tablet, func.control, func.min, func.max);
+					}
+				}
+				break;
+			}
+			case WTX_TOUCHSTRIP:
+			{
+				// Touch Strips
+				SetupPropertiesForFunc(func, Drawing::SetupStrip);
+				if (func.function == 0)
+				{
+					gSliderMotion.Setup(SLIDER_STRIP, func.tablet, func.control, func.min, func.max);
+					if (gpSliderRecording)
+					{
+						WriteSliderRange(*gpSliderRecording, SLIDER_STRIP, func.tablet, func.control, func.min, func.max);
+					}
+				}
+				break;
+			}
+		}
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 //	Purpose:
-//		Iterate through all extensions on this tablet.
+//		Remove the overrides this application set.
 //	Parameters:
-//		tablet_I - The index of the tablet
-//	Return:
 //		none
-//	Notes:
-//		This is a definite testing function.  Normally you would only take over what
-//		you need.  This code takes over everything.
-//
-void SetupControlsForTablet(UINT tablet_I)
-{
-	// Express Keys
-	SetupControlsForExtension(tablet_I, WTX_EXPKEYS2,   Drawing::SetupKey);
-
-	// Touch Rings
-	SetupControlsForExtension(tablet_I, WTX_TOUCHRING,  Drawing::SetupRing);
-
-	// Touch Strips
-	SetupControlsForExtension(tablet_I, WTX_TOUCHSTRIP, Drawing::SetupStrip);
-}
-
-////////////////////////////////////////////////////////////////////////////////
-//	Purpose:
-//		Iterate through all controls/functions on this tablet/extension.
-//	Parameters:
-//		tablet_I - The index of the tablet
-//		ext_I - The index of the extension
 //	Return:
 //		none
-//	Notes:
-//		This is a definite testing function.  Normally you would only take over what
-//		you need.  This code takes over everything.
 //
-void RemoveOverridesForExtension(UINT tablet_I,
-											UINT ext_I)
+void RemoveOverrides(void)
 {
-	// Get number of controls of this type
-	// Note the control and function elements are ignored for this property.
-	const UINT32 numCtrls = CtrlPropertyGet<UINT32>(ext_I, tablet_I, 0, 0,
-		TABLET_PROPERTY_CONTROLCOUNT);
-	for (UINT control=0; control<numCtrls; control++)
+	for (ControlFunction &func : gControls.Functions())
 	{
-		// Get number of functions.
-		// Note the function element is ignored for this property.
-		const UINT32 numFuncs = CtrlPropertyGet<UINT32>(ext_I, tablet_I, control, 0,
-			TABLET_PROPERTY_FUNCCOUNT);
-		for (UINT function = 0; function < numFuncs; ++function)
+		if (func.overridden)
 		{
-			CtrlPropertySet(ext_I, tablet_I, control, function,
+			gControls.Set(func.extension, func.tablet, func.control, func.function,
 				TABLET_PROPERTY_OVERRIDE, static_cast<BOOL>(FALSE));
+			func.overridden = false;
 		}
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 //	Purpose:
-//		Iterate through all extensions on this tablet.
+//		Bring the cached controls up to date and set up the tablets that changed.
 //	Parameters:
-//		tablet_I - The index of the tablet
-//	Return:
 //		none
+//	Return:
+//		bool - true if any tablet changed
 //
-void RemoveOverridesForTablet(UINT tablet_I)
+bool RefreshControls(void)
 {
-	// Express Keys
-	RemoveOverridesForExtension(tablet_I, WTX_EXPKEYS2);
+	const unsigned long long failures = gControls.Stats().failures;
 
-	// Touch Rings
-	RemoveOverridesForExtension(tablet_I, WTX_TOUCHRING);
+	std::vector<UINT> changed;
+	gControls.Refresh(changed);
+
+	for (const UINT tablet : changed)
+	{
+		Drawing::RemoveTablet(tablet);
+		gIconScheduler.Forget(tablet);
+		gSliderMotion.Forget(tablet);
+		SetupControlsForTablet(tablet);
+	}
+	Tablet::PumpIcons();
 
-	// Touch Strips
-	RemoveOverridesForExtension(tablet_I, WTX_TOUCHSTRIP);
+	if (gControls.Stats().failures != failures)
+	{
+		ShowError("Failed to get a property.");
+	}
+	return !changed.empty();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -525,49 +267,35 @@ bool Tablet::Init(HWND hWnd_I)
 		return FALSE;
 	}
 
-	// Verify that the extensions we're targeting are available
-	WTPKT lTouchRing_Mask = 0;
-	UINT extIndex_TouchRing = 0;
+	ghWnd = hWnd_I;
 
-	// get the extension index for the touch ring
-	if (FindWTExtension(WTX_TOUCHRING, extIndex_TouchRing))
+	// Keep converted icons across sessions
+	char tempPath[MAX_PATH] = { 0 };
+	if (GetTempPathA(MAX_PATH, tempPath))
 	{
-		// get the extension mask for the touch ring
-		gpWTInfoA(WTI_EXTENSIONS + extIndex_TouchRing, EXT_MASK, &lTouchRing_Mask);
+		gIcons.SetCacheDirectory(std::string(tempPath) + "TabletControlsIcons\\");
 	}
-	else
-	{
-		ShowError("TouchRing extension not found.");
-	}
-
-	WTPKT lTouchStrip_Mask = 0;
-	UINT extIndex_TouchStrip = 0;
 
-	// get the extension index for the touch strip
-	if (FindWTExtension(WTX_TOUCHSTRIP, extIndex_TouchStrip))
+	// Verify that the extensions we're targeting are available
+	gControls.FindExtensions();
+	if (!gControls.HasExtension(WTX_TOUCHRING))
 	{
-		// get the extension mask for the touch strip
-		gpWTInfoA(WTI_EXTENSIONS + extIndex_TouchStrip, EXT_MASK, &lTouchStrip_Mask);
+		ShowError("TouchRing extension not found.");
 	}
-	else
+	if (!gControls.HasExtension(WTX_TOUCHSTRIP))
 	{
 		ShowError("TouchStrip Extension not found.");
 	}
-
-	WTPKT lExpKeys_Mask = 0;
-	UINT extIndex_ExpKeys = 0;
-
-	// get the extension index for the express keys
-	if (FindWTExtension(WTX_EXPKEYS2, extIndex_ExpKeys))
-	{
-		// get the extension mask for the express keys
-		gpWTInfoA(WTI_EXTENSIONS + extIndex_ExpKeys, EXT_MASK, &lExpKeys_Mask);
-	}
-	else
+	if (!gControls.HasExtension(WTX_EXPKEYS2))
 	{
 		ShowError("ExpKeys Extension not found.");
 	}
 
+	// get the extension masks
+	const WTPKT lTouchRing_Mask = gControls.ExtensionMask(WTX_TOUCHRING);
+	const WTPKT lTouchStrip_Mask = gControls.ExtensionMask(WTX_TOUCHSTRIP);
+	const WTPKT lExpKeys_Mask = gControls.ExtensionMask(WTX_EXPKEYS2);
+
 	LOGCONTEXT lcContext = {0};
 
 	// ask for the default system context
@@ -592,26 +320,137 @@ bool Tablet::Init(HWND hWnd_I)
 		return false;
 	}
 
-	// This counts the number of tablets that the driver detects as
+	// Read the controls of every tablet that the driver detects as
 	// having been attached since the last time the driver settings
-	// were cleared.  Wintab only supports 16 attached tablets.
-	// When WTInfo returns zero, we know that number.
-	for (int idx = 0; idx < 16; ++idx)
+	// were cleared, and set them up.
+	gControls.SetContext(ghCtx);
+	RefreshControls();
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Update the controls after Wintab reports a change, as on WT_INFOCHANGE.
+//	Parameters:
+//		none
+//	Return:
+//		bool - true if any tablet changed and the display needs repainting
+//
+bool Tablet::Refresh(void)
+{
+	if (!ghCtx)
 	{
-		LOGCONTEXT lcTemp = { 0 };
-		const int numBytes = gpWTInfoA(WTI_DDCTXS + idx, 0, &lcTemp);
-		if (numBytes)
-		{
-			SetupControlsForTablet(idx);
-		}
-		else
-		{
-			break;
-		}
+		return false;
+	}
+	return RefreshControls();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Upload the queued icons that the tablets' budgets allow.
+//	Parameters:
+//		none
+//	Return:
+//		none
+//	Notes:
+//		While icons wait, TABLET_ICON_TIMER calls this again.
+//
+void Tablet::PumpIcons(void)
+{
+	gIconScheduler.Pump(GetTickCount64());
+	if (!ghWnd)
+	{
+		return;
+	}
+
+	if (gIconScheduler.Pending())
+	{
+		SetTimer(ghWnd, TABLET_ICON_TIMER, TABLET_ICON_TIMER_MS, NULL);
+	}
+	else
+	{
+		KillTimer(ghWnd, TABLET_ICON_TIMER);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Record the TouchRings and TouchStrips, for /sliderReplay.
+//	Parameters:
+//		out_I - The recording, or nullptr to stop
+//	Return:
+//		none
+//	Notes:
+//		Call before Init, so that the recording starts with the controls'
+//		ranges.
+//
+void Tablet::RecordSliders(std::ostream *out_I)
+{
+	gpSliderRecording = out_I;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Track a TouchRing's or TouchStrip's packet data.
+//	Parameters:
+//		kind_I - Whether the data is pkTouchRing or pkTouchStrip
+//		data_I - The data
+//		timeMs_I - The packet's nTime
+//		event_O - Receives the motion
+//	Return:
+//		bool - true if the finger touched, moved or lifted
+//	Notes:
+//		A lift that leaves the control coasting starts TABLET_MOTION_TIMER;
+//		see CoastSliders.
+//
+bool Tablet::TrackSlider(SliderKind kind_I,
+								 const SLIDERDATA &data_I,
+								 DWORD timeMs_I,
+								 SliderMotionEvent &event_O)
+{
+	if (gpSliderRecording)
+	{
+		WriteSliderSample(*gpSliderRecording, kind_I, data_I, timeMs_I);
+	}
+
+	gSliderPacketMs = timeMs_I;
+	gSliderTickMs = GetTickCount();
+	if (!gSliderMotion.Packet(kind_I, data_I, timeMs_I, event_O))
+	{
+		return false;
+	}
+
+	if (event_O.coasting && ghWnd)
+	{
+		SetTimer(ghWnd, TABLET_MOTION_TIMER, TABLET_MOTION_TIMER_MS, NULL);
 	}
 	return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Move the coasting TouchRings and TouchStrips on.
+//	Parameters:
+//		events_O - Receives an event per coasting control
+//		capacity_I - The number of events events_O holds
+//	Return:
+//		size_t - the number of events written
+//	Notes:
+//		The packets' clock is not the tick count, so the time is the last
+//		packet's plus the ticks since.  Once nothing coasts, the timer
+//		stops.
+//
+size_t Tablet::CoastSliders(SliderMotionEvent *events_O,
+									 size_t capacity_I)
+{
+	const size_t count = gSliderMotion.Coast(gSliderPacketMs + (GetTickCount() - gSliderTickMs), events_O, capacity_I);
+	if (!gSliderMotion.Coasting() && ghWnd)
+	{
+		KillTimer(ghWnd, TABLET_MOTION_TIMER);
+	}
+	return count;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //	Purpose:
 //		Remove the extension overides and close the context.
@@ -622,12 +461,20 @@ bool Tablet::Init(HWND hWnd_I)
 //
 void Tablet::Cleanup(void)
 {
-	// Remove overrides for each tablet
-	for (UINT8 i = 0; i < gNumTablets; ++i)
+	// Drop the icons still waiting, and remove the overrides this
+	// application set
+	if (ghWnd)
 	{
-		RemoveOverridesForTablet(i);
+		KillTimer(ghWnd, TABLET_ICON_TIMER);
+		KillTimer(ghWnd, TABLET_MOTION_TIMER);
+		ghWnd = NULL;
 	}
-	gNumTablets = 0;
+	gIconScheduler.Clear();
+	gSliderMotion.Clear();
+	gpSliderRecording = nullptr;
+	RemoveOverrides();
+	gControls.Clear();
+	gIcons.Clear();
 
 	// close the context
 	if (ghCtx)
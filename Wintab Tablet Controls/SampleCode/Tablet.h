@@ -22,10 +22,25 @@ constexpr WTPKT PACKETMODE = 0;
 #define PACKETTOUCHRING		PKEXT_ABSOLUTE
 #include <pktdef.h>
 
+#include "SliderMotion.h"
+
+// Timer that uploads queued icons, and its period.
+#define TABLET_ICON_TIMER		1
+#define TABLET_ICON_TIMER_MS	50
+
+// Timer that moves coasting TouchRings and TouchStrips on, and its period.
+#define TABLET_MOTION_TIMER		2
+#define TABLET_MOTION_TIMER_MS	16
+
 ///////////////////////////////////////////////////////////////////////////////
 
 namespace Tablet
 {
 	bool Init(HWND hWnd_I);
+	bool Refresh(void);
+	void PumpIcons(void);
+	void RecordSliders(std::ostream *out_I);
+	bool TrackSlider(SliderKind kind_I, const SLIDERDATA &data_I, DWORD timeMs_I, SliderMotionEvent &event_O);
+	size_t CoastSliders(SliderMotionEvent *events_O, size_t capacity_I);
 	void Cleanup(void);
 }
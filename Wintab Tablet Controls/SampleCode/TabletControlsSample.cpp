@@ -13,6 +13,7 @@
 #include "resource.h"
 #include <map>
 
+#include "ControlsBenchmark.h"
 #include "Drawing.h"
 #include "Tablet.h"
 #include "Utils.h"
@@ -29,6 +30,9 @@ extern std::map<int, bool> gAttachMap;
 HINSTANCE	ghInst;									// current instance
 TCHAR			gszTitle[MAX_LOADSTRING];			// The title bar text
 TCHAR			gszWindowClass[MAX_LOADSTRING];	// the main window class name
+PACKETEXT	gLastPacketExt = {0};					// to find the control a packet is about
+std::vector<RECT>	gDirtyRects;						// reused per packet
+std::ofstream		gSliderRecording;					// of /sliderRecord
 
 ////////////////////////////////////////////////////////////////////////////////
 // Forward declarations
@@ -36,14 +40,58 @@ TCHAR			gszWindowClass[MAX_LOADSTRING];	// the main window class name
 ATOM					MyRegisterClass(HINSTANCE hInstance);
 BOOL					InitInstance(HINSTANCE, int);
 LRESULT CALLBACK	WndProc(HWND, UINT, WPARAM, LPARAM);
+std::basic_string<TCHAR>	SwitchArgument(LPCTSTR cmdLine_I, LPCTSTR switch_I);
+void					ShowSliderMotion(const SliderMotionEvent &event_I);
+void					InvalidateDirtyRects(HWND hWnd_I);
 
 ////////////////////////////////////////////////////////////////////////////////
 // Main application entry point.
 
-int APIENTRY _tWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ LPTSTR, _In_ int nCmdShow)
+int APIENTRY _tWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE, _In_ LPTSTR lpCmdLine, _In_ int nCmdShow)
 {
 	MSG msg = {0};
 
+	// Benchmarks run instead of the application.
+	if (_tcsstr(lpCmdLine, _T("/startupBenchmark")))
+	{
+		RunStartupBenchmark();
+		return 0;
+	}
+	if (_tcsstr(lpCmdLine, _T("/iconBenchmark")))
+	{
+		RunIconBenchmark();
+		return 0;
+	}
+	if (_tcsstr(lpCmdLine, _T("/iconStreamBenchmark")))
+	{
+		RunIconStreamBenchmark();
+		return 0;
+	}
+	if (_tcsstr(lpCmdLine, _T("/repaintBenchmark")))
+	{
+		RunRepaintBenchmark();
+		return 0;
+	}
+	if (_tcsstr(lpCmdLine, _T("/sliderReplay")))
+	{
+		RunSliderReplay(SwitchArgument(lpCmdLine, _T("/sliderReplay")).c_str());
+		return 0;
+	}
+
+	// Record the TouchRing and TouchStrip packets, for /sliderReplay.
+	if (_tcsstr(lpCmdLine, _T("/sliderRecord")))
+	{
+		gSliderRecording.open(SwitchArgument(lpCmdLine, _T("/sliderRecord")).c_str());
+		if (gSliderRecording)
+		{
+			Tablet::RecordSliders(&gSliderRecording);
+		}
+		else
+		{
+			ShowError("Failed to open the slider recording.");
+		}
+	}
+
 	// Initialize global strings
 	LoadString(hInstance, IDS_APP_TITLE, gszTitle, MAX_LOADSTRING);
 	LoadString(hInstance, IDC_TABLETCONTROLSSAMPLE, gszWindowClass, MAX_LOADSTRING);
@@ -131,6 +179,33 @@ LRESULT CALLBACK WndProc(HWND hWnd_I, UINT message_I, WPARAM wParam_I, LPARAM lP
 			EndPaint(hWnd_I, &ps);
 			break;
 		}
+		case WT_INFOCHANGE:
+		{
+			// a tablet was attached or detached
+			if (Tablet::Refresh())
+			{
+				InvalidateRect(hWnd_I, NULL, TRUE);
+			}
+			break;
+		}
+		case WM_TIMER:
+		{
+			if (wParam_I == TABLET_ICON_TIMER)
+			{
+				Tablet::PumpIcons();
+			}
+			else if (wParam_I == TABLET_MOTION_TIMER)
+			{
+				SliderMotionEvent events[8];
+				const size_t count = Tablet::CoastSliders(events, _countof(events));
+				for (size_t idx = 0; idx < count; ++idx)
+				{
+					ShowSliderMotion(events[idx]);
+				}
+				InvalidateDirtyRects(hWnd_I);
+			}
+			break;
+		}
 		case WT_PACKET:
 		{
 			// handle pen input here if desired
@@ -141,14 +216,35 @@ LRESULT CALLBACK WndProc(HWND hWnd_I, UINT message_I, WPARAM wParam_I, LPARAM lP
 			PACKETEXT pkt = {0};
 			if (gpWTPacket((HCTX)lParam_I, static_cast<UINT>(wParam_I), &pkt))
 			{
-				// Update display.
-				Drawing::UpdateKeys(pkt.pkExpKeys.nTablet, pkt.pkExpKeys.nControl,
-					pkt.pkExpKeys.nLocation, pkt.pkExpKeys.nState);
-				Drawing::UpdateRing(pkt.pkTouchRing.nTablet, pkt.pkTouchRing.nControl,
-					pkt.pkTouchRing.nMode, pkt.pkTouchRing.nPosition);
-				Drawing::UpdateStrip(pkt.pkTouchStrip.nTablet, pkt.pkTouchStrip.nControl,
-					pkt.pkTouchStrip.nMode, pkt.pkTouchStrip.nPosition);
-				InvalidateRect(hWnd_I, NULL, TRUE);
+				// Update display, for the parts of the packet that changed:
+				// a packet carries every extension, the others as they were.
+				if (memcmp(&pkt.pkExpKeys, &gLastPacketExt.pkExpKeys, sizeof(pkt.pkExpKeys)) != 0)
+				{
+					Drawing::UpdateKeys(pkt.pkExpKeys.nTablet, pkt.pkExpKeys.nControl,
+						pkt.pkExpKeys.nLocation, pkt.pkExpKeys.nState);
+				}
+				// A ring or strip left coasting by a lift shows its coasting
+				// instead; see TABLET_MOTION_TIMER.
+				SliderMotionEvent motion = {};
+				if (memcmp(&pkt.pkTouchRing, &gLastPacketExt.pkTouchRing, sizeof(pkt.pkTouchRing)) != 0)
+				{
+					if (!Tablet::TrackSlider(SLIDER_RING, pkt.pkTouchRing, pkt.pkBase.nTime, motion) || !motion.coasting)
+					{
+						Drawing::UpdateRing(pkt.pkTouchRing.nTablet, pkt.pkTouchRing.nControl,
+							pkt.pkTouchRing.nMode, pkt.pkTouchRing.nPosition);
+					}
+				}
+				if (memcmp(&pkt.pkTouchStrip, &gLastPacketExt.pkTouchStrip, sizeof(pkt.pkTouchStrip)) != 0)
+				{
+					if (!Tablet::TrackSlider(SLIDER_STRIP, pkt.pkTouchStrip, pkt.pkBase.nTime, motion) || !motion.coasting)
+					{
+						Drawing::UpdateStrip(pkt.pkTouchStrip.nTablet, pkt.pkTouchStrip.nControl,
+							pkt.pkTouchStrip.nMode, pkt.pkTouchStrip.nPosition);
+					}
+				}
+				gLastPacketExt = pkt;
+
+				InvalidateDirtyRects(hWnd_I);
 			}
 			break;
 		}
@@ -166,3 +262,77 @@ LRESULT CALLBACK WndProc(HWND hWnd_I, UINT message_I, WPARAM wParam_I, LPARAM lP
 	}
 	return 0;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+//	Purpose:
+//		Find the argument of a command line switch.
+//	Parameters:
+//		cmdLine_I - The command line
+//		switch_I - The switch
+//	Return:
+//		std::basic_string<TCHAR> - the word after the switch, or empty if
+//		there is none
+//	Notes:
+//		The argument may be quoted, to hold spaces.
+//
+std::basic_string<TCHAR> SwitchArgument(LPCTSTR cmdLine_I, LPCTSTR switch_I)
+{
+	LPCTSTR arg = _tcsstr(cmdLine_I, switch_I);
+	if (!arg)
+	{
+		return std::basic_string<TCHAR>();
+	}
+
+	arg += _tcslen(switch_I);
+	while (*arg == _T(' '))
+	{
+		++arg;
+	}
+
+	const TCHAR end = *arg == _T('"') ? _T('"') : _T(' ');
+	if (end == _T('"'))
+	{
+		++arg;
+	}
+	else if (*arg == _T('/'))
+	{
+		return std::basic_string<TCHAR>();
+	}
+
+	LPCTSTR last = arg;
+	while (*last && *last != end)
+	{
+		++last;
+	}
+	return std::basic_string<TCHAR>(arg, last);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Show where a coasting ring or strip is, or that it stopped.
+
+void ShowSliderMotion(const SliderMotionEvent &event_I)
+{
+	// Positions are whole in packets; 0 shows a lift.
+	const int position = static_cast<int>(event_I.position);
+	if (event_I.kind == SLIDER_RING)
+	{
+		Drawing::UpdateRing(event_I.tablet, event_I.control, event_I.mode, event_I.coasting ? position + 1 : 0);
+	}
+	else
+	{
+		Drawing::UpdateStrip(event_I.tablet, event_I.control, event_I.mode, event_I.coasting ? max(position, 1) : 0);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Repaint only the controls that changed; the backbuffer covers what is
+// invalidated, so there is nothing to erase.
+
+void InvalidateDirtyRects(HWND hWnd_I)
+{
+	Drawing::DirtyRects(gDirtyRects);
+	for (const RECT &rect : gDirtyRects)
+	{
+		InvalidateRect(hWnd_I, &rect, FALSE);
+	}
+}
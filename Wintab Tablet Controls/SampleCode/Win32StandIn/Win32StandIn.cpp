@@ -0,0 +1,627 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Linux implementation of the Win32 and GDI+ stand-ins in this
+//		directory.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <windows.h>
+#include <gdiplus.h>
+
+#include "Win32StandIn.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Win32 error codes that GetLastError reports.
+#define ERROR_FILE_NOT_FOUND		2
+#define ERROR_MOD_NOT_FOUND		126
+
+////////////////////////////////////////////////////////////////////////////////
+// Local types and state
+
+namespace
+{
+	struct GdiObject
+	{
+		virtual ~GdiObject() {}
+	};
+
+	struct DibSection : GdiObject
+	{
+		LONG						width;
+		LONG						height;
+		std::vector<UINT32>	bits;
+	};
+
+	// Rectangular regions are all the sample makes; a union keeps its
+	// bounding box, which is what GetClipBox reports of any region.
+	struct Region : GdiObject
+	{
+		RECT		box;
+		int		type;
+	};
+
+	struct DeviceContext
+	{
+		GdiObject	*selected;
+		bool			clipped;
+		RECT			clip;
+	};
+
+	struct Window
+	{
+		int		width;
+		int		height;
+	};
+
+	// What a memory DC starts with selected, drawn to as an empty bitmap.
+	DibSection						gStockBitmap;
+
+	thread_local DWORD			gLastError		= 0;
+	WIN32STANDINDRAWSTATS		gDrawStats		= { 0, 0, 0 };
+	const Gdiplus::FontFamily	gSansSerif;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	LONGLONG MonotonicNs(void)
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return static_cast<LONGLONG>(now.tv_sec) * 1000000000 + now.tv_nsec;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void SetRegion(Region &region_O, LONG left_I, LONG top_I, LONG right_I, LONG bottom_I)
+	{
+		region_O.box.left = left_I;
+		region_O.box.top = top_I;
+		region_O.box.right = right_I;
+		region_O.box.bottom = bottom_I;
+		region_O.type = (right_I > left_I && bottom_I > top_I) ? SIMPLEREGION : NULLREGION;
+		if (region_O.type == NULLREGION)
+		{
+			region_O.box = RECT{ 0, 0, 0, 0 };
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Gdiplus::Rect Intersect(const Gdiplus::Rect &a_I, const Gdiplus::Rect &b_I)
+	{
+		const INT left = std::max(a_I.X, b_I.X);
+		const INT top = std::max(a_I.Y, b_I.Y);
+		const INT right = std::min(a_I.X + a_I.Width, b_I.X + b_I.Width);
+		const INT bottom = std::min(a_I.Y + a_I.Height, b_I.Y + b_I.Height);
+		return right > left && bottom > top ? Gdiplus::Rect(left, top, right - left, bottom - top) : Gdiplus::Rect();
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	const DibSection &Selected(const DeviceContext &dc_I)
+	{
+		const DibSection *bitmap = dynamic_cast<const DibSection *>(dc_I.selected);
+		return bitmap ? *bitmap : gStockBitmap;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Draw statistics
+
+void Win32StandInGetDrawStats(WIN32STANDINDRAWSTATS *stats_O)
+{
+	if (stats_O)
+	{
+		*stats_O = gDrawStats;
+	}
+}
+
+void Win32StandInResetDrawStats(void)
+{
+	gDrawStats = WIN32STANDINDRAWSTATS{ 0, 0, 0 };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Libraries
+
+HMODULE LoadLibraryA(LPCSTR name_I)
+{
+	std::string stem(name_I ? name_I : "");
+	const size_t dot = stem.rfind('.');
+	if (dot != std::string::npos && _stricmp(stem.c_str() + dot, ".dll") == 0)
+	{
+		stem.erase(dot);
+	}
+	std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	// The executable's directory first, as Windows searches it first.
+	const std::string file = "lib" + stem + ".so";
+	char exe[MAX_PATH + 1] = { 0 };
+	std::string directory;
+	if (readlink("/proc/self/exe", exe, MAX_PATH) > 0 && strrchr(exe, '/'))
+	{
+		directory.assign(exe, strrchr(exe, '/') + 1);
+	}
+	void *library = directory.empty() ? nullptr : dlopen((directory + file).c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (!library)
+	{
+		library = dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL);
+	}
+	gLastError = library ? 0 : ERROR_MOD_NOT_FOUND;
+	return static_cast<HMODULE>(library);
+}
+
+BOOL FreeLibrary(HMODULE module_I)
+{
+	return module_I && dlclose(module_I) == 0;
+}
+
+void *GetProcAddress(HMODULE module_I, LPCSTR name_I)
+{
+	return module_I ? dlsym(module_I, name_I) : nullptr;
+}
+
+DWORD GetLastError(void)
+{
+	return gLastError;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Windows
+
+HWND CreateWindowExA(DWORD, LPCSTR, LPCSTR, DWORD, int, int, int width_I, int height_I, HWND, void *, HINSTANCE, void *)
+{
+	return reinterpret_cast<HWND>(new Window{ width_I, height_I });
+}
+
+BOOL DestroyWindow(HWND hWnd_I)
+{
+	delete reinterpret_cast<Window *>(hWnd_I);
+	return hWnd_I != NULL;
+}
+
+BOOL GetClientRect(HWND hWnd_I, RECT *rect_O)
+{
+	const Window *window = reinterpret_cast<const Window *>(hWnd_I);
+	if (!window || !rect_O)
+	{
+		return FALSE;
+	}
+	*rect_O = RECT{ 0, 0, window->width, window->height };
+	return TRUE;
+}
+
+BOOL PostMessage(HWND hWnd_I, UINT, WPARAM, LPARAM)
+{
+	return hWnd_I != NULL;
+}
+
+UINT_PTR SetTimer(HWND, UINT_PTR id_I, UINT, void *)
+{
+	return id_I;
+}
+
+BOOL KillTimer(HWND, UINT_PTR)
+{
+	return TRUE;
+}
+
+int MessageBoxA(HWND, LPCSTR text_I, LPCSTR caption_I, UINT)
+{
+	printf("%s\n%s\n", caption_I ? caption_I : "", text_I ? text_I : "");
+	fflush(stdout);
+	return 1;		// IDOK
+}
+
+void OutputDebugStringA(LPCSTR)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GDI
+
+HDC CreateCompatibleDC(HDC)
+{
+	return reinterpret_cast<HDC>(new DeviceContext{ &gStockBitmap, false, RECT{ 0, 0, 0, 0 } });
+}
+
+BOOL DeleteDC(HDC hdc_I)
+{
+	delete reinterpret_cast<DeviceContext *>(hdc_I);
+	return hdc_I != NULL;
+}
+
+HBITMAP CreateDIBSection(HDC, const BITMAPINFO *info_I, UINT, void **bits_O, HANDLE, DWORD)
+{
+	if (!info_I || info_I->bmiHeader.biBitCount != 32 || info_I->bmiHeader.biWidth <= 0 || info_I->bmiHeader.biHeight == 0)
+	{
+		return NULL;
+	}
+
+	DibSection *bitmap = new DibSection;
+	bitmap->width = info_I->bmiHeader.biWidth;
+	bitmap->height = std::abs(info_I->bmiHeader.biHeight);
+	bitmap->bits.resize(static_cast<size_t>(bitmap->width) * bitmap->height);
+	if (bits_O)
+	{
+		*bits_O = bitmap->bits.data();
+	}
+	return reinterpret_cast<HBITMAP>(static_cast<GdiObject *>(bitmap));
+}
+
+HGDIOBJ SelectObject(HDC hdc_I, HGDIOBJ object_I)
+{
+	DeviceContext *dc = reinterpret_cast<DeviceContext *>(hdc_I);
+	GdiObject *object = static_cast<GdiObject *>(object_I);
+	if (!dc || !dynamic_cast<DibSection *>(object))
+	{
+		return NULL;
+	}
+	GdiObject *previous = dc->selected;
+	dc->selected = object;
+	return previous;
+}
+
+BOOL DeleteObject(HGDIOBJ object_I)
+{
+	GdiObject *object = static_cast<GdiObject *>(object_I);
+	if (!object || object == &gStockBitmap)
+	{
+		return FALSE;
+	}
+	delete object;
+	return TRUE;
+}
+
+HRGN CreateRectRgn(int left_I, int top_I, int right_I, int bottom_I)
+{
+	Region *region = new Region;
+	SetRegion(*region, left_I, top_I, right_I, bottom_I);
+	return reinterpret_cast<HRGN>(static_cast<GdiObject *>(region));
+}
+
+HRGN CreateRectRgnIndirect(const RECT *rect_I)
+{
+	return CreateRectRgn(rect_I->left, rect_I->top, rect_I->right, rect_I->bottom);
+}
+
+int CombineRgn(HRGN destination_O, HRGN source1_I, HRGN source2_I, int mode_I)
+{
+	Region *destination = dynamic_cast<Region *>(reinterpret_cast<GdiObject *>(destination_O));
+	const Region *source1 = dynamic_cast<const Region *>(reinterpret_cast<GdiObject *>(source1_I));
+	const Region *source2 = dynamic_cast<const Region *>(reinterpret_cast<GdiObject *>(source2_I));
+	if (!destination || !source1 || !source2 || mode_I != RGN_OR)
+	{
+		return ERROR;
+	}
+
+	if (source1->type == NULLREGION || source2->type == NULLREGION)
+	{
+		*destination = source1->type == NULLREGION ? *source2 : *source1;
+		return destination->type;
+	}
+
+	const RECT &a = source1->box;
+	const RECT &b = source2->box;
+	const bool aHoldsB = a.left <= b.left && a.top <= b.top && a.right >= b.right && a.bottom >= b.bottom;
+	const bool bHoldsA = b.left <= a.left && b.top <= a.top && b.right >= a.right && b.bottom >= a.bottom;
+	const int type = (source1->type == SIMPLEREGION && bHoldsA) || (source2->type == SIMPLEREGION && aHoldsB) ?
+		SIMPLEREGION : COMPLEXREGION;
+	SetRegion(*destination, std::min(a.left, b.left), std::min(a.top, b.top),
+		std::max(a.right, b.right), std::max(a.bottom, b.bottom));
+	destination->type = type;
+	return type;
+}
+
+int SelectClipRgn(HDC hdc_I, HRGN region_I)
+{
+	DeviceContext *dc = reinterpret_cast<DeviceContext *>(hdc_I);
+	if (!dc)
+	{
+		return ERROR;
+	}
+	const Region *region = dynamic_cast<const Region *>(reinterpret_cast<GdiObject *>(region_I));
+	dc->clipped = region != nullptr;
+	if (!region)
+	{
+		return SIMPLEREGION;
+	}
+	dc->clip = region->box;
+	return region->type;
+}
+
+int GetClipBox(HDC hdc_I, RECT *rect_O)
+{
+	const DeviceContext *dc = reinterpret_cast<const DeviceContext *>(hdc_I);
+	if (!dc || !rect_O)
+	{
+		return ERROR;
+	}
+
+	const DibSection &bitmap = Selected(*dc);
+	RECT box = { 0, 0, bitmap.width, bitmap.height };
+	if (dc->clipped)
+	{
+		box.left = std::max(box.left, dc->clip.left);
+		box.top = std::max(box.top, dc->clip.top);
+		box.right = std::min(box.right, dc->clip.right);
+		box.bottom = std::min(box.bottom, dc->clip.bottom);
+	}
+	if (box.right <= box.left || box.bottom <= box.top)
+	{
+		*rect_O = RECT{ 0, 0, 0, 0 };
+		return NULLREGION;
+	}
+	*rect_O = box;
+	return SIMPLEREGION;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Time
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER *count_O)
+{
+	count_O->QuadPart = MonotonicNs();
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *frequency_O)
+{
+	frequency_O->QuadPart = 1000000000;
+	return TRUE;
+}
+
+DWORD GetTickCount(void)
+{
+	return static_cast<DWORD>(GetTickCount64());
+}
+
+ULONGLONG GetTickCount64(void)
+{
+	return static_cast<ULONGLONG>(MonotonicNs() / 1000000);
+}
+
+void Sleep(DWORD ms_I)
+{
+	const timespec duration = { static_cast<time_t>(ms_I / 1000), static_cast<long>(ms_I % 1000) * 1000000 };
+	nanosleep(&duration, nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Files
+
+DWORD GetTempPathA(DWORD size_I, LPSTR path_O)
+{
+	std::string path = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+	if (path.empty() || path.back() != '/')
+	{
+		path += '/';
+	}
+	if (path.size() + 1 > size_I)
+	{
+		return static_cast<DWORD>(path.size() + 1);
+	}
+	strcpy(path_O, path.c_str());
+	return static_cast<DWORD>(path.size());
+}
+
+BOOL CreateDirectoryA(LPCSTR path_I, void *)
+{
+	return mkdir(path_I, 0777) == 0;
+}
+
+BOOL RemoveDirectoryA(LPCSTR path_I)
+{
+	return rmdir(path_I) == 0;
+}
+
+BOOL DeleteFileA(LPCSTR path_I)
+{
+	return unlink(path_I) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GDI+
+
+namespace Gdiplus
+{
+	Status GdiplusStartup(ULONG_PTR *token_O, const GdiplusStartupInput *, void *)
+	{
+		*token_O = 1;
+		return Ok;
+	}
+
+	void GdiplusShutdown(ULONG_PTR)
+	{
+	}
+
+	const FontFamily *FontFamily::GenericSansSerif(void)
+	{
+		return &gSansSerif;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Bitmap::Bitmap(INT width_I, INT height_I, PixelFormat)
+	{
+		if (width_I <= 0 || height_I <= 0)
+		{
+			mStatus = InvalidParameter;
+			return;
+		}
+		mWidth = static_cast<UINT>(width_I);
+		mHeight = static_cast<UINT>(height_I);
+		mPixels.resize(static_cast<size_t>(mWidth) * mHeight);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Uncompressed 24 and 32 bpp BMP files only.
+
+	Bitmap::Bitmap(const WCHAR *path_I)
+	{
+		std::string path;
+		for (; path_I && *path_I; ++path_I)
+		{
+			path += static_cast<char>(*path_I);
+		}
+
+		std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+		if (!file)
+		{
+			mStatus = FileNotFound;
+			return;
+		}
+
+		BITMAPFILEHEADER fileHeader;
+		BITMAPINFOHEADER infoHeader;
+		file.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader));
+		file.read(reinterpret_cast<char *>(&infoHeader), sizeof(infoHeader));
+		const WORD bpp = infoHeader.biBitCount;
+		if (!file || fileHeader.bfType != 0x4D42 || infoHeader.biCompression != BI_RGB ||
+			(bpp != 24 && bpp != 32) || infoHeader.biWidth <= 0 || infoHeader.biHeight == 0)
+		{
+			mStatus = GenericError;
+			return;
+		}
+
+		const UINT width = static_cast<UINT>(infoHeader.biWidth);
+		const UINT height = static_cast<UINT>(std::abs(infoHeader.biHeight));
+		const size_t stride = (static_cast<size_t>(width) * bpp / 8 + 3) & ~static_cast<size_t>(3);
+		std::vector<BYTE> rows(stride * height);
+		file.seekg(fileHeader.bfOffBits);
+		file.read(reinterpret_cast<char *>(rows.data()), static_cast<std::streamsize>(rows.size()));
+		if (!file)
+		{
+			mStatus = GenericError;
+			return;
+		}
+
+		mWidth = width;
+		mHeight = height;
+		mPixels.resize(static_cast<size_t>(width) * height);
+		for (UINT y = 0; y < height; ++y)
+		{
+			const UINT row = infoHeader.biHeight > 0 ? height - 1 - y : y;
+			const BYTE *source = &rows[row * stride];
+			for (UINT x = 0; x < width; ++x, source += bpp / 8)
+			{
+				const UINT32 alpha = bpp == 32 ? source[3] : 0xFF;
+				mPixels[static_cast<size_t>(y) * width + x] = (alpha << 24) | (source[2] << 16) | (source[1] << 8) | source[0];
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Status Bitmap::LockBits(const Rect *rect_I, UINT, PixelFormat format_I, BitmapData *data_O)
+	{
+		const Rect all(0, 0, static_cast<INT>(mWidth), static_cast<INT>(mHeight));
+		const Rect rect = rect_I ? *rect_I : all;
+		if (mStatus != Ok || !data_O || rect.X < 0 || rect.Y < 0 || rect.Width <= 0 || rect.Height <= 0 ||
+			rect.X + rect.Width > all.Width || rect.Y + rect.Height > all.Height)
+		{
+			return InvalidParameter;
+		}
+
+		data_O->Width = static_cast<UINT>(rect.Width);
+		data_O->Height = static_cast<UINT>(rect.Height);
+		data_O->Stride = static_cast<INT>(mWidth * sizeof(UINT32));
+		data_O->PixelFormat = format_I;
+		data_O->Scan0 = &mPixels[static_cast<size_t>(rect.Y) * mWidth + rect.X];
+		data_O->Reserved = 0;
+		return Ok;
+	}
+
+	Status Bitmap::UnlockBits(BitmapData *)
+	{
+		return Ok;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Graphics::Graphics(Image *image_I) :
+		mBounds(0, 0, static_cast<INT>(image_I->GetWidth()), static_cast<INT>(image_I->GetHeight())),
+		mClip(mBounds)
+	{
+	}
+
+	Graphics::Graphics(HDC hdc_I)
+	{
+		const DibSection &bitmap = Selected(*reinterpret_cast<const DeviceContext *>(hdc_I));
+		mBounds = Rect(0, 0, bitmap.width, bitmap.height);
+
+		RECT clip;
+		mClip = GetClipBox(hdc_I, &clip) == NULLREGION ? Rect() :
+			Rect(clip.left, clip.top, clip.right - clip.left, clip.bottom - clip.top);
+	}
+
+	Status Graphics::SetClip(const Rect &rect_I)
+	{
+		mClip = Intersect(mBounds, rect_I);
+		return Ok;
+	}
+
+	Status Graphics::ResetClip(void)
+	{
+		mClip = mBounds;
+		return Ok;
+	}
+
+	unsigned long long Graphics::Covered(const Rect &rect_I) const
+	{
+		const Rect covered = Intersect(mClip, rect_I);
+		return static_cast<unsigned long long>(covered.Width) * covered.Height;
+	}
+
+	Status Graphics::Primitive(void)
+	{
+		++gDrawStats.primitives;
+		return Ok;
+	}
+
+	Status Graphics::Clear(const Color &)
+	{
+		gDrawStats.pixelsCleared += Covered(mBounds);
+		return Ok;
+	}
+
+	Status Graphics::DrawImage(Image *image_I, INT x_I, INT y_I)
+	{
+		gDrawStats.pixelsCopied += Covered(Rect(x_I, y_I, static_cast<INT>(image_I->GetWidth()), static_cast<INT>(image_I->GetHeight())));
+		return Ok;
+	}
+
+	Status Graphics::DrawImage(Image *, const Rect &destination_I, INT, INT, INT, INT, Unit)
+	{
+		gDrawStats.pixelsCopied += Covered(destination_I);
+		return Ok;
+	}
+
+	Status Graphics::DrawLine(const Pen *, REAL, REAL, REAL, REAL)								{ return Primitive(); }
+	Status Graphics::DrawRectangle(const Pen *, REAL, REAL, REAL, REAL)						{ return Primitive(); }
+	Status Graphics::FillRectangle(const Brush *, REAL, REAL, REAL, REAL)					{ return Primitive(); }
+	Status Graphics::DrawEllipse(const Pen *, REAL, REAL, REAL, REAL)							{ return Primitive(); }
+	Status Graphics::FillEllipse(const Brush *, REAL, REAL, REAL, REAL)						{ return Primitive(); }
+	Status Graphics::DrawString(const WCHAR *, INT, const Font *, const PointF &, const Brush *)	{ return Primitive(); }
+
+	Status Graphics::DrawString(const WCHAR *, INT, const Font *, const PointF &, const StringFormat *, const Brush *)
+	{
+		return Primitive();
+	}
+}
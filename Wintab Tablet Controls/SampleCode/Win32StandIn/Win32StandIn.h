@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Stand-ins for the Windows headers and libraries the sample needs, so
+//		that its benchmarks build and run on Linux against WintabStandIn.
+//
+//		The directory takes the place of the Windows SDK on the include
+//		path: windows.h, gdiplus.h and tchar.h declare what the sample uses,
+//		and wintab.h and pktdef.h forward to the Wintab headers, whose names
+//		are upper case.  Win32StandIn.cpp implements them as a library of
+//		its own, which WintabStandIn links too.  LoadLibraryA("Wintab32.dll")
+//		loads libwintab32.so, from the executable's directory first.
+//
+//		Nothing is drawn: the GDI+ stand-in counts what the sample draws,
+//		for the benchmarks to report where Windows would time it.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	///////////////////////////////////////////////////////////////////////////
+	// What Gdiplus::Graphics was asked to draw.  Pixels are those inside the
+	// target surface and its clip.
+	//
+	typedef struct tagWIN32STANDINDRAWSTATS
+	{
+		unsigned long long	primitives;			// lines, shapes and strings
+		unsigned long long	pixelsCleared;
+		unsigned long long	pixelsCopied;		// by DrawImage
+	} WIN32STANDINDRAWSTATS;
+
+	void Win32StandInGetDrawStats(WIN32STANDINDRAWSTATS *stats_O);
+	void Win32StandInResetDrawStats(void);
+
+#ifdef __cplusplus
+}
+#endif
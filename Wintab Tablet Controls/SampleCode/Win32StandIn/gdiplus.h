@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Stand-in for <gdiplus.h> on Linux: the GDI+ classes the sample
+//		draws and decodes images with.  Bitmaps decode uncompressed 24 and
+//		32 bpp BMP files only.  Graphics draws nothing; it counts the
+//		primitives drawn and the pixels cleared and copied, which
+//		Win32StandInGetDrawStats reports (see Win32StandIn.h).
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <windows.h>
+
+#include <vector>
+
+#define PixelFormat32bppARGB		0x0026200A
+#define PixelFormat32bppPARGB		0x000E200B
+
+namespace Gdiplus
+{
+	typedef float	REAL;
+	typedef int		PixelFormat;
+
+	enum Status
+	{
+		Ok = 0,
+		GenericError = 1,
+		InvalidParameter = 2,
+		FileNotFound = 10
+	};
+
+	enum ImageLockMode
+	{
+		ImageLockModeRead = 1,
+		ImageLockModeWrite = 2
+	};
+
+	enum SmoothingMode
+	{
+		SmoothingModeDefault = 0,
+		SmoothingModeHighQuality = 2
+	};
+
+	enum CompositingMode
+	{
+		CompositingModeSourceOver,
+		CompositingModeSourceCopy
+	};
+
+	enum Unit
+	{
+		UnitPixel = 2
+	};
+
+	enum StringAlignment
+	{
+		StringAlignmentNear,
+		StringAlignmentCenter,
+		StringAlignmentFar
+	};
+
+	struct GdiplusStartupInput
+	{
+	};
+
+	Status GdiplusStartup(ULONG_PTR *token_O, const GdiplusStartupInput *input_I, void *output_O);
+	void GdiplusShutdown(ULONG_PTR token_I);
+
+	///////////////////////////////////////////////////////////////////////////
+
+	class Color
+	{
+	public:
+		enum
+		{
+			Black = 0xFF000000,
+			White = 0xFFFFFFFF,
+			LightGray = 0xFFD3D3D3,
+			CornflowerBlue = 0xFF6495ED
+		};
+
+		Color(UINT32 argb_I = Black) : mArgb(argb_I) {}
+
+		UINT32 GetValue(void) const { return mArgb; }
+
+	private:
+		UINT32	mArgb;
+	};
+
+	struct PointF
+	{
+		PointF(REAL x_I, REAL y_I) : X(x_I), Y(y_I) {}
+
+		REAL	X;
+		REAL	Y;
+	};
+
+	struct Rect
+	{
+		Rect() : X(0), Y(0), Width(0), Height(0) {}
+		Rect(INT x_I, INT y_I, INT width_I, INT height_I) : X(x_I), Y(y_I), Width(width_I), Height(height_I) {}
+
+		BOOL IntersectsWith(const Rect &rect_I) const
+		{
+			return X < rect_I.X + rect_I.Width && rect_I.X < X + Width &&
+				Y < rect_I.Y + rect_I.Height && rect_I.Y < Y + Height;
+		}
+
+		INT		X;
+		INT		Y;
+		INT		Width;
+		INT		Height;
+	};
+
+	struct BitmapData
+	{
+		UINT			Width;
+		UINT			Height;
+		INT				Stride;
+		INT				PixelFormat;
+		void			*Scan0;
+		UINT_PTR		Reserved;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	class Brush
+	{
+	public:
+		virtual ~Brush() {}
+	};
+
+	class SolidBrush : public Brush
+	{
+	public:
+		SolidBrush(const Color &color_I) : mColor(color_I) {}
+
+	private:
+		Color	mColor;
+	};
+
+	class Pen
+	{
+	public:
+		Pen(const Color &color_I, REAL width_I = 1.0f) : mColor(color_I), mWidth(width_I) {}
+
+	private:
+		Color	mColor;
+		REAL	mWidth;
+	};
+
+	class FontFamily
+	{
+	public:
+		static const FontFamily *GenericSansSerif(void);
+	};
+
+	class Font
+	{
+	public:
+		Font(const FontFamily *family_I, REAL size_I) : mFamily(family_I), mSize(size_I) {}
+
+	private:
+		const FontFamily	*mFamily;
+		REAL				mSize;
+	};
+
+	class StringFormat
+	{
+	public:
+		StringFormat() : mAlign(StringAlignmentNear), mLineAlign(StringAlignmentNear) {}
+
+		Status SetAlignment(StringAlignment align_I) { mAlign = align_I; return Ok; }
+		Status SetLineAlignment(StringAlignment align_I) { mLineAlign = align_I; return Ok; }
+
+	private:
+		StringAlignment	mAlign;
+		StringAlignment	mLineAlign;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	class Image
+	{
+	public:
+		virtual ~Image() {}
+
+		UINT GetWidth(void) const { return mWidth; }
+		UINT GetHeight(void) const { return mHeight; }
+		Status GetLastStatus(void) const { return mStatus; }
+
+	protected:
+		Image() : mWidth(0), mHeight(0), mStatus(Ok) {}
+
+		UINT		mWidth;
+		UINT		mHeight;
+		Status		mStatus;
+	};
+
+	class Bitmap : public Image
+	{
+	public:
+		Bitmap(INT width_I, INT height_I, PixelFormat format_I);
+		Bitmap(const WCHAR *path_I);
+
+		Status LockBits(const Rect *rect_I, UINT flags_I, PixelFormat format_I, BitmapData *data_O);
+		Status UnlockBits(BitmapData *data_I);
+
+	private:
+		std::vector<UINT32>	mPixels;			// ARGB, top down
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	// Draws nothing; see Win32StandInGetDrawStats.
+
+	class Graphics
+	{
+	public:
+		Graphics(Image *image_I);
+		Graphics(HDC hdc_I);
+
+		Status SetSmoothingMode(SmoothingMode mode_I) { (void)mode_I; return Ok; }
+		Status SetCompositingMode(CompositingMode mode_I) { (void)mode_I; return Ok; }
+		Status SetClip(const Rect &rect_I);
+		Status ResetClip(void);
+
+		Status Clear(const Color &color_I);
+		Status DrawImage(Image *image_I, INT x_I, INT y_I);
+		Status DrawImage(Image *image_I, const Rect &destination_I, INT x_I, INT y_I, INT width_I, INT height_I, Unit unit_I);
+
+		Status DrawLine(const Pen *pen_I, REAL x1_I, REAL y1_I, REAL x2_I, REAL y2_I);
+		Status DrawRectangle(const Pen *pen_I, REAL x_I, REAL y_I, REAL width_I, REAL height_I);
+		Status FillRectangle(const Brush *brush_I, REAL x_I, REAL y_I, REAL width_I, REAL height_I);
+		Status DrawEllipse(const Pen *pen_I, REAL x_I, REAL y_I, REAL width_I, REAL height_I);
+		Status FillEllipse(const Brush *brush_I, REAL x_I, REAL y_I, REAL width_I, REAL height_I);
+		Status DrawString(const WCHAR *text_I, INT length_I, const Font *font_I, const PointF &origin_I, const Brush *brush_I);
+		Status DrawString(const WCHAR *text_I, INT length_I, const Font *font_I, const PointF &origin_I,
+			const StringFormat *format_I, const Brush *brush_I);
+
+	private:
+		// Pixels of rect_I inside the surface and the clip.
+		unsigned long long Covered(const Rect &rect_I) const;
+		Status Primitive(void);
+
+		Rect	mBounds;			// of the surface
+		Rect	mClip;
+	};
+}
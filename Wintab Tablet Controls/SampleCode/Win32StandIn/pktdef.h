@@ -0,0 +1,14 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Forwards <pktdef.h> to the sample's Wintab/PKTDEF.H on file systems
+//		where case matters.  No include guard: PKTDEF.H may be included once
+//		per packet format.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "../Wintab/PKTDEF.H"
@@ -0,0 +1,22 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Stand-in for <tchar.h> on Linux, where TCHAR is char.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string.h>
+
+typedef char			TCHAR;
+typedef char			*LPTSTR;
+typedef const char		*LPCTSTR;
+
+#define _T(x_I)			x_I
+#define _tcslen			strlen
+#define _tcsstr			strstr
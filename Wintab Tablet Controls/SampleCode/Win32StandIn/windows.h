@@ -0,0 +1,260 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Stand-in for <windows.h> on Linux: the Win32 types, macros and calls
+//		that the sample's benchmarks and WintabStandIn use, implemented in
+//		Win32StandIn.cpp.  Windows get a size and no message queue; DCs and
+//		regions keep the bitmap and clip box that the drawing code reads
+//		back.  See CMakeLists.txt and Win32StandIn.h.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Types, with the sizes they have on Windows
+
+typedef int					BOOL;
+typedef unsigned char		BYTE;
+typedef char				CHAR;
+typedef uint16_t			WORD;
+typedef uint32_t			DWORD;
+typedef int32_t				LONG;
+typedef uint32_t			ULONG;
+typedef int64_t				LONGLONG;
+typedef uint64_t			ULONGLONG;
+typedef short				SHORT;
+typedef unsigned short		USHORT;
+typedef int					INT;
+typedef unsigned int		UINT;
+typedef int32_t				INT32;
+typedef uint8_t				UINT8;
+typedef uint16_t			UINT16;
+typedef uint32_t			UINT32;
+typedef int64_t				INT64;
+typedef uint64_t			UINT64;
+typedef float				FLOAT;
+typedef wchar_t				WCHAR;
+typedef intptr_t			INT_PTR;
+typedef uintptr_t			UINT_PTR;
+typedef uintptr_t			ULONG_PTR;
+typedef unsigned short		ATOM;
+typedef DWORD				COLORREF;
+
+typedef intptr_t			LPARAM;
+typedef uintptr_t			WPARAM;
+typedef intptr_t			LRESULT;
+
+typedef void				*LPVOID;
+typedef const void			*LPCVOID;
+typedef char				*LPSTR;
+typedef const char			*LPCSTR;
+typedef wchar_t				*LPWSTR;
+typedef const wchar_t		*LPCWSTR;
+typedef BOOL				*LPBOOL;
+typedef BYTE				*LPBYTE;
+typedef WORD				*LPWORD;
+typedef DWORD				*LPDWORD;
+typedef LONG				*LPLONG;
+typedef int					*LPINT;
+
+#define DECLARE_HANDLE(name_I)	struct name_I##__ { int unused; }; typedef struct name_I##__ *name_I
+
+typedef void				*HANDLE;
+typedef void				*HGDIOBJ;
+DECLARE_HANDLE(HWND);
+DECLARE_HANDLE(HINSTANCE);
+typedef HINSTANCE			HMODULE;
+DECLARE_HANDLE(HDC);
+DECLARE_HANDLE(HBITMAP);
+DECLARE_HANDLE(HBRUSH);
+DECLARE_HANDLE(HPEN);
+DECLARE_HANDLE(HRGN);
+
+typedef struct tagRECT
+{
+	LONG	left;
+	LONG	top;
+	LONG	right;
+	LONG	bottom;
+} RECT, *LPRECT;
+
+typedef struct tagPOINT
+{
+	LONG	x;
+	LONG	y;
+} POINT, *LPPOINT;
+
+typedef struct tagSIZE
+{
+	LONG	cx;
+	LONG	cy;
+} SIZE;
+
+typedef union _LARGE_INTEGER
+{
+	struct
+	{
+		DWORD	LowPart;
+		LONG	HighPart;
+	};
+	LONGLONG	QuadPart;
+} LARGE_INTEGER;
+
+typedef struct tagBITMAPINFOHEADER
+{
+	DWORD	biSize;
+	LONG	biWidth;
+	LONG	biHeight;
+	WORD	biPlanes;
+	WORD	biBitCount;
+	DWORD	biCompression;
+	DWORD	biSizeImage;
+	LONG	biXPelsPerMeter;
+	LONG	biYPelsPerMeter;
+	DWORD	biClrUsed;
+	DWORD	biClrImportant;
+} BITMAPINFOHEADER;
+
+#pragma pack(push, 2)
+typedef struct tagBITMAPFILEHEADER
+{
+	WORD	bfType;
+	DWORD	bfSize;
+	WORD	bfReserved1;
+	WORD	bfReserved2;
+	DWORD	bfOffBits;
+} BITMAPFILEHEADER;
+#pragma pack(pop)
+
+typedef struct tagRGBQUAD
+{
+	BYTE	rgbBlue;
+	BYTE	rgbGreen;
+	BYTE	rgbRed;
+	BYTE	rgbReserved;
+} RGBQUAD;
+
+typedef struct tagBITMAPINFO
+{
+	BITMAPINFOHEADER	bmiHeader;
+	RGBQUAD				bmiColors[1];
+} BITMAPINFO;
+
+////////////////////////////////////////////////////////////////////////////////
+// Macros
+
+#define TRUE				1
+#define FALSE				0
+#define MAX_PATH			260
+#define MAXDWORD			0xffffffffu
+#define INFINITE			0xffffffffu
+
+#define WINAPI
+#define APIENTRY
+#define CALLBACK
+#define PASCAL
+#define FAR
+#define NEAR
+
+#define LOBYTE(w_I)			((BYTE)((UINT_PTR)(w_I) & 0xff))
+#define LOWORD(l_I)			((WORD)((UINT_PTR)(l_I) & 0xffff))
+#define HIWORD(l_I)			((WORD)(((UINT_PTR)(l_I) >> 16) & 0xffff))
+#define MAKELONG(a_I, b_I)	((LONG)(((WORD)(a_I)) | ((DWORD)((WORD)(b_I))) << 16))
+#define MAKELPARAM(l_I, h_I)	((LPARAM)(DWORD)MAKELONG(l_I, h_I))
+#define RGB(r_I, g_I, b_I)	((COLORREF)((BYTE)(r_I) | ((WORD)(BYTE)(g_I) << 8) | ((DWORD)(BYTE)(b_I) << 16)))
+
+#define UNREFERENCED_PARAMETER(p_I)	(void)(p_I)
+
+#ifndef _countof
+	#define _countof(a_I)	(sizeof(a_I) / sizeof((a_I)[0]))
+#endif
+
+#define sprintf_s			snprintf
+
+inline int _stricmp(const char *a_I, const char *b_I)
+{
+	return strcasecmp(a_I, b_I);
+}
+
+#define WM_USER				0x0400
+#define WM_APP				0x8000
+
+#define WS_POPUP			0x80000000L
+#define HWND_MESSAGE		((HWND)(INT_PTR)-3)
+
+#define MB_OK				0x00000000L
+#define MB_ICONERROR		0x00000010L
+#define MB_ICONINFORMATION	0x00000040L
+
+#define BI_RGB				0
+#define DIB_RGB_COLORS		0
+
+#define ERROR				0
+#define NULLREGION			1
+#define SIMPLEREGION		2
+#define COMPLEXREGION		3
+#define RGN_OR				2
+
+////////////////////////////////////////////////////////////////////////////////
+// Calls
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	// Libraries: "Name.dll" is libname.so, found as dlopen finds it.
+	HMODULE LoadLibraryA(LPCSTR name_I);
+	BOOL FreeLibrary(HMODULE module_I);
+	void *GetProcAddress(HMODULE module_I, LPCSTR name_I);
+	DWORD GetLastError(void);
+
+	// Windows: a size, and nothing posted to them is delivered.
+	HWND CreateWindowExA(DWORD exStyle_I, LPCSTR className_I, LPCSTR windowName_I, DWORD style_I,
+		int x_I, int y_I, int width_I, int height_I, HWND parent_I, void *menu_I, HINSTANCE instance_I, void *param_I);
+	BOOL DestroyWindow(HWND hWnd_I);
+	BOOL GetClientRect(HWND hWnd_I, RECT *rect_O);
+	BOOL PostMessage(HWND hWnd_I, UINT message_I, WPARAM wParam_I, LPARAM lParam_I);
+	UINT_PTR SetTimer(HWND hWnd_I, UINT_PTR id_I, UINT elapseMs_I, void *timerProc_I);
+	BOOL KillTimer(HWND hWnd_I, UINT_PTR id_I);
+	int MessageBoxA(HWND hWnd_I, LPCSTR text_I, LPCSTR caption_I, UINT type_I);
+	void OutputDebugStringA(LPCSTR text_I);
+
+	// GDI: memory DCs, DIB sections and rectangular clip regions.
+	HDC CreateCompatibleDC(HDC hdc_I);
+	BOOL DeleteDC(HDC hdc_I);
+	HBITMAP CreateDIBSection(HDC hdc_I, const BITMAPINFO *info_I, UINT usage_I, void **bits_O, HANDLE section_I, DWORD offset_I);
+	HGDIOBJ SelectObject(HDC hdc_I, HGDIOBJ object_I);
+	BOOL DeleteObject(HGDIOBJ object_I);
+	HRGN CreateRectRgn(int left_I, int top_I, int right_I, int bottom_I);
+	HRGN CreateRectRgnIndirect(const RECT *rect_I);
+	int CombineRgn(HRGN destination_O, HRGN source1_I, HRGN source2_I, int mode_I);
+	int SelectClipRgn(HDC hdc_I, HRGN region_I);
+	int GetClipBox(HDC hdc_I, RECT *rect_O);
+
+	// Time.
+	BOOL QueryPerformanceCounter(LARGE_INTEGER *count_O);
+	BOOL QueryPerformanceFrequency(LARGE_INTEGER *frequency_O);
+	DWORD GetTickCount(void);
+	ULONGLONG GetTickCount64(void);
+	void Sleep(DWORD ms_I);
+
+	// Files.
+	DWORD GetTempPathA(DWORD size_I, LPSTR path_O);
+	BOOL CreateDirectoryA(LPCSTR path_I, void *security_I);
+	BOOL RemoveDirectoryA(LPCSTR path_I);
+	BOOL DeleteFileA(LPCSTR path_I);
+
+#ifdef __cplusplus
+}
+#endif
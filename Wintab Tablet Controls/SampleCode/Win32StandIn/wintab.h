@@ -0,0 +1,13 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Forwards <wintab.h> to the sample's Wintab/WINTAB.H on file systems
+//		where case matters.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "../Wintab/WINTAB.H"
@@ -0,0 +1,723 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Stand-in for the Wintab driver library, with synthetic tablet controls.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "WintabStandIn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Local types and state
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct FunctionState
+	{
+		BOOL						overridden;
+		std::string				name;
+		std::vector<BYTE>		icon;
+	};
+
+	struct ControlState
+	{
+		UINT32						location;
+		UINT32						min;
+		UINT32						max;
+		UINT32						iconFormat;
+		std::vector<FunctionState>	functions;
+	};
+
+	struct TabletState
+	{
+		bool							attached;
+		std::vector<ControlState>	keys;
+		std::vector<ControlState>	rings;
+		std::vector<ControlState>	strips;
+	};
+
+	struct Context
+	{
+		HWND			window;
+	};
+
+	struct Extension
+	{
+		UINT			tag;
+		const char	*name;
+	};
+
+	// The extensions, in the driver's order.  Each has a packet bit of its
+	// own, from EXTENSION_MASK_BASE up.
+	const Extension kExtensions[] =
+	{
+		{ WTX_OBT,			"Out of bounds tracking" },
+		{ WTX_FKEYS,		"Function keys" },
+		{ WTX_TILT,			"Cartesian tilt" },
+		{ WTX_CSRMASK,		"Cursor mask" },
+		{ WTX_XBTNMASK,	"Extended button mask" },
+		{ WTX_EXPKEYS,		"ExpressKeys" },
+		{ WTX_TOUCHSTRIP,	"TouchStrips" },
+		{ WTX_TOUCHRING,	"TouchRings" },
+		{ WTX_EXPKEYS2,	"ExpressKeys 2" },
+	};
+	const UINT kExtensionCount = sizeof(kExtensions) / sizeof(kExtensions[0]);
+	const WTPKT EXTENSION_MASK_BASE = 0x00010000;
+
+	std::mutex									gLock;
+	bool											gConfigured = false;
+	WTSTANDINCONFIG							gConfig;
+	std::vector<TabletState>				gTablets;
+	std::vector<std::unique_ptr<Context>>	gContexts;
+	WTSTANDINSTATS								gStats;
+
+	////////////////////////////////////////////////////////////////////////////
+	// Busy waits, since a sleep would take a whole scheduler tick.
+
+	void Wait(UINT us_I)
+	{
+		const Clock::time_point until = Clock::now() + std::chrono::microseconds(us_I);
+		while (Clock::now() < until)
+		{
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	ControlState MakeControl(UINT32 location_I, UINT32 max_I, UINT32 iconFormat_I, UINT functions_I)
+	{
+		ControlState control;
+		control.location = location_I;
+		control.min = 0;
+		control.max = max_I;
+		control.iconFormat = iconFormat_I;
+		control.functions.resize(std::max(functions_I, 1u), FunctionState { FALSE, std::string(), std::vector<BYTE>() });
+		return control;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// ExpressKeys are split between the left and right, rings and strips
+	// alternate between them.
+
+	TabletState MakeTablet(const WTSTANDINCONFIG &config_I)
+	{
+		TabletState tablet;
+		tablet.attached = true;
+		for (UINT idx = 0; idx < config_I.keys; ++idx)
+		{
+			tablet.keys.push_back(MakeControl(idx < (config_I.keys + 1) / 2 ? TABLET_LOC_LEFT : TABLET_LOC_RIGHT,
+				0, idx < config_I.displays ? TABLET_ICON_FMT_4BPP_GRAY : TABLET_ICON_FMT_NONE, 1));
+		}
+		for (UINT idx = 0; idx < config_I.rings; ++idx)
+		{
+			tablet.rings.push_back(MakeControl(idx % 2 ? TABLET_LOC_RIGHT : TABLET_LOC_LEFT,
+				WTSTANDIN_RING_MAX, TABLET_ICON_FMT_NONE, config_I.modes));
+		}
+		for (UINT idx = 0; idx < config_I.strips; ++idx)
+		{
+			tablet.strips.push_back(MakeControl(idx % 2 ? TABLET_LOC_RIGHT : TABLET_LOC_LEFT,
+				WTSTANDIN_STRIP_MAX, TABLET_ICON_FMT_NONE, config_I.modes));
+		}
+		return tablet;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void Configure(const WTSTANDINCONFIG &config_I)
+	{
+		gConfig = config_I;
+		gConfig.tablets = std::min<UINT>(gConfig.tablets, WTSTANDIN_MAX_TABLETS);
+		gTablets.assign(gConfig.tablets, MakeTablet(gConfig));
+		gConfigured = true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Call under gLock.
+
+	void EnsureConfigured(void)
+	{
+		if (!gConfigured)
+		{
+			WTSTANDINCONFIG config;
+			WintabStandInGetDefaultConfig(&config);
+			Configure(config);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	bool IsContext(HCTX ctx_I)
+	{
+		return std::any_of(gContexts.begin(), gContexts.end(),
+			[ctx_I](const std::unique_ptr<Context> &context_I) { return reinterpret_cast<HCTX>(context_I.get()) == ctx_I; });
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Copies size_I bytes to the caller's buffer, if any, and returns the
+	// size, as WTInfo does.
+
+	UINT Output(LPVOID output_O, const void *data_I, UINT size_I)
+	{
+		if (output_O)
+		{
+			memcpy(output_O, data_I, size_I);
+		}
+		return size_I;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	LOGCONTEXTA DefaultContext(UINT device_I, bool system_I)
+	{
+		LOGCONTEXTA context;
+		memset(&context, 0, sizeof(context));
+		strcpy(context.lcName, system_I ? "StandIn System Context" : "StandIn Digitizing Context");
+		context.lcOptions = system_I ? CXO_SYSTEM : 0;
+		context.lcDevice = device_I;
+		context.lcPktRate = 200;
+		context.lcPktData = PK_X | PK_Y | PK_BUTTONS | PK_CURSOR | PK_NORMAL_PRESSURE;
+		context.lcMoveMask = context.lcPktData;
+		context.lcBtnDnMask = 0xFFFFFFFF;
+		context.lcBtnUpMask = 0xFFFFFFFF;
+		context.lcInExtX = 32767;
+		context.lcInExtY = 32767;
+		context.lcOutExtX = 32767;
+		context.lcOutExtY = 32767;
+		context.lcSysMode = FALSE;
+		return context;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	UINT Info(UINT category_I, UINT index_I, LPVOID output_O)
+	{
+		if (category_I == 0)
+		{
+			return sizeof(LOGCONTEXTA);
+		}
+
+		if (category_I == WTI_INTERFACE)
+		{
+			const UINT count = index_I == IFC_NDEVICES ? static_cast<UINT>(gTablets.size()) :
+				index_I == IFC_NEXTENSIONS ? kExtensionCount : 0;
+			return count ? Output(output_O, &count, sizeof(count)) : 0;
+		}
+
+		if (category_I == WTI_DEFCONTEXT || category_I == WTI_DEFSYSCTX)
+		{
+			const LOGCONTEXTA context = DefaultContext(0, category_I == WTI_DEFSYSCTX);
+			return Output(output_O, &context, sizeof(context));
+		}
+
+		if ((category_I >= WTI_DDCTXS && category_I < WTI_DDCTXS + WTSTANDIN_MAX_TABLETS) ||
+			(category_I >= WTI_DSCTXS && category_I < WTI_DSCTXS + WTSTANDIN_MAX_TABLETS))
+		{
+			const bool system = category_I >= WTI_DSCTXS;
+			const UINT tablet = category_I - (system ? WTI_DSCTXS : WTI_DDCTXS);
+			if (tablet >= gTablets.size())
+			{
+				return 0;
+			}
+			const LOGCONTEXTA context = DefaultContext(tablet, system);
+			return Output(output_O, &context, sizeof(context));
+		}
+
+		if (category_I >= WTI_EXTENSIONS && category_I < WTI_EXTENSIONS + kExtensionCount)
+		{
+			const UINT ext = category_I - WTI_EXTENSIONS;
+			switch (index_I)
+			{
+				case EXT_NAME:
+				{
+					return Output(output_O, kExtensions[ext].name, static_cast<UINT>(strlen(kExtensions[ext].name) + 1));
+				}
+				case EXT_TAG:
+				{
+					return Output(output_O, &kExtensions[ext].tag, sizeof(UINT));
+				}
+				case EXT_MASK:
+				{
+					const WTPKT mask = EXTENSION_MASK_BASE << ext;
+					return Output(output_O, &mask, sizeof(mask));
+				}
+				default:
+				{
+					return 0;
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	std::vector<ControlState> *Controls(UINT ext_I, UINT tablet_I)
+	{
+		if (tablet_I >= gTablets.size() || !gTablets[tablet_I].attached)
+		{
+			return nullptr;
+		}
+
+		TabletState &tablet = gTablets[tablet_I];
+		switch (ext_I)
+		{
+			case WTX_EXPKEYS2:
+			{
+				return &tablet.keys;
+			}
+			case WTX_TOUCHRING:
+			{
+				return &tablet.rings;
+			}
+			case WTX_TOUCHSTRIP:
+			{
+				return &tablet.strips;
+			}
+			default:
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	template <typename T>
+	bool Put(EXTPROPERTY &prop_IO, T value_I)
+	{
+		if (prop_IO.dataSize < sizeof(T))
+		{
+			return false;
+		}
+		memcpy(prop_IO.data, &value_I, sizeof(T));
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// The control and function indices are ignored where Wintab ignores
+	// them: by TABLET_PROPERTY_CONTROLCOUNT, and the function index by
+	// TABLET_PROPERTY_FUNCCOUNT.
+
+	bool GetProperty(UINT ext_I, EXTPROPERTY &prop_IO)
+	{
+		std::vector<ControlState> *controls = Controls(ext_I, prop_IO.tabletIndex);
+		if (!controls)
+		{
+			return false;
+		}
+		if (prop_IO.propertyID == TABLET_PROPERTY_CONTROLCOUNT)
+		{
+			return Put(prop_IO, static_cast<UINT32>(controls->size()));
+		}
+
+		if (prop_IO.controlIndex >= controls->size())
+		{
+			return false;
+		}
+		const ControlState &control = (*controls)[prop_IO.controlIndex];
+		if (prop_IO.propertyID == TABLET_PROPERTY_FUNCCOUNT)
+		{
+			return Put(prop_IO, static_cast<UINT32>(control.functions.size()));
+		}
+
+		if (prop_IO.functionIndex >= control.functions.size())
+		{
+			return false;
+		}
+		const FunctionState &function = control.functions[prop_IO.functionIndex];
+		const bool display = control.iconFormat != TABLET_ICON_FMT_NONE;
+		switch (prop_IO.propertyID)
+		{
+			case TABLET_PROPERTY_AVAILABLE:		return Put(prop_IO, static_cast<BOOL>(TRUE));
+			case TABLET_PROPERTY_MIN:				return Put(prop_IO, control.min);
+			case TABLET_PROPERTY_MAX:				return Put(prop_IO, control.max);
+			case TABLET_PROPERTY_OVERRIDE:		return Put(prop_IO, function.overridden);
+			case TABLET_PROPERTY_ICON_WIDTH:		return Put(prop_IO, static_cast<UINT32>(display ? gConfig.iconWidth : 0));
+			case TABLET_PROPERTY_ICON_HEIGHT:	return Put(prop_IO, static_cast<UINT32>(display ? gConfig.iconHeight : 0));
+			case TABLET_PROPERTY_ICON_FORMAT:	return Put(prop_IO, control.iconFormat);
+			case TABLET_PROPERTY_LOCATION:		return Put(prop_IO, control.location);
+
+			case TABLET_PROPERTY_OVERRIDE_NAME:
+			{
+				if (prop_IO.dataSize < function.name.size() + 1)
+				{
+					return false;
+				}
+				memcpy(prop_IO.data, function.name.c_str(), function.name.size() + 1);
+				return true;
+			}
+
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	bool SetProperty(UINT ext_I, const EXTPROPERTY &prop_I)
+	{
+		std::vector<ControlState> *controls = Controls(ext_I, prop_I.tabletIndex);
+		if (!controls || prop_I.controlIndex >= controls->size())
+		{
+			return false;
+		}
+		ControlState &control = (*controls)[prop_I.controlIndex];
+		if (prop_I.functionIndex >= control.functions.size())
+		{
+			return false;
+		}
+
+		FunctionState &function = control.functions[prop_I.functionIndex];
+		switch (prop_I.propertyID)
+		{
+			case TABLET_PROPERTY_OVERRIDE:
+			{
+				if (prop_I.dataSize < sizeof(BOOL))
+				{
+					return false;
+				}
+				memcpy(&function.overridden, prop_I.data, sizeof(BOOL));
+				break;
+			}
+
+			case TABLET_PROPERTY_OVERRIDE_NAME:
+			{
+				const char *name = reinterpret_cast<const char *>(prop_I.data);
+				function.name.assign(name, std::find(name, name + prop_I.dataSize, '\0'));
+				break;
+			}
+
+			case TABLET_PROPERTY_OVERRIDE_ICON:
+			{
+				// A display takes an icon of exactly its size, 4 bits per
+				// pixel, rows starting on a byte.
+				const size_t iconSize = static_cast<size_t>((gConfig.iconWidth + 1) / 2) * gConfig.iconHeight;
+				if (control.iconFormat != TABLET_ICON_FMT_4BPP_GRAY || prop_I.dataSize != iconSize)
+				{
+					return false;
+				}
+				function.icon.assign(prop_I.data, prop_I.data + prop_I.dataSize);
+				break;
+			}
+
+			default:
+			{
+				return false;
+			}
+		}
+
+		gStats.bytesSet += prop_I.dataSize;
+		return true;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Tells the windows of the open contexts that the tablets changed.  Call
+	// without gLock, since the windows may call back right away.
+
+	void PostInfoChange(const std::vector<HWND> &windows_I, UINT tablet_I)
+	{
+		for (HWND window : windows_I)
+		{
+			PostMessage(window, WT_INFOCHANGE, 0, MAKELPARAM(WTI_DEVICES, tablet_I));
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Call under gLock.
+
+	std::vector<HWND> ContextWindows(void)
+	{
+		std::vector<HWND> windows;
+		for (const std::unique_ptr<Context> &context : gContexts)
+		{
+			if (context->window)
+			{
+				windows.push_back(context->window);
+			}
+		}
+		return windows;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Stand-in configuration and hot plug
+
+void WintabStandInGetDefaultConfig(WTSTANDINCONFIG *config_O)
+{
+	if (!config_O)
+	{
+		return;
+	}
+
+	config_O->tablets = WTSTANDIN_DEFAULT_TABLETS;
+	config_O->keys = WTSTANDIN_DEFAULT_KEYS;
+	config_O->displays = WTSTANDIN_DEFAULT_DISPLAYS;
+	config_O->rings = WTSTANDIN_DEFAULT_RINGS;
+	config_O->strips = WTSTANDIN_DEFAULT_STRIPS;
+	config_O->modes = WTSTANDIN_DEFAULT_MODES;
+	config_O->iconWidth = WTSTANDIN_DEFAULT_ICON_WIDTH;
+	config_O->iconHeight = WTSTANDIN_DEFAULT_ICON_HEIGHT;
+	config_O->extLatencyUs = WTSTANDIN_DEFAULT_EXT_LATENCY_US;
+	config_O->infoLatencyUs = WTSTANDIN_DEFAULT_INFO_LATENCY_US;
+
+	// key=value pairs separated by commas; unknown keys are ignored.
+	const char *env = getenv("WINTAB_STANDIN");
+	std::stringstream pairs(env ? env : "");
+	std::string pair;
+	while (std::getline(pairs, pair, ','))
+	{
+		const size_t equals = pair.find('=');
+		if (equals == std::string::npos)
+		{
+			continue;
+		}
+
+		const std::string key = pair.substr(0, equals);
+		const std::string value = pair.substr(equals + 1);
+		const UINT number = static_cast<UINT>(strtoul(value.c_str(), nullptr, 10));
+		if (key == "tablets")				config_O->tablets = number;
+		else if (key == "keys")				config_O->keys = number;
+		else if (key == "displays")		config_O->displays = number;
+		else if (key == "rings")			config_O->rings = number;
+		else if (key == "strips")			config_O->strips = number;
+		else if (key == "modes")			config_O->modes = number;
+		else if (key == "extlatency")		config_O->extLatencyUs = number;
+		else if (key == "infolatency")	config_O->infoLatencyUs = number;
+		else if (key == "icon")
+		{
+			config_O->iconWidth = number;
+			const size_t by = value.find('x');
+			config_O->iconHeight = by == std::string::npos ? number : static_cast<UINT>(strtoul(value.c_str() + by + 1, nullptr, 10));
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOL WintabStandInSetConfig(const WTSTANDINCONFIG *config_I)
+{
+	if (!config_I)
+	{
+		return FALSE;
+	}
+
+	std::lock_guard<std::mutex> lock(gLock);
+	Configure(*config_I);
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOL WintabStandInAttachTablet(UINT *tablet_O)
+{
+	std::vector<HWND> windows;
+	UINT tablet = 0;
+	{
+		std::lock_guard<std::mutex> lock(gLock);
+		EnsureConfigured();
+
+		while (tablet < gTablets.size() && gTablets[tablet].attached)
+		{
+			++tablet;
+		}
+		if (tablet == WTSTANDIN_MAX_TABLETS)
+		{
+			return FALSE;
+		}
+
+		if (tablet == gTablets.size())
+		{
+			gTablets.push_back(MakeTablet(gConfig));
+		}
+		else
+		{
+			gTablets[tablet] = MakeTablet(gConfig);
+		}
+		windows = ContextWindows();
+	}
+
+	if (tablet_O)
+	{
+		*tablet_O = tablet;
+	}
+	PostInfoChange(windows, tablet);
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOL WintabStandInDetachTablet(UINT tablet_I)
+{
+	std::vector<HWND> windows;
+	{
+		std::lock_guard<std::mutex> lock(gLock);
+		EnsureConfigured();
+		if (tablet_I >= gTablets.size() || !gTablets[tablet_I].attached)
+		{
+			return FALSE;
+		}
+
+		gTablets[tablet_I].attached = false;
+		windows = ContextWindows();
+	}
+
+	PostInfoChange(windows, tablet_I);
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void WintabStandInGetStats(WTSTANDINSTATS *stats_O)
+{
+	std::lock_guard<std::mutex> lock(gLock);
+	if (stats_O)
+	{
+		*stats_O = gStats;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void WintabStandInResetStats(void)
+{
+	std::lock_guard<std::mutex> lock(gLock);
+	gStats = WTSTANDINSTATS();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Wintab functions
+
+UINT API WTInfoA(UINT wCategory, UINT nIndex, LPVOID lpOutput)
+{
+	UINT result = 0;
+	UINT latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(gLock);
+		EnsureConfigured();
+		gStats.infoCalls++;
+		latency = gConfig.infoLatencyUs;
+		result = Info(wCategory, nIndex, lpOutput);
+	}
+
+	Wait(latency);
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+HCTX API WTOpenA(HWND hWnd, LPLOGCONTEXTA lpLogCtx, BOOL fEnable)
+{
+	(void)lpLogCtx;
+	(void)fEnable;
+
+	std::lock_guard<std::mutex> lock(gLock);
+	EnsureConfigured();
+	gContexts.push_back(std::unique_ptr<Context>(new Context { hWnd }));
+	return reinterpret_cast<HCTX>(gContexts.back().get());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOL API WTClose(HCTX hCtx)
+{
+	std::lock_guard<std::mutex> lock(gLock);
+	const auto found = std::find_if(gContexts.begin(), gContexts.end(),
+		[hCtx](const std::unique_ptr<Context> &context_I) { return reinterpret_cast<HCTX>(context_I.get()) == hCtx; });
+	if (found == gContexts.end())
+	{
+		return FALSE;
+	}
+
+	gContexts.erase(found);
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOL API WTExtGet(HCTX hCtx, UINT wExt, LPVOID lpData)
+{
+	bool result = false;
+	UINT latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(gLock);
+		EnsureConfigured();
+		gStats.extGets++;
+		latency = gConfig.extLatencyUs;
+		result = lpData && IsContext(hCtx) && GetProperty(wExt, *static_cast<EXTPROPERTY *>(lpData));
+		gStats.extFailures += result ? 0 : 1;
+	}
+
+	Wait(latency);
+	return result ? TRUE : FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOL API WTExtSet(HCTX hCtx, UINT wExt, LPVOID lpData)
+{
+	bool result = false;
+	UINT latency = 0;
+	{
+		std::lock_guard<std::mutex> lock(gLock);
+		EnsureConfigured();
+		gStats.extSets++;
+		latency = gConfig.extLatencyUs;
+		result = lpData && IsContext(hCtx) && SetProperty(wExt, *static_cast<const EXTPROPERTY *>(lpData));
+		gStats.extFailures += result ? 0 : 1;
+	}
+
+	Wait(latency);
+	return result ? TRUE : FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The rest does nothing, or what a context without packets would.
+
+BOOL API WTGetA(HCTX hCtx, LPLOGCONTEXTA lpLogCtx)
+{
+	std::lock_guard<std::mutex> lock(gLock);
+	if (!lpLogCtx || !IsContext(hCtx))
+	{
+		return FALSE;
+	}
+	*lpLogCtx = DefaultContext(0, true);
+	return TRUE;
+}
+
+BOOL API WTSetA(HCTX hCtx, LPLOGCONTEXTA)						{ std::lock_guard<std::mutex> lock(gLock); return IsContext(hCtx); }
+BOOL API WTPacket(HCTX, UINT, LPVOID)							{ return FALSE; }
+int API WTPacketsGet(HCTX, int, LPVOID)						{ return 0; }
+BOOL API WTEnable(HCTX hCtx, BOOL)								{ std::lock_guard<std::mutex> lock(gLock); return IsContext(hCtx); }
+BOOL API WTOverlap(HCTX hCtx, BOOL)								{ std::lock_guard<std::mutex> lock(gLock); return IsContext(hCtx); }
+BOOL API WTConfig(HCTX, HWND)										{ return FALSE; }
+BOOL API WTSave(HCTX, LPVOID)										{ return FALSE; }
+HCTX API WTRestore(HWND, LPVOID, BOOL)							{ return NULL; }
+BOOL API WTQueueSizeSet(HCTX hCtx, int)						{ std::lock_guard<std::mutex> lock(gLock); return IsContext(hCtx); }
+int API WTDataPeek(HCTX, UINT, UINT, int, LPVOID, LPINT)	{ return 0; }
+HMGR API WTMgrOpen(HWND, UINT)									{ return NULL; }
+BOOL API WTMgrClose(HMGR)											{ return FALSE; }
+HCTX API WTMgrDefContext(HMGR, BOOL)							{ return NULL; }
+HCTX API WTMgrDefContextEx(HMGR, UINT, BOOL)					{ return NULL; }
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//	DESCRIPTION
+//		Stand-in for the Wintab driver library, with synthetic tablet controls.
+//
+//		Implements the parts of Wintab that the Tablet Controls sample uses:
+//		WTInfoA for the extensions and the tablets' default contexts,
+//		contexts, and WTExtGet / WTExtSet on the ExpressKey, TouchRing and
+//		TouchStrip properties of a configurable set of identical tablets.
+//		Each WTInfoA and WTExtGet / WTExtSet call waits for a configurable
+//		time, as a round trip to the tablet service would, so that the
+//		number of calls an application makes shows in its timings.
+//
+//		Windows: build WintabStandIn.vcxproj and copy the resulting
+//		Wintab32.dll next to the sample's executable; the sample loads it
+//		instead of the driver's.  Set WINTAB_STANDIN to configure it, e.g.
+//			WINTAB_STANDIN=tablets=3,keys=17,displays=8,rings=2,strips=2
+//		Other keys: modes=N (functions per ring and strip), icon=WxH,
+//		extlatency=us, infolatency=us.
+//
+//		Linux: CMakeLists.txt builds it as libwintab32.so, against the Win32
+//		stand-ins in Win32StandIn, next to the benchmarks, which load it as
+//		they would Wintab32.dll.  WINTAB_STANDIN configures it as above.
+//
+//		WintabStandInAttachTablet and WintabStandInDetachTablet plug tablets
+//		in and out while the library runs, posting WT_INFOCHANGE to the
+//		windows of the open contexts as the driver does.  Load them with
+//		GetProcAddress (see the typedefs below), since the driver's library
+//		has none of the WintabStandIn functions.
+//
+//	COPYRIGHT
+//		Copyright (c) 2014-2020 Wacom Co., Ltd.
+//		All rights reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <wintab.h>
+
+// Defaults of the stand-in configuration: a display tablet with two
+// ExpressKey Remotes' worth of controls on each of three tablets.
+#define WTSTANDIN_DEFAULT_TABLETS			3
+#define WTSTANDIN_DEFAULT_KEYS				17
+#define WTSTANDIN_DEFAULT_DISPLAYS			8
+#define WTSTANDIN_DEFAULT_RINGS				2
+#define WTSTANDIN_DEFAULT_STRIPS				2
+#define WTSTANDIN_DEFAULT_MODES				4
+#define WTSTANDIN_DEFAULT_ICON_WIDTH		64
+#define WTSTANDIN_DEFAULT_ICON_HEIGHT		32
+#define WTSTANDIN_DEFAULT_EXT_LATENCY_US	150
+#define WTSTANDIN_DEFAULT_INFO_LATENCY_US	30
+
+// Positions reported by the synthetic rings and strips, MIN to MAX.
+#define WTSTANDIN_RING_MAX					72
+#define WTSTANDIN_STRIP_MAX				32
+
+// Wintab remembers at most this many tablets.
+#define WTSTANDIN_MAX_TABLETS				16
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	///////////////////////////////////////////////////////////////////////////
+	// Every tablet has the same controls.  The first displays ExpressKeys
+	// have a 4 bpp grayscale icon display.
+	//
+	typedef struct tagWTSTANDINCONFIG
+	{
+		UINT		tablets;
+		UINT		keys;					// ExpressKeys per tablet
+		UINT		displays;			// of them, with an icon display
+		UINT		rings;
+		UINT		strips;
+		UINT		modes;				// functions per ring and strip
+		UINT		iconWidth;
+		UINT		iconHeight;
+		UINT		extLatencyUs;		// per WTExtGet and WTExtSet
+		UINT		infoLatencyUs;		// per WTInfoA
+	} WTSTANDINCONFIG;
+
+	typedef struct tagWTSTANDINSTATS
+	{
+		unsigned long long	infoCalls;
+		unsigned long long	extGets;
+		unsigned long long	extSets;
+		unsigned long long	extFailures;	// gets and sets that returned FALSE
+		unsigned long long	bytesSet;		// property data written
+	} WTSTANDINSTATS;
+
+	/// Fills config_O with the defaults, overridden by WINTAB_STANDIN if set.
+	void WintabStandInGetDefaultConfig(WTSTANDINCONFIG *config_O);
+
+	/// Replaces all tablets with config_I's, attached, and forgets their
+	/// overrides.  Used by the library's first call if never called.
+	BOOL WintabStandInSetConfig(const WTSTANDINCONFIG *config_I);
+
+	/// Plugs in a tablet: the first one detached, or a new one.
+	BOOL WintabStandInAttachTablet(UINT *tablet_O);
+
+	/// Unplugs a tablet.  It keeps its index, and its default context stays
+	/// in WTI_DDCTXS, as with the driver.
+	BOOL WintabStandInDetachTablet(UINT tablet_I);
+
+	void WintabStandInGetStats(WTSTANDINSTATS *stats_O);
+	void WintabStandInResetStats(void);
+
+	typedef void ( * WINTABSTANDINGETDEFAULTCONFIG ) ( WTSTANDINCONFIG* );
+	typedef BOOL ( * WINTABSTANDINSETCONFIG )        ( const WTSTANDINCONFIG* );
+	typedef BOOL ( * WINTABSTANDINATTACHTABLET )     ( UINT* );
+	typedef BOOL ( * WINTABSTANDINDETACHTABLET )     ( UINT );
+	typedef void ( * WINTABSTANDINGETSTATS )         ( WTSTANDINSTATS* );
+	typedef void ( * WINTABSTANDINRESETSTATS )       ( void );
+
+#ifdef __cplusplus
+}
+#endif